@@ -28,4 +28,4 @@ endif
 
 # Generate the keymap.c
 $(KEYBOARD_OUTPUT)/src/keymap.c: $(KEYMAP_JSON)
-	bin/qmk json2c --quiet --output $(KEYMAP_C) $(KEYMAP_JSON)
+	bin/qmk json2c --quiet $(if $(filter yes,$(strip $(KEYMAP_COMPRESSED))),--compressed) $(if $(filter yes,$(strip $(KEYMAP_ACTIONS))),--actions) --output $(KEYMAP_C) $(KEYMAP_JSON)
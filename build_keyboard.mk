@@ -146,6 +146,11 @@ ifneq ($(FORCE_LAYOUT),)
     TARGET := $(TARGET)_$(FORCE_LAYOUT)
 endif
 
+# The host build keeps its objects and executable apart from the firmware's
+ifeq ($(strip $(NATIVE)), yes)
+    TARGET := $(TARGET)_native
+endif
+
 include quantum/mcu_selection.mk
 
 # Find all the C source files to be compiled in subfolders.
@@ -225,7 +230,13 @@ endif
 # Determine and set parameters based on the keyboard's processor family.
 # We can assume a ChibiOS target When MCU_FAMILY is defined since it's
 # not used for LUFA
-ifdef MCU_FAMILY
+ifeq ($(strip $(NATIVE)), yes)
+    # A host executable to profile the keyboard and keymap with, see docs/faq_debug.md
+    PLATFORM=TEST
+    PLATFORM_KEY=test
+    FIRMWARE_FORMAT=elf
+    PROTOCOL=NATIVE
+else ifdef MCU_FAMILY
     PLATFORM=CHIBIOS
     PLATFORM_KEY=chibios
     FIRMWARE_FORMAT?=bin
@@ -305,6 +316,21 @@ $(KEYBOARD_OUTPUT)/src/layouts.h: $(INFO_JSON_FILES)
 
 generated-files: $(KEYBOARD_OUTPUT)/src/info_config.h $(KEYBOARD_OUTPUT)/src/default_keyboard.h $(KEYBOARD_OUTPUT)/src/layouts.h
 
+ifeq ($(strip $(MATRIX_SCAN_DRIVER)), generated)
+# The matrix pins may also come from config.h
+$(KEYBOARD_OUTPUT)/src/matrix_scan.h: $(INFO_JSON_FILES) $(filter-out $(KEYBOARD_OUTPUT)/%,$(CONFIG_H))
+	bin/qmk generate-matrix-scan --quiet --keyboard $(KEYBOARD) --output $(KEYBOARD_OUTPUT)/src/matrix_scan.h
+
+generated-files: $(KEYBOARD_OUTPUT)/src/matrix_scan.h
+endif
+
+ifneq ($(strip $(SEND_STRING_LOCALE)),)
+$(KEYBOARD_OUTPUT)/src/send_string_unicode.h: $(QUANTUM_DIR)/keymap_extras/keymap_$(strip $(SEND_STRING_LOCALE)).h
+	bin/qmk generate-send-string-unicode --quiet --locale $(strip $(SEND_STRING_LOCALE)) --output $(KEYBOARD_OUTPUT)/src/send_string_unicode.h
+
+generated-files: $(KEYBOARD_OUTPUT)/src/send_string_unicode.h
+endif
+
 .INTERMEDIATE : generated-files
 
 # Userspace setup and definitions
@@ -324,6 +350,35 @@ endif
 # Disable features that a keyboard doesn't support
 -include disable_features.mk
 
+ifeq ($(strip $(NATIVE)), yes)
+    # Hardware the host build has nothing to stand in for
+    NATIVE_DISABLED_FEATURES := ADAFRUIT_BLE ADB_MOUSE AUDIO BACKLIGHT BLUETOOTH CONSOLE DIP_SWITCH ENCODER \
+        HAPTIC HD44780 JOYSTICK LATENCY_PROBE LCD LED_MATRIX MIDI OLED_DRIVER POINTING_DEVICE PS2_MOUSE \
+        SERIAL_LINK SERIAL_MOUSE_MICROSOFT SERIAL_MOUSE_MOUSESYSTEMS SLEEP_LED STACK_WATERMARK STENO USBPD \
+        VIRTSER VISUALIZER XT
+    $(foreach AFEATURE,$(NATIVE_DISABLED_FEATURES),$(eval $(AFEATURE)_ENABLE=no))
+
+    # Lighting on WS2812s runs as on the keyboard, the frames it sends are dropped
+    ifneq ($(filter-out WS2812,$(RGBLIGHT_DRIVER))$(filter yes,$(RGBLIGHT_CUSTOM_DRIVER)),)
+        RGBLIGHT_ENABLE = no
+    endif
+    ifneq ($(strip $(RGB_MATRIX_DRIVER)), WS2812)
+        RGB_MATRIX_ENABLE = no
+    endif
+    WS2812_DRIVER = native
+    EEPROM_DRIVER = vendor
+
+    # The halves of a split keyboard run as one, on a matrix fed by tmk_core/protocol/native/main.c
+    ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
+        VPATH += $(QUANTUM_PATH)/split_common
+    endif
+    SPLIT_KEYBOARD = no
+    CUSTOM_MATRIX = lite
+
+    # Formats written for the int sizes of the keyboard's MCU
+    CFLAGS += -Wno-error=format
+endif
+
 # Object files directory
 #     To put object files in current directory, use a dot (.), do NOT make
 #     this an empty or blank macro!
@@ -365,7 +420,11 @@ ifneq ($(REQUIRE_PLATFORM_KEY),)
     endif
 endif
 
-include $(TMK_PATH)/$(PLATFORM_KEY).mk
+ifeq ($(PLATFORM_KEY),test)
+    include $(TMK_PATH)/native.mk
+else
+    include $(TMK_PATH)/$(PLATFORM_KEY).mk
+endif
 ifneq ($(strip $(PROTOCOL)),)
     include $(TMK_PATH)/protocol/$(strip $(shell echo $(PROTOCOL) | tr '[:upper:]' '[:lower:]')).mk
 else
@@ -386,6 +445,11 @@ endif
 CONFIG_H += $(POST_CONFIG_H)
 ALL_CONFIGS := $(PROJECT_CONFIG) $(CONFIG_H)
 
+ifeq ($(strip $(NATIVE)), yes)
+    # In place of the keyboard's own matrix scan
+    SRC := $(filter-out matrix.c,$(SRC))
+endif
+
 OUTPUTS := $(KEYMAP_OUTPUT) $(KEYBOARD_OUTPUT)
 $(KEYMAP_OUTPUT)_SRC := $(SRC)
 $(KEYMAP_OUTPUT)_DEFS := $(OPT_DEFS) $(GFXDEFS) \
@@ -401,7 +465,7 @@ $(KEYBOARD_OUTPUT)_CONFIG := $(PROJECT_CONFIG)
 
 # Default target.
 ifeq ($(SKIP_COMPILE),no)
-all: build check-size
+all: build check-size $(if $(strip $(MEMORY_BUDGET)),memory-report)
 else
 all:
 	echo "skipped" >&2
@@ -411,6 +475,7 @@ build: elf cpfirmware
 check-size: build
 check-md5: build
 objs-size: build
+memory-report: build
 
 include show_options.mk
 include $(TMK_PATH)/rules.mk
@@ -23,6 +23,14 @@ QUANTUM_SRC += \
     $(QUANTUM_DIR)/keymap_common.c \
     $(QUANTUM_DIR)/keycode_config.c
 
+ifneq ($(strip $(SEND_STRING_LOCALE)),)
+    ifeq ($(wildcard $(QUANTUM_DIR)/keymap_extras/keymap_$(strip $(SEND_STRING_LOCALE)).h),)
+        $(error SEND_STRING_LOCALE="$(SEND_STRING_LOCALE)" has no quantum/keymap_extras/keymap_$(strip $(SEND_STRING_LOCALE)).h)
+    endif
+    # send_string_unicode.h is generated from the locale's keymap_extras header by build_keyboard.mk
+    OPT_DEFS += -DSEND_STRING_UNICODE_H=\"$(KEYBOARD_OUTPUT)/src/send_string_unicode.h\"
+endif
+
 ifeq ($(strip $(DEBUG_MATRIX_SCAN_RATE_ENABLE)), yes)
     OPT_DEFS += -DDEBUG_MATRIX_SCAN_RATE
     CONSOLE_ENABLE = yes
@@ -106,10 +114,22 @@ ifeq ($(strip $(MOUSEKEY_ENABLE)), yes)
     SRC += $(QUANTUM_DIR)/mousekey.c
 endif
 
+VALID_POINTING_DEVICE_DRIVER_TYPES := pmw3360 custom
+POINTING_DEVICE_DRIVER ?= custom
 ifeq ($(strip $(POINTING_DEVICE_ENABLE)), yes)
+    ifeq ($(filter $(POINTING_DEVICE_DRIVER),$(VALID_POINTING_DEVICE_DRIVER_TYPES)),)
+        $(error POINTING_DEVICE_DRIVER="$(POINTING_DEVICE_DRIVER)" is not a valid pointing device driver)
+    endif
     OPT_DEFS += -DPOINTING_DEVICE_ENABLE
     OPT_DEFS += -DMOUSE_ENABLE
+    OPT_DEFS += -DPOINTING_DEVICE_DRIVER_$(strip $(POINTING_DEVICE_DRIVER))
     SRC += $(QUANTUM_DIR)/pointing_device.c
+
+    ifeq ($(strip $(POINTING_DEVICE_DRIVER)), pmw3360)
+        COMMON_VPATH += $(DRIVER_PATH)/sensors
+        SRC += pmw3360.c
+        QUANTUM_LIB_SRC += spi_master.c
+    endif
 endif
 
 VALID_EEPROM_DRIVER_TYPES := vendor custom transient i2c spi
@@ -255,6 +275,8 @@ endif
     SRC += $(QUANTUM_DIR)/color.c
     SRC += $(QUANTUM_DIR)/rgb_matrix.c
     SRC += $(QUANTUM_DIR)/rgb_matrix_drivers.c
+    # The seed of the lib8tion random number generator
+    SRC += $(LIB_PATH)/lib8tion/lib8tion.c
     CIE1931_CURVE := yes
     RGB_KEYCODES_ENABLE := yes
 
@@ -303,6 +325,12 @@ endif
     ifeq ($(strip $(RGB_MATRIX_CUSTOM_USER)), yes)
         OPT_DEFS += -DRGB_MATRIX_CUSTOM_USER
     endif
+
+    ifeq ($(strip $(RGB_MATRIX_BENCHMARK_ENABLE)), yes)
+        OPT_DEFS += -DRGB_MATRIX_BENCHMARK
+        TASK_PROFILE_COUNTER = yes
+        CONSOLE_ENABLE = yes
+    endif
 endif
 
 ifeq ($(strip $(RGB_KEYCODES_ENABLE)), yes)
@@ -312,7 +340,7 @@ endif
 ifeq ($(strip $(PRINTING_ENABLE)), yes)
     OPT_DEFS += -DPRINTING_ENABLE
     SRC += $(QUANTUM_DIR)/process_keycode/process_printer.c
-    SRC += $(TMK_DIR)/protocol/serial_uart.c
+    QUANTUM_LIB_SRC += uart.c
 endif
 
 ifeq ($(strip $(SERIAL_LINK_ENABLE)), yes)
@@ -370,7 +398,7 @@ ifeq ($(strip $(BACKLIGHT_ENABLE)), yes)
     endif
 endif
 
-VALID_WS2812_DRIVER_TYPES := bitbang pwm spi i2c
+VALID_WS2812_DRIVER_TYPES := bitbang pwm spi i2c native
 
 WS2812_DRIVER ?= bitbang
 ifeq ($(strip $(WS2812_DRIVER_REQUIRED)), yes)
@@ -398,9 +426,22 @@ ifeq ($(strip $(WS2812_DRIVER_REQUIRED)), yes)
     endif
 endif
 
+VALID_APA102_DRIVER_TYPES := bitbang spi
+
+APA102_DRIVER ?= bitbang
 ifeq ($(strip $(APA102_DRIVER_REQUIRED)), yes)
+    ifeq ($(filter $(APA102_DRIVER),$(VALID_APA102_DRIVER_TYPES)),)
+        $(error APA102_DRIVER="$(APA102_DRIVER)" is not a valid APA102 driver)
+    endif
+
     COMMON_VPATH += $(DRIVER_PATH)/apa102
-    SRC += apa102.c
+
+    ifeq ($(strip $(APA102_DRIVER)), bitbang)
+        SRC += apa102.c
+    else
+        SRC += apa102_$(strip $(APA102_DRIVER)).c
+        QUANTUM_LIB_SRC += spi_master.c
+    endif
 endif
 
 ifeq ($(strip $(VISUALIZER_ENABLE)), yes)
@@ -447,6 +488,13 @@ ifeq ($(strip $(VIA_ENABLE)), yes)
     BOOTMAGIC_ENABLE := lite
     SRC += $(QUANTUM_DIR)/via.c
     OPT_DEFS += -DVIA_ENABLE
+    ifeq ($(strip $(VIA_TELEMETRY_ENABLE)), yes)
+        OPT_DEFS += -DVIA_TELEMETRY
+        # keyboard_task() timing, without the console output unless it was asked for
+        ifeq ($(strip $(KEYBOARD_TASK_PROFILE_ENABLE)),)
+            KEYBOARD_TASK_PROFILE_ENABLE = api
+        endif
+    endif
 endif
 
 ifeq ($(strip $(DYNAMIC_KEYMAP_ENABLE)), yes)
@@ -454,14 +502,32 @@ ifeq ($(strip $(DYNAMIC_KEYMAP_ENABLE)), yes)
     SRC += $(QUANTUM_DIR)/dynamic_keymap.c
 endif
 
+ifeq ($(strip $(KEYMAP_COMPRESSED)), yes)
+    # Only keymap.json keymaps, their keymap.c is written by qmk json2c --compressed
+    OPT_DEFS += -DKEYMAP_COMPRESSED
+endif
+
+ifeq ($(strip $(KEYMAP_ACTIONS)), yes)
+    # Only keymap.json keymaps, qmk json2c --actions writes the table. A dynamic keymap can change after it's built
+    ifneq ($(strip $(DYNAMIC_KEYMAP_ENABLE)), yes)
+        OPT_DEFS += -DKEYMAP_ACTIONS
+    endif
+endif
+
 ifeq ($(strip $(DIP_SWITCH_ENABLE)), yes)
     OPT_DEFS += -DDIP_SWITCH_ENABLE
     SRC += $(QUANTUM_DIR)/dip_switch.c
 endif
 
 VALID_CUSTOM_MATRIX_TYPES:= yes lite no
+VALID_MATRIX_SCAN_DRIVER_TYPES := software dma analog shift_register generated
 
 CUSTOM_MATRIX ?= no
+MATRIX_SCAN_DRIVER ?= software
+
+ifeq ($(filter $(MATRIX_SCAN_DRIVER),$(VALID_MATRIX_SCAN_DRIVER_TYPES)),)
+    $(error MATRIX_SCAN_DRIVER="$(MATRIX_SCAN_DRIVER)" is not a valid matrix scan driver)
+endif
 
 ifneq ($(strip $(CUSTOM_MATRIX)), yes)
     ifeq ($(filter $(CUSTOM_MATRIX),$(VALID_CUSTOM_MATRIX_TYPES)),)
@@ -476,6 +542,21 @@ ifneq ($(strip $(CUSTOM_MATRIX)), yes)
         # Include the standard or split matrix code if needed
         ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
             QUANTUM_SRC += $(QUANTUM_DIR)/split_common/matrix.c
+        else ifeq ($(strip $(MATRIX_SCAN_DRIVER)), dma)
+            ifneq ($(PLATFORM),CHIBIOS)
+                $(error MATRIX_SCAN_DRIVER="dma" is only supported on ChibiOS)
+            endif
+            QUANTUM_SRC += $(QUANTUM_DIR)/matrix_dma.c
+        else ifeq ($(strip $(MATRIX_SCAN_DRIVER)), analog)
+            QUANTUM_SRC += $(QUANTUM_DIR)/matrix_analog.c
+            ANALOG_DRIVER_REQUIRED = yes
+        else ifeq ($(strip $(MATRIX_SCAN_DRIVER)), shift_register)
+            QUANTUM_SRC += $(QUANTUM_DIR)/matrix_shift_register.c
+            QUANTUM_LIB_SRC += spi_master.c
+        else ifeq ($(strip $(MATRIX_SCAN_DRIVER)), generated)
+            # matrix_scan.h is generated from info.json by build_keyboard.mk
+            OPT_DEFS += -DMATRIX_SCAN_GENERATED -DMATRIX_SCAN_GENERATED_H=\"$(KEYBOARD_OUTPUT)/src/matrix_scan.h\"
+            QUANTUM_SRC += $(QUANTUM_DIR)/matrix.c
         else
             QUANTUM_SRC += $(QUANTUM_DIR)/matrix.c
         endif
@@ -553,10 +634,21 @@ ifeq ($(strip $(HD44780_ENABLE)), yes)
     OPT_DEFS += -DHD44780_ENABLE
 endif
 
+VALID_OLED_TRANSPORT_TYPES := i2c spi
+OLED_TRANSPORT ?= i2c
 ifeq ($(strip $(OLED_DRIVER_ENABLE)), yes)
+    ifeq ($(filter $(OLED_TRANSPORT),$(VALID_OLED_TRANSPORT_TYPES)),)
+        $(error OLED_TRANSPORT="$(OLED_TRANSPORT)" is not a valid OLED transport)
+    endif
     OPT_DEFS += -DOLED_DRIVER_ENABLE
     COMMON_VPATH += $(DRIVER_PATH)/oled
-    QUANTUM_LIB_SRC += i2c_master.c
+    ifeq ($(strip $(OLED_TRANSPORT)), spi)
+        OPT_DEFS += -DOLED_TRANSPORT_SPI
+        QUANTUM_LIB_SRC += spi_master.c
+    else
+        OPT_DEFS += -DOLED_TRANSPORT_I2C
+        QUANTUM_LIB_SRC += i2c_master.c
+    endif
     SRC += oled_driver.c
 endif
 
@@ -644,6 +736,10 @@ endif
 
 ifeq ($(strip $(JOYSTICK_ENABLE)), analog)
     OPT_DEFS += -DANALOG_JOYSTICK_ENABLE
+    ANALOG_DRIVER_REQUIRED = yes
+endif
+
+ifeq ($(strip $(ANALOG_DRIVER_REQUIRED)), yes)
     SRC += analog.c
 endif
 
@@ -0,0 +1,118 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "apa102.h"
+#include "spi_master.h"
+#include "quantum.h"
+
+/* The whole update, start frame, LEDs and end frame, is rendered into one
+ * buffer and clocked out by the SPI peripheral. With SPI_ASYNC it goes out
+ * in the background, and only the next update waits for it to finish. */
+
+#ifndef APA102_SPI_CS_PIN
+#    error "APA102_DRIVER = spi needs APA102_SPI_CS_PIN, the pin enabling the LEDs' clock and data, or any free pin if nothing else uses the SPI bus"
+#endif
+#ifndef APA102_SPI_DIVISOR
+#    define APA102_SPI_DIVISOR 4
+#endif
+#ifndef APA102_LED_COUNT
+#    define APA102_LED_COUNT RGBLED_NUM
+#endif
+
+#define APA102_START_BYTES 4
+#define APA102_END_BYTES ((APA102_LED_COUNT + 14) / 16)  // see the end frame comment in apa102.c
+#define APA102_BUFFER_SIZE (APA102_START_BYTES + APA102_LED_COUNT * 4 + APA102_END_BYTES)
+
+uint8_t apa102_led_brightness = APA102_DEFAULT_BRIGHTNESS;
+
+static uint8_t apa102_buffer[APA102_BUFFER_SIZE];
+
+#ifdef SPI_ASYNC
+static spi_transaction_t apa102_transaction = {
+    .slave_pin = APA102_SPI_CS_PIN,
+    .divisor   = APA102_SPI_DIVISOR,
+    .tx        = apa102_buffer,
+};
+#endif
+
+/* Each LED's 5-bit brightness scales its colour by brightness / 31. Rather
+ * than sending the global brightness with dimmed colours, the LED's
+ * brightness is lowered as far as its brightest channel allows and the
+ * colours are scaled back up, so dim colours keep all their 8 bits. */
+static void apa102_render_led(uint8_t *frame, LED_TYPE *led, uint8_t brightness) {
+    uint8_t max = led->r > led->g ? led->r : led->g;
+    if (led->b > max) {
+        max = led->b;
+    }
+
+    uint8_t led_brightness = (max * brightness + 254) / 255;
+    if (led_brightness == 0) {
+        led_brightness = 1;
+    }
+
+    frame[0] = 0b11100000 | led_brightness;
+    frame[1] = led->b * brightness / led_brightness;
+    frame[2] = led->g * brightness / led_brightness;
+    frame[3] = led->r * brightness / led_brightness;
+}
+
+void apa102_setleds(LED_TYPE *start_led, uint16_t num_leds) {
+    if (num_leds > APA102_LED_COUNT) {
+        num_leds = APA102_LED_COUNT;
+    }
+
+#ifdef SPI_ASYNC
+    // The buffer is still being sent from the last update
+    if (apa102_transaction.status == SPI_STATUS_PENDING) {
+        spi_wait(&apa102_transaction);
+    }
+#endif
+
+    uint8_t *frame = apa102_buffer;
+    for (uint8_t i = 0; i < APA102_START_BYTES; i++) {
+        *frame++ = 0;
+    }
+    for (uint16_t i = 0; i < num_leds; i++, frame += 4) {
+        apa102_render_led(frame, &start_led[i], apa102_led_brightness);
+    }
+    uint16_t end_bytes = (num_leds + 14) / 16;
+    for (uint16_t i = 0; i < end_bytes; i++) {
+        *frame++ = 0;
+    }
+    uint16_t length = frame - apa102_buffer;
+
+    spi_init();
+#ifdef SPI_ASYNC
+    apa102_transaction.length = length;
+    spi_submit(&apa102_transaction);
+#else
+    if (spi_start(APA102_SPI_CS_PIN, false, 0, APA102_SPI_DIVISOR)) {
+        spi_transmit(apa102_buffer, length);
+        spi_stop();
+    }
+#endif
+}
+
+// Overwrite the default rgblight_call_driver to use apa102 driver
+void rgblight_call_driver(LED_TYPE *start_led, uint8_t num_leds) { apa102_setleds(start_led, num_leds); }
+
+void apa102_set_brightness(uint8_t brightness) {
+    if (brightness > APA102_MAX_BRIGHTNESS) {
+        apa102_led_brightness = APA102_MAX_BRIGHTNESS;
+    } else {
+        apa102_led_brightness = brightness;
+    }
+}
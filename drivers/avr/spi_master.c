@@ -169,6 +169,22 @@ spi_status_t spi_receive(uint8_t *data, uint16_t length) {
     return SPI_STATUS_SUCCESS;
 }
 
+spi_status_t spi_transceive(const uint8_t *tx, uint8_t *rx, uint16_t length) {
+    spi_status_t status;
+
+    for (uint16_t i = 0; i < length; i++) {
+        status = spi_write(tx[i]);
+
+        if (status >= 0) {
+            rx[i] = status;
+        } else {
+            return status;
+        }
+    }
+
+    return SPI_STATUS_SUCCESS;
+}
+
 void spi_stop(void) {
     if (currentSlavePin != NO_PIN) {
         setPinOutput(currentSlavePin);
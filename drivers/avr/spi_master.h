@@ -51,6 +51,8 @@ spi_status_t spi_transmit(const uint8_t *data, uint16_t length);
 
 spi_status_t spi_receive(uint8_t *data, uint16_t length);
 
+spi_status_t spi_transceive(const uint8_t *tx, uint8_t *rx, uint16_t length);
+
 void spi_stop(void);
 #ifdef __cplusplus
 }
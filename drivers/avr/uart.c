@@ -77,8 +77,14 @@
 #endif
 
 // These buffers may be any size from 2 to 256 bytes.
-#define RX_BUFFER_SIZE 64
-#define TX_BUFFER_SIZE 256
+#ifndef UART_RX_BUFFER_SIZE
+#    define UART_RX_BUFFER_SIZE 64
+#endif
+#ifndef UART_TX_BUFFER_SIZE
+#    define UART_TX_BUFFER_SIZE 256
+#endif
+#define RX_BUFFER_SIZE UART_RX_BUFFER_SIZE
+#define TX_BUFFER_SIZE UART_TX_BUFFER_SIZE
 
 static volatile uint8_t tx_buffer[TX_BUFFER_SIZE];
 static volatile uint8_t tx_buffer_head;
@@ -99,21 +105,70 @@ void uart_init(uint32_t baud) {
     sei();
 }
 
-// Transmit a byte
-void uart_putchar(uint8_t c) {
+// Queue a byte for transmission, return false without waiting if the buffer is full
+bool uart_try_putchar(uint8_t c) {
     uint8_t i;
 
     i = tx_buffer_head + 1;
     if (i >= TX_BUFFER_SIZE) i = 0;
-    // return immediately to avoid deadlock when interrupt is disabled(called from ISR)
-    if (tx_buffer_tail == i && (SREG & (1 << SREG_I)) == 0) return;
-    while (tx_buffer_tail == i)
-        ;  // wait until space in buffer
-    // cli();
+    if (tx_buffer_tail == i) return false;
     tx_buffer[i]   = c;
     tx_buffer_head = i;
     UCSRnB         = (1 << RXENn) | (1 << TXENn) | (1 << RXCIEn) | (1 << UDRIEn);
-    // sei();
+    return true;
+}
+
+// Transmit a byte
+void uart_putchar(uint8_t c) {
+    while (!uart_try_putchar(c)) {
+        // return immediately to avoid deadlock when interrupt is disabled(called from ISR)
+        if ((SREG & (1 << SREG_I)) == 0) return;
+        // wait until space in buffer
+    }
+}
+
+// Queue as many bytes as fit, enabling the transmit interrupt once for all of them
+uint16_t uart_write(const uint8_t *data, uint16_t length) {
+    uint8_t  head = tx_buffer_head;
+    uint16_t n;
+
+    for (n = 0; n < length; n++) {
+        uint8_t i = head + 1;
+        if (i >= TX_BUFFER_SIZE) i = 0;
+        if (tx_buffer_tail == i) break;
+        tx_buffer[i] = data[n];
+        head         = i;
+    }
+    if (n) {
+        tx_buffer_head = head;
+        UCSRnB         = (1 << RXENn) | (1 << TXENn) | (1 << RXCIEn) | (1 << UDRIEn);
+    }
+    return n;
+}
+
+// Transmit bytes
+void uart_transmit(const uint8_t *data, uint16_t length) {
+    while (length) {
+        uint16_t n = uart_write(data, length);
+        // return immediately to avoid deadlock when interrupt is disabled(called from ISR)
+        if (!n && (SREG & (1 << SREG_I)) == 0) return;
+        data += n;
+        length -= n;
+    }
+}
+
+// Take the bytes already received, up to length
+uint16_t uart_read(uint8_t *data, uint16_t length) {
+    uint8_t  tail = rx_buffer_tail;
+    uint16_t n;
+
+    for (n = 0; n < length && tail != rx_buffer_head; n++) {
+        tail++;
+        if (tail >= RX_BUFFER_SIZE) tail = 0;
+        data[n] = rx_buffer[tail];
+    }
+    rx_buffer_tail = tail;
+    return n;
 }
 
 // Receive a byte
@@ -47,6 +47,13 @@ void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds) {
     _delay_us(WS2812_TRST_US);
 }
 
+void ws2812_setleds_async(LED_TYPE *ledarray, uint16_t number_of_leds, ws2812_callback_t callback) {
+    ws2812_setleds(ledarray, number_of_leds);
+    if (callback) {
+        callback();
+    }
+}
+
 /*
   This routine writes an array of bytes with RGB values to the Dataout pin
   using the fast 800kHz clockless WS2811/2812 protocol.
@@ -104,6 +104,18 @@
 #    define ADC_RESOLUTION ADC_CFGR1_RES_10BIT
 #endif
 
+#ifdef ADC_CONTINUOUS_PINS
+#    ifndef ADC_CONTINUOUS_ADC
+#        define ADC_CONTINUOUS_ADC 0
+#    endif
+// Samples averaged per read, 1 or an even number
+#    ifndef ADC_CONTINUOUS_DEPTH
+#        define ADC_CONTINUOUS_DEPTH 4
+#    elif ADC_CONTINUOUS_DEPTH > 1 && ADC_CONTINUOUS_DEPTH % 2
+#        error "ADC_CONTINUOUS_DEPTH has to be 1 or an even number."
+#    endif
+#endif
+
 static ADCConfig   adcCfg = {};
 static adcsample_t sampleBuffer[ADC_NUM_CHANNELS * ADC_BUFFER_DEPTH];
 
@@ -232,6 +244,114 @@ static inline void manageAdcInitializationDriver(uint8_t adc, ADCDriver* adcDriv
     }
 }
 
+#ifdef ADC_CONTINUOUS_PINS
+/* The pins listed in ADC_CONTINUOUS_PINS are sampled over and over by their
+ * ADC, with the DMA writing the results into a circular buffer. Reading one is
+ * then only a matter of averaging its last ADC_CONTINUOUS_DEPTH samples out of
+ * that buffer, which needs no locking as the DMA writes each sample whole. */
+static const pin_t continuousPins[] = ADC_CONTINUOUS_PINS;
+#    define ADC_CONTINUOUS_COUNT (sizeof(continuousPins) / sizeof(pin_t))
+
+static adcsample_t continuousBuffer[ADC_CONTINUOUS_COUNT * ADC_CONTINUOUS_DEPTH];
+static uint8_t     continuousSlot[ADC_CONTINUOUS_COUNT];  // where each pin's samples land in a sequence
+static uint16_t    continuousInput[ADC_CONTINUOUS_COUNT];
+static bool        continuousStarted = false;
+
+static ADCConversionGroup continuousConversionGroup = {
+    .circular     = TRUE,
+    .num_channels = (uint16_t)ADC_CONTINUOUS_COUNT,
+#    if defined(USE_ADCV1)
+    .cfgr1 = ADC_CFGR1_CONT | ADC_RESOLUTION,
+    .smpr  = ADC_SAMPLING_RATE,
+#    elif defined(USE_ADCV2)
+    .cr2   = ADC_CR2_CONT | ADC_CR2_SWSTART,
+    .sqr1  = ADC_SQR1_NUM_CH(ADC_CONTINUOUS_COUNT),
+    .smpr2 = ADC_SMPR2_SMP_AN0(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN1(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN2(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN3(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN4(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN5(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN6(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN7(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN8(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN9(ADC_SAMPLING_RATE),
+    .smpr1 = ADC_SMPR1_SMP_AN10(ADC_SAMPLING_RATE) | ADC_SMPR1_SMP_AN11(ADC_SAMPLING_RATE) | ADC_SMPR1_SMP_AN12(ADC_SAMPLING_RATE) | ADC_SMPR1_SMP_AN13(ADC_SAMPLING_RATE) | ADC_SMPR1_SMP_AN14(ADC_SAMPLING_RATE) | ADC_SMPR1_SMP_AN15(ADC_SAMPLING_RATE),
+#    else
+    .cfgr = ADC_CFGR_CONT | ADC_RESOLUTION,
+    .smpr = {ADC_SMPR1_SMP_AN0(ADC_SAMPLING_RATE) | ADC_SMPR1_SMP_AN1(ADC_SAMPLING_RATE) | ADC_SMPR1_SMP_AN2(ADC_SAMPLING_RATE) | ADC_SMPR1_SMP_AN3(ADC_SAMPLING_RATE) | ADC_SMPR1_SMP_AN4(ADC_SAMPLING_RATE) | ADC_SMPR1_SMP_AN5(ADC_SAMPLING_RATE) | ADC_SMPR1_SMP_AN6(ADC_SAMPLING_RATE) | ADC_SMPR1_SMP_AN7(ADC_SAMPLING_RATE) | ADC_SMPR1_SMP_AN8(ADC_SAMPLING_RATE) | ADC_SMPR1_SMP_AN9(ADC_SAMPLING_RATE), ADC_SMPR2_SMP_AN10(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN11(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN12(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN13(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN14(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN15(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN16(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN17(ADC_SAMPLING_RATE) | ADC_SMPR2_SMP_AN18(ADC_SAMPLING_RATE)},
+#    endif
+};
+
+/** \brief Starts sampling the pins in ADC_CONTINUOUS_PINS, done by the first read otherwise
+ */
+void adc_continuous_start(void) {
+    if (continuousStarted) {
+        return;
+    }
+
+    ADCDriver* targetDriver = intToADCDriver(ADC_CONTINUOUS_ADC);
+    if (!targetDriver) {
+        return;
+    }
+    continuousStarted = true;
+
+    for (uint8_t i = 0; i < ADC_CONTINUOUS_COUNT; i++) {
+        palSetLineMode(continuousPins[i], PAL_MODE_INPUT_ANALOG);
+        continuousInput[i] = pinToMux(continuousPins[i]).input;
+#    if defined(USE_ADCV1)
+        // The channels are always converted from the lowest to the highest
+        continuousConversionGroup.chselr |= continuousInput[i];
+#    elif defined(USE_ADCV2)
+        // SQ1-SQ6 in SQR3, SQ7-SQ12 in SQR2, SQ13-SQ16 in SQR1, 5 bits each
+        uint32_t sq = (uint32_t)continuousInput[i] << ((i % 6) * 5);
+        if (i < 6) {
+            continuousConversionGroup.sqr3 |= sq;
+        } else if (i < 12) {
+            continuousConversionGroup.sqr2 |= sq;
+        } else {
+            continuousConversionGroup.sqr1 |= sq;
+        }
+#    else
+        // SQ1-SQ4 in SQR1 after its length field, then five to a register, 6 bits each
+        if (i < 4) {
+            continuousConversionGroup.sqr[0] |= (uint32_t)continuousInput[i] << ((i + 1) * 6);
+        } else {
+            continuousConversionGroup.sqr[1 + (i - 4) / 5] |= (uint32_t)continuousInput[i] << (((i - 4) % 5) * 6);
+        }
+#    endif
+    }
+
+    for (uint8_t i = 0; i < ADC_CONTINUOUS_COUNT; i++) {
+#    if defined(USE_ADCV1)
+        continuousSlot[i] = 0;
+        for (uint8_t j = 0; j < ADC_CONTINUOUS_COUNT; j++) {
+            if (continuousInput[j] < continuousInput[i]) {
+                continuousSlot[i]++;
+            }
+        }
+#    else
+        continuousSlot[i] = i;
+#    endif
+    }
+
+    manageAdcInitializationDriver(ADC_CONTINUOUS_ADC, targetDriver);
+    adcStartConversion(targetDriver, &continuousConversionGroup, continuousBuffer, ADC_CONTINUOUS_DEPTH);
+}
+
+/** \brief Returns the latest value of the pin at the given index of ADC_CONTINUOUS_PINS
+ */
+int16_t adc_continuous_read(uint8_t index) {
+    adc_continuous_start();
+    if (index >= ADC_CONTINUOUS_COUNT) {
+        return 0;
+    }
+
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < ADC_CONTINUOUS_DEPTH; i++) {
+        sum += continuousBuffer[i * ADC_CONTINUOUS_COUNT + continuousSlot[index]];
+    }
+    sum /= ADC_CONTINUOUS_DEPTH;
+#    ifdef USE_ADCV2
+    // fake 12-bit -> N-bit scale
+    return sum >> (12 - ADC_RESOLUTION);
+#    else
+    return sum;
+#    endif
+}
+#endif
+
 int16_t analogReadPin(pin_t pin) {
     palSetLineMode(pin, PAL_MODE_INPUT_ANALOG);
 
@@ -261,6 +381,20 @@ int16_t adc_read(adc_mux mux) {
         return 0;
     }
 
+#ifdef ADC_CONTINUOUS_PINS
+    // That ADC is busy sampling, the value is in its buffer if at all
+    if (mux.adc == ADC_CONTINUOUS_ADC) {
+        adc_continuous_start();
+        for (uint8_t i = 0; i < ADC_CONTINUOUS_COUNT; i++) {
+            if (continuousInput[i] == mux.input) {
+                return adc_continuous_read(i);
+            }
+        }
+        return 0;
+    }
+#endif
+
+
     manageAdcInitializationDriver(mux.adc, targetDriver);
     if (adcConvert(targetDriver, &adcConversionGroup, &sampleBuffer[0], ADC_BUFFER_DEPTH) != MSG_OK) {
         return 0;
@@ -36,6 +36,11 @@ adc_mux pinToMux(pin_t pin);
 
 int16_t adc_read(adc_mux mux);
 
+#ifdef ADC_CONTINUOUS_PINS
+void    adc_continuous_start(void);
+int16_t adc_continuous_read(uint8_t index);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
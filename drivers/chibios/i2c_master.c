@@ -45,6 +45,15 @@ static const I2CConfig i2cconfig = {
 #endif
 };
 
+/* Starts the driver unless it already is. It is left running between
+ * transfers, only a timeout (which locks the driver) or i2c_stop() make it
+ * start again. */
+static void i2c_ensure_started(void) {
+    if (I2C_DRIVER.state != I2C_READY) {
+        i2cStart(&I2C_DRIVER, &i2cconfig);
+    }
+}
+
 static i2c_status_t chibios_to_qmk(const msg_t* status) {
     switch (*status) {
         case I2C_NO_ERROR:
@@ -74,48 +83,175 @@ __attribute__((weak)) void i2c_init(void) {
         palSetPadMode(I2C1_SCL_BANK, I2C1_SCL, PAL_MODE_ALTERNATE(I2C1_SCL_PAL_MODE) | PAL_STM32_OTYPE_OPENDRAIN);
         palSetPadMode(I2C1_SDA_BANK, I2C1_SDA, PAL_MODE_ALTERNATE(I2C1_SDA_PAL_MODE) | PAL_STM32_OTYPE_OPENDRAIN);
 #endif
+        i2c_ensure_started();
+    }
+}
+
+static i2c_status_t i2c_transfer_now(uint8_t address, const uint8_t* tx, uint16_t tx_length, uint8_t* rx, uint16_t rx_length, uint16_t timeout) {
+    i2c_ensure_started();
+    msg_t status;
+    if (tx_length) {
+        status = i2cMasterTransmitTimeout(&I2C_DRIVER, (address >> 1), tx, tx_length, rx, rx_length, TIME_MS2I(timeout));
+    } else {
+        status = i2cMasterReceiveTimeout(&I2C_DRIVER, (address >> 1), rx, rx_length, TIME_MS2I(timeout));
     }
+    return chibios_to_qmk(&status);
 }
 
+#ifdef I2C_ASYNC
+/* Transactions are run one at a time by a thread of their own, so the main
+ * loop carries on while the bus is busy. The thread has a higher priority
+ * than the main loop, which it only takes over between two transfers. */
+static i2c_transaction_t* queue_head;  // submitted, run in order
+static i2c_transaction_t* queue_tail;
+static i2c_transaction_t* done_head;  // completed, callbacks still to run
+static i2c_transaction_t* done_tail;
+static semaphore_t        queue_count;
+static binary_semaphore_t transaction_done;
+static thread_t*          i2c_thread = NULL;
+
+static THD_WORKING_AREA(i2c_thread_wa, I2C_ASYNC_STACK_SIZE);
+
+static THD_FUNCTION(i2c_thread_main, arg) {
+    (void)arg;
+    chRegSetThreadName("i2c");
+
+    while (true) {
+        chSemWait(&queue_count);
+
+        chSysLock();
+        i2c_transaction_t* transaction = queue_head;
+        queue_head                     = transaction->next;
+        if (!queue_head) {
+            queue_tail = NULL;
+        }
+        chSysUnlock();
+
+        i2c_status_t status = i2c_transfer_now(transaction->address, transaction->tx, transaction->tx_length, transaction->rx, transaction->rx_length, transaction->timeout);
+
+        chSysLock();
+        transaction->next = NULL;
+        if (transaction->callback) {
+            if (done_tail) {
+                done_tail->next = transaction;
+            } else {
+                done_head = transaction;
+            }
+            done_tail = transaction;
+        }
+        transaction->status = status;
+        chBSemSignalI(&transaction_done);
+        chSchRescheduleS();
+        chSysUnlock();
+    }
+}
+
+/** \brief Queues a transaction
+ *
+ * The transaction must stay valid until its status is no longer I2C_STATUS_PENDING. Its tx bytes are written,
+ * then with a repeated start its rx bytes read, in one transfer and without copying either buffer.
+ */
+void i2c_submit(i2c_transaction_t* transaction) {
+    if (!i2c_thread) {
+        chSemObjectInit(&queue_count, 0);
+        chBSemObjectInit(&transaction_done, true);
+        i2c_thread = chThdCreateStatic(i2c_thread_wa, sizeof(i2c_thread_wa), NORMALPRIO + 1, i2c_thread_main, NULL);
+    }
+
+    transaction->status = I2C_STATUS_PENDING;
+    transaction->next   = NULL;
+
+    chSysLock();
+    if (queue_tail) {
+        queue_tail->next = transaction;
+    } else {
+        queue_head = transaction;
+    }
+    queue_tail = transaction;
+    chSemSignalI(&queue_count);
+    chSchRescheduleS();
+    chSysUnlock();
+}
+
+/** \brief Waits for a transaction to complete
+ */
+i2c_status_t i2c_wait(i2c_transaction_t* transaction) {
+    while (transaction->status == I2C_STATUS_PENDING) {
+        chBSemWaitTimeout(&transaction_done, TIME_MS2I(1));
+    }
+    return transaction->status;
+}
+
+/** \brief Runs the callbacks of the completed transactions, called from the main loop
+ */
+void i2c_async_task(void) {
+    while (done_head) {
+        chSysLock();
+        i2c_transaction_t* transaction = done_head;
+        done_head                      = transaction->next;
+        if (!done_head) {
+            done_tail = NULL;
+        }
+        chSysUnlock();
+
+        transaction->callback(transaction);
+    }
+}
+
+static i2c_status_t i2c_transfer(uint8_t address, const uint8_t* tx, uint16_t tx_length, uint8_t* rx, uint16_t rx_length, uint16_t timeout) {
+    i2c_transaction_t transaction = {
+        .address   = address,
+        .tx        = tx,
+        .tx_length = tx_length,
+        .rx        = rx,
+        .rx_length = rx_length,
+        .timeout   = timeout,
+    };
+    i2c_submit(&transaction);
+    return i2c_wait(&transaction);
+}
+#else
+#    define i2c_transfer i2c_transfer_now
+#endif
+
 i2c_status_t i2c_start(uint8_t address) {
     i2c_address = address;
-    i2cStart(&I2C_DRIVER, &i2cconfig);
+#ifndef I2C_ASYNC
+    i2c_ensure_started();
+#endif
     return I2C_STATUS_SUCCESS;
 }
 
 i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
     i2c_address = address;
-    i2cStart(&I2C_DRIVER, &i2cconfig);
-    msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, 0, 0, TIME_MS2I(timeout));
-    return chibios_to_qmk(&status);
+    return i2c_transfer(i2c_address, data, length, 0, 0, timeout);
 }
 
 i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout) {
     i2c_address = address;
-    i2cStart(&I2C_DRIVER, &i2cconfig);
-    msg_t status = i2cMasterReceiveTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, TIME_MS2I(timeout));
-    return chibios_to_qmk(&status);
+    return i2c_transfer(i2c_address, NULL, 0, data, length, timeout);
 }
 
 i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
     i2c_address = devaddr;
-    i2cStart(&I2C_DRIVER, &i2cconfig);
 
+    // The register has to go out in the same transfer as the data, which
+    // ChibiOS takes from a single buffer. Callers that can put it in front of
+    // their data themselves should use i2c_transmit() and skip this copy.
     uint8_t complete_packet[length + 1];
-    for (uint8_t i = 0; i < length; i++) {
-        complete_packet[i + 1] = data[i];
-    }
+    memcpy(complete_packet + 1, data, length);
     complete_packet[0] = regaddr;
 
-    msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), complete_packet, length + 1, 0, 0, TIME_MS2I(timeout));
-    return chibios_to_qmk(&status);
+    return i2c_transfer(i2c_address, complete_packet, length + 1, 0, 0, timeout);
 }
 
 i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
     i2c_address = devaddr;
-    i2cStart(&I2C_DRIVER, &i2cconfig);
-    msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), &regaddr, 1, data, length, TIME_MS2I(timeout));
-    return chibios_to_qmk(&status);
+    return i2c_transfer(i2c_address, &regaddr, 1, data, length, timeout);
 }
 
-void i2c_stop(void) { i2cStop(&I2C_DRIVER); }
+void i2c_stop(void) {
+#ifndef I2C_ASYNC
+    i2cStop(&I2C_DRIVER);
+#endif
+}
@@ -111,3 +111,32 @@ i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16
 i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout);
 i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout);
 void         i2c_stop(void);
+
+#ifdef I2C_ASYNC
+#    ifndef I2C_ASYNC_STACK_SIZE
+#        define I2C_ASYNC_STACK_SIZE 256
+#    endif
+
+#    define I2C_STATUS_PENDING (-3)
+
+typedef struct i2c_transaction i2c_transaction_t;
+typedef void (*i2c_callback_t)(i2c_transaction_t* transaction);
+
+/* One write, read, or write then read with a repeated start. */
+struct i2c_transaction {
+    uint8_t               address;    // already shifted, like the blocking functions take it
+    const uint8_t*        tx;         // e.g. a register address followed by the data to write it
+    uint16_t              tx_length;  // 0 for a plain read
+    uint8_t*              rx;
+    uint16_t              rx_length;  // 0 for a plain write
+    uint16_t              timeout;    // in milliseconds
+    i2c_callback_t        callback;   // run from i2c_async_task() once done, may be NULL
+    void*                 context;    // for the callback
+    volatile i2c_status_t status;     // I2C_STATUS_PENDING until done
+    i2c_transaction_t*    next;       // used by the queue
+};
+
+void         i2c_submit(i2c_transaction_t* transaction);
+i2c_status_t i2c_wait(i2c_transaction_t* transaction);
+void         i2c_async_task(void);
+#endif
@@ -0,0 +1,270 @@
+#include "quantum.h"
+#include "serial.h"
+#include "print.h"
+
+#include <ch.h>
+#include <hal.h>
+
+/*
+ * Full duplex split transport on the ChibiOS UART driver, which moves every
+ * frame with DMA. It needs separate TX and RX lines crossed over between the
+ * halves, HAL_USE_UART and UART_USE_WAIT in halconf.h, and the USART enabled
+ * for the UART driver in mcuconf.h.
+ *
+ * A transaction is:
+ *   master: [id]
+ *   slave:  [id ^ HANDSHAKE_MAGIC]                       (slave is ready for the payload)
+ *   master: [initiator2target payload][crc8(id, payload)]
+ *   slave:  [ack][target2initiator payload][crc8(ack, payload)]
+ * where ack is id ^ HANDSHAKE_MAGIC, or its complement if the master's
+ * payload failed the CRC. Each side starts receiving before it sends
+ * whatever the other side answers, so no byte can arrive unexpected.
+ */
+
+#ifndef USE_GPIOV1
+// The default PAL alternate modes are used to signal that the pins are used for USART
+#    ifndef SERIAL_USART_TX_PAL_MODE
+#        define SERIAL_USART_TX_PAL_MODE 7
+#    endif
+#    ifndef SERIAL_USART_RX_PAL_MODE
+#        define SERIAL_USART_RX_PAL_MODE 7
+#    endif
+#endif
+
+#ifndef SERIAL_USART_DRIVER
+#    define SERIAL_USART_DRIVER UARTD1
+#endif
+
+#ifndef SERIAL_USART_CR1
+#    define SERIAL_USART_CR1 0  // 8 bit length, no parity, the frames carry a CRC instead
+#endif
+
+#ifndef SERIAL_USART_CR2
+#    define SERIAL_USART_CR2 0  // 1 stop bit
+#endif
+
+#ifndef SERIAL_USART_CR3
+#    define SERIAL_USART_CR3 0
+#endif
+
+#ifdef SOFT_SERIAL_PIN
+#    define SERIAL_USART_TX_PIN SOFT_SERIAL_PIN
+#endif
+
+#ifndef SERIAL_USART_RX_PIN
+#    error "SERIAL_DRIVER = usart_duplex needs SERIAL_USART_RX_PIN"
+#endif
+
+#ifndef SERIAL_USART_SPEED
+#    define SERIAL_USART_SPEED 1000000
+#endif
+
+#ifndef SERIAL_USART_TIMEOUT
+#    define SERIAL_USART_TIMEOUT 20
+#endif
+
+#define HANDSHAKE_MAGIC 7
+
+// id or ack, a payload of up to 255 bytes and the crc
+static uint8_t serial_tx_frame[1 + 255 + 1];
+static uint8_t serial_rx_frame[1 + 255 + 1];
+
+static BSEMAPHORE_DECL(serial_rx_done, true);
+
+static void serial_rxend_cb(UARTDriver* uartp) {
+    (void)uartp;
+    chSysLockFromISR();
+    chBSemSignalI(&serial_rx_done);
+    chSysUnlockFromISR();
+}
+
+static UARTConfig uart_config = {
+    .txend1_cb = NULL,
+    .txend2_cb = NULL,
+    .rxend_cb  = serial_rxend_cb,
+    .rxchar_cb = NULL,
+    .rxerr_cb  = NULL,
+    .speed     = (SERIAL_USART_SPEED),
+    .cr1       = (SERIAL_USART_CR1),
+    .cr2       = (SERIAL_USART_CR2),
+    .cr3       = (SERIAL_USART_CR3),
+};
+
+// CRC-8, polynomial 0x07
+static uint8_t serial_crc8(uint8_t crc, const uint8_t* data, size_t size) {
+    while (size--) {
+        crc ^= *data++;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static void serial_receive_start(uint8_t* data, size_t size) {
+    chBSemReset(&serial_rx_done, true);
+    uartStartReceive(&SERIAL_USART_DRIVER, size, data);
+}
+
+static bool serial_receive_wait(sysinterval_t timeout) {
+    if (chBSemWaitTimeout(&serial_rx_done, timeout) == MSG_OK) {
+        return true;
+    }
+    uartStopReceive(&SERIAL_USART_DRIVER);
+    return false;
+}
+
+static bool serial_send(const uint8_t* data, size_t size) { return uartSendFullTimeout(&SERIAL_USART_DRIVER, &size, data, TIME_MS2I(SERIAL_USART_TIMEOUT)) == MSG_OK; }
+
+void handle_soft_serial_slave(void);
+
+/*
+ * This thread runs on the slave and responds to transactions initiated
+ * by the master
+ */
+static THD_WORKING_AREA(waSlaveThread, 512);
+static THD_FUNCTION(SlaveThread, arg) {
+    (void)arg;
+    chRegSetThreadName("slave_transport");
+
+    while (true) {
+        handle_soft_serial_slave();
+    }
+}
+
+__attribute__((weak)) void usart_init(void) {
+#if defined(USE_GPIOV1)
+    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_STM32_ALTERNATE_PUSHPULL);
+    palSetLineMode(SERIAL_USART_RX_PIN, PAL_MODE_INPUT_PULLUP);
+#else
+    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_TX_PAL_MODE) | PAL_STM32_OTYPE_PUSHPULL | PAL_STM32_OSPEED_HIGHEST);
+    palSetLineMode(SERIAL_USART_RX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_RX_PAL_MODE) | PAL_STM32_PUPDR_PULLUP);
+#endif
+}
+
+void usart_master_init(void) {
+    usart_init();
+
+    uartStart(&SERIAL_USART_DRIVER, &uart_config);
+}
+
+void usart_slave_init(void) {
+    usart_init();
+
+    uartStart(&SERIAL_USART_DRIVER, &uart_config);
+
+    // Start transport thread
+    chThdCreateStatic(waSlaveThread, sizeof(waSlaveThread), HIGHPRIO, SlaveThread, NULL);
+}
+
+static SSTD_t* Transaction_table      = NULL;
+static uint8_t Transaction_table_size = 0;
+
+void soft_serial_initiator_init(SSTD_t* sstd_table, int sstd_table_size) {
+    Transaction_table      = sstd_table;
+    Transaction_table_size = (uint8_t)sstd_table_size;
+
+    usart_master_init();
+}
+
+void soft_serial_target_init(SSTD_t* sstd_table, int sstd_table_size) {
+    Transaction_table      = sstd_table;
+    Transaction_table_size = (uint8_t)sstd_table_size;
+
+    usart_slave_init();
+}
+
+void handle_soft_serial_slave(void) {
+    uint8_t sstd_index;
+
+    // first chunk is always transaction id
+    serial_receive_start(&sstd_index, sizeof(sstd_index));
+    if (!serial_receive_wait(TIME_INFINITE) || sstd_index >= Transaction_table_size) {
+        return;
+    }
+    SSTD_t* trans = &Transaction_table[sstd_index];
+    uint8_t shake = sstd_index ^ HANDSHAKE_MAGIC;
+
+    // Wait for the payload only once it can't be missed
+    serial_receive_start(serial_rx_frame, trans->initiator2target_buffer_size + 1);
+    serial_send(&shake, sizeof(shake));
+    if (!serial_receive_wait(TIME_MS2I(SERIAL_USART_TIMEOUT))) {
+        return;
+    }
+
+    uint8_t size = trans->initiator2target_buffer_size;
+    bool    ok   = serial_crc8(serial_crc8(0, &sstd_index, 1), serial_rx_frame, size) == serial_rx_frame[size];
+    if (ok && size) {
+        memcpy(trans->initiator2target_buffer, serial_rx_frame, size);
+    }
+
+    size               = trans->target2initiator_buffer_size;
+    serial_tx_frame[0] = ok ? shake : ~shake;
+    if (size) {
+        memcpy(&serial_tx_frame[1], trans->target2initiator_buffer, size);
+    }
+    serial_tx_frame[size + 1] = serial_crc8(0, serial_tx_frame, size + 1);
+    serial_send(serial_tx_frame, size + 2);
+
+    if (trans->status) {
+        *trans->status = ok ? TRANSACTION_ACCEPTED : TRANSACTION_DATA_ERROR;
+    }
+}
+
+/////////
+//  start transaction by initiator
+//
+// int  soft_serial_transaction(int sstd_index)
+//
+// Returns:
+//    TRANSACTION_END
+//    TRANSACTION_NO_RESPONSE
+//    TRANSACTION_DATA_ERROR
+#ifndef SERIAL_USE_MULTI_TRANSACTION
+int soft_serial_transaction(void) {
+    uint8_t sstd_index = 0;
+#else
+int soft_serial_transaction(int index) {
+    uint8_t sstd_index = index;
+#endif
+
+    if (sstd_index >= Transaction_table_size) return TRANSACTION_TYPE_ERROR;
+    SSTD_t* trans = &Transaction_table[sstd_index];
+    uint8_t shake = sstd_index ^ HANDSHAKE_MAGIC;
+
+    // First chunk is always transaction id, which the slave echoes back once it is ready for the payload
+    uint8_t sstd_index_shake = 0xFF;
+    serial_receive_start(&sstd_index_shake, sizeof(sstd_index_shake));
+    bool ok = serial_send(&sstd_index, sizeof(sstd_index));
+    ok      = serial_receive_wait(TIME_MS2I(SERIAL_USART_TIMEOUT)) && ok;
+    if (!ok || sstd_index_shake != shake) {
+        dprintf("serial::usart_shake NO_RESPONSE\n");
+        return TRANSACTION_NO_RESPONSE;
+    }
+
+    uint8_t size = trans->initiator2target_buffer_size;
+    if (size) {
+        memcpy(serial_tx_frame, trans->initiator2target_buffer, size);
+    }
+    serial_tx_frame[size] = serial_crc8(serial_crc8(0, &sstd_index, 1), serial_tx_frame, size);
+
+    // Listen for the reply before the payload goes out, the slave answers as soon as it has it
+    serial_receive_start(serial_rx_frame, trans->target2initiator_buffer_size + 2);
+    ok   = serial_send(serial_tx_frame, size + 1);
+    ok   = serial_receive_wait(TIME_MS2I(SERIAL_USART_TIMEOUT)) && ok;
+    size = trans->target2initiator_buffer_size;
+    if (!ok) {
+        dprintf("serial::usart_transmit NO_RESPONSE\n");
+        return TRANSACTION_NO_RESPONSE;
+    }
+
+    if (serial_rx_frame[0] != shake || serial_crc8(0, serial_rx_frame, size + 1) != serial_rx_frame[size + 1]) {
+        dprintf("serial::usart_receive DATA_ERROR\n");
+        return TRANSACTION_DATA_ERROR;
+    }
+    if (size) {
+        memcpy(trans->target2initiator_buffer, &serial_rx_frame[1], size);
+    }
+
+    return TRANSACTION_END;
+}
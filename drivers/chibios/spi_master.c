@@ -44,7 +44,7 @@ __attribute__((weak)) void spi_init(void) {
     }
 }
 
-bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
+static bool spi_select(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
     if (currentSlavePin != NO_PIN || slavePin == NO_PIN) {
         return false;
     }
@@ -115,6 +115,151 @@ bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
     return true;
 }
 
+static void spi_unselect(void) {
+    spiUnselect(&SPI_DRIVER);
+    spiStop(&SPI_DRIVER);
+    currentSlavePin = NO_PIN;
+}
+
+#ifdef SPI_ASYNC
+/* Transactions are run one at a time by a thread of their own, which sleeps
+ * while the DMA moves the data, so the main loop carries on in the meantime.
+ * The blocking functions share the bus with it: spi_start() waits for the
+ * transaction in progress, and holds the bus off the thread until spi_stop(). */
+static spi_transaction_t *queue_head;  // submitted, run in order
+static spi_transaction_t *queue_tail;
+static spi_transaction_t *done_head;  // completed, callbacks still to run
+static spi_transaction_t *done_tail;
+static semaphore_t        queue_count;
+static semaphore_t        bus_free;
+static binary_semaphore_t transaction_done;
+static thread_t *         spi_thread       = NULL;
+static bool               blocking_started = false;  // by spi_start(), on the main loop
+
+static THD_WORKING_AREA(spi_thread_wa, SPI_ASYNC_STACK_SIZE);
+
+static THD_FUNCTION(spi_thread_main, arg) {
+    (void)arg;
+    chRegSetThreadName("spi");
+
+    while (true) {
+        chSemWait(&queue_count);
+
+        chSysLock();
+        spi_transaction_t *transaction = queue_head;
+        queue_head                     = transaction->next;
+        if (!queue_head) {
+            queue_tail = NULL;
+        }
+        chSysUnlock();
+
+        spi_status_t status = SPI_STATUS_ERROR;
+        chSemWait(&bus_free);
+        if (spi_select(transaction->slave_pin, transaction->lsb_first, transaction->mode, transaction->divisor)) {
+            if (transaction->tx && transaction->rx) {
+                spiExchange(&SPI_DRIVER, transaction->length, transaction->tx, transaction->rx);
+            } else if (transaction->tx) {
+                spiSend(&SPI_DRIVER, transaction->length, transaction->tx);
+            } else {
+                spiReceive(&SPI_DRIVER, transaction->length, transaction->rx);
+            }
+            spi_unselect();
+            status = SPI_STATUS_SUCCESS;
+        }
+        chSemSignal(&bus_free);
+
+        chSysLock();
+        transaction->next = NULL;
+        if (transaction->callback) {
+            if (done_tail) {
+                done_tail->next = transaction;
+            } else {
+                done_head = transaction;
+            }
+            done_tail = transaction;
+        }
+        transaction->status = status;
+        chBSemSignalI(&transaction_done);
+        chSchRescheduleS();
+        chSysUnlock();
+    }
+}
+
+static void spi_async_init(void) {
+    if (!spi_thread) {
+        chSemObjectInit(&queue_count, 0);
+        chSemObjectInit(&bus_free, 1);
+        chBSemObjectInit(&transaction_done, true);
+        spi_thread = chThdCreateStatic(spi_thread_wa, sizeof(spi_thread_wa), NORMALPRIO + 1, spi_thread_main, NULL);
+    }
+}
+
+/** \brief Queues a transaction
+ *
+ * The transaction must stay valid until its status is no longer SPI_STATUS_PENDING. Its buffers are handed to the
+ * DMA as they are, without being copied.
+ */
+void spi_submit(spi_transaction_t *transaction) {
+    spi_async_init();
+
+    transaction->status = SPI_STATUS_PENDING;
+    transaction->next   = NULL;
+
+    chSysLock();
+    if (queue_tail) {
+        queue_tail->next = transaction;
+    } else {
+        queue_head = transaction;
+    }
+    queue_tail = transaction;
+    chSemSignalI(&queue_count);
+    chSchRescheduleS();
+    chSysUnlock();
+}
+
+/** \brief Waits for a transaction to complete
+ */
+spi_status_t spi_wait(spi_transaction_t *transaction) {
+    while (transaction->status == SPI_STATUS_PENDING) {
+        chBSemWaitTimeout(&transaction_done, TIME_MS2I(1));
+    }
+    return transaction->status;
+}
+
+/** \brief Runs the callbacks of the completed transactions, called from the main loop
+ */
+void spi_async_task(void) {
+    while (done_head) {
+        chSysLock();
+        spi_transaction_t *transaction = done_head;
+        done_head                      = transaction->next;
+        if (!done_head) {
+            done_tail = NULL;
+        }
+        chSysUnlock();
+
+        transaction->callback(transaction);
+    }
+}
+
+bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
+    if (blocking_started) {
+        return false;
+    }
+
+    spi_async_init();
+    chSemWait(&bus_free);
+    if (!spi_select(slavePin, lsbFirst, mode, divisor)) {
+        chSemSignal(&bus_free);
+        return false;
+    }
+    blocking_started = true;
+    return true;
+}
+#else
+bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) { return spi_select(slavePin, lsbFirst, mode, divisor); }
+#endif
+
 spi_status_t spi_write(uint8_t data) {
     uint8_t rxData;
     spiExchange(&SPI_DRIVER, 1, &data, &rxData);
@@ -139,10 +284,21 @@ spi_status_t spi_receive(uint8_t *data, uint16_t length) {
     return SPI_STATUS_SUCCESS;
 }
 
+spi_status_t spi_transceive(const uint8_t *tx, uint8_t *rx, uint16_t length) {
+    spiExchange(&SPI_DRIVER, length, tx, rx);
+    return SPI_STATUS_SUCCESS;
+}
+
 void spi_stop(void) {
+#ifdef SPI_ASYNC
+    if (blocking_started) {
+        spi_unselect();
+        blocking_started = false;
+        chSemSignal(&bus_free);
+    }
+#else
     if (currentSlavePin != NO_PIN) {
-        spiUnselect(&SPI_DRIVER);
-        spiStop(&SPI_DRIVER);
-        currentSlavePin = NO_PIN;
+        spi_unselect();
     }
+#endif
 }
@@ -57,6 +57,32 @@ typedef int16_t spi_status_t;
 #define SPI_TIMEOUT_IMMEDIATE (0)
 #define SPI_TIMEOUT_INFINITE (0xFFFF)
 
+#ifdef SPI_ASYNC
+#    ifndef SPI_ASYNC_STACK_SIZE
+#        define SPI_ASYNC_STACK_SIZE 256
+#    endif
+
+#    define SPI_STATUS_PENDING (-3)
+
+typedef struct spi_transaction spi_transaction_t;
+typedef void (*spi_callback_t)(spi_transaction_t *transaction);
+
+/* One transfer with its chip select asserted throughout. */
+struct spi_transaction {
+    pin_t                 slave_pin;  // chip select, as with spi_start()
+    bool                  lsb_first;
+    uint8_t               mode;
+    uint16_t              divisor;
+    const uint8_t *       tx;        // NULL to only receive
+    uint8_t *             rx;        // NULL to only transmit
+    uint16_t              length;    // of tx and rx both
+    spi_callback_t        callback;  // run from spi_async_task() once done, may be NULL
+    void *                context;   // for the callback
+    volatile spi_status_t status;    // SPI_STATUS_PENDING until done
+    spi_transaction_t *   next;      // used by the queue
+};
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -72,7 +98,17 @@ spi_status_t spi_transmit(const uint8_t *data, uint16_t length);
 
 spi_status_t spi_receive(uint8_t *data, uint16_t length);
 
+spi_status_t spi_transceive(const uint8_t *tx, uint8_t *rx, uint16_t length);
+
 void spi_stop(void);
+
+#ifdef SPI_ASYNC
+void spi_submit(spi_transaction_t *transaction);
+
+spi_status_t spi_wait(spi_transaction_t *transaction);
+
+void spi_async_task(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
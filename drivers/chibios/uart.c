@@ -41,6 +41,15 @@ void uart_init(uint32_t baud) {
 
 void uart_putchar(uint8_t c) { sdPut(&SERIAL_DRIVER, c); }
 
+bool uart_try_putchar(uint8_t c) { return sdPutTimeout(&SERIAL_DRIVER, c, TIME_IMMEDIATE) == MSG_OK; }
+
+// The serial driver's queues are filled and drained by its interrupt, a batch takes the lock once
+uint16_t uart_write(const uint8_t *data, uint16_t length) { return sdWriteTimeout(&SERIAL_DRIVER, data, length, TIME_IMMEDIATE); }
+
+void uart_transmit(const uint8_t *data, uint16_t length) { sdWrite(&SERIAL_DRIVER, data, length); }
+
+uint16_t uart_read(uint8_t *data, uint16_t length) { return sdReadTimeout(&SERIAL_DRIVER, data, length, TIME_IMMEDIATE); }
+
 uint8_t uart_getchar(void) {
     msg_t res = sdGet(&SERIAL_DRIVER);
 
@@ -72,6 +72,17 @@ void uart_init(uint32_t baud);
 
 void uart_putchar(uint8_t c);
 
+bool uart_try_putchar(uint8_t c);
+
+// Queues up to length bytes for transmission without waiting, returns how many were queued
+uint16_t uart_write(const uint8_t *data, uint16_t length);
+
+// Queues all length bytes for transmission, waiting for room as needed
+void uart_transmit(const uint8_t *data, uint16_t length);
+
+// Takes up to length received bytes without waiting, returns how many were taken
+uint16_t uart_read(uint8_t *data, uint16_t length);
+
 uint8_t uart_getchar(void);
 
 bool uart_available(void);
@@ -84,10 +84,11 @@ void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
         s_init = true;
     }
 
-    // this code is very time dependent, so we need to disable interrupts
-    chSysLock();
-
     for (uint8_t i = 0; i < leds; i++) {
+        // this code is very time dependent, so we need to disable interrupts. Only do so one LED
+        // at a time: the line idles low in between, well short of the reset time, and USB and
+        // serial interrupts don't have to wait for the whole strip.
+        chSysLock();
         // WS2812 protocol dictates grb order
 #if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
         sendByte(ledarray[i].g);
@@ -106,9 +107,16 @@ void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
 #ifdef RGBW
         sendByte(ledarray[i].w);
 #endif
+        chSysUnlock();
     }
 
+    // the latch only needs the line to stay low, no need to block interrupts for it
     wait_ns(RES);
+}
 
-    chSysUnlock();
+void ws2812_setleds_async(LED_TYPE *ledarray, uint16_t leds, ws2812_callback_t callback) {
+    ws2812_setleds(ledarray, leds);
+    if (callback) {
+        callback();
+    }
 }
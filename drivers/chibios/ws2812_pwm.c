@@ -63,6 +63,13 @@
 #define WS2812_COLOR_BIT_N (RGBLED_NUM * 24)                   /**< Number of data bits */
 #define WS2812_BIT_N (WS2812_COLOR_BIT_N + WS2812_RESET_BIT_N) /**< Total number of bits in a frame */
 
+#ifdef WS2812_PWM_STREAM
+#    ifndef WS2812_PWM_STREAM_LEDS
+#        define WS2812_PWM_STREAM_LEDS 4
+#    endif
+#    define WS2812_STREAM_HALF_N (WS2812_PWM_STREAM_LEDS * 24) /**< Number of bits in each half of the stream buffer */
+#endif
+
 /**
  * @brief   High period for a zero, in ticks
  *
@@ -221,7 +228,25 @@
 
 /* --- PRIVATE VARIABLES ---------------------------------------------------- */
 
+#ifdef WS2812_PWM_STREAM
+/*
+ * Instead of the duty cycles of a whole frame, the circular DMA goes round a
+ * buffer of a few LEDs' worth. Each half is refilled from the colors while the
+ * DMA sends the other one, and the DMA is stopped once the reset period has
+ * gone out. The colors are double buffered like the SPI driver's frames.
+ */
+static uint32_t                   ws2812_frame_buffer[2 * WS2812_STREAM_HALF_N]; /**< Circular buffer for part of a frame */
+static LED_TYPE                   stream_leds[2][RGBLED_NUM];
+static volatile uint8_t           stream_front   = 0;      // colors being sent
+static volatile bool              stream_busy    = false;  // a frame is being sent
+static volatile bool              stream_pending = false;  // the back colors hold a frame to send next
+static volatile ws2812_callback_t stream_callback[2] = {NULL, NULL};
+static uint16_t                   stream_pos;     // next bit of the frame to go into the buffer
+static uint8_t                    stream_byte;    // rest of the color byte stream_pos is in
+static bool                       stream_idle[2]; // the half only holds what comes after the frame
+#else
 static uint32_t ws2812_frame_buffer[WS2812_BIT_N + 1]; /**< Buffer for a frame */
+#endif
 
 /* --- PUBLIC FUNCTIONS ----------------------------------------------------- */
 /*
@@ -230,11 +255,105 @@ the memory (while the DMA is reading/writing from/to a buffer, the application c
 write/read to/from the other buffer).
  */
 
+#ifdef WS2812_PWM_STREAM
+// The byte of the frame's color data with the given index, in the order the LEDs expect
+static uint8_t ws2812_stream_byte(const LED_TYPE* leds, uint16_t index) {
+    const LED_TYPE* led = &leds[index / 3];
+    switch (index % 3) {
+#    if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
+        case 0:
+            return led->g;
+        case 1:
+            return led->r;
+        default:
+            return led->b;
+#    elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_RGB)
+        case 0:
+            return led->r;
+        case 1:
+            return led->g;
+        default:
+            return led->b;
+#    elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_BGR)
+        case 0:
+            return led->b;
+        case 1:
+            return led->g;
+        default:
+            return led->r;
+#    endif
+    }
+}
+
+// Fills one half of the buffer with the next bits of the frame, then with zeros
+static void ws2812_stream_fill(uint8_t half) {
+    const LED_TYPE* leds = stream_leds[stream_front];
+    uint32_t*       dest = &ws2812_frame_buffer[half * WS2812_STREAM_HALF_N];
+
+    stream_idle[half] = stream_pos >= WS2812_BIT_N;
+    for (uint16_t i = 0; i < WS2812_STREAM_HALF_N; i++) {
+        if (stream_pos < WS2812_COLOR_BIT_N) {
+            if (stream_pos % 8 == 0) {
+                stream_byte = ws2812_stream_byte(leds, stream_pos / 8);
+            }
+            dest[i] = (stream_byte & 0x80) ? WS2812_DUTYCYCLE_1 : WS2812_DUTYCYCLE_0;
+            stream_byte <<= 1;
+        } else {
+            dest[i] = 0;
+        }
+        if (stream_pos < WS2812_BIT_N) {
+            stream_pos++;
+        }
+    }
+}
+
+// Called with the system locked, sends the front colors
+static void ws2812_stream_start(void) {
+    stream_busy = true;
+    stream_pos  = 0;
+    ws2812_stream_fill(0);
+    ws2812_stream_fill(1);
+    dmaStreamSetMemory0(WS2812_DMA_STREAM, ws2812_frame_buffer);
+    dmaStreamSetTransactionSize(WS2812_DMA_STREAM, 2 * WS2812_STREAM_HALF_N);
+    dmaStreamEnable(WS2812_DMA_STREAM);
+}
+
+// Runs in interrupt context each time the DMA is done with a half of the buffer
+static void ws2812_stream_cb(void* param, uint32_t flags) {
+    (void)param;
+    uint8_t           half     = (flags & STM32_DMA_ISR_TCIF) ? 1 : 0;
+    ws2812_callback_t callback = NULL;
+
+    chSysLockFromISR();
+    if (!stream_idle[half]) {
+        ws2812_stream_fill(half);
+    } else {
+        // The whole reset period has gone out, the output stays low from here on
+        dmaStreamDisable(WS2812_DMA_STREAM);
+        callback                      = stream_callback[stream_front];
+        stream_callback[stream_front] = NULL;
+        stream_busy                   = false;
+        if (stream_pending) {
+            stream_pending = false;
+            stream_front ^= 1;
+            ws2812_stream_start();
+        }
+    }
+    chSysUnlockFromISR();
+
+    if (callback) {
+        callback();
+    }
+}
+#endif
+
 void ws2812_init(void) {
+#ifndef WS2812_PWM_STREAM
     // Initialize led frame buffer
     uint32_t i;
     for (i = 0; i < WS2812_COLOR_BIT_N; i++) ws2812_frame_buffer[i] = WS2812_DUTYCYCLE_0;      // All color bits are zero duty cycle
     for (i = 0; i < WS2812_RESET_BIT_N; i++) ws2812_frame_buffer[i + WS2812_COLOR_BIT_N] = 0;  // All reset bits are zero
+#endif
 
     palSetLineMode(RGB_DI_PIN, WS2812_OUTPUT_MODE);
 
@@ -256,11 +375,17 @@ void ws2812_init(void) {
 
     // Configure DMA
     // dmaInit(); // Joe added this
+#ifdef WS2812_PWM_STREAM
+    dmaStreamAlloc(WS2812_DMA_STREAM - STM32_DMA_STREAM(0), 10, ws2812_stream_cb, NULL);
+    dmaStreamSetPeripheral(WS2812_DMA_STREAM, &(WS2812_PWM_DRIVER.tim->CCR[WS2812_PWM_CHANNEL - 1]));
+    dmaStreamSetMode(WS2812_DMA_STREAM, STM32_DMA_CR_CHSEL(WS2812_DMA_CHANNEL) | STM32_DMA_CR_DIR_M2P | STM32_DMA_CR_PSIZE_WORD | STM32_DMA_CR_MSIZE_WORD | STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC | STM32_DMA_CR_PL(3) | STM32_DMA_CR_HTIE | STM32_DMA_CR_TCIE);
+#else
     dmaStreamAlloc(WS2812_DMA_STREAM - STM32_DMA_STREAM(0), 10, NULL, NULL);
     dmaStreamSetPeripheral(WS2812_DMA_STREAM, &(WS2812_PWM_DRIVER.tim->CCR[WS2812_PWM_CHANNEL - 1]));  // Ziel ist der An-Zeit im Cap-Comp-Register
     dmaStreamSetMemory0(WS2812_DMA_STREAM, ws2812_frame_buffer);
     dmaStreamSetTransactionSize(WS2812_DMA_STREAM, WS2812_BIT_N);
     dmaStreamSetMode(WS2812_DMA_STREAM, STM32_DMA_CR_CHSEL(WS2812_DMA_CHANNEL) | STM32_DMA_CR_DIR_M2P | STM32_DMA_CR_PSIZE_WORD | STM32_DMA_CR_MSIZE_WORD | STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC | STM32_DMA_CR_PL(3));
+#endif
     // M2P: Memory 2 Periph; PL: Priority Level
 
 #if (STM32_DMA_SUPPORTS_DMAMUX == TRUE)
@@ -268,8 +393,10 @@ void ws2812_init(void) {
     dmaSetRequestSource(WS2812_DMA_STREAM, WS2812_DMAMUX_ID);
 #endif
 
-    // Start DMA
+#ifndef WS2812_PWM_STREAM
+    // Start DMA, in stream mode it only runs while a frame is being sent
     dmaStreamEnable(WS2812_DMA_STREAM);
+#endif
 
     // Configure PWM
     // NOTE: It's required that preload be enabled on the timer channel CCR register. This is currently enabled in the
@@ -279,6 +406,39 @@ void ws2812_init(void) {
     pwmEnableChannel(&WS2812_PWM_DRIVER, WS2812_PWM_CHANNEL - 1, 0);  // Initial period is 0; output will be low until first duty cycle is DMA'd in
 }
 
+#ifdef WS2812_PWM_STREAM
+void ws2812_setleds_async(LED_TYPE* ledarray, uint16_t leds, ws2812_callback_t callback) {
+    static bool s_init = false;
+    if (!s_init) {
+        ws2812_init();
+        s_init = true;
+    }
+
+    // Take the back colors away from the interrupt before touching them
+    chSysLock();
+    stream_pending = false;
+    uint8_t back   = stream_front ^ 1;
+    chSysUnlock();
+
+    // LEDs past the end of ledarray keep the colors they were last sent
+    for (uint16_t i = 0; i < RGBLED_NUM; i++) {
+        stream_leds[back][i] = i < leds ? ledarray[i] : stream_leds[back ^ 1][i];
+    }
+    stream_callback[back] = callback;
+
+    // Send now if the DMA is idle, otherwise the end of the current frame picks it up
+    chSysLock();
+    if (stream_busy) {
+        stream_pending = true;
+    } else {
+        stream_front = back;
+        ws2812_stream_start();
+    }
+    chSysUnlock();
+}
+
+void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) { ws2812_setleds_async(ledarray, leds, NULL); }
+#else
 void ws2812_write_led(uint16_t led_number, uint8_t r, uint8_t g, uint8_t b) {
     // Write color to frame buffer
     for (uint8_t bit = 0; bit < 8; bit++) {
@@ -300,3 +460,13 @@ void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
         ws2812_write_led(i, ledarray[i].r, ledarray[i].g, ledarray[i].b);
     }
 }
+
+// The frame buffer is streamed continuously by the circular DMA, so the new colors go out with
+// the next frame without waiting for anything.
+void ws2812_setleds_async(LED_TYPE* ledarray, uint16_t leds, ws2812_callback_t callback) {
+    ws2812_setleds(ledarray, leds);
+    if (callback) {
+        callback();
+    }
+}
+#endif
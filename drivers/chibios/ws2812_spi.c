@@ -39,50 +39,83 @@
 #define RESET_SIZE (1000 * WS2812_TRST_US / (2 * 1250))
 #define PREAMBLE_SIZE 4
 
-static uint8_t txbuf[PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE] = {0};
+#define TXBUF_SIZE (PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE)
+
+// Double buffered, so the next frame can be encoded while the DMA sends the current one
+static uint8_t                    txbuf[2][TXBUF_SIZE] = {{0}};
+static volatile uint8_t           tx_front             = 0;      // buffer owned by the DMA
+static volatile bool              tx_busy              = false;  // a transfer is in progress
+static volatile bool              tx_pending           = false;  // the back buffer holds a frame to send next
+static volatile ws2812_callback_t tx_callback[2]       = {NULL, NULL};
 
 /*
  * As the trick here is to use the SPI to send a huge pattern of 0 and 1 to
- * the ws2812b protocol, we use this helper function to translate bytes into
- * 0s and 1s for the LED (with the appropriate timing).
+ * the ws2812b protocol, every two bits of a colour byte become one SPI byte,
+ * each bit a nibble of 0b1000 for a 0 or 0b1110 for a 1 (with the appropriate
+ * timing). Indexed by a nibble of colour, the two SPI bytes it becomes.
  */
-static uint8_t get_protocol_eq(uint8_t data, int pos) {
-    uint8_t eq = 0;
-    if (data & (1 << (2 * (3 - pos))))
-        eq = 0b1110;
-    else
-        eq = 0b1000;
-    if (data & (2 << (2 * (3 - pos))))
-        eq += 0b11100000;
-    else
-        eq += 0b10000000;
-    return eq;
+// clang-format off
+static const uint8_t protocol_eq[16][2] = {
+    {0x88, 0x88}, {0x88, 0x8E}, {0x88, 0xE8}, {0x88, 0xEE},
+    {0x8E, 0x88}, {0x8E, 0x8E}, {0x8E, 0xE8}, {0x8E, 0xEE},
+    {0xE8, 0x88}, {0xE8, 0x8E}, {0xE8, 0xE8}, {0xE8, 0xEE},
+    {0xEE, 0x88}, {0xEE, 0x8E}, {0xEE, 0xE8}, {0xEE, 0xEE},
+};
+// clang-format on
+
+static inline void set_led_byte(uint8_t* dest, uint8_t data) {
+    const uint8_t* high = protocol_eq[data >> 4];
+    const uint8_t* low  = protocol_eq[data & 0x0F];
+    dest[0]             = high[0];
+    dest[1]             = high[1];
+    dest[2]             = low[0];
+    dest[3]             = low[1];
 }
 
-static void set_led_color_rgb(LED_TYPE color, int pos) {
-    uint8_t* tx_start = &txbuf[PREAMBLE_SIZE];
+static void set_led_color_rgb(uint8_t* buf, LED_TYPE color, int pos) {
+    uint8_t* tx_start = &buf[PREAMBLE_SIZE + BYTES_FOR_LED * pos];
 
 #if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
+    set_led_byte(&tx_start[0], color.g);
+    set_led_byte(&tx_start[BYTES_FOR_LED_BYTE], color.r);
+    set_led_byte(&tx_start[BYTES_FOR_LED_BYTE * 2], color.b);
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_RGB)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
+    set_led_byte(&tx_start[0], color.r);
+    set_led_byte(&tx_start[BYTES_FOR_LED_BYTE], color.g);
+    set_led_byte(&tx_start[BYTES_FOR_LED_BYTE * 2], color.b);
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_BGR)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.b, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.r, j);
+    set_led_byte(&tx_start[0], color.b);
+    set_led_byte(&tx_start[BYTES_FOR_LED_BYTE], color.g);
+    set_led_byte(&tx_start[BYTES_FOR_LED_BYTE * 2], color.r);
 #endif
 }
 
+// Runs in interrupt context once a frame has been sent
+static void ws2812_spi_end_cb(SPIDriver* spip) {
+    ws2812_callback_t callback = tx_callback[tx_front];
+    tx_callback[tx_front]      = NULL;
+
+    chSysLockFromISR();
+    if (tx_pending) {
+        tx_pending = false;
+        tx_front ^= 1;
+        spiStartSendI(spip, TXBUF_SIZE, txbuf[tx_front]);
+    } else {
+        tx_busy = false;
+    }
+    chSysUnlockFromISR();
+
+    if (callback) {
+        callback();
+    }
+}
+
 void ws2812_init(void) {
     palSetLineMode(RGB_DI_PIN, WS2812_OUTPUT_MODE);
 
     // TODO: more dynamic baudrate
     static const SPIConfig spicfg = {
-        0, NULL, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN),
+        0, ws2812_spi_end_cb, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN),
         SPI_CR1_BR_1 | SPI_CR1_BR_0  // baudrate : fpclk / 8 => 1tick is 0.32us (2.25 MHz)
     };
 
@@ -91,22 +124,43 @@ void ws2812_init(void) {
     spiSelect(&WS2812_SPI);         /* Slave Select assertion.          */
 }
 
-void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
+void ws2812_setleds_async(LED_TYPE* ledarray, uint16_t leds, ws2812_callback_t callback) {
     static bool s_init = false;
     if (!s_init) {
         ws2812_init();
         s_init = true;
     }
 
+    // Take the back buffer away from the interrupt before touching it
+    chSysLock();
+    tx_pending   = false;
+    uint8_t back = tx_front ^ 1;
+    chSysUnlock();
+
     for (uint8_t i = 0; i < leds; i++) {
-        set_led_color_rgb(ledarray[i], i);
+        set_led_color_rgb(txbuf[back], ledarray[i], i);
+    }
+    tx_callback[back] = callback;
+
+    // Send now if the bus is idle, otherwise the end of the current transfer picks it up
+    chSysLock();
+    if (tx_busy) {
+        tx_pending = true;
+    } else {
+        tx_busy  = true;
+        tx_front = back;
+        spiStartSendI(&WS2812_SPI, TXBUF_SIZE, txbuf[back]);
     }
+    chSysUnlock();
+}
 
-    // Send async - each led takes ~0.03ms, 50 leds ~1.5ms, animations flushing faster than send will cause issues.
-    // Instead spiSend can be used to send synchronously (or the thread logic can be added back).
+void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
+    ws2812_setleds_async(ledarray, leds, NULL);
+
+    // Each led takes ~0.03ms, 50 leds ~1.5ms. With WS2812_SPI_SYNC, wait for the frame to go out
 #ifdef WS2812_SPI_SYNC
-    spiSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
-#else
-    spiStartSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    while (tx_busy) {
+        chThdYield();
+    }
 #endif
 }
@@ -19,6 +19,149 @@
 
 #include "eeprom_driver.h"
 
+static uint32_t backend_writes;
+
+static void eeprom_backend_write(const void *buf, void *addr, size_t len) {
+    backend_writes++;
+    eeprom_driver_write_block(buf, addr, len);
+}
+
+uint32_t eeprom_driver_get_writes(void) { return backend_writes; }
+
+__attribute__((weak)) bool eeprom_driver_busy(void) { return false; }
+
+#ifdef EEPROM_WRITE_BACK
+#    include "timer.h"
+
+#    ifndef EEPROM_WRITE_BACK_LINES
+#        define EEPROM_WRITE_BACK_LINES 4
+#    endif
+#    ifndef EEPROM_WRITE_BACK_LINE_SIZE
+#        define EEPROM_WRITE_BACK_LINE_SIZE 16
+#    endif
+#    ifndef EEPROM_WRITE_BACK_DELAY
+#        define EEPROM_WRITE_BACK_DELAY 500
+#    endif
+
+#    if EEPROM_WRITE_BACK_LINE_SIZE > 32 || (EEPROM_WRITE_BACK_LINE_SIZE & (EEPROM_WRITE_BACK_LINE_SIZE - 1)) != 0
+#        error "EEPROM_WRITE_BACK_LINE_SIZE must be a power of two no larger than 32"
+#    endif
+
+// An aligned run of EEPROM bytes, with a bit set in dirty for each byte that still has to be written
+typedef struct {
+    uintptr_t base;
+    uint32_t  dirty;
+    uint8_t   data[EEPROM_WRITE_BACK_LINE_SIZE];
+} eeprom_write_back_line_t;
+
+static eeprom_write_back_line_t write_back_lines[EEPROM_WRITE_BACK_LINES];
+static uint16_t                 write_back_last_write;
+
+// Writes the first run of dirty bytes to the backend as one block, which never crosses the line, false if there is none
+static bool eeprom_write_back_run(void) {
+    for (uint8_t i = 0; i < EEPROM_WRITE_BACK_LINES; i++) {
+        eeprom_write_back_line_t *line = &write_back_lines[i];
+        if (!line->dirty) {
+            continue;
+        }
+        uint8_t start = 0;
+        while (!(line->dirty & (1UL << start))) start++;
+        uint8_t end = start;
+        while (end < EEPROM_WRITE_BACK_LINE_SIZE && (line->dirty & (1UL << end))) {
+            line->dirty &= ~(1UL << end);
+            end++;
+        }
+        eeprom_backend_write(&line->data[start], (void *)(line->base + start), end - start);
+        return true;
+    }
+    return false;
+}
+
+void eeprom_driver_flush(void) {
+    while (eeprom_write_back_run()) {
+    }
+}
+
+void eeprom_driver_discard(void) {
+    for (uint8_t i = 0; i < EEPROM_WRITE_BACK_LINES; i++) {
+        write_back_lines[i].dirty = 0;
+    }
+}
+
+uint16_t eeprom_driver_get_pending(void) {
+    uint16_t pending = 0;
+    for (uint8_t i = 0; i < EEPROM_WRITE_BACK_LINES; i++) {
+        for (uint32_t dirty = write_back_lines[i].dirty; dirty; dirty &= dirty - 1) {
+            pending++;
+        }
+    }
+    return pending;
+}
+
+void eeprom_driver_task(void) {
+    // One run per call, and only once the backend is done with the previous one, so the scan never waits on the EEPROM
+    if (timer_elapsed(write_back_last_write) >= EEPROM_WRITE_BACK_DELAY && !eeprom_driver_busy()) {
+        eeprom_write_back_run();
+    }
+}
+
+static eeprom_write_back_line_t *eeprom_write_back_line(uintptr_t base) {
+    eeprom_write_back_line_t *free_line = NULL;
+    for (uint8_t i = 0; i < EEPROM_WRITE_BACK_LINES; i++) {
+        if (write_back_lines[i].dirty) {
+            if (write_back_lines[i].base == base) {
+                return &write_back_lines[i];
+            }
+        } else if (!free_line) {
+            free_line = &write_back_lines[i];
+        }
+    }
+    if (!free_line) {
+        // Every line holds something else, write them all out together
+        eeprom_driver_flush();
+        free_line = &write_back_lines[0];
+    }
+    free_line->base = base;
+    return free_line;
+}
+
+void eeprom_read_block(void *buf, const void *addr, size_t len) {
+    eeprom_driver_read_block(buf, addr, len);
+
+    // Bytes that have not been written back yet are newer than what the backend has
+    uintptr_t start = (uintptr_t)addr;
+    for (uint8_t i = 0; i < EEPROM_WRITE_BACK_LINES; i++) {
+        eeprom_write_back_line_t *line = &write_back_lines[i];
+        if (!line->dirty || line->base + EEPROM_WRITE_BACK_LINE_SIZE <= start || line->base >= start + len) {
+            continue;
+        }
+        for (uint8_t j = 0; j < EEPROM_WRITE_BACK_LINE_SIZE; j++) {
+            uintptr_t a = line->base + j;
+            if ((line->dirty & (1UL << j)) && a >= start && a < start + len) {
+                ((uint8_t *)buf)[a - start] = line->data[j];
+            }
+        }
+    }
+}
+
+void eeprom_write_block(const void *buf, void *addr, size_t len) {
+    const uint8_t *src = (const uint8_t *)buf;
+    uintptr_t      a   = (uintptr_t)addr;
+    while (len--) {
+        eeprom_write_back_line_t *line   = eeprom_write_back_line(a & ~(uintptr_t)(EEPROM_WRITE_BACK_LINE_SIZE - 1));
+        uint8_t                   offset = a & (EEPROM_WRITE_BACK_LINE_SIZE - 1);
+        line->data[offset]               = *src++;
+        line->dirty |= 1UL << offset;
+        a++;
+    }
+    write_back_last_write = timer_read();
+}
+#else
+void eeprom_read_block(void *buf, const void *addr, size_t len) { eeprom_driver_read_block(buf, addr, len); }
+
+void eeprom_write_block(const void *buf, void *addr, size_t len) { eeprom_backend_write(buf, addr, len); }
+#endif
+
 uint8_t eeprom_read_byte(const uint8_t *addr) {
     uint8_t ret = 0;
     eeprom_read_block(&ret, addr, 1);
@@ -46,8 +189,25 @@ void eeprom_write_dword(uint32_t *addr, uint32_t value) { eeprom_write_block(&va
 void eeprom_update_block(const void *buf, void *addr, size_t len) {
     uint8_t read_buf[len];
     eeprom_read_block(read_buf, addr, len);
-    if (memcmp(buf, read_buf, len) != 0) {
-        eeprom_write_block(buf, addr, len);
+
+    // Only the runs that actually changed are written, so a large block with a few changes costs a few page writes.
+    // Runs separated by just a few unchanged bytes are written together.
+    const uint8_t *src = (const uint8_t *)buf;
+    size_t         i   = 0;
+    while (i < len) {
+        if (src[i] == read_buf[i]) {
+            i++;
+            continue;
+        }
+        size_t start = i;
+        size_t end   = i + 1;
+        for (i = end; i < len && i < end + 4; i++) {
+            if (src[i] != read_buf[i]) {
+                end = i + 1;
+            }
+        }
+        eeprom_write_block(&src[start], (uint8_t *)addr + start, end - start);
+        i = end;
     }
 }
 
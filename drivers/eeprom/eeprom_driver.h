@@ -16,7 +16,34 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include "eeprom.h"
 
 void eeprom_driver_init(void);
 void eeprom_driver_erase(void);
+
+// Implemented by the backend, eeprom_read_block() and eeprom_write_block() go through these
+void eeprom_driver_read_block(void *buf, const void *addr, size_t len);
+void eeprom_driver_write_block(const void *buf, void *addr, size_t len);
+
+// The number of blocks written to the backend so far
+uint32_t eeprom_driver_get_writes(void);
+
+// True while the backend is still busy with the last write, and the next access would have to wait for it
+// Weak, backends that finish their writes before returning don't need to implement it
+bool eeprom_driver_busy(void);
+
+#ifdef EEPROM_WRITE_BACK
+// Writes sit in a small RAM cache and reach the backend once the EEPROM has been left alone for a while
+// eeprom_driver_task() writes them back one run at a time, whenever the backend isn't busy
+void eeprom_driver_task(void);
+void eeprom_driver_flush(void);
+void eeprom_driver_discard(void);
+// The number of bytes written to the cache that haven't reached the backend yet
+uint16_t eeprom_driver_get_pending(void);
+#else
+#    define eeprom_driver_get_pending() 0
+#    define eeprom_driver_task()
+#    define eeprom_driver_flush()
+#    define eeprom_driver_discard()
+#endif
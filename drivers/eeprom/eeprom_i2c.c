@@ -30,15 +30,14 @@
     there is nothing to override during linkage.
 */
 
-#include "wait.h"
+#include "timer.h"
 #include "i2c_master.h"
-#include "eeprom.h"
+#include "eeprom_driver.h"
 #include "eeprom_i2c.h"
 
 // #define DEBUG_EEPROM_OUTPUT
 
 #if defined(CONSOLE_ENABLE) && defined(DEBUG_EEPROM_OUTPUT)
-#    include "timer.h"
 #    include "debug.h"
 #endif  // DEBUG_EEPROM_OUTPUT
 
@@ -50,6 +49,49 @@ static inline void fill_target_address(uint8_t *buffer, const void *addr) {
     }
 }
 
+#if EXTERNAL_EEPROM_WRITE_TIME > 0
+/*
+    A page write returns as soon as the data is on the bus, the EEPROM then
+    programs the page on its own and doesn't acknowledge its address until it
+    is done. Whatever comes next polls for that acknowledgement, so the wait is
+    only as long as the device actually takes, and none at all if the keyboard
+    got on with something else in the meantime. EXTERNAL_EEPROM_WRITE_TIME
+    bounds the wait in case the device never answers.
+*/
+static bool      write_in_progress = false;
+static uintptr_t write_addr;
+static uint16_t  write_started;
+
+// Addresses the device once, true when it acknowledged and so has finished the page write
+static bool eeprom_i2c_ready(void) {
+    uint8_t address[EXTERNAL_EEPROM_ADDRESS_SIZE];
+    fill_target_address(address, (const void *)write_addr);
+    return i2c_transmit(EXTERNAL_EEPROM_I2C_ADDRESS(write_addr), address, EXTERNAL_EEPROM_ADDRESS_SIZE, 1) == I2C_STATUS_SUCCESS;
+}
+
+bool eeprom_driver_busy(void) {
+    if (write_in_progress && (eeprom_i2c_ready() || timer_elapsed(write_started) > EXTERNAL_EEPROM_WRITE_TIME)) {
+        write_in_progress = false;
+    }
+    return write_in_progress;
+}
+
+static void eeprom_i2c_wait(void) {
+    while (eeprom_driver_busy()) {
+    }
+}
+
+static void eeprom_i2c_write_started(uintptr_t addr) {
+    write_in_progress = true;
+    write_addr        = addr;
+    write_started     = timer_read();
+}
+#else
+// FRAM and the like take writes at bus speed
+#    define eeprom_i2c_wait()
+#    define eeprom_i2c_write_started(addr)
+#endif
+
 void eeprom_driver_init(void) { i2c_init(); }
 
 void eeprom_driver_erase(void) {
@@ -60,7 +102,7 @@ void eeprom_driver_erase(void) {
     uint8_t buf[EXTERNAL_EEPROM_PAGE_SIZE];
     memset(buf, 0x00, EXTERNAL_EEPROM_PAGE_SIZE);
     for (uint32_t addr = 0; addr < EXTERNAL_EEPROM_BYTE_COUNT; addr += EXTERNAL_EEPROM_PAGE_SIZE) {
-        eeprom_write_block(buf, (void *)(uintptr_t)addr, EXTERNAL_EEPROM_PAGE_SIZE);
+        eeprom_driver_write_block(buf, (void *)(uintptr_t)addr, EXTERNAL_EEPROM_PAGE_SIZE);
     }
 
 #if defined(CONSOLE_ENABLE) && defined(DEBUG_EEPROM_OUTPUT)
@@ -68,10 +110,11 @@ void eeprom_driver_erase(void) {
 #endif
 }
 
-void eeprom_read_block(void *buf, const void *addr, size_t len) {
+void eeprom_driver_read_block(void *buf, const void *addr, size_t len) {
     uint8_t complete_packet[EXTERNAL_EEPROM_ADDRESS_SIZE];
     fill_target_address(complete_packet, addr);
 
+    eeprom_i2c_wait();
     i2c_transmit(EXTERNAL_EEPROM_I2C_ADDRESS((uintptr_t)addr), complete_packet, EXTERNAL_EEPROM_ADDRESS_SIZE, 100);
     i2c_receive(EXTERNAL_EEPROM_I2C_ADDRESS((uintptr_t)addr), buf, len, 100);
 
@@ -84,7 +127,7 @@ void eeprom_read_block(void *buf, const void *addr, size_t len) {
 #endif  // DEBUG_EEPROM_OUTPUT
 }
 
-void eeprom_write_block(const void *buf, void *addr, size_t len) {
+void eeprom_driver_write_block(const void *buf, void *addr, size_t len) {
     uint8_t   complete_packet[EXTERNAL_EEPROM_ADDRESS_SIZE + EXTERNAL_EEPROM_PAGE_SIZE];
     uint8_t * read_buf    = (uint8_t *)buf;
     uintptr_t target_addr = (uintptr_t)addr;
@@ -109,8 +152,10 @@ void eeprom_write_block(const void *buf, void *addr, size_t len) {
         dprintf("\n");
 #endif  // DEBUG_EEPROM_OUTPUT
 
-        i2c_transmit(EXTERNAL_EEPROM_I2C_ADDRESS((uintptr_t)addr), complete_packet, EXTERNAL_EEPROM_ADDRESS_SIZE + write_length, 100);
-        wait_ms(EXTERNAL_EEPROM_WRITE_TIME);
+        // Each page is written whole in one transfer, the previous one has to have been programmed first
+        eeprom_i2c_wait();
+        i2c_transmit(EXTERNAL_EEPROM_I2C_ADDRESS(target_addr), complete_packet, EXTERNAL_EEPROM_ADDRESS_SIZE + write_length, 100);
+        eeprom_i2c_write_started(target_addr);
 
         read_buf += write_length;
         target_addr += write_length;
@@ -0,0 +1,176 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "expander_matrix.h"
+
+#include "debug.h"
+#include "timer.h"
+
+// Time between attempts to initialise an expander that could not be read
+#ifndef EXPANDER_MATRIX_RETRY_INTERVAL
+#    define EXPANDER_MATRIX_RETRY_INTERVAL 1000
+#endif
+
+enum {
+    SCAN_NONE,   // nothing was read, as nothing changed
+    SCAN_QUICK,  // every row was read at once into the last slot
+    SCAN_FULL,   // the rows were read one by one, then all of them at once again
+};
+
+static uint8_t all_rows(expander_matrix_t *expander) { return ~((1 << expander->rows) - 1); }
+
+#ifdef I2C_ASYNC
+static i2c_transaction_t *next_transaction(expander_matrix_t *expander) {
+    i2c_transaction_t *transaction = &expander->transactions[expander->transaction_count++];
+    *transaction                   = (i2c_transaction_t){.address = expander->address, .timeout = EXPANDER_MATRIX_TIMEOUT};
+    return transaction;
+}
+#endif
+
+// Selects the rows in value, then reads the columns into the given slot
+static void select_and_read(expander_matrix_t *expander, uint8_t slot, uint8_t value) {
+    uint8_t *select = expander->select[slot];
+    uint8_t *input  = expander->input[slot];
+    bool     single = expander->input_reg == expander->output_reg + 1;
+
+    select[0] = expander->output_reg;
+    select[1] = value;
+
+#ifdef I2C_ASYNC
+    i2c_transaction_t *transaction = next_transaction(expander);
+    transaction->tx                = select;
+    transaction->tx_length         = 2;
+    if (!single) {
+        i2c_submit(transaction);
+        transaction            = next_transaction(expander);
+        transaction->tx        = &expander->input_reg;
+        transaction->tx_length = 1;
+    }
+    transaction->rx        = input;
+    transaction->rx_length = expander->input_size;
+    i2c_submit(transaction);
+#else
+    i2c_status_t status = i2c_transmit(expander->address, select, 2, EXPANDER_MATRIX_TIMEOUT);
+    if (status == I2C_STATUS_SUCCESS) {
+        if (single) {
+            // The register pointer has already moved on from output_reg to input_reg
+            status = i2c_receive(expander->address, input, expander->input_size, EXPANDER_MATRIX_TIMEOUT);
+        } else {
+            status = i2c_readReg(expander->address, expander->input_reg, input, expander->input_size, EXPANDER_MATRIX_TIMEOUT);
+        }
+    }
+    if (status != I2C_STATUS_SUCCESS) {
+        expander->failed = true;
+    }
+#endif
+}
+
+static void start_full(expander_matrix_t *expander) {
+    for (uint8_t row = 0; row < expander->rows; row++) {
+        select_and_read(expander, row, ~(1 << row));
+    }
+    // Leave every row selected for the next quick check, the read clears the interrupt
+    select_and_read(expander, expander->rows, all_rows(expander));
+    expander->scan = SCAN_FULL;
+}
+
+static bool wait_scan(expander_matrix_t *expander) {
+#ifdef I2C_ASYNC
+    for (uint8_t i = 0; i < expander->transaction_count; i++) {
+        if (i2c_wait(&expander->transactions[i]) != I2C_STATUS_SUCCESS) {
+            expander->failed = true;
+        }
+    }
+    expander->transaction_count = 0;
+#endif
+    return !expander->failed;
+}
+
+static uint16_t pressed_cols(expander_matrix_t *expander, uint8_t slot) {
+    uint16_t input = expander->input[slot][0];
+    if (expander->input_size > 1) {
+        input |= expander->input[slot][1] << 8;
+        return ~input;
+    }
+    return ~input & 0xFF;
+}
+
+/** \brief Writes the init registers, the first scan then reads every row
+ */
+bool expander_matrix_init(expander_matrix_t *expander) {
+    i2c_init();
+
+    expander->ready       = false;
+    expander->retry_timer = timer_read();
+    for (uint8_t i = 0; i < expander->init_length; i++) {
+        if (i2c_writeReg(expander->address, expander->init[i][0], &expander->init[i][1], 1, EXPANDER_MATRIX_TIMEOUT) != I2C_STATUS_SUCCESS) {
+            dprintf("expander_matrix_init: 0x%02X failed\n", expander->address);
+            return false;
+        }
+    }
+    if (expander->int_pin != NO_PIN) {
+        setPinInputHigh(expander->int_pin);
+    }
+
+    expander->ready = true;
+    expander->idle  = false;
+    return true;
+}
+
+/** \brief Starts reading the columns of every row, see expander_matrix_scan_finish()
+ */
+void expander_matrix_scan_start(expander_matrix_t *expander) {
+    expander->failed = false;
+    expander->scan   = SCAN_NONE;
+    if (!expander->ready) {
+        return;
+    }
+
+    if (!expander->idle) {
+        start_full(expander);
+    } else if (expander->int_pin == NO_PIN || !readPin(expander->int_pin)) {
+        // Every row is still selected, one read tells whether any key went down
+        select_and_read(expander, expander->rows, all_rows(expander));
+        expander->scan = SCAN_QUICK;
+    }
+}
+
+/** \brief Waits for the scan started by expander_matrix_scan_start() and returns the pressed columns of each row
+ *
+ * Returns false, leaving cols as it was, if the expander could not be read. It is then initialised again, straight
+ * away the first time and every EXPANDER_MATRIX_RETRY_INTERVAL milliseconds after that.
+ */
+bool expander_matrix_scan_finish(expander_matrix_t *expander, uint16_t cols[]) {
+    if (expander->ready && wait_scan(expander) && expander->scan == SCAN_QUICK && pressed_cols(expander, expander->rows)) {
+        start_full(expander);
+        wait_scan(expander);
+    }
+
+    if (!expander->ready || expander->failed) {
+        if (expander->ready || timer_elapsed(expander->retry_timer) > EXPANDER_MATRIX_RETRY_INTERVAL) {
+            expander_matrix_init(expander);
+        }
+        return false;
+    }
+
+    expander->idle = true;
+    for (uint8_t row = 0; row < expander->rows; row++) {
+        cols[row] = expander->scan == SCAN_FULL ? pressed_cols(expander, row) : 0;
+        if (cols[row]) {
+            expander->idle = false;
+        }
+    }
+    return true;
+}
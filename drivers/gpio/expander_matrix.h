@@ -0,0 +1,93 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "i2c_master.h"
+#include "gpio.h"
+
+/*
+ * Scans the part of a matrix wired to an I2C I/O expander, such as one half
+ * of a split keyboard. The rows are the low pins of one output register and
+ * are selected by driving them low, the columns are read back from an input
+ * register and are active low.
+ *
+ * When the input register comes right after the output register, as GPIOB
+ * does after GPIOA on an MCP23017 with IOCON.BANK = 0, selecting a row and
+ * reading its columns is a single write-then-read transfer. Otherwise (a
+ * PCA9555 for one) it is a write followed by a register read.
+ *
+ * Between scans every row is left selected, so that one read tells whether
+ * any key is down at all, and the rows are only gone through one by one when
+ * one is. With an int_pin, the expander's interrupt output, not even that read
+ * is needed while it stays high.
+ *
+ *   static const uint8_t left_init[][2] = {
+ *       {0x00, 0x00},  // IODIRA: rows are outputs
+ *       {0x0D, 0xFF},  // GPPUB: pull-ups on the columns
+ *   };
+ *   static expander_matrix_t left = {
+ *       .address     = 0x20 << 1,
+ *       .output_reg  = 0x12,  // GPIOA
+ *       .input_reg   = 0x13,  // GPIOB
+ *       .input_size  = 1,
+ *       .rows        = 7,
+ *       .int_pin     = NO_PIN,
+ *       .init        = left_init,
+ *       .init_length = 2,
+ *   };
+ *
+ * With I2C_ASYNC, expander_matrix_scan_start() queues the transfers and
+ * returns, so the local half can be scanned while they run, and
+ * expander_matrix_scan_finish() waits for them. Without it, the transfers
+ * run in expander_matrix_scan_start().
+ */
+
+#ifndef EXPANDER_MATRIX_MAX_ROWS
+#    define EXPANDER_MATRIX_MAX_ROWS 8
+#endif
+#ifndef EXPANDER_MATRIX_TIMEOUT
+#    define EXPANDER_MATRIX_TIMEOUT 100
+#endif
+
+typedef struct {
+    uint8_t address;     // shifted, as i2c_master takes it
+    uint8_t output_reg;  // register the rows are selected in
+    uint8_t input_reg;   // register the columns are read from
+    uint8_t input_size;  // bytes read from input_reg, 1 or 2
+    uint8_t rows;
+    pin_t   int_pin;  // low when the inputs changed since they were last read, NO_PIN if not wired
+    const uint8_t (*init)[2];  // register and value pairs written by expander_matrix_init()
+    uint8_t init_length;
+
+    // The rest is the scan's own
+    bool     ready;
+    bool     idle;    // no key was down at the last scan
+    bool     failed;  // a transfer of the scan in progress failed
+    uint8_t  scan;    // what the scan in progress reads
+    uint16_t retry_timer;
+    uint8_t  select[EXPANDER_MATRIX_MAX_ROWS + 1][2];
+    uint8_t  input[EXPANDER_MATRIX_MAX_ROWS + 1][2];
+#ifdef I2C_ASYNC
+    i2c_transaction_t transactions[2 * (EXPANDER_MATRIX_MAX_ROWS + 1)];
+    uint8_t           transaction_count;
+#endif
+} expander_matrix_t;
+
+bool expander_matrix_init(expander_matrix_t *expander);
+void expander_matrix_scan_start(expander_matrix_t *expander);
+bool expander_matrix_scan_finish(expander_matrix_t *expander, uint16_t cols[]);
@@ -23,6 +23,11 @@
 uint8_t DRV2605L_transfer_buffer[2];
 uint8_t DRV2605L_read_register;
 
+#ifdef I2C_ASYNC
+static uint8_t           DRV2605L_pulse_buffers[3][2];
+static i2c_transaction_t DRV2605L_pulse_transactions[3];
+#endif
+
 void DRV_write(uint8_t drv_register, uint8_t settings) {
     DRV2605L_transfer_buffer[0] = drv_register;
     DRV2605L_transfer_buffer[1] = settings;
@@ -114,7 +119,27 @@ void DRV_rtp_init(void) {
 void DRV_amplitude(uint8_t amplitude) { DRV_write(DRV_RTP_INPUT, amplitude); }
 
 void DRV_pulse(uint8_t sequence) {
+#ifdef I2C_ASYNC
+    // Queued rather than waited for, the writes go out while the next scan runs
+    const uint8_t writes[3][2] = {{DRV_GO, 0x00}, {DRV_WAVEFORM_SEQ_1, sequence}, {DRV_GO, 0x01}};
+    for (uint8_t i = 0; i < 3; i++) {
+        i2c_transaction_t *transaction = &DRV2605L_pulse_transactions[i];
+        if (transaction->status == I2C_STATUS_PENDING) {
+            i2c_wait(transaction);
+        }
+        DRV2605L_pulse_buffers[i][0] = writes[i][0];
+        DRV2605L_pulse_buffers[i][1] = writes[i][1];
+        *transaction                 = (i2c_transaction_t){
+            .address   = DRV2605L_BASE_ADDRESS << 1,
+            .tx        = DRV2605L_pulse_buffers[i],
+            .tx_length = 2,
+            .timeout   = 100,
+        };
+        i2c_submit(transaction);
+    }
+#else
     DRV_write(DRV_GO, 0x00);
     DRV_write(DRV_WAVEFORM_SEQ_1, sequence);
     DRV_write(DRV_GO, 0x01);
+#endif
 }
@@ -27,6 +27,9 @@
 
 haptic_config_t haptic_config;
 
+// Set by haptic_play(), played by the next haptic_task()
+static bool haptic_play_pending = false;
+
 void haptic_init(void) {
     debug_enable = 1;  // Debug is ON!
     if (!eeconfig_is_enabled()) {
@@ -58,7 +61,22 @@ void haptic_init(void) {
     eeconfig_debug_haptic();
 }
 
+static void haptic_play_now(void) {
+#ifdef DRV2605L
+    uint8_t play_eff = 0;
+    play_eff         = haptic_config.mode;
+    DRV_pulse(play_eff);
+#endif
+#ifdef SOLENOID_ENABLE
+    solenoid_fire();
+#endif
+}
+
 void haptic_task(void) {
+    if (haptic_play_pending) {
+        haptic_play_pending = false;
+        haptic_play_now();
+    }
 #ifdef SOLENOID_ENABLE
     solenoid_check();
 #endif
@@ -280,16 +298,13 @@ void haptic_cont_decrease(void) {
     haptic_set_amplitude(amp);
 }
 
-void haptic_play(void) {
-#ifdef DRV2605L
-    uint8_t play_eff = 0;
-    play_eff         = haptic_config.mode;
-    DRV_pulse(play_eff);
-#endif
-#ifdef SOLENOID_ENABLE
-    solenoid_fire();
-#endif
-}
+/** \brief Plays the haptic feedback from the next haptic_task()
+ *
+ * haptic_play() is called while a key is processed, so it leaves the I2C
+ * writes and pin toggles to the next matrix scan, after the report has gone
+ * out. Plays asked for before then are played once.
+ */
+void haptic_play(void) { haptic_play_pending = true; }
 
 bool process_haptic(uint16_t keycode, keyrecord_t *record) {
     if (keycode == HPT_ON && record->event.pressed) {
@@ -62,7 +62,11 @@ uint8_t g_twi_transfer_buffer[20];
 // buffers and the transfers in IS31FL3731_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
 uint8_t g_pwm_buffer[DRIVER_COUNT][144];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
+// One bit per 16 byte chunk of g_pwm_buffer that differs from the device.
+uint16_t g_pwm_buffer_dirty[DRIVER_COUNT] = {0};
+
+#define ISSI_PWM_CHUNK_SIZE 16
+#define ISSI_PWM_CHUNKS_ALL 0x01FF
 
 uint8_t g_led_control_registers[DRIVER_COUNT][18]             = {{0}};
 bool    g_led_control_registers_update_required[DRIVER_COUNT] = {false};
@@ -94,33 +98,43 @@ void IS31FL3731_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 #endif
 }
 
-void IS31FL3731_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+static void IS31FL3731_write_pwm_chunks(uint8_t addr, uint8_t *pwm_buffer, uint16_t chunks) {
     // assumes bank is already selected
 
-    // transmit PWM registers in 9 transfers of 16 bytes
-    // g_twi_transfer_buffer[] is 20 bytes
-
-    // iterate over the pwm_buffer contents at 16 byte intervals
-    for (int i = 0; i < 144; i += 16) {
-        // set the first register, e.g. 0x24, 0x34, 0x44, etc.
-        g_twi_transfer_buffer[0] = 0x24 + i;
-        // copy the data from i to i+15
-        // device will auto-increment register for data after the first byte
-        // thus this sets registers 0x24-0x33, 0x34-0x43, etc. in one transfer
-        for (int j = 0; j < 16; j++) {
-            g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
+    // each run of adjacent chunks is sent as one transfer
+    // device will auto-increment register for data after the first byte
+    uint8_t chunk = 0;
+    while (chunks) {
+        if (!(chunks & 1)) {
+            chunks >>= 1;
+            chunk++;
+            continue;
+        }
+        uint8_t first = chunk;
+        while (chunks & 1) {
+            chunks >>= 1;
+            chunk++;
         }
+        uint8_t offset = first * ISSI_PWM_CHUNK_SIZE;
+        uint8_t length = (chunk - first) * ISSI_PWM_CHUNK_SIZE;
 
+        // the first register is offset from 0x24, e.g. 0x24, 0x34, 0x44, etc.
 #if ISSI_PERSISTENCE > 0
         for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) break;
+            if (i2c_writeReg(addr << 1, 0x24 + offset, &pwm_buffer[offset], length, ISSI_TIMEOUT) == 0) break;
         }
 #else
-        i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT);
+        i2c_writeReg(addr << 1, 0x24 + offset, &pwm_buffer[offset], length, ISSI_TIMEOUT);
 #endif
     }
 }
 
+void IS31FL3731_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    // assumes bank is already selected
+    // transmit all 144 PWM registers
+    IS31FL3731_write_pwm_chunks(addr, pwm_buffer, ISSI_PWM_CHUNKS_ALL);
+}
+
 void IS31FL3731_init(uint8_t addr) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, first enable software shutdown,
@@ -173,15 +187,22 @@ void IS31FL3731_init(uint8_t addr) {
     IS31FL3731_write_register(addr, ISSI_COMMANDREGISTER, 0);
 }
 
+static inline void IS31FL3731_set_pwm(uint8_t driver, uint8_t offset, uint8_t value) {
+    // only mark the chunk dirty if the value actually changes
+    if (g_pwm_buffer[driver][offset] != value) {
+        g_pwm_buffer[driver][offset] = value;
+        g_pwm_buffer_dirty[driver] |= 1 << (offset / ISSI_PWM_CHUNK_SIZE);
+    }
+}
+
 void IS31FL3731_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
         // Subtract 0x24 to get the second index of g_pwm_buffer
-        g_pwm_buffer[led.driver][led.r - 0x24]   = red;
-        g_pwm_buffer[led.driver][led.g - 0x24]   = green;
-        g_pwm_buffer[led.driver][led.b - 0x24]   = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL3731_set_pwm(led.driver, led.r - 0x24, red);
+        IS31FL3731_set_pwm(led.driver, led.g - 0x24, green);
+        IS31FL3731_set_pwm(led.driver, led.b - 0x24, blue);
     }
 }
 
@@ -221,10 +242,10 @@ void IS31FL3731_set_led_control_register(uint8_t index, bool red, bool green, bo
 }
 
 void IS31FL3731_update_pwm_buffers(uint8_t addr, uint8_t index) {
-    if (g_pwm_buffer_update_required[index]) {
-        IS31FL3731_write_pwm_buffer(addr, g_pwm_buffer[index]);
+    if (g_pwm_buffer_dirty[index]) {
+        IS31FL3731_write_pwm_chunks(addr, g_pwm_buffer[index], g_pwm_buffer_dirty[index]);
     }
-    g_pwm_buffer_update_required[index] = false;
+    g_pwm_buffer_dirty[index] = 0;
 }
 
 void IS31FL3731_update_led_control_registers(uint8_t addr, uint8_t index) {
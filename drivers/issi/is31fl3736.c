@@ -64,7 +64,11 @@ uint8_t g_twi_transfer_buffer[20];
 // buffers and the transfers in IS31FL3736_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
 uint8_t g_pwm_buffer[DRIVER_COUNT][192];
-bool    g_pwm_buffer_update_required = false;
+// One bit per 16 byte chunk of g_pwm_buffer that differs from the device.
+uint16_t g_pwm_buffer_dirty[DRIVER_COUNT] = {0};
+
+#define ISSI_PWM_CHUNK_SIZE 16
+#define ISSI_PWM_CHUNKS_ALL 0x0FFF
 
 uint8_t g_led_control_registers[DRIVER_COUNT][24] = {{0}, {0}};
 bool    g_led_control_registers_update_required   = false;
@@ -82,32 +86,42 @@ void IS31FL3736_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 #endif
 }
 
-void IS31FL3736_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+static void IS31FL3736_write_pwm_chunks(uint8_t addr, uint8_t *pwm_buffer, uint16_t chunks) {
     // assumes PG1 is already selected
 
-    // transmit PWM registers in 12 transfers of 16 bytes
-    // g_twi_transfer_buffer[] is 20 bytes
-
-    // iterate over the pwm_buffer contents at 16 byte intervals
-    for (int i = 0; i < 192; i += 16) {
-        g_twi_transfer_buffer[0] = i;
-        // copy the data from i to i+15
-        // device will auto-increment register for data after the first byte
-        // thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer
-        for (int j = 0; j < 16; j++) {
-            g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
+    // each run of adjacent chunks is sent as one transfer
+    // device will auto-increment register for data after the first byte
+    uint8_t chunk = 0;
+    while (chunks) {
+        if (!(chunks & 1)) {
+            chunks >>= 1;
+            chunk++;
+            continue;
+        }
+        uint8_t first = chunk;
+        while (chunks & 1) {
+            chunks >>= 1;
+            chunk++;
         }
+        uint8_t reg    = first * ISSI_PWM_CHUNK_SIZE;
+        uint8_t length = (chunk - first) * ISSI_PWM_CHUNK_SIZE;
 
 #if ISSI_PERSISTENCE > 0
         for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) break;
+            if (i2c_writeReg(addr << 1, reg, &pwm_buffer[reg], length, ISSI_TIMEOUT) == 0) break;
         }
 #else
-        i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT);
+        i2c_writeReg(addr << 1, reg, &pwm_buffer[reg], length, ISSI_TIMEOUT);
 #endif
     }
 }
 
+void IS31FL3736_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    // assumes PG1 is already selected
+    // transmit all 192 PWM registers
+    IS31FL3736_write_pwm_chunks(addr, pwm_buffer, ISSI_PWM_CHUNKS_ALL);
+}
+
 void IS31FL3736_init(uint8_t addr) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, shutdown is enabled last.
@@ -149,14 +163,21 @@ void IS31FL3736_init(uint8_t addr) {
     wait_ms(10);
 }
 
+static inline void IS31FL3736_set_pwm(uint8_t driver, uint8_t reg, uint8_t value) {
+    // only mark the chunk dirty if the value actually changes
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        g_pwm_buffer_dirty[driver] |= 1 << (reg / ISSI_PWM_CHUNK_SIZE);
+    }
+}
+
 void IS31FL3736_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
-        g_pwm_buffer[led.driver][led.r] = red;
-        g_pwm_buffer[led.driver][led.g] = green;
-        g_pwm_buffer[led.driver][led.b] = blue;
-        g_pwm_buffer_update_required    = true;
+        IS31FL3736_set_pwm(led.driver, led.r, red);
+        IS31FL3736_set_pwm(led.driver, led.g, green);
+        IS31FL3736_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -214,8 +235,7 @@ void IS31FL3736_mono_set_brightness(int index, uint8_t value) {
         // Index in range 0..95 -> A1..A8, B1..B8, etc.
         // Map index 0..95 to registers 0x00..0xBE (interleaved)
         uint8_t pwm_register          = index * 2;
-        g_pwm_buffer[0][pwm_register] = value;
-        g_pwm_buffer_update_required  = true;
+        IS31FL3736_set_pwm(0, pwm_register, value);
     }
 }
 
@@ -244,15 +264,15 @@ void IS31FL3736_mono_set_led_control_register(uint8_t index, bool enabled) {
 }
 
 void IS31FL3736_update_pwm_buffers(uint8_t addr1, uint8_t addr2) {
-    if (g_pwm_buffer_update_required) {
+    if (g_pwm_buffer_dirty[0]) {
         // Firstly we need to unlock the command register and select PG1
         IS31FL3736_write_register(addr1, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
         IS31FL3736_write_register(addr1, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM);
 
-        IS31FL3736_write_pwm_buffer(addr1, g_pwm_buffer[0]);
-        // IS31FL3736_write_pwm_buffer(addr2, g_pwm_buffer[1]);
+        IS31FL3736_write_pwm_chunks(addr1, g_pwm_buffer[0], g_pwm_buffer_dirty[0]);
+        // IS31FL3736_write_pwm_chunks(addr2, g_pwm_buffer[1], g_pwm_buffer_dirty[1]);
     }
-    g_pwm_buffer_update_required = false;
+    g_pwm_buffer_dirty[0] = 0;
 }
 
 void IS31FL3736_update_led_control_registers(uint8_t addr1, uint8_t addr2) {
@@ -14,11 +14,19 @@ GNU General Public License for more details.
 You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
-#include "i2c_master.h"
+#if defined(OLED_TRANSPORT_SPI)
+#    include "spi_master.h"
+#    include "quantum.h"
+#else
+#    include "i2c_master.h"
+#endif
 #include "oled_driver.h"
 #include OLED_FONT_H
 #include "timer.h"
 #include "print.h"
+#if defined(SPLIT_KEYBOARD) && defined(SPLIT_OLED_MIRROR)
+#    include "keyboard.h"
+#endif
 
 #include <string.h>
 
@@ -84,16 +92,58 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define OLED_ALL_BLOCKS_MASK (((((OLED_BLOCK_TYPE)1 << (OLED_BLOCK_COUNT - 1)) - 1) << 1) | 1)
 
+// Every block lies within a single page, so that the bytes of a block that changed can be sent on their own
+#define OLED_PARTIAL_BLOCKS (OLED_BLOCK_SIZE <= OLED_DISPLAY_WIDTH && OLED_DISPLAY_WIDTH % OLED_BLOCK_SIZE == 0)
+
+// Lines remembered by oled_write_status_line, as many as fit either way round
+#define OLED_STATUS_LINES ((OLED_DISPLAY_WIDTH > OLED_DISPLAY_HEIGHT ? OLED_DISPLAY_WIDTH : OLED_DISPLAY_HEIGHT) / OLED_FONT_HEIGHT)
+
 // i2c defines
+// Command arrays start with the I2C_CMD control byte, the SPI transport skips it and drives OLED_DC_PIN instead
 #define I2C_CMD 0x00
 #define I2C_DATA 0x40
-#if defined(__AVR__)
-#    define I2C_TRANSMIT_P(data) i2c_transmit_P((OLED_DISPLAY_ADDRESS << 1), &data[0], sizeof(data), OLED_I2C_TIMEOUT)
-#else  // defined(__AVR__)
-#    define I2C_TRANSMIT_P(data) i2c_transmit((OLED_DISPLAY_ADDRESS << 1), &data[0], sizeof(data), OLED_I2C_TIMEOUT)
-#endif  // defined(__AVR__)
-#define I2C_TRANSMIT(data) i2c_transmit((OLED_DISPLAY_ADDRESS << 1), &data[0], sizeof(data), OLED_I2C_TIMEOUT)
-#define I2C_WRITE_REG(mode, data, size) i2c_writeReg((OLED_DISPLAY_ADDRESS << 1), mode, data, size, OLED_I2C_TIMEOUT)
+
+#if defined(OLED_TRANSPORT_SPI)
+#    if !defined(OLED_CS_PIN)
+#        error "OLED_CS_PIN must be defined when using the SPI transport"
+#    endif
+#    if !defined(OLED_DC_PIN)
+#        error "OLED_DC_PIN must be defined when using the SPI transport"
+#    endif
+#    if !defined(OLED_SPI_MODE)
+#        define OLED_SPI_MODE 0
+#    endif
+#    if !defined(OLED_SPI_DIVISOR)
+#        define OLED_SPI_DIVISOR 2
+#    endif
+#    define OLED_TRANSMIT_CMD(data, size) oled_spi_transmit(false, &(data)[1], (size)-1, false)
+#    define OLED_TRANSMIT_CMD_P(data, size) oled_spi_transmit(false, &(data)[1], (size)-1, true)
+#    define OLED_TRANSMIT_DATA(data, size) oled_spi_transmit(true, data, size, false)
+#else
+#    if defined(__AVR__)
+#        define OLED_TRANSMIT_CMD_P(data, size) (i2c_transmit_P((OLED_DISPLAY_ADDRESS << 1), data, size, OLED_I2C_TIMEOUT) == I2C_STATUS_SUCCESS)
+#    else  // defined(__AVR__)
+#        define OLED_TRANSMIT_CMD_P(data, size) (i2c_transmit((OLED_DISPLAY_ADDRESS << 1), data, size, OLED_I2C_TIMEOUT) == I2C_STATUS_SUCCESS)
+#    endif  // defined(__AVR__)
+#    define OLED_TRANSMIT_CMD(data, size) (i2c_transmit((OLED_DISPLAY_ADDRESS << 1), data, size, OLED_I2C_TIMEOUT) == I2C_STATUS_SUCCESS)
+#    define OLED_TRANSMIT_DATA(data, size) (i2c_writeReg((OLED_DISPLAY_ADDRESS << 1), I2C_DATA, data, size, OLED_I2C_TIMEOUT) == I2C_STATUS_SUCCESS)
+#endif
+
+#define OLED_SEND_CMD(data) oled_send_cmd(&data[0], sizeof(data))
+#define OLED_SEND_CMD_P(data) oled_send_cmd_P(&data[0], sizeof(data))
+
+#if defined(OLED_RENDER_THREAD)
+#    if !defined(PROTOCOL_CHIBIOS)
+#        error "OLED_RENDER_THREAD is only supported on ChibiOS"
+#    endif
+#    include <ch.h>
+#    if !defined(OLED_THREAD_PRIORITY)
+#        define OLED_THREAD_PRIORITY (NORMALPRIO + 1)
+#    endif
+#    if !defined(OLED_THREAD_STACK_SIZE)
+#        define OLED_THREAD_STACK_SIZE 256
+#    endif
+#endif
 
 #define HAS_FLAGS(bits, flags) ((bits & flags) == flags)
 
@@ -125,7 +175,57 @@ uint16_t oled_update_timeout;
 
 // Internal variables to reduce math instructions
 
-#if defined(__AVR__)
+// Blocks are prepared here (and rotated if needed) before being sent
+static uint8_t oled_block_buffer[OLED_BLOCK_SIZE];
+
+// First and last byte of each dirty block that changed since it was sent, first > last when it is sent whole
+_Static_assert(OLED_BLOCK_SIZE <= 256, "OLED_BLOCK_SIZE must be 256 or less, use a larger OLED_BLOCK_TYPE");
+static uint8_t oled_dirty_first[OLED_BLOCK_COUNT];
+static uint8_t oled_dirty_last[OLED_BLOCK_COUNT];
+
+// What each line last written by oled_write_status_line holds, while it still holds it
+_Static_assert(OLED_STATUS_LINES <= 32, "oled_write_status_line supports at most 32 lines");
+static uint32_t oled_status_hash[OLED_STATUS_LINES];
+static uint32_t oled_status_valid = 0;
+
+#if defined(OLED_RENDER_THREAD)
+// The render thread owns the bus while a block is in flight, commands from the main loop wait for it
+static MUTEX_DECL(oled_bus_mutex);
+static BSEMAPHORE_DECL(oled_render_sem, true);
+static uint8_t          oled_tx_start[7];
+static volatile uint8_t oled_tx_block;
+static uint16_t         oled_tx_length;
+static volatile bool    oled_tx_busy   = false;
+static volatile bool    oled_tx_failed = false;
+#    define OLED_BUS_LOCK() chMtxLock(&oled_bus_mutex)
+#    define OLED_BUS_UNLOCK() chMtxUnlock(&oled_bus_mutex)
+#else
+#    define OLED_BUS_LOCK()
+#    define OLED_BUS_UNLOCK()
+#endif
+
+#if defined(OLED_TRANSPORT_SPI)
+static bool oled_spi_transmit(bool is_data, const uint8_t *data, uint16_t length, bool progmem) {
+    if (!spi_start(OLED_CS_PIN, false, OLED_SPI_MODE, OLED_SPI_DIVISOR)) {
+        return false;
+    }
+
+    writePin(OLED_DC_PIN, is_data);
+
+    spi_status_t status = SPI_STATUS_SUCCESS;
+    if (progmem) {
+        for (uint16_t i = 0; i < length && status >= 0; i++) {
+            status = spi_write(pgm_read_byte(&data[i]));
+        }
+    } else {
+        status = spi_transmit(data, length);
+    }
+
+    spi_stop();
+
+    return status >= 0;
+}
+#elif defined(__AVR__)
 // identical to i2c_transmit, but for PROGMEM since all initialization is in PROGMEM arrays currently
 // probably should move this into i2c_master...
 static i2c_status_t i2c_transmit_P(uint8_t address, const uint8_t *data, uint16_t length, uint16_t timeout) {
@@ -142,15 +242,166 @@ static i2c_status_t i2c_transmit_P(uint8_t address, const uint8_t *data, uint16_
 }
 #endif
 
-// Flips the rendering bits for a character at the current cursor position
-static void InvertCharacter(uint8_t *cursor) {
-    const uint8_t *end = cursor + OLED_FONT_WIDTH;
-    while (cursor < end) {
-        *cursor = ~(*cursor);
-        cursor++;
+static bool oled_send_cmd(const uint8_t *data, uint16_t size) {
+    OLED_BUS_LOCK();
+    bool success = OLED_TRANSMIT_CMD(data, size);
+    OLED_BUS_UNLOCK();
+    return success;
+}
+
+static bool oled_send_cmd_P(const uint8_t *data, uint16_t size) {
+    OLED_BUS_LOCK();
+    bool success = OLED_TRANSMIT_CMD_P(data, size);
+    OLED_BUS_UNLOCK();
+    return success;
+}
+
+#if defined(OLED_RENDER_THREAD)
+// Sends prepared blocks off the main loop. On ChibiOS the I2C and SPI drivers sleep the calling
+// thread while the transfer runs, so the main loop keeps scanning while a block is on the bus.
+static THD_WORKING_AREA(waOLEDRenderThread, OLED_THREAD_STACK_SIZE);
+static THD_FUNCTION(OLEDRenderThread, arg) {
+    (void)arg;
+    chRegSetThreadName("oled");
+    while (true) {
+        chBSemWait(&oled_render_sem);
+
+        chMtxLock(&oled_bus_mutex);
+        bool success = OLED_TRANSMIT_CMD(oled_tx_start, sizeof(oled_tx_start)) && OLED_TRANSMIT_DATA(oled_block_buffer, oled_tx_length);
+        chMtxUnlock(&oled_bus_mutex);
+
+        oled_tx_failed = !success;
+        oled_tx_busy   = false;
+    }
+}
+#endif
+
+// Sends the whole of block the next time it is rendered
+static void oled_reset_span(uint8_t block) {
+    oled_dirty_first[block] = UINT8_MAX;
+    oled_dirty_last[block]  = 0;
+}
+
+// Marks the whole buffer to be sent, for changes that aren't tracked byte by byte
+static void oled_mark_all_dirty(void) {
+    oled_dirty = OLED_ALL_BLOCKS_MASK;
+    for (uint8_t block = 0; block < OLED_BLOCK_COUNT; block++) {
+        oled_reset_span(block);
     }
+    oled_status_valid = 0;
 }
 
+// Marks length bytes of the buffer from index as changed, only those bytes of their blocks are sent where possible
+static void oled_mark_dirty(uint16_t index, uint16_t length) {
+    uint16_t end = index + length - 1;
+
+    for (uint8_t block = index / OLED_BLOCK_SIZE; block <= end / OLED_BLOCK_SIZE; block++) {
+        uint16_t        block_start = block * OLED_BLOCK_SIZE;
+        uint8_t         first       = index > block_start ? index - block_start : 0;
+        uint8_t         last        = end - block_start < OLED_BLOCK_SIZE ? end - block_start : OLED_BLOCK_SIZE - 1;
+        OLED_BLOCK_TYPE bit         = (OLED_BLOCK_TYPE)1 << block;
+
+        if (!(oled_dirty & bit)) {
+            oled_dirty |= bit;
+            oled_dirty_first[block] = first;
+            oled_dirty_last[block]  = last;
+        } else if (oled_dirty_first[block] <= oled_dirty_last[block]) {
+            // Widen the span, a block already to be sent whole stays that way
+            if (first < oled_dirty_first[block]) oled_dirty_first[block] = first;
+            if (last > oled_dirty_last[block]) oled_dirty_last[block] = last;
+        }
+    }
+
+    // The lines written over no longer hold what oled_write_status_line left there
+    if (oled_status_valid) {
+        for (uint8_t line = index / oled_rotation_width; line <= end / oled_rotation_width && line < OLED_STATUS_LINES; line++) {
+            oled_status_valid &= ~((uint32_t)1 << line);
+        }
+    }
+}
+
+#if defined(SPLIT_KEYBOARD) && defined(SPLIT_OLED_MIRROR)
+// Master: the slave's display, drawn by oled_task_slave_user() and sent a block at a time by the split transport.
+// It is swapped into oled_buffer while it is drawn, so every drawing function works on it.
+static uint8_t         oled_mirror_buffer[OLED_MATRIX_SIZE];
+static OLED_BLOCK_TYPE oled_mirror_dirty = 0;
+static uint8_t         oled_mirror_first[OLED_BLOCK_COUNT];
+static uint8_t         oled_mirror_last[OLED_BLOCK_COUNT];
+static uint32_t        oled_mirror_status_hash[OLED_STATUS_LINES];
+static uint32_t        oled_mirror_status_valid = 0;
+static uint8_t         oled_mirror_next         = 0;  // the block looked at first, so a block that is always dirty can't hold up the rest
+
+static void oled_swap_bytes(void *a, void *b, uint16_t size) {
+    uint8_t *x = a;
+    uint8_t *y = b;
+    for (uint16_t i = 0; i < size; i++) {
+        uint8_t byte = x[i];
+        x[i]         = y[i];
+        y[i]         = byte;
+    }
+}
+
+// Exchanges the buffer and dirty state of the master's display with the slave's
+static void oled_mirror_swap(void) {
+    oled_swap_bytes(oled_buffer, oled_mirror_buffer, sizeof(oled_buffer));
+    oled_swap_bytes(&oled_dirty, &oled_mirror_dirty, sizeof(oled_dirty));
+    oled_swap_bytes(oled_dirty_first, oled_mirror_first, sizeof(oled_dirty_first));
+    oled_swap_bytes(oled_dirty_last, oled_mirror_last, sizeof(oled_dirty_last));
+    oled_swap_bytes(oled_status_hash, oled_mirror_status_hash, sizeof(oled_status_hash));
+    oled_swap_bytes(&oled_status_valid, &oled_mirror_status_valid, sizeof(oled_status_valid));
+}
+
+void oled_mirror_resend(void) {
+    oled_mirror_dirty = OLED_ALL_BLOCKS_MASK;
+    for (uint8_t block = 0; block < OLED_BLOCK_COUNT; block++) {
+        oled_mirror_first[block] = UINT8_MAX;
+        oled_mirror_last[block]  = 0;
+    }
+}
+
+uint8_t oled_mirror_next_block(void) {
+    for (uint8_t i = 0; i < OLED_BLOCK_COUNT; i++) {
+        uint8_t block = (oled_mirror_next + i) % OLED_BLOCK_COUNT;
+        if (oled_mirror_dirty & ((OLED_BLOCK_TYPE)1 << block)) {
+            return block;
+        }
+    }
+    return OLED_BLOCK_COUNT;
+}
+
+const uint8_t *oled_mirror_block_data(uint8_t block) { return &oled_mirror_buffer[OLED_BLOCK_SIZE * block]; }
+
+void oled_mirror_block_sent(uint8_t block) {
+    oled_mirror_dirty &= ~((OLED_BLOCK_TYPE)1 << block);
+    oled_mirror_first[block] = UINT8_MAX;
+    oled_mirror_last[block]  = 0;
+    oled_mirror_next         = (block + 1) % OLED_BLOCK_COUNT;
+}
+
+void oled_mirror_write_block(uint8_t block, const uint8_t *data) {
+    if (block >= OLED_BLOCK_COUNT) {
+        return;
+    }
+    uint8_t *dest  = &oled_buffer[OLED_BLOCK_SIZE * block];
+    uint16_t first = 0;
+    uint16_t last  = OLED_BLOCK_SIZE;
+    while (first < OLED_BLOCK_SIZE && dest[first] == data[first]) {
+        first++;
+    }
+    if (first == OLED_BLOCK_SIZE) {
+        return;
+    }
+    while (dest[last - 1] == data[last - 1]) {
+        last--;
+    }
+    // Only the bytes that differ are rendered again
+    memcpy(&dest[first], &data[first], last - first);
+    oled_mark_dirty(OLED_BLOCK_SIZE * block + first, last - first);
+}
+
+__attribute__((weak)) void oled_task_slave_user(void) {}
+#endif
+
 bool oled_init(uint8_t rotation) {
     oled_rotation = oled_init_user(rotation);
     if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
@@ -158,7 +409,19 @@ bool oled_init(uint8_t rotation) {
     } else {
         oled_rotation_width = OLED_DISPLAY_HEIGHT;
     }
+#if defined(OLED_TRANSPORT_SPI)
+    spi_init();
+    setPinOutput(OLED_DC_PIN);
+#    if defined(OLED_RST_PIN)
+    // Datasheet asks for at least 3us of reset before the first command
+    setPinOutput(OLED_RST_PIN);
+    writePinLow(OLED_RST_PIN);
+    wait_us(10);
+    writePinHigh(OLED_RST_PIN);
+#    endif
+#else
     i2c_init();
+#endif
 
     static const uint8_t PROGMEM display_setup1[] = {
         I2C_CMD,
@@ -178,27 +441,27 @@ bool oled_init(uint8_t rotation) {
         0x00,  // Horizontal addressing mode
 #endif
     };
-    if (I2C_TRANSMIT_P(display_setup1) != I2C_STATUS_SUCCESS) {
+    if (!OLED_SEND_CMD_P(display_setup1)) {
         print("oled_init cmd set 1 failed\n");
         return false;
     }
 
     if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_180)) {
         static const uint8_t PROGMEM display_normal[] = {I2C_CMD, SEGMENT_REMAP_INV, COM_SCAN_DEC};
-        if (I2C_TRANSMIT_P(display_normal) != I2C_STATUS_SUCCESS) {
+        if (!OLED_SEND_CMD_P(display_normal)) {
             print("oled_init cmd normal rotation failed\n");
             return false;
         }
     } else {
         static const uint8_t PROGMEM display_flipped[] = {I2C_CMD, SEGMENT_REMAP, COM_SCAN_INC};
-        if (I2C_TRANSMIT_P(display_flipped) != I2C_STATUS_SUCCESS) {
+        if (!OLED_SEND_CMD_P(display_flipped)) {
             print("display_flipped failed\n");
             return false;
         }
     }
 
     static const uint8_t PROGMEM display_setup2[] = {I2C_CMD, COM_PINS, OLED_COM_PINS, CONTRAST, OLED_BRIGHTNESS, PRE_CHARGE_PERIOD, 0xF1, VCOM_DETECT, 0x20, DISPLAY_ALL_ON_RESUME, NORMAL_DISPLAY, DEACTIVATE_SCROLL, DISPLAY_ON};
-    if (I2C_TRANSMIT_P(display_setup2) != I2C_STATUS_SUCCESS) {
+    if (!OLED_SEND_CMD_P(display_setup2)) {
         print("display_setup2 failed\n");
         return false;
     }
@@ -211,9 +474,20 @@ bool oled_init(uint8_t rotation) {
 #endif
 
     oled_clear();
+#if defined(SPLIT_KEYBOARD) && defined(SPLIT_OLED_MIRROR)
+    oled_mirror_resend();
+#endif
     oled_initialized = true;
     oled_active      = true;
     oled_scrolling   = false;
+
+#if defined(OLED_RENDER_THREAD)
+    static bool thread_started = false;
+    if (!thread_started) {
+        chThdCreateStatic(waOLEDRenderThread, sizeof(waOLEDRenderThread), OLED_THREAD_PRIORITY, OLEDRenderThread, NULL);
+        thread_started = true;
+    }
+#endif
     return true;
 }
 
@@ -222,13 +496,14 @@ __attribute__((weak)) oled_rotation_t oled_init_user(oled_rotation_t rotation) {
 void oled_clear(void) {
     memset(oled_buffer, 0, sizeof(oled_buffer));
     oled_cursor = &oled_buffer[0];
-    oled_dirty  = OLED_ALL_BLOCKS_MASK;
+    oled_mark_all_dirty();
 }
 
-static void calc_bounds(uint8_t update_start, uint8_t *cmd_array) {
+// first and length pick out the bytes of the block that are sent, all of them unless OLED_PARTIAL_BLOCKS
+static void calc_bounds(uint8_t update_start, uint8_t first, uint16_t length, uint8_t *cmd_array) {
     // Calculate commands to set memory addressing bounds.
     uint8_t start_page   = OLED_BLOCK_SIZE * update_start / OLED_DISPLAY_WIDTH;
-    uint8_t start_column = OLED_BLOCK_SIZE * update_start % OLED_DISPLAY_WIDTH;
+    uint8_t start_column = OLED_BLOCK_SIZE * update_start % OLED_DISPLAY_WIDTH + first;
 #if (OLED_IC == OLED_IC_SH1106)
     // Commands for Page Addressing Mode. Sets starting page and column; has no end bound.
     // Column value must be split into high and low nybble and sent as two commands.
@@ -242,7 +517,7 @@ static void calc_bounds(uint8_t update_start, uint8_t *cmd_array) {
     // Commands for use in Horizontal Addressing mode.
     cmd_array[1] = start_column;
     cmd_array[4] = start_page;
-    cmd_array[2] = (OLED_BLOCK_SIZE + OLED_DISPLAY_WIDTH - 1) % OLED_DISPLAY_WIDTH + cmd_array[1];
+    cmd_array[2] = length < OLED_BLOCK_SIZE ? start_column + length - 1 : (OLED_BLOCK_SIZE + OLED_DISPLAY_WIDTH - 1) % OLED_DISPLAY_WIDTH + cmd_array[1];
     cmd_array[5] = (OLED_BLOCK_SIZE + OLED_DISPLAY_WIDTH - 1) / OLED_DISPLAY_WIDTH - 1;
 #endif
 }
@@ -275,6 +550,18 @@ void oled_render(void) {
         return;
     }
 
+#if defined(OLED_RENDER_THREAD)
+    // The previous block is still on the bus
+    if (oled_tx_busy) {
+        return;
+    }
+    if (oled_tx_failed) {
+        oled_dirty |= (OLED_BLOCK_TYPE)1 << oled_tx_block;
+        oled_reset_span(oled_tx_block);
+        oled_tx_failed = false;
+    }
+#endif
+
     // Do we have work to do?
     oled_dirty &= OLED_ALL_BLOCKS_MASK;
     if (!oled_dirty || oled_scrolling) {
@@ -287,49 +574,65 @@ void oled_render(void) {
         ++update_start;
     }
 
+    // Only the bytes that changed are sent, unless the block is rotated or spans pages
+    uint8_t  first  = 0;
+    uint16_t length = OLED_BLOCK_SIZE;
+    if (OLED_PARTIAL_BLOCKS && !HAS_FLAGS(oled_rotation, OLED_ROTATION_90) && oled_dirty_first[update_start] <= oled_dirty_last[update_start]) {
+        first  = oled_dirty_first[update_start];
+        length = oled_dirty_last[update_start] - first + 1;
+    }
+
     // Set column & page position
     static uint8_t display_start[] = {I2C_CMD, COLUMN_ADDR, 0, OLED_DISPLAY_WIDTH - 1, PAGE_ADDR, 0, OLED_DISPLAY_HEIGHT / 8 - 1};
     if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
-        calc_bounds(update_start, &display_start[1]);  // Offset from I2C_CMD byte at the start
+        calc_bounds(update_start, first, length, &display_start[1]);  // Offset from I2C_CMD byte at the start
     } else {
         calc_bounds_90(update_start, &display_start[1]);  // Offset from I2C_CMD byte at the start
     }
 
-    // Send column & page position
-    if (I2C_TRANSMIT(display_start) != I2C_STATUS_SUCCESS) {
-        print("oled_render offset command failed\n");
-        return;
-    }
-
-    if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
-        // Send render data chunk as is
-        if (I2C_WRITE_REG(I2C_DATA, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
-            print("oled_render data failed\n");
-            return;
-        }
-    } else {
-        // Rotate the render chunks
+    // Only the dirty block is rotated, the rest of the buffer is left untouched
+    const uint8_t *block = &oled_buffer[OLED_BLOCK_SIZE * update_start + first];
+    if (HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
         const static uint8_t source_map[] = OLED_SOURCE_MAP;
         const static uint8_t target_map[] = OLED_TARGET_MAP;
 
-        static uint8_t temp_buffer[OLED_BLOCK_SIZE];
-        memset(temp_buffer, 0, sizeof(temp_buffer));
+        memset(oled_block_buffer, 0, sizeof(oled_block_buffer));
         for (uint8_t i = 0; i < sizeof(source_map); ++i) {
-            rotate_90(&oled_buffer[OLED_BLOCK_SIZE * update_start + source_map[i]], &temp_buffer[target_map[i]]);
+            rotate_90(&block[source_map[i]], &oled_block_buffer[target_map[i]]);
         }
+        block = oled_block_buffer;
+    }
 
-        // Send render data chunk after rotating
-        if (I2C_WRITE_REG(I2C_DATA, &temp_buffer[0], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
-            print("oled_render90 data failed\n");
-            return;
-        }
+#if defined(OLED_RENDER_THREAD)
+    // Hand a copy of the block to the render thread, drawing can carry on in oled_buffer meanwhile
+    if (block != oled_block_buffer) {
+        memcpy(oled_block_buffer, block, length);
+    }
+    memcpy(oled_tx_start, display_start, sizeof(oled_tx_start));
+    oled_tx_block  = update_start;
+    oled_tx_length = length;
+    oled_tx_busy  = true;
+    chBSemSignal(&oled_render_sem);
+#else
+    // Send column & page position
+    if (!OLED_SEND_CMD(display_start)) {
+        print("oled_render offset command failed\n");
+        return;
     }
 
+    // Send render data chunk
+    if (!OLED_TRANSMIT_DATA(block, length)) {
+        print("oled_render data failed\n");
+        return;
+    }
+#endif
+
     // Turn on display if it is off
     oled_on();
 
     // Clear dirty flag
     oled_dirty &= ~((OLED_BLOCK_TYPE)1 << update_start);
+    oled_reset_span(update_start);
 }
 
 void oled_set_cursor(uint8_t col, uint8_t line) {
@@ -396,32 +699,34 @@ void oled_write_char(const char data, bool invert) {
         return;
     }
 
-    // copy the current render buffer to check for dirty after
-    static uint8_t oled_temp_buffer[OLED_FONT_WIDTH];
-    memcpy(&oled_temp_buffer, oled_cursor, OLED_FONT_WIDTH);
-
     _Static_assert(sizeof(font) >= ((OLED_FONT_END + 1 - OLED_FONT_START) * OLED_FONT_WIDTH), "OLED_FONT_END references outside array");
 
-    // set the reder buffer data
-    uint8_t cast_data = (uint8_t)data;  // font based on unsigned type for index
-    if (cast_data < OLED_FONT_START || cast_data > OLED_FONT_END) {
-        memset(oled_cursor, 0x00, OLED_FONT_WIDTH);
-    } else {
-        const uint8_t *glyph = &font[(cast_data - OLED_FONT_START) * OLED_FONT_WIDTH];
-        memcpy_P(oled_cursor, glyph, OLED_FONT_WIDTH);
+    const uint8_t *glyph     = NULL;
+    uint8_t        cast_data = (uint8_t)data;  // font based on unsigned type for index
+    if (cast_data >= OLED_FONT_START && cast_data <= OLED_FONT_END) {
+        glyph = &font[(cast_data - OLED_FONT_START) * OLED_FONT_WIDTH];
     }
 
-    // Invert if needed
-    if (invert) {
-        InvertCharacter(oled_cursor);
+    // Write the glyph over the render buffer, keeping track of the columns that change
+    uint8_t first = OLED_FONT_WIDTH;
+    uint8_t last  = 0;
+    for (uint8_t i = 0; i < OLED_FONT_WIDTH; i++) {
+        uint8_t column = glyph ? pgm_read_byte(&glyph[i]) : 0x00;
+        if (invert) {
+            column = ~column;
+        }
+        if (oled_cursor[i] != column) {
+            oled_cursor[i] = column;
+            if (first == OLED_FONT_WIDTH) {
+                first = i;
+            }
+            last = i;
+        }
     }
 
     // Dirty check
-    if (memcmp(&oled_temp_buffer, oled_cursor, OLED_FONT_WIDTH)) {
-        uint16_t index = oled_cursor - &oled_buffer[0];
-        oled_dirty |= ((OLED_BLOCK_TYPE)1 << (index / OLED_BLOCK_SIZE));
-        // Edgecase check if the written data spans the 2 chunks
-        oled_dirty |= ((OLED_BLOCK_TYPE)1 << ((index + OLED_FONT_WIDTH - 1) / OLED_BLOCK_SIZE));
+    if (first < OLED_FONT_WIDTH) {
+        oled_mark_dirty(oled_cursor - &oled_buffer[0] + first, last - first + 1);
     }
 
     // Finally move to the next char
@@ -441,6 +746,45 @@ void oled_write_ln(const char *data, bool invert) {
     oled_advance_page(true);
 }
 
+static void oled_write_status_line_impl(uint8_t line, const char *data, bool invert, bool progmem) {
+    if (!oled_initialized || line >= oled_max_lines()) {
+        return;
+    }
+
+    // FNV-1a over what the line is to show, up to the characters that fit
+    uint8_t  max_chars = oled_max_chars();
+    uint8_t  length    = 0;
+    uint32_t hash      = invert ? 0x811C9DC5 ^ 0xFF : 0x811C9DC5;
+    for (; length < max_chars; length++) {
+        char c = progmem ? pgm_read_byte(&data[length]) : data[length];
+        if (c == '\0' || c == '\n' || c == '\r') {
+            break;
+        }
+        hash = (hash ^ (uint8_t)c) * 0x01000193;
+    }
+
+    uint32_t line_bit = (uint32_t)1 << line;
+    if ((oled_status_valid & line_bit) && oled_status_hash[line] == hash) {
+        return;
+    }
+
+    uint8_t *cursor = oled_cursor;
+    oled_set_cursor(0, line);
+    for (uint8_t i = 0; i < max_chars; i++) {
+        if (i < length) {
+            oled_write_char(progmem ? pgm_read_byte(&data[i]) : data[i], invert);
+        } else {
+            oled_write_char(' ', false);
+        }
+    }
+    oled_cursor = cursor;
+
+    oled_status_hash[line] = hash;
+    oled_status_valid |= line_bit;
+}
+
+void oled_write_status_line(uint8_t line, const char *data, bool invert) { oled_write_status_line_impl(line, data, invert, false); }
+
 void oled_pan(bool left) {
     uint16_t i = 0;
     for (uint16_t y = 0; y < OLED_DISPLAY_HEIGHT / 8; y++) {
@@ -456,7 +800,7 @@ void oled_pan(bool left) {
             }
         }
     }
-    oled_dirty = OLED_ALL_BLOCKS_MASK;
+    oled_mark_all_dirty();
 }
 
 oled_buffer_reader_t oled_read_raw(uint16_t start_index) {
@@ -468,10 +812,10 @@ oled_buffer_reader_t oled_read_raw(uint16_t start_index) {
 }
 
 void oled_write_raw_byte(const char data, uint16_t index) {
-    if (index > OLED_MATRIX_SIZE) index = OLED_MATRIX_SIZE;
+    if (index >= OLED_MATRIX_SIZE) return;
     if (oled_buffer[index] == data) return;
     oled_buffer[index] = data;
-    oled_dirty |= ((OLED_BLOCK_TYPE)1 << (index / OLED_BLOCK_SIZE));
+    oled_mark_dirty(index, 1);
 }
 
 void oled_write_raw(const char *data, uint16_t size) {
@@ -480,7 +824,7 @@ void oled_write_raw(const char *data, uint16_t size) {
     for (uint16_t i = cursor_start_index; i < cursor_start_index + size; i++) {
         if (oled_buffer[i] == data[i]) continue;
         oled_buffer[i] = data[i];
-        oled_dirty |= ((OLED_BLOCK_TYPE)1 << (i / OLED_BLOCK_SIZE));
+        oled_mark_dirty(i, 1);
     }
 }
 
@@ -500,7 +844,7 @@ void oled_write_pixel(uint8_t x, uint8_t y, bool on) {
     }
     if (oled_buffer[index] != data) {
         oled_buffer[index] = data;
-        oled_dirty |= ((OLED_BLOCK_TYPE)1 << (index / OLED_BLOCK_SIZE));
+        oled_mark_dirty(index, 1);
     }
 }
 
@@ -525,9 +869,11 @@ void oled_write_raw_P(const char *data, uint16_t size) {
         uint8_t c = pgm_read_byte(data++);
         if (oled_buffer[i] == c) continue;
         oled_buffer[i] = c;
-        oled_dirty |= ((OLED_BLOCK_TYPE)1 << (i / OLED_BLOCK_SIZE));
+        oled_mark_dirty(i, 1);
     }
 }
+
+void oled_write_status_line_P(uint8_t line, const char *data, bool invert) { oled_write_status_line_impl(line, data, invert, true); }
 #endif  // defined(__AVR__)
 
 bool oled_on(void) {
@@ -541,7 +887,7 @@ bool oled_on(void) {
 
     static const uint8_t PROGMEM display_on[] = {I2C_CMD, DISPLAY_ON};
     if (!oled_active) {
-        if (I2C_TRANSMIT_P(display_on) != I2C_STATUS_SUCCESS) {
+        if (!OLED_SEND_CMD_P(display_on)) {
             print("oled_on cmd failed\n");
             return oled_active;
         }
@@ -557,7 +903,7 @@ bool oled_off(void) {
 
     static const uint8_t PROGMEM display_off[] = {I2C_CMD, DISPLAY_OFF};
     if (oled_active) {
-        if (I2C_TRANSMIT_P(display_off) != I2C_STATUS_SUCCESS) {
+        if (!OLED_SEND_CMD_P(display_off)) {
             print("oled_off cmd failed\n");
             return oled_active;
         }
@@ -575,7 +921,7 @@ uint8_t oled_set_brightness(uint8_t level) {
 
     uint8_t set_contrast[] = {I2C_CMD, CONTRAST, level};
     if (oled_brightness != level) {
-        if (I2C_TRANSMIT(set_contrast) != I2C_STATUS_SUCCESS) {
+        if (!OLED_SEND_CMD(set_contrast)) {
             print("set_brightness cmd failed\n");
             return oled_brightness;
         }
@@ -620,7 +966,7 @@ bool oled_scroll_right(void) {
     // This prevents scrolling of bad data from starting the scroll too early after init
     if (!oled_dirty && !oled_scrolling) {
         uint8_t display_scroll_right[] = {I2C_CMD, SCROLL_RIGHT, 0x00, oled_scroll_start, oled_scroll_speed, oled_scroll_end, 0x00, 0xFF, ACTIVATE_SCROLL};
-        if (I2C_TRANSMIT(display_scroll_right) != I2C_STATUS_SUCCESS) {
+        if (!OLED_SEND_CMD(display_scroll_right)) {
             print("oled_scroll_right cmd failed\n");
             return oled_scrolling;
         }
@@ -638,7 +984,7 @@ bool oled_scroll_left(void) {
     // This prevents scrolling of bad data from starting the scroll too early after init
     if (!oled_dirty && !oled_scrolling) {
         uint8_t display_scroll_left[] = {I2C_CMD, SCROLL_LEFT, 0x00, oled_scroll_start, oled_scroll_speed, oled_scroll_end, 0x00, 0xFF, ACTIVATE_SCROLL};
-        if (I2C_TRANSMIT(display_scroll_left) != I2C_STATUS_SUCCESS) {
+        if (!OLED_SEND_CMD(display_scroll_left)) {
             print("oled_scroll_left cmd failed\n");
             return oled_scrolling;
         }
@@ -654,12 +1000,12 @@ bool oled_scroll_off(void) {
 
     if (oled_scrolling) {
         static const uint8_t PROGMEM display_scroll_off[] = {I2C_CMD, DEACTIVATE_SCROLL};
-        if (I2C_TRANSMIT_P(display_scroll_off) != I2C_STATUS_SUCCESS) {
+        if (!OLED_SEND_CMD_P(display_scroll_off)) {
             print("oled_scroll_off cmd failed\n");
             return oled_scrolling;
         }
         oled_scrolling = false;
-        oled_dirty     = OLED_ALL_BLOCKS_MASK;
+        oled_mark_all_dirty();
     }
     return !oled_scrolling;
 }
@@ -678,6 +1024,28 @@ uint8_t oled_max_lines(void) {
     return OLED_DISPLAY_WIDTH / OLED_FONT_HEIGHT;
 }
 
+// Lets the keymap draw the display, and with SPLIT_OLED_MIRROR the master draw the slave's too
+static void oled_draw(void) {
+#if defined(SPLIT_KEYBOARD) && defined(SPLIT_OLED_MIRROR)
+    // The slave's display arrives from the master through the split transport
+    if (!is_keyboard_master()) {
+        return;
+    }
+    oled_set_cursor(0, 0);
+    oled_task_user();
+
+    uint8_t *cursor = oled_cursor;
+    oled_mirror_swap();
+    oled_set_cursor(0, 0);
+    oled_task_slave_user();
+    oled_mirror_swap();
+    oled_cursor = cursor;
+#else
+    oled_set_cursor(0, 0);
+    oled_task_user();
+#endif
+}
+
 void oled_task(void) {
     if (!oled_initialized) {
         return;
@@ -686,12 +1054,10 @@ void oled_task(void) {
 #if OLED_UPDATE_INTERVAL > 0
     if (timer_elapsed(oled_update_timeout) >= OLED_UPDATE_INTERVAL) {
         oled_update_timeout = timer_read();
-        oled_set_cursor(0, 0);
-        oled_task_user();
+        oled_draw();
     }
 #else
-    oled_set_cursor(0, 0);
-    oled_task_user();
+    oled_draw();
 #endif
 
 #if OLED_SCROLL_TIMEOUT > 0
@@ -213,6 +213,11 @@ void oled_write(const char *data, bool invert);
 // Advances the cursor to the next page, wiring ' ' to the remainder of the current page
 void oled_write_ln(const char *data, bool invert);
 
+// Writes a string over the whole of the given line, wiring ' ' to the remainder of it
+// Nothing is written while the line still shows the same string, leaves the cursor where it was
+// Meant for status screens that are redrawn every frame, text that doesn't fit is cut off
+void oled_write_status_line(uint8_t line, const char *data, bool invert);
+
 // Pans the buffer to the right (or left by passing true) by moving contents of the buffer
 void oled_pan(bool left);
 
@@ -240,6 +245,10 @@ void oled_write_P(const char *data, bool invert);
 void oled_write_ln_P(const char *data, bool invert);
 
 void oled_write_raw_P(const char *data, uint16_t size);
+
+// Writes a PROGMEM string over the whole of the given line, see 'oled_write_status_line'
+// Remapped to call 'void oled_write_status_line(uint8_t line, const char *data, bool invert);' on ARM
+void oled_write_status_line_P(uint8_t line, const char *data, bool invert);
 #else
 // Writes a string to the buffer at current cursor position
 // Advances the cursor while writing, inverts the pixels if true
@@ -251,6 +260,9 @@ void oled_write_raw_P(const char *data, uint16_t size);
 #    define oled_write_ln_P(data, invert) oled_write(data, invert)
 
 #    define oled_write_raw_P(data, size) oled_write_raw(data, size)
+
+// Writes a string over the whole of the given line, see 'oled_write_status_line'
+#    define oled_write_status_line_P(line, data, invert) oled_write_status_line(line, data, invert)
 #endif  // defined(__AVR__)
 
 // Can be used to manually turn on the screen if it is off
@@ -277,6 +289,21 @@ void oled_task(void);
 // Called at the start of oled_task, weak function overridable by the user
 void oled_task_user(void);
 
+#if defined(SPLIT_KEYBOARD) && defined(SPLIT_OLED_MIRROR)
+// Called on the master right after oled_task_user, draws the slave's display, weak function overridable by the user
+void oled_task_slave_user(void);
+
+// Used by the split transport. On the master, the next block of the slave's display that changed, OLED_BLOCK_COUNT
+// if there is none, its data, and that it arrived. On the slave, writes a block received from the master.
+uint8_t        oled_mirror_next_block(void);
+const uint8_t *oled_mirror_block_data(uint8_t block);
+void           oled_mirror_block_sent(uint8_t block);
+void           oled_mirror_write_block(uint8_t block, const uint8_t *data);
+
+// Sends the whole of the slave's display again, for when the slave was reset
+void oled_mirror_resend(void);
+#endif
+
 // Set the specific 8 lines rows of the screen to scroll.
 // 0 is the default for start, and 7 for end, which is the entire
 // height of the screen.  For 128x32 screens, rows 4-7 are not used.
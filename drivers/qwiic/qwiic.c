@@ -15,6 +15,55 @@
  */
 #include "qwiic.h"
 
+#include <stddef.h>
+#include "timer.h"
+
+static qwiic_device_t *qwiic_devices = NULL;
+
+#ifdef I2C_ASYNC
+static void qwiic_read_done(i2c_transaction_t *transaction) {
+    qwiic_device_t *device = transaction->context;
+    device->pending        = false;
+    device->callback(device, transaction->status == I2C_STATUS_SUCCESS);
+}
+#endif
+
+static void qwiic_device_read(qwiic_device_t *device) {
+    device->last_read = timer_read();
+#ifdef I2C_ASYNC
+    device->pending     = true;
+    device->transaction = (i2c_transaction_t){
+        .address   = device->address,
+        .tx        = &device->reg,
+        .tx_length = 1,
+        .rx        = device->data,
+        .rx_length = device->length,
+        .timeout   = QWIIC_TIMEOUT,
+        .callback  = qwiic_read_done,
+        .context   = device,
+    };
+    i2c_submit(&device->transaction);
+#else
+    device->callback(device, i2c_readReg(device->address, device->reg, device->data, device->length, QWIIC_TIMEOUT) == I2C_STATUS_SUCCESS);
+#endif
+}
+
+/** \brief Adds a device for qwiic_task() to read, which must stay valid from then on
+ */
+void qwiic_device_add(qwiic_device_t *device) {
+    i2c_init();
+    if (device->int_pin != NO_PIN) {
+        setPinInputHigh(device->int_pin);
+    }
+    if (!device->interval) {
+        device->interval = QWIIC_POLL_INTERVAL;
+    }
+    device->pending   = false;
+    device->last_read = timer_read();
+    device->next      = qwiic_devices;
+    qwiic_devices     = device;
+}
+
 void qwiic_init(void) {
 #ifdef QWIIC_JOYSTIIC_ENABLE
     joystiic_init();
@@ -28,4 +77,13 @@ void qwiic_task(void) {
 #ifdef QWIIC_JOYSTIIC_ENABLE
     joystiic_task();
 #endif
+
+    for (qwiic_device_t *device = qwiic_devices; device; device = device->next) {
+        if (device->pending) {
+            continue;
+        }
+        if (device->int_pin != NO_PIN ? !readPin(device->int_pin) : timer_elapsed(device->last_read) >= device->interval) {
+            qwiic_device_read(device);
+        }
+    }
 }
@@ -15,7 +15,10 @@
  */
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
 #include "i2c_master.h"
+#include "gpio.h"
 
 #ifdef QWIIC_JOYSTIIC_ENABLE
 #    include "joystiic.h"
@@ -24,5 +27,54 @@
 #    include "micro_oled.h"
 #endif
 
+/*
+ * Devices added with qwiic_device_add() have a register read by qwiic_task()
+ * and handed to their callback. A device with an interrupt line, active low,
+ * is only read while it is asserted, the others every `interval`
+ * milliseconds:
+ *
+ *   static uint8_t        buttons[2];
+ *   static qwiic_device_t keypad = {
+ *       .address  = 0x4B << 1,
+ *       .reg      = 0x03,
+ *       .data     = buttons,
+ *       .length   = sizeof(buttons),
+ *       .int_pin  = B5,
+ *       .callback = keypad_read,
+ *   };
+ *
+ * With I2C_ASYNC, the reads are queued and the callbacks run from the main
+ * loop once they are done, so the keyboard carries on scanning while the bus
+ * is busy. Without it, the reads block in qwiic_task().
+ */
+
+#ifndef QWIIC_POLL_INTERVAL
+#    define QWIIC_POLL_INTERVAL 50
+#endif
+#ifndef QWIIC_TIMEOUT
+#    define QWIIC_TIMEOUT 100
+#endif
+
+typedef struct qwiic_device qwiic_device_t;
+
+struct qwiic_device {
+    uint8_t  address;   // shifted, as i2c_master takes it
+    uint8_t  reg;       // register read into data
+    uint8_t *data;
+    uint16_t length;
+    pin_t    int_pin;   // low when the device has something to read, NO_PIN if not wired
+    uint16_t interval;  // milliseconds between reads without int_pin, 0 for QWIIC_POLL_INTERVAL
+    void (*callback)(qwiic_device_t *device, bool success);
+
+    // The rest is qwiic's own
+    bool            pending;  // a read is queued
+    uint16_t        last_read;
+    qwiic_device_t *next;
+#ifdef I2C_ASYNC
+    i2c_transaction_t transaction;
+#endif
+};
+
 void qwiic_init(void);
 void qwiic_task(void);
+void qwiic_device_add(qwiic_device_t *device);
@@ -0,0 +1,201 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pmw3360.h"
+#include "progmem.h"
+#include "pmw3360_firmware.h"
+#include "spi_master.h"
+#include "gpio.h"
+#include "wait.h"
+
+#ifndef PMW3360_CS_PIN
+#    ifdef SPI_SS_PIN
+#        define PMW3360_CS_PIN SPI_SS_PIN
+#    else
+#        error "PMW3360_CS_PIN must be defined"
+#    endif
+#endif
+
+// The sensor takes up to 2 MHz, in SPI mode 3
+#ifndef PMW3360_SPI_DIVISOR
+#    ifdef __AVR__
+#        define PMW3360_SPI_DIVISOR (F_CPU / 2000000)
+#    else
+#        define PMW3360_SPI_DIVISOR 64
+#    endif
+#endif
+
+// Turns the image by -30 to 30 degrees, for sensors that aren't mounted square
+#ifndef PMW3360_ANGLE_TUNE
+#    define PMW3360_ANGLE_TUNE 0
+#endif
+#if PMW3360_ANGLE_TUNE < -30 || PMW3360_ANGLE_TUNE > 30
+#    error "PMW3360_ANGLE_TUNE must be from -30 to 30"
+#endif
+
+#define REG_Product_ID 0x00
+#define REG_Motion 0x02
+#define REG_Delta_X_L 0x03
+#define REG_Delta_X_H 0x04
+#define REG_Delta_Y_L 0x05
+#define REG_Delta_Y_H 0x06
+#define REG_Config1 0x0F
+#define REG_Config2 0x10
+#define REG_Angle_Tune 0x11
+#define REG_SROM_Enable 0x13
+#define REG_SROM_ID 0x2A
+#define REG_Power_Up_Reset 0x3A
+#define REG_Inverse_Product_ID 0x3F
+#define REG_Motion_Burst 0x50
+#define REG_SROM_Load_Burst 0x62
+
+// Motion register bits
+#define MOTION_MOT 0x80
+#define MOTION_LIFT_STAT 0x08
+#define MOTION_OP_MODE 0x06
+
+// Any other register access ends burst mode, the next burst read has to start it again
+static bool     pmw3360_in_burst = false;
+static uint16_t pmw3360_cpi      = PMW3360_CPI;
+
+static bool pmw3360_start(void) { return spi_start(PMW3360_CS_PIN, false, 3, PMW3360_SPI_DIVISOR); }
+
+static void pmw3360_write(uint8_t reg, uint8_t data) {
+    pmw3360_in_burst = false;
+    if (!pmw3360_start()) {
+        return;
+    }
+    spi_write(reg | 0x80);
+    spi_write(data);
+    wait_us(35);  // tSCLK-NCS for a write
+    spi_stop();
+    wait_us(145);  // tSWW and tSWR are 180 us from the last clock
+}
+
+static uint8_t pmw3360_read(uint8_t reg) {
+    pmw3360_in_burst = false;
+    if (!pmw3360_start()) {
+        return 0;
+    }
+    spi_write(reg & 0x7F);
+    wait_us(160);  // tSRAD
+    uint8_t data = spi_read();
+    wait_us(1);  // tSCLK-NCS for a read
+    spi_stop();
+    wait_us(19);  // tSRW and tSRR are 20 us from the last clock
+    return data;
+}
+
+static void pmw3360_upload_firmware(void) {
+    // Rest modes off, the sensor always runs at full rate
+    pmw3360_write(REG_Config2, 0x00);
+    pmw3360_write(REG_Angle_Tune, (uint8_t)(int8_t)PMW3360_ANGLE_TUNE);
+    pmw3360_write(REG_SROM_Enable, 0x1D);
+    wait_ms(10);
+    pmw3360_write(REG_SROM_Enable, 0x18);
+
+    if (pmw3360_start()) {
+        spi_write(REG_SROM_Load_Burst | 0x80);
+        wait_us(15);
+        for (uint16_t i = 0; i < firmware_length; i++) {
+            spi_write(pgm_read_byte(firmware_data + i));
+            wait_us(15);
+        }
+        spi_stop();
+    }
+    wait_us(200);
+
+    pmw3360_read(REG_SROM_ID);
+    pmw3360_write(REG_Config2, 0x00);
+    wait_ms(10);
+}
+
+bool pmw3360_init(void) {
+#ifdef PMW3360_MOTION_PIN
+    setPinInputHigh(PMW3360_MOTION_PIN);
+#endif
+    spi_init();
+
+    // A chip select cycle resets the sensor's serial port
+    if (pmw3360_start()) {
+        spi_stop();
+    }
+    pmw3360_write(REG_Power_Up_Reset, 0x5A);
+    wait_ms(50);
+
+    // Clears the motion from before the reset
+    pmw3360_read(REG_Motion);
+    pmw3360_read(REG_Delta_X_L);
+    pmw3360_read(REG_Delta_X_H);
+    pmw3360_read(REG_Delta_Y_L);
+    pmw3360_read(REG_Delta_Y_H);
+
+    pmw3360_upload_firmware();
+    pmw3360_set_cpi(pmw3360_cpi);
+    wait_ms(1);
+
+    uint8_t pid      = pmw3360_read(REG_Product_ID);
+    uint8_t inv_pid  = pmw3360_read(REG_Inverse_Product_ID);
+    uint8_t srom_ver = pmw3360_read(REG_SROM_ID);
+    return pid == 0x42 && inv_pid == 0xBD && srom_ver == 0x04;
+}
+
+bool pmw3360_motion_pending(void) {
+#ifdef PMW3360_MOTION_PIN
+    // Held low from the first motion until the motion is read
+    return !readPin(PMW3360_MOTION_PIN);
+#else
+    return true;
+#endif
+}
+
+pmw3360_report_t pmw3360_read_burst(void) {
+    pmw3360_report_t report = {0};
+    uint8_t          burst[6];
+
+    if (!pmw3360_in_burst) {
+        pmw3360_write(REG_Motion_Burst, 0x00);
+        pmw3360_in_burst = true;
+    }
+    if (!pmw3360_start()) {
+        return report;
+    }
+    // Motion, Observation, Delta_X_L, Delta_X_H, Delta_Y_L and Delta_Y_H in one transfer
+    spi_write(REG_Motion_Burst);
+    wait_us(35);  // tSRAD_MOTBR
+    spi_status_t status = spi_receive(burst, sizeof(burst));
+    spi_stop();
+    wait_us(1);  // tBEXIT
+
+    // The operation mode is always run with the rest modes off, anything else is a garbled burst
+    if (status != SPI_STATUS_SUCCESS || (burst[0] & MOTION_OP_MODE)) {
+        pmw3360_in_burst = false;
+        return report;
+    }
+    report.motion     = (burst[0] & MOTION_MOT) != 0;
+    report.on_surface = (burst[0] & MOTION_LIFT_STAT) == 0;
+    report.dx         = (int16_t)(burst[2] | (burst[3] << 8));
+    report.dy         = (int16_t)(burst[4] | (burst[5] << 8));
+    return report;
+}
+
+void pmw3360_set_cpi(uint16_t cpi) {
+    cpi         = cpi < PMW3360_CPI_MIN ? PMW3360_CPI_MIN : cpi > PMW3360_CPI_MAX ? PMW3360_CPI_MAX : cpi;
+    pmw3360_cpi = cpi / 100 * 100;
+    pmw3360_write(REG_Config1, cpi / 100 - 1);
+}
+
+uint16_t pmw3360_get_cpi(void) { return pmw3360_cpi; }
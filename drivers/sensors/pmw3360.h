@@ -0,0 +1,44 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef PMW3360_CPI
+#    define PMW3360_CPI 1600
+#endif
+
+// The sensor takes 100 to 12000 CPI, in steps of 100
+#define PMW3360_CPI_MIN 100
+#define PMW3360_CPI_MAX 12000
+
+typedef struct {
+    int16_t dx;          // counts moved since the last read, CPI counts per inch
+    int16_t dy;
+    bool    motion;      // dx or dy moved
+    bool    on_surface;  // false once the sensor is lifted off
+} pmw3360_report_t;
+
+// Resets the sensor and uploads its firmware, false if it doesn't answer with the expected signature
+bool pmw3360_init(void);
+// Whether the sensor has motion waiting, always true without PMW3360_MOTION_PIN
+bool pmw3360_motion_pending(void);
+// Reads the motion since the last read, in a single SPI transfer
+pmw3360_report_t pmw3360_read_burst(void);
+void             pmw3360_set_cpi(uint16_t cpi);
+uint16_t         pmw3360_get_cpi(void);
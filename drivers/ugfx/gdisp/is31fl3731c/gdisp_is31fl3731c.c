@@ -108,6 +108,9 @@ typedef struct {
     uint8_t write_buffer[IS31_FRAME_SIZE];
     uint8_t frame_buffer[GDISP_SCREEN_HEIGHT * GDISP_SCREEN_WIDTH];
     uint8_t page;
+    // PWM registers changed since each of the two frames was last written, none if the start is after the end
+    uint8_t dirty_start[2];
+    uint8_t dirty_end[2];
 } __attribute__((__packed__)) PrivData;
 
 // Some common routines and macros
@@ -138,6 +141,16 @@ static GFXINLINE void write_ram(GDisplay *g, uint8_t page, uint16_t offset, uint
     write_data(g, (uint8_t *)PRIV(g), length + 1);
 }
 
+// Writes the PWM registers from IS31_PWM_REG + start on, the byte before them in the private area holding the address
+static GFXINLINE void write_pwm(GDisplay *g, uint8_t page, uint8_t start, uint8_t length) {
+    uint8_t *tx    = (uint8_t *)PRIV(g) + start;
+    uint8_t  saved = *tx;
+    *tx            = IS31_PWM_REG + start;
+    write_page(g, page);
+    write_data(g, tx, length + 1);
+    *tx = saved;
+}
+
 LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
     // The private area is the display surface.
     g->priv = gfxAlloc(sizeof(PrivData));
@@ -170,6 +183,13 @@ LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
     write_register(g, IS31_FUNCTIONREG, IS31_REG_SHUTDOWN, IS31_REG_SHUTDOWN_OFF);
     gfxSleepMilliseconds(10);
 
+    // Both frames' PWM registers are all zero now
+    __builtin_memset(PRIV(g)->write_buffer, 0, IS31_PWM_SIZE);
+    for (uint8_t i = 0; i < 2; i++) {
+        PRIV(g)->dirty_start[i] = 0xFF;
+        PRIV(g)->dirty_end[i]   = 0;
+    }
+
     // Finish Init
     post_init_board(g);
 
@@ -188,23 +208,34 @@ LLDSPEC void gdisp_lld_flush(GDisplay *g) {
     // Don't flush if we don't need it.
     if (!(g->flags & GDISP_FLG_NEEDFLUSH)) return;
 
-    PRIV(g)->page++;
-    PRIV(g)->page %= 2;
-    // TODO: some smarter algorithm for this
-    // We should run only one physical page at a time
-    // This way we don't need to send so much data, and
-    // we could use slightly less memory
+    // Only the LEDs that changed are sent, to the frame not on display, which is then shown
     uint8_t *src = PRIV(g)->frame_buffer;
     for (int y = 0; y < GDISP_SCREEN_HEIGHT; y++) {
         for (int x = 0; x < GDISP_SCREEN_WIDTH; x++) {
-            uint8_t val                                     = (uint16_t)*src * g->g.Backlight / 100;
-            PRIV(g)->write_buffer[get_led_address(g, x, y)] = CIE1931_CURVE[val];
+            uint8_t val     = (uint16_t)*src * g->g.Backlight / 100;
+            uint8_t address = get_led_address(g, x, y);
+            uint8_t pwm     = CIE1931_CURVE[val];
+            if (PRIV(g)->write_buffer[address] != pwm) {
+                PRIV(g)->write_buffer[address] = pwm;
+                for (uint8_t i = 0; i < 2; i++) {
+                    if (address < PRIV(g)->dirty_start[i]) PRIV(g)->dirty_start[i] = address;
+                    if (address > PRIV(g)->dirty_end[i]) PRIV(g)->dirty_end[i] = address;
+                }
+            }
             ++src;
         }
     }
-    write_ram(g, PRIV(g)->page, IS31_PWM_REG, IS31_PWM_SIZE);
+
+    PRIV(g)->page++;
+    PRIV(g)->page %= 2;
+    uint8_t page = PRIV(g)->page;
+    if (PRIV(g)->dirty_start[page] <= PRIV(g)->dirty_end[page]) {
+        write_pwm(g, page, PRIV(g)->dirty_start[page], PRIV(g)->dirty_end[page] - PRIV(g)->dirty_start[page] + 1);
+        PRIV(g)->dirty_start[page] = 0xFF;
+        PRIV(g)->dirty_end[page]   = 0;
+    }
     gfxSleepMilliseconds(1);
-    write_register(g, IS31_FUNCTIONREG, IS31_REG_PICTDISP, PRIV(g)->page);
+    write_register(g, IS31_FUNCTIONREG, IS31_REG_PICTDISP, page);
 
     g->flags &= ~GDISP_FLG_NEEDFLUSH;
 }
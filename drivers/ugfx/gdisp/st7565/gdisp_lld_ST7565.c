@@ -77,6 +77,23 @@
 #    define xyaddr(x, y) ((x) + ((y) >> 3) * GDISP_SCREEN_WIDTH)
 #    define xybit(y) (1 << ((y)&7))
 
+/*
+ * Each page keeps the range of columns drawn to since it was last flushed,
+ * after the display surface, and only those are sent. A clean page starts
+ * after it ends.
+ */
+#    define PAGES (GDISP_SCREEN_HEIGHT / 8)
+#    define RAM_SIZE (GDISP_SCREEN_HEIGHT * GDISP_SCREEN_WIDTH / 8)
+#    define DIRTY_START(g) (RAM(g) + RAM_SIZE)
+#    define DIRTY_END(g) (DIRTY_START(g) + PAGES)
+
+static GFXINLINE void mark_dirty(GDisplay *g, coord_t x, coord_t y) {
+    gU8 page = y >> 3;
+    if (x < DIRTY_START(g)[page]) DIRTY_START(g)[page] = x;
+    if (x > DIRTY_END(g)[page]) DIRTY_END(g)[page] = x;
+    g->flags |= GDISP_FLG_NEEDFLUSH;
+}
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -89,11 +106,16 @@
  */
 
 LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
-    // The private area is the display surface.
-    g->priv = gfxAlloc(GDISP_SCREEN_HEIGHT * GDISP_SCREEN_WIDTH / 8);
+    // The private area is the display surface, followed by the dirty columns of each page.
+    g->priv = gfxAlloc(RAM_SIZE + 2 * PAGES);
     if (!g->priv) {
         return gFalse;
     }
+    // What the controller shows is unknown, so the first flush sends everything
+    for (unsigned p = 0; p < PAGES; p++) {
+        DIRTY_START(g)[p] = 0;
+        DIRTY_END(g)[p]   = GDISP_SCREEN_WIDTH - 1;
+    }
 
     // Initialise the board interface
     init_board(g);
@@ -158,11 +180,17 @@ LLDSPEC void gdisp_lld_flush(GDisplay *g) {
     acquire_bus(g);
     gU8 pagemap[] = {ST7565_PAGE_ORDER};
     for (p = 0; p < sizeof(pagemap); p++) {
+        gU8 start = DIRTY_START(g)[p];
+        if (start > DIRTY_END(g)[p]) continue;
+
         write_cmd(g, ST7565_PAGE | pagemap[p]);
-        write_cmd(g, ST7565_COLUMN_MSB | 0);
-        write_cmd(g, ST7565_COLUMN_LSB | 0);
+        write_cmd(g, ST7565_COLUMN_MSB | (start >> 4));
+        write_cmd(g, ST7565_COLUMN_LSB | (start & 0x0F));
         write_cmd(g, ST7565_RMW);
-        write_data(g, RAM(g) + (p * GDISP_SCREEN_WIDTH), GDISP_SCREEN_WIDTH);
+        write_data(g, RAM(g) + (p * GDISP_SCREEN_WIDTH) + start, DIRTY_END(g)[p] - start + 1);
+
+        DIRTY_START(g)[p] = 0xFF;
+        DIRTY_END(g)[p]   = 0;
     }
     release_bus(g);
 
@@ -193,11 +221,12 @@ LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g) {
             y = g->p.x;
             break;
     }
+    gU8 old = RAM(g)[xyaddr(x, y)];
     if (gdispColor2Native(g->p.color) != Black)
         RAM(g)[xyaddr(x, y)] |= xybit(y);
     else
         RAM(g)[xyaddr(x, y)] &= ~xybit(y);
-    g->flags |= GDISP_FLG_NEEDFLUSH;
+    if (RAM(g)[xyaddr(x, y)] != old) mark_dirty(g, x, y);
 }
 #    endif
 
@@ -243,16 +272,17 @@ LLDSPEC void gdisp_lld_blit_area(GDisplay *g) {
             uint8_t  bit    = 7 - (srcbit % 8);
             uint8_t  bitset = (src >> bit) & 1;
             uint8_t *dst    = &(RAM(g)[xyaddr(dstx, dsty)]);
+            uint8_t  old    = *dst;
             if (bitset) {
                 *dst |= xybit(dsty);
             } else {
                 *dst &= ~xybit(dsty);
             }
+            if (*dst != old) mark_dirty(g, dstx, dsty);
             dstx++;
             srcbit++;
         }
     }
-    g->flags |= GDISP_FLG_NEEDFLUSH;
 }
 #    endif
 
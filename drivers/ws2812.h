@@ -38,3 +38,15 @@
  *         - Wait 50us to reset the LEDs
  */
 void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds);
+
+/* Asynchronous interface
+ *
+ * Same as ws2812_setleds(), but returns as soon as the LED data has been encoded, on drivers
+ * that can send it in the background. The callback, if not NULL, is called once the frame has
+ * been sent, from interrupt context on DMA based drivers. A frame that gets replaced by a newer
+ * one before its transfer started is dropped, and its callback is not called.
+ * Blocking drivers send the data before returning and call the callback right away.
+ */
+typedef void (*ws2812_callback_t)(void);
+
+void ws2812_setleds_async(LED_TYPE *ledarray, uint16_t number_of_leds, ws2812_callback_t callback);
@@ -40,3 +40,5 @@ Ported to QMK by Peter Roe <pete@13bit.me>
 #define ADB_DDR         DDRD
 #define ADB_DATA_BIT    0
 //#define ADB_PSW_BIT     1       // optional
+// Poll without blocking, timestamping the edges on INT0 (PD0)
+//#define ADB_ASYNC
@@ -75,6 +75,26 @@ void matrix_init(void)
     matrix_init_quantum();
 }
 
+#ifdef ADB_ASYNC
+/* Starts a Talk to register 0 every 12ms and returns true once it is done,
+ * the keyboard and the mouse take turns as only one Talk can run at a time */
+static bool adb_poll(uint8_t addr, uint16_t *tick_ms, bool *pending, uint16_t *codes)
+{
+    if (*pending) {
+        uint8_t buf[2];
+        if (adb_host_talk_busy()) return false;
+        *pending = false;
+        *codes = adb_host_talk_result(buf, 2) == 2 ? buf[0] << 8 | buf[1] : 0;
+        return true;
+    }
+    if (timer_elapsed(*tick_ms) >= 12 && adb_host_talk_start(addr, ADB_REG_0)) {
+        *tick_ms = timer_read();
+        *pending = true;
+    }
+    return false;
+}
+#endif
+
 #ifdef ADB_MOUSE_ENABLE
 
 #ifdef MAX
@@ -93,11 +113,16 @@ void adb_mouse_task(void)
     /* tick of last polling */
     static uint16_t tick_ms;
 
+#ifdef ADB_ASYNC
+    static bool pending;
+    if (!adb_poll(ADB_ADDR_MOUSE, &tick_ms, &pending, &codes)) return;
+#else
     // polling with 12ms interval
     if (timer_elapsed(tick_ms) < 12) return;
     tick_ms = timer_read();
 
     codes = adb_host_mouse_recv();
+#endif
     // If nothing received reset mouse acceleration, and quit.
     if (!codes) {
         mouseacc = 1;
@@ -162,11 +187,16 @@ uint8_t matrix_scan(void)
 
     if ( codes == 0xFFFF )
     {
+#ifdef ADB_ASYNC
+        static bool pending;
+        if (!adb_poll(ADB_ADDR_KEYBOARD, &tick_ms, &pending, &codes)) return 0;
+#else
         // polling with 12ms interval
         if (timer_elapsed(tick_ms) < 12) return 0;
         tick_ms = timer_read();
 
         codes = adb_host_kbd_recv();
+#endif
     }
 
     key0 = codes>>8;
@@ -29,6 +29,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MATRIX_ROWS 16
 #define MATRIX_COLS 16
 
+/* poll the keyboards every millisecond rather than at the interval they ask for */
+//#define USB_HOST_POLL_INTERVAL 1
+
 /*
  * Feature disable options
  *  These options are also useful to firmware size reduction.
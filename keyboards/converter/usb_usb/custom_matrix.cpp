@@ -135,21 +135,21 @@ extern "C"
     }
 
     uint8_t matrix_scan(void) {
-        static uint16_t last_time_stamp1 = 0;
-        static uint16_t last_time_stamp2 = 0;
-        static uint16_t last_time_stamp3 = 0;
-        static uint16_t last_time_stamp4 = 0;
+        // Poll the keyboards first, so that what they report is seen by this very scan
+        uint16_t timer;
+        timer = timer_read();
+        usb_host.Task();
+        timer = timer_elapsed(timer);
+        if (timer > 100) {
+            dprintf("host.Task: %d\n", timer);
+        }
 
         // check report came from keyboards
-        if (kbd_parser1.time_stamp != last_time_stamp1 ||
-            kbd_parser2.time_stamp != last_time_stamp2 ||
-            kbd_parser3.time_stamp != last_time_stamp3 ||
-            kbd_parser4.time_stamp != last_time_stamp4) {
-
-            last_time_stamp1 = kbd_parser1.time_stamp;
-            last_time_stamp2 = kbd_parser2.time_stamp;
-            last_time_stamp3 = kbd_parser3.time_stamp;
-            last_time_stamp4 = kbd_parser4.time_stamp;
+        if (kbd_parser1.updated || kbd_parser2.updated || kbd_parser3.updated || kbd_parser4.updated) {
+            kbd_parser1.updated = false;
+            kbd_parser2.updated = false;
+            kbd_parser3.updated = false;
+            kbd_parser4.updated = false;
 
             // clear and integrate all reports
             local_keyboard_report = {};
@@ -169,14 +169,6 @@ extern "C"
             matrix_is_mod = false;
         }
 
-        uint16_t timer;
-        timer = timer_read();
-        usb_host.Task();
-        timer = timer_elapsed(timer);
-        if (timer > 100) {
-            dprintf("host.Task: %d\n", timer);
-        }
-
         static uint8_t usb_state = 0;
         if (usb_state != usb_host.getUsbTaskState()) {
             usb_state = usb_host.getUsbTaskState();
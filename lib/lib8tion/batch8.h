@@ -0,0 +1,142 @@
+#ifndef __INC_LIB8TION_BATCH_H
+#define __INC_LIB8TION_BATCH_H
+
+#include "math8.h"
+#include "scale8.h"
+
+///@ingroup lib8tion
+
+///@defgroup Batch Four bytes at a time
+/// Saturating math and scaling on four bytes packed into a uint32_t, and
+/// on whole arrays of bytes such as LED frame buffers.
+///
+/// On Cortex-M4 and M7 the saturating adds and subtracts are single DSP
+/// instructions. Elsewhere on 32 bit chips the four bytes are worked on
+/// together in plain C, and on AVR the arrays go one byte at a time
+/// through the assembly versions, which are faster there.
+///@{
+
+#if defined(__arm__) && defined(__ARM_FEATURE_DSP)
+#define BATCH8_ARM_DSP_ASM 1
+#else
+#define BATCH8_ARM_DSP_ASM 0
+#endif
+
+#define BATCH8_HIGH_BITS 0x80808080UL
+#define BATCH8_EVEN_BYTES 0x00FF00FFUL
+
+/// add four bytes to four others, each saturating at 0xFF
+LIB8STATIC_ALWAYS_INLINE uint32_t qadd8x4( uint32_t i, uint32_t j)
+{
+#if BATCH8_ARM_DSP_ASM == 1
+    asm( "uqadd8 %0, %0, %1" : "+r" (i) : "r" (j));
+    return i;
+#else
+    // add the low seven bits of each byte, then work out what carries out of the top one
+    uint32_t low   = (i & ~BATCH8_HIGH_BITS) + (j & ~BATCH8_HIGH_BITS);
+    uint32_t sum   = low ^ ((i ^ j) & BATCH8_HIGH_BITS);
+    uint32_t carry = ((i & j) | ((i | j) & low)) & BATCH8_HIGH_BITS;
+    return sum | ((carry >> 7) * 0xFF);
+#endif
+}
+
+/// subtract four bytes from four others, each with a floor of 0
+LIB8STATIC_ALWAYS_INLINE uint32_t qsub8x4( uint32_t i, uint32_t j)
+{
+#if BATCH8_ARM_DSP_ASM == 1
+    asm( "uqsub8 %0, %0, %1" : "+r" (i) : "r" (j));
+    return i;
+#else
+    // subtract the low seven bits of each byte, then work out what borrows out of the top one
+    uint32_t diff   = ((i | BATCH8_HIGH_BITS) - (j & ~BATCH8_HIGH_BITS)) ^ ((i ^ ~j) & BATCH8_HIGH_BITS);
+    uint32_t borrow = ((~i & j) | (~(i ^ j) & diff)) & BATCH8_HIGH_BITS;
+    return diff & ~((borrow >> 7) * 0xFF);
+#endif
+}
+
+/// scale four bytes by the same fraction, as scale8() does each of them
+LIB8STATIC_ALWAYS_INLINE uint32_t scale8x4( uint32_t i, fract8 scale)
+{
+    // every other byte is spread over a 16 bit lane, whose product can't spill into the next
+#if (FASTLED_SCALE8_FIXED == 1)
+    uint32_t factor = (uint32_t)scale + 1;
+#else
+    uint32_t factor = scale;
+#endif
+    uint32_t even = (i & BATCH8_EVEN_BYTES) * factor;
+    uint32_t odd  = ((i >> 8) & BATCH8_EVEN_BYTES) * factor;
+    return ((even >> 8) & BATCH8_EVEN_BYTES) | (odd & ~BATCH8_EVEN_BYTES);
+}
+
+/// scale four bytes by the same fraction, as scale8_video() does each of them
+LIB8STATIC_ALWAYS_INLINE uint32_t scale8_video_x4( uint32_t i, fract8 scale)
+{
+    if (!scale) {
+        return 0;
+    }
+    uint32_t even = i & BATCH8_EVEN_BYTES;
+    uint32_t odd  = (i >> 8) & BATCH8_EVEN_BYTES;
+    // 1 in each lane holding a non-zero byte
+    uint32_t even_nonzero = ((even + BATCH8_EVEN_BYTES) >> 8) & 0x00010001UL;
+    uint32_t odd_nonzero  = ((odd + BATCH8_EVEN_BYTES) >> 8) & 0x00010001UL;
+    even = (((even * scale) >> 8) & BATCH8_EVEN_BYTES) + even_nonzero;
+    odd  = (((odd * scale) >> 8) & BATCH8_EVEN_BYTES) + odd_nonzero;
+    return even | (odd << 8);
+}
+
+#if defined(__AVR__)
+
+/// add value to every byte of data, saturating at 0xFF
+LIB8STATIC void qadd8_array( uint8_t* data, uint8_t value, uint16_t count)
+{
+    for (; count; count--, data++) *data = qadd8(*data, value);
+}
+
+/// subtract value from every byte of data, with a floor of 0
+LIB8STATIC void qsub8_array( uint8_t* data, uint8_t value, uint16_t count)
+{
+    for (; count; count--, data++) *data = qsub8(*data, value);
+}
+
+/// scale every byte of data, as scale8_video() does
+LIB8STATIC void scale8_video_array( uint8_t* data, fract8 scale, uint16_t count)
+{
+    for (; count; count--, data++) *data = scale8_video(*data, scale);
+}
+
+#else
+
+// data needn't be aligned, memcpy() of four bytes compiles to a single load or store where it can be
+#define BATCH8_ARRAY(data, count, packed_op, byte_op)  \
+    for (; count >= 4; count -= 4, data += 4) {        \
+        uint32_t packed;                               \
+        memcpy(&packed, data, 4);                      \
+        packed = packed_op;                            \
+        memcpy(data, &packed, 4);                      \
+    }                                                  \
+    for (; count; count--, data++) *data = byte_op;
+
+/// add value to every byte of data, saturating at 0xFF
+LIB8STATIC void qadd8_array( uint8_t* data, uint8_t value, uint16_t count)
+{
+    uint32_t values = value * 0x01010101UL;
+    BATCH8_ARRAY(data, count, qadd8x4(packed, values), qadd8(*data, value));
+}
+
+/// subtract value from every byte of data, with a floor of 0
+LIB8STATIC void qsub8_array( uint8_t* data, uint8_t value, uint16_t count)
+{
+    uint32_t values = value * 0x01010101UL;
+    BATCH8_ARRAY(data, count, qsub8x4(packed, values), qsub8(*data, value));
+}
+
+/// scale every byte of data, as scale8_video() does
+LIB8STATIC void scale8_video_array( uint8_t* data, fract8 scale, uint16_t count)
+{
+    BATCH8_ARRAY(data, count, scale8_video_x4(packed, scale), scale8_video(*data, scale));
+}
+
+#endif
+
+///@}
+#endif
@@ -177,19 +177,21 @@ Lib8tion is pronounced like 'libation': lie-BAY-shun
 
 #if defined(__arm__)
 
-#if defined(FASTLED_TEENSY3)
+#if defined(FASTLED_TEENSY3) || defined(__ARM_FEATURE_DSP)
 // Can use Cortex M4 DSP instructions
 #define QADD8_C 0
 #define QADD7_C 0
+#define QSUB8_C 0
 #define QADD8_ARM_DSP_ASM 1
 #define QADD7_ARM_DSP_ASM 1
+#define QSUB8_ARM_DSP_ASM 1
 #else
 // Generic ARM
 #define QADD8_C 1
 #define QADD7_C 1
+#define QSUB8_C 1
 #endif
 
-#define QSUB8_C 1
 #define SCALE8_C 1
 #define SCALE16BY8_C 1
 #define SCALE16_C 1
@@ -357,6 +359,7 @@ typedef int32_t   saccum114;///< no direct ANSI counterpart. 1 bit int, 14 bits
 #include "scale8.h"
 #include "random8.h"
 #include "trig8.h"
+#include "batch8.h"
 
 ///////////////////////////////////////////////////////////////////////
 
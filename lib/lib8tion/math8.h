@@ -108,6 +108,9 @@ LIB8STATIC_ALWAYS_INLINE uint8_t qsub8( uint8_t i, uint8_t j)
          : "a"  (j) );
 
     return i;
+#elif QSUB8_ARM_DSP_ASM == 1
+    asm volatile( "uqsub8 %0, %0, %1" : "+r" (i) : "r" (j));
+    return i;
 #else
 #error "No implementation for qsub8 available."
 #endif
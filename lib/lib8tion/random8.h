@@ -15,10 +15,25 @@
 /// random number seed
 extern uint16_t rand16seed;// = RAND16_SEED;
 
+/// Advance the seed to the next random number
+LIB8STATIC uint16_t random16_next(void)
+{
+#if defined(LIB8TION_RANDOM_XORSHIFT)
+    // xorshift with shifts of 7, 9 and 8, only byte moves and single bit
+    //  shifts where there's no fast 16-bit multiply, never leaves 0
+    rand16seed ^= rand16seed << 7;
+    rand16seed ^= rand16seed >> 9;
+    rand16seed ^= rand16seed << 8;
+#else
+    rand16seed = (rand16seed * FASTLED_RAND16_2053) + FASTLED_RAND16_13849;
+#endif
+    return rand16seed;
+}
+
 /// Generate an 8-bit random number
 LIB8STATIC uint8_t random8(void)
 {
-    rand16seed = (rand16seed * FASTLED_RAND16_2053) + FASTLED_RAND16_13849;
+    random16_next();
     // return the sum of the high and low bytes, for better
     //  mixing and non-sequential correlation
     return (uint8_t)(((uint8_t)(rand16seed & 0xFF)) +
@@ -28,8 +43,7 @@ LIB8STATIC uint8_t random8(void)
 /// Generate a 16 bit random number
 LIB8STATIC uint16_t random16(void)
 {
-    rand16seed = (rand16seed * FASTLED_RAND16_2053) + FASTLED_RAND16_13849;
-    return rand16seed;
+    return random16_next();
 }
 
 /// Generate an 8-bit random number between 0 and lim
@@ -75,6 +89,10 @@ LIB8STATIC uint16_t random16_min_max( uint16_t min, uint16_t lim)
 LIB8STATIC void random16_set_seed(uint16_t seed)
 {
     rand16seed = seed;
+#if defined(LIB8TION_RANDOM_XORSHIFT)
+    // xorshift would be stuck at 0
+    if (!rand16seed) rand16seed = 1;
+#endif
 }
 
 /// Get the current seed value for the random number generator
@@ -87,6 +105,9 @@ LIB8STATIC uint16_t random16_get_seed(void)
 LIB8STATIC void random16_add_entropy(uint16_t entropy)
 {
     rand16seed += entropy;
+#if defined(LIB8TION_RANDOM_XORSHIFT)
+    if (!rand16seed) rand16seed = 1;
+#endif
 }
 
 ///@}
@@ -141,6 +141,7 @@ from . import chibios  # noqa
 from . import clean  # noqa
 from . import compile  # noqa
 from . import config  # noqa
+from . import decode_trace  # noqa
 from . import docs  # noqa
 from . import doctor  # noqa
 from . import fileformat  # noqa
@@ -153,6 +154,7 @@ from . import json2c  # noqa
 from . import lint  # noqa
 from . import list  # noqa
 from . import kle2json  # noqa
+from . import memory_report  # noqa
 from . import multibuild  # noqa
 from . import new  # noqa
 from . import pyformat  # noqa
@@ -20,7 +20,9 @@ from qmk.keymap import keymap_completer
 @cli.argument('-n', '--dry-run', arg_only=True, action='store_true', help="Don't actually build, just show the make command to be run.")
 @cli.argument('-j', '--parallel', type=int, default=1, help="Set the number of parallel make jobs to run.")
 @cli.argument('-e', '--env', arg_only=True, action='append', default=[], help="Set a variable to be passed to make. May be passed multiple times.")
+@cli.argument('-m', '--memory-report', arg_only=True, action='store_true', help="Report RAM and flash use by feature after compiling.")
 @cli.argument('-c', '--clean', arg_only=True, action='store_true', help="Remove object files before compiling.")
+@cli.argument('--native', arg_only=True, action='store_true', help="Build a program for this computer to profile the keyboard and keymap with, instead of the firmware.")
 @cli.subcommand('Compile a QMK Firmware.')
 @automagic_keyboard
 @automagic_keymap
@@ -31,10 +33,6 @@ def compile(cli):
 
     If a keyboard and keymap are provided this command will build a firmware based on that.
     """
-    if cli.args.clean and not cli.args.filename and not cli.args.dry_run:
-        command = create_make_command(cli.config.compile.keyboard, cli.config.compile.keymap, 'clean')
-        cli.run(command, capture_output=False, stdin=DEVNULL)
-
     # Build the environment vars
     envs = {}
     for env in cli.args.env:
@@ -44,6 +42,13 @@ def compile(cli):
         else:
             cli.log.warning('Invalid environment variable: %s', env)
 
+    if cli.args.native:
+        envs['NATIVE'] = 'yes'
+
+    if cli.args.clean and not cli.args.filename and not cli.args.dry_run:
+        command = create_make_command(cli.config.compile.keyboard, cli.config.compile.keymap, 'clean', **envs)
+        cli.run(command, capture_output=False, stdin=DEVNULL)
+
     # Determine the compile command
     command = None
 
@@ -55,7 +60,8 @@ def compile(cli):
     else:
         if cli.config.compile.keyboard and cli.config.compile.keymap:
             # Generate the make command for a specific keyboard/keymap.
-            command = create_make_command(cli.config.compile.keyboard, cli.config.compile.keymap, parallel=cli.config.compile.parallel, **envs)
+            target = 'memory-report' if cli.args.memory_report else None
+            command = create_make_command(cli.config.compile.keyboard, cli.config.compile.keymap, target, parallel=cli.config.compile.parallel, **envs)
 
         elif not cli.config.compile.keyboard:
             cli.log.error('Could not determine keyboard!')
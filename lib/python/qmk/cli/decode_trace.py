@@ -0,0 +1,42 @@
+"""Decode the event trace of a keyboard built with EVENT_TRACE_ENABLE.
+"""
+import sys
+
+from argcomplete.completers import FilesCompleter
+from milc import cli
+
+import qmk.event_trace
+import qmk.path
+
+
+@cli.argument('-c', '--capture', arg_only=True, action='store_true', help='Print the key events as a capture for tests/replay')
+@cli.argument('-b', '--binary', arg_only=True, action='store_true', help='The input holds raw 8 byte records instead of console output')
+@cli.argument('filename', nargs='?', default='-', arg_only=True, type=qmk.path.normpath, completer=FilesCompleter('.txt'), help='Console log to decode, stdin when left out')
+@cli.subcommand('Decode the event trace of a keyboard built with EVENT_TRACE_ENABLE.', hidden=False if cli.config.user.developer else True)
+def decode_trace(cli):
+    """Decode the event trace of a keyboard built with EVENT_TRACE_ENABLE.
+
+    Reads the output of `qmk console` or hid_listen, or raw records with --binary, and prints one line per record. With --capture it prints the key events in the format tests/replay reads instead.
+    """
+    if cli.args.filename.name == '-':
+        source = sys.stdin.buffer.read() if cli.args.binary else sys.stdin
+    elif not cli.args.filename.exists():
+        cli.log.error('File {fg_cyan}%s{style_reset_all} was not found.', cli.args.filename)
+        return False
+    elif cli.args.binary:
+        source = cli.args.filename.read_bytes()
+    else:
+        source = cli.args.filename.read_text(encoding='utf-8', errors='replace').splitlines()
+
+    records = qmk.event_trace.parse_binary(source) if cli.args.binary else qmk.event_trace.parse_lines(source)
+    if cli.args.capture:
+        try:
+            for time, row, col, pressed in qmk.event_trace.capture(records):
+                print('%u %u %u %s' % (time, row, col, 'down' if pressed else 'up'))
+        except ValueError as e:
+            cli.log.error('%s, build the keyboard with EVENT_TRACE_KEYS_ONLY or a larger EVENT_TRACE_SIZE.', e)
+            return False
+        return
+
+    for record in records:
+        print(qmk.event_trace.describe(record))
@@ -5,5 +5,7 @@ from . import docs
 from . import info_json
 from . import keyboard_h
 from . import layouts
+from . import matrix_scan
 from . import rgb_breathe_table
 from . import rules_mk
+from . import send_string_unicode
@@ -1,5 +1,7 @@
 """This script automates the generation of the QMK API data.
 """
+from hashlib import sha1
+from multiprocessing import Pool
 from pathlib import Path
 from shutil import copyfile
 import json
@@ -13,10 +15,76 @@ from qmk.json_schema import json_load
 from qmk.keyboard import list_keyboards
 
 
+def _info_json(keyboard_name):
+    """info_json() for the worker processes, which return None rather than exit when the data is invalid.
+    """
+    try:
+        return info_json(keyboard_name)
+
+    except SystemExit:
+        return None
+
+
+class ApiWriter:
+    """Writes API files whose data changed since the last run, going by the hashes in the index file.
+
+    The data is hashed without its last_updated time, so a file only gets a new one when something else changed.
+    """
+    def __init__(self, api_dir, index_file, dry_run):
+        self.api_dir = api_dir
+        self.index_file = index_file
+        self.dry_run = dry_run
+        self.hashes = {}
+        self.written = 0
+        self.old_hashes = {}
+
+        if index_file.exists():
+            self.old_hashes = json_load(index_file).get('hashes', {})
+
+    def _update(self, file, data_hash, write):
+        key = file.relative_to(self.api_dir).as_posix()
+        self.hashes[key] = data_hash
+
+        if self.old_hashes.get(key) == data_hash and file.exists():
+            return
+
+        self.written += 1
+        if not self.dry_run:
+            file.parent.mkdir(parents=True, exist_ok=True)
+            write()
+            cli.log.debug('Wrote file %s', file)
+
+    def json(self, file, data, cls=None):
+        """Writes the dict data, with last_updated in front.
+        """
+        data_hash = sha1(json.dumps(data, cls=cls).encode('utf-8')).hexdigest()
+        self._update(file, data_hash, lambda: file.write_text(json.dumps({'last_updated': current_datetime(), **data}, cls=cls)))
+
+    def copy(self, file, src_file):
+        self._update(file, sha1(src_file.read_bytes()).hexdigest(), lambda: copyfile(src_file, file))
+
+    def finish(self):
+        """Removes the files that are gone from the data, such as those of deleted keyboards, and writes the index.
+        """
+        for key in self.old_hashes.keys() - self.hashes.keys():
+            file = self.api_dir / key
+            if file.exists() and not self.dry_run:
+                file.unlink()
+                cli.log.debug('Removed file %s', file)
+
+        if not self.dry_run and (self.written or self.hashes != self.old_hashes):
+            self.index_file.write_text(json.dumps({'last_updated': current_datetime(), 'hashes': self.hashes}, cls=InfoJSONEncoder))
+
+        cli.log.info('%d of %d API files changed.', self.written, len(self.hashes))
+
+
+@cli.argument('-j', '--parallel', type=int, default=1, help="Set the number of keyboards to generate the data for at once.")
 @cli.argument('-n', '--dry-run', arg_only=True, action='store_true', help="Don't write the data to disk.")
 @cli.subcommand('Creates a new keymap for the keyboard of your choosing', hidden=False if cli.config.user.developer else True)
 def generate_api(cli):
     """Generates the QMK API data.
+
+    Only files whose data changed are written, api_data/v1/hashes.json has the hash of every file's data.
     """
     api_data_dir = Path('api_data')
     v1_dir = api_data_dir / 'v1'
@@ -25,30 +93,35 @@ def generate_api(cli):
     keyboard_aliases_file = v1_dir / 'keyboard_aliases.json'  # A list of historical keyboard names and their new name
     keyboard_metadata_file = v1_dir / 'keyboard_metadata.json'  # All the data configurator/via needs for initialization
     usb_file = v1_dir / 'usb.json'  # A mapping of USB VID/PID -> keyboard target
+    hashes_file = v1_dir / 'hashes.json'  # The hash of the data in every other file, for incremental updates
 
     if not api_data_dir.exists():
         api_data_dir.mkdir()
 
+    writer = ApiWriter(v1_dir, hashes_file, cli.args.dry_run)
     kb_all = {}
     usb_list = {}
 
     # Generate and write keyboard specific JSON files
-    for keyboard_name in list_keyboards():
-        kb_all[keyboard_name] = info_json(keyboard_name)
+    keyboard_names = list_keyboards()
+    if cli.args.parallel > 1:
+        with Pool(cli.args.parallel) as pool:
+            keyboard_infos = pool.map(_info_json, keyboard_names, chunksize=16)
+
+        if None in keyboard_infos:
+            return False
+
+    else:
+        keyboard_infos = map(info_json, keyboard_names)
+
+    for keyboard_name, keyboard_info_data in zip(keyboard_names, keyboard_infos):
+        kb_all[keyboard_name] = keyboard_info_data
         keyboard_dir = v1_dir / 'keyboards' / keyboard_name
-        keyboard_info = keyboard_dir / 'info.json'
-        keyboard_readme = keyboard_dir / 'readme.md'
         keyboard_readme_src = Path('keyboards') / keyboard_name / 'readme.md'
 
-        keyboard_dir.mkdir(parents=True, exist_ok=True)
-        keyboard_json = json.dumps({'last_updated': current_datetime(), 'keyboards': {keyboard_name: kb_all[keyboard_name]}})
-        if not cli.args.dry_run:
-            keyboard_info.write_text(keyboard_json)
-            cli.log.debug('Wrote file %s', keyboard_info)
-
-            if keyboard_readme_src.exists():
-                copyfile(keyboard_readme_src, keyboard_readme)
-                cli.log.debug('Copied %s -> %s', keyboard_readme_src, keyboard_readme)
+        writer.json(keyboard_dir / 'info.json', {'keyboards': {keyboard_name: kb_all[keyboard_name]}})
+        if keyboard_readme_src.exists():
+            writer.copy(keyboard_dir / 'readme.md', keyboard_readme_src)
 
         if 'usb' in kb_all[keyboard_name]:
             usb = kb_all[keyboard_name]['usb']
@@ -65,23 +138,16 @@ def generate_api(cli):
     # Generate data for the global files
     keyboard_list = sorted(kb_all)
     keyboard_aliases = json_load(Path('data/mappings/keyboard_aliases.json'))
-    keyboard_metadata = {
-        'last_updated': current_datetime(),
+
+    # Write the global JSON files
+    writer.json(keyboard_all_file, {'keyboards': kb_all}, cls=InfoJSONEncoder)
+    writer.json(usb_file, {'usb': usb_list}, cls=InfoJSONEncoder)
+    writer.json(keyboard_list_file, {'keyboards': keyboard_list}, cls=InfoJSONEncoder)
+    writer.json(keyboard_aliases_file, {'keyboard_aliases': keyboard_aliases}, cls=InfoJSONEncoder)
+    writer.json(keyboard_metadata_file, {
         'keyboards': keyboard_list,
         'keyboard_aliases': keyboard_aliases,
         'usb': usb_list,
-    }
+    }, cls=InfoJSONEncoder)
 
-    # Write the global JSON files
-    keyboard_all_json = json.dumps({'last_updated': current_datetime(), 'keyboards': kb_all}, cls=InfoJSONEncoder)
-    usb_json = json.dumps({'last_updated': current_datetime(), 'usb': usb_list}, cls=InfoJSONEncoder)
-    keyboard_list_json = json.dumps({'last_updated': current_datetime(), 'keyboards': keyboard_list}, cls=InfoJSONEncoder)
-    keyboard_aliases_json = json.dumps({'last_updated': current_datetime(), 'keyboard_aliases': keyboard_aliases}, cls=InfoJSONEncoder)
-    keyboard_metadata_json = json.dumps(keyboard_metadata, cls=InfoJSONEncoder)
-
-    if not cli.args.dry_run:
-        keyboard_all_file.write_text(keyboard_all_json)
-        usb_file.write_text(usb_json)
-        keyboard_list_file.write_text(keyboard_list_json)
-        keyboard_aliases_file.write_text(keyboard_aliases_json)
-        keyboard_metadata_file.write_text(keyboard_metadata_json)
+    writer.finish()
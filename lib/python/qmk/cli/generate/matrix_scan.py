@@ -0,0 +1,166 @@
+"""Used by the make system to generate matrix_scan.h from info.json.
+"""
+import re
+
+from milc import cli
+
+from qmk.decorators import automagic_keyboard, automagic_keymap
+from qmk.info import info_json
+from qmk.keyboard import keyboard_completer, keyboard_folder
+from qmk.path import is_keyboard, normpath
+
+# Pins named after their port and pad, B4 or A10, can be read a port at a time
+PORT_PIN_RE = re.compile(r'^([A-Z]+)(\d+)$')
+
+
+def _port_groups(pins):
+    """Splits pins into the ones that can be read a port at a time and the rest.
+
+    Returns a dict of port name to (first pin, {shift: mask}) and a list of (index, pin) read one by one. Every bit of a mask is an index, the pad of the index's pin is the index plus shift.
+    """
+    ports = {}
+    single = []
+
+    for index, pin in enumerate(pins):
+        match = PORT_PIN_RE.match(pin or '')
+
+        if not match:
+            single.append((index, pin))
+            continue
+
+        port, pad = match.group(1), int(match.group(2))
+        runs = ports.setdefault(port, (pin, {}))[1]
+        shift = pad - index
+        runs[shift] = runs.get(shift, 0) | (1 << index)
+
+    return ports, single
+
+
+def _read_function(name, result_type, pins):
+    """Returns the lines of a function reading every pin, active low, into one bit per pin.
+    """
+    ports, single = _port_groups(pins)
+    lines = ['static inline %s %s(void) {' % (result_type, name)]
+    terms = []
+
+    for port, (first_pin, runs) in ports.items():
+        lines.append('    port_data_t port_%s = ~readPinPort(%s);' % (port.lower(), first_pin))
+
+        for shift, mask in sorted(runs.items()):
+            if shift >= 0:
+                terms.append('((%s)(port_%s >> %d) & 0x%X)' % (result_type, port.lower(), shift, mask))
+            else:
+                terms.append('(((%s)port_%s << %d) & 0x%X)' % (result_type, port.lower(), -shift, mask))
+
+    for index, pin in single:
+        if pin:
+            terms.append('(readPin(%s) ? 0 : ((%s)1 << %d))' % (pin, result_type, index))
+
+    if terms:
+        lines.append('    return %s;' % ' |\n           '.join(terms))
+    else:
+        lines.append('    return 0;')
+
+    lines.append('}')
+
+    return lines
+
+
+def _switch_function(name, action, pins):
+    """Returns the lines of a function applying action to the pin of the given index.
+    """
+    lines = ['static inline void %s(uint8_t index) {' % name, '    switch (index) {']
+
+    for index, pin in enumerate(pins):
+        if pin:
+            lines.append('        case %d:' % index)
+            lines.append('            %s(%s);' % (action, pin))
+            lines.append('            break;')
+
+    lines.append('    }')
+    lines.append('}')
+
+    return lines
+
+
+def generate_matrix_scan_h(keyboard, kb_info_json):
+    """Returns the contents of matrix_scan.h, or None if the keyboard's matrix cannot be generated.
+    """
+    matrix_pins = kb_info_json.get('matrix_pins', {})
+    diode_direction = kb_info_json.get('diode_direction')
+
+    if 'rows' not in matrix_pins or 'cols' not in matrix_pins:
+        cli.log.error('%s: A generated matrix scan needs matrix_pins.rows and matrix_pins.cols.', keyboard)
+        return None
+
+    if diode_direction == 'COL2ROW':
+        outputs, inputs = matrix_pins['rows'], matrix_pins['cols']
+        select, unselect, read, read_type = 'select_row', 'unselect_row', 'read_cols', 'matrix_row_t'
+    elif diode_direction == 'ROW2COL':
+        outputs, inputs = matrix_pins['cols'], matrix_pins['rows']
+        select, unselect, read, read_type = 'select_col', 'unselect_col', 'read_rows', 'uint32_t'
+        if len(inputs) > 32:
+            cli.log.error('%s: A generated ROW2COL matrix scan supports at most 32 rows.', keyboard)
+            return None
+    else:
+        cli.log.error('%s: A generated matrix scan needs diode_direction COL2ROW or ROW2COL.', keyboard)
+        return None
+
+    lines = [
+        '/* This file was generated by `qmk generate-matrix-scan`. Do not edit or copy.',
+        ' */',
+        '',
+        '#pragma once',
+        '',
+        '// Included by quantum/matrix.c for MATRIX_SCAN_DRIVER = generated, every pin is known at compile time',
+        '',
+    ]
+    lines.extend(_switch_function(select, 'setPinOutput_writeLow', outputs))
+    lines.append('')
+    lines.extend(_switch_function(unselect, 'setPinInputHigh_atomic', outputs))
+    lines.append('')
+    lines.extend(_read_function(read, read_type, inputs))
+
+    return '\n'.join(lines) + '\n'
+
+
+@cli.argument('-o', '--output', arg_only=True, type=normpath, help='File to write to')
+@cli.argument('-q', '--quiet', arg_only=True, action='store_true', help="Quiet mode, only output error messages")
+@cli.argument('-kb', '--keyboard', type=keyboard_folder, completer=keyboard_completer, help='Keyboard to generate matrix_scan.h for.')
+@cli.subcommand('Used by the make system to generate matrix_scan.h from info.json', hidden=True)
+@automagic_keyboard
+@automagic_keymap
+def generate_matrix_scan(cli):
+    """Generates the matrix_scan.h file.
+    """
+    # Determine our keyboard(s)
+    if not cli.config.generate_matrix_scan.keyboard:
+        cli.log.error('Missing parameter: --keyboard')
+        cli.subcommands['info'].print_help()
+        return False
+
+    if not is_keyboard(cli.config.generate_matrix_scan.keyboard):
+        cli.log.error('Invalid keyboard: "%s"', cli.config.generate_matrix_scan.keyboard)
+        return False
+
+    # Build the info.json file
+    kb_info_json = info_json(cli.config.generate_matrix_scan.keyboard)
+
+    # Build the matrix_scan.h file.
+    matrix_scan_h = generate_matrix_scan_h(cli.config.generate_matrix_scan.keyboard, kb_info_json)
+
+    if matrix_scan_h is None:
+        return False
+
+    # Show the results
+    if cli.args.output:
+        cli.args.output.parent.mkdir(parents=True, exist_ok=True)
+        if cli.args.output.exists():
+            cli.args.output.replace(cli.args.output.parent / (cli.args.output.name + '.bak'))
+        cli.args.output.write_text(matrix_scan_h)
+
+        if not cli.args.quiet:
+            cli.log.info('Wrote matrix_scan.h to %s.', cli.args.output)
+
+    else:
+        print(matrix_scan_h)
@@ -0,0 +1,238 @@
+"""Used by the make system to generate send_string_unicode.h from a keymap_extras locale header.
+"""
+import re
+import unicodedata
+from pathlib import Path
+
+from milc import cli
+
+from qmk.path import normpath
+
+KEYMAP_EXTRAS = Path('quantum/keymap_extras')
+
+# `#define DE_ADIA KC_QUOT // Ä` or `#define DE_CIRC KC_GRV  // ^ (dead)`
+DEFINE_RE = re.compile(r'^#define\s+(\w+)\s+(.+?)\s*(?://\s*(.*))?$')
+WRAPPER_RE = re.compile(r'^(\w+)\((.+)\)$')
+
+# The modifier each keycode wrapper in keymap_extras adds, as the MOD_BIT() name
+WRAPPER_MODS = {
+    'S': 'KC_LSFT',
+    'LSFT': 'KC_LSFT',
+    'ALGR': 'KC_RALT',
+    'A': 'KC_LALT',
+    'RCTL': 'KC_RCTL',
+}
+
+# Dead keys whose character has no compatibility decomposition onto the combining mark they add
+DEAD_MARKS = {
+    '^': '̂',
+    '`': '̀',
+    '~': '̃',
+    '°': '̊',
+}
+
+
+def _parse_defines(locale):
+    """Returns the name to (value, comment) of every #define in the locale header.
+    """
+    defines = {}
+
+    for line in (KEYMAP_EXTRAS / f'keymap_{locale}.h').read_text(encoding='utf-8').splitlines():
+        match = DEFINE_RE.match(line.strip())
+
+        if match:
+            defines[match.group(1)] = (match.group(2), match.group(3) or '')
+
+    return defines
+
+
+def _resolve(defines, value, depth=0):
+    """Resolves a keycode expression to (KC_ name, set of modifier names), or None.
+    """
+    value = value.strip()
+
+    if depth > 16:
+        return None
+
+    match = WRAPPER_RE.match(value)
+    if match:
+        if match.group(1) not in WRAPPER_MODS:
+            return None
+        inner = _resolve(defines, match.group(2), depth + 1)
+        if inner is None:
+            return None
+        return inner[0], inner[1] | {WRAPPER_MODS[match.group(1)]}
+
+    if value.startswith('KC_'):
+        return value, frozenset()
+
+    if value in defines:
+        return _resolve(defines, defines[value][0], depth + 1)
+
+    return None
+
+
+def _comment_char(comment):
+    """Returns the character a define's comment names, and whether it is a dead key, or (None, False).
+    """
+    dead = comment.endswith('(dead)')
+    text = comment[:-len('(dead)')].strip() if dead else comment.strip()
+    # Emoji-style variation selectors don't change the character typed
+    text = text.replace('︎', '').replace('️', '')
+
+    if len(text) != 1:
+        return None, False
+
+    return text, dead
+
+
+def _layout_keys(locale):
+    """Returns the character to (keycode, mods, dead) of every character the locale types with a single key.
+    """
+    defines = _parse_defines(locale)
+    keys = {}
+
+    def add(char, keycode, mods, dead):
+        # The fewest modifiers wins where a character can be typed in more than one way
+        if char not in keys or len(mods) < len(keys[char][1]):
+            keys[char] = (keycode, mods, dead)
+
+    for name, (value, comment) in defines.items():
+        # macOS variants of a layout live in the same header
+        if name.endswith('_MAC'):
+            continue
+
+        char, dead = _comment_char(comment)
+        resolved = _resolve(defines, value)
+
+        if char is None or resolved is None:
+            continue
+
+        keycode, mods = resolved
+        lower, upper = char.lower(), char.upper()
+
+        # A letter's key types it in lower case, and in upper case with Shift
+        if char == upper and lower != upper and len(lower) == 1 and 'KC_LSFT' not in mods and not dead:
+            add(lower, keycode, mods, dead)
+            add(upper, keycode, mods | {'KC_LSFT'}, dead)
+        else:
+            add(char, keycode, mods, dead)
+
+    return keys
+
+
+def _dead_mark(char):
+    """Returns the combining mark the dead key for char adds, or None.
+    """
+    if char in DEAD_MARKS:
+        return DEAD_MARKS[char]
+
+    decomposed = unicodedata.normalize('NFKD', char)
+    if len(decomposed) == 2 and decomposed[0] == ' ' and unicodedata.combining(decomposed[1]):
+        return decomposed[1]
+
+    return None
+
+
+def _mods_c(mods):
+    if not mods:
+        return '0'
+
+    return ' | '.join('MOD_BIT(%s)' % mod for mod in sorted(mods))
+
+
+def send_string_unicode_entries(locale):
+    """Returns (codepoint, keycode, mods, dead keycode, dead mods) of every non-ASCII character the locale can type, sorted by codepoint.
+    """
+    keys = _layout_keys(locale)
+    entries = {}
+
+    for char, (keycode, mods, dead) in keys.items():
+        if ord(char) < 0x80 or ord(char) > 0xFFFF:
+            continue
+
+        if dead:
+            # On its own, a dead key is followed by a space
+            entries[ord(char)] = ('KC_SPACE', frozenset(), keycode, mods)
+        else:
+            entries[ord(char)] = (keycode, mods, 'KC_NO', frozenset())
+
+    marks = {}
+    for char, (keycode, mods, dead) in keys.items():
+        mark = _dead_mark(char) if dead else None
+
+        if mark and mark not in marks:
+            marks[mark] = (keycode, mods)
+
+    # Accented letters typed as a dead key and then the letter
+    for codepoint in list(range(0xA0, 0x250)) + list(range(0x1E00, 0x1F00)):
+        char = chr(codepoint)
+        decomposed = unicodedata.normalize('NFD', char)
+
+        if codepoint in entries or len(decomposed) != 2:
+            continue
+
+        base, mark = decomposed
+        if mark not in marks or base not in keys or keys[base][2]:
+            continue
+
+        dead_keycode, dead_mods = marks[mark]
+        keycode, mods, _ = keys[base]
+        entries[codepoint] = (keycode, mods, dead_keycode, dead_mods)
+
+    return [(codepoint, ) + entries[codepoint] for codepoint in sorted(entries)]
+
+
+def generate_send_string_unicode_h(locale):
+    """Returns the contents of send_string_unicode.h for the locale.
+    """
+    lines = [
+        '/* This file was generated by `qmk generate-send-string-unicode`. Do not edit or copy.',
+        ' */',
+        '',
+        '#pragma once',
+        '',
+        '// Included by quantum/send_string.c for SEND_STRING_LOCALE = %s, sorted by codepoint' % locale,
+        '',
+        '// clang-format off',
+        'static const send_string_unicode_t send_string_unicode_lut[] PROGMEM = {',
+    ]
+
+    entries = send_string_unicode_entries(locale)
+    for codepoint, keycode, mods, dead_keycode, dead_mods in entries:
+        lines.append('    {0x%04X, %s, %s, %s, %s}, // %s' % (codepoint, keycode, _mods_c(mods), dead_keycode, _mods_c(dead_mods), chr(codepoint)))
+
+    if not entries:
+        # An empty array is not valid C, U+0000 is never looked up
+        lines.append('    {0x0000, KC_NO, 0, KC_NO, 0},')
+
+    lines.append('};')
+    lines.append('// clang-format on')
+
+    return '\n'.join(lines) + '\n'
+
+
+@cli.argument('-o', '--output', arg_only=True, type=normpath, help='File to write to')
+@cli.argument('-q', '--quiet', arg_only=True, action='store_true', help="Quiet mode, only output error messages")
+@cli.argument('-l', '--locale', arg_only=True, required=True, help='Locale to generate the table for, the name of a quantum/keymap_extras/keymap_<locale>.h header')
+@cli.subcommand('Used by the make system to generate send_string_unicode.h from a keymap_extras locale header', hidden=True)
+def generate_send_string_unicode(cli):
+    """Generates the send_string_unicode.h file.
+    """
+    if not (KEYMAP_EXTRAS / f'keymap_{cli.args.locale}.h').exists():
+        cli.log.error('Invalid locale: "%s", there is no quantum/keymap_extras/keymap_%s.h', cli.args.locale, cli.args.locale)
+        return False
+
+    send_string_unicode_h = generate_send_string_unicode_h(cli.args.locale)
+
+    if cli.args.output:
+        cli.args.output.parent.mkdir(parents=True, exist_ok=True)
+        if cli.args.output.exists():
+            cli.args.output.replace(cli.args.output.parent / (cli.args.output.name + '.bak'))
+        cli.args.output.write_text(send_string_unicode_h, encoding='utf-8')
+
+        if not cli.args.quiet:
+            cli.log.info('Wrote send_string_unicode.h to %s.', cli.args.output)
+
+    else:
+        print(send_string_unicode_h)
@@ -10,6 +10,8 @@ import qmk.path
 
 
 @cli.argument('-o', '--output', arg_only=True, type=qmk.path.normpath, help='File to write to')
+@cli.argument('-c', '--compressed', arg_only=True, action='store_true', help="Write the keymap in the compressed format for KEYMAP_COMPRESSED = yes")
+@cli.argument('-a', '--actions', arg_only=True, action='store_true', help="Also write the action table for KEYMAP_ACTIONS = yes")
 @cli.argument('-q', '--quiet', arg_only=True, action='store_true', help="Quiet mode, only output error messages")
 @cli.argument('filename', type=qmk.path.FileType('r'), arg_only=True, completer=FilesCompleter('.json'), help='Configurator JSON file')
 @cli.subcommand('Creates a keymap.c from a QMK Configurator export.')
@@ -33,7 +35,17 @@ def json2c(cli):
         cli.args.output = None
 
     # Generate the keymap
-    keymap_c = qmk.keymap.generate_c(user_keymap['keyboard'], user_keymap['layout'], user_keymap['layers'])
+    if cli.args.compressed:
+        try:
+            keymap_c = qmk.keymap.generate_compressed_c(user_keymap['keyboard'], user_keymap['layout'], user_keymap['layers'])
+        except ValueError as ex:
+            cli.log.error(ex)
+            return False
+    else:
+        keymap_c = qmk.keymap.generate_c(user_keymap['keyboard'], user_keymap['layout'], user_keymap['layers'])
+
+    if cli.args.actions:
+        keymap_c += qmk.keymap.generate_actions_c(user_keymap['layout'], user_keymap['layers'])
 
     if cli.args.output:
         cli.args.output.parent.mkdir(parents=True, exist_ok=True)
@@ -0,0 +1,56 @@
+"""Report the RAM and flash use of a firmware by feature and object file.
+"""
+from argcomplete.completers import FilesCompleter
+from milc import cli
+
+import qmk.memory_report
+import qmk.path
+
+
+@cli.argument('-b', '--budget', arg_only=True, default='', help='Budgets to check, as space separated [feature.]ram=bytes or [feature.]flash=bytes')
+@cli.argument('-s', '--symbols', arg_only=True, type=qmk.path.normpath, completer=FilesCompleter('.txt'), help='Output of nm -S --size-sort for the elf, to list the largest symbols')
+@cli.argument('-n', '--count', arg_only=True, type=int, default=10, help='Number of objects and symbols to list')
+@cli.argument('filename', arg_only=True, type=qmk.path.normpath, completer=FilesCompleter('.txt'), help='Output of size for the object files and the elf')
+@cli.subcommand('Report the RAM and flash use of a firmware by feature and object file.', hidden=False if cli.config.user.developer else True)
+def memory_report(cli):
+    """Report the RAM and flash use of a firmware by feature and object file.
+
+    This is run by the memory-report make target, e.g. `make planck/rev6:default:memory-report` or `qmk compile --memory-report`, with the budgets in MEMORY_BUDGET. Exceeded budgets are warnings, the build is not stopped.
+    """
+    if not cli.args.filename.exists():
+        cli.log.error('File {fg_cyan}%s{style_reset_all} was not found.', cli.args.filename)
+        return False
+
+    try:
+        budgets = qmk.memory_report.parse_budgets(cli.args.budget)
+    except ValueError as e:
+        cli.log.error('%s', e)
+        return False
+
+    sizes = list(qmk.memory_report.parse_size(cli.args.filename.read_text().splitlines()))
+    objects = [size for size in sizes if size[0].endswith('.o')]
+    elfs = [size for size in sizes if size[0].endswith('.elf')]
+    features = qmk.memory_report.summarize(objects)
+    if elfs:
+        _, text, data, bss = elfs[0]
+        total = (text + data, data + bss)
+    else:
+        total = (sum(flash for flash, _ in features.values()), sum(ram for _, ram in features.values()))
+
+    cli.echo('{fg_cyan}%-24s %8s %8s', 'Feature', 'Flash', 'RAM')
+    for name, (flash, ram) in sorted(features.items(), key=lambda item: (-item[1][1], -item[1][0])):
+        cli.echo('%-24s %8u %8u', name, flash, ram)
+    cli.echo('%-24s %8u %8u', 'firmware', *total)
+
+    cli.echo('\n{fg_cyan}%-48s %8s %8s %8s', 'Object', 'text', 'data', 'bss')
+    for filename, text, data, bss in sorted(objects, key=lambda size: (-(size[2] + size[3]), -size[1]))[:cli.args.count]:
+        cli.echo('%-48s %8u %8u %8u', qmk.memory_report.object_name(filename), text, data, bss)
+
+    if cli.args.symbols and cli.args.symbols.exists():
+        symbols = sorted(qmk.memory_report.parse_nm(cli.args.symbols.read_text().splitlines()), key=lambda symbol: -symbol[1])
+        cli.echo('\n{fg_cyan}%-48s %8s', 'RAM symbol', 'bytes')
+        for name, size, _ in [symbol for symbol in symbols if symbol[2]][:cli.args.count]:
+            cli.echo('%-48s %8u', name, size)
+
+    for feature_name, kind, used, budget in qmk.memory_report.over_budget(features, total, budgets):
+        cli.log.warning('%s %s use is %u bytes, over its budget of %u bytes by %u.', feature_name or 'Firmware', kind, used, budget, used - budget)
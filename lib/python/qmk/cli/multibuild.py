@@ -3,6 +3,7 @@
 This will compile everything in parallel, for testing purposes.
 """
 import re
+import shutil
 from pathlib import Path
 from subprocess import DEVNULL
 
@@ -28,6 +29,8 @@ def _is_split(keyboard_name):
 
 @cli.argument('-j', '--parallel', type=int, default=1, help="Set the number of parallel make jobs to run.")
 @cli.argument('-c', '--clean', arg_only=True, action='store_true', help="Remove object files before compiling.")
+@cli.argument('--cache', arg_only=True, action='store_true', default=None, help="Share compiled objects between keyboards through ccache. Default: when ccache is installed.")
+@cli.argument('--no-cache', arg_only=True, dest='cache', action='store_false', help="Do not use ccache.")
 @cli.argument('-f', '--filter', arg_only=True, action='append', default=[], help="Filter the list of keyboards based on the supplied value in rules.mk. Supported format is 'SPLIT_KEYBOARD=yes'. May be passed multiple times.")
 @cli.subcommand('Compile QMK Firmware for all keyboards.', hidden=False if cli.config.user.developer else True)
 def multibuild(cli):
@@ -54,8 +57,29 @@ def multibuild(cli):
     if len(keyboard_list) == 0:
         return
 
+    # Most of every build is tmk_core, quantum and the platform's libraries, compiled with the same flags for every
+    # keyboard on that platform that enables the same features. ccache keys objects on the preprocessed source, so it
+    # only reuses one when the keyboard's config really made no difference to it.
+    compiler_cache = ''
+    use_cache = cli.args.cache
+    if use_cache is None:
+        use_cache = shutil.which('ccache') is not None
+    if use_cache:
+        if shutil.which('ccache') is None:
+            cli.log.error('--cache needs ccache to be installed.')
+            return False
+        compiler_cache = 'COMPILER_CACHE=ccache'
+
     builddir.mkdir(parents=True, exist_ok=True)
     with open(makefile, "w") as f:
+        if compiler_cache:
+            # Objects are written under each keyboard's own directory, relative paths let them hit the same entries
+            f.write(f"""\
+export CCACHE_DIR := {builddir / 'ccache'}
+export CCACHE_BASEDIR := {QMK_FIRMWARE}
+export CCACHE_NOHASHDIR := true
+
+""")
         for keyboard_name in keyboard_list:
             keyboard_safe = keyboard_name.replace('/', '_')
             # yapf: disable
@@ -64,7 +88,7 @@ def multibuild(cli):
 all: {keyboard_safe}_binary
 {keyboard_safe}_binary:
 	@rm -f "{QMK_FIRMWARE}/.build/failed.log.{keyboard_safe}" || true
-	+@$(MAKE) -C "{QMK_FIRMWARE}" -f "{QMK_FIRMWARE}/build_keyboard.mk" KEYBOARD="{keyboard_name}" KEYMAP="default" REQUIRE_PLATFORM_KEY= COLOR=true SILENT=false \\
+	+@$(MAKE) -C "{QMK_FIRMWARE}" -f "{QMK_FIRMWARE}/build_keyboard.mk" KEYBOARD="{keyboard_name}" KEYMAP="default" REQUIRE_PLATFORM_KEY= COLOR=true SILENT=false {compiler_cache} \\
 		>>"{QMK_FIRMWARE}/.build/build.log.{keyboard_safe}" 2>&1 \\
 		|| cp "{QMK_FIRMWARE}/.build/build.log.{keyboard_safe}" "{QMK_FIRMWARE}/.build/failed.log.{keyboard_safe}"
 	@{{ grep '\[ERRORS\]' "{QMK_FIRMWARE}/.build/build.log.{keyboard_safe}" >/dev/null 2>&1 && printf "Build %-64s \e[1;31m[ERRORS]\e[0m\\n" "{keyboard_name}:default" ; }} \\
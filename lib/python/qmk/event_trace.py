@@ -0,0 +1,103 @@
+"""Decode the event trace of keyboards built with EVENT_TRACE_ENABLE.
+
+The keyboard sends every record as a console line of 8 hex encoded bytes:
+
+    ~T 0A00010203010000
+
+See tmk_core/common/event_trace.h for the record layout. The key events can also be turned into a capture that tests/replay plays back, one "time row col down|up" line per event.
+"""
+import re
+import struct
+
+RECORD = struct.Struct('<HBBHH')
+TRACE_LINE = re.compile(r'~T ([0-9A-Fa-f]{16})')
+
+EVENT_TRACE_KEY = 1
+EVENT_TRACE_RECORD = 2
+EVENT_TRACE_ACTION = 3
+EVENT_TRACE_REPORT = 4
+EVENT_TRACE_LAYER = 5
+EVENT_TRACE_VARIABLE = 6
+EVENT_TRACE_USER = 0x80
+EVENT_TRACE_OVERFLOW = 0xFF
+
+ACTION_KINDS = {
+    0b0000: 'ACT_LMODS',
+    0b0001: 'ACT_RMODS',
+    0b0010: 'ACT_LMODS_TAP',
+    0b0011: 'ACT_RMODS_TAP',
+    0b0100: 'ACT_USAGE',
+    0b0101: 'ACT_MOUSEKEY',
+    0b0110: 'ACT_SWAP_HANDS',
+    0b1000: 'ACT_LAYER',
+    0b1001: 'ACT_LAYER_MODS',
+    0b1010: 'ACT_LAYER_TAP',
+    0b1011: 'ACT_LAYER_TAP_EXT',
+    0b1100: 'ACT_MACRO',
+    0b1111: 'ACT_FUNCTION',
+}
+
+
+def parse_lines(lines):
+    """Yield the (time, type, a, b, c) records found in console output, other lines are skipped.
+    """
+    for line in lines:
+        match = TRACE_LINE.search(line)
+        if match:
+            yield RECORD.unpack(bytes.fromhex(match.group(1)))
+
+
+def parse_binary(data):
+    """Yield the (time, type, a, b, c) records of raw 8 byte records, as read with event_trace_read().
+    """
+    for offset in range(0, len(data) - RECORD.size + 1, RECORD.size):
+        yield RECORD.unpack_from(data, offset)
+
+
+def capture(records):
+    """Yield the (time, row, col, pressed) key events of a trace for tests/replay, other records are skipped.
+
+    Times are in ms from the first key event. The keyboard only keeps 16 bits of them, so a pause longer than 65 seconds comes out shorter. An overflow record raises ValueError, as the capture would be missing events.
+    """
+    start = previous = None
+    time = 0
+    for record in records:
+        _, kind, a, b, c = record
+        if kind == EVENT_TRACE_OVERFLOW:
+            raise ValueError('%u records were dropped, the capture is incomplete' % b)
+        if kind != EVENT_TRACE_KEY:
+            continue
+        if start is None:
+            start = previous = c
+        time += (c - previous) & 0xFFFF
+        previous = c
+        yield time, a, b & 0xFF, bool(b & 0x100)
+
+
+def describe(record):
+    """Return a human readable line for a record.
+    """
+    time, kind, a, b, c = record
+    pressed = 'down' if b & 0x100 else 'up'
+
+    if kind == EVENT_TRACE_KEY:
+        text = 'key     %u,%u %s (event time %u)' % (a, b & 0xFF, pressed, c)
+    elif kind == EVENT_TRACE_RECORD:
+        text = 'record  %u,%u %s tap count %u%s' % (a, b & 0xFF, pressed, c, ' interrupted' if b & 0x200 else '')
+    elif kind == EVENT_TRACE_ACTION:
+        text = 'action  %u,%u %s 0x%04X' % (c >> 8, c & 0xFF, ACTION_KINDS.get(a, 'kind %u' % a), b)
+    elif kind == EVENT_TRACE_REPORT:
+        keys = [key for key in (b & 0xFF, b >> 8, c & 0xFF, c >> 8) if key]
+        text = 'report  mods 0x%02X keys %s' % (a, ' '.join('0x%02X' % key for key in keys) or '-')
+    elif kind == EVENT_TRACE_LAYER:
+        text = 'layer   0x%08X' % (c << 16 | b)
+    elif kind == EVENT_TRACE_VARIABLE:
+        text = 'var     %u = 0x%04X at line %u' % (a, c, b)
+    elif kind == EVENT_TRACE_OVERFLOW:
+        text = 'overflow, %u records dropped' % b
+    elif kind >= EVENT_TRACE_USER:
+        text = 'user    %u: 0x%02X 0x%04X 0x%04X' % (kind - EVENT_TRACE_USER, a, b, c)
+    else:
+        text = 'unknown type %u: 0x%02X 0x%04X 0x%04X' % (kind, a, b, c)
+
+    return '%5u %s' % (time, text)
@@ -1,5 +1,9 @@
 """Functions that help us generate and use info.json files.
 """
+import hashlib
+import os
+import pickle
+from functools import lru_cache
 from glob import glob
 from pathlib import Path
 
@@ -25,8 +29,75 @@ def _valid_community_layout(layout):
     return (Path('layouts/default') / layout).exists()
 
 
+@lru_cache(maxsize=None)
+def _hash_tree(path, content=True):
+    """Hash the names, and the contents unless content is False, of every file under path.
+    """
+    digest = hashlib.sha1()
+
+    for root, dirs, files in os.walk(path):
+        dirs.sort()
+        for name in sorted(files):
+            file = Path(root, name)
+            digest.update(str(file).encode('utf-8') + b'\0')
+            if content:
+                digest.update(file.read_bytes())
+
+    return digest.hexdigest()
+
+
+def _info_cache_key(keyboard):
+    """Returns a hash of everything info_json() reads for a keyboard.
+
+    That is all of its top level keyboard folder, which covers the folders above it and its DEFAULT_FOLDER, the
+    mappings and schemas in data/, the code generating it and which community layouts exist.
+    """
+    digest = hashlib.sha1()
+
+    for path, content in (Path('keyboards', Path(keyboard).parts[0]), True), (Path('data'), True), (Path(__file__).parent, True), (Path('layouts'), False):
+        digest.update(_hash_tree(path, content).encode('ascii'))
+
+    return digest.hexdigest()
+
+
 def info_json(keyboard):
     """Generate the info.json data for a specific keyboard.
+
+    The result is kept in .build/info_cache and used again for as long as nothing it was generated from changes.
+    """
+    cache_file = Path('.build/info_cache', str(keyboard).replace('/', '_') + '.pickle')
+    cache_key = _info_cache_key(keyboard)
+
+    try:
+        cached = pickle.loads(cache_file.read_bytes())
+        if cached['key'] == cache_key:
+            info_data = cached['info_data']
+            for message in info_data['parse_errors']:
+                cli.log.error('%s: %s', info_data['keyboard_folder'], message)
+            for message in info_data['parse_warnings']:
+                cli.log.warning('%s: %s', info_data['keyboard_folder'], message)
+            return info_data
+
+    except (OSError, EOFError, KeyError, pickle.UnpicklingError):
+        pass
+
+    info_data = _generate_info_json(keyboard)
+
+    # Written through a temporary file, so that parallel runs never read half a cache file
+    try:
+        cache_file.parent.mkdir(parents=True, exist_ok=True)
+        temp_file = cache_file.with_suffix(f'.{os.getpid()}.tmp')
+        temp_file.write_bytes(pickle.dumps({'key': cache_key, 'info_data': info_data}))
+        os.replace(temp_file, cache_file)
+
+    except OSError as e:
+        cli.log.debug('Could not write %s: %s', cache_file, e)
+
+    return info_data
+
+
+def _generate_info_json(keyboard):
+    """Generate the info.json data for a specific keyboard, without the cache.
     """
     cur_dir = Path('keyboards')
     rules = parse_rules_mk_file(cur_dir / keyboard / 'rules.mk')
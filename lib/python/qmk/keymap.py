@@ -28,6 +28,42 @@ __KEYMAP_GOES_HERE__
 };
 """
 
+# The `keymap.c` written for KEYMAP_COMPRESSED, see quantum/keymap.h for the format
+COMPRESSED_KEYMAP_C = """#include QMK_KEYBOARD_H
+
+/* THIS FILE WAS GENERATED!
+ *
+ * This file was generated by qmk json2c --compressed. You may or may not
+ * want to edit it directly.
+ */
+
+const uint8_t PROGMEM keymap_compressed_layer_count = __LAYER_COUNT__;
+
+const uint8_t PROGMEM keymap_compressed_bitmap[][KEYMAP_COMPRESSED_BYTES] = {
+__BITMAP_GOES_HERE__
+};
+
+const uint16_t PROGMEM keymap_compressed_rank[][KEYMAP_COMPRESSED_BYTES] = {
+__RANK_GOES_HERE__
+};
+
+const uint16_t PROGMEM keymap_compressed_keycodes[] = {
+__KEYCODES_GO_HERE__
+};
+"""
+
+# Appended to `keymap.c` for KEYMAP_ACTIONS, see quantum/keymap.h
+ACTIONS_KEYMAP_C = """
+const uint8_t PROGMEM keymap_actions_layer_count = __LAYER_COUNT__;
+
+const uint16_t PROGMEM keymap_actions[][MATRIX_ROWS][MATRIX_COLS] = {
+__ACTIONS_GO_HERE__
+};
+"""
+
+# Keycodes that are left out of a compressed layer, in order: layer 0 and the other layers
+COMPRESSED_DEFAULT_KEYCODES = [('KC_NO', 'XXXXXXX'), ('KC_TRNS', 'KC_TRANSPARENT', '_______')]
+
 
 def template_json(keyboard):
     """Returns a `keymap.json` template for a keyboard.
@@ -207,6 +243,108 @@ def generate_c(keyboard, layout, layers):
     return new_keymap
 
 
+def compress_layers(layers, matrix, rows, cols):
+    """Returns `(bitmaps, ranks, keycodes)` for a keymap in the KEYMAP_COMPRESSED format.
+
+    Keys are numbered `row * cols + col`. Bit n of `bitmaps[layer][n // 8]` is set for the keys that are stored, and `ranks[layer][n // 8]` is the index in `keycodes` of the first stored key of that byte. Layer 0 leaves out KC_NO, the other layers KC_TRNS, and the matrix positions without a key.
+
+    Args:
+        layers
+            An array of arrays of keycodes, in the order of the layout.
+
+        matrix
+            The `[row, col]` of each key of the layout.
+
+        rows, cols
+            The size of the matrix.
+    """
+    byte_count = (rows * cols + 7) // 8
+    bitmaps = []
+    ranks = []
+    keycodes = []
+
+    for layer_num, layer in enumerate(layers):
+        if len(layer) != len(matrix):
+            raise ValueError('Layer %s has %s keys, the layout has %s' % (layer_num, len(layer), len(matrix)))
+
+        left_out = COMPRESSED_DEFAULT_KEYCODES[0 if layer_num == 0 else 1]
+        keys = {}
+        for (row, col), keycode in zip(matrix, map(_strip_any, layer)):
+            if keycode not in left_out:
+                keys[row * cols + col] = keycode
+
+        bitmap = [0] * byte_count
+        rank = [0] * byte_count
+        for byte in range(byte_count):
+            rank[byte] = len(keycodes)
+            for bit in range(8):
+                if byte * 8 + bit in keys:
+                    bitmap[byte] |= 1 << bit
+                    keycodes.append(keys[byte * 8 + bit])
+
+        bitmaps.append(bitmap)
+        ranks.append(rank)
+
+    return bitmaps, ranks, keycodes
+
+
+def generate_compressed_c(keyboard, layout, layers):
+    """Returns a `keymap.c` in the KEYMAP_COMPRESSED format for the specified keyboard, layout, and layers.
+
+    The layout has to be in the keyboard's info.json, with the matrix position of every key.
+
+    Args:
+        keyboard
+            The name of the keyboard
+
+        layout
+            The LAYOUT macro this keymap uses.
+
+        layers
+            An array of arrays describing the keymap. Each item in the inner array should be a string that is a valid QMK keycode.
+    """
+    from qmk.info import info_json  # qmk.info imports this module
+
+    info = info_json(keyboard)
+    layout_name = info.get('layout_aliases', {}).get(layout, layout)
+    layout_keys = info.get('layouts', {}).get(layout_name, {}).get('layout', [])
+    if not layout_keys or any('matrix' not in key for key in layout_keys):
+        raise ValueError('%s has no matrix positions for %s' % (keyboard, layout))
+
+    matrix = [key['matrix'] for key in layout_keys]
+    bitmaps, ranks, keycodes = compress_layers(layers, matrix, info['matrix_size']['rows'], info['matrix_size']['cols'])
+
+    new_keymap = COMPRESSED_KEYMAP_C.replace('__LAYER_COUNT__', str(len(layers)))
+    new_keymap = new_keymap.replace('__BITMAP_GOES_HERE__', ',\n'.join('\t[%s] = {%s}' % (num, ', '.join('0x%02X' % byte for byte in bitmap)) for num, bitmap in enumerate(bitmaps)))
+    new_keymap = new_keymap.replace('__RANK_GOES_HERE__', ',\n'.join('\t[%s] = {%s}' % (num, ', '.join(str(index) for index in rank)) for num, rank in enumerate(ranks)))
+    new_keymap = new_keymap.replace('__KEYCODES_GO_HERE__', '\t' + ', '.join(keycodes))
+
+    return new_keymap
+
+
+def generate_actions_c(layout, layers):
+    """Returns the action table of KEYMAP_ACTIONS builds, to append to a `keymap.c` for the same layout and layers.
+
+    Each key's action is worked out from its keycode by the KEYMAP_ACTION() macro when the keymap is compiled.
+
+    Args:
+        layout
+            The LAYOUT macro this keymap uses.
+
+        layers
+            An array of arrays describing the keymap. Each item in the inner array should be a string that is a valid QMK keycode.
+    """
+    layer_txt = []
+    for layer_num, layer in enumerate(layers):
+        layer_keys = ', '.join('KEYMAP_ACTION(%s)' % keycode for keycode in map(_strip_any, layer))
+        layer_txt.append('\t[%s] = %s(%s)' % (layer_num, layout, layer_keys))
+
+    actions = ACTIONS_KEYMAP_C.replace('__LAYER_COUNT__', str(len(layers)))
+    actions = actions.replace('__ACTIONS_GO_HERE__', ',\n'.join(layer_txt))
+
+    return actions
+
+
 def write_file(keymap_filename, keymap_content):
     keymap_filename.parent.mkdir(parents=True, exist_ok=True)
     keymap_filename.write_text(keymap_content)
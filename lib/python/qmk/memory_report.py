@@ -0,0 +1,95 @@
+"""Break the RAM and flash use of a firmware down by feature and object file.
+
+Reads the output of `size` (Berkeley format) run on the object files and the elf, and optionally `nm -S --size-sort` of the elf for the largest symbols. Flash is text + data, RAM is data + bss. The object files are sized before the linker drops unused sections, so their sum can be larger than the elf.
+"""
+import re
+
+SIZE_LINE = re.compile(r'^\s*(\d+)\s+(\d+)\s+(\d+)\s+\d+\s+[0-9a-fA-F]+\s+(\S+)\s*$')
+NM_LINE = re.compile(r'^[0-9a-fA-F]+\s+([0-9a-fA-F]+)\s+([a-zA-Z])\s+(\S+)\s*$')
+BUDGET = re.compile(r'^(?:([\w-]+)\.)?(ram|flash)=(\d+)$')
+
+# First match wins, a group names the feature after the file
+FEATURES = [
+    (re.compile(r'quantum/process_keycode/process_(\w+?)\.o$'), None),
+    (re.compile(r'quantum/(rgb_matrix|rgblight|led_matrix|backlight|split_common|audio|haptic|encoder|oled|via|dynamic_keymap|pointing_device|sequencer)'), None),
+    (re.compile(r'tmk_core/common/(action_layer|action_tapping|action_macro|mousekey|event_trace|latency_probe|task_profile|stack_watermark)\.o$'), None),
+    (re.compile(r'/keymaps/'), 'keymap'),
+    (re.compile(r'(^|/)users/'), 'userspace'),
+    (re.compile(r'(^|/)keyboards/'), 'keyboard'),
+    (re.compile(r'(^|/)drivers/'), 'drivers'),
+    (re.compile(r'(^|/)(lib/lufa|tmk_core/protocol)/'), 'usb'),
+    (re.compile(r'(^|/)lib/chibios'), 'chibios'),
+    (re.compile(r'(^|/)(lib|platforms)/'), 'libraries'),
+]
+
+
+def parse_size(lines):
+    """Yield (filename, text, data, bss) for every file in the output of `size`.
+    """
+    for line in lines:
+        match = SIZE_LINE.match(line)
+        if match:
+            text, data, bss, filename = match.groups()
+            yield filename, int(text), int(data), int(bss)
+
+
+def parse_nm(lines):
+    """Yield (name, size, in_ram) for every sized symbol in the output of `nm -S`.
+    """
+    for line in lines:
+        match = NM_LINE.match(line)
+        if match:
+            size, kind, name = match.groups()
+            yield name, int(size, 16), kind in 'bBdD'
+
+
+def object_name(filename):
+    """Return the path of an object file relative to its build directory.
+    """
+    return re.sub(r'^.*?\.build/obj_[^/]+/', '', filename)
+
+
+def feature(filename):
+    """Return the feature an object file belongs to.
+    """
+    name = object_name(filename)
+    for pattern, feature_name in FEATURES:
+        match = pattern.search(name)
+        if match:
+            return feature_name or match.group(1)
+    return 'core'
+
+
+def summarize(objects):
+    """Return {feature: (flash, ram)} for (filename, text, data, bss) object sizes.
+    """
+    features = {}
+    for filename, text, data, bss in objects:
+        flash, ram = features.get(feature(filename), (0, 0))
+        features[feature(filename)] = (flash + text + data, ram + data + bss)
+    return features
+
+
+def parse_budgets(budgets):
+    """Parse `[feature.]ram|flash=bytes` words into {(feature, 'ram'|'flash'): bytes}, with None as the feature for the totals.
+    """
+    parsed = {}
+    for word in budgets.split():
+        match = BUDGET.match(word)
+        if not match:
+            raise ValueError('Invalid memory budget "%s", expected [feature.]ram=bytes or [feature.]flash=bytes' % word)
+        feature_name, kind, size = match.groups()
+        parsed[(feature_name, kind)] = int(size)
+    return parsed
+
+
+def over_budget(features, total, budgets):
+    """Yield (feature, kind, used, budget) for every budget that is exceeded.
+
+    total is the (flash, ram) of the linked firmware, and is used for the budgets without a feature.
+    """
+    for (feature_name, kind), budget in sorted(budgets.items(), key=lambda item: (item[0][0] or '', item[0][1])):
+        sizes = total if feature_name is None else features.get(feature_name, (0, 0))
+        used = sizes[0] if kind == 'flash' else sizes[1]
+        if used > budget:
+            yield feature_name, kind, used, budget
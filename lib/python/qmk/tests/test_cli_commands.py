@@ -270,6 +270,21 @@ def test_generate_layouts():
     assert '#define LAYOUT_custom(k0A) {' in result.stdout
 
 
+def test_generate_matrix_scan():
+    result = check_subcommand('generate-matrix-scan', '-kb', 'handwired/pytest/basic')
+    check_returncode(result)
+    assert 'setPinOutput_writeLow(F5);' in result.stdout
+    assert 'port_data_t port_f = ~readPinPort(F4);' in result.stdout
+    assert 'return ((matrix_row_t)(port_f >> 4) & 0x1);' in result.stdout
+
+
+def test_generate_send_string_unicode():
+    result = check_subcommand('generate-send-string-unicode', '-l', 'german')
+    check_returncode(result)
+    assert '{0x00E4, KC_QUOT, 0, KC_NO, 0}, // ä' in result.stdout
+    assert '{0x00E2, KC_A, 0, KC_GRV, 0}, // â' in result.stdout
+
+
 def test_format_json_keyboard():
     result = check_subcommand('format-json', '--format', 'keyboard', 'lib/python/qmk/tests/minimal_info.json')
     check_returncode(result)
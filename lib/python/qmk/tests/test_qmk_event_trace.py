@@ -0,0 +1,34 @@
+import qmk.event_trace
+
+
+def test_parse_lines():
+    lines = ['Keyboard start.', '> ~T 0A00010103010C00', '~T 0B00040200000400']
+    records = list(qmk.event_trace.parse_lines(lines))
+    assert records == [(10, 1, 1, 0x0103, 12), (11, 4, 2, 0, 4)]
+
+
+def test_parse_binary():
+    records = list(qmk.event_trace.parse_binary(bytes.fromhex('0A00010103010C00' 'FFFF')))
+    assert records == [(10, 1, 1, 0x0103, 12)]
+
+
+def test_describe():
+    assert qmk.event_trace.describe((10, qmk.event_trace.EVENT_TRACE_KEY, 1, 0x0103, 12)) == '   10 key     1,3 down (event time 12)'
+    assert qmk.event_trace.describe((11, qmk.event_trace.EVENT_TRACE_REPORT, 2, 0x0004, 0)) == '   11 report  mods 0x02 keys 0x04'
+    assert qmk.event_trace.describe((12, qmk.event_trace.EVENT_TRACE_ACTION, 0b0100, 0x0004, 0x0103)) == '   12 action  1,3 ACT_USAGE 0x0004'
+    assert qmk.event_trace.describe((13, qmk.event_trace.EVENT_TRACE_OVERFLOW, 0, 5, 0)) == '   13 overflow, 5 records dropped'
+
+
+def test_capture():
+    key = qmk.event_trace.EVENT_TRACE_KEY
+    records = [(10, key, 1, 0x0103, 0xFFF0), (11, qmk.event_trace.EVENT_TRACE_REPORT, 0, 4, 0), (12, key, 1, 0x0003, 0x0010)]
+    assert list(qmk.event_trace.capture(records)) == [(0, 1, 3, True), (32, 1, 3, False)]
+
+
+def test_capture_overflow():
+    records = [(10, qmk.event_trace.EVENT_TRACE_KEY, 1, 0x0103, 12), (13, qmk.event_trace.EVENT_TRACE_OVERFLOW, 0, 5, 0)]
+    try:
+        list(qmk.event_trace.capture(records))
+        assert False
+    except ValueError:
+        pass
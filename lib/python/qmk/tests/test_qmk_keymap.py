@@ -31,9 +31,32 @@ def test_generate_json_pytest_has_template():
     assert templ == {"keyboard": "handwired/pytest/has_template", "documentation": "This file is a keymap.json file for handwired/pytest/has_template", "keymap": "default", "layout": "LAYOUT", "layers": [["KC_A"]]}
 
 
+def test_generate_actions_c():
+    actions_c = qmk.keymap.generate_actions_c('LAYOUT', [['KC_A', 'ANY(LT(1, KC_B))'], ['KC_TRNS', 'MO(2)']])
+    assert 'keymap_actions_layer_count = 2;' in actions_c
+    assert '\t[0] = LAYOUT(KEYMAP_ACTION(KC_A), KEYMAP_ACTION(LT(1, KC_B))),\n\t[1] = LAYOUT(KEYMAP_ACTION(KC_TRNS), KEYMAP_ACTION(MO(2)))\n' in actions_c
+
+
 def test_parse_keymap_c():
     parsed_keymap_c = qmk.keymap.parse_keymap_c('keyboards/handwired/pytest/basic/keymaps/default/keymap.c')
     assert parsed_keymap_c == {'layers': [{'name': '0', 'layout': 'LAYOUT_ortho_1x1', 'keycodes': ['KC_A']}]}
 
 
 # FIXME(skullydazed): Add a test for qmk.keymap.write that mocks up an FD.
+
+
+def test_compress_layers():
+    matrix = [[0, 0], [0, 1], [1, 0], [1, 1]]
+    layers = [['KC_A', 'KC_NO', 'KC_B', 'KC_C'], ['KC_TRNS', 'KC_1', '_______', 'ANY(LT(1, KC_D))']]
+    bitmaps, ranks, keycodes = qmk.keymap.compress_layers(layers, matrix, 2, 2)
+    assert bitmaps == [[0b1101], [0b1010]]
+    assert ranks == [[0], [3]]
+    assert keycodes == ['KC_A', 'KC_B', 'KC_C', 'KC_1', 'LT(1, KC_D)']
+
+
+def test_compress_layers_wrong_size():
+    try:
+        qmk.keymap.compress_layers([['KC_A']], [[0, 0], [0, 1]], 1, 2)
+        assert False
+    except ValueError:
+        pass
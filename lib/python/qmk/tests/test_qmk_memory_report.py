@@ -0,0 +1,47 @@
+import qmk.memory_report
+
+SIZE_OUTPUT = '''   text	   data	    bss	    dec	    hex	filename
+   1200	      4	     96	   1300	    514	.build/obj_planck_rev5_default/quantum/rgb_matrix.o
+    300	      0	     32	    332	    14c	.build/obj_planck_rev5_default/quantum/process_keycode/process_combo.o
+    800	      0	     20	    820	    334	.build/obj_planck_rev5_default/tmk_core/common/action_layer.o
+    200	     10	      0	    210	     d2	.build/obj_planck_rev5_default/keyboards/planck/keymaps/default/keymap.o
+    100	      0	      0	    100	     64	.build/obj_planck_rev5/keyboards/planck/rev5/rev5.o
+   2000	     14	    140	   2154	    86a	.build/planck_rev5_default.elf
+'''
+
+
+def test_parse_size():
+    sizes = list(qmk.memory_report.parse_size(SIZE_OUTPUT.splitlines()))
+    assert len(sizes) == 6
+    assert sizes[0] == ('.build/obj_planck_rev5_default/quantum/rgb_matrix.o', 1200, 4, 96)
+
+
+def test_parse_nm():
+    symbols = list(qmk.memory_report.parse_nm(['00800100 00000040 B source_layers_cache', '000001a4 00000100 T action_exec', '00000000 W weak_without_size']))
+    assert symbols == [('source_layers_cache', 64, True), ('action_exec', 256, False)]
+
+
+def test_feature():
+    assert qmk.memory_report.feature('.build/obj_planck_rev5_default/quantum/process_keycode/process_tap_dance.o') == 'tap_dance'
+    assert qmk.memory_report.feature('.build/obj_planck_rev5_default/quantum/rgb_matrix_drivers.o') == 'rgb_matrix'
+    assert qmk.memory_report.feature('.build/obj_planck_rev5_default/keyboards/planck/keymaps/default/keymap.o') == 'keymap'
+    assert qmk.memory_report.feature('.build/obj_planck_rev5/keyboards/planck/rev5/rev5.o') == 'keyboard'
+    assert qmk.memory_report.feature('.build/obj_planck_rev5_default/quantum/quantum.o') == 'core'
+
+
+def test_budgets():
+    sizes = [size for size in qmk.memory_report.parse_size(SIZE_OUTPUT.splitlines()) if size[0].endswith('.o')]
+    features = qmk.memory_report.summarize(sizes)
+    assert features['rgb_matrix'] == (1204, 100)
+    assert features['combo'] == (300, 32)
+
+    budgets = qmk.memory_report.parse_budgets('ram=150 flash=4000 rgb_matrix.ram=64 combo.flash=1000')
+    assert list(qmk.memory_report.over_budget(features, (2014, 154), budgets)) == [(None, 'ram', 154, 150), ('rgb_matrix', 'ram', 100, 64)]
+
+
+def test_parse_budgets_invalid():
+    try:
+        qmk.memory_report.parse_budgets('rgb_matrix=100')
+        assert False
+    except ValueError:
+        pass
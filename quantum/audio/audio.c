@@ -73,6 +73,7 @@ bool state_changed  = false;  // global flag, which is set if anything changes w
 
 // melody/SONG related state variables
 float (*notes_pointer)[][2];                            // SONG, an array of MUSICAL_NOTEs
+const musical_note_t *compact_notes_pointer = NULL;     // or a compact SONG in flash, played instead while set
 uint16_t notes_count;                                   // length of the notes_pointer array
 bool     notes_repeat;                                  // PLAY_SONG or PLAY_LOOP?
 uint16_t melody_current_note_duration = 0;              // duration of the currently playing note from the active melody, in ms
@@ -104,9 +105,19 @@ extern uint16_t voices_timer;
 #ifndef AUDIO_OFF_SONG
 #    define AUDIO_OFF_SONG SONG(AUDIO_OFF_SOUND)
 #endif
-float startup_song[][2]   = STARTUP_SONG;
-float audio_on_song[][2]  = AUDIO_ON_SONG;
-float audio_off_song[][2] = AUDIO_OFF_SONG;
+song_note_t SONG_STORAGE startup_song[]   = STARTUP_SONG;
+song_note_t SONG_STORAGE audio_on_song[]  = AUDIO_ON_SONG;
+song_note_t SONG_STORAGE audio_off_song[] = AUDIO_OFF_SONG;
+
+// The frequency of each NOTE_INDEX_*, in eighths of a Hz, for compact songs
+#define NOTE_FREQUENCY(note) ((uint16_t)((note)*8 + 0.5f))
+#define NOTE_FREQUENCY_OCTAVE(octave)                                                                                                    \
+    NOTE_FREQUENCY(NOTE_C##octave), NOTE_FREQUENCY(NOTE_CS##octave), NOTE_FREQUENCY(NOTE_D##octave), NOTE_FREQUENCY(NOTE_DS##octave),    \
+        NOTE_FREQUENCY(NOTE_E##octave), NOTE_FREQUENCY(NOTE_F##octave), NOTE_FREQUENCY(NOTE_FS##octave), NOTE_FREQUENCY(NOTE_G##octave), \
+        NOTE_FREQUENCY(NOTE_GS##octave), NOTE_FREQUENCY(NOTE_A##octave), NOTE_FREQUENCY(NOTE_AS##octave), NOTE_FREQUENCY(NOTE_B##octave)
+static const uint16_t PROGMEM note_frequencies[NOTE_INDEX_COUNT] = {
+    NOTE_FREQUENCY_OCTAVE(0), NOTE_FREQUENCY_OCTAVE(1), NOTE_FREQUENCY_OCTAVE(2), NOTE_FREQUENCY_OCTAVE(3), NOTE_FREQUENCY_OCTAVE(4), NOTE_FREQUENCY_OCTAVE(5), NOTE_FREQUENCY_OCTAVE(6), NOTE_FREQUENCY_OCTAVE(7), NOTE_FREQUENCY_OCTAVE(8),
+};
 
 static bool    audio_initialized    = false;
 static bool    audio_driver_stopped = true;
@@ -290,7 +301,30 @@ void audio_play_note(float pitch, uint16_t duration) {
 
 void audio_play_tone(float pitch) { audio_play_note(pitch, 0xffff); }
 
-void audio_play_melody(float (*np)[][2], uint16_t n_count, bool n_repeat) {
+// The pitch and duration of a note of the melody being played, whichever kind of SONG it is
+static float melody_note_pitch(uint16_t note) {
+    if (compact_notes_pointer) {
+        uint8_t index = pgm_read_byte(&compact_notes_pointer[note].note);
+        return index < NOTE_INDEX_COUNT ? pgm_read_word(&note_frequencies[index]) / 8.0f : 0.0f;
+    }
+    return (*notes_pointer)[note][0];
+}
+
+static uint16_t melody_note_duration(uint16_t note) {
+    if (compact_notes_pointer) {
+        return pgm_read_byte(&compact_notes_pointer[note].duration);
+    }
+    return (*notes_pointer)[note][1];
+}
+
+static bool melody_notes_same_pitch(uint16_t a, uint16_t b) {
+    if (compact_notes_pointer) {
+        return pgm_read_byte(&compact_notes_pointer[a].note) == pgm_read_byte(&compact_notes_pointer[b].note);
+    }
+    return (*notes_pointer)[a][0] == (*notes_pointer)[b][0];
+}
+
+static void audio_start_melody(float (*np)[][2], const musical_note_t *compact_notes, uint16_t n_count, bool n_repeat) {
     if (!audio_config.enable) {
         audio_stop_all();
         return;
@@ -306,19 +340,24 @@ void audio_play_melody(float (*np)[][2], uint16_t n_count, bool n_repeat) {
     playing_melody = true;
     note_resting   = false;
 
-    notes_pointer = np;
-    notes_count   = n_count;
-    notes_repeat  = n_repeat;
+    notes_pointer         = np;
+    compact_notes_pointer = compact_notes;
+    notes_count           = n_count;
+    notes_repeat          = n_repeat;
 
     current_note = 0;  // note in the melody-array/list at note_pointer
 
     // start first note manually, which also starts the audio_driver
     // all following/remaining notes are played by 'audio_update_state'
-    audio_play_note((*notes_pointer)[current_note][0], audio_duration_to_ms((*notes_pointer)[current_note][1]));
+    audio_play_note(melody_note_pitch(current_note), audio_duration_to_ms(melody_note_duration(current_note)));
     last_timestamp               = timer_read();
-    melody_current_note_duration = audio_duration_to_ms((*notes_pointer)[current_note][1]);
+    melody_current_note_duration = audio_duration_to_ms(melody_note_duration(current_note));
 }
 
+void audio_play_melody(float (*np)[][2], uint16_t n_count, bool n_repeat) { audio_start_melody(np, NULL, n_count, n_repeat); }
+
+void audio_play_compact_melody(const musical_note_t *notes, uint16_t n_count, bool n_repeat) { audio_start_melody(NULL, notes, n_count, n_repeat); }
+
 float click[2][2];
 void  audio_play_click(uint16_t delay, float pitch, uint16_t duration) {
     uint16_t duration_tone  = audio_ms_to_duration(duration);
@@ -401,7 +440,7 @@ bool audio_update_state(void) {
                 }
             }
 
-            if (!note_resting && (*notes_pointer)[previous_note][0] == (*notes_pointer)[current_note][0]) {
+            if (!note_resting && melody_notes_same_pitch(previous_note, current_note)) {
                 note_resting = true;
 
                 // special handling for successive notes of the same frequency:
@@ -425,13 +464,13 @@ bool audio_update_state(void) {
 
                 // '- delta': Skip forward in the next note's length if we've over shot
                 //            the last, so the overall length of the song is the same
-                uint16_t duration = audio_duration_to_ms((*notes_pointer)[current_note][1]);
+                uint16_t duration = audio_duration_to_ms(melody_note_duration(current_note));
 
                 // Skip forward past any completely missed notes
                 while (delta > duration && current_note < notes_count - 1) {
                     delta -= duration;
                     current_note++;
-                    duration = audio_duration_to_ms((*notes_pointer)[current_note][1]);
+                    duration = audio_duration_to_ms(melody_note_duration(current_note));
                 }
 
                 if (delta < duration) {
@@ -442,7 +481,7 @@ bool audio_update_state(void) {
                     duration = 1;
                 }
 
-                audio_play_note((*notes_pointer)[current_note][0], duration);
+                audio_play_note(melody_note_pitch(current_note), duration);
                 melody_current_note_duration = duration;
             }
         }
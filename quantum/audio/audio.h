@@ -147,6 +147,17 @@ void audio_stop_tone(float pitch);
  */
 void audio_play_melody(float (*np)[][2], uint16_t n_count, bool n_repeat);
 
+/**
+ * @brief plays a melody of compact notes, see AUDIO_COMPACT_SONGS
+ *
+ * @details like audio_play_melody, for a SONG kept in flash as musical_note_t
+ *
+ * @param[in] notes the SONG array, in flash
+ * @param[in] n_count number of MUSICAL_NOTES of the SONG
+ * @param[in] n_repeat false for onetime, true for looped playback
+ */
+void audio_play_compact_melody(const musical_note_t *notes, uint16_t n_count, bool n_repeat);
+
 /**
  * @brief play a short tone of a specific frequency to emulate a 'click'
  *
@@ -183,15 +194,21 @@ bool audio_is_playing_melody(void);
 // The global float array for the song must be used here.
 #define NOTE_ARRAY_SIZE(x) ((int16_t)(sizeof(x) / (sizeof(x[0]))))
 
+// Picks audio_play_compact_melody or audio_play_melody by the kind of array the song is
+#define AUDIO_PLAY_SONG(note_array, repeat)                                                                                          \
+    __builtin_choose_expr(__builtin_types_compatible_p(__typeof__((note_array)[0]), musical_note_t),                                 \
+                          audio_play_compact_melody((const musical_note_t *)(note_array), NOTE_ARRAY_SIZE((note_array)), (repeat)), \
+                          audio_play_melody((float(*)[][2]) & (note_array), NOTE_ARRAY_SIZE((note_array)), (repeat)))
+
 /**
  * @brief convenience macro, to play a melody/SONG once
  */
-#define PLAY_SONG(note_array) audio_play_melody(&note_array, NOTE_ARRAY_SIZE((note_array)), false)
+#define PLAY_SONG(note_array) AUDIO_PLAY_SONG(note_array, false)
 // TODO: a 'song' is a melody plus singing/vocals -> PLAY_MELODY
 /**
  * @brief convenience macro, to play a melody/SONG in a loop, until stopped by 'audio_stop_all'
  */
-#define PLAY_LOOP(note_array) audio_play_melody(&note_array, NOTE_ARRAY_SIZE((note_array)), true)
+#define PLAY_LOOP(note_array) AUDIO_PLAY_SONG(note_array, true)
 
 // Tone-Multiplexing functions
 // this feature only makes sense for hardware setups which can't do proper
@@ -81,11 +81,21 @@ static const dacsample_t dac_buffer_trapezoid[AUDIO_DAC_BUFFER_SIZE] = {0x0,   0
 
 static dacsample_t dac_buffer_empty[AUDIO_DAC_BUFFER_SIZE] = {AUDIO_DAC_OFF_VALUE};
 
-/* keep track of the sample position for for each frequency */
-static float dac_if[AUDIO_MAX_SIMULTANEOUS_TONES] = {0.0};
+/* keep track of the sample position for each frequency, as a phase in 1/2^32 turns of the waveform;
+ * advanced by a fixed step per sample so the DMA callback does no floating point work */
+static uint32_t dac_phase[AUDIO_MAX_SIMULTANEOUS_TONES] = {0};
 
-static float   active_tones_snapshot[AUDIO_MAX_SIMULTANEOUS_TONES] = {0, 0};
-static uint8_t active_tones_snapshot_length                        = 0;
+static uint32_t active_tones_snapshot[AUDIO_MAX_SIMULTANEOUS_TONES] = {0};  // phase step per sample
+static uint8_t  active_tones_snapshot_length                        = 0;
+
+/* phase step per sample for one Hz.
+ * Note: the 2/3 are necessary to get the correct frequencies on the DAC output
+ *       (as measured with an oscilloscope), since the gpt timer runs with
+ *       3*AUDIO_DAC_SAMPLE_RATE; and the DAC callback is called twice per conversion. */
+#define DAC_PHASE_STEP_PER_HZ (4294967296.0f * 2 / 3 / AUDIO_DAC_SAMPLE_RATE)
+
+// upper 16 bits of the phase scaled to the waveform table
+#define DAC_PHASE_TO_INDEX(phase) ((uint16_t)((((phase) >> 16) * AUDIO_DAC_BUFFER_SIZE) >> 16))
 
 typedef enum {
     OUTPUT_SHOULD_START,
@@ -116,49 +126,43 @@ __attribute__((weak)) uint16_t dac_value_generate(void) {
     /* doing additive wave synthesis over all currently playing tones = adding up
      * sine-wave-samples for each frequency, scaled by the number of active tones
      */
-    uint16_t value     = 0;
-    float    frequency = 0.0f;
+    uint32_t value = 0;
 
     for (uint8_t i = 0; i < active_tones_snapshot_length; i++) {
         /* Note: a user implementation does not have to rely on the active_tones_snapshot, but
          * could directly query the active frequencies through audio_get_processed_frequency */
-        frequency = active_tones_snapshot[i];
-
-        dac_if[i] = dac_if[i] + ((frequency * AUDIO_DAC_BUFFER_SIZE) / AUDIO_DAC_SAMPLE_RATE) * 2 / 3;
-        /*Note: the 2/3 are necessary to get the correct frequencies on the
-         *      DAC output (as measured with an oscilloscope), since the gpt
-         *      timer runs with 3*AUDIO_DAC_SAMPLE_RATE; and the DAC callback
-         *      is called twice per conversion.*/
-
-        dac_if[i] = fmod(dac_if[i], AUDIO_DAC_BUFFER_SIZE);
+        dac_phase[i] += active_tones_snapshot[i];
 
         // Wavetable generation/lookup
-        uint16_t dac_i = (uint16_t)dac_if[i];
+        uint16_t dac_i = DAC_PHASE_TO_INDEX(dac_phase[i]);
 
 #if defined(AUDIO_DAC_SAMPLE_WAVEFORM_SINE)
-        value += dac_buffer_sine[dac_i] / active_tones_snapshot_length;
+        value += dac_buffer_sine[dac_i];
 #elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_TRIANGLE)
-        value += dac_buffer_triangle[dac_i] / active_tones_snapshot_length;
+        value += dac_buffer_triangle[dac_i];
 #elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_TRAPEZOID)
-        value += dac_buffer_trapezoid[dac_i] / active_tones_snapshot_length;
+        value += dac_buffer_trapezoid[dac_i];
 #elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_SQUARE)
-        value += dac_buffer_square[dac_i] / active_tones_snapshot_length;
+        value += dac_buffer_square[dac_i];
 #endif
         /*
         // SINE
-        value += dac_buffer_sine[dac_i] / active_tones_snapshot_length / 3;
+        value += dac_buffer_sine[dac_i] / 3;
         // TRIANGLE
-        value += dac_buffer_triangle[dac_i] / active_tones_snapshot_length / 3;
+        value += dac_buffer_triangle[dac_i] / 3;
         // SQUARE
-        value += dac_buffer_square[dac_i] / active_tones_snapshot_length / 3;
+        value += dac_buffer_square[dac_i] / 3;
         //NOTE: combination of these three wave-forms is more exemplary - and doesn't sound particularly good :-P
         */
 
         // STAIRS (mostly usefully as test-pattern)
-        // value_avg = dac_buffer_staircase[dac_i] / active_tones_snapshot_length;
+        // value = dac_buffer_staircase[dac_i];
     }
 
-    return value;
+    // scale by the number of active tones once, instead of once per tone
+    value /= active_tones_snapshot_length;
+
+    return (uint16_t)value;
 }
 
 /**
@@ -221,7 +225,8 @@ static void dac_end(DACDriver *dacp) {
             for (uint8_t i = 0; i < active_tones; i++) {
                 float freq = audio_get_processed_frequency(i);
                 if (freq > 0) {  // disregard 'rest' notes, with valid frequency 0.0f; which would only lower the resulting waveform volume during the additive synthesis step
-                    active_tones_snapshot[active_tones_snapshot_length++] = freq;
+                    // the step is only computed here, when the tones change, and not for every sample
+                    active_tones_snapshot[active_tones_snapshot_length++] = (uint32_t)(freq * DAC_PHASE_STEP_PER_HZ);
                 }
             }
 
@@ -327,8 +332,8 @@ void audio_driver_start(void) {
     gptStartContinuous(&GPTD6, 2U);
 
     for (uint8_t i = 0; i < AUDIO_MAX_SIMULTANEOUS_TONES; i++) {
-        dac_if[i]                = 0.0f;
-        active_tones_snapshot[i] = 0.0f;
+        dac_phase[i]             = 0;
+        active_tones_snapshot[i] = 0;
     }
     active_tones_snapshot_length = 0;
     state                        = OUTPUT_SHOULD_START;
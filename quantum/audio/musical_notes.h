@@ -16,6 +16,9 @@
  */
 #pragma once
 
+#include <stdint.h>
+#include "progmem.h"
+
 #ifndef TEMPO_DEFAULT
 #    define TEMPO_DEFAULT 120
 // in beats-per-minute
@@ -24,9 +27,34 @@
 #define SONG(notes...) \
     { notes }
 
+/* With AUDIO_COMPACT_SONGS, songs are kept in flash as two bytes a note, the
+ * note's index from the table below and its duration, instead of two floats
+ * in RAM. Songs are then declared as
+ *
+ *   song_note_t SONG_STORAGE my_song[] = SONG(...);
+ *
+ * which is the same as float my_song[][2] without it. */
+typedef struct {
+    uint8_t note;      // NOTE_INDEX_*
+    uint8_t duration;  // in the same unit as MUSICAL_NOTE()
+} musical_note_t;
+
+#ifdef AUDIO_COMPACT_SONGS
+typedef const musical_note_t song_note_t;
+#    define SONG_STORAGE PROGMEM
+#else
+typedef float song_note_t[2];
+#    define SONG_STORAGE
+#endif
+
 // Note Types
-#define MUSICAL_NOTE(note, duration) \
-    { (NOTE##note), duration }
+#ifdef AUDIO_COMPACT_SONGS
+#    define MUSICAL_NOTE(n, d) \
+        { .note = (NOTE_INDEX##n), .duration = (d) }
+#else
+#    define MUSICAL_NOTE(note, duration) \
+        { (NOTE##note), duration }
+#endif
 
 #define BREVE_NOTE(note) MUSICAL_NOTE(note, 128)
 #define WHOLE_NOTE(note) MUSICAL_NOTE(note, 64)
@@ -232,3 +260,165 @@
 #define NOTE_GF8 NOTE_FS8
 #define NOTE_AF8 NOTE_GS8
 #define NOTE_BF8 NOTE_AS8
+
+// Note indices for compact songs, in semitones from C0
+
+#define NOTE_INDEX_REST 0xFF
+
+#define NOTE_INDEX_C0 0
+#define NOTE_INDEX_CS0 1
+#define NOTE_INDEX_D0 2
+#define NOTE_INDEX_DS0 3
+#define NOTE_INDEX_E0 4
+#define NOTE_INDEX_F0 5
+#define NOTE_INDEX_FS0 6
+#define NOTE_INDEX_G0 7
+#define NOTE_INDEX_GS0 8
+#define NOTE_INDEX_A0 9
+#define NOTE_INDEX_AS0 10
+#define NOTE_INDEX_B0 11
+#define NOTE_INDEX_C1 12
+#define NOTE_INDEX_CS1 13
+#define NOTE_INDEX_D1 14
+#define NOTE_INDEX_DS1 15
+#define NOTE_INDEX_E1 16
+#define NOTE_INDEX_F1 17
+#define NOTE_INDEX_FS1 18
+#define NOTE_INDEX_G1 19
+#define NOTE_INDEX_GS1 20
+#define NOTE_INDEX_A1 21
+#define NOTE_INDEX_AS1 22
+#define NOTE_INDEX_B1 23
+#define NOTE_INDEX_C2 24
+#define NOTE_INDEX_CS2 25
+#define NOTE_INDEX_D2 26
+#define NOTE_INDEX_DS2 27
+#define NOTE_INDEX_E2 28
+#define NOTE_INDEX_F2 29
+#define NOTE_INDEX_FS2 30
+#define NOTE_INDEX_G2 31
+#define NOTE_INDEX_GS2 32
+#define NOTE_INDEX_A2 33
+#define NOTE_INDEX_AS2 34
+#define NOTE_INDEX_B2 35
+#define NOTE_INDEX_C3 36
+#define NOTE_INDEX_CS3 37
+#define NOTE_INDEX_D3 38
+#define NOTE_INDEX_DS3 39
+#define NOTE_INDEX_E3 40
+#define NOTE_INDEX_F3 41
+#define NOTE_INDEX_FS3 42
+#define NOTE_INDEX_G3 43
+#define NOTE_INDEX_GS3 44
+#define NOTE_INDEX_A3 45
+#define NOTE_INDEX_AS3 46
+#define NOTE_INDEX_B3 47
+#define NOTE_INDEX_C4 48
+#define NOTE_INDEX_CS4 49
+#define NOTE_INDEX_D4 50
+#define NOTE_INDEX_DS4 51
+#define NOTE_INDEX_E4 52
+#define NOTE_INDEX_F4 53
+#define NOTE_INDEX_FS4 54
+#define NOTE_INDEX_G4 55
+#define NOTE_INDEX_GS4 56
+#define NOTE_INDEX_A4 57
+#define NOTE_INDEX_AS4 58
+#define NOTE_INDEX_B4 59
+#define NOTE_INDEX_C5 60
+#define NOTE_INDEX_CS5 61
+#define NOTE_INDEX_D5 62
+#define NOTE_INDEX_DS5 63
+#define NOTE_INDEX_E5 64
+#define NOTE_INDEX_F5 65
+#define NOTE_INDEX_FS5 66
+#define NOTE_INDEX_G5 67
+#define NOTE_INDEX_GS5 68
+#define NOTE_INDEX_A5 69
+#define NOTE_INDEX_AS5 70
+#define NOTE_INDEX_B5 71
+#define NOTE_INDEX_C6 72
+#define NOTE_INDEX_CS6 73
+#define NOTE_INDEX_D6 74
+#define NOTE_INDEX_DS6 75
+#define NOTE_INDEX_E6 76
+#define NOTE_INDEX_F6 77
+#define NOTE_INDEX_FS6 78
+#define NOTE_INDEX_G6 79
+#define NOTE_INDEX_GS6 80
+#define NOTE_INDEX_A6 81
+#define NOTE_INDEX_AS6 82
+#define NOTE_INDEX_B6 83
+#define NOTE_INDEX_C7 84
+#define NOTE_INDEX_CS7 85
+#define NOTE_INDEX_D7 86
+#define NOTE_INDEX_DS7 87
+#define NOTE_INDEX_E7 88
+#define NOTE_INDEX_F7 89
+#define NOTE_INDEX_FS7 90
+#define NOTE_INDEX_G7 91
+#define NOTE_INDEX_GS7 92
+#define NOTE_INDEX_A7 93
+#define NOTE_INDEX_AS7 94
+#define NOTE_INDEX_B7 95
+#define NOTE_INDEX_C8 96
+#define NOTE_INDEX_CS8 97
+#define NOTE_INDEX_D8 98
+#define NOTE_INDEX_DS8 99
+#define NOTE_INDEX_E8 100
+#define NOTE_INDEX_F8 101
+#define NOTE_INDEX_FS8 102
+#define NOTE_INDEX_G8 103
+#define NOTE_INDEX_GS8 104
+#define NOTE_INDEX_A8 105
+#define NOTE_INDEX_AS8 106
+#define NOTE_INDEX_B8 107
+
+// Flat Aliases
+#define NOTE_INDEX_DF0 NOTE_INDEX_CS0
+#define NOTE_INDEX_EF0 NOTE_INDEX_DS0
+#define NOTE_INDEX_GF0 NOTE_INDEX_FS0
+#define NOTE_INDEX_AF0 NOTE_INDEX_GS0
+#define NOTE_INDEX_BF0 NOTE_INDEX_AS0
+#define NOTE_INDEX_DF1 NOTE_INDEX_CS1
+#define NOTE_INDEX_EF1 NOTE_INDEX_DS1
+#define NOTE_INDEX_GF1 NOTE_INDEX_FS1
+#define NOTE_INDEX_AF1 NOTE_INDEX_GS1
+#define NOTE_INDEX_BF1 NOTE_INDEX_AS1
+#define NOTE_INDEX_DF2 NOTE_INDEX_CS2
+#define NOTE_INDEX_EF2 NOTE_INDEX_DS2
+#define NOTE_INDEX_GF2 NOTE_INDEX_FS2
+#define NOTE_INDEX_AF2 NOTE_INDEX_GS2
+#define NOTE_INDEX_BF2 NOTE_INDEX_AS2
+#define NOTE_INDEX_DF3 NOTE_INDEX_CS3
+#define NOTE_INDEX_EF3 NOTE_INDEX_DS3
+#define NOTE_INDEX_GF3 NOTE_INDEX_FS3
+#define NOTE_INDEX_AF3 NOTE_INDEX_GS3
+#define NOTE_INDEX_BF3 NOTE_INDEX_AS3
+#define NOTE_INDEX_DF4 NOTE_INDEX_CS4
+#define NOTE_INDEX_EF4 NOTE_INDEX_DS4
+#define NOTE_INDEX_GF4 NOTE_INDEX_FS4
+#define NOTE_INDEX_AF4 NOTE_INDEX_GS4
+#define NOTE_INDEX_BF4 NOTE_INDEX_AS4
+#define NOTE_INDEX_DF5 NOTE_INDEX_CS5
+#define NOTE_INDEX_EF5 NOTE_INDEX_DS5
+#define NOTE_INDEX_GF5 NOTE_INDEX_FS5
+#define NOTE_INDEX_AF5 NOTE_INDEX_GS5
+#define NOTE_INDEX_BF5 NOTE_INDEX_AS5
+#define NOTE_INDEX_DF6 NOTE_INDEX_CS6
+#define NOTE_INDEX_EF6 NOTE_INDEX_DS6
+#define NOTE_INDEX_GF6 NOTE_INDEX_FS6
+#define NOTE_INDEX_AF6 NOTE_INDEX_GS6
+#define NOTE_INDEX_BF6 NOTE_INDEX_AS6
+#define NOTE_INDEX_DF7 NOTE_INDEX_CS7
+#define NOTE_INDEX_EF7 NOTE_INDEX_DS7
+#define NOTE_INDEX_GF7 NOTE_INDEX_FS7
+#define NOTE_INDEX_AF7 NOTE_INDEX_GS7
+#define NOTE_INDEX_BF7 NOTE_INDEX_AS7
+#define NOTE_INDEX_DF8 NOTE_INDEX_CS8
+#define NOTE_INDEX_EF8 NOTE_INDEX_DS8
+#define NOTE_INDEX_GF8 NOTE_INDEX_FS8
+#define NOTE_INDEX_AF8 NOTE_INDEX_GS8
+#define NOTE_INDEX_BF8 NOTE_INDEX_AS8
+
+#define NOTE_INDEX_COUNT 108
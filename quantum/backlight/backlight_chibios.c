@@ -36,8 +36,32 @@
 #    endif
 #endif
 
-static PWMConfig pwmCFG = {0xFFFF, /* PWM clock frequency  */
-                           256,    /* PWM period (in ticks) 1S (1/10kHz=0.1mS 0.1ms*10000 ticks=1S) */
+#ifdef BACKLIGHT_BREATHING_DMA
+#    ifndef BACKLIGHT_BREATHING
+#        error "BACKLIGHT_BREATHING_DMA needs BACKLIGHT_BREATHING"
+#    endif
+#    ifndef BACKLIGHT_DMA_STREAM
+#        define BACKLIGHT_DMA_STREAM STM32_DMA1_STREAM6  // DMA Stream for TIMx_UP
+#    endif
+#    ifndef BACKLIGHT_DMA_CHANNEL
+#        define BACKLIGHT_DMA_CHANNEL 2  // DMA Channel for TIMx_UP
+#    endif
+#    if (STM32_DMA_SUPPORTS_DMAMUX == TRUE) && !defined(BACKLIGHT_DMAMUX_ID)
+#        error "please consult your MCU's datasheet and specify in your config.h: #define BACKLIGHT_DMAMUX_ID STM32_DMAMUX1_TIM?_UP"
+#    endif
+// Must divide the timer's clock
+#    ifndef BACKLIGHT_PWM_COUNTER_FREQUENCY
+#        define BACKLIGHT_PWM_COUNTER_FREQUENCY (STM32_SYSCLK / 2)
+#    endif
+// Full 16-bit duty resolution, at a few hundred Hz
+#    define BACKLIGHT_PWM_PERIOD 0xFFFF
+#else
+#    define BACKLIGHT_PWM_COUNTER_FREQUENCY 0xFFFF
+#    define BACKLIGHT_PWM_PERIOD 256
+#endif
+
+static PWMConfig pwmCFG = {BACKLIGHT_PWM_COUNTER_FREQUENCY, /* PWM clock frequency  */
+                           BACKLIGHT_PWM_PERIOD,            /* PWM period (in ticks) */
                            NULL,   /* Breathing Callback */
                            {       /* Default all channels to disabled - Channels will be configured durring init */
                             {PWM_OUTPUT_DISABLED, NULL},
@@ -111,6 +135,102 @@ void backlight_task(void) {}
  */
 static const uint8_t breathing_table[BREATHING_STEPS] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 3, 4, 5, 6, 8, 10, 12, 15, 17, 20, 24, 28, 32, 36, 41, 46, 51, 57, 63, 70, 76, 83, 91, 98, 106, 113, 121, 129, 138, 146, 154, 162, 170, 178, 185, 193, 200, 207, 213, 220, 225, 231, 235, 240, 244, 247, 250, 252, 253, 254, 255, 254, 253, 252, 250, 247, 244, 240, 235, 231, 225, 220, 213, 207, 200, 193, 185, 178, 170, 162, 154, 146, 138, 129, 121, 113, 106, 98, 91, 83, 76, 70, 63, 57, 51, 46, 41, 36, 32, 28, 24, 20, 17, 15, 12, 10, 8, 6, 5, 4, 3, 2, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
+// Use this before the cie_lightness function.
+static inline uint16_t scale_backlight(uint16_t v) { return v / BACKLIGHT_LEVELS * get_backlight_level(); }
+
+#    ifdef BACKLIGHT_BREATHING_DMA
+
+/* The timer's update event has the DMA write the next duty cycle into the
+ * channel's compare register every PWM period, from a circular buffer of
+ * BACKLIGHT_DMA_BUFFER_SIZE entries. Half of it is refilled each time the
+ * DMA is done with that half, so the CPU only wakes every few dozen periods,
+ * and each period gets its own 16-bit step of the curve, interpolated
+ * between the table's entries and gamma corrected. */
+
+#        ifndef BACKLIGHT_DMA_BUFFER_SIZE
+#            define BACKLIGHT_DMA_BUFFER_SIZE 64
+#        endif
+
+#        define BACKLIGHT_PWM_FREQUENCY (BACKLIGHT_PWM_COUNTER_FREQUENCY / BACKLIGHT_PWM_PERIOD)
+
+static uint32_t breathing_buffer[BACKLIGHT_DMA_BUFFER_SIZE];
+static bool     breathing = false;
+static uint32_t breathing_phase;  // through the breathing period, wrapping around at 2^32
+
+static void breathing_fill(uint32_t *duty, uint16_t count) {
+    uint32_t period = (uint32_t)get_breathing_period() * BACKLIGHT_PWM_FREQUENCY;
+    uint32_t step   = period ? UINT32_MAX / period : UINT32_MAX;
+
+    for (uint16_t i = 0; i < count; i++) {
+        breathing_phase += step;
+
+        // Position in the table's BREATHING_STEPS in 1/256 steps, each entry blended into the next one
+        uint16_t position = breathing_phase >> (32 - 15);
+        uint8_t  index    = position / 256;
+        uint8_t  frac     = position % 256;
+        uint16_t from     = breathing_table[index];
+        uint16_t to       = breathing_table[(index + 1) % BREATHING_STEPS];
+        uint16_t value    = from * 256 + (to - from) * frac;
+
+        duty[i] = PWM_FRACTION_TO_WIDTH(&BACKLIGHT_PWM_DRIVER, 0xFFFF, cie_lightness(rescale_limit_val(scale_backlight(value))));
+    }
+}
+
+static void breathing_dma_callback(void *param, uint32_t flags) {
+    (void)param;
+    // Refill the half the DMA has just finished with
+    if (flags & STM32_DMA_ISR_HTIF) {
+        breathing_fill(breathing_buffer, BACKLIGHT_DMA_BUFFER_SIZE / 2);
+    }
+    if (flags & STM32_DMA_ISR_TCIF) {
+        breathing_fill(breathing_buffer + BACKLIGHT_DMA_BUFFER_SIZE / 2, BACKLIGHT_DMA_BUFFER_SIZE / 2);
+    }
+}
+
+bool is_breathing(void) { return breathing; }
+
+void breathing_enable(void) {
+    if (breathing) {
+        return;
+    }
+    breathing = true;
+
+    breathing_fill(breathing_buffer, BACKLIGHT_DMA_BUFFER_SIZE);
+
+    static bool allocated = false;
+    if (!allocated) {
+        dmaStreamAlloc(BACKLIGHT_DMA_STREAM - STM32_DMA_STREAM(0), 10, breathing_dma_callback, NULL);
+        allocated = true;
+    }
+    dmaStreamSetPeripheral(BACKLIGHT_DMA_STREAM, &(BACKLIGHT_PWM_DRIVER.tim->CCR[BACKLIGHT_PWM_CHANNEL - 1]));
+    dmaStreamSetMemory0(BACKLIGHT_DMA_STREAM, breathing_buffer);
+    dmaStreamSetTransactionSize(BACKLIGHT_DMA_STREAM, BACKLIGHT_DMA_BUFFER_SIZE);
+    dmaStreamSetMode(BACKLIGHT_DMA_STREAM, STM32_DMA_CR_CHSEL(BACKLIGHT_DMA_CHANNEL) | STM32_DMA_CR_DIR_M2P | STM32_DMA_CR_PSIZE_WORD | STM32_DMA_CR_MSIZE_WORD | STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC | STM32_DMA_CR_HTIE | STM32_DMA_CR_TCIE | STM32_DMA_CR_PL(1));
+#        if (STM32_DMA_SUPPORTS_DMAMUX == TRUE)
+    dmaSetRequestSource(BACKLIGHT_DMA_STREAM, BACKLIGHT_DMAMUX_ID);
+#        endif
+    dmaStreamEnable(BACKLIGHT_DMA_STREAM);
+
+    // The channel has to be on for the DMA's duty cycles to show, whatever the level
+    pwmEnableChannel(&BACKLIGHT_PWM_DRIVER, BACKLIGHT_PWM_CHANNEL - 1, breathing_buffer[0]);
+    BACKLIGHT_PWM_DRIVER.tim->DIER |= TIM_DIER_UDE;
+}
+
+void breathing_disable(void) {
+    if (!breathing) {
+        return;
+    }
+    breathing = false;
+
+    BACKLIGHT_PWM_DRIVER.tim->DIER &= ~TIM_DIER_UDE;
+    dmaStreamDisable(BACKLIGHT_DMA_STREAM);
+
+    // Restore backlight level
+    backlight_set(get_backlight_level());
+}
+
+#    else
+
 void breathing_callback(PWMDriver *pwmp);
 
 bool is_breathing(void) { return pwmCFG.callback != NULL; }
@@ -128,9 +248,6 @@ void breathing_disable(void) {
     backlight_set(get_backlight_level());
 }
 
-// Use this before the cie_lightness function.
-static inline uint16_t scale_backlight(uint16_t v) { return v / BACKLIGHT_LEVELS * get_backlight_level(); }
-
 void breathing_callback(PWMDriver *pwmp) {
     uint8_t  breathing_period = get_breathing_period();
     uint16_t interval         = (uint16_t)breathing_period * 256 / BREATHING_STEPS;
@@ -146,6 +263,8 @@ void breathing_callback(PWMDriver *pwmp) {
     chSysUnlockFromISR();
 }
 
+#    endif
+
 // TODO: integrate generic pulse solution
 void breathing_pulse(void) {
     backlight_set(is_backlight_enabled() ? 0 : BACKLIGHT_LEVELS);
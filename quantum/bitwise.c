@@ -81,6 +81,10 @@ uint8_t biton16(uint16_t bits) {
 }
 
 uint8_t biton32(uint32_t bits) {
+#if !defined(__AVR__)
+    // a single instruction on the ARM cores, AVR has no count leading zeros
+    return bits ? 31 - __builtin_clz(bits) : 0;
+#else
     uint8_t n = 0;
     if (bits >> 16) {
         bits >>= 16;
@@ -103,6 +107,15 @@ uint8_t biton32(uint32_t bits) {
         n += 1;
     }
     return n;
+#endif
+}
+
+uint8_t biton64(uint64_t bits) {
+#if !defined(__AVR__)
+    return bits ? 63 - __builtin_clzll(bits) : 0;
+#else
+    return (bits >> 32) ? 32 + biton32(bits >> 32) : biton32(bits);
+#endif
 }
 
 __attribute__((noinline)) uint8_t bitrev(uint8_t bits) {
@@ -26,7 +26,7 @@ RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
     if (hsv.s == 0) {
 #ifdef USE_CIE1931_CURVE
         if (use_cie) {
-            rgb.r = rgb.g = rgb.b = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
+            rgb.r = rgb.g = rgb.b = hot_read_byte(CIE1931_CURVE, &CIE1931_CURVE[hsv.v]);
         } else {
             rgb.r = hsv.v;
             rgb.g = hsv.v;
@@ -44,7 +44,7 @@ RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
     s = hsv.s;
 #ifdef USE_CIE1931_CURVE
     if (use_cie) {
-        v = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
+        v = hot_read_byte(CIE1931_CURVE, &CIE1931_CURVE[hsv.v]);
     } else {
         v = hsv.v;
     }
@@ -106,6 +106,22 @@ RGB hsv_to_rgb(HSV hsv) {
 
 RGB hsv_to_rgb_nocie(HSV hsv) { return hsv_to_rgb_impl(hsv, false); }
 
+// Converts a run of LEDs in one pass. A run of equal colors, as solid and
+// breathing effects produce, is only converted once.
+void hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (i && hsv[i].h == hsv[i - 1].h && hsv[i].s == hsv[i - 1].s && hsv[i].v == hsv[i - 1].v) {
+            rgb[i] = rgb[i - 1];
+            continue;
+        }
+#ifdef USE_CIE1931_CURVE
+        rgb[i] = hsv_to_rgb_impl(hsv[i], true);
+#else
+        rgb[i] = hsv_to_rgb_impl(hsv[i], false);
+#endif
+    }
+}
+
 #ifdef RGBW
 #    ifndef MIN
 #        define MIN(a, b) ((a) < (b) ? (a) : (b))
@@ -26,15 +26,30 @@ When no state changes have occured for DEBOUNCE milliseconds, we push the state.
 void        debounce_init(uint8_t num_rows) {}
 static bool debouncing = false;
 
-#if DEBOUNCE > 0
+#ifdef DEBOUNCE_US
+#    define DEBOUNCE_ACTIVE (DEBOUNCE_US > 0)
+#else
+#    define DEBOUNCE_ACTIVE (DEBOUNCE > 0)
+#endif
+
+#if DEBOUNCE_ACTIVE
+#    ifdef DEBOUNCE_US
+static uint32_t debouncing_time;
+#        define DEBOUNCE_ELAPSED() (timer_elapsed_us(debouncing_time) >= DEBOUNCE_US)
+#        define DEBOUNCE_START() timer_read_us()
+#    else
 static uint16_t debouncing_time;
-void            debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+// Over DEBOUNCE, as the millisecond the timer was read in may have been almost over
+#        define DEBOUNCE_ELAPSED() (timer_elapsed(debouncing_time) > DEBOUNCE)
+#        define DEBOUNCE_START() timer_read()
+#    endif
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
     if (changed) {
         debouncing      = true;
-        debouncing_time = timer_read();
+        debouncing_time = DEBOUNCE_START();
     }
 
-    if (debouncing && timer_elapsed(debouncing_time) > DEBOUNCE) {
+    if (debouncing && DEBOUNCE_ELAPSED()) {
         for (int i = 0; i < num_rows; i++) {
             cooked[i] = raw[i];
         }
@@ -0,0 +1,138 @@
+/*
+Copyright 2021 QMK
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+Symmetric per-key algorithm using vertical counters.
+Bit n of each counter plane belongs to column n, so a whole row of counters is
+advanced with a handful of bitwise operations instead of a loop over the keys.
+When no state changes have occured for DEBOUNCE milliseconds on a key, we push its state.
+*/
+
+#include "matrix.h"
+#include "timer.h"
+#include "quantum.h"
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+#ifdef DEBOUNCE_US
+#    error DEBOUNCE_US is not supported by this debounce algorithm, its counters advance once per millisecond
+#endif
+
+#if DEBOUNCE < 2
+#    define DEBOUNCE_COUNTER_BITS 1
+#elif DEBOUNCE < 4
+#    define DEBOUNCE_COUNTER_BITS 2
+#elif DEBOUNCE < 8
+#    define DEBOUNCE_COUNTER_BITS 3
+#elif DEBOUNCE < 16
+#    define DEBOUNCE_COUNTER_BITS 4
+#elif DEBOUNCE < 32
+#    define DEBOUNCE_COUNTER_BITS 5
+#elif DEBOUNCE < 64
+#    define DEBOUNCE_COUNTER_BITS 6
+#elif DEBOUNCE < 128
+#    define DEBOUNCE_COUNTER_BITS 7
+#elif DEBOUNCE < 256
+#    define DEBOUNCE_COUNTER_BITS 8
+#else
+#    error DEBOUNCE must be less than 256 with this debounce algorithm
+#endif
+
+#if DEBOUNCE > 0
+// counters[row][n] holds bit n of the millisecond counter of every key in the row
+static matrix_row_t counters[MATRIX_ROWS][DEBOUNCE_COUNTER_BITS];
+// Keys whose raw state differs from the cooked state and are being counted
+static matrix_row_t pending[MATRIX_ROWS];
+static bool         counters_need_update;
+static uint16_t     last_time;
+
+// Adds one to the counters of the keys in mask
+static void counters_increment(matrix_row_t *planes, matrix_row_t mask) {
+    for (uint8_t n = 0; n < DEBOUNCE_COUNTER_BITS && mask; n++) {
+        matrix_row_t carry = planes[n] & mask;
+        planes[n] ^= mask;
+        mask = carry;
+    }
+}
+
+// Returns the keys whose counters are equal to DEBOUNCE
+static matrix_row_t counters_elapsed(const matrix_row_t *planes) {
+    matrix_row_t elapsed = ~(matrix_row_t)0;
+    for (uint8_t n = 0; n < DEBOUNCE_COUNTER_BITS; n++) {
+        elapsed &= (DEBOUNCE & (1 << n)) ? planes[n] : ~planes[n];
+    }
+    return elapsed;
+}
+
+static void counters_clear(matrix_row_t *planes, matrix_row_t mask) {
+    for (uint8_t n = 0; n < DEBOUNCE_COUNTER_BITS; n++) {
+        planes[n] &= ~mask;
+    }
+}
+
+// we use num_rows rather than MATRIX_ROWS to support split keyboards
+void debounce_init(uint8_t num_rows) { last_time = timer_read(); }
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    uint16_t now     = timer_read();
+    uint16_t elapsed = TIMER_DIFF_16(now, last_time);
+    last_time        = now;
+
+    if (!counters_need_update && !changed) {
+        return;
+    }
+
+    if (elapsed > DEBOUNCE) {
+        elapsed = DEBOUNCE;
+    }
+
+    counters_need_update = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t *planes = counters[row];
+
+        // Keys that bounced back to the cooked state start over
+        matrix_row_t settled = pending[row] & ~(raw[row] ^ cooked[row]);
+        counters_clear(planes, settled);
+        pending[row] &= ~settled;
+
+        for (uint16_t i = 0; i < elapsed && pending[row]; i++) {
+            counters_increment(planes, pending[row]);
+            matrix_row_t expired = counters_elapsed(planes) & pending[row];
+            cooked[row] ^= expired;
+            counters_clear(planes, expired);
+            pending[row] &= ~expired;
+        }
+
+        // Keys that changed during this scan start counting from now
+        pending[row] |= raw[row] ^ cooked[row];
+        if (pending[row]) {
+            counters_need_update = true;
+        }
+    }
+}
+
+bool debounce_active(void) { return counters_need_update; }
+#else  // no debouncing.
+void debounce_init(uint8_t num_rows) {}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    for (int i = 0; i < num_rows; i++) {
+        cooked[i] = raw[i];
+    }
+}
+
+bool debounce_active(void) { return false; }
+#endif
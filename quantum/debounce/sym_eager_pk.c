@@ -21,46 +21,53 @@ No further inputs are accepted until DEBOUNCE milliseconds have occurred.
 #include "matrix.h"
 #include "timer.h"
 #include "quantum.h"
-#include <stdlib.h>
-
-#ifdef PROTOCOL_CHIBIOS
-#    if CH_CFG_USE_MEMCORE == FALSE
-#        error ChibiOS is configured without a memory allocator. Your keyboard may have set `#define CH_CFG_USE_MEMCORE FALSE`, which is incompatible with this debounce algorithm.
-#    endif
-#endif
 
 #ifndef DEBOUNCE
 #    define DEBOUNCE 5
 #endif
 
-#define ROW_SHIFTER ((matrix_row_t)1)
+// With DEBOUNCE_US the counters hold microseconds in 16 bits instead of milliseconds in 8
+#ifdef DEBOUNCE_US
+#    if DEBOUNCE_US > 60000
+#        error DEBOUNCE_US must not be larger than 60000 with this debounce algorithm, use DEBOUNCE instead
+#    endif
+#    define DEBOUNCE_TIME DEBOUNCE_US
+#    define debounce_counter_t uint16_t
+#    define debounce_timer_t uint32_t
+#    define DEBOUNCE_TIMER_READ() timer_read_us()
+#    define DEBOUNCE_ELAPSED UINT16_MAX
+#else
+#    define DEBOUNCE_TIME DEBOUNCE
+#    define debounce_counter_t uint8_t
+#    define debounce_timer_t uint16_t
+#    define DEBOUNCE_TIMER_READ() timer_read()
+#    define DEBOUNCE_ELAPSED 251
+#endif
+#define MAX_DEBOUNCE (DEBOUNCE_ELAPSED - 1)
 
-#define debounce_counter_t uint8_t
+#define ROW_SHIFTER ((matrix_row_t)1)
 
-static debounce_counter_t *debounce_counters;
-static bool                counters_need_update;
-static bool                matrix_need_update;
 
-#define DEBOUNCE_ELAPSED 251
-#define MAX_DEBOUNCE (DEBOUNCE_ELAPSED - 1)
+static debounce_counter_t debounce_counters[MATRIX_ROWS * MATRIX_COLS];
+static bool               counters_need_update;
+static bool               matrix_need_update;
 
-static uint8_t wrapping_timer_read(void) {
-    static uint16_t time        = 0;
-    static uint8_t  last_result = 0;
-    uint16_t        new_time    = timer_read();
-    uint16_t        diff        = new_time - time;
-    time                        = new_time;
-    last_result                 = (last_result + diff) % (MAX_DEBOUNCE + 1);
+static debounce_counter_t wrapping_timer_read(void) {
+    static debounce_timer_t   time        = 0;
+    static debounce_counter_t last_result = 0;
+    debounce_timer_t          new_time    = DEBOUNCE_TIMER_READ();
+    debounce_timer_t          diff        = new_time - time;
+    time                                  = new_time;
+    last_result                           = ((debounce_timer_t)last_result + diff) % (MAX_DEBOUNCE + 1);
     return last_result;
 }
 
-void update_debounce_counters(uint8_t num_rows, uint8_t current_time);
-void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t current_time);
+void update_debounce_counters(uint8_t num_rows, debounce_counter_t current_time);
+void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, debounce_counter_t current_time);
 
 // we use num_rows rather than MATRIX_ROWS to support split keyboards
 void debounce_init(uint8_t num_rows) {
-    debounce_counters = (debounce_counter_t *)malloc(num_rows * MATRIX_COLS * sizeof(debounce_counter_t));
-    int i             = 0;
+    int i = 0;
     for (uint8_t r = 0; r < num_rows; r++) {
         for (uint8_t c = 0; c < MATRIX_COLS; c++) {
             debounce_counters[i++] = DEBOUNCE_ELAPSED;
@@ -69,7 +76,7 @@ void debounce_init(uint8_t num_rows) {
 }
 
 void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
-    uint8_t current_time = wrapping_timer_read();
+    debounce_counter_t current_time = wrapping_timer_read();
     if (counters_need_update) {
         update_debounce_counters(num_rows, current_time);
     }
@@ -80,13 +87,13 @@ void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool
 }
 
 // If the current time is > debounce counter, set the counter to enable input.
-void update_debounce_counters(uint8_t num_rows, uint8_t current_time) {
+void update_debounce_counters(uint8_t num_rows, debounce_counter_t current_time) {
     counters_need_update                 = false;
     debounce_counter_t *debounce_pointer = debounce_counters;
     for (uint8_t row = 0; row < num_rows; row++) {
         for (uint8_t col = 0; col < MATRIX_COLS; col++) {
             if (*debounce_pointer != DEBOUNCE_ELAPSED) {
-                if (TIMER_DIFF(current_time, *debounce_pointer, MAX_DEBOUNCE) >= DEBOUNCE) {
+                if (TIMER_DIFF(current_time, *debounce_pointer, MAX_DEBOUNCE) >= DEBOUNCE_TIME) {
                     *debounce_pointer = DEBOUNCE_ELAPSED;
                 } else {
                     counters_need_update = true;
@@ -98,7 +105,7 @@ void update_debounce_counters(uint8_t num_rows, uint8_t current_time) {
 }
 
 // upload from raw_matrix to final matrix;
-void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t current_time) {
+void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, debounce_counter_t current_time) {
     matrix_need_update                   = false;
     debounce_counter_t *debounce_pointer = debounce_counters;
     for (uint8_t row = 0; row < num_rows; row++) {
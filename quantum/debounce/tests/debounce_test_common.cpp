@@ -0,0 +1,211 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "debounce_test_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+extern "C" {
+void set_time(uint32_t t);
+}
+
+// Long enough for every algorithm to let go of the last change
+#define SETTLE_TIME (4 * DEBOUNCE + 20)
+
+static bool raw_state(const matrix_row_t *matrix, uint8_t row, uint8_t col) { return matrix[row] & ((matrix_row_t)1 << col); }
+
+void DebounceTest::SetUp() {
+    seed_ = 0x2545F491;
+    transitions_.clear();
+    glitches_.clear();
+    memset(raw_, 0, sizeof(raw_));
+    memset(cooked_, 0, sizeof(cooked_));
+
+    // The algorithms keep their state in statics, so let whatever the last test left behind run out
+    debounce_init(MATRIX_ROWS);
+    uint32_t now = timer_read32();
+    for (uint32_t t = 0; t < SETTLE_TIME; t++) {
+        set_time(++now);
+        debounce(raw_, cooked_, MATRIX_ROWS, t == 0);
+    }
+    memset(cooked_, 0, sizeof(cooked_));
+}
+
+uint32_t DebounceTest::random(void) {
+    // xorshift32, so every run of a test sees the same bounces
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 17;
+    seed_ ^= seed_ << 5;
+    return seed_;
+}
+
+void DebounceTest::add_transition(uint32_t time, uint8_t row, uint8_t col, bool pressed, uint8_t chatter) {
+    chatter          = std::min<uint8_t>(chatter, 32);
+    uint32_t pattern = random();
+    // The first contact is always in the new state, the rest of the chatter is noise
+    pattern = pressed ? (pattern | 1) : (pattern & ~(uint32_t)1);
+    transitions_.push_back({time, row, col, pressed, chatter, pattern});
+}
+
+void DebounceTest::add_tap(uint32_t time, uint8_t row, uint8_t col, uint32_t hold, uint8_t chatter) {
+    add_transition(time, row, col, true, chatter);
+    add_transition(time + hold, row, col, false, chatter);
+}
+
+void DebounceTest::add_glitch(uint32_t time, uint8_t row, uint8_t col, uint8_t length) { glitches_.push_back({time, row, col, length}); }
+
+uint32_t DebounceTest::add_random_taps(uint32_t time, uint32_t seed, unsigned groups, unsigned simultaneous, uint8_t max_chatter, uint8_t num_rows) {
+    seed_ = seed ? seed : 1;
+    simultaneous = std::min<unsigned>(simultaneous, num_rows * MATRIX_COLS);
+    for (unsigned group = 0; group < groups; group++) {
+        uint32_t             hold = 40 + random() % 40;
+        std::vector<uint8_t> rows, cols;
+        while (rows.size() < simultaneous) {
+            uint8_t row = random() % num_rows;
+            uint8_t col = random() % MATRIX_COLS;
+            bool    dup = false;
+            for (size_t i = 0; i < rows.size(); i++) {
+                dup |= rows[i] == row && cols[i] == col;
+            }
+            if (!dup) {
+                rows.push_back(row);
+                cols.push_back(col);
+            }
+        }
+        for (size_t i = 0; i < rows.size(); i++) {
+            uint32_t offset = random() % (max_chatter + 1);
+            add_tap(time + offset, rows[i], cols[i], hold, random() % (max_chatter + 1));
+        }
+        time += max_chatter + hold + max_chatter + 40 + random() % 40;
+    }
+    return time;
+}
+
+DebounceStats DebounceTest::run(uint8_t num_rows) {
+    std::stable_sort(transitions_.begin(), transitions_.end(), [](const Transition &a, const Transition &b) { return a.time < b.time; });
+
+    uint32_t length = 0;
+    for (auto &t : transitions_) {
+        length = std::max(length, t.time + t.chatter);
+    }
+    for (auto &g : glitches_) {
+        length = std::max<uint32_t>(length, g.time + g.length);
+    }
+    length += SETTLE_TIME;
+
+    // The raw matrix for every millisecond of the simulation
+    std::vector<matrix_row_t> timeline(length * MATRIX_ROWS, 0);
+    auto                      set_key = [&](uint32_t time, uint8_t row, uint8_t col, bool pressed) {
+        matrix_row_t &bits = timeline[time * MATRIX_ROWS + row];
+        bits               = pressed ? (bits | ((matrix_row_t)1 << col)) : (bits & ~((matrix_row_t)1 << col));
+    };
+    for (auto &t : transitions_) {
+        for (uint32_t time = t.time; time < length; time++) {
+            set_key(time, t.row, t.col, t.pressed);
+        }
+        for (uint8_t i = 0; i < t.chatter; i++) {
+            set_key(t.time + i, t.row, t.col, (t.pattern >> i) & 1);
+        }
+    }
+    for (auto &g : glitches_) {
+        for (uint8_t i = 0; i < g.length; i++) {
+            timeline[(g.time + i) * MATRIX_ROWS + g.row] ^= (matrix_row_t)1 << g.col;
+        }
+    }
+
+    struct Change {
+        uint32_t time;
+        bool     pressed;
+    };
+    std::vector<std::vector<Change>> changes(MATRIX_ROWS * MATRIX_COLS);
+
+    uint32_t                 start = timer_read32();
+    std::chrono::nanoseconds cpu_time(0);
+    for (uint32_t time = 0; time < length; time++) {
+        set_time(start + time);
+        matrix_row_t previous[MATRIX_ROWS];
+        memcpy(previous, cooked_, sizeof(previous));
+
+        bool changed = false;
+        for (uint8_t row = 0; row < num_rows; row++) {
+            matrix_row_t bits = timeline[time * MATRIX_ROWS + row];
+            changed |= bits != raw_[row];
+            raw_[row] = bits;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        debounce(raw_, cooked_, num_rows, changed);
+        cpu_time += std::chrono::steady_clock::now() - begin;
+
+        for (uint8_t row = 0; row < num_rows; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                if (raw_state(previous, row, col) != raw_state(cooked_, row, col)) {
+                    changes[row * MATRIX_COLS + col].push_back({time, raw_state(cooked_, row, col)});
+                }
+            }
+        }
+    }
+
+    DebounceStats stats = {};
+    stats.scans         = length;
+    stats.ns_per_scan   = (double)cpu_time.count() / length;
+
+    // Every intended change should show up once in the cooked matrix before the next one on the same key
+    uint64_t total_latency = 0;
+    for (uint16_t key = 0; key < MATRIX_ROWS * MATRIX_COLS; key++) {
+        std::vector<const Transition *> intended;
+        for (auto &t : transitions_) {
+            if (t.row * MATRIX_COLS + t.col == key) {
+                intended.push_back(&t);
+            }
+        }
+        auto   &cooked = changes[key];
+        size_t  next   = 0;
+        // Changes before the first intended one can only be noise
+        while (next < cooked.size() && (intended.empty() || cooked[next].time < intended[0]->time)) {
+            stats.extra++;
+            next++;
+        }
+        for (size_t i = 0; i < intended.size(); i++) {
+            uint32_t until = i + 1 < intended.size() ? intended[i + 1]->time : length;
+            bool     found = false;
+            stats.transitions++;
+            for (; next < cooked.size() && cooked[next].time < until; next++) {
+                if (!found && cooked[next].pressed == intended[i]->pressed) {
+                    uint32_t latency = cooked[next].time - intended[i]->time;
+                    stats.max_latency = std::max(stats.max_latency, latency);
+                    total_latency += latency;
+                    found = true;
+                } else {
+                    stats.extra++;
+                }
+            }
+            if (!found) {
+                stats.missed++;
+            }
+        }
+    }
+    unsigned found    = stats.transitions - stats.missed;
+    stats.mean_latency = found ? (double)total_latency / found : 0.0;
+    return stats;
+}
+
+void DebounceTest::report(const char *name, const DebounceStats &stats) {
+    printf("[ DEBOUNCE ] %-24s %4u transitions %3u missed %3u extra, latency max %3u ms mean %5.2f ms, %6.1f ns per scan\n", name, stats.transitions, stats.missed, stats.extra, stats.max_latency, stats.mean_latency, stats.ns_per_scan);
+}
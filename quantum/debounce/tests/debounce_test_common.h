@@ -0,0 +1,86 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include "quantum.h"
+#include "timer.h"
+#include "debounce.h"
+}
+
+// What came out of the debounce algorithm for the intended key changes of a simulation
+struct DebounceStats {
+    unsigned transitions;  // intended key changes
+    unsigned missed;       // intended changes that never made it to the cooked matrix
+    unsigned extra;        // cooked changes on top of one per intended change
+    uint32_t max_latency;  // ms from the first contact of a change to its cooked change
+    double   mean_latency;
+    unsigned scans;
+    double   ns_per_scan;  // host CPU time spent in debounce(), not checked
+};
+
+/*
+ * Simulates the raw matrix of a keyboard one scan per millisecond, with the
+ * contacts of every key bouncing around each intended change, and feeds it
+ * through debounce() like matrix_scan() does.
+ */
+class DebounceTest : public ::testing::Test {
+   protected:
+    void SetUp() override;
+
+    // The key starts moving to `pressed` at `time` and bounces for `chatter` ms before it settles
+    void add_transition(uint32_t time, uint8_t row, uint8_t col, bool pressed, uint8_t chatter = 0);
+    // A press at `time` and a release `hold` ms later, both bouncing for `chatter` ms
+    void add_tap(uint32_t time, uint8_t row, uint8_t col, uint32_t hold, uint8_t chatter = 0);
+    // Noise that flips an idle key for `length` ms without an intended change
+    void add_glitch(uint32_t time, uint8_t row, uint8_t col, uint8_t length);
+    // `groups` rounds of `simultaneous` distinct keys pressed within `max_chatter` ms of each other,
+    // each bouncing for up to `max_chatter` ms, starting at `time`; returns the end of the last round
+    uint32_t add_random_taps(uint32_t time, uint32_t seed, unsigned groups, unsigned simultaneous, uint8_t max_chatter, uint8_t num_rows = MATRIX_ROWS);
+
+    DebounceStats run(uint8_t num_rows = MATRIX_ROWS);
+    void          report(const char *name, const DebounceStats &stats);
+
+   private:
+    struct Transition {
+        uint32_t time;
+        uint8_t  row;
+        uint8_t  col;
+        bool     pressed;
+        uint8_t  chatter;
+        uint32_t pattern;  // bit n is the contact state n ms into the chatter
+    };
+    struct Glitch {
+        uint32_t time;
+        uint8_t  row;
+        uint8_t  col;
+        uint8_t  length;
+    };
+
+    uint32_t random(void);
+
+    uint32_t                seed_;
+    std::vector<Transition> transitions_;
+    std::vector<Glitch>     glitches_;
+    matrix_row_t            raw_[MATRIX_ROWS];
+    matrix_row_t            cooked_[MATRIX_ROWS];
+};
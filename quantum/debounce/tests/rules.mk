@@ -0,0 +1,56 @@
+# The letter case of these variables might seem odd. However:
+# - it is consistent with the serial_link example that is used as a reference in the Unit Testing article (https://docs.qmk.fm/#/unit_testing?id=adding-tests-for-new-or-existing-features)
+# - Neither `make test:debounce_sym_defer_g` or `make test:DEBOUNCE_SYM_DEFER_G` work when using SCREAMING_SNAKE_CASE
+
+# 32 columns so the vertical counters run on full 32 bit rows
+DEBOUNCE_COMMON_DEFS := -DNO_DEBUG -DMATRIX_ROWS=16 -DMATRIX_COLS=32 -DDEBOUNCE=5
+
+DEBOUNCE_COMMON_SRC := \
+	$(QUANTUM_PATH)/debounce/tests/debounce_test_common.cpp \
+	$(TMK_PATH)/common/test/timer.c
+
+debounce_sym_defer_g_DEFS := $(DEBOUNCE_COMMON_DEFS)
+debounce_sym_defer_g_SRC := \
+	$(DEBOUNCE_COMMON_SRC) \
+	$(QUANTUM_PATH)/debounce/sym_defer_g.c \
+	$(QUANTUM_PATH)/debounce/tests/sym_defer_g_tests.cpp
+
+debounce_sym_defer_pk_DEFS := $(DEBOUNCE_COMMON_DEFS)
+debounce_sym_defer_pk_SRC := \
+	$(DEBOUNCE_COMMON_SRC) \
+	$(QUANTUM_PATH)/debounce/sym_defer_pk.c \
+	$(QUANTUM_PATH)/debounce/tests/sym_defer_pk_tests.cpp
+
+debounce_sym_defer_vc_DEFS := $(DEBOUNCE_COMMON_DEFS)
+debounce_sym_defer_vc_SRC := \
+	$(DEBOUNCE_COMMON_SRC) \
+	$(QUANTUM_PATH)/debounce/sym_defer_vc.c \
+	$(QUANTUM_PATH)/debounce/tests/sym_defer_vc_tests.cpp
+
+debounce_sym_eager_pk_DEFS := $(DEBOUNCE_COMMON_DEFS)
+debounce_sym_eager_pk_SRC := \
+	$(DEBOUNCE_COMMON_SRC) \
+	$(QUANTUM_PATH)/debounce/sym_eager_pk.c \
+	$(QUANTUM_PATH)/debounce/tests/sym_eager_pk_tests.cpp
+
+debounce_sym_eager_pr_DEFS := $(DEBOUNCE_COMMON_DEFS)
+debounce_sym_eager_pr_SRC := \
+	$(DEBOUNCE_COMMON_SRC) \
+	$(QUANTUM_PATH)/debounce/sym_eager_pr.c \
+	$(QUANTUM_PATH)/debounce/tests/sym_eager_pr_tests.cpp
+
+debounce_sym_eager_vc_DEFS := $(DEBOUNCE_COMMON_DEFS)
+debounce_sym_eager_vc_SRC := \
+	$(DEBOUNCE_COMMON_SRC) \
+	$(QUANTUM_PATH)/debounce/sym_eager_vc.c \
+	$(QUANTUM_PATH)/debounce/tests/sym_eager_vc_tests.cpp
+
+# The same tests, with the timestamps in microseconds
+debounce_sym_defer_pk_us_DEFS := $(DEBOUNCE_COMMON_DEFS) -DDEBOUNCE_US=5000
+debounce_sym_defer_pk_us_SRC := $(debounce_sym_defer_pk_SRC)
+
+debounce_sym_eager_pk_us_DEFS := $(DEBOUNCE_COMMON_DEFS) -DDEBOUNCE_US=5000
+debounce_sym_eager_pk_us_SRC := $(debounce_sym_eager_pk_SRC)
+
+debounce_sym_eager_pr_us_DEFS := $(DEBOUNCE_COMMON_DEFS) -DDEBOUNCE_US=5000
+debounce_sym_eager_pr_us_SRC := $(debounce_sym_eager_pr_SRC)
@@ -0,0 +1,72 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "debounce_test_common.h"
+
+// A timer per key, a change is pushed once the key has been stable for DEBOUNCE ms.
+
+TEST_F(DebounceTest, PressAndRelease) {
+    add_tap(10, 0, 0, 50);
+    DebounceStats stats = run();
+    EXPECT_EQ(stats.transitions, 2);
+    EXPECT_EQ(stats.missed, 0);
+    EXPECT_EQ(stats.extra, 0);
+    EXPECT_EQ(stats.max_latency, DEBOUNCE);
+}
+
+TEST_F(DebounceTest, ChatterShorterThanDebounce) {
+    add_tap(10, 1, 3, 50, DEBOUNCE - 1);
+    add_tap(100, 15, 31, 50, DEBOUNCE - 1);
+    add_tap(200, 7, 0, 50, DEBOUNCE - 1);
+    DebounceStats stats = run();
+    EXPECT_EQ(stats.transitions, 6);
+    EXPECT_EQ(stats.missed, 0);
+    EXPECT_EQ(stats.extra, 0);
+    EXPECT_LE(stats.max_latency, (DEBOUNCE - 1) + DEBOUNCE);
+}
+
+TEST_F(DebounceTest, NoiseOnIdleKey) {
+    add_glitch(10, 2, 5, 1);
+    add_glitch(50, 2, 5, DEBOUNCE - 1);
+    DebounceStats stats = run();
+    // Noise shorter than DEBOUNCE never makes it to the cooked matrix
+    EXPECT_EQ(stats.extra, 0);
+}
+
+TEST_F(DebounceTest, FuzzedSimultaneousPresses) {
+    for (uint32_t seed = 1; seed <= 20; seed++) {
+        SetUp();
+        add_random_taps(10, seed, 20, 4, DEBOUNCE - 1);
+        DebounceStats stats = run();
+        EXPECT_EQ(stats.transitions, 160) << "seed " << seed;
+        EXPECT_EQ(stats.missed, 0) << "seed " << seed;
+        EXPECT_EQ(stats.extra, 0) << "seed " << seed;
+        EXPECT_LE(stats.max_latency, (DEBOUNCE - 1) + DEBOUNCE) << "seed " << seed;
+    }
+}
+
+TEST_F(DebounceTest, ScanCost) {
+    for (uint8_t rows : {4, 8, 16}) {
+        SetUp();
+        add_random_taps(10, 7, 50, 6, DEBOUNCE - 1, rows);
+        DebounceStats stats = run(rows);
+        EXPECT_EQ(stats.missed, 0);
+
+        char name[32];
+        snprintf(name, sizeof(name), "sym_defer_pk %ux%u", rows, MATRIX_COLS);
+        report(name, stats);
+    }
+}
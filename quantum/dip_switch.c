@@ -18,8 +18,7 @@
 
 #include "dip_switch.h"
 
-// for memcpy
-#include <string.h>
+#include "timer.h"
 
 #if !defined(DIP_SWITCH_PINS) && !defined(DIP_SWITCH_MATRIX_GRID)
 #    error "Either DIP_SWITCH_PINS or DIP_SWITCH_MATRIX_GRID must be defined."
@@ -46,8 +45,15 @@ extern bool           peek_matrix(uint8_t row_index, uint8_t col_index, bool rea
 static uint16_t       scan_count;
 #endif /* DIP_SWITCH_MATRIX_GRID */
 
-static bool dip_switch_state[NUMBER_OF_DIP_SWITCHES]      = {0};
-static bool last_dip_switch_state[NUMBER_OF_DIP_SWITCHES] = {0};
+_Static_assert(NUMBER_OF_DIP_SWITCHES <= 32, "At most 32 DIP switches are supported");
+
+// DIP switches are set by hand, now and then, so there's no need to read them on every scan
+#ifndef DIP_SWITCH_POLL_INTERVAL
+#    define DIP_SWITCH_POLL_INTERVAL 10
+#endif
+
+static uint32_t last_dip_switch_mask = 0;
+static uint16_t dip_switch_timer     = 0;
 
 __attribute__((weak)) void dip_switch_update_user(uint8_t index, bool active) {}
 
@@ -69,13 +75,25 @@ void dip_switch_init(void) {
 #endif
 }
 
-void dip_switch_read(bool forced) {
-    bool     has_dip_state_changed = false;
-    uint32_t dip_switch_mask       = 0;
-
+// One bit for each switch, set while it is on
+static uint32_t dip_switch_read_mask(bool read_raw) {
+    uint32_t dip_switch_mask = 0;
+    for (uint8_t i = 0; i < NUMBER_OF_DIP_SWITCHES; i++) {
+#ifdef DIP_SWITCH_PINS
+        bool active = !readPin(dip_switch_pad[i]);
+#endif
 #ifdef DIP_SWITCH_MATRIX_GRID
+        bool active = peek_matrix(dip_switch_pad[i].row, dip_switch_pad[i].col, read_raw);
+#endif
+        dip_switch_mask |= (uint32_t)active << i;
+    }
+    return dip_switch_mask;
+}
+
+void dip_switch_read(bool forced) {
     bool read_raw = false;
 
+#ifdef DIP_SWITCH_MATRIX_GRID
     if (scan_count < 500) {
         scan_count++;
         if (scan_count == 10) {
@@ -87,21 +105,22 @@ void dip_switch_read(bool forced) {
     }
 #endif
 
+    if (!forced && timer_elapsed(dip_switch_timer) < DIP_SWITCH_POLL_INTERVAL) {
+        return;
+    }
+    dip_switch_timer = timer_read();
+
+    uint32_t dip_switch_mask = dip_switch_read_mask(read_raw);
+    uint32_t changed         = dip_switch_mask ^ last_dip_switch_mask;
+    if (!changed && !forced) {
+        return;
+    }
+
     for (uint8_t i = 0; i < NUMBER_OF_DIP_SWITCHES; i++) {
-#ifdef DIP_SWITCH_PINS
-        dip_switch_state[i] = !readPin(dip_switch_pad[i]);
-#endif
-#ifdef DIP_SWITCH_MATRIX_GRID
-        dip_switch_state[i] = peek_matrix(dip_switch_pad[i].row, dip_switch_pad[i].col, read_raw);
-#endif
-        dip_switch_mask |= dip_switch_state[i] << i;
-        if (last_dip_switch_state[i] != dip_switch_state[i] || forced) {
-            has_dip_state_changed = true;
-            dip_switch_update_kb(i, dip_switch_state[i]);
+        if ((changed & ((uint32_t)1 << i)) || forced) {
+            dip_switch_update_kb(i, dip_switch_mask & ((uint32_t)1 << i));
         }
     }
-    if (has_dip_state_changed) {
-        dip_switch_update_mask_kb(dip_switch_mask);
-        memcpy(last_dip_switch_state, dip_switch_state, sizeof(dip_switch_state));
-    }
+    dip_switch_update_mask_kb(dip_switch_mask);
+    last_dip_switch_mask = dip_switch_mask;
 }
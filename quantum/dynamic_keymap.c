@@ -14,6 +14,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include "config.h"
 #include "keymap.h"  // to get keymaps[][][]
 #include "tmk_core/common/eeprom.h"
@@ -30,6 +32,17 @@
 #    define DYNAMIC_KEYMAP_MACRO_COUNT 16
 #endif
 
+// Number of dynamic keymap layers mirrored in RAM, starting from layer 0.
+// Lookups on these layers do not touch the EEPROM, at the cost of
+// MATRIX_ROWS * MATRIX_COLS * 2 bytes of RAM per layer.
+#ifndef DYNAMIC_KEYMAP_CACHE_LAYERS
+#    define DYNAMIC_KEYMAP_CACHE_LAYERS 0
+#endif
+
+#if DYNAMIC_KEYMAP_CACHE_LAYERS > DYNAMIC_KEYMAP_LAYER_COUNT
+#    error DYNAMIC_KEYMAP_CACHE_LAYERS must not be greater than DYNAMIC_KEYMAP_LAYER_COUNT
+#endif
+
 // This is the default EEPROM max address to use for dynamic keymaps.
 // The default is the ATmega32u4 EEPROM max address.
 // Explicitly override it if the keyboard uses a microcontroller with
@@ -81,6 +94,14 @@
 #    define DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE (DYNAMIC_KEYMAP_EEPROM_MAX_ADDR - DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + 1)
 #endif
 
+// Drops whatever was worked out from the old keymap
+static void dynamic_keymap_changed(void) {
+    layer_resolve_cache_clear();
+#if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_LAYER_COLORS)
+    rgb_matrix_layer_colors_refresh();
+#endif
+}
+
 uint8_t dynamic_keymap_get_layer_count(void) { return DYNAMIC_KEYMAP_LAYER_COUNT; }
 
 void *dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t column) {
@@ -88,60 +109,120 @@ void *dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t c
     return ((void *)DYNAMIC_KEYMAP_EEPROM_ADDR) + (layer * MATRIX_ROWS * MATRIX_COLS * 2) + (row * MATRIX_COLS * 2) + (column * 2);
 }
 
-uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column) {
-    void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
+static uint16_t dynamic_keymap_read_keycode(uint8_t layer, uint8_t row, uint8_t column) {
+    void *  address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
+    uint8_t data[2];
+    eeprom_read_block(data, address, sizeof(data));
     // Big endian, so we can read/write EEPROM directly from host if we want
-    uint16_t keycode = eeprom_read_byte(address) << 8;
-    keycode |= eeprom_read_byte(address + 1);
-    return keycode;
+    return (data[0] << 8) | data[1];
+}
+
+// Clamps a buffer access at offset to the size bytes available, returns how many bytes of it are in range
+static uint16_t dynamic_keymap_buffer_length(uint16_t offset, uint16_t size, uint16_t available) {
+    if (offset >= available) {
+        return 0;
+    }
+    return size < available - offset ? size : available - offset;
+}
+
+#if DYNAMIC_KEYMAP_CACHE_LAYERS > 0
+// Loaded from EEPROM on the first lookup, then kept in sync by every write below
+static uint16_t dynamic_keymap_cache[DYNAMIC_KEYMAP_CACHE_LAYERS][MATRIX_ROWS][MATRIX_COLS];
+static bool     dynamic_keymap_cache_valid = false;
+
+static void dynamic_keymap_cache_load(void) {
+    // One block read per row, then swapped from the big endian EEPROM layout
+    uint8_t data[MATRIX_COLS * 2];
+    for (uint8_t layer = 0; layer < DYNAMIC_KEYMAP_CACHE_LAYERS; layer++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            eeprom_read_block(data, dynamic_keymap_key_to_eeprom_address(layer, row, 0), sizeof(data));
+            for (uint8_t column = 0; column < MATRIX_COLS; column++) {
+                dynamic_keymap_cache[layer][row][column] = (data[column * 2] << 8) | data[column * 2 + 1];
+            }
+        }
+    }
+    dynamic_keymap_cache_valid = true;
+}
+
+// Mirrors one byte written to the EEPROM keymap buffer, offset as in dynamic_keymap_set_buffer()
+static void dynamic_keymap_cache_update_byte(uint16_t offset, uint8_t data) {
+    if (!dynamic_keymap_cache_valid || offset >= sizeof(dynamic_keymap_cache)) {
+        return;
+    }
+    uint16_t *keycode = &dynamic_keymap_cache[0][0][0] + (offset / 2);
+    if (offset & 1) {
+        *keycode = (*keycode & 0xFF00) | data;
+    } else {
+        *keycode = (*keycode & 0x00FF) | (data << 8);
+    }
+}
+#endif
+
+uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column) {
+#if DYNAMIC_KEYMAP_CACHE_LAYERS > 0
+    if (layer < DYNAMIC_KEYMAP_CACHE_LAYERS && row < MATRIX_ROWS && column < MATRIX_COLS) {
+        if (!dynamic_keymap_cache_valid) {
+            dynamic_keymap_cache_load();
+        }
+        return dynamic_keymap_cache[layer][row][column];
+    }
+#endif
+    return dynamic_keymap_read_keycode(layer, row, column);
 }
 
 void dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t column, uint16_t keycode) {
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
-    eeprom_update_byte(address, (uint8_t)(keycode >> 8));
-    eeprom_update_byte(address + 1, (uint8_t)(keycode & 0xFF));
+    uint8_t data[2] = {(uint8_t)(keycode >> 8), (uint8_t)(keycode & 0xFF)};
+    eeprom_update_block(data, address, sizeof(data));
+    dynamic_keymap_changed();
+#if DYNAMIC_KEYMAP_CACHE_LAYERS > 0
+    if (dynamic_keymap_cache_valid && layer < DYNAMIC_KEYMAP_CACHE_LAYERS && row < MATRIX_ROWS && column < MATRIX_COLS) {
+        dynamic_keymap_cache[layer][row][column] = keycode;
+    }
+#endif
 }
 
 void dynamic_keymap_reset(void) {
     // Reset the keymaps in EEPROM to what is in flash.
     // All keyboards using dynamic keymaps should define a layout
     // for the same number of layers as DYNAMIC_KEYMAP_LAYER_COUNT.
+    // Each layer goes out as a single block update.
+    uint8_t data[MATRIX_ROWS * MATRIX_COLS * 2];
     for (int layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; layer++) {
+        uint8_t *target = data;
         for (int row = 0; row < MATRIX_ROWS; row++) {
             for (int column = 0; column < MATRIX_COLS; column++) {
-                dynamic_keymap_set_keycode(layer, row, column, pgm_read_word(&keymaps[layer][row][column]));
+                uint16_t keycode = keymap_flash_keycode(layer, row, column);
+                *target++        = (uint8_t)(keycode >> 8);
+                *target++        = (uint8_t)(keycode & 0xFF);
             }
         }
+        eeprom_update_block(data, dynamic_keymap_key_to_eeprom_address(layer, 0, 0), sizeof(data));
     }
+#if DYNAMIC_KEYMAP_CACHE_LAYERS > 0
+    dynamic_keymap_cache_valid = false;
+#endif
+    dynamic_keymap_changed();
 }
 
 void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
     uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   source                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *target                     = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
-            *target = eeprom_read_byte(source);
-        } else {
-            *target = 0x00;
-        }
-        source++;
-        target++;
-    }
+    uint16_t length                     = dynamic_keymap_buffer_length(offset, size, dynamic_keymap_eeprom_size);
+    eeprom_read_block(data, (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset), length);
+    memset(data + length, 0x00, size - length);
 }
 
 void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
     uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   target                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *source                     = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
-            eeprom_update_byte(target, *source);
-        }
-        source++;
-        target++;
+    uint16_t length                     = dynamic_keymap_buffer_length(offset, size, dynamic_keymap_eeprom_size);
+    eeprom_update_block(data, (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset), length);
+#if DYNAMIC_KEYMAP_CACHE_LAYERS > 0
+    for (uint16_t i = 0; i < length; i++) {
+        dynamic_keymap_cache_update_byte(offset + i, data[i]);
     }
+#endif
+    dynamic_keymap_changed();
 }
 
 // This overrides the one in quantum/keymap_common.c
@@ -158,38 +239,58 @@ uint8_t dynamic_keymap_macro_get_count(void) { return DYNAMIC_KEYMAP_MACRO_COUNT
 uint16_t dynamic_keymap_macro_get_buffer_size(void) { return DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE; }
 
 void dynamic_keymap_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   source = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
-    uint8_t *target = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            *target = eeprom_read_byte(source);
-        } else {
-            *target = 0x00;
+    uint16_t length = dynamic_keymap_buffer_length(offset, size, DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+    eeprom_read_block(data, (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset), length);
+    memset(data + length, 0x00, size - length);
+}
+
+// Start of each macro, relative to DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR, followed by the end
+// of the last one found. Rebuilt on the first send after the buffer changed.
+static uint16_t dynamic_keymap_macro_offsets[DYNAMIC_KEYMAP_MACRO_COUNT + 1];
+static uint8_t  dynamic_keymap_macro_found       = 0;
+static bool     dynamic_keymap_macro_index_valid = false;
+
+static void dynamic_keymap_macro_index_build(void) {
+    dynamic_keymap_macro_found       = 0;
+    dynamic_keymap_macro_index_valid = true;
+    dynamic_keymap_macro_offsets[0]  = 0;
+
+    // Check the last byte of the buffer.
+    // If it's not zero, then we are in the middle
+    // of buffer writing, possibly an aborted buffer
+    // write. So no macro is sent until it is written again.
+    if (eeprom_read_byte((void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - 1)) != 0) {
+        return;
+    }
+
+    // Find the null terminators in blocks. If there are not
+    // DYNAMIC_KEYMAP_MACRO_COUNT of them, the macros past the
+    // last one are garbage and are not sent.
+    uint8_t data[32];
+    for (uint16_t offset = 0; offset < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE && dynamic_keymap_macro_found < DYNAMIC_KEYMAP_MACRO_COUNT; offset += sizeof(data)) {
+        uint16_t length = dynamic_keymap_buffer_length(offset, sizeof(data), DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+        eeprom_read_block(data, (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset), length);
+        for (uint16_t i = 0; i < length && dynamic_keymap_macro_found < DYNAMIC_KEYMAP_MACRO_COUNT; i++) {
+            if (data[i] == 0) {
+                dynamic_keymap_macro_offsets[++dynamic_keymap_macro_found] = offset + i + 1;
+            }
         }
-        source++;
-        target++;
     }
 }
 
 void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   target = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
-    uint8_t *source = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            eeprom_update_byte(target, *source);
-        }
-        source++;
-        target++;
-    }
+    uint16_t length = dynamic_keymap_buffer_length(offset, size, DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+    eeprom_update_block(data, (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset), length);
+    dynamic_keymap_macro_index_valid = false;
 }
 
 void dynamic_keymap_macro_reset(void) {
-    void *p   = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
-    while (p != end) {
-        eeprom_update_byte(p, 0);
-        ++p;
+    // Cleared in chunks, so the zeroes do not need a buffer as large as the macro space
+    uint8_t zero[32] = {0};
+    for (uint16_t offset = 0; offset < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE; offset += sizeof(zero)) {
+        eeprom_update_block(zero, (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset), dynamic_keymap_buffer_length(offset, sizeof(zero), DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE));
     }
+    dynamic_keymap_macro_index_valid = false;
 }
 
 void dynamic_keymap_macro_send(uint8_t id) {
@@ -197,37 +298,25 @@ void dynamic_keymap_macro_send(uint8_t id) {
         return;
     }
 
-    // Check the last byte of the buffer.
-    // If it's not zero, then we are in the middle
-    // of buffer writing, possibly an aborted buffer
-    // write. So do nothing.
-    void *p = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - 1);
-    if (eeprom_read_byte(p) != 0) {
+    if (!dynamic_keymap_macro_index_valid) {
+        dynamic_keymap_macro_index_build();
+    }
+    if (id >= dynamic_keymap_macro_found) {
         return;
     }
+    void *   p      = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + dynamic_keymap_macro_offsets[id]);
+    uint16_t length = dynamic_keymap_macro_offsets[id + 1] - dynamic_keymap_macro_offsets[id];
 
-    // Skip N null characters
-    // p will then point to the Nth macro
-    p         = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
-    while (id > 0) {
-        // If we are past the end of the buffer, then the buffer
-        // contents are garbage, i.e. there were not DYNAMIC_KEYMAP_MACRO_COUNT
-        // nulls in the buffer.
-        if (p == end) {
-            return;
-        }
-        if (eeprom_read_byte(p) == 0) {
-            --id;
-        }
-        ++p;
+    // Queue the macro to be typed from the main loop, if there is room
+    if (send_string_async_eeprom((const char *)p, length)) {
+        return;
     }
 
     // Send the macro string one or three chars at a time
     // by making temporary 1 or 3 char strings
     char data[4] = {0, 0, 0, 0};
-    // We already checked there was a null at the end of
-    // the buffer, so this cannot go past the end
+    // The index found the null at the end of
+    // this macro, so this cannot go past it
     while (1) {
         data[0] = eeprom_read_byte(p++);
         data[1] = 0;
@@ -46,9 +46,24 @@ static uint8_t encoder_resolutions[] = ENCODER_RESOLUTIONS;
 #    define ENCODER_COUNTER_CLOCKWISE true
 #endif
 
+#if defined(ENCODER_SAMPLE_TIMER) && !defined(PROTOCOL_CHIBIOS)
+#    error "ENCODER_SAMPLE_TIMER is only supported on ChibiOS, call encoder_sample() from your own interrupt with ENCODER_SAMPLE_EXTERNAL"
+#endif
+
+#ifdef ENCODER_SAMPLE_TIMER
+#    include <ch.h>
+#    ifndef ENCODER_SAMPLE_INTERVAL_US
+#        define ENCODER_SAMPLE_INTERVAL_US 500
+#    endif
+#endif
+
 static uint8_t encoder_state[NUMBER_OF_ENCODERS]  = {0};
 static int8_t  encoder_pulses[NUMBER_OF_ENCODERS] = {0};
 
+// Detents counted by encoder_sample(), free running so encoder_read() can take them without a lock
+static volatile uint8_t encoder_detents[NUMBER_OF_ENCODERS]      = {0};
+static uint8_t          encoder_detents_read[NUMBER_OF_ENCODERS] = {0};
+
 #ifdef SPLIT_KEYBOARD
 // right half encoders come over as second set of encoders
 static uint8_t encoder_value[NUMBER_OF_ENCODERS * 2] = {0};
@@ -62,6 +77,29 @@ __attribute__((weak)) void encoder_update_user(int8_t index, bool clockwise) {}
 
 __attribute__((weak)) void encoder_update_kb(int8_t index, bool clockwise) { encoder_update_user(index, clockwise); }
 
+__attribute__((weak)) bool encoder_update_steps_user(int8_t index, bool clockwise, uint8_t steps) { return true; }
+
+__attribute__((weak)) bool encoder_update_steps_kb(int8_t index, bool clockwise, uint8_t steps) { return encoder_update_steps_user(index, clockwise, steps); }
+
+// Hands all detents of a read to the steps callbacks, and one by one to encoder_update_kb unless they took them
+static void encoder_update_steps(int8_t index, bool clockwise, uint8_t steps) {
+    if (!steps || !encoder_update_steps_kb(index, clockwise, steps)) return;
+    while (steps--) {
+        encoder_update_kb(index, clockwise);
+    }
+}
+
+#ifdef ENCODER_SAMPLE_TIMER
+static virtual_timer_t encoder_timer;
+
+static void encoder_timer_cb(void *arg) {
+    encoder_sample();
+    chSysLockFromISR();
+    chVTSetI(&encoder_timer, TIME_US2I(ENCODER_SAMPLE_INTERVAL_US), encoder_timer_cb, NULL);
+    chSysUnlockFromISR();
+}
+#endif
+
 void encoder_init(void) {
 #if defined(SPLIT_KEYBOARD) && defined(ENCODERS_PAD_A_RIGHT) && defined(ENCODERS_PAD_B_RIGHT)
     if (!isLeftHand) {
@@ -90,9 +128,15 @@ void encoder_init(void) {
     thisHand = isLeftHand ? 0 : NUMBER_OF_ENCODERS;
     thatHand = NUMBER_OF_ENCODERS - thisHand;
 #endif
+
+#ifdef ENCODER_SAMPLE_TIMER
+    chVTObjectInit(&encoder_timer);
+    chVTSet(&encoder_timer, TIME_US2I(ENCODER_SAMPLE_INTERVAL_US), encoder_timer_cb, NULL);
+#endif
 }
 
-static uint8_t encoder_update(int8_t index, uint8_t state) {
+// Returns 1 or -1 once the pulses of encoder i add up to a detent
+static int8_t encoder_detent(uint8_t i, uint8_t state) {
     state = state & 0xF;
     if (state & 0x8) {
         state = state ^ 0xF;
@@ -108,44 +152,61 @@ static uint8_t encoder_update(int8_t index, uint8_t state) {
         default: return 0;
     }
 
-    uint8_t i  = index;
-
 #ifdef ENCODER_RESOLUTIONS
     int8_t resolution = encoder_resolutions[i];
 #else
     int8_t resolution = ENCODER_RESOLUTION;
 #endif
 
-#ifdef SPLIT_KEYBOARD
-    index += thisHand;
-#endif  
     encoder_pulses[i] += pulse;
     if (encoder_pulses[i] >= resolution) {
         encoder_pulses[i] -= resolution;
-        encoder_update_kb(index, ENCODER_CLOCKWISE);
+        return 1;
     }
     else if (encoder_pulses[i] <= -resolution) {
         encoder_pulses[i] += resolution;
-        encoder_update_kb(index, ENCODER_COUNTER_CLOCKWISE);
-    } else {
-        return 0;
+        return -1;
     }
-#ifndef ENCODER_DIRECTION_FLIP
-    encoder_value[index] -= pulse;
-#else
-    encoder_value[index] += pulse;
-#endif
-    return 1;
+    return 0;
 }
 
-bool encoder_read(void) {
-    uint8_t changed = 0;
+void encoder_sample(void) {
     for (uint8_t i = 0; i < NUMBER_OF_ENCODERS; i++) {
         encoder_state[i] <<= 1;
         encoder_state[i] |= readPin(encoders_pad_b[i]);
         encoder_state[i] <<= 1;
         encoder_state[i] |= readPin(encoders_pad_a[i]);
-        changed |= encoder_update(i, encoder_state[i]);
+        encoder_detents[i] += encoder_detent(i, encoder_state[i]);
+    }
+}
+
+bool encoder_read(void) {
+#if !defined(ENCODER_SAMPLE_TIMER) && !defined(ENCODER_SAMPLE_EXTERNAL)
+    encoder_sample();
+#endif
+
+    uint8_t changed = 0;
+    for (uint8_t i = 0; i < NUMBER_OF_ENCODERS; i++) {
+        uint8_t count   = encoder_detents[i];
+        int8_t  detents = count - encoder_detents_read[i];
+        if (!detents) continue;
+        encoder_detents_read[i] = count;
+
+        uint8_t index = i;
+#ifdef SPLIT_KEYBOARD
+        index += thisHand;
+#endif
+#ifndef ENCODER_DIRECTION_FLIP
+        encoder_value[index] -= detents;
+#else
+        encoder_value[index] += detents;
+#endif
+        if (detents > 0) {
+            encoder_update_steps(index, ENCODER_CLOCKWISE, detents);
+        } else {
+            encoder_update_steps(index, ENCODER_COUNTER_CLOCKWISE, -detents);
+        }
+        changed = 1;
     }
     return changed != 0;
 }
@@ -153,14 +214,26 @@ bool encoder_read(void) {
 #ifdef SPLIT_KEYBOARD
 void last_encoder_activity_trigger(void);
 
-void encoder_state_raw(uint8_t* slave_state) { memcpy(slave_state, &encoder_value[thisHand], sizeof(uint8_t) * NUMBER_OF_ENCODERS); }
+/* Only the low four bits of each counter are sent, two encoders to a byte. The master takes the
+ * difference to its own count modulo 16, so up to 7 detents either way can pass between two
+ * transactions it gets, where one transaction per scan gets a handful of milliseconds at most. */
+void encoder_state_raw(uint8_t* slave_state) {
+    memset(slave_state, 0, ENCODER_STATE_SIZE(NUMBER_OF_ENCODERS));
+    for (uint8_t i = 0; i < NUMBER_OF_ENCODERS; i++) {
+        slave_state[i / 2] |= (encoder_value[thisHand + i] & 0xF) << ((i & 1) * 4);
+    }
+}
 
 void encoder_update_raw(uint8_t* slave_state) {
     uint8_t changed = 0;
     uint8_t index = thatHand;
     for (uint8_t i = 0; i < NUMBER_OF_ENCODERS; i++, index++) {
-        int8_t  delta = slave_state[i] - encoder_value[index];
+        uint8_t value = (slave_state[i / 2] >> ((i & 1) * 4)) & 0xF;
+        int8_t  delta = (value - encoder_value[index]) & 0xF;
         bool    cw;
+        if (delta > 7) {
+            delta -= 16;
+        }
         changed |= delta;
         if (delta < 0) {
             delta = -delta;
@@ -168,11 +241,8 @@ void encoder_update_raw(uint8_t* slave_state) {
         } else {
             cw = ENCODER_COUNTER_CLOCKWISE;
         }
-        while (delta > 0) {
-            delta--;
-            encoder_update_kb(index, cw);
-        }
-        encoder_value[index] = slave_state[i];
+        encoder_update_steps(index, cw, delta);
+        encoder_value[index] = value;
     }
 
     // Update the last encoder input time -- handled external to encoder_read() when we're running a split
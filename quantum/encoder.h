@@ -21,11 +21,17 @@
 
 void encoder_init(void);
 bool encoder_read(void);
+void encoder_sample(void);
 
 void encoder_update_kb(int8_t index, bool clockwise);
 void encoder_update_user(int8_t index, bool clockwise);
+bool encoder_update_steps_kb(int8_t index, bool clockwise, uint8_t steps);
+bool encoder_update_steps_user(int8_t index, bool clockwise, uint8_t steps);
 
 #ifdef SPLIT_KEYBOARD
+// Bytes encoder_state_raw() fills for the given number of encoders, four bits each
+#    define ENCODER_STATE_SIZE(encoders) (((encoders) + 1) / 2)
+
 void encoder_state_raw(uint8_t* slave_state);
 void encoder_update_raw(uint8_t* slave_state);
 #endif
@@ -18,12 +18,21 @@
 
 extern keymap_config_t keymap_config;
 
-/** \brief keycode_config
- *
- * This function is used to check a specific keycode against the bootmagic config,
- * and will return the corrected keycode, when appropriate.
- */
-uint16_t keycode_config(uint16_t keycode) {
+/* What each keycode keycode_config() may change becomes with the current config. It is rebuilt
+ * whenever keymap_config no longer matches the config it was built for, which catches every way
+ * of changing it: magic keycodes, bootmagic, eeconfig and keyboard code writing the bits directly. */
+#define KEYCODE_CONFIG_BASIC_FIRST KC_ESCAPE
+#define KEYCODE_CONFIG_BASIC_LAST KC_CAPSLOCK
+#define KEYCODE_CONFIG_MODS_FIRST KC_LCTRL
+#define KEYCODE_CONFIG_MODS_LAST KC_RGUI
+
+static uint8_t  remap_basic[KEYCODE_CONFIG_BASIC_LAST - KEYCODE_CONFIG_BASIC_FIRST + 1];
+static uint8_t  remap_mods[KEYCODE_CONFIG_MODS_LAST - KEYCODE_CONFIG_MODS_FIRST + 1];
+static uint16_t remap_config;
+static bool     remap_valid = false;
+
+// Every keycode it changes, and what it changes them to, is a basic keycode
+static uint16_t keycode_config_remap(uint16_t keycode) {
     switch (keycode) {
         case KC_CAPSLOCK:
         case KC_LOCKING_CAPS:
@@ -113,6 +122,38 @@ uint16_t keycode_config(uint16_t keycode) {
     }
 }
 
+static void keycode_config_build(void) {
+    for (uint8_t i = 0; i < sizeof(remap_basic); i++) {
+        remap_basic[i] = keycode_config_remap(KEYCODE_CONFIG_BASIC_FIRST + i);
+    }
+    for (uint8_t i = 0; i < sizeof(remap_mods); i++) {
+        remap_mods[i] = keycode_config_remap(KEYCODE_CONFIG_MODS_FIRST + i);
+    }
+    remap_config = keymap_config.raw;
+    remap_valid  = true;
+}
+
+/** \brief keycode_config
+ *
+ * This function is used to check a specific keycode against the bootmagic config,
+ * and will return the corrected keycode, when appropriate.
+ */
+uint16_t keycode_config(uint16_t keycode) {
+    if (!remap_valid || remap_config != keymap_config.raw) {
+        keycode_config_build();
+    }
+    if (keycode >= KEYCODE_CONFIG_MODS_FIRST && keycode <= KEYCODE_CONFIG_MODS_LAST) {
+        return remap_mods[keycode - KEYCODE_CONFIG_MODS_FIRST];
+    }
+    if (keycode >= KEYCODE_CONFIG_BASIC_FIRST && keycode <= KEYCODE_CONFIG_BASIC_LAST) {
+        return remap_basic[keycode - KEYCODE_CONFIG_BASIC_FIRST];
+    }
+    if (keycode == KC_LOCKING_CAPS) {
+        return keycode_config_remap(keycode);
+    }
+    return keycode;
+}
+
 /** \brief mod_config
  *
  *  This function checks the mods passed to it against the bootmagic config,
@@ -54,3 +54,91 @@ uint16_t keymap_function_id_to_action(uint16_t function_id);
 
 extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
 extern const uint16_t fn_actions[];
+
+#ifdef KEYMAP_COMPRESSED
+/* Written by qmk json2c --compressed instead of keymaps[]. Keys are numbered
+ * row * MATRIX_COLS + col. Bit n of keymap_compressed_bitmap[layer][n / 8] is
+ * set for the keys that are stored, and keymap_compressed_rank[layer][n / 8]
+ * is the index in keymap_compressed_keycodes of the first stored key of that
+ * byte. Keys that are not stored are KC_NO on layer 0, KC_TRNS above it. */
+#    define KEYMAP_COMPRESSED_BYTES ((MATRIX_ROWS * MATRIX_COLS + 7) / 8)
+extern const uint8_t  keymap_compressed_layer_count;
+extern const uint8_t  keymap_compressed_bitmap[][KEYMAP_COMPRESSED_BYTES];
+extern const uint16_t keymap_compressed_rank[][KEYMAP_COMPRESSED_BYTES];
+extern const uint16_t keymap_compressed_keycodes[];
+
+uint16_t keymap_flash_keycode(uint8_t layer, uint8_t row, uint8_t col);
+#else
+// The keycode of a key in the keymap in flash, without dynamic keymap overrides
+#    define keymap_flash_keycode(layer, row, col) pgm_read_word(&keymaps[(layer)][(row)][(col)])
+#endif
+
+#ifdef KEYMAP_ACTIONS
+/* Written by qmk json2c --actions next to the keymap: the action of every key,
+ * worked out by KEYMAP_ACTION() when the keymap is compiled instead of by
+ * action_for_key() on every key event. It is used while keymap_config remaps
+ * no keys. Keys whose action takes more than the keycode to work out are
+ * KEYMAP_ACTION_RUNTIME, and still go through action_for_key()'s switch. */
+#    define KEYMAP_ACTION_RUNTIME 0xFFFF
+extern const uint8_t  keymap_actions_layer_count;
+extern const uint16_t keymap_actions[][MATRIX_ROWS][MATRIX_COLS];
+
+// Each part is a chain of `condition ? action :` for the keycodes of one feature, mirroring action_for_key()
+#    define KEYMAP_ACTION_IN(kc, first, last) ((kc) >= (first) && (kc) <= (last))
+#    define KEYMAP_ACTION_BASIC(kc)                                                                          \
+        KEYMAP_ACTION_IN(kc, KC_A, KC_EXSEL) || KEYMAP_ACTION_IN(kc, KC_LCTRL, KC_RGUI) ? ACTION_KEY(kc) :   \
+        (kc) == KC_TRNS                                                               ? ACTION_TRANSPARENT : \
+        KEYMAP_ACTION_IN(kc, QK_MODS, QK_MODS_MAX)                                    ? ACTION_MODS_KEY((kc) >> 8, (kc)&0xFF) :
+#    ifdef EXTRAKEY_ENABLE
+#        define KEYMAP_ACTION_EXTRAKEY(kc) KEYMAP_ACTION_IN(kc, KC_SYSTEM_POWER, KC_BRIGHTNESS_DOWN) ? KEYMAP_ACTION_RUNTIME :
+#    else
+#        define KEYMAP_ACTION_EXTRAKEY(kc)
+#    endif
+#    ifdef MOUSEKEY_ENABLE
+#        define KEYMAP_ACTION_MOUSEKEY(kc) KEYMAP_ACTION_IN(kc, KC_MS_UP, KC_MS_ACCEL2) ? ACTION_MOUSEKEY(kc) :
+#    else
+#        define KEYMAP_ACTION_MOUSEKEY(kc)
+#    endif
+#    ifndef NO_ACTION_FUNCTION
+#        define KEYMAP_ACTION_FUNCTION(kc) KEYMAP_ACTION_IN(kc, KC_FN0, KC_FN31) || KEYMAP_ACTION_IN(kc, QK_FUNCTION, QK_FUNCTION_MAX) ? KEYMAP_ACTION_RUNTIME :
+#    else
+#        define KEYMAP_ACTION_FUNCTION(kc)
+#    endif
+#    ifndef NO_ACTION_MACRO
+#        define KEYMAP_ACTION_MACRO(kc) KEYMAP_ACTION_IN(kc, QK_MACRO, QK_MACRO_MAX) ? ((kc)&0x800 ? ACTION_MACRO_TAP((kc)&0xFF) : ACTION_MACRO((kc)&0xFF)) :
+#    else
+#        define KEYMAP_ACTION_MACRO(kc)
+#    endif
+#    ifndef NO_ACTION_LAYER
+#        define KEYMAP_ACTION_LAYER(kc)                                                                                                 \
+            KEYMAP_ACTION_IN(kc, QK_LAYER_TAP, QK_LAYER_TAP_MAX)               ? ACTION_LAYER_TAP_KEY(((kc) >> 0x8) & 0xF, (kc)&0xFF) : \
+            KEYMAP_ACTION_IN(kc, QK_TO, QK_TO_MAX)                             ? ACTION_LAYER_SET((kc)&0xF, ((kc) >> 0x4) & 0x3) :      \
+            KEYMAP_ACTION_IN(kc, QK_MOMENTARY, QK_MOMENTARY_MAX)               ? ACTION_LAYER_MOMENTARY((kc)&0xFF) :                    \
+            KEYMAP_ACTION_IN(kc, QK_DEF_LAYER, QK_DEF_LAYER_MAX)               ? ACTION_DEFAULT_LAYER_SET((kc)&0xFF) :                  \
+            KEYMAP_ACTION_IN(kc, QK_TOGGLE_LAYER, QK_TOGGLE_LAYER_MAX)         ? ACTION_LAYER_TOGGLE((kc)&0xFF) :                       \
+            KEYMAP_ACTION_IN(kc, QK_LAYER_TAP_TOGGLE, QK_LAYER_TAP_TOGGLE_MAX) ? ACTION_LAYER_TAP_TOGGLE((kc)&0xFF) :                   \
+            KEYMAP_ACTION_IN(kc, QK_LAYER_MOD, QK_LAYER_MOD_MAX)               ? ACTION_LAYER_MODS(((kc) >> 4) & 0xF, (kc)&0xF) :
+#    else
+#        define KEYMAP_ACTION_LAYER(kc)
+#    endif
+#    ifndef NO_ACTION_ONESHOT
+#        define KEYMAP_ACTION_ONESHOT(kc)                                                                      \
+            KEYMAP_ACTION_IN(kc, QK_ONE_SHOT_LAYER, QK_ONE_SHOT_LAYER_MAX) ? ACTION_LAYER_ONESHOT((kc)&0xFF) : \
+            KEYMAP_ACTION_IN(kc, QK_ONE_SHOT_MOD, QK_ONE_SHOT_MOD_MAX)     ? ACTION_MODS_ONESHOT((kc)&0xFF) :
+#    else
+#        define KEYMAP_ACTION_ONESHOT(kc)
+#    endif
+#    ifndef NO_ACTION_TAPPING
+#        define KEYMAP_ACTION_TAPPING(kc) KEYMAP_ACTION_IN(kc, QK_MOD_TAP, QK_MOD_TAP_MAX) ? ACTION_MODS_TAP_KEY(((kc) >> 0x8) & 0x1F, (kc)&0xFF) :
+#    else
+#        define KEYMAP_ACTION_TAPPING(kc)
+#    endif
+#    ifdef SWAP_HANDS_ENABLE
+#        define KEYMAP_ACTION_SWAP_HANDS(kc) KEYMAP_ACTION_IN(kc, QK_SWAP_HANDS, QK_SWAP_HANDS_MAX) ? ACTION(ACT_SWAP_HANDS, (kc)&0xff) :
+#    else
+#        define KEYMAP_ACTION_SWAP_HANDS(kc)
+#    endif
+
+// The action of a keycode, as a constant expression
+#    define KEYMAP_ACTION(kc) ((uint16_t)(KEYMAP_ACTION_BASIC(kc) KEYMAP_ACTION_EXTRAKEY(kc) KEYMAP_ACTION_MOUSEKEY(kc) KEYMAP_ACTION_FUNCTION(kc) KEYMAP_ACTION_MACRO(kc) KEYMAP_ACTION_LAYER(kc) KEYMAP_ACTION_ONESHOT(kc) KEYMAP_ACTION_TAPPING(kc) KEYMAP_ACTION_SWAP_HANDS(kc) ACTION_NO))
+#endif
@@ -42,6 +42,16 @@ extern keymap_config_t keymap_config;
 
 /* converts key to action */
 action_t action_for_key(uint8_t layer, keypos_t key) {
+#ifdef KEYMAP_ACTIONS
+    // Worked out when the keymap was compiled, which only holds while keycode_config() and mod_config() change nothing
+    if (layer < pgm_read_byte(&keymap_actions_layer_count) && !(keymap_config.raw & ~EECONFIG_KEYMAP_NKRO)) {
+        action_t action = {.code = pgm_read_word(&keymap_actions[layer][key.row][key.col])};
+        if (action.code != KEYMAP_ACTION_RUNTIME) {
+            return action;
+        }
+    }
+#endif
+
     // 16bit keycodes - important
     uint16_t keycode = keymap_key_to_keycode(layer, key);
 
@@ -176,10 +186,32 @@ __attribute__((weak)) const macro_t *action_get_macro(keyrecord_t *record, uint8
 /* Function */
 __attribute__((weak)) void action_function(keyrecord_t *record, uint8_t id, uint8_t opt) {}
 
+#ifdef KEYMAP_COMPRESSED
+static inline uint8_t keymap_popcount8(uint8_t bits) {
+    bits = bits - ((bits >> 1) & 0x55);
+    bits = (bits & 0x33) + ((bits >> 2) & 0x33);
+    return (bits + (bits >> 4)) & 0x0F;
+}
+
+uint16_t keymap_flash_keycode(uint8_t layer, uint8_t row, uint8_t col) {
+    if (layer >= pgm_read_byte(&keymap_compressed_layer_count)) {
+        return KC_TRNS;
+    }
+    uint16_t key  = row * MATRIX_COLS + col;
+    uint8_t  bits = pgm_read_byte(&keymap_compressed_bitmap[layer][key / 8]);
+    uint8_t  bit  = 1 << (key % 8);
+    if (!(bits & bit)) {
+        return layer == 0 ? KC_NO : KC_TRNS;
+    }
+    uint16_t index = pgm_read_word(&keymap_compressed_rank[layer][key / 8]) + keymap_popcount8(bits & (bit - 1));
+    return pgm_read_word(&keymap_compressed_keycodes[index]);
+}
+#endif
+
 // translates key to keycode
 __attribute__((weak)) uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {
     // Read entire word (16bits)
-    return pgm_read_word(&keymaps[(layer)][(key.row)][(key.col)]);
+    return keymap_flash_keycode(layer, key.row, key.col);
 }
 
 // translates function id to action
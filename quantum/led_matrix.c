@@ -37,8 +37,12 @@ led_eeconfig_t led_matrix_eeconfig;
 #    define MIN(a, b) ((a) < (b) ? (a) : (b))
 #endif
 
-#ifndef LED_DISABLE_AFTER_TIMEOUT
-#    define LED_DISABLE_AFTER_TIMEOUT 0
+#if defined(LED_DISABLE_AFTER_TIMEOUT) && !defined(LED_DISABLE_TIMEOUT)
+#    define LED_DISABLE_TIMEOUT (LED_DISABLE_AFTER_TIMEOUT * 60000UL)
+#endif
+
+#ifndef LED_DISABLE_TIMEOUT
+#    define LED_DISABLE_TIMEOUT 0
 #endif
 
 #ifndef LED_DISABLE_WHEN_USB_SUSPENDED
@@ -55,14 +59,30 @@ led_eeconfig_t led_matrix_eeconfig;
 
 bool g_suspend_state = false;
 
-// Global tick at 20 Hz
-uint32_t g_tick = 0;
+// Time at the start of the frame being rendered
+uint32_t g_led_timer;
+
+// Time each LED's key was last hit, clamped so that it never looks recent again after the timer wraps
+uint16_t g_led_hit_time[DRIVER_LED_TOTAL];
 
-// Ticks since this key was last hit.
-uint8_t g_key_hit[DRIVER_LED_TOTAL];
+// internals
+static uint8_t         led_last_enable   = UINT8_MAX;
+static uint8_t         led_last_effect   = UINT8_MAX;
+static effect_params_t led_effect_params = {0, 0};
+static led_task_states led_task_state    = SYNCING;
+#if LED_DISABLE_TIMEOUT > 0
+static uint32_t led_anykey_timer;
+#endif  // LED_DISABLE_TIMEOUT > 0
 
-// Ticks since any key was last hit.
-uint32_t g_any_key_hit = 0;
+// double buffers
+static uint32_t led_timer_buffer;
+
+// Stamps are clamped to this age every LED_HIT_SWEEP_INTERVAL ms, so none of them can wrap around
+#define LED_HIT_SWEEP_INTERVAL 1024
+#define LED_HIT_MAX_AGE (UINT16_MAX - LED_HIT_SWEEP_INTERVAL)
+// Hits are forgotten this long after they happened
+#define LED_HIT_FORGET_AGE 12750
+static uint16_t last_hit_sweep;
 
 uint32_t eeconfig_read_led_matrix(void) { return eeprom_read_dword(EECONFIG_LED_MATRIX); }
 
@@ -104,8 +124,15 @@ void led_matrix_set_index_value(int index, uint8_t value) { led_matrix_driver.se
 
 void led_matrix_set_index_value_all(uint8_t value) { led_matrix_driver.set_value_all(value); }
 
+static void led_matrix_stamp_hits(const uint8_t *led, uint8_t led_count, uint16_t time) {
+    for (uint8_t i = 0; i < led_count; i++) g_led_hit_time[led[i]] = time;
+}
+
 bool process_led_matrix(uint16_t keycode, keyrecord_t *record) {
     if (record->event.pressed) {
+#if LED_DISABLE_TIMEOUT > 0
+        led_anykey_timer = 0;
+#endif  // LED_DISABLE_TIMEOUT > 0
         uint8_t led[8];
         uint8_t led_count = map_row_column_to_led(record->event.key.row, record->event.key.col, led);
         if (led_count > 0) {
@@ -115,15 +142,13 @@ bool process_led_matrix(uint16_t keycode, keyrecord_t *record) {
             g_last_led_hit[0] = led[0];
             g_last_led_count  = MIN(LED_HITS_TO_REMEMBER, g_last_led_count + 1);
         }
-        for (uint8_t i = 0; i < led_count; i++) g_key_hit[led[i]] = 0;
-        g_any_key_hit = 0;
+        led_matrix_stamp_hits(led, led_count, (uint16_t)sync_timer_read32());
     } else {
 #ifdef LED_MATRIX_KEYRELEASES
         uint8_t led[8];
         uint8_t led_count = map_row_column_to_led(record->event.key.row, record->event.key.col, led);
-        for (uint8_t i = 0; i < led_count; i++) g_key_hit[led[i]] = 255;
-
-        g_any_key_hit = 255;
+        // A released key counts as long ago
+        led_matrix_stamp_hits(led, led_count, (uint16_t)sync_timer_read32() - LED_HIT_MAX_AGE);
 #endif
     }
     return true;
@@ -134,54 +159,151 @@ void led_matrix_set_suspend_state(bool state) { g_suspend_state = state; }
 // All LEDs off
 void led_matrix_all_off(void) { led_matrix_set_index_value_all(0); }
 
-// Uniform brightness
-void led_matrix_uniform_brightness(void) { led_matrix_set_index_value_all(LED_MATRIX_MAXIMUM_BRIGHTNESS / BACKLIGHT_LEVELS * led_matrix_eeconfig.val); }
+static bool led_matrix_none(effect_params_t *params) {
+    if (!params->init) {
+        return false;
+    }
 
-void led_matrix_custom(void) {}
+    led_matrix_all_off();
+    return false;
+}
 
-void led_matrix_task(void) {
-    if (!led_matrix_eeconfig.enable) {
-        led_matrix_all_off();
-        led_matrix_indicators();
-        return;
+// Uniform brightness
+static bool led_matrix_uniform_brightness(effect_params_t *params) {
+    LED_MATRIX_USE_LIMITS(led_min, led_max);
+
+    uint8_t value = LED_MATRIX_MAXIMUM_BRIGHTNESS / BACKLIGHT_LEVELS * led_matrix_eeconfig.val;
+    for (uint8_t i = led_min; i < led_max; i++) {
+        led_matrix_set_index_value(i, value);
     }
+    return led_max < DRIVER_LED_TOTAL;
+}
 
-    g_tick++;
+void led_matrix_custom(void) {}
 
-    if (g_any_key_hit < 0xFFFFFFFF) {
-        g_any_key_hit++;
+static void led_task_timers(void) {
+#if LED_DISABLE_TIMEOUT > 0
+    uint32_t deltaTime = sync_timer_elapsed32(led_timer_buffer);
+#endif  // LED_DISABLE_TIMEOUT > 0
+    led_timer_buffer = sync_timer_read32();
+
+    // Update double buffer timers
+#if LED_DISABLE_TIMEOUT > 0
+    if (led_anykey_timer < UINT32_MAX) {
+        if (UINT32_MAX - deltaTime < led_anykey_timer) {
+            led_anykey_timer = UINT32_MAX;
+        } else {
+            led_anykey_timer += deltaTime;
+        }
     }
-
-    for (int led = 0; led < DRIVER_LED_TOTAL; led++) {
-        if (g_key_hit[led] < 255) {
-            if (g_key_hit[led] == 254) g_last_led_count = MAX(g_last_led_count - 1, 0);
-            g_key_hit[led]++;
+#endif  // LED_DISABLE_TIMEOUT > 0
+
+    // Forget old hits and clamp the per LED stamps, instead of aging every LED on every call
+    uint16_t now = led_timer_buffer;
+    if ((uint16_t)(now - last_hit_sweep) >= LED_HIT_SWEEP_INTERVAL) {
+        last_hit_sweep = now;
+        while (g_last_led_count && (uint16_t)(now - g_led_hit_time[g_last_led_hit[g_last_led_count - 1]]) > LED_HIT_FORGET_AGE) {
+            g_last_led_count--;
+        }
+        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+            if ((uint16_t)(now - g_led_hit_time[i]) > LED_HIT_MAX_AGE) {
+                g_led_hit_time[i] = now - LED_HIT_MAX_AGE;
+            }
         }
     }
+}
 
-    // Ideally we would also stop sending zeros to the LED driver PWM buffers
-    // while suspended and just do a software shutdown. This is a cheap hack for now.
-    bool    suspend_backlight = ((g_suspend_state && LED_DISABLE_WHEN_USB_SUSPENDED) || (LED_DISABLE_AFTER_TIMEOUT > 0 && g_any_key_hit > LED_DISABLE_AFTER_TIMEOUT * 60 * 20));
-    uint8_t effect            = suspend_backlight ? 0 : led_matrix_eeconfig.mode;
+static void led_task_sync(void) {
+    // next task
+    if (sync_timer_elapsed32(g_led_timer) >= LED_MATRIX_LED_FLUSH_LIMIT) led_task_state = STARTING;
+}
+
+static void led_task_start(void) {
+    // reset iter
+    led_effect_params.iter = 0;
+
+    // update double buffers
+    g_led_timer = led_timer_buffer;
+
+    // next task
+    led_task_state = RENDERING;
+}
+
+static void led_task_render(uint8_t effect) {
+    bool rendering         = false;
+    led_effect_params.init = (effect != led_last_effect) || (led_matrix_eeconfig.enable != led_last_enable);
 
-    // this gets ticked at 20 Hz.
     // each effect can opt to do calculations
     // and/or request PWM buffer updates.
     switch (effect) {
+        case 0:
+            rendering = led_matrix_none(&led_effect_params);
+            break;
         case LED_MATRIX_UNIFORM_BRIGHTNESS:
-            led_matrix_uniform_brightness();
+            rendering = led_matrix_uniform_brightness(&led_effect_params);
             break;
         default:
             led_matrix_custom();
             break;
     }
 
-    if (!suspend_backlight) {
-        led_matrix_indicators();
+    led_effect_params.iter++;
+
+    // next task
+    if (!rendering) {
+        led_task_state = FLUSHING;
+        if (!led_effect_params.init && effect == 0) {
+            // We only need to flush once if the LEDs are off
+            led_task_state = SYNCING;
+        }
     }
+}
+
+static void led_task_flush(uint8_t effect) {
+    // update last trackers after the first full render so we can init over several frames
+    led_last_effect = effect;
+    led_last_enable = led_matrix_eeconfig.enable;
 
     // Tell the LED driver to update its state
-    led_matrix_driver.flush();
+    led_matrix_update_pwm_buffers();
+
+    // next task
+    led_task_state = SYNCING;
+}
+
+void led_matrix_task(void) {
+    led_task_timers();
+
+    // Ideally we would also stop sending zeros to the LED driver PWM buffers
+    // while suspended and just do a software shutdown. This is a cheap hack for now.
+    bool suspend_backlight =
+#if LED_DISABLE_WHEN_USB_SUSPENDED == true
+        g_suspend_state ||
+#endif  // LED_DISABLE_WHEN_USB_SUSPENDED == true
+#if LED_DISABLE_TIMEOUT > 0
+        (led_anykey_timer > (uint32_t)LED_DISABLE_TIMEOUT) ||
+#endif  // LED_DISABLE_TIMEOUT > 0
+        false;
+
+    uint8_t effect = suspend_backlight || !led_matrix_eeconfig.enable ? 0 : led_matrix_eeconfig.mode;
+
+    switch (led_task_state) {
+        case STARTING:
+            led_task_start();
+            break;
+        case RENDERING:
+            led_task_render(effect);
+            if (effect) {
+                led_matrix_indicators();
+            }
+            break;
+        case FLUSHING:
+            led_task_flush(effect);
+            break;
+        case SYNCING:
+            led_task_sync();
+            break;
+    }
 }
 
 void led_matrix_indicators(void) {
@@ -217,9 +339,11 @@ void led_matrix_init(void) {
     wait_ms(500);
 
     // clear the key hits
+    uint16_t now = sync_timer_read32();
     for (int led = 0; led < DRIVER_LED_TOTAL; led++) {
-        g_key_hit[led] = 255;
+        g_led_hit_time[led] = now - LED_HIT_MAX_AGE;
     }
+    last_hit_sweep = now;
 
     if (!eeconfig_is_enabled()) {
         dprintf("led_matrix_init_drivers eeconfig is not enabled.\n");
@@ -272,7 +396,7 @@ static uint8_t decrement(uint8_t value, uint8_t step, uint8_t min, uint8_t max)
 //     }
 // }
 
-uint32_t led_matrix_get_tick(void) { return g_tick; }
+uint32_t led_matrix_get_tick(void) { return g_led_timer; }
 
 void led_matrix_toggle(void) {
     led_matrix_eeconfig.enable ^= 1;
@@ -25,6 +25,25 @@
 #    error You must define BACKLIGHT_ENABLE with LED_MATRIX_ENABLE
 #endif
 
+#ifndef LED_MATRIX_LED_FLUSH_LIMIT
+#    define LED_MATRIX_LED_FLUSH_LIMIT 16
+#endif
+
+#ifndef LED_MATRIX_LED_PROCESS_LIMIT
+#    define LED_MATRIX_LED_PROCESS_LIMIT (DRIVER_LED_TOTAL + 4) / 5
+#endif
+
+#if defined(LED_MATRIX_LED_PROCESS_LIMIT) && LED_MATRIX_LED_PROCESS_LIMIT > 0 && LED_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
+#    define LED_MATRIX_USE_LIMITS(min, max)                        \
+        uint8_t min = LED_MATRIX_LED_PROCESS_LIMIT * params->iter; \
+        uint8_t max = min + LED_MATRIX_LED_PROCESS_LIMIT;          \
+        if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
+#else
+#    define LED_MATRIX_USE_LIMITS(min, max) \
+        uint8_t min = 0;                    \
+        uint8_t max = DRIVER_LED_TOTAL;
+#endif
+
 enum led_matrix_effects {
     LED_MATRIX_UNIFORM_BRIGHTNESS = 1,
     // All new effects go above this line
@@ -56,6 +75,7 @@ void led_matrix_update_pwm_buffers(void);
 
 bool process_led_matrix(uint16_t keycode, keyrecord_t *record);
 
+// Milliseconds at the start of the frame being rendered
 uint32_t led_matrix_get_tick(void);
 
 void    led_matrix_toggle(void);
@@ -92,3 +112,5 @@ extern const led_matrix_driver_t led_matrix_driver;
 extern led_eeconfig_t led_matrix_eeconfig;
 
 extern led_config_t g_led_config;
+
+extern uint32_t g_led_timer;
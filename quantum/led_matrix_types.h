@@ -34,6 +34,13 @@
 #    define LED_HITS_TO_REMEMBER 8
 #endif  // LED_HITS_TO_REMEMBER
 
+typedef struct PACKED {
+    uint8_t iter;
+    bool    init;
+} effect_params_t;
+
+typedef enum led_task_states { STARTING, RENDERING, FLUSHING, SYNCING } led_task_states;
+
 typedef struct PACKED {
     uint8_t x;
     uint8_t y;
@@ -19,6 +19,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util.h"
 #include "matrix.h"
 #include "debounce.h"
+#include "task_profile.h"
+#include "latency_probe.h"
 #include "quantum.h"
 
 #ifdef DIRECT_PINS
@@ -43,6 +45,12 @@ static inline void setPinInputHigh_atomic(pin_t pin) {
     ATOMIC_BLOCK_FORCEON { setPinInputHigh(pin); }
 }
 
+#ifdef MATRIX_IO_DELAY_ADAPTIVE
+static void matrix_unselect_settle(bool key_pressed);
+#else
+static inline void matrix_unselect_settle(bool key_pressed) { matrix_output_unselect_delay(); }
+#endif
+
 // matrix code
 
 #ifdef DIRECT_PINS
@@ -80,9 +88,71 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
 #elif defined(DIODE_DIRECTION)
 #    if (DIODE_DIRECTION == COL2ROW)
 
+#        ifdef MATRIX_SCAN_GENERATED
+// select_row(), unselect_row() and read_cols() with every pin known at compile time, see `qmk generate-matrix-scan`
+#            include MATRIX_SCAN_GENERATED_H
+#        else
 static void select_row(uint8_t row) { setPinOutput_writeLow(row_pins[row]); }
 
 static void unselect_row(uint8_t row) { setPinInputHigh_atomic(row_pins[row]); }
+#        endif
+
+#        if defined(MATRIX_READ_COLS_BY_PORT) && !defined(MATRIX_SCAN_GENERATED)
+// Runs of columns wired to consecutive pads of the same port, built from col_pins[] at init
+typedef struct {
+    uint8_t     port;  // index into col_ports[]
+    uint8_t     pad;   // pad of the first column of the run
+    uint8_t     col;   // first column of the run
+    port_data_t mask;  // one bit per column of the run
+} col_run_t;
+
+static pin_t     col_ports[MATRIX_COLS];
+static uint8_t   col_port_count;
+static col_run_t col_runs[MATRIX_COLS];
+static uint8_t   col_run_count;
+
+static void init_col_runs(void) {
+    col_port_count = 0;
+    col_run_count  = 0;
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        pin_t pin = col_pins[col];
+
+        // Extend the previous run if this pin is the next pad on the same port
+        if (col_run_count > 0) {
+            col_run_t *run = &col_runs[col_run_count - 1];
+            if (samePinPort(col_ports[run->port], pin) && getPinPad(pin) == run->pad + col - run->col) {
+                run->mask = (run->mask << 1) | 1;
+                continue;
+            }
+        }
+
+        uint8_t port = 0;
+        while (port < col_port_count && !samePinPort(col_ports[port], pin)) {
+            port++;
+        }
+        if (port == col_port_count) {
+            col_ports[col_port_count++] = pin;
+        }
+
+        col_runs[col_run_count++] = (col_run_t){.port = port, .pad = getPinPad(pin), .col = col, .mask = 1};
+    }
+}
+
+static matrix_row_t read_cols(void) {
+    // Sample every port once, then assemble the row from the runs
+    port_data_t port_values[MATRIX_COLS];
+    for (uint8_t port = 0; port < col_port_count; port++) {
+        port_values[port] = ~readPinPort(col_ports[port]);
+    }
+
+    matrix_row_t row_value = 0;
+    for (uint8_t i = 0; i < col_run_count; i++) {
+        const col_run_t *run = &col_runs[i];
+        row_value |= (matrix_row_t)((port_values[run->port] >> run->pad) & run->mask) << run->col;
+    }
+    return row_value;
+}
+#        endif
 
 static void unselect_rows(void) {
     for (uint8_t x = 0; x < MATRIX_ROWS; x++) {
@@ -95,6 +165,9 @@ static void init_pins(void) {
     for (uint8_t x = 0; x < MATRIX_COLS; x++) {
         setPinInputHigh_atomic(col_pins[x]);
     }
+#        if defined(MATRIX_READ_COLS_BY_PORT) && !defined(MATRIX_SCAN_GENERATED)
+    init_col_runs();
+#        endif
 }
 
 static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row) {
@@ -105,6 +178,9 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
     select_row(current_row);
     matrix_output_select_delay();
 
+#        if defined(MATRIX_READ_COLS_BY_PORT) || defined(MATRIX_SCAN_GENERATED)
+    current_row_value = read_cols();
+#        else
     // For each col...
     for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
         // Select the col pin to read (active low)
@@ -113,11 +189,12 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
         // Populate the matrix row with the state of the col pin
         current_row_value |= pin_state ? 0 : (MATRIX_ROW_SHIFTER << col_index);
     }
+#        endif
 
     // Unselect row
     unselect_row(current_row);
     if (current_row + 1 < MATRIX_ROWS) {
-        matrix_output_unselect_delay();  // wait for row signal to go HIGH
+        matrix_unselect_settle(current_row_value != 0);  // wait for row signal to go HIGH
     }
 
     // If the row has changed, store the row and return the changed flag.
@@ -130,9 +207,14 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
 
 #    elif (DIODE_DIRECTION == ROW2COL)
 
+#        ifdef MATRIX_SCAN_GENERATED
+// select_col(), unselect_col() and read_rows() with every pin known at compile time, see `qmk generate-matrix-scan`
+#            include MATRIX_SCAN_GENERATED_H
+#        else
 static void select_col(uint8_t col) { setPinOutput_writeLow(col_pins[col]); }
 
 static void unselect_col(uint8_t col) { setPinInputHigh_atomic(col_pins[col]); }
+#        endif
 
 static void unselect_cols(void) {
     for (uint8_t x = 0; x < MATRIX_COLS; x++) {
@@ -149,10 +231,14 @@ static void init_pins(void) {
 
 static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col) {
     bool matrix_changed = false;
+    bool key_pressed    = false;
 
     // Select col
     select_col(current_col);
     matrix_output_select_delay();
+#        ifdef MATRIX_SCAN_GENERATED
+    uint32_t rows = read_rows();
+#        endif
 
     // For each row...
     for (uint8_t row_index = 0; row_index < MATRIX_ROWS; row_index++) {
@@ -161,9 +247,14 @@ static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
         matrix_row_t current_row_value = last_row_value;
 
         // Check row pin state
+#        ifdef MATRIX_SCAN_GENERATED
+        if (rows & ((uint32_t)1 << row_index)) {
+#        else
         if (readPin(row_pins[row_index]) == 0) {
+#        endif
             // Pin LO, set col bit
             current_row_value |= (MATRIX_ROW_SHIFTER << current_col);
+            key_pressed = true;
         } else {
             // Pin HI, clear col bit
             current_row_value &= ~(MATRIX_ROW_SHIFTER << current_col);
@@ -179,7 +270,7 @@ static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
     // Unselect col
     unselect_col(current_col);
     if (current_col + 1 < MATRIX_COLS) {
-        matrix_output_unselect_delay();  // wait for col signal to go HIGH
+        matrix_unselect_settle(key_pressed);  // wait for col signal to go HIGH
     }
 
     return matrix_changed;
@@ -192,9 +283,265 @@ static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
 #    error DIODE_DIRECTION is not defined!
 #endif
 
+#ifndef DIRECT_PINS
+// True while any input reads low
+static bool matrix_input_active(void) {
+#    if (DIODE_DIRECTION == COL2ROW)
+#        if defined(MATRIX_READ_COLS_BY_PORT) || defined(MATRIX_SCAN_GENERATED)
+    return read_cols() != 0;
+#        else
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        if (!readPin(col_pins[x])) return true;
+    }
+    return false;
+#        endif
+#    elif defined(MATRIX_SCAN_GENERATED)
+    return read_rows() != 0;
+#    else
+    for (uint8_t x = 0; x < MATRIX_ROWS; x++) {
+        if (!readPin(row_pins[x])) return true;
+    }
+    return false;
+#    endif
+}
+#endif
+
+#ifdef MATRIX_IO_DELAY_ADAPTIVE
+#    ifdef DIRECT_PINS
+#        error "MATRIX_IO_DELAY_ADAPTIVE is not supported with DIRECT_PINS"
+#    endif
+#    ifndef MATRIX_IO_DELAY
+#        define MATRIX_IO_DELAY 30
+#    endif
+
+#    ifdef MATRIX_IO_DELAY_CALIBRATE
+// Polls of the inputs matrix_unselect_settle() waits at most, measured at init, 0 to wait up to MATRIX_IO_DELAY instead
+static uint16_t matrix_settle_polls = 0;
+
+/* Times how long each output takes to read back high once unselected, in
+ * polls of that one pin, which is as slow to rise as an input pulled low
+ * through a key on it. Waiting for twice the slowest, in polls of every
+ * input, leaves a wide margin. */
+static void matrix_io_calibrate(void) {
+#        if (DIODE_DIRECTION == COL2ROW)
+    const pin_t *outputs      = row_pins;
+    uint8_t      output_count = MATRIX_ROWS;
+#        else
+    const pin_t *outputs      = col_pins;
+    uint8_t      output_count = MATRIX_COLS;
+#        endif
+    uint16_t slowest = 0;
+
+    for (uint8_t x = 0; x < output_count; x++) {
+        setPinOutput_writeLow(outputs[x]);
+        waitInputPinDelay();
+        setPinInputHigh_atomic(outputs[x]);
+
+        uint16_t polls = 0;
+        while (!readPin(outputs[x])) {
+            if (++polls == UINT16_MAX / 2) {
+                // Never came back up, keep the fixed delay
+                return;
+            }
+        }
+        if (polls > slowest) {
+            slowest = polls;
+        }
+    }
+    matrix_settle_polls = slowest * 2 + 2;
+}
+#    endif
+
+/* Only inputs pulled low through a key on the output just unselected have
+ * to settle, and once every input reads high again they have. The wait is
+ * skipped for outputs without a key down, and otherwise ends as soon as the
+ * inputs are high, MATRIX_IO_DELAY (or the calibrated time) at most. */
+static void matrix_unselect_settle(bool key_pressed) {
+    if (!key_pressed) {
+        return;
+    }
+#    ifdef MATRIX_IO_DELAY_CALIBRATE
+    if (matrix_settle_polls) {
+        for (uint16_t polls = matrix_settle_polls; polls && matrix_input_active(); polls--) {
+        }
+        return;
+    }
+#    endif
+    for (uint16_t us = 0; us < MATRIX_IO_DELAY && matrix_input_active(); us++) {
+        wait_us(1);
+    }
+}
+#endif
+
+#if (defined(MATRIX_IDLE_TIMEOUT) || defined(SUSPEND_STOP_MODE)) && defined(DIRECT_PINS)
+#    error "MATRIX_IDLE_TIMEOUT and SUSPEND_STOP_MODE are not supported with DIRECT_PINS"
+#endif
+
+#ifndef DIRECT_PINS
+// Drives every output at once, so a press on any key pulls one of the inputs low
+static void select_all_outputs(void) {
+#    if (DIODE_DIRECTION == COL2ROW)
+    for (uint8_t x = 0; x < MATRIX_ROWS; x++) {
+        setPinOutput_writeLow(row_pins[x]);
+    }
+#    else
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        setPinOutput_writeLow(col_pins[x]);
+    }
+#    endif
+}
+
+static void unselect_all_outputs(void) {
+#    if (DIODE_DIRECTION == COL2ROW)
+    unselect_rows();
+#    else
+    unselect_cols();
+#    endif
+    matrix_output_unselect_delay();
+}
+#endif
+
+#ifdef MATRIX_IDLE_TIMEOUT
+static bool     matrix_idle = false;
+static uint16_t matrix_last_activity;
+
+__attribute__((weak)) void matrix_idle_sleep_user(void) {}
+
+__attribute__((weak)) void matrix_idle_sleep_kb(void) { matrix_idle_sleep_user(); }
+
+static void matrix_idle_enter(void) {
+    select_all_outputs();
+    matrix_idle = true;
+}
+
+static void matrix_idle_exit(void) {
+    unselect_all_outputs();
+    matrix_idle          = false;
+    matrix_last_activity = timer_read();
+}
+
+#endif
+
+#ifdef SUSPEND_STOP_MODE
+#    if PAL_USE_CALLBACKS != TRUE
+#        error "SUSPEND_STOP_MODE needs #define PAL_USE_CALLBACKS TRUE in halconf.h"
+#    endif
+
+static bool matrix_powered_down = false;
+
+/* While suspended the MCU is stopped between scans. Every output is driven
+ * and every input raises an EXTI interrupt when a key pulls it low, which
+ * wakes the MCU up again. */
+void matrix_power_down(void) {
+    if (matrix_powered_down) {
+        return;
+    }
+    select_all_outputs();
+#    if (DIODE_DIRECTION == COL2ROW)
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        palEnableLineEvent(col_pins[x], PAL_EVENT_MODE_FALLING_EDGE);
+    }
+#    else
+    for (uint8_t x = 0; x < MATRIX_ROWS; x++) {
+        palEnableLineEvent(row_pins[x], PAL_EVENT_MODE_FALLING_EDGE);
+    }
+#    endif
+    matrix_powered_down = true;
+}
+
+void matrix_power_up(void) {
+    if (!matrix_powered_down) {
+        return;
+    }
+#    if (DIODE_DIRECTION == COL2ROW)
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        palDisableLineEvent(col_pins[x]);
+    }
+#    else
+    for (uint8_t x = 0; x < MATRIX_ROWS; x++) {
+        palDisableLineEvent(row_pins[x]);
+    }
+#    endif
+#    ifdef MATRIX_IDLE_TIMEOUT
+    // The idle check scans with every output still driven
+    if (!matrix_idle) {
+        unselect_all_outputs();
+    }
+#    else
+    unselect_all_outputs();
+#    endif
+    matrix_powered_down = false;
+}
+#endif
+
+/* Whether any key is down, from one read of the inputs with every output
+ * driven. Nothing is debounced, suspend_wakeup_condition() only scans the
+ * matrix once this finds a key. */
+bool matrix_any_key_down(void) {
+#ifdef DIRECT_PINS
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            pin_t pin = direct_pins[row][col];
+            if (pin != NO_PIN && !readPin(pin)) return true;
+        }
+    }
+    return false;
+#else
+#    ifdef SUSPEND_STOP_MODE
+    if (matrix_powered_down) {
+        return matrix_input_active();
+    }
+#    endif
+#    ifdef MATRIX_IDLE_TIMEOUT
+    if (matrix_idle) {
+        return matrix_input_active();
+    }
+#    endif
+    select_all_outputs();
+    matrix_output_select_delay();
+    bool key_down = matrix_input_active();
+    unselect_all_outputs();
+    return key_down;
+#endif
+}
+
+#ifdef MATRIX_SCAN_ADAPTIVE
+#    ifndef MATRIX_SCAN_ACTIVE_INTERVAL
+#        define MATRIX_SCAN_ACTIVE_INTERVAL 0
+#    endif
+#    ifndef MATRIX_SCAN_IDLE_INTERVAL
+#        define MATRIX_SCAN_IDLE_INTERVAL 8
+#    endif
+#    ifndef MATRIX_SCAN_DWELL
+#        define MATRIX_SCAN_DWELL 250
+#    endif
+#    if MATRIX_SCAN_IDLE_INTERVAL > 255 || MATRIX_SCAN_IDLE_INTERVAL < MATRIX_SCAN_ACTIVE_INTERVAL
+#        error "MATRIX_SCAN_IDLE_INTERVAL must be between MATRIX_SCAN_ACTIVE_INTERVAL and 255"
+#    endif
+
+// Milliseconds between scans, doubled every MATRIX_SCAN_DWELL while the matrix is stable
+static uint8_t  matrix_scan_interval = MATRIX_SCAN_ACTIVE_INTERVAL;
+static uint16_t matrix_last_scan;
+static uint16_t matrix_last_step;
+
+static void matrix_scan_interval_update(bool stable) {
+    if (!stable) {
+        matrix_scan_interval = MATRIX_SCAN_ACTIVE_INTERVAL;
+        matrix_last_step     = matrix_last_scan;
+    } else if (matrix_scan_interval < MATRIX_SCAN_IDLE_INTERVAL && TIMER_DIFF_16(matrix_last_scan, matrix_last_step) >= MATRIX_SCAN_DWELL) {
+        uint16_t interval    = matrix_scan_interval ? matrix_scan_interval * 2 : 1;
+        matrix_scan_interval = interval < MATRIX_SCAN_IDLE_INTERVAL ? interval : MATRIX_SCAN_IDLE_INTERVAL;
+        matrix_last_step     = matrix_last_scan;
+    }
+}
+#endif
+
 void matrix_init(void) {
     // initialize key pins
     init_pins();
+#if defined(MATRIX_IO_DELAY_ADAPTIVE) && defined(MATRIX_IO_DELAY_CALIBRATE)
+    matrix_io_calibrate();
+#endif
 
     // initialize matrix state: all keys off
     for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
@@ -204,12 +551,41 @@ void matrix_init(void) {
 
     debounce_init(MATRIX_ROWS);
 
+#ifdef MATRIX_IDLE_TIMEOUT
+    matrix_last_activity = timer_read();
+#endif
+#ifdef MATRIX_SCAN_ADAPTIVE
+    matrix_last_scan = matrix_last_step = timer_read();
+#endif
+
     matrix_init_quantum();
 }
 
 uint8_t matrix_scan(void) {
     bool changed = false;
 
+#ifdef MATRIX_SCAN_ADAPTIVE
+    uint16_t now = timer_read();
+    if (TIMER_DIFF_16(now, matrix_last_scan) < matrix_scan_interval) {
+        matrix_scan_quantum();
+        return 0;
+    }
+    matrix_last_scan = now;
+    matrix_scan_perf_task();
+#endif
+
+#ifdef MATRIX_IDLE_TIMEOUT
+    // Skip the scan until a key pulls one of the inputs low
+    if (matrix_idle) {
+        if (!matrix_input_active()) {
+            matrix_idle_sleep_kb();
+            matrix_scan_quantum();
+            return 0;
+        }
+        matrix_idle_exit();
+    }
+#endif
+
 #if defined(DIRECT_PINS) || (DIODE_DIRECTION == COL2ROW)
     // Set row, read cols
     for (uint8_t current_row = 0; current_row < MATRIX_ROWS; current_row++) {
@@ -222,7 +598,30 @@ uint8_t matrix_scan(void) {
     }
 #endif
 
-    debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
+    latency_probe_raw_matrix(raw_matrix, 0, MATRIX_ROWS, changed);
+    TASK_PROFILE(TASK_PROFILE_DEBOUNCE, debounce(raw_matrix, matrix, MATRIX_ROWS, changed));
+    matrix_update_row_times(0, MATRIX_ROWS);
+
+#ifdef MATRIX_IDLE_TIMEOUT
+    bool active = changed;
+    for (uint8_t row = 0; row < MATRIX_ROWS && !active; row++) {
+        active = raw_matrix[row] || matrix[row];
+    }
+    if (active) {
+        matrix_last_activity = timer_read();
+    } else if (timer_elapsed(matrix_last_activity) > MATRIX_IDLE_TIMEOUT) {
+        matrix_idle_enter();
+    }
+#endif
+
+#ifdef MATRIX_SCAN_ADAPTIVE
+    // Stable means nothing moved and the debounced state has caught up with the raw one
+    bool stable = !changed;
+    for (uint8_t row = 0; row < MATRIX_ROWS && stable; row++) {
+        stable = raw_matrix[row] == matrix[row];
+    }
+    matrix_scan_interval_update(stable);
+#endif
 
     matrix_scan_quantum();
     return (uint8_t)changed;
@@ -32,6 +32,9 @@ typedef uint32_t matrix_row_t;
 
 #define MATRIX_ROW_SHIFTER ((matrix_row_t)1)
 
+/* bytes in a bitmap with one bit per matrix row */
+#define MATRIX_ROW_BITMAP_SIZE ((MATRIX_ROWS + 7) / 8)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -52,6 +55,15 @@ bool matrix_is_modified(void) __attribute__((deprecated));
 bool matrix_is_on(uint8_t row, uint8_t col);
 /* matrix state on row */
 matrix_row_t matrix_get_row(uint8_t row);
+/* time at which the debounced state of a row last changed, in sync_timer time */
+uint16_t matrix_get_row_time(uint8_t row);
+/* record change times of debounced rows, called by matrix_scan() after debouncing */
+void matrix_update_row_times(uint8_t first_row, uint8_t num_rows);
+/* mark a debounced row as changed, for rows matrix_update_row_times() doesn't see */
+void matrix_mark_row_changed(uint8_t row);
+/* sets a bit in rows[MATRIX_ROW_BITMAP_SIZE] for every debounced row that changed since the
+ * last call. returns whether any did */
+bool matrix_take_changed_rows(uint8_t rows[]);
 /* print matrix for debug */
 void matrix_print(void);
 /* delay between changing matrix pin state and reading values */
@@ -63,6 +75,13 @@ void matrix_io_delay(void);
 /* power control */
 void matrix_power_up(void);
 void matrix_power_down(void);
+/* whether any key is down, without a full scan or debouncing. used by suspend to detect a wakeup */
+bool matrix_any_key_down(void);
+
+/* called on every scan while the matrix is idle (MATRIX_IDLE_TIMEOUT), with every
+ * row driven so that any key press pulls its input low. may sleep until a pin interrupt */
+void matrix_idle_sleep_kb(void);
+void matrix_idle_sleep_user(void);
 
 /* executes code for Quantum */
 void matrix_init_quantum(void);
@@ -0,0 +1,228 @@
+/*
+Copyright 2021 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Matrix of analog keys, e.g. Hall effect sensors.
+ *
+ * Each row is an ADC input. With ANALOG_MATRIX_MUX_PINS, each of those is
+ * the output of an analog multiplexer whose select pins pick the column,
+ * without them every row is a single key. Every reading is turned into a
+ * travel from 0 to ANALOG_MATRIX_TRAVEL_MAX using the key's calibration, and
+ * the key is pressed or released from that travel rather than from a pin.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "util.h"
+#include "matrix.h"
+#include "matrix_analog.h"
+#include "debounce.h"
+#include "task_profile.h"
+#include "latency_probe.h"
+#include "analog.h"
+#include "eeprom.h"
+#include "wait.h"
+#include "quantum.h"
+
+#ifdef ANALOG_MATRIX_MUX_PINS
+static const pin_t mux_pins[] = ANALOG_MATRIX_MUX_PINS;
+#    define ANALOG_MATRIX_MUX_COUNT (sizeof(mux_pins) / sizeof(pin_t))
+#elif MATRIX_COLS != 1
+#    error "MATRIX_SCAN_DRIVER = analog needs ANALOG_MATRIX_MUX_PINS unless MATRIX_COLS is 1"
+#endif
+
+// Time for a multiplexer's output to settle after a change of column
+#ifndef ANALOG_MATRIX_SETTLE_US
+#    define ANALOG_MATRIX_SETTLE_US 5
+#endif
+// Assumed distance from rest to bottom until a key has been pressed all the way, negative for sensors whose reading falls
+#ifndef ANALOG_MATRIX_RANGE
+#    define ANALOG_MATRIX_RANGE 300
+#endif
+#ifndef ANALOG_MATRIX_CALIBRATION_SAMPLES
+#    define ANALOG_MATRIX_CALIBRATION_SAMPLES 8
+#endif
+
+#define ANALOG_MATRIX_EEPROM_MAGIC (uint16_t)0xA7A1
+
+static const pin_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+
+/* matrix state(1:on, 0:off) */
+extern matrix_row_t raw_matrix[MATRIX_ROWS];  // raw values
+extern matrix_row_t matrix[MATRIX_ROWS];      // debounced values
+
+static analog_key_calibration_t calibration[MATRIX_ROWS][MATRIX_COLS];
+static uint8_t                  travel[MATRIX_ROWS][MATRIX_COLS];
+// Deepest travel since the key was pressed, or shallowest since it was released
+static uint8_t extreme[MATRIX_ROWS][MATRIX_COLS];
+
+static void select_col(uint8_t col) {
+#ifdef ANALOG_MATRIX_MUX_PINS
+    for (uint8_t i = 0; i < ANALOG_MATRIX_MUX_COUNT; i++) {
+        writePin(mux_pins[i], col & (1 << i));
+    }
+    wait_us(ANALOG_MATRIX_SETTLE_US);
+#endif
+}
+
+static uint8_t to_travel(analog_key_calibration_t *key, uint16_t value) {
+    int32_t range = (int32_t)key->bottom - key->rest;
+    int32_t delta = (int32_t)value - key->rest;
+
+    // Keys that go further than they did so far move their bottom out with them
+    if ((range > 0 && delta > range) || (range < 0 && delta < range)) {
+        key->bottom = value;
+        return ANALOG_MATRIX_TRAVEL_MAX;
+    }
+    if (range == 0 || (range > 0 && delta <= 0) || (range < 0 && delta >= 0)) {
+        return 0;
+    }
+    return delta * ANALOG_MATRIX_TRAVEL_MAX / range;
+}
+
+static bool update_key(bool pressed, uint8_t key_travel, uint8_t actuation, uint8_t *key_extreme) {
+    if (pressed) {
+        if (key_travel > *key_extreme) {
+            *key_extreme = key_travel;
+        }
+        bool release = key_travel + ANALOG_MATRIX_HYSTERESIS < actuation;
+#if ANALOG_MATRIX_RAPID_TRIGGER > 0
+        release |= key_travel + ANALOG_MATRIX_RAPID_TRIGGER <= *key_extreme;
+#endif
+        if (release) {
+            *key_extreme = key_travel;
+            return false;
+        }
+        return true;
+    }
+
+    if (key_travel < *key_extreme) {
+        *key_extreme = key_travel;
+    }
+    bool press = key_travel >= actuation;
+#if ANALOG_MATRIX_RAPID_TRIGGER > 0
+    press &= key_travel >= *key_extreme + ANALOG_MATRIX_RAPID_TRIGGER;
+#endif
+    if (press) {
+        *key_extreme = key_travel;
+        return true;
+    }
+    return false;
+}
+
+/** \brief Takes the current readings as every key's rest position, so no key may be held down
+ */
+void analog_matrix_calibration_reset(void) {
+    uint32_t sums[MATRIX_ROWS][MATRIX_COLS] = {0};
+    for (uint8_t i = 0; i < ANALOG_MATRIX_CALIBRATION_SAMPLES; i++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            select_col(col);
+            for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+                sums[row][col] += analogReadPin(row_pins[row]);
+            }
+        }
+    }
+
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            analog_key_calibration_t *key    = &calibration[row][col];
+            uint16_t                  rest   = sums[row][col] / ANALOG_MATRIX_CALIBRATION_SAMPLES;
+            int32_t                   bottom = (int32_t)rest + ANALOG_MATRIX_RANGE;
+
+            key->rest      = rest;
+            key->bottom    = bottom < 0 ? 0 : bottom > UINT16_MAX ? UINT16_MAX : bottom;
+            key->actuation = ANALOG_MATRIX_ACTUATION;
+        }
+    }
+}
+
+/** \brief Stores the calibration, including what was learned about each key's bottom since
+ *
+ * Does nothing unless ANALOG_MATRIX_EEPROM_ADDR gives it a place in EEPROM.
+ */
+void analog_matrix_calibration_save(void) {
+#ifdef ANALOG_MATRIX_EEPROM_ADDR
+    eeprom_update_block(calibration, (void *)(ANALOG_MATRIX_EEPROM_ADDR + sizeof(uint16_t)), sizeof(calibration));
+    eeprom_update_word((uint16_t *)ANALOG_MATRIX_EEPROM_ADDR, ANALOG_MATRIX_EEPROM_MAGIC);
+#endif
+}
+
+static void calibration_load(void) {
+#ifdef ANALOG_MATRIX_EEPROM_ADDR
+    if (eeprom_read_word((uint16_t *)ANALOG_MATRIX_EEPROM_ADDR) == ANALOG_MATRIX_EEPROM_MAGIC) {
+        eeprom_read_block(calibration, (void *)(ANALOG_MATRIX_EEPROM_ADDR + sizeof(uint16_t)), sizeof(calibration));
+        return;
+    }
+#endif
+    analog_matrix_calibration_reset();
+}
+
+uint8_t analog_matrix_travel(uint8_t row, uint8_t col) { return travel[row][col]; }
+
+uint8_t analog_matrix_get_actuation(uint8_t row, uint8_t col) { return calibration[row][col].actuation; }
+
+void analog_matrix_set_actuation(uint8_t row, uint8_t col, uint8_t actuation) { calibration[row][col].actuation = actuation; }
+
+void matrix_init(void) {
+#ifdef ANALOG_MATRIX_MUX_PINS
+    for (uint8_t i = 0; i < ANALOG_MATRIX_MUX_COUNT; i++) {
+        setPinOutput(mux_pins[i]);
+    }
+#endif
+
+    // initialize matrix state: all keys off
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        raw_matrix[i] = 0;
+        matrix[i]     = 0;
+    }
+
+    calibration_load();
+
+    debounce_init(MATRIX_ROWS);
+
+    matrix_init_quantum();
+}
+
+uint8_t matrix_scan(void) {
+    matrix_row_t curr_matrix[MATRIX_ROWS] = {0};
+
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        select_col(col);
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            analog_key_calibration_t *key        = &calibration[row][col];
+            bool                      pressed    = raw_matrix[row] & (MATRIX_ROW_SHIFTER << col);
+            uint8_t                   key_travel = to_travel(key, analogReadPin(row_pins[row]));
+
+            travel[row][col] = key_travel;
+            if (update_key(pressed, key_travel, key->actuation, &extreme[row][col])) {
+                curr_matrix[row] |= MATRIX_ROW_SHIFTER << col;
+            }
+        }
+    }
+
+    bool changed = memcmp(raw_matrix, curr_matrix, sizeof(curr_matrix)) != 0;
+    if (changed) {
+        memcpy(raw_matrix, curr_matrix, sizeof(curr_matrix));
+    }
+
+    latency_probe_raw_matrix(raw_matrix, 0, MATRIX_ROWS, changed);
+    TASK_PROFILE(TASK_PROFILE_DEBOUNCE, debounce(raw_matrix, matrix, MATRIX_ROWS, changed));
+    matrix_update_row_times(0, MATRIX_ROWS);
+
+    matrix_scan_quantum();
+    return (uint8_t)changed;
+}
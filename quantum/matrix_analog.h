@@ -0,0 +1,47 @@
+/*
+Copyright 2021 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Key travel is reported from 0 (at rest) to ANALOG_MATRIX_TRAVEL_MAX (bottomed out)
+#define ANALOG_MATRIX_TRAVEL_MAX 255
+
+#ifndef ANALOG_MATRIX_ACTUATION
+#    define ANALOG_MATRIX_ACTUATION 128
+#endif
+#ifndef ANALOG_MATRIX_HYSTERESIS
+#    define ANALOG_MATRIX_HYSTERESIS 16
+#endif
+// Travel back up (or down again) that releases (or presses) a key, 0 to turn rapid trigger off
+#ifndef ANALOG_MATRIX_RAPID_TRIGGER
+#    define ANALOG_MATRIX_RAPID_TRIGGER 0
+#endif
+
+typedef struct {
+    uint16_t rest;       // reading with the key up
+    uint16_t bottom;     // reading with the key fully down, above or below rest depending on the sensor
+    uint8_t  actuation;  // travel the key is pressed at
+} analog_key_calibration_t;
+
+uint8_t analog_matrix_travel(uint8_t row, uint8_t col);
+uint8_t analog_matrix_get_actuation(uint8_t row, uint8_t col);
+void    analog_matrix_set_actuation(uint8_t row, uint8_t col, uint8_t actuation);
+void    analog_matrix_calibration_reset(void);
+void    analog_matrix_calibration_save(void);
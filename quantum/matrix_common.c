@@ -1,9 +1,12 @@
+#include <string.h>
+
 #include "quantum.h"
 #include "matrix.h"
 #include "debounce.h"
 #include "wait.h"
 #include "print.h"
 #include "debug.h"
+#include "sync_timer.h"
 
 #ifndef MATRIX_IO_DELAY
 #    define MATRIX_IO_DELAY 30
@@ -13,6 +16,14 @@
 matrix_row_t raw_matrix[MATRIX_ROWS];
 matrix_row_t matrix[MATRIX_ROWS];
 
+/* sync_timer time at which each debounced row last changed */
+uint16_t            matrix_row_time[MATRIX_ROWS];
+static matrix_row_t matrix_row_stamped[MATRIX_ROWS];
+/* debounced rows that changed since keyboard_task() last took them, one bit per row */
+static uint8_t matrix_rows_changed[MATRIX_ROW_BITMAP_SIZE];
+static bool    matrix_any_row_changed = false;
+static bool    matrix_rows_tracked    = false;  // false while matrix_scan() is overridden by one that doesn't call matrix_update_row_times()
+
 #ifdef MATRIX_MASKED
 extern const matrix_row_t matrix_mask[];
 #endif
@@ -45,6 +56,42 @@ inline matrix_row_t matrix_get_row(uint8_t row) {
 #endif
 }
 
+uint16_t matrix_get_row_time(uint8_t row) { return matrix_row_time[row]; }
+
+void matrix_update_row_times(uint8_t first_row, uint8_t num_rows) {
+    uint16_t now = sync_timer_read();
+
+    matrix_rows_tracked = true;
+    for (uint8_t row = first_row; row < first_row + num_rows; row++) {
+        if (matrix[row] != matrix_row_stamped[row]) {
+            matrix_row_stamped[row] = matrix[row];
+            matrix_row_time[row]    = now;
+            matrix_mark_row_changed(row);
+        }
+    }
+}
+
+void matrix_mark_row_changed(uint8_t row) {
+    matrix_rows_changed[row / 8] |= 1 << (row % 8);
+    matrix_any_row_changed = true;
+}
+
+bool matrix_take_changed_rows(uint8_t rows[]) {
+    if (!matrix_rows_tracked) {
+        memset(rows, 0xFF, MATRIX_ROW_BITMAP_SIZE);
+        return true;
+    }
+    if (!matrix_any_row_changed) {
+        return false;
+    }
+    for (uint8_t i = 0; i < MATRIX_ROW_BITMAP_SIZE; i++) {
+        rows[i] |= matrix_rows_changed[i];
+        matrix_rows_changed[i] = 0;
+    }
+    matrix_any_row_changed = false;
+    return true;
+}
+
 // Deprecated.
 bool matrix_is_modified(void) {
     if (debounce_active()) return false;
@@ -113,6 +160,7 @@ __attribute__((weak)) uint8_t matrix_scan(void) {
     bool changed = matrix_scan_custom(raw_matrix);
 
     debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
+    matrix_update_row_times(0, MATRIX_ROWS);
 
     matrix_scan_quantum();
     return changed;
@@ -0,0 +1,234 @@
+/*
+Copyright 2021 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Matrix scanning done by the STM32 timer and DMA instead of the CPU.
+ *
+ * Every timer period one row is strobed: the update event makes the "row"
+ * DMA stream write the next word of row_bsrr[] into the row port's BSRR, and
+ * the compare event half way through the period makes the "col" DMA stream
+ * copy the column port's IDR into the snapshot ring. Both streams run in
+ * circular mode, so the hardware keeps scanning at a fixed rate no matter how
+ * long keyboard_task() takes, and matrix_scan() only has to diff the latest
+ * complete snapshot against the previous one.
+ *
+ * All rows must be on one GPIO port and all columns on one GPIO port.
+ * COL2ROW only.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <hal.h>
+#include "util.h"
+#include "matrix.h"
+#include "debounce.h"
+#include "task_profile.h"
+#include "latency_probe.h"
+#include "quantum.h"
+
+#if defined(DIRECT_PINS) || (DIODE_DIRECTION != COL2ROW)
+#    error "MATRIX_SCAN_DRIVER = dma only supports COL2ROW matrices"
+#endif
+
+#ifndef MATRIX_DMA_PWM_DRIVER
+#    define MATRIX_DMA_PWM_DRIVER PWMD1  // TIMx
+#endif
+#ifndef MATRIX_DMA_PWM_CHANNEL
+#    define MATRIX_DMA_PWM_CHANNEL 1  // Compare channel used to time the column sample
+#endif
+#ifndef MATRIX_DMA_ROW_STREAM
+#    define MATRIX_DMA_ROW_STREAM STM32_DMA2_STREAM5  // DMA Stream for TIMx_UP
+#endif
+#ifndef MATRIX_DMA_ROW_CHANNEL
+#    define MATRIX_DMA_ROW_CHANNEL 6  // DMA Channel for TIMx_UP
+#endif
+#ifndef MATRIX_DMA_COL_STREAM
+#    define MATRIX_DMA_COL_STREAM STM32_DMA2_STREAM1  // DMA Stream for TIMx_CHy
+#endif
+#ifndef MATRIX_DMA_COL_CHANNEL
+#    define MATRIX_DMA_COL_CHANNEL 6  // DMA Channel for TIMx_CHy
+#endif
+#if (STM32_DMA_SUPPORTS_DMAMUX == TRUE) && (!defined(MATRIX_DMA_ROW_DMAMUX_ID) || !defined(MATRIX_DMA_COL_DMAMUX_ID))
+#    error "please consult your MCU's datasheet and specify in your config.h: #define MATRIX_DMA_ROW_DMAMUX_ID STM32_DMAMUX1_TIM?_UP and #define MATRIX_DMA_COL_DMAMUX_ID STM32_DMAMUX1_TIM?_CH?"
+#endif
+
+#ifndef MATRIX_DMA_FREQUENCY
+#    define MATRIX_DMA_FREQUENCY 1000000  // Timer tick rate
+#endif
+#ifndef MATRIX_DMA_ROW_TICKS
+#    define MATRIX_DMA_ROW_TICKS 20  // Ticks each row is selected for
+#endif
+#ifndef MATRIX_DMA_SAMPLE_TICKS
+#    define MATRIX_DMA_SAMPLE_TICKS (MATRIX_DMA_ROW_TICKS / 2)  // Ticks after selecting a row before the columns are sampled
+#endif
+#ifndef MATRIX_DMA_SNAPSHOTS
+#    define MATRIX_DMA_SNAPSHOTS 4
+#endif
+#if MATRIX_DMA_SNAPSHOTS < 3
+#    error "MATRIX_DMA_SNAPSHOTS must be at least 3"
+#endif
+#if MATRIX_DMA_SAMPLE_TICKS < 1 || MATRIX_DMA_SAMPLE_TICKS >= MATRIX_DMA_ROW_TICKS
+#    error "MATRIX_DMA_SAMPLE_TICKS must be between 1 and MATRIX_DMA_ROW_TICKS - 1"
+#endif
+
+#define MATRIX_DMA_SNAPSHOT_WORDS (MATRIX_DMA_SNAPSHOTS * MATRIX_ROWS)
+
+static const pin_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+static const pin_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+
+/* matrix state(1:on, 0:off) */
+extern matrix_row_t raw_matrix[MATRIX_ROWS];  // raw values
+extern matrix_row_t matrix[MATRIX_ROWS];      // debounced values
+
+// Written to the row port's BSRR at the end of each period: the next row low, every other row high
+static uint32_t row_bsrr[MATRIX_ROWS];
+// Column port IDR captured while each row was selected
+static volatile uint32_t col_snapshots[MATRIX_DMA_SNAPSHOTS][MATRIX_ROWS];
+static uint8_t           last_snapshot = MATRIX_DMA_SNAPSHOTS;
+
+#if defined(USE_GPIOV1)
+#    define MATRIX_DMA_BSRR(port) (&(port)->BSRR)
+#else
+#    define MATRIX_DMA_BSRR(port) (&(port)->BSRR.W)
+#endif
+
+static void init_pins(void) {
+    uint32_t rows_mask = 0;
+    for (uint8_t x = 0; x < MATRIX_ROWS; x++) {
+        rows_mask |= 1UL << PAL_PAD(row_pins[x]);
+        setPinOutput(row_pins[x]);
+        writePinHigh(row_pins[x]);
+    }
+    // Row 0 is selected by hand, the first update event then moves on to row 1
+    for (uint8_t x = 0; x < MATRIX_ROWS; x++) {
+        uint32_t row_mask = 1UL << PAL_PAD(row_pins[(x + 1) % MATRIX_ROWS]);
+        row_bsrr[x]       = (rows_mask & ~row_mask) | (row_mask << 16);
+    }
+    writePinLow(row_pins[0]);
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        setPinInputHigh(col_pins[x]);
+    }
+}
+
+static void init_dma(void) {
+    // A snapshot read before the first frame lands must look like "no keys down"
+    for (uint8_t s = 0; s < MATRIX_DMA_SNAPSHOTS; s++) {
+        for (uint8_t x = 0; x < MATRIX_ROWS; x++) {
+            col_snapshots[s][x] = UINT32_MAX;
+        }
+    }
+
+    dmaStreamAlloc(MATRIX_DMA_ROW_STREAM - STM32_DMA_STREAM(0), 10, NULL, NULL);
+    dmaStreamSetPeripheral(MATRIX_DMA_ROW_STREAM, MATRIX_DMA_BSRR(PAL_PORT(row_pins[0])));
+    dmaStreamSetMemory0(MATRIX_DMA_ROW_STREAM, row_bsrr);
+    dmaStreamSetTransactionSize(MATRIX_DMA_ROW_STREAM, MATRIX_ROWS);
+    dmaStreamSetMode(MATRIX_DMA_ROW_STREAM, STM32_DMA_CR_CHSEL(MATRIX_DMA_ROW_CHANNEL) | STM32_DMA_CR_DIR_M2P | STM32_DMA_CR_PSIZE_WORD | STM32_DMA_CR_MSIZE_WORD | STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC | STM32_DMA_CR_PL(2));
+
+    dmaStreamAlloc(MATRIX_DMA_COL_STREAM - STM32_DMA_STREAM(0), 10, NULL, NULL);
+    dmaStreamSetPeripheral(MATRIX_DMA_COL_STREAM, &(PAL_PORT(col_pins[0])->IDR));
+    dmaStreamSetMemory0(MATRIX_DMA_COL_STREAM, col_snapshots);
+    dmaStreamSetTransactionSize(MATRIX_DMA_COL_STREAM, MATRIX_DMA_SNAPSHOT_WORDS);
+    dmaStreamSetMode(MATRIX_DMA_COL_STREAM, STM32_DMA_CR_CHSEL(MATRIX_DMA_COL_CHANNEL) | STM32_DMA_CR_DIR_P2M | STM32_DMA_CR_PSIZE_WORD | STM32_DMA_CR_MSIZE_WORD | STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC | STM32_DMA_CR_PL(2));
+
+#if (STM32_DMA_SUPPORTS_DMAMUX == TRUE)
+    // If the MCU has a DMAMUX we need to assign the correct resource
+    dmaSetRequestSource(MATRIX_DMA_ROW_STREAM, MATRIX_DMA_ROW_DMAMUX_ID);
+    dmaSetRequestSource(MATRIX_DMA_COL_STREAM, MATRIX_DMA_COL_DMAMUX_ID);
+#endif
+
+    // The channel never drives a pin, it only raises the DMA request that samples the columns
+    static const PWMConfig matrix_pwm_config = {
+        .frequency = MATRIX_DMA_FREQUENCY,
+        .period    = MATRIX_DMA_ROW_TICKS,
+        .callback  = NULL,
+        .channels =
+            {
+                [0 ... 3] = {.mode = PWM_OUTPUT_DISABLED, .callback = NULL},
+            },
+        .cr2  = 0,
+        .dier = 0,
+    };
+
+    // Both streams must see exactly one request per period from the very first one, otherwise
+    // the snapshots would be out of step with the rows. So load the compare value (which is
+    // preloaded) with the timer stopped, and only then turn on the DMA requests and the counter.
+    pwmStart(&MATRIX_DMA_PWM_DRIVER, &matrix_pwm_config);
+    MATRIX_DMA_PWM_DRIVER.tim->CR1 &= ~TIM_CR1_CEN;
+    pwmEnableChannel(&MATRIX_DMA_PWM_DRIVER, MATRIX_DMA_PWM_CHANNEL - 1, MATRIX_DMA_SAMPLE_TICKS);
+    MATRIX_DMA_PWM_DRIVER.tim->EGR = TIM_EGR_UG;
+    MATRIX_DMA_PWM_DRIVER.tim->CNT = 0;
+    MATRIX_DMA_PWM_DRIVER.tim->SR  = 0;
+    MATRIX_DMA_PWM_DRIVER.tim->DIER |= TIM_DIER_UDE | (TIM_DIER_CC1DE << (MATRIX_DMA_PWM_CHANNEL - 1));
+
+    dmaStreamEnable(MATRIX_DMA_ROW_STREAM);
+    dmaStreamEnable(MATRIX_DMA_COL_STREAM);
+    MATRIX_DMA_PWM_DRIVER.tim->CR1 |= TIM_CR1_CEN;
+}
+
+// The snapshot before the one the column stream is filling is the newest complete one
+static uint8_t latest_snapshot(void) {
+    size_t  filled  = MATRIX_DMA_SNAPSHOT_WORDS - dmaStreamGetTransactionSize(MATRIX_DMA_COL_STREAM);
+    uint8_t current = (filled % MATRIX_DMA_SNAPSHOT_WORDS) / MATRIX_ROWS;
+    return (current + MATRIX_DMA_SNAPSHOTS - 1) % MATRIX_DMA_SNAPSHOTS;
+}
+
+static matrix_row_t snapshot_to_row(uint32_t idr) {
+    matrix_row_t row = 0;
+    for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
+        if (!(idr & (1UL << PAL_PAD(col_pins[col_index])))) {
+            row |= (MATRIX_ROW_SHIFTER << col_index);
+        }
+    }
+    return row;
+}
+
+void matrix_init(void) {
+    // initialize key pins
+    init_pins();
+
+    // initialize matrix state: all keys off
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        raw_matrix[i] = 0;
+        matrix[i]     = 0;
+    }
+
+    debounce_init(MATRIX_ROWS);
+
+    init_dma();
+
+    matrix_init_quantum();
+}
+
+uint8_t matrix_scan(void) {
+    bool    changed  = false;
+    uint8_t snapshot = latest_snapshot();
+
+    if (snapshot != last_snapshot) {
+        last_snapshot = snapshot;
+        for (uint8_t current_row = 0; current_row < MATRIX_ROWS; current_row++) {
+            matrix_row_t current_matrix = snapshot_to_row(col_snapshots[snapshot][current_row]);
+            changed |= raw_matrix[current_row] != current_matrix;
+            raw_matrix[current_row] = current_matrix;
+        }
+    }
+
+    latency_probe_raw_matrix(raw_matrix, 0, MATRIX_ROWS, changed);
+    TASK_PROFILE(TASK_PROFILE_DEBOUNCE, debounce(raw_matrix, matrix, MATRIX_ROWS, changed));
+    matrix_update_row_times(0, MATRIX_ROWS);
+
+    matrix_scan_quantum();
+    return (uint8_t)changed;
+}
@@ -0,0 +1,182 @@
+/*
+Copyright 2021 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Matrix whose rows are driven by a chain of 74HC595 shift registers and
+ * whose columns are read through a chain of 74HC165 shift registers, both
+ * on the SPI bus.
+ *
+ * The 595s' serial input is on MOSI and their RCLK on
+ * MATRIX_SHIFT_REGISTER_LATCH_PIN, used as the chip select so that the end
+ * of every transfer latches the rows. The 165s' output is on MISO and their
+ * SH/LD on MATRIX_SHIFT_REGISTER_LOAD_PIN. Row r is output r % 8 of the
+ * r / 8th 595 counted from the MCU, column c is input c % 8 (A is 0) of the
+ * c / 8th 165 counted from the MCU. Rows are selected low and the columns
+ * are pulled up, so COL2ROW.
+ *
+ * Each row is a single full-duplex transfer: the columns loaded while one
+ * row is selected are shifted in while the next row's select is shifted out.
+ * Between scans every row is left selected, so that one transfer tells
+ * whether any key is down at all, and the rows are only gone through one by
+ * one when one is.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "util.h"
+#include "matrix.h"
+#include "debounce.h"
+#include "task_profile.h"
+#include "latency_probe.h"
+#include "spi_master.h"
+#include "quantum.h"
+
+#if defined(DIRECT_PINS) || (DIODE_DIRECTION != COL2ROW)
+#    error "MATRIX_SCAN_DRIVER = shift_register only supports COL2ROW matrices"
+#endif
+#if !defined(MATRIX_SHIFT_REGISTER_LATCH_PIN) || !defined(MATRIX_SHIFT_REGISTER_LOAD_PIN)
+#    error "MATRIX_SCAN_DRIVER = shift_register needs MATRIX_SHIFT_REGISTER_LATCH_PIN (74HC595 RCLK) and MATRIX_SHIFT_REGISTER_LOAD_PIN (74HC165 SH/LD)"
+#endif
+
+#ifndef MATRIX_SHIFT_REGISTER_SPI_MODE
+#    define MATRIX_SHIFT_REGISTER_SPI_MODE 0
+#endif
+#ifndef MATRIX_SHIFT_REGISTER_SPI_DIVISOR
+#    define MATRIX_SHIFT_REGISTER_SPI_DIVISOR 8
+#endif
+
+#define ROW_BYTES ((MATRIX_ROWS + 7) / 8)
+#define COL_BYTES ((MATRIX_COLS + 7) / 8)
+// Anything shifted out beyond the 595s falls off the end of the chain, and anything beyond the 165s is ignored
+#define TRANSFER_BYTES (ROW_BYTES > COL_BYTES ? ROW_BYTES : COL_BYTES)
+
+/* matrix state(1:on, 0:off) */
+extern matrix_row_t raw_matrix[MATRIX_ROWS];  // raw values
+extern matrix_row_t matrix[MATRIX_ROWS];      // debounced values
+
+// What is shifted out to select each row, then to select all of them
+static uint8_t row_select[MATRIX_ROWS + 1][TRANSFER_BYTES];
+static uint8_t col_input[TRANSFER_BYTES];
+// No key was down at the last scan
+static bool idle = false;
+
+static void init_row_select(void) {
+    memset(row_select, 0xFF, sizeof(row_select));
+    for (uint8_t select = 0; select <= MATRIX_ROWS; select++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            if (select == row || select == MATRIX_ROWS) {
+                // The last byte shifted out stays in the 595 nearest the MCU
+                row_select[select][TRANSFER_BYTES - 1 - row / 8] &= ~(1 << (row % 8));
+            }
+        }
+    }
+}
+
+// Loads the columns of the rows selected now, then shifts them in while shifting out and latching select
+static bool exchange(const uint8_t *select) {
+    writePinLow(MATRIX_SHIFT_REGISTER_LOAD_PIN);
+    writePinHigh(MATRIX_SHIFT_REGISTER_LOAD_PIN);
+
+    if (!spi_start(MATRIX_SHIFT_REGISTER_LATCH_PIN, false, MATRIX_SHIFT_REGISTER_SPI_MODE, MATRIX_SHIFT_REGISTER_SPI_DIVISOR)) {
+        return false;
+    }
+    spi_status_t status = spi_transceive(select, col_input, TRANSFER_BYTES);
+    spi_stop();
+    return status == SPI_STATUS_SUCCESS;
+}
+
+static matrix_row_t pressed_cols(void) {
+    matrix_row_t cols = 0;
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        if (!(col_input[col / 8] & (1 << (col % 8)))) {
+            cols |= MATRIX_ROW_SHIFTER << col;
+        }
+    }
+    return cols;
+}
+
+static bool scan_rows(matrix_row_t curr_matrix[]) {
+    if (idle) {
+        // Every row is still selected, one transfer tells whether any key went down
+        if (!exchange(row_select[MATRIX_ROWS])) {
+            return false;
+        }
+        if (!pressed_cols()) {
+            return true;
+        }
+    }
+
+    if (!exchange(row_select[0])) {
+        return false;
+    }
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        matrix_output_select_delay();
+        // Ends up selecting every row again for the next quick check
+        if (!exchange(row_select[row + 1])) {
+            return false;
+        }
+        curr_matrix[row] = pressed_cols();
+    }
+    return true;
+}
+
+void matrix_init(void) {
+    setPinOutput(MATRIX_SHIFT_REGISTER_LOAD_PIN);
+    writePinHigh(MATRIX_SHIFT_REGISTER_LOAD_PIN);
+    init_row_select();
+    spi_init();
+    exchange(row_select[MATRIX_ROWS]);
+
+    // initialize matrix state: all keys off
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        raw_matrix[i] = 0;
+        matrix[i]     = 0;
+    }
+
+    debounce_init(MATRIX_ROWS);
+
+    matrix_init_quantum();
+}
+
+uint8_t matrix_scan(void) {
+    matrix_row_t curr_matrix[MATRIX_ROWS] = {0};
+
+    if (!scan_rows(curr_matrix)) {
+        // Keep the keys as they were, and go through every row next time
+        memcpy(curr_matrix, raw_matrix, sizeof(curr_matrix));
+        idle = false;
+    } else {
+        idle = true;
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            if (curr_matrix[row]) {
+                idle = false;
+            }
+        }
+    }
+
+    bool changed = memcmp(raw_matrix, curr_matrix, sizeof(curr_matrix)) != 0;
+    if (changed) {
+        memcpy(raw_matrix, curr_matrix, sizeof(curr_matrix));
+    }
+
+    latency_probe_raw_matrix(raw_matrix, 0, MATRIX_ROWS, changed);
+    TASK_PROFILE(TASK_PROFILE_DEBOUNCE, debounce(raw_matrix, matrix, MATRIX_ROWS, changed));
+    matrix_update_row_times(0, MATRIX_ROWS);
+
+    matrix_scan_quantum();
+    return (uint8_t)changed;
+}
@@ -22,6 +22,9 @@
 #include "print.h"
 #include "debug.h"
 #include "mousekey.h"
+#ifdef MK_SMOOTH
+#    include "progmem.h"
+#endif
 
 inline int8_t times_inv_sqrt2(int8_t x) {
     // 181/256 is pretty close to 1/sqrt(2)
@@ -107,6 +110,86 @@ static uint8_t wheel_unit(void) {
     return (unit > MOUSEKEY_WHEEL_MAX ? MOUSEKEY_WHEEL_MAX : (unit == 0 ? 1 : unit));
 }
 
+#        ifdef MK_SMOOTH
+/*
+ * Smooth movement
+ *
+ * The cursor speed follows mk_smooth_curve from MOUSEKEY_MOVE_DELTA to the maximum speed over
+ * mk_time_to_max intervals. It is kept in 1/256 units, and every task adds the distance covered since
+ * the last one to an accumulator. Whole units go out every MK_SMOOTH_INTERVAL and the fraction carries
+ * over, so slow and diagonal movements don't lose or round away motion.
+ */
+// clang-format off
+#            define MK_SMOOTH_CURVE_4(i) MK_SMOOTH_CURVE(i), MK_SMOOTH_CURVE(i + 1), MK_SMOOTH_CURVE(i + 2), MK_SMOOTH_CURVE(i + 3)
+static const uint8_t PROGMEM mk_smooth_curve[MK_SMOOTH_CURVE_STEPS + 1] = {
+    MK_SMOOTH_CURVE_4(0), MK_SMOOTH_CURVE_4(4), MK_SMOOTH_CURVE_4(8), MK_SMOOTH_CURVE_4(12), MK_SMOOTH_CURVE(16),
+};
+// clang-format on
+
+static uint16_t mk_smooth_start = 0;  // start of the repeated movement
+static uint16_t mk_smooth_last  = 0;  // last time movement was added
+static int16_t  mk_smooth_x     = 0;  // movement still to be sent, in 1/256 units
+static int16_t  mk_smooth_y     = 0;
+
+/* Cursor speed in 1/256 units per mk_interval */
+static uint16_t move_unit_smooth(void) {
+    if (mousekey_accel & ((1 << 0) | (1 << 1) | (1 << 2))) {
+        return (uint16_t)move_unit() << 8;
+    }
+
+    uint16_t min  = MOUSEKEY_MOVE_DELTA << 8;
+    uint16_t max  = (MOUSEKEY_MOVE_DELTA * mk_max_speed > MOUSEKEY_MOVE_MAX ? MOUSEKEY_MOVE_MAX : MOUSEKEY_MOVE_DELTA * mk_max_speed) << 8;
+    uint32_t ramp = (uint32_t)mk_time_to_max * mk_interval;
+    uint16_t time = timer_elapsed(mk_smooth_start);
+    if (max <= min) return min;
+    if (time >= ramp) return max;
+
+    // interpolate between the two nearest points of the curve
+    uint16_t pos   = ((uint32_t)time * MK_SMOOTH_CURVE_STEPS << 8) / ramp;
+    uint8_t  a     = pgm_read_byte(&mk_smooth_curve[pos >> 8]);
+    uint8_t  b     = pgm_read_byte(&mk_smooth_curve[(pos >> 8) + 1]);
+    uint16_t curve = (a << 8) + (b - a) * (pos & 0xFF);
+    return min + ((uint32_t)(max - min) * curve >> 16);
+}
+
+/* Moves as much of an accumulator as fits in a report */
+static int8_t mk_smooth_take(int16_t *acc) {
+    int16_t move = *acc / 256;
+    if (move > MOUSEKEY_MOVE_MAX) move = MOUSEKEY_MOVE_MAX;
+    if (move < -MOUSEKEY_MOVE_MAX) move = -MOUSEKEY_MOVE_MAX;
+    *acc -= move * 256;
+    return move;
+}
+
+/* Adds the distance covered since the last call for the held directions in held, a report of it goes to mouse_report when due */
+static void mousekey_smooth_task(report_mouse_t const *held) {
+    uint16_t now = timer_read();
+    if (!mousekey_repeat) {
+        // the press has already moved the cursor once, wait out the delay
+        if (timer_elapsed(last_timer_c) <= mk_delay * 10) return;
+        mousekey_repeat = 1;
+        mk_smooth_start = mk_smooth_last = now;
+        mk_smooth_x = mk_smooth_y = 0;
+        return;
+    }
+
+    uint32_t step = (uint32_t)move_unit_smooth() * TIMER_DIFF_16(now, mk_smooth_last) / mk_interval;
+    mk_smooth_last = now;
+    if (held->x && held->y) step = step * 181 >> 8;  // diagonal move [1/sqrt(2)]
+    if (step > MOUSEKEY_MOVE_MAX << 8) step = MOUSEKEY_MOVE_MAX << 8;
+
+    // a reversed direction drops the fraction left from the old one
+    if (!held->x || (held->x > 0) != (mk_smooth_x > 0)) mk_smooth_x = 0;
+    if (!held->y || (held->y > 0) != (mk_smooth_y > 0)) mk_smooth_y = 0;
+    if (held->x) mk_smooth_x += held->x > 0 ? (int16_t)step : -(int16_t)step;
+    if (held->y) mk_smooth_y += held->y > 0 ? (int16_t)step : -(int16_t)step;
+
+    if (timer_elapsed(last_timer_c) < MK_SMOOTH_INTERVAL) return;
+    mouse_report.x = mk_smooth_take(&mk_smooth_x);
+    mouse_report.y = mk_smooth_take(&mk_smooth_y);
+}
+#        endif /* #ifdef MK_SMOOTH */
+
 #    else /* #ifndef MK_COMBINED */
 #        ifdef MK_KINETIC_SPEED
 
@@ -216,6 +299,9 @@ void mousekey_task(void) {
     mouse_report.v = 0;
     mouse_report.h = 0;
 
+#    ifdef MK_SMOOTH
+    if (tmpmr.x || tmpmr.y) mousekey_smooth_task(&tmpmr);
+#    else
     if ((tmpmr.x || tmpmr.y) && timer_elapsed(last_timer_c) > (mousekey_repeat ? mk_interval : mk_delay * 10)) {
         if (mousekey_repeat != UINT8_MAX) mousekey_repeat++;
         if (tmpmr.x != 0) mouse_report.x = move_unit() * ((tmpmr.x > 0) ? 1 : -1);
@@ -233,6 +319,7 @@ void mousekey_task(void) {
             }
         }
     }
+#    endif
     if ((tmpmr.v || tmpmr.h) && timer_elapsed(last_timer_w) > (mousekey_wheel_repeat ? mk_wheel_interval : mk_wheel_delay * 10)) {
         if (mousekey_wheel_repeat != UINT8_MAX) mousekey_wheel_repeat++;
         if (tmpmr.v != 0) mouse_report.v = wheel_unit() * ((tmpmr.v > 0) ? 1 : -1);
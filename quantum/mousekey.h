@@ -78,6 +78,26 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #        define MOUSEKEY_WHEEL_TIME_TO_MAX 40
 #    endif
 
+#    ifdef MK_SMOOTH
+#        if defined(MK_COMBINED) || defined(MK_KINETIC_SPEED)
+#            error "MK_SMOOTH extends the accelerated mode, it can't be combined with MK_COMBINED or MK_KINETIC_SPEED"
+#        endif
+/* time between cursor reports, the movement in between is still added up every scan */
+#        ifndef MK_SMOOTH_INTERVAL
+#            ifdef USB_POLLING_INTERVAL_MS
+#                define MK_SMOOTH_INTERVAL USB_POLLING_INTERVAL_MS
+#            else
+#                define MK_SMOOTH_INTERVAL 8
+#            endif
+#        endif
+/* points of the acceleration curve, from 0 at the start to 255 at the maximum speed */
+#        define MK_SMOOTH_CURVE_STEPS 16
+#        ifndef MK_SMOOTH_CURVE
+// quadratic, slow at first for precise movements
+#            define MK_SMOOTH_CURVE(i) ((i) * (i) * 255 / (MK_SMOOTH_CURVE_STEPS * MK_SMOOTH_CURVE_STEPS))
+#        endif
+#    endif
+
 #    ifndef MOUSEKEY_INITIAL_SPEED
 #        define MOUSEKEY_INITIAL_SPEED 100
 #    endif
@@ -22,18 +22,159 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "print.h"
 #include "debug.h"
 #include "pointing_device.h"
+#ifdef POINTING_DEVICE_DRIVER_pmw3360
+#    include "pmw3360.h"
+#endif
+#ifdef SPLIT_POINTING_ENABLE
+#    include "keyboard.h"
+#endif
 
 static report_mouse_t mouseReport = {};
 
+static inline int16_t pointing_motion_add(int16_t total, int16_t delta) {
+    int32_t sum = (int32_t)total + delta;
+    return sum > INT16_MAX / 2 ? INT16_MAX / 2 : sum < -INT16_MAX / 2 ? -INT16_MAX / 2 : sum;
+}
+
+// Hands out as much of the accumulated motion as fits in a report field of up to max and keeps the rest
+static inline int16_t pointing_motion_take(int16_t *total, int16_t max) {
+    int16_t delta = *total > max ? max : *total < -max ? -max : *total;
+    *total -= delta;
+    return delta;
+}
+
+#ifdef SPLIT_POINTING_ENABLE
+// Motion that has not been handed on yet, wider than a report so nothing is lost to clamping
+typedef struct {
+    uint8_t buttons;
+    int16_t x;
+    int16_t y;
+    int16_t v;
+    int16_t h;
+} split_pointing_accumulator_t;
+
+// On the slave: motion waiting for the master to fetch it. On the master: motion received from the slave.
+static split_pointing_accumulator_t split_pointing = {};
+
+static void split_pointing_accumulate(report_mouse_t report) {
+    split_pointing.buttons = report.buttons;
+    split_pointing.x       = pointing_motion_add(split_pointing.x, report.x);
+    split_pointing.y       = pointing_motion_add(split_pointing.y, report.y);
+    split_pointing.v       = pointing_motion_add(split_pointing.v, report.v);
+    split_pointing.h       = pointing_motion_add(split_pointing.h, report.h);
+}
+
+static report_mouse_t split_pointing_take_report(void) {
+    report_mouse_t report = {};
+    report.buttons        = split_pointing.buttons;
+    report.x              = pointing_motion_take(&split_pointing.x, MOUSE_REPORT_XY_MAX);
+    report.y              = pointing_motion_take(&split_pointing.y, MOUSE_REPORT_XY_MAX);
+    report.v              = pointing_motion_take(&split_pointing.v, 127);
+    report.h              = pointing_motion_take(&split_pointing.h, 127);
+    return report;
+}
+
+report_mouse_t pointing_device_get_split_report(void) { return split_pointing_take_report(); }
+
+void pointing_device_set_split_report(report_mouse_t report) { split_pointing_accumulate(report); }
+
+// Adds the slave's motion to the master's own, saturating the report and leaving any excess for the next one
+static void split_pointing_merge(void) {
+    int16_t x = pointing_motion_add(split_pointing.x, mouseReport.x);
+    int16_t y = pointing_motion_add(split_pointing.y, mouseReport.y);
+    int16_t v = pointing_motion_add(split_pointing.v, mouseReport.v);
+    int16_t h = pointing_motion_add(split_pointing.h, mouseReport.h);
+
+    mouseReport.x = pointing_motion_take(&x, MOUSE_REPORT_XY_MAX);
+    mouseReport.y = pointing_motion_take(&y, MOUSE_REPORT_XY_MAX);
+    mouseReport.v = pointing_motion_take(&v, 127);
+    mouseReport.h = pointing_motion_take(&h, 127);
+
+    split_pointing.x = x;
+    split_pointing.y = y;
+    split_pointing.v = v;
+    split_pointing.h = h;
+}
+#endif
+
+#ifdef POINTING_DEVICE_DRIVER_pmw3360
+// Sensor motion that didn't fit in the last report
+static int16_t sensor_x = 0;
+static int16_t sensor_y = 0;
+
+// Only talks to the sensor while it has motion waiting, so an idle trackball costs a pin read
+static void pointing_device_read_sensor(void) {
+    if (pmw3360_motion_pending()) {
+        pmw3360_report_t sensor = pmw3360_read_burst();
+        if (sensor.motion) {
+#    ifdef POINTING_DEVICE_INVERT_X
+            sensor.dx = -sensor.dx;
+#    endif
+#    ifdef POINTING_DEVICE_INVERT_Y
+            sensor.dy = -sensor.dy;
+#    endif
+            sensor_x = pointing_motion_add(sensor_x, sensor.dx);
+            sensor_y = pointing_motion_add(sensor_y, sensor.dy);
+        }
+    }
+
+    int16_t x     = pointing_motion_add(sensor_x, mouseReport.x);
+    int16_t y     = pointing_motion_add(sensor_y, mouseReport.y);
+    mouseReport.x = pointing_motion_take(&x, MOUSE_REPORT_XY_MAX);
+    mouseReport.y = pointing_motion_take(&y, MOUSE_REPORT_XY_MAX);
+    sensor_x      = x;
+    sensor_y      = y;
+}
+#endif
+
+uint16_t pointing_device_get_cpi(void) {
+#ifdef POINTING_DEVICE_DRIVER_pmw3360
+    return pmw3360_get_cpi();
+#else
+    return 0;
+#endif
+}
+
+void pointing_device_set_cpi(uint16_t cpi) {
+#ifdef POINTING_DEVICE_DRIVER_pmw3360
+    pmw3360_set_cpi(cpi);
+#endif
+}
+
+__attribute__((weak)) report_mouse_t pointing_device_task_user(report_mouse_t mouse_report) { return mouse_report; }
+
+__attribute__((weak)) report_mouse_t pointing_device_task_kb(report_mouse_t mouse_report) { return pointing_device_task_user(mouse_report); }
+
 __attribute__((weak)) bool has_mouse_report_changed(report_mouse_t new, report_mouse_t old) { return (new.buttons != old.buttons) || (new.x&& new.x != old.x) || (new.y&& new.y != old.y) || (new.h&& new.h != old.h) || (new.v&& new.v != old.v); }
 
 __attribute__((weak)) void pointing_device_init(void) {
+#ifdef POINTING_DEVICE_DRIVER_pmw3360
+    if (!pmw3360_init()) {
+        dprintf("pointing_device_init: PMW3360 signature mismatch\n");
+    }
+#endif
     // initialize device, if that needs to be done.
 }
 
 __attribute__((weak)) void pointing_device_send(void) {
     static report_mouse_t old_report = {};
 
+#ifdef SPLIT_POINTING_ENABLE
+    if (!is_keyboard_master()) {
+        // The slave keeps its motion until the split transport carries it to the master
+        split_pointing_accumulate(mouseReport);
+        mouseReport.x = 0;
+        mouseReport.y = 0;
+        mouseReport.v = 0;
+        mouseReport.h = 0;
+        return;
+    }
+    // The slave's buttons are held alongside the master's own until it reports them released
+    uint8_t buttons = mouseReport.buttons;
+    split_pointing_merge();
+    mouseReport.buttons |= split_pointing.buttons;
+#endif
+
     // If you need to do other things, like debugging, this is the place to do it.
     if (has_mouse_report_changed(mouseReport, old_report)) {
         host_mouse_send(&mouseReport);
@@ -44,15 +185,22 @@ __attribute__((weak)) void pointing_device_send(void) {
     mouseReport.v = 0;
     mouseReport.h = 0;
     old_report    = mouseReport;
+#ifdef SPLIT_POINTING_ENABLE
+    mouseReport.buttons = buttons;
+#endif
 }
 
 __attribute__((weak)) void pointing_device_task(void) {
     // gather info and put it in:
-    // mouseReport.x = 127 max -127 min
-    // mouseReport.y = 127 max -127 min
+    // mouseReport.x = MOUSE_REPORT_XY_MAX max -MOUSE_REPORT_XY_MAX min (127, or 32767 with MOUSE_EXTENDED_REPORT)
+    // mouseReport.y = MOUSE_REPORT_XY_MAX max -MOUSE_REPORT_XY_MAX min
     // mouseReport.v = 127 max -127 min (scroll vertical)
     // mouseReport.h = 127 max -127 min (scroll horizontal)
     // mouseReport.buttons = 0x1F (decimal 31, binary 00011111) max (bitmask for mouse buttons 1-5, 1 is rightmost, 5 is leftmost) 0x00 min
+#ifdef POINTING_DEVICE_DRIVER_pmw3360
+    pointing_device_read_sensor();
+#endif
+    mouseReport = pointing_device_task_kb(mouseReport);
     // send the report
     pointing_device_send();
 }
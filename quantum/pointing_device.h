@@ -27,3 +27,15 @@ void           pointing_device_send(void);
 report_mouse_t pointing_device_get_report(void);
 void           pointing_device_set_report(report_mouse_t newMouseReport);
 bool           has_mouse_report_changed(report_mouse_t new, report_mouse_t old);
+// Called by the default pointing_device_task() with the sensor's motion, before the report is sent
+report_mouse_t pointing_device_task_kb(report_mouse_t mouse_report);
+report_mouse_t pointing_device_task_user(report_mouse_t mouse_report);
+// The sensor's resolution in counts per inch, 0 without a POINTING_DEVICE_DRIVER
+uint16_t pointing_device_get_cpi(void);
+void     pointing_device_set_cpi(uint16_t cpi);
+
+#ifdef SPLIT_POINTING_ENABLE
+// for the split transport: the slave hands out motion accumulated since the last call, the master adds it to its next report
+report_mouse_t pointing_device_get_split_report(void);
+void           pointing_device_set_split_report(report_mouse_t report);
+#endif
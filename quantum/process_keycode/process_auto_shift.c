@@ -114,10 +114,11 @@ static void autoshift_end(uint16_t keycode, uint16_t now, bool matrix_trigger) {
         }
 
 #    if TAP_CODE_DELAY > 0
-        wait_ms(TAP_CODE_DELAY);
-#    endif
+        unregister_code_deferred(autoshift_lastkey, 0, MOD_BIT(KC_LSFT), TAP_CODE_DELAY);
+#    else
         unregister_code(autoshift_lastkey);
         del_weak_mods(MOD_BIT(KC_LSFT));
+#    endif
     } else {
         // Release after keyrepeat.
         unregister_code(keycode);
@@ -100,6 +100,7 @@ bool process_clicky(uint16_t keycode, keyrecord_t *record) {
         clicky_freq_down();
     }
 
+#    ifndef AUDIO_CLICKY_ON_SWITCH
     if (audio_config.enable && audio_config.clicky_enable) {
         if (record->event.pressed) {                       // Leave this separate so it's easier to add upstroke sound
             if (keycode != AU_OFF && keycode != AU_TOG) {  // DO NOT PLAY if audio will be disabled, and causes issuse on ARM
@@ -107,7 +108,22 @@ bool process_clicky(uint16_t keycode, keyrecord_t *record) {
             }
         }
     }
+#    endif  // !AUDIO_CLICKY_ON_SWITCH
     return true;
 }
 
+#    ifdef AUDIO_CLICKY_ON_SWITCH
+// Called from switch_events() as the switch changes, before the key is processed, which tapping and combos can hold
+// back. The key still has to be looked up so the click doesn't start while audio is being turned off.
+void clicky_switch_event(uint8_t row, uint8_t col, bool pressed) {
+    if (!pressed || !audio_config.enable || !audio_config.clicky_enable || !is_keyboard_master()) return;
+
+    keypos_t key     = {.row = row, .col = col};
+    uint16_t keycode = keymap_key_to_keycode(layer_switch_get_layer(key), key);
+    if (keycode != AU_OFF && keycode != AU_TOG) {
+        clicky_play();
+    }
+}
+#    endif  // AUDIO_CLICKY_ON_SWITCH
+
 #endif  // AUDIO_CLICKY
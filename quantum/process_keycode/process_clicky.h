@@ -2,6 +2,7 @@
 
 void clicky_play(void);
 bool process_clicky(uint16_t keycode, keyrecord_t *record);
+void clicky_switch_event(uint8_t row, uint8_t col, bool pressed);
 
 void clicky_freq_up(void);
 void clicky_freq_down(void);
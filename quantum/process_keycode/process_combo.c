@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include "print.h"
 #include "process_combo.h"
 
@@ -26,18 +27,94 @@ extern int      COMBO_LEN;
 
 __attribute__((weak)) void process_combo_event(uint16_t combo_index, bool pressed) {}
 
+#ifdef COMBO_TERM_PER_COMBO
+__attribute__((weak)) uint16_t get_combo_term(uint16_t index, combo_t *combo) { return COMBO_TERM; }
+#endif
+
+#ifdef COMBO_SHOULD_TRIGGER
+__attribute__((weak)) bool combo_should_trigger(uint16_t combo_index, combo_t *combo, uint16_t keycode, keyrecord_t *record) { return true; }
+#endif
+
 static uint16_t timer               = 0;
 static uint16_t current_combo_index = 0;
 static bool     drop_buffer         = false;
 static bool     is_active           = false;
 static bool     b_combo_enable      = true;  // defaults to enabled
 
+static uint16_t combos_down         = 0;  // combos with at least one key held
+
+#ifndef COMBO_VARIABLE_LEN
+#    define COMBO_LENGTH COMBO_COUNT
+#else
+#    define COMBO_LENGTH COMBO_LEN
+#endif
+
+#ifdef COMBO_INDEX_LENGTH
+/* Every combo key, sorted by keycode, so a key event only visits the
+ * combos that contain it. Built from key_combos[] on the first event,
+ * if it does not fit the combos are scanned one by one instead. */
+typedef struct {
+    uint16_t keycode;
+    uint16_t combo;
+} combo_index_t;
+
+static combo_index_t combo_index[COMBO_INDEX_LENGTH];
+static uint16_t      combo_index_length = 0;
+static enum { COMBO_INDEX_NONE, COMBO_INDEX_READY, COMBO_INDEX_FULL } combo_index_state = COMBO_INDEX_NONE;
+
+static void combo_index_build(void) {
+    combo_index_state  = COMBO_INDEX_READY;
+    combo_index_length = 0;
+    for (uint16_t combo = 0; combo < COMBO_LENGTH; ++combo) {
+        for (const uint16_t *keys = key_combos[combo].keys;; ++keys) {
+            uint16_t keycode = pgm_read_word(keys);
+            if (COMBO_END == keycode) break;
+
+            /* Insert after equal keycodes, so combos keep their order */
+            uint16_t i = combo_index_length;
+            while (i > 0 && combo_index[i - 1].keycode > keycode) --i;
+            if (i > 0 && combo_index[i - 1].keycode == keycode && combo_index[i - 1].combo == combo) continue;
+            if (combo_index_length == COMBO_INDEX_LENGTH) {
+                combo_index_state = COMBO_INDEX_FULL;
+                return;
+            }
+            memmove(&combo_index[i + 1], &combo_index[i], (combo_index_length - i) * sizeof(combo_index_t));
+            combo_index[i].keycode = keycode;
+            combo_index[i].combo   = combo;
+            ++combo_index_length;
+        }
+    }
+}
+
+/* First index entry with a keycode not below the given one */
+static uint16_t combo_index_find(uint16_t keycode) {
+    uint16_t low = 0, high = combo_index_length;
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        if (combo_index[mid].keycode < keycode) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+#endif
+
 static uint8_t buffer_size = 0;
 #ifdef COMBO_ALLOW_ACTION_KEYS
 static keyrecord_t key_buffer[MAX_COMBO_LENGTH];
 #else
 static uint16_t key_buffer[MAX_COMBO_LENGTH];
 #endif
+static uint16_t buffer_first_keycode = 0;
+
+#ifdef COMBO_TERM_PER_COMBO
+static uint16_t combo_term = COMBO_TERM;  // the longest term of the combos the buffered keys can still become
+#    define CURRENT_COMBO_TERM combo_term
+#else
+#    define CURRENT_COMBO_TERM COMBO_TERM
+#endif
 
 static inline void send_combo(uint16_t action, bool pressed) {
     if (action) {
@@ -81,6 +158,50 @@ static inline void dump_key_buffer(bool emit) {
         combo->state &= ~(1 << key); \
     } while (0)
 
+static uint8_t combo_keys_down(const combo_t *combo) {
+    uint8_t count = 0;
+    for (uint32_t state = combo->state; state; state &= state - 1) {
+        ++count;
+    }
+    return count;
+}
+
+/* Whether the combo can still be completed from the keys in the buffer. It
+ * can't with fewer of its keys down than there are keys in the buffer. */
+static bool combo_can_complete(uint16_t index) {
+    combo_t *combo = &key_combos[index];
+    if (combo_keys_down(combo) < buffer_size) return false;
+#ifdef COMBO_TERM_PER_COMBO
+    uint16_t term = get_combo_term(index, combo);
+    if (term > combo_term) combo_term = term;
+#endif
+    return true;
+}
+
+/* Whether the buffered keys can still become any combo, each of which would
+ * contain the first of them. The buffer is let go of as soon as they can't,
+ * rather than after COMBO_TERM. */
+static bool combo_buffer_can_complete(void) {
+    bool can_complete = false;
+#ifdef COMBO_TERM_PER_COMBO
+    combo_term = 0;
+#endif
+
+#ifdef COMBO_INDEX_LENGTH
+    if (COMBO_INDEX_READY == combo_index_state) {
+        for (uint16_t i = combo_index_find(buffer_first_keycode); i < combo_index_length && combo_index[i].keycode == buffer_first_keycode; ++i) {
+            can_complete |= combo_can_complete(combo_index[i].combo);
+        }
+    } else
+#endif
+    {
+        for (uint16_t index = 0; index < COMBO_LENGTH; ++index) {
+            can_complete |= combo_can_complete(index);
+        }
+    }
+    return can_complete;
+}
+
 static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *record) {
     uint8_t  count = 0;
     uint16_t index = -1;
@@ -94,7 +215,14 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
     /* Continue processing if not a combo key */
     if (-1 == (int8_t)index) return false;
 
+#ifdef COMBO_SHOULD_TRIGGER
+    /* A combo that isn't wanted right now, on this layer for instance, doesn't see the press. Its
+     * release then finds the combo incomplete and goes through. */
+    if (record->event.pressed && !combo_should_trigger(current_combo_index, combo, keycode, record)) return false;
+#endif
+
     bool is_combo_active = is_active;
+    bool was_down        = combo->state;
 
     if (record->event.pressed) {
         KEY_STATE_DOWN(index);
@@ -116,15 +244,20 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
         KEY_STATE_UP(index);
     }
 
+    if (was_down != (bool)combo->state) {
+        if (was_down) {
+            --combos_down;
+        } else {
+            ++combos_down;
+        }
+    }
+
     return is_combo_active;
 }
 
-#define NO_COMBO_KEYS_ARE_DOWN (0 == combo->state)
-
 bool process_combo(uint16_t keycode, keyrecord_t *record) {
-    bool is_combo_key          = false;
-    drop_buffer                = false;
-    bool no_combo_keys_pressed = true;
+    bool is_combo_key = false;
+    drop_buffer       = false;
 
     if (keycode == CMB_ON && record->event.pressed) {
         combo_enable();
@@ -144,15 +277,25 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
     if (!is_combo_enabled()) {
         return true;
     }
-#ifndef COMBO_VARIABLE_LEN
-    for (current_combo_index = 0; current_combo_index < COMBO_COUNT; ++current_combo_index) {
-#else
-    for (current_combo_index = 0; current_combo_index < COMBO_LEN; ++current_combo_index) {
+
+#ifdef COMBO_INDEX_LENGTH
+    if (COMBO_INDEX_NONE == combo_index_state) {
+        combo_index_build();
+    }
+    if (COMBO_INDEX_READY == combo_index_state) {
+        for (uint16_t i = combo_index_find(keycode); i < combo_index_length && combo_index[i].keycode == keycode; ++i) {
+            current_combo_index = combo_index[i].combo;
+            is_combo_key |= process_single_combo(&key_combos[current_combo_index], keycode, record);
+        }
+    } else
 #endif
-        combo_t *combo = &key_combos[current_combo_index];
-        is_combo_key |= process_single_combo(combo, keycode, record);
-        no_combo_keys_pressed = no_combo_keys_pressed && NO_COMBO_KEYS_ARE_DOWN;
+    {
+        for (current_combo_index = 0; current_combo_index < COMBO_LENGTH; ++current_combo_index) {
+            combo_t *combo = &key_combos[current_combo_index];
+            is_combo_key |= process_single_combo(combo, keycode, record);
+        }
     }
+    bool no_combo_keys_pressed = 0 == combos_down;
 
     if (drop_buffer) {
         /* buffer is only dropped when we complete a combo, so we refresh the timer
@@ -173,19 +316,28 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
         timer = timer_read();
 
         if (buffer_size < MAX_COMBO_LENGTH) {
+            if (buffer_size == 0) {
+                buffer_first_keycode = keycode;
+            }
 #ifdef COMBO_ALLOW_ACTION_KEYS
             key_buffer[buffer_size++] = *record;
 #else
             key_buffer[buffer_size++] = keycode;
 #endif
         }
+
+        if (!combo_buffer_can_complete()) {
+            /* Same as running out of COMBO_TERM, just sooner */
+            is_active = false;
+            dump_key_buffer(true);
+        }
     }
 
     return !is_combo_key;
 }
 
 void matrix_scan_combo(void) {
-    if (b_combo_enable && is_active && timer && timer_elapsed(timer) > COMBO_TERM) {
+    if (b_combo_enable && is_active && timer && timer_elapsed(timer) > CURRENT_COMBO_TERM) {
         /* This disables the combo, meaning key events for this
          * combo will be handled by the next processors in the chain
          */
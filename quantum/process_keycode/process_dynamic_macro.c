@@ -50,7 +50,7 @@ __attribute__((weak)) void dynamic_macro_record_end_user(int8_t direction) { dyn
  * @param[out] macro_pointer The new macro buffer iterator.
  * @param[in]  macro_buffer  The macro buffer used to initialize macro_pointer.
  */
-void dynamic_macro_record_start(keyrecord_t **macro_pointer, keyrecord_t *macro_buffer) {
+void dynamic_macro_record_start(dynamic_macro_t **macro_pointer, dynamic_macro_t *macro_buffer) {
     dprintln("dynamic macro recording: started");
 
     dynamic_macro_record_start_user();
@@ -60,6 +60,285 @@ void dynamic_macro_record_start(keyrecord_t **macro_pointer, keyrecord_t *macro_
     *macro_pointer = macro_buffer;
 }
 
+#ifdef DYNAMIC_MACRO_COMPACT
+/* Packed event layout. The bytes of an event are written and read in
+ * the direction of the macro, so the second macro simply has them
+ * mirrored.
+ *
+ *   key word  two bytes, low byte first: bits 0-11 hold the key index
+ *             (row * MATRIX_COLS + col), bit 12 the pressed state,
+ *             bit 13 is set when a tap byte follows and bit 14 when a
+ *             delay follows. Positions outside of the matrix use the
+ *             DYNAMIC_MACRO_KEY_RAW index followed by the row and the
+ *             col bytes.
+ *   tap       tap count in the low nibble, interrupted in bit 7.
+ *   delay     milliseconds since the previous event, 7 bits per byte
+ *             starting with the lowest, bit 7 set on all but the last.
+ */
+#    define DYNAMIC_MACRO_KEY_MASK 0x0FFF
+#    define DYNAMIC_MACRO_KEY_RAW 0x0FFF
+#    define DYNAMIC_MACRO_PRESSED 0x1000
+#    define DYNAMIC_MACRO_TAP 0x2000
+#    define DYNAMIC_MACRO_DELAY 0x4000
+#    define DYNAMIC_MACRO_EVENT_MAX 8
+
+_Static_assert(MATRIX_ROWS * MATRIX_COLS < DYNAMIC_MACRO_KEY_RAW, "Matrix too large for DYNAMIC_MACRO_COMPACT");
+
+#    ifdef DYNAMIC_MACRO_TIMED
+/* Time of the last recorded event, the delays are relative to it. */
+static uint16_t dynamic_macro_last_time;
+
+/* The macro being played back by dynamic_macro_task(), if any. */
+static struct {
+    const uint8_t *pointer;
+    const uint8_t *end;
+    int8_t         direction;
+    uint16_t       timer;
+    layer_state_t  saved_layer_state;
+} dynamic_macro_playback;
+#    endif
+
+/**
+ * Pack a key event.
+ *
+ * @param[out] event  Receives the packed bytes, in the recording order.
+ * @param[in]  record The key event to pack.
+ * @param[in]  first  Whether this is the first event of the macro.
+ * @return The number of bytes used.
+ */
+static uint8_t dynamic_macro_encode(uint8_t *event, keyrecord_t *record, bool first) {
+    uint8_t  length = 2;
+    uint16_t word;
+
+    if (record->event.key.row < MATRIX_ROWS && record->event.key.col < MATRIX_COLS) {
+        word = record->event.key.row * MATRIX_COLS + record->event.key.col;
+    } else {
+        word            = DYNAMIC_MACRO_KEY_RAW;
+        event[length++] = record->event.key.row;
+        event[length++] = record->event.key.col;
+    }
+    if (record->event.pressed) {
+        word |= DYNAMIC_MACRO_PRESSED;
+    }
+#    ifndef NO_ACTION_TAPPING
+    if (record->tap.count || record->tap.interrupted) {
+        word |= DYNAMIC_MACRO_TAP;
+        event[length++] = record->tap.count | (record->tap.interrupted ? 0x80 : 0);
+    }
+#    endif
+#    ifdef DYNAMIC_MACRO_TIMED
+    uint16_t delay = first ? 0 : TIMER_DIFF_16(record->event.time, dynamic_macro_last_time);
+
+    dynamic_macro_last_time = record->event.time;
+    if (delay) {
+        word |= DYNAMIC_MACRO_DELAY;
+        while (delay > 0x7F) {
+            event[length++] = (delay & 0x7F) | 0x80;
+            delay >>= 7;
+        }
+        event[length++] = delay;
+    }
+#    endif
+    event[0] = word & 0xFF;
+    event[1] = word >> 8;
+    return length;
+}
+
+/**
+ * Unpack a key event.
+ *
+ * @param[in]  pointer   The first byte of the event.
+ * @param[in]  direction Either +1 or -1, which way to iterate the buffer.
+ * @param[out] record    Receives the key event.
+ * @param[out] delay     Receives the delay before the event, may be NULL.
+ * @return The first byte of the next event.
+ */
+static const uint8_t *dynamic_macro_decode(const uint8_t *pointer, int8_t direction, keyrecord_t *record, uint16_t *delay) {
+    uint16_t word = *pointer;
+    pointer += direction;
+    word |= *pointer << 8;
+    pointer += direction;
+
+    if ((word & DYNAMIC_MACRO_KEY_MASK) == DYNAMIC_MACRO_KEY_RAW) {
+        record->event.key.row = *pointer;
+        pointer += direction;
+        record->event.key.col = *pointer;
+        pointer += direction;
+    } else {
+        record->event.key.row = (word & DYNAMIC_MACRO_KEY_MASK) / MATRIX_COLS;
+        record->event.key.col = (word & DYNAMIC_MACRO_KEY_MASK) % MATRIX_COLS;
+    }
+    record->event.pressed = word & DYNAMIC_MACRO_PRESSED;
+    record->event.time    = timer_read() | 1;
+#    ifndef NO_ACTION_TAPPING
+    record->tap = (tap_t){0};
+#    endif
+    if (word & DYNAMIC_MACRO_TAP) {
+#    ifndef NO_ACTION_TAPPING
+        record->tap.count       = *pointer & 0x0F;
+        record->tap.interrupted = *pointer & 0x80;
+#    endif
+        pointer += direction;
+    }
+
+    uint16_t value = 0;
+    if (word & DYNAMIC_MACRO_DELAY) {
+        uint8_t shift = 0;
+        uint8_t byte;
+        do {
+            byte = *pointer;
+            pointer += direction;
+            value |= (uint16_t)(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+    }
+    if (delay) {
+        *delay = value;
+    }
+    return pointer;
+}
+
+#    ifdef DYNAMIC_MACRO_TIMED
+/**
+ * Play back the events of a timed macro once their delay has passed.
+ * Called from matrix_scan_quantum().
+ */
+void dynamic_macro_task(void) {
+    while (dynamic_macro_playback.pointer) {
+        int8_t direction = dynamic_macro_playback.direction;
+
+        if (dynamic_macro_playback.pointer == dynamic_macro_playback.end) {
+            dynamic_macro_playback.pointer = NULL;
+            clear_keyboard();
+            layer_state = dynamic_macro_playback.saved_layer_state;
+            dynamic_macro_play_user(direction);
+            return;
+        }
+
+        keyrecord_t    record;
+        uint16_t       delay;
+        const uint8_t *next = dynamic_macro_decode(dynamic_macro_playback.pointer, direction, &record, &delay);
+
+        if (timer_elapsed(dynamic_macro_playback.timer) < delay) {
+            return;
+        }
+        dynamic_macro_playback.timer += delay;
+        dynamic_macro_playback.pointer = next;
+        process_record(&record);
+    }
+}
+#    endif
+
+/**
+ * Play the dynamic macro.
+ *
+ * With DYNAMIC_MACRO_TIMED the playback is handed over to
+ * dynamic_macro_task(). A macro played from within a timed playback,
+ * i.e. a nested one, is played back at once.
+ *
+ * @param macro_buffer[in] The beginning of the macro buffer being played.
+ * @param macro_end[in]    The byte after the last macro byte.
+ * @param direction[in]    Either +1 or -1, which way to iterate the buffer.
+ */
+void dynamic_macro_play(uint8_t *macro_buffer, uint8_t *macro_end, int8_t direction) {
+    dprintf("dynamic macro: slot %d playback\n", DYNAMIC_MACRO_CURRENT_SLOT());
+
+    layer_state_t saved_layer_state = layer_state;
+
+    clear_keyboard();
+    layer_clear();
+
+#    ifdef DYNAMIC_MACRO_TIMED
+    if (!dynamic_macro_playback.pointer) {
+        dynamic_macro_playback.pointer           = macro_buffer;
+        dynamic_macro_playback.end               = macro_end;
+        dynamic_macro_playback.direction         = direction;
+        dynamic_macro_playback.timer             = timer_read();
+        dynamic_macro_playback.saved_layer_state = saved_layer_state;
+        dynamic_macro_task();
+        return;
+    }
+#    endif
+
+    const uint8_t *pointer = macro_buffer;
+    while (pointer != macro_end) {
+        keyrecord_t record;
+        pointer = dynamic_macro_decode(pointer, direction, &record, NULL);
+        process_record(&record);
+    }
+
+    clear_keyboard();
+
+    layer_state = saved_layer_state;
+
+    dynamic_macro_play_user(direction);
+}
+
+/**
+ * Record a single key in a dynamic macro.
+ *
+ * @param macro_buffer[in] The start of the used macro buffer.
+ * @param macro_pointer[in,out] The current buffer position.
+ * @param macro2_end[in] The end of the other macro.
+ * @param direction[in]  Either +1 or -1, which way to iterate the buffer.
+ * @param record[in]     The current keypress.
+ */
+void dynamic_macro_record_key(uint8_t *macro_buffer, uint8_t **macro_pointer, uint8_t *macro2_end, int8_t direction, keyrecord_t *record) {
+    /* If we've just started recording, ignore all the key releases. */
+    if (!record->event.pressed && *macro_pointer == macro_buffer) {
+        dprintln("dynamic macro: ignoring a leading key-up event");
+        return;
+    }
+
+    uint8_t event[DYNAMIC_MACRO_EVENT_MAX];
+    uint8_t length = dynamic_macro_encode(event, record, *macro_pointer == macro_buffer);
+
+    /* Everything up to and including the other end of the other macro
+     * is free to use.
+     */
+    if (direction * (macro2_end - *macro_pointer) + 1 >= length) {
+        for (uint8_t i = 0; i < length; i++) {
+            **macro_pointer = event[i];
+            *macro_pointer += direction;
+        }
+    } else {
+        dynamic_macro_record_key_user(direction, record);
+    }
+
+    dprintf("dynamic macro: slot %d length: %d/%d bytes\n", DYNAMIC_MACRO_CURRENT_SLOT(), DYNAMIC_MACRO_CURRENT_LENGTH(macro_buffer, *macro_pointer), DYNAMIC_MACRO_CURRENT_CAPACITY(macro_buffer, macro2_end));
+}
+
+/**
+ * End recording of the dynamic macro. Essentially just update the
+ * pointer to the end of the macro.
+ */
+void dynamic_macro_record_end(uint8_t *macro_buffer, uint8_t *macro_pointer, int8_t direction, uint8_t **macro_end) {
+    dynamic_macro_record_end_user(direction);
+
+    /* Do not save the keys being held when stopping the recording,
+     * i.e. the keys used to access the layer DYN_REC_STOP is on. The
+     * events can only be walked forwards, so look for the end of the
+     * last key-up event.
+     */
+    const uint8_t *pointer = macro_buffer;
+    const uint8_t *end     = macro_buffer;
+    while (pointer != macro_pointer) {
+        keyrecord_t record;
+        pointer = dynamic_macro_decode(pointer, direction, &record, NULL);
+        if (!record.event.pressed) {
+            end = pointer;
+        }
+    }
+    if (end != macro_pointer) {
+        dprintln("dynamic macro: trimming trailing key-down events");
+    }
+
+    dprintf("dynamic macro: slot %d saved, length: %d bytes\n", DYNAMIC_MACRO_CURRENT_SLOT(), DYNAMIC_MACRO_CURRENT_LENGTH(macro_buffer, end));
+
+    *macro_end = (uint8_t *)end;
+}
+#else
+
 /**
  * Play the dynamic macro.
  *
@@ -135,6 +414,7 @@ void dynamic_macro_record_end(keyrecord_t *macro_buffer, keyrecord_t *macro_poin
 
     *macro_end = macro_pointer;
 }
+#endif
 
 /* Handle the key events related to the dynamic macros. Should be
  * called from process_record_user() like this:
@@ -171,23 +451,23 @@ bool process_dynamic_macro(uint16_t keycode, keyrecord_t *record) {
      * macros or one long macro and one short macro. Or even one empty
      * and one using the whole buffer.
      */
-    static keyrecord_t macro_buffer[DYNAMIC_MACRO_SIZE];
+    static dynamic_macro_t macro_buffer[DYNAMIC_MACRO_BUFFER_SIZE];
 
     /* Pointer to the first buffer element after the first macro.
      * Initially points to the very beginning of the buffer since the
      * macro is empty. */
-    static keyrecord_t *macro_end = macro_buffer;
+    static dynamic_macro_t *macro_end = macro_buffer;
 
     /* The other end of the macro buffer. Serves as the beginning of
      * the second macro. */
-    static keyrecord_t *const r_macro_buffer = macro_buffer + DYNAMIC_MACRO_SIZE - 1;
+    static dynamic_macro_t *const r_macro_buffer = macro_buffer + DYNAMIC_MACRO_BUFFER_SIZE - 1;
 
     /* Like macro_end but for the second macro. */
-    static keyrecord_t *r_macro_end = r_macro_buffer;
+    static dynamic_macro_t *r_macro_end = r_macro_buffer;
 
     /* A persistent pointer to the current macro position (iterator)
      * used during the recording. */
-    static keyrecord_t *macro_pointer = NULL;
+    static dynamic_macro_t *macro_pointer = NULL;
 
     /* 0   - no macro is being recorded right now
      * 1,2 - either macro 1 or 2 is being recorded */
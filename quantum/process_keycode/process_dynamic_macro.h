@@ -33,8 +33,36 @@
 #    define DYNAMIC_MACRO_SIZE 128
 #endif
 
+/* With DYNAMIC_MACRO_COMPACT the recordings are packed into a byte
+ * buffer of the same size in RAM as the keyrecord_t buffer above
+ * (unless DYNAMIC_MACRO_BYTES says otherwise). A plain key event takes
+ * two bytes instead of a whole keyrecord_t, so the macros can be three
+ * to four times longer.
+ *
+ * DYNAMIC_MACRO_TIMED additionally stores the delay between the events
+ * and paces the playback from it instead of replaying as fast as
+ * possible. It implies DYNAMIC_MACRO_COMPACT.
+ */
+#if defined(DYNAMIC_MACRO_TIMED) && !defined(DYNAMIC_MACRO_COMPACT)
+#    define DYNAMIC_MACRO_COMPACT
+#endif
+
+#ifdef DYNAMIC_MACRO_COMPACT
+#    ifndef DYNAMIC_MACRO_BYTES
+#        define DYNAMIC_MACRO_BYTES (DYNAMIC_MACRO_SIZE * sizeof(keyrecord_t))
+#    endif
+typedef uint8_t dynamic_macro_t;
+#    define DYNAMIC_MACRO_BUFFER_SIZE DYNAMIC_MACRO_BYTES
+#else
+typedef keyrecord_t dynamic_macro_t;
+#    define DYNAMIC_MACRO_BUFFER_SIZE DYNAMIC_MACRO_SIZE
+#endif
+
 void dynamic_macro_led_blink(void);
 bool process_dynamic_macro(uint16_t keycode, keyrecord_t *record);
+#ifdef DYNAMIC_MACRO_TIMED
+void dynamic_macro_task(void);
+#endif
 void dynamic_macro_record_start_user(void);
 void dynamic_macro_play_user(int8_t direction);
 void dynamic_macro_record_key_user(int8_t direction, keyrecord_t *record);
@@ -6,6 +6,11 @@
 #include <string.h>
 #include <math.h>
 
+// Axis readings that move by no more than this from the last reported value are left out, to ride out ADC noise
+#ifndef JOYSTICK_AXIS_DEADBAND
+#    define JOYSTICK_AXIS_DEADBAND 0
+#endif
+
 bool process_joystick_buttons(uint16_t keycode, keyrecord_t *record);
 
 bool process_joystick(uint16_t keycode, keyrecord_t *record) {
@@ -75,88 +80,113 @@ void restorePinState(pin_t pin, uint16_t restoreState) {
 
 __attribute__((weak)) bool process_joystick_analogread() { return process_joystick_analogread_quantum(); }
 
-bool process_joystick_analogread_quantum() {
 #if JOYSTICK_AXES_COUNT > 0
-    for (int axis_index = 0; axis_index < JOYSTICK_AXES_COUNT; ++axis_index) {
-        if (joystick_axes[axis_index].input_pin == JS_VIRTUAL_AXIS) {
-            continue;
-        }
-
-        // save previous input pin status as well
-        uint16_t inputSavedState = savePinState(joystick_axes[axis_index].input_pin);
+// Reads an axis off the ADC and scales it to +-JOYSTICK_RESOLUTION
+static int16_t joystick_read_axis(uint8_t axis_index) {
+    // save previous input pin status as well
+    uint16_t inputSavedState = savePinState(joystick_axes[axis_index].input_pin);
 
-        // disable pull-up resistor
-        writePinLow(joystick_axes[axis_index].input_pin);
+    // disable pull-up resistor
+    writePinLow(joystick_axes[axis_index].input_pin);
 
-        // if pin was a pull-up input, we need to uncharge it by turning it low
-        // before making it a low input
-        setPinOutput(joystick_axes[axis_index].input_pin);
+    // if pin was a pull-up input, we need to uncharge it by turning it low
+    // before making it a low input
+    setPinOutput(joystick_axes[axis_index].input_pin);
 
-        wait_us(10);
+    wait_us(10);
 
-        // save and apply output pin status
-        uint16_t outputSavedState = 0;
-        if (joystick_axes[axis_index].output_pin != JS_VIRTUAL_AXIS) {
-            // save previous output pin status
-            outputSavedState = savePinState(joystick_axes[axis_index].output_pin);
+    // save and apply output pin status
+    uint16_t outputSavedState = 0;
+    if (joystick_axes[axis_index].output_pin != JS_VIRTUAL_AXIS) {
+        // save previous output pin status
+        outputSavedState = savePinState(joystick_axes[axis_index].output_pin);
 
-            setPinOutput(joystick_axes[axis_index].output_pin);
-            writePinHigh(joystick_axes[axis_index].output_pin);
-        }
+        setPinOutput(joystick_axes[axis_index].output_pin);
+        writePinHigh(joystick_axes[axis_index].output_pin);
+    }
 
-        uint16_t groundSavedState = 0;
-        if (joystick_axes[axis_index].ground_pin != JS_VIRTUAL_AXIS) {
-            // save previous output pin status
-            groundSavedState = savePinState(joystick_axes[axis_index].ground_pin);
+    uint16_t groundSavedState = 0;
+    if (joystick_axes[axis_index].ground_pin != JS_VIRTUAL_AXIS) {
+        // save previous output pin status
+        groundSavedState = savePinState(joystick_axes[axis_index].ground_pin);
 
-            setPinOutput(joystick_axes[axis_index].ground_pin);
-            writePinLow(joystick_axes[axis_index].ground_pin);
-        }
+        setPinOutput(joystick_axes[axis_index].ground_pin);
+        writePinLow(joystick_axes[axis_index].ground_pin);
+    }
 
-        wait_us(10);
+    wait_us(10);
 
-        setPinInput(joystick_axes[axis_index].input_pin);
+    setPinInput(joystick_axes[axis_index].input_pin);
 
-        wait_us(10);
+    wait_us(10);
 
 #    if defined(__AVR__) || defined(PROTOCOL_CHIBIOS)
-        int16_t axis_val = analogReadPin(joystick_axes[axis_index].input_pin);
+    int16_t axis_val = analogReadPin(joystick_axes[axis_index].input_pin);
 #    else
-        // default to resting position
-        int16_t axis_val = joystick_axes[axis_index].mid_digit;
+    // default to resting position
+    int16_t axis_val = joystick_axes[axis_index].mid_digit;
 #    endif
 
-        // test the converted value against the lower range
-        int32_t ref        = joystick_axes[axis_index].mid_digit;
-        int32_t range      = joystick_axes[axis_index].min_digit;
-        int32_t ranged_val = ((axis_val - ref) * -JOYSTICK_RESOLUTION) / (range - ref);
+    // restore output, ground and input status
+    if (joystick_axes[axis_index].output_pin != JS_VIRTUAL_AXIS) {
+        restorePinState(joystick_axes[axis_index].output_pin, outputSavedState);
+    }
+    if (joystick_axes[axis_index].ground_pin != JS_VIRTUAL_AXIS) {
+        restorePinState(joystick_axes[axis_index].ground_pin, groundSavedState);
+    }
 
-        if (ranged_val > 0) {
-            // the value is in the higher range
-            range      = joystick_axes[axis_index].max_digit;
-            ranged_val = ((axis_val - ref) * JOYSTICK_RESOLUTION) / (range - ref);
-        }
+    restorePinState(joystick_axes[axis_index].input_pin, inputSavedState);
 
-        // clamp the result in the valid range
-        ranged_val = ranged_val < -JOYSTICK_RESOLUTION ? -JOYSTICK_RESOLUTION : ranged_val;
-        ranged_val = ranged_val > JOYSTICK_RESOLUTION ? JOYSTICK_RESOLUTION : ranged_val;
+    // test the converted value against the lower range
+    int32_t ref        = joystick_axes[axis_index].mid_digit;
+    int32_t range      = joystick_axes[axis_index].min_digit;
+    int32_t ranged_val = ((axis_val - ref) * -JOYSTICK_RESOLUTION) / (range - ref);
 
-        if (ranged_val != joystick_status.axes[axis_index]) {
-            joystick_status.axes[axis_index] = ranged_val;
-            joystick_status.status |= JS_UPDATED;
-        }
+    if (ranged_val > 0) {
+        // the value is in the higher range
+        range      = joystick_axes[axis_index].max_digit;
+        ranged_val = ((axis_val - ref) * JOYSTICK_RESOLUTION) / (range - ref);
+    }
 
-        // restore output, ground and input status
-        if (joystick_axes[axis_index].output_pin != JS_VIRTUAL_AXIS) {
-            restorePinState(joystick_axes[axis_index].output_pin, outputSavedState);
-        }
-        if (joystick_axes[axis_index].ground_pin != JS_VIRTUAL_AXIS) {
-            restorePinState(joystick_axes[axis_index].ground_pin, groundSavedState);
-        }
+    // clamp the result in the valid range
+    ranged_val = ranged_val < -JOYSTICK_RESOLUTION ? -JOYSTICK_RESOLUTION : ranged_val;
+    ranged_val = ranged_val > JOYSTICK_RESOLUTION ? JOYSTICK_RESOLUTION : ranged_val;
+    return ranged_val;
+}
 
-        restorePinState(joystick_axes[axis_index].input_pin, inputSavedState);
+// Whether a new reading differs enough from the last one to be reported
+static bool joystick_axis_moved(int16_t last, int16_t value) {
+    if (value == last) {
+        return false;
+    }
+    // The ends and the rest position are always reported, so the deadband can't hold the axis short of them
+    if (value == 0 || value == JOYSTICK_RESOLUTION || value == -JOYSTICK_RESOLUTION) {
+        return true;
     }
+    int32_t diff = (int32_t)value - last;
+    return diff > JOYSTICK_AXIS_DEADBAND || diff < -JOYSTICK_AXIS_DEADBAND;
+}
+#endif
 
+bool process_joystick_analogread_quantum() {
+#if JOYSTICK_AXES_COUNT > 0
+    // One axis is sampled per call, so that the ADC waits are spread over the loop, and joystick_status.axes keeps
+    // the last sample of each
+    static uint8_t axis_index = 0;
+
+    for (uint8_t i = 0; i < JOYSTICK_AXES_COUNT; i++) {
+        axis_index = axis_index + 1 < JOYSTICK_AXES_COUNT ? axis_index + 1 : 0;
+        if (joystick_axes[axis_index].input_pin == JS_VIRTUAL_AXIS) {
+            continue;
+        }
+
+        int16_t value = joystick_read_axis(axis_index);
+        if (joystick_axis_moved(joystick_status.axes[axis_index], value)) {
+            joystick_status.axes[axis_index] = value;
+            joystick_status.status |= JS_UPDATED;
+        }
+        break;
+    }
 #endif
     return true;
 }
@@ -34,6 +34,49 @@ uint16_t leader_time = 0;
 uint16_t leader_sequence[5]   = {0, 0, 0, 0, 0};
 uint8_t  leader_sequence_size = 0;
 
+#    ifdef LEADER_TABLE
+/* Runs the entry matching the sequence so far once no longer entry can
+ * still match it, or on timeout. A sequence nothing matches ends at once. */
+static void leader_table_resolve(bool timeout) {
+    const leader_entry_t *match  = NULL;
+    bool                  longer = false;
+
+    for (uint8_t i = 0; i < leader_table_size; i++) {
+        const leader_entry_t *entry = &leader_table[i];
+        uint8_t               k     = 0;
+        while (k < leader_sequence_size && pgm_read_word(&entry->keys[k]) == leader_sequence[k]) {
+            k++;
+        }
+        if (k < leader_sequence_size) {
+            continue;
+        }
+        if (k == LEADER_SEQUENCE_LENGTH || pgm_read_word(&entry->keys[k]) == KC_NO) {
+            if (!match) {
+                match = entry;
+            }
+        } else {
+            longer = true;
+        }
+    }
+
+    if (longer && !timeout) {
+        return;
+    }
+    leading = false;
+    leader_end();
+    if (match) {
+        void (*fn)(void) = (void (*)(void))pgm_read_ptr(&match->fn);
+        fn();
+    }
+}
+
+void matrix_scan_leader(void) {
+    if (leading && timer_elapsed(leader_time) > LEADER_TIMEOUT) {
+        leader_table_resolve(true);
+    }
+}
+#    endif
+
 void qk_leader_start(void) {
     if (leading) {
         return;
@@ -58,6 +101,9 @@ bool process_leader(uint16_t keycode, keyrecord_t *record) {
                 if (leader_sequence_size < (sizeof(leader_sequence) / sizeof(leader_sequence[0]))) {
                     leader_sequence[leader_sequence_size] = keycode;
                     leader_sequence_size++;
+#    ifdef LEADER_TABLE
+                    leader_table_resolve(false);
+#    endif
                 } else {
                     leading = false;
                     leader_end();
@@ -18,12 +18,29 @@
 
 #include "quantum.h"
 
+#define LEADER_SEQUENCE_LENGTH 5
+
 bool process_leader(uint16_t keycode, keyrecord_t *record);
 
 void leader_start(void);
 void leader_end(void);
 void qk_leader_start(void);
 
+#ifdef LEADER_TABLE
+typedef struct {
+    uint16_t keys[LEADER_SEQUENCE_LENGTH];
+    void (*fn)(void);
+} leader_entry_t;
+
+#    define LEADER_ENTRY(func, ...) \
+        { .keys = {__VA_ARGS__}, .fn = (func) }
+
+extern const leader_entry_t leader_table[];
+extern const uint8_t        leader_table_size;
+
+void matrix_scan_leader(void);
+#endif
+
 #define SEQ_ONE_KEY(key) if (leader_sequence[0] == (key) && leader_sequence[1] == 0 && leader_sequence[2] == 0 && leader_sequence[3] == 0 && leader_sequence[4] == 0)
 #define SEQ_TWO_KEYS(key1, key2) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == 0 && leader_sequence[3] == 0 && leader_sequence[4] == 0)
 #define SEQ_THREE_KEYS(key1, key2, key3) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3) && leader_sequence[3] == 0 && leader_sequence[4] == 0)
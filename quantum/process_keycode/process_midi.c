@@ -22,7 +22,9 @@
 
 #    ifdef MIDI_BASIC
 
-void process_midi_basic_noteon(uint8_t note) { midi_send_noteon(&midi_device, 0, note, 127); }
+void process_midi_basic_noteon(uint8_t note) { process_midi_basic_noteon_velocity(note, 127); }
+
+void process_midi_basic_noteon_velocity(uint8_t note, uint8_t velocity) { midi_send_noteon(&midi_device, 0, note, velocity); }
 
 void process_midi_basic_noteoff(uint8_t note) { midi_send_noteoff(&midi_device, 0, note, 0); }
 
@@ -22,6 +22,7 @@
 
 #    ifdef MIDI_BASIC
 void process_midi_basic_noteon(uint8_t note);
+void process_midi_basic_noteon_velocity(uint8_t note, uint8_t velocity);
 void process_midi_basic_noteoff(uint8_t note);
 void process_midi_all_notes_off(void);
 #    endif
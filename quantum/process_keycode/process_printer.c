@@ -14,15 +14,31 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include "process_printer.h"
 #include "action_util.h"
 
+#ifndef SERIAL_UART_BAUD
+#    define SERIAL_UART_BAUD 9600
+#endif
+
+// Characters waiting for room in the UART's own transmit buffer, from 2 to 256
+#ifndef PRINTER_BUFFER_SIZE
+#    define PRINTER_BUFFER_SIZE 256
+#endif
+_Static_assert(PRINTER_BUFFER_SIZE >= 2 && PRINTER_BUFFER_SIZE <= 256, "PRINTER_BUFFER_SIZE must be from 2 to 256");
+
 bool    printing_enabled = false;
 uint8_t character_shift  = 0;
 
+static char    printer_buffer[PRINTER_BUFFER_SIZE];
+static uint8_t printer_buffer_head = 0;
+static uint8_t printer_buffer_tail = 0;
+
 void enable_printing(void) {
     printing_enabled = true;
-    serial_init();
+    uart_init(SERIAL_UART_BAUD);
 }
 
 void disable_printing(void) { printing_enabled = false; }
@@ -33,19 +49,33 @@ uint8_t shifted_numbers[10] = {0x21, 0x40, 0x23, 0x24, 0x25, 0x5E, 0x26, 0x2A, 0
 
 // keycode_to_ascii[KC_MINS] = {0x2D, 0x5F};
 
+/* Characters are only queued here, printer_task() hands them to the UART as
+ * it drains, so that printing never holds up key processing. They are
+ * dropped if the printer falls a whole buffer behind. */
 void print_char(char c) {
-    USB_Disable();
-    serial_send(c);
-    USB_Init();
+    uint8_t next = printer_buffer_head + 1 == PRINTER_BUFFER_SIZE ? 0 : printer_buffer_head + 1;
+    if (next == printer_buffer_tail) {
+        return;
+    }
+    printer_buffer[printer_buffer_head] = c;
+    printer_buffer_head                 = next;
 }
 
-void print_string(char c[]) {
-    for (uint8_t i = 0; i < strlen(c); i++) print_char(c[i]);
+void print_string(const char *c) {
+    while (*c) {
+        print_char(*c++);
+    }
+}
+
+void printer_task(void) {
+    while (printer_buffer_tail != printer_buffer_head && uart_try_putchar(printer_buffer[printer_buffer_tail])) {
+        printer_buffer_tail = printer_buffer_tail + 1 == PRINTER_BUFFER_SIZE ? 0 : printer_buffer_tail + 1;
+    }
 }
 
 void print_box_string(const char text[]) {
     size_t len = strlen(text);
-    char   out[len * 3 + 8];
+    char   out[len * 3 + 10];
     out[0] = 0xDA;
     for (uint8_t i = 0; i < len; i++) {
         out[i + 1] = 0xC4;
@@ -66,6 +96,7 @@ void print_box_string(const char text[]) {
     }
     out[len * 3 + 7] = 0xD9;
     out[len * 3 + 8] = '\n';
+    out[len * 3 + 9] = 0;
 
     print_string(out);
 }
@@ -18,6 +18,7 @@
 
 #include "quantum.h"
 
-#include "protocol/serial.h"
+#include "uart.h"
 
 bool process_printer(uint16_t keycode, keyrecord_t *record);
+void printer_task(void);
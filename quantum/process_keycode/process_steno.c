@@ -70,14 +70,21 @@ static void steno_clear_state(void) {
     memset(chord, 0, sizeof(chord));
 }
 
-static void send_steno_state(uint8_t size, bool send_empty) {
+static void send_steno_state(uint8_t size, bool send_empty, bool terminate) {
+#ifdef VIRTSER_ENABLE
+    // stage the whole packet so it goes out in one transfer rather than one per byte
+    uint8_t packet[MAX_STATE_SIZE + 1];
+    uint8_t length = 0;
     for (uint8_t i = 0; i < size; ++i) {
         if (chord[i] || send_empty) {
-#ifdef VIRTSER_ENABLE
-            virtser_send(chord[i]);
-#endif
+            packet[length++] = chord[i];
         }
     }
+    if (terminate) {
+        packet[length++] = 0;  // terminating byte
+    }
+    virtser_send_buffer(packet, length);
+#endif
 }
 
 void steno_init() {
@@ -106,14 +113,11 @@ static void send_steno_chord(void) {
     if (send_steno_chord_user(mode, chord)) {
         switch (mode) {
             case STENO_MODE_BOLT:
-                send_steno_state(BOLT_STATE_SIZE, false);
-#ifdef VIRTSER_ENABLE
-                virtser_send(0);  // terminating byte
-#endif
+                send_steno_state(BOLT_STATE_SIZE, false, true);
                 break;
             case STENO_MODE_GEMINI:
                 chord[0] |= 0x80;  // Indicate start of packet
-                send_steno_state(GEMINI_STATE_SIZE, true);
+                send_steno_state(GEMINI_STATE_SIZE, true, false);
                 break;
         }
     }
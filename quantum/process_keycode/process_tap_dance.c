@@ -19,8 +19,20 @@
 uint8_t get_oneshot_mods(void);
 #endif
 
+#ifndef TAP_DANCE_MAX_ACTIVE
+#    define TAP_DANCE_MAX_ACTIVE 4
+#endif
+
 static uint16_t last_td;
-static int8_t   highest_td = -1;
+
+/* The dances with a non-zero count, in the order they were started, each with
+ * the deferred executor of its tapping term. Only these are ever looked at, so
+ * the cost does not depend on the size of tap_dance_actions[]. */
+static struct {
+    uint8_t        index;
+    deferred_token token;
+} active_td[TAP_DANCE_MAX_ACTIVE];
+static uint8_t active_td_count = 0;
 
 void qk_tap_dance_pair_on_each_tap(qk_tap_dance_state_t *state, void *user_data) {
     qk_tap_dance_pair_t *pair = (qk_tap_dance_pair_t *)user_data;
@@ -102,15 +114,52 @@ static inline void process_tap_dance_action_on_reset(qk_tap_dance_action_t *acti
     send_keyboard_report();
 }
 
+static int8_t active_td_find(uint8_t index) {
+    for (uint8_t i = 0; i < active_td_count; i++) {
+        if (active_td[i].index == index) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static uint16_t tap_dance_term(qk_tap_dance_action_t *action) {
+    if (action->custom_tapping_term > 0) {
+        return action->custom_tapping_term;
+    }
+#ifdef TAPPING_TERM_PER_KEY
+    return get_tapping_term(action->state.keycode, NULL);
+#else
+    return TAPPING_TERM;
+#endif
+}
+
+static uint32_t tap_dance_timeout(uint32_t trigger_time, void *cb_arg) {
+    qk_tap_dance_action_t *action = (qk_tap_dance_action_t *)cb_arg;
+    int8_t                 i      = active_td_find(action - tap_dance_actions);
+
+    if (i >= 0) {
+        active_td[i].token = INVALID_DEFERRED_TOKEN;
+    }
+    process_tap_dance_action_on_dance_finished(action);
+    reset_tap_dance(&action->state);
+    return 0;
+}
+
 void preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
     qk_tap_dance_action_t *action;
 
     if (!record->event.pressed) return;
 
-    if (highest_td == -1) return;
+    // Walk a copy, resetting a dance removes it from the active list.
+    uint8_t active[TAP_DANCE_MAX_ACTIVE];
+    uint8_t count = active_td_count;
+    for (uint8_t i = 0; i < count; i++) {
+        active[i] = active_td[i].index;
+    }
 
-    for (int i = 0; i <= highest_td; i++) {
-        action = &tap_dance_actions[i];
+    for (uint8_t i = 0; i < count; i++) {
+        action = &tap_dance_actions[active[i]];
         if (action->state.count) {
             if (keycode == action->state.keycode && keycode == last_td) continue;
             action->state.interrupted          = true;
@@ -131,14 +180,30 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
 
     switch (keycode) {
         case QK_TAP_DANCE ... QK_TAP_DANCE_MAX:
-            if ((int16_t)idx > highest_td) highest_td = idx;
             action = &tap_dance_actions[idx];
 
             action->state.pressed = record->event.pressed;
             if (record->event.pressed) {
+                int8_t i = active_td_find(idx);
+                if (i < 0) {
+                    if (active_td_count == TAP_DANCE_MAX_ACTIVE) {
+                        // Out of slots, the oldest dance ends early.
+                        qk_tap_dance_action_t *oldest = &tap_dance_actions[active_td[0].index];
+                        process_tap_dance_action_on_dance_finished(oldest);
+                        oldest->state.pressed = false;
+                        reset_tap_dance(&oldest->state);
+                    }
+                    i                  = active_td_count++;
+                    active_td[i].index = idx;
+                    active_td[i].token = INVALID_DEFERRED_TOKEN;
+                }
+
                 action->state.keycode = keycode;
                 action->state.count++;
                 action->state.timer = timer_read();
+                if (!extend_deferred_exec(active_td[i].token, tap_dance_term(action) + 1)) {
+                    active_td[i].token = defer_exec(tap_dance_term(action) + 1, tap_dance_timeout, action);
+                }
 #ifndef NO_ACTION_ONESHOT
                 action->state.oneshot_mods = get_oneshot_mods();
 #else
@@ -161,28 +226,6 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
     return true;
 }
 
-void matrix_scan_tap_dance() {
-    if (highest_td == -1) return;
-    uint16_t tap_user_defined;
-
-    for (uint8_t i = 0; i <= highest_td; i++) {
-        qk_tap_dance_action_t *action = &tap_dance_actions[i];
-        if (action->custom_tapping_term > 0) {
-            tap_user_defined = action->custom_tapping_term;
-        } else {
-#ifdef TAPPING_TERM_PER_KEY
-            tap_user_defined = get_tapping_term(action->state.keycode, NULL);
-#else
-            tap_user_defined = TAPPING_TERM;
-#endif
-        }
-        if (action->state.count && timer_elapsed(action->state.timer) > tap_user_defined) {
-            process_tap_dance_action_on_dance_finished(action);
-            reset_tap_dance(&action->state);
-        }
-    }
-}
-
 void reset_tap_dance(qk_tap_dance_state_t *state) {
     qk_tap_dance_action_t *action;
 
@@ -197,4 +240,13 @@ void reset_tap_dance(qk_tap_dance_state_t *state) {
     state->finished             = false;
     state->interrupting_keycode = 0;
     last_td                     = 0;
+
+    int8_t i = active_td_find(state->keycode - QK_TAP_DANCE);
+    if (i >= 0) {
+        cancel_deferred_exec(active_td[i].token);
+        active_td_count--;
+        for (; i < active_td_count; i++) {
+            active_td[i] = active_td[i + 1];
+        }
+    }
 }
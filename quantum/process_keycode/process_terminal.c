@@ -24,12 +24,15 @@
 #    define CMD_BUFF_SIZE 5
 #endif
 
+#define TERMINAL_ARGUMENTS 6
+
 bool terminal_enabled = false;
 char buffer[80]       = "";
 char cmd_buffer[CMD_BUFF_SIZE][80];
 bool cmd_buffer_enabled = true;  // replace with ifdef?
 char newline[2]         = "\n";
-char arguments[6][20];
+// Point into buffer once a command is entered, words past the last one are empty
+const char *arguments[TERMINAL_ARGUMENTS];
 bool firstTime = true;
 
 short int current_cmd_buffer_pos = 0;  // used for up/down arrows - keeps track of where you are in the command buffer
@@ -40,7 +43,7 @@ __attribute__((weak)) const char terminal_prompt[8] = "> ";
 #    ifndef TERMINAL_SONG
 #        define TERMINAL_SONG SONG(TERMINAL_SOUND)
 #    endif
-float terminal_song[][2] = TERMINAL_SONG;
+song_note_t SONG_STORAGE terminal_song[] = TERMINAL_SONG;
 #    define TERMINAL_BELL() PLAY_SONG(terminal_song)
 #else
 #    define TERMINAL_BELL()
@@ -59,7 +62,7 @@ void enable_terminal(void) {
     terminal_enabled = true;
     strcpy(buffer, "");
     memset(cmd_buffer, 0, CMD_BUFF_SIZE * 80);
-    for (int i = 0; i < 6; i++) strcpy(arguments[i], "");
+    for (int i = 0; i < TERMINAL_ARGUMENTS; i++) arguments[i] = "";
     // select all text to start over
     // SEND_STRING(SS_LCTL("a"));
     send_string(terminal_prompt);
@@ -110,8 +113,6 @@ void terminal_about(void) {
 
 void terminal_help(void);
 
-extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
-
 void terminal_keycode(void) {
     if (strlen(arguments[1]) != 0 && strlen(arguments[2]) != 0 && strlen(arguments[3]) != 0) {
         char     keycode_dec[5];
@@ -119,7 +120,7 @@ void terminal_keycode(void) {
         uint16_t layer   = strtol(arguments[1], (char **)NULL, 10);
         uint16_t row     = strtol(arguments[2], (char **)NULL, 10);
         uint16_t col     = strtol(arguments[3], (char **)NULL, 10);
-        uint16_t keycode = pgm_read_word(&keymaps[layer][row][col]);
+        uint16_t keycode = keymap_flash_keycode(layer, row, col);
         itoa(keycode, keycode_dec, 10);
         itoa(keycode, keycode_hex, 16);
         SEND_STRING("0x");
@@ -139,7 +140,7 @@ void terminal_keymap(void) {
         uint16_t layer = strtol(arguments[1], (char **)NULL, 10);
         for (int r = 0; r < MATRIX_ROWS; r++) {
             for (int c = 0; c < MATRIX_COLS; c++) {
-                uint16_t keycode = pgm_read_word(&keymaps[layer][r][c]);
+                uint16_t keycode = keymap_flash_keycode(layer, r, c);
                 char     keycode_s[8];
                 sprintf(keycode_s, "0x%04x,", keycode);
                 send_string(keycode_s);
@@ -195,13 +196,14 @@ void process_terminal_command(void) {
     // we capture return bc of the order of events, so we need to manually send a newline
     send_string(newline);
 
-    char *  pch;
-    uint8_t i = 0;
-    pch       = strtok(buffer, " ");
-    while (pch != NULL) {
-        strcpy(arguments[i], pch);
-        pch = strtok(NULL, " ");
-        i++;
+    // Split the line into words in place, each space after a word ends it, so buffer is left holding the first
+    char *pch = buffer;
+    for (uint8_t i = 0; i < TERMINAL_ARGUMENTS; i++) {
+        while (*pch == ' ') pch++;
+        if (!*pch) break;
+        arguments[i] = pch;
+        while (*pch && *pch != ' ') pch++;
+        if (*pch) *pch++ = 0;
     }
 
     bool command_found = false;
@@ -217,7 +219,7 @@ void process_terminal_command(void) {
 
     if (terminal_enabled) {
         strcpy(buffer, "");
-        for (int i = 0; i < 6; i++) strcpy(arguments[i], "");
+        for (int i = 0; i < TERMINAL_ARGUMENTS; i++) arguments[i] = "";
         SEND_STRING(SS_TAP(X_HOME));
         send_string(terminal_prompt);
     }
@@ -316,8 +318,10 @@ bool process_terminal(uint16_t keycode, keyrecord_t *record) {
                         } else if (get_mods() == 0) {
                             char_to_add = keycode_to_ascii_lut[keycode];
                         }
-                        if (char_to_add != 0) {
-                            strncat(buffer, &char_to_add, 1);
+                        str_len = strlen(buffer);
+                        if (char_to_add != 0 && str_len < sizeof(buffer) - 1) {
+                            buffer[str_len]     = char_to_add;
+                            buffer[str_len + 1] = 0;
                         }
                     }
                     break;
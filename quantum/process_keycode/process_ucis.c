@@ -15,6 +15,7 @@
  */
 
 #include "process_ucis.h"
+#include <string.h>
 
 qk_ucis_state_t qk_ucis_state;
 
@@ -33,20 +34,108 @@ __attribute__((weak)) void qk_ucis_start_user(void) {
 
 __attribute__((weak)) void qk_ucis_success(uint8_t symbol_index) {}
 
-static bool is_uni_seq(char *seq) {
-    uint8_t i;
-    for (i = 0; seq[i]; i++) {
-        uint16_t keycode;
-        if ('1' <= seq[i] && seq[i] <= '0') {
-            keycode = seq[i] - '1' + KC_1;
+/* Symbols are looked up by binary search when the table is in strcmp() order,
+ * which is checked the first time it is needed, and one by one otherwise. */
+static uint16_t symbol_count = 0;
+static bool     table_sorted = false;
+static bool     table_known  = false;
+
+static void ucis_table_scan(void) {
+    table_sorted = true;
+    for (symbol_count = 0; ucis_symbol_table[symbol_count].symbol; symbol_count++) {
+        if (symbol_count > 0 && strcmp(ucis_symbol_table[symbol_count - 1].symbol, ucis_symbol_table[symbol_count].symbol) > 0) {
+            table_sorted = false;
+        }
+    }
+    table_known = true;
+}
+
+// Spells out the first length typed keys, a key no symbol can have becomes a character none has either
+static void ucis_typed(char *typed, uint8_t length) {
+    for (uint8_t i = 0; i < length; i++) {
+        uint16_t keycode = qk_ucis_state.codes[i];
+        if (keycode >= KC_A && keycode <= KC_Z) {
+            typed[i] = keycode - KC_A + 'a';
+        } else if (keycode >= KC_1 && keycode <= KC_9) {
+            typed[i] = keycode - KC_1 + '1';
+        } else if (keycode == KC_0) {
+            typed[i] = '0';
         } else {
-            keycode = seq[i] - 'a' + KC_A;
+            typed[i] = '\x7f';
         }
-        if (i > qk_ucis_state.count || qk_ucis_state.codes[i] != keycode) {
-            return false;
+    }
+    typed[length] = '\0';
+}
+
+// Index of the first symbol the prefix does not sort after
+static uint16_t ucis_lower_bound(const char *prefix) {
+    uint16_t low = 0, high = symbol_count;
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        if (strcmp(ucis_symbol_table[mid].symbol, prefix) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Index of the first symbol after those starting with the prefix
+static uint16_t ucis_upper_bound(const char *prefix, uint8_t length) {
+    uint16_t low = 0, high = symbol_count;
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        if (strncmp(ucis_symbol_table[mid].symbol, prefix, length) <= 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Index of the symbol spelled by the first length typed keys, or -1
+static int16_t ucis_find_symbol(uint8_t length) {
+    char typed[UCIS_MAX_SYMBOL_LENGTH + 1];
+    ucis_typed(typed, length);
+    if (!table_known) {
+        ucis_table_scan();
+    }
+
+    if (table_sorted) {
+        uint16_t i = ucis_lower_bound(typed);
+        return i < symbol_count && strcmp(ucis_symbol_table[i].symbol, typed) == 0 ? i : -1;
+    }
+    for (uint16_t i = 0; i < symbol_count; i++) {
+        if (strcmp(ucis_symbol_table[i].symbol, typed) == 0) {
+            return i;
         }
     }
-    return qk_ucis_state.codes[i] == KC_ENT || qk_ucis_state.codes[i] == KC_SPC;
+    return -1;
+}
+
+uint16_t qk_ucis_matches(uint16_t *first) {
+    char typed[UCIS_MAX_SYMBOL_LENGTH + 1];
+    ucis_typed(typed, qk_ucis_state.count);
+    if (!table_known) {
+        ucis_table_scan();
+    }
+
+    if (table_sorted) {
+        *first = ucis_lower_bound(typed);
+        return ucis_upper_bound(typed, qk_ucis_state.count) - *first;
+    }
+    uint16_t matches = 0;
+    for (uint16_t i = 0; i < symbol_count; i++) {
+        if (strncmp(ucis_symbol_table[i].symbol, typed, qk_ucis_state.count) == 0) {
+            if (matches == 0) {
+                *first = i;
+            }
+            matches++;
+        }
+    }
+    return matches;
 }
 
 __attribute__((weak)) void qk_ucis_symbol_fallback(void) {
@@ -62,8 +151,12 @@ __attribute__((weak)) void qk_ucis_cancel(void) {}
 
 void register_ucis(const uint32_t *code_points) {
     for (int i = 0; i < UCIS_MAX_CODE_POINTS && code_points[i]; i++) {
+#ifdef UNICODE_ASYNC
+        register_unicode_queued(code_points[i]);
+#else
         register_unicode(code_points[i]);
         wait_ms(UNICODE_TYPE_DELAY);
+#endif
     }
 }
 
@@ -105,17 +198,10 @@ bool process_ucis(uint16_t keycode, keyrecord_t *record) {
                 return false;
             }
 
-            uint8_t i;
-            bool    symbol_found = false;
-            for (i = 0; ucis_symbol_table[i].symbol; i++) {
-                if (is_uni_seq(ucis_symbol_table[i].symbol)) {
-                    symbol_found = true;
-                    register_ucis(ucis_symbol_table[i].code_points);
-                    break;
-                }
-            }
-            if (symbol_found) {
-                qk_ucis_success(i);
+            int16_t symbol_index = ucis_find_symbol(qk_ucis_state.count - 1);
+            if (symbol_index >= 0) {
+                register_ucis(ucis_symbol_table[symbol_index].code_points);
+                qk_ucis_success(symbol_index);
             } else {
                 qk_ucis_symbol_fallback();
             }
@@ -57,6 +57,9 @@ void qk_ucis_start(void);
 void qk_ucis_start_user(void);
 void qk_ucis_symbol_fallback(void);
 void qk_ucis_success(uint8_t symbol_index);
+/* Number of symbols starting with what has been typed so far, and the table index of the first
+ * of them. With the table in alphabetical order these are all the symbols from there on. */
+uint16_t qk_ucis_matches(uint16_t *first);
 
 void register_ucis(const uint32_t *code_points);
 
@@ -274,37 +274,241 @@ void send_unicode_string(const char *str) {
     }
 }
 
+/* Queued code points, typed from the main loop one key event at a time.
+ * Each code point is expanded into the key events of the selected input
+ * mode when it comes up, so mode changes apply to what is still queued. */
+#define UNICODE_ASYNC_UP 0x8000          // release the keycode instead of pressing it
+#define UNICODE_ASYNC_DELAY 0x4000       // give the input method UNICODE_TYPE_DELAY to catch up
+#define UNICODE_ASYNC_CLEAR_MODS 0x2000  // save and clear the current mods
+#define UNICODE_ASYNC_SET_MODS 0x2001    // put the saved mods back
+
+// Enough for the longest expansion: caps lock, the start key, a surrogate pair and the finish key
+#define UNICODE_ASYNC_EVENTS_SIZE 24
+
+static uint32_t unicode_async_queue[UNICODE_ASYNC_QUEUE_SIZE];
+static uint8_t  unicode_async_queue_head  = 0;
+static uint8_t  unicode_async_queue_count = 0;
+
+static uint16_t unicode_async_events[UNICODE_ASYNC_EVENTS_SIZE];
+static uint8_t  unicode_async_event_index = 0;
+static uint8_t  unicode_async_event_count = 0;
+static uint8_t  unicode_async_saved_mods  = 0;
+static bool     unicode_async_waiting     = false;
+static uint16_t unicode_async_timer       = 0;
+
+static void unicode_async_push(uint16_t event) { unicode_async_events[unicode_async_event_count++] = event; }
+
+static void unicode_async_tap(uint16_t keycode) {
+    unicode_async_push(keycode);
+    unicode_async_push(keycode | UNICODE_ASYNC_UP);
+}
+
+// Same digits as register_hex32(): at least four, without further leading zeroes
+static void unicode_async_hex32(uint32_t hex) {
+    bool onzerostart = true;
+    for (int i = 7; i >= 0; i--) {
+        if (i <= 3) {
+            onzerostart = false;
+        }
+        uint8_t digit = ((hex >> (i * 4)) & 0xF);
+        if (digit == 0 && onzerostart) {
+            continue;
+        }
+        onzerostart = false;
+        unicode_async_tap(digit == 0 ? KC_0 : digit < 10 ? KC_1 + digit - 1 : KC_A + digit - 10);
+    }
+}
+
+/* The key events of unicode_input_start(), register_unicode() and
+ * unicode_input_finish(), for the built-in input modes */
+static void unicode_async_expand(uint32_t code_point) {
+    bool caps_lock = host_keyboard_led_state().caps_lock;
+
+    unicode_async_event_index = 0;
+    unicode_async_event_count = 0;
+
+    if (unicode_config.input_mode == UC_LNX && caps_lock) {
+        unicode_async_tap(KC_CAPS);
+    }
+    unicode_async_push(UNICODE_ASYNC_CLEAR_MODS);
+
+    switch (unicode_config.input_mode) {
+        case UC_MAC:
+            unicode_async_push(UNICODE_KEY_MAC);
+            break;
+        case UC_LNX:
+            unicode_async_tap(UNICODE_KEY_LNX);
+            break;
+        case UC_WIN:
+            unicode_async_push(KC_LALT);
+            unicode_async_tap(KC_PPLS);
+            break;
+        case UC_WINC:
+            unicode_async_tap(UNICODE_KEY_WINC);
+            unicode_async_tap(KC_U);
+            break;
+    }
+    if (UNICODE_TYPE_DELAY > 0) {
+        unicode_async_push(UNICODE_ASYNC_DELAY);
+    }
+
+    if (code_point > 0xFFFF && unicode_config.input_mode == UC_MAC) {
+        // Convert code point to UTF-16 surrogate pair on macOS
+        code_point -= 0x10000;
+        uint32_t lo = code_point & 0x3FF, hi = (code_point & 0xFFC00) >> 10;
+        unicode_async_hex32(hi + 0xD800);
+        unicode_async_hex32(lo + 0xDC00);
+    } else {
+        unicode_async_hex32(code_point);
+    }
+
+    switch (unicode_config.input_mode) {
+        case UC_MAC:
+            unicode_async_push(UNICODE_KEY_MAC | UNICODE_ASYNC_UP);
+            break;
+        case UC_LNX:
+            unicode_async_tap(KC_SPC);
+            if (caps_lock) {
+                unicode_async_tap(KC_CAPS);
+            }
+            break;
+        case UC_WIN:
+            unicode_async_push(KC_LALT | UNICODE_ASYNC_UP);
+            break;
+        case UC_WINC:
+            unicode_async_tap(KC_ENTER);
+            break;
+    }
+    unicode_async_push(UNICODE_ASYNC_SET_MODS);
+}
+
+bool register_unicode_async(uint32_t code_point) {
+    if (code_point > 0x10FFFF || (code_point > 0xFFFF && unicode_config.input_mode == UC_WIN)) {
+        // Code point out of range, do nothing
+        return true;
+    }
+    if (unicode_async_queue_count == UNICODE_ASYNC_QUEUE_SIZE) {
+        return false;
+    }
+    unicode_async_queue[(unicode_async_queue_head + unicode_async_queue_count++) % UNICODE_ASYNC_QUEUE_SIZE] = code_point;
+    return true;
+}
+
+// Queues the code point, typing what is already queued in place while the queue is full
+void register_unicode_queued(uint32_t code_point) {
+    while (!register_unicode_async(code_point)) {
+        send_string_task();
+        unicode_task();
+    }
+}
+
+bool send_unicode_string_async(const char *str) {
+    if (!str) {
+        return true;
+    }
+
+    // Only queue the string if all of it fits
+    uint8_t count = 0;
+    for (const char *p = str; *p;) {
+        int32_t code_point = 0;
+        p                  = decode_utf8(p, &code_point);
+        if (code_point >= 0 && ++count > UNICODE_ASYNC_QUEUE_SIZE - unicode_async_queue_count) {
+            return false;
+        }
+    }
+
+    while (*str) {
+        int32_t code_point = 0;
+        str                = decode_utf8(str, &code_point);
+
+        if (code_point >= 0) {
+            register_unicode_async(code_point);
+        }
+    }
+    return true;
+}
+
+bool unicode_async_busy(void) { return unicode_async_queue_count || unicode_async_event_index < unicode_async_event_count; }
+
+/* Sends at most one key event, or waits out the input method delay */
+void unicode_task(void) {
+    if (unicode_async_waiting) {
+        if (timer_elapsed(unicode_async_timer) < UNICODE_TYPE_DELAY) {
+            return;
+        }
+        unicode_async_waiting = false;
+    }
+
+    if (unicode_async_event_index == unicode_async_event_count) {
+        // Let queued strings finish first, both hold keys in the same report
+        if (!unicode_async_queue_count || send_string_async_busy()) {
+            return;
+        }
+        unicode_async_expand(unicode_async_queue[unicode_async_queue_head]);
+        unicode_async_queue_head = (unicode_async_queue_head + 1) % UNICODE_ASYNC_QUEUE_SIZE;
+        unicode_async_queue_count--;
+    }
+
+    uint16_t event = unicode_async_events[unicode_async_event_index++];
+    switch (event) {
+        case UNICODE_ASYNC_DELAY:
+            unicode_async_waiting = true;
+            unicode_async_timer   = timer_read();
+            break;
+        case UNICODE_ASYNC_CLEAR_MODS:
+            unicode_async_saved_mods = get_mods();
+            if (unicode_async_saved_mods) {
+                clear_mods();
+                send_keyboard_report();
+            }
+            break;
+        case UNICODE_ASYNC_SET_MODS:
+            if (unicode_async_saved_mods) {
+                set_mods(unicode_async_saved_mods);
+                send_keyboard_report();
+            }
+            break;
+        default:
+            if (event & UNICODE_ASYNC_UP) {
+                unregister_code16(event & ~UNICODE_ASYNC_UP);
+            } else {
+                register_code16(event);
+            }
+            break;
+    }
+}
+
 // clang-format off
 
 static void audio_helper(void) {
 #ifdef AUDIO_ENABLE
     switch (get_unicode_input_mode()) {
 #    ifdef UNICODE_SONG_MAC
-        static float song_mac[][2] = UNICODE_SONG_MAC;
+        static song_note_t SONG_STORAGE song_mac[] = UNICODE_SONG_MAC;
         case UC_MAC:
             PLAY_SONG(song_mac);
             break;
 #    endif
 #    ifdef UNICODE_SONG_LNX
-        static float song_lnx[][2] = UNICODE_SONG_LNX;
+        static song_note_t SONG_STORAGE song_lnx[] = UNICODE_SONG_LNX;
         case UC_LNX:
             PLAY_SONG(song_lnx);
             break;
 #    endif
 #    ifdef UNICODE_SONG_WIN
-        static float song_win[][2] = UNICODE_SONG_WIN;
+        static song_note_t SONG_STORAGE song_win[] = UNICODE_SONG_WIN;
         case UC_WIN:
             PLAY_SONG(song_win);
             break;
 #    endif
 #    ifdef UNICODE_SONG_BSD
-        static float song_bsd[][2] = UNICODE_SONG_BSD;
+        static song_note_t SONG_STORAGE song_bsd[] = UNICODE_SONG_BSD;
         case UC_BSD:
             PLAY_SONG(song_bsd);
             break;
 #    endif
 #    ifdef UNICODE_SONG_WINC
-        static float song_winc[][2] = UNICODE_SONG_WINC;
+        static song_note_t SONG_STORAGE song_winc[] = UNICODE_SONG_WINC;
         case UC_WINC:
             PLAY_SONG(song_winc);
             break;
@@ -49,6 +49,11 @@
 #    define UNICODE_TYPE_DELAY 10
 #endif
 
+// Number of code points that can wait to be typed by unicode_task()
+#ifndef UNICODE_ASYNC_QUEUE_SIZE
+#    define UNICODE_ASYNC_QUEUE_SIZE 16
+#endif
+
 // Deprecated aliases
 #if !defined(UNICODE_KEY_MAC) && defined(UNICODE_KEY_OSX)
 #    define UNICODE_KEY_MAC UNICODE_KEY_OSX
@@ -93,6 +98,14 @@ void register_unicode(uint32_t code_point);
 void send_unicode_hex_string(const char *str);
 void send_unicode_string(const char *str);
 
+// Queued code points, typed from the main loop without blocking it.
+// These use the built-in input mode sequences, not unicode_input_start()/_finish() overrides.
+bool register_unicode_async(uint32_t code_point);
+void register_unicode_queued(uint32_t code_point);
+bool send_unicode_string_async(const char *str);
+bool unicode_async_busy(void);
+void unicode_task(void);
+
 bool process_unicode_common(uint16_t keycode, keyrecord_t *record);
 
 #define UC_BSPC UC(0x0008)
@@ -42,7 +42,11 @@ __attribute__((weak)) uint16_t unicodemap_index(uint16_t keycode) {
 bool process_unicodemap(uint16_t keycode, keyrecord_t *record) {
     if (keycode >= QK_UNICODEMAP && keycode <= QK_UNICODEMAP_PAIR_MAX && record->event.pressed) {
         uint32_t code_point = pgm_read_dword(unicode_map + unicodemap_index(keycode));
+#ifdef UNICODE_ASYNC
+        register_unicode_queued(code_point);
+#else
         register_unicode(code_point);
+#endif
     }
     return true;
 }
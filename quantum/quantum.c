@@ -40,16 +40,20 @@
 #    include "haptic.h"
 #endif
 
+#if defined(EEPROM_DRIVER) && defined(EEPROM_WRITE_BACK)
+#    include "eeprom_driver.h"
+#endif
+
 #ifdef AUDIO_ENABLE
 #    ifndef GOODBYE_SONG
 #        define GOODBYE_SONG SONG(GOODBYE_SOUND)
 #    endif
-float goodbye_song[][2] = GOODBYE_SONG;
+song_note_t SONG_STORAGE goodbye_song[] = GOODBYE_SONG;
 #    ifdef DEFAULT_LAYER_SONGS
-float default_layer_songs[][16][2] = DEFAULT_LAYER_SONGS;
+song_note_t SONG_STORAGE default_layer_songs[][16] = DEFAULT_LAYER_SONGS;
 #    endif
 #    ifdef SENDSTRING_BELL
-float bell_song[][2] = SONG(TERMINAL_SOUND);
+song_note_t SONG_STORAGE bell_song[] = SONG(TERMINAL_SOUND);
 #    endif
 #endif
 
@@ -57,12 +61,12 @@ float bell_song[][2] = SONG(TERMINAL_SOUND);
 #    include "process_auto_shift.h"
 #endif
 
-static void do_code16(uint16_t code, void (*f)(uint8_t)) {
+static uint8_t code16_mods(uint16_t code) {
     switch (code) {
         case QK_MODS ... QK_MODS_MAX:
             break;
         default:
-            return;
+            return 0;
     }
 
     uint8_t mods_to_send = 0;
@@ -79,9 +83,11 @@ static void do_code16(uint16_t code, void (*f)(uint8_t)) {
         if (code & QK_LGUI) mods_to_send |= MOD_BIT(KC_LGUI);
     }
 
-    f(mods_to_send);
+    return mods_to_send;
 }
 
+static void do_code16(uint16_t code, void (*f)(uint8_t)) { f(code16_mods(code)); }
+
 void register_code16(uint16_t code) {
     if (IS_MOD(code) || code == KC_NO) {
         do_code16(code, register_mods);
@@ -102,10 +108,11 @@ void unregister_code16(uint16_t code) {
 
 void tap_code16(uint16_t code) {
     register_code16(code);
-#if TAP_CODE_DELAY > 0
-    wait_ms(TAP_CODE_DELAY);
-#endif
-    unregister_code16(code);
+    if (IS_MOD(code) || code == KC_NO) {
+        unregister_code_deferred(code, code16_mods(code), 0, TAP_CODE_DELAY);
+    } else {
+        unregister_code_deferred(code, 0, code16_mods(code), TAP_CODE_DELAY);
+    }
 }
 
 __attribute__((weak)) bool process_action_kb(keyrecord_t *record) { return true; }
@@ -138,6 +145,9 @@ void reset_keyboard(void) {
 #endif
 #ifdef HAPTIC_ENABLE
     haptic_shutdown();
+#endif
+#if defined(EEPROM_DRIVER) && defined(EEPROM_WRITE_BACK)
+    eeprom_driver_flush();
 #endif
     bootloader_jump();
 }
@@ -175,6 +185,13 @@ void post_process_record_quantum(keyrecord_t *record) {
     post_process_record_kb(keycode, record);
 }
 
+/* Calls a handler only for the keycodes it acts on. The handlers
+   given a range return true for every other keycode without side
+   effects, so the call can be skipped. Handlers that look at every
+   event (key lock, dynamic macros, tap dance, combos, leader, auto
+   shift, space cadet...) are still called for every event.        */
+#define PROCESS_RANGE(first, last, handler) (keycode < (first) || keycode > (last) || handler(keycode, record))
+
 /* Core keycode function, hands off handling to other functions,
     then processes internal quantum keycodes, and then processes
     ACTIONs.                                                      */
@@ -221,23 +238,23 @@ bool process_record_quantum(keyrecord_t *record) {
             process_haptic(keycode, record) &&
 #endif  // HAPTIC_ENABLE
 #if defined(VIA_ENABLE)
-            process_record_via(keycode, record) &&
+            PROCESS_RANGE(FN_MO13, MACRO15, process_record_via) &&
 #endif
             process_record_kb(keycode, record) &&
 #if defined(SEQUENCER_ENABLE)
-            process_sequencer(keycode, record) &&
+            PROCESS_RANGE(SQ_ON, SEQUENCER_TRACK_MAX, process_sequencer) &&
 #endif
 #if defined(MIDI_ENABLE) && defined(MIDI_ADVANCED)
-            process_midi(keycode, record) &&
+            PROCESS_RANGE(MIDI_TONE_MIN, MI_BENDU, process_midi) &&
 #endif
 #ifdef AUDIO_ENABLE
-            process_audio(keycode, record) &&
+            PROCESS_RANGE(AU_ON, MUV_DE, process_audio) &&
 #endif
 #ifdef BACKLIGHT_ENABLE
-            process_backlight(keycode, record) &&
+            PROCESS_RANGE(BL_ON, BL_BRTG, process_backlight) &&
 #endif
 #ifdef STENO_ENABLE
-            process_steno(keycode, record) &&
+            PROCESS_RANGE(QK_STENO, QK_STENO_MAX, process_steno) &&
 #endif
 #if (defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_BASIC))) && !defined(NO_MUSIC_MODE)
             process_music(keycode, record) &&
@@ -267,16 +284,17 @@ bool process_record_quantum(keyrecord_t *record) {
             process_space_cadet(keycode, record) &&
 #endif
 #ifdef MAGIC_KEYCODE_ENABLE
-            process_magic(keycode, record) &&
+            PROCESS_RANGE(MAGIC_SWAP_CONTROL_CAPSLOCK, MAGIC_TOGGLE_ALT_GUI, process_magic) &&
+            PROCESS_RANGE(MAGIC_SWAP_LCTL_LGUI, MAGIC_EE_HANDS_RIGHT, process_magic) &&
 #endif
 #ifdef GRAVE_ESC_ENABLE
-            process_grave_esc(keycode, record) &&
+            PROCESS_RANGE(GRAVE_ESC, GRAVE_ESC, process_grave_esc) &&
 #endif
 #if defined(RGBLIGHT_ENABLE) || defined(RGB_MATRIX_ENABLE)
-            process_rgb(keycode, record) &&
+            PROCESS_RANGE(RGB_TOG, RGB_MODE_RGBTEST, process_rgb) &&
 #endif
 #ifdef JOYSTICK_ENABLE
-            process_joystick(keycode, record) &&
+            PROCESS_RANGE(JS_BUTTON_MIN, JS_BUTTON_MAX, process_joystick) &&
 #endif
             true)) {
         return false;
@@ -333,8 +351,8 @@ void set_single_persistent_default_layer(uint8_t default_layer) {
 }
 
 layer_state_t update_tri_layer_state(layer_state_t state, uint8_t layer1, uint8_t layer2, uint8_t layer3) {
-    layer_state_t mask12 = (1UL << layer1) | (1UL << layer2);
-    layer_state_t mask3  = 1UL << layer3;
+    layer_state_t mask12 = LAYER_STATE_BIT(layer1) | LAYER_STATE_BIT(layer2);
+    layer_state_t mask3  = LAYER_STATE_BIT(layer3);
     return (state & mask12) == mask12 ? (state | mask3) : (state & ~mask3);
 }
 
@@ -351,6 +369,29 @@ void matrix_init_quantum() {
     // TODO: remove calls to led_init_ports from keyboards and remove ifdef
     led_init_ports();
 #endif
+#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
+    unicode_input_mode_init();
+#endif
+#if defined(BLUETOOTH_ENABLE) && defined(OUTPUT_AUTO_ENABLE)
+    set_output(OUTPUT_AUTO);
+#endif
+#ifndef KEYBOARD_DEFERRED_INIT
+    keyboard_init_deferred_quantum();
+#endif
+
+    matrix_init_kb();
+}
+
+static bool outputs_ready = false;
+
+/** \brief Starts backlight, LED and RGB matrix, audio and haptic feedback
+ *
+ * Part of matrix_init_quantum(), or of keyboard_init_deferred() with KEYBOARD_DEFERRED_INIT.
+ */
+void keyboard_init_deferred_quantum(void) {
+    if (outputs_ready) {
+        return;
+    }
 #ifdef BACKLIGHT_ENABLE
 #    ifdef LED_MATRIX_ENABLE
     led_matrix_init();
@@ -364,17 +405,10 @@ void matrix_init_quantum() {
 #ifdef RGB_MATRIX_ENABLE
     rgb_matrix_init();
 #endif
-#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
-    unicode_input_mode_init();
-#endif
 #ifdef HAPTIC_ENABLE
     haptic_init();
 #endif
-#if defined(BLUETOOTH_ENABLE) && defined(OUTPUT_AUTO_ENABLE)
-    set_output(OUTPUT_AUTO);
-#endif
-
-    matrix_init_kb();
+    outputs_ready = true;
 }
 
 void matrix_scan_quantum() {
@@ -388,7 +422,7 @@ void matrix_scan_quantum() {
     // startup song.
     static bool     delayed_tasks_run  = false;
     static uint16_t delayed_task_timer = 0;
-    if (!delayed_tasks_run) {
+    if (!delayed_tasks_run && outputs_ready) {
         if (!delayed_task_timer) {
             delayed_task_timer = timer_read();
         } else if (timer_elapsed(delayed_task_timer) > 300) {
@@ -406,24 +440,38 @@ void matrix_scan_quantum() {
     matrix_scan_sequencer();
 #endif
 
-#ifdef TAP_DANCE_ENABLE
-    matrix_scan_tap_dance();
-#endif
-
 #ifdef COMBO_ENABLE
     matrix_scan_combo();
 #endif
 
-#ifdef LED_MATRIX_ENABLE
-    led_matrix_task();
+#if defined(DYNAMIC_MACRO_ENABLE) && defined(DYNAMIC_MACRO_TIMED)
+    dynamic_macro_task();
 #endif
 
-#ifdef WPM_ENABLE
-    decay_wpm();
+#if defined(LEADER_ENABLE) && defined(LEADER_TABLE)
+    matrix_scan_leader();
+#endif
+
+    send_string_task();
+
+#ifdef PRINTING_ENABLE
+    printer_task();
+#endif
+
+#if defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)
+    unicode_task();
+#endif
+
+#ifdef LED_MATRIX_ENABLE
+    if (outputs_ready) {
+        led_matrix_task();
+    }
 #endif
 
 #ifdef HAPTIC_ENABLE
-    haptic_task();
+    if (outputs_ready) {
+        haptic_task();
+    }
 #endif
 
 #ifdef DIP_SWITCH_ENABLE
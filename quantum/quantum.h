@@ -54,6 +54,8 @@
 #include "bootloader.h"
 #include "timer.h"
 #include "sync_timer.h"
+#include "deferred_exec.h"
+#include "event_bus.h"
 #include "config_common.h"
 #include "gpio.h"
 #include "atomic_util.h"
@@ -230,6 +232,11 @@ extern layer_state_t layer_state;
 #    endif
 #    define waitInputPinDelay() wait_cpuclock(GPIO_INPUT_PIN_DELAY)
 
+#elif defined(PROTOCOL_NATIVE)
+
+/* No pins to settle on the host */
+#    define waitInputPinDelay()
+
 #endif
 
 // For tri-layer
@@ -20,6 +20,8 @@
 #include "progmem.h"
 #include "config.h"
 #include "eeprom.h"
+#include "spsc_queue.h"
+#include <stddef.h>
 #include <string.h>
 #include <math.h>
 
@@ -31,11 +33,53 @@ const point_t k_rgb_matrix_center = {112, 32};
 const point_t k_rgb_matrix_center = RGB_MATRIX_CENTER;
 #endif
 
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+led_geometry_t g_led_geometry[DRIVER_LED_TOTAL];
+#endif
+
+#ifdef RGB_MATRIX_KEY_LED_CACHE
+#    if RGB_MATRIX_KEY_LED_LIST_SIZE > UINT8_MAX
+#        error "RGB_MATRIX_KEY_LED_LIST_SIZE must not be larger than 255"
+#    endif
+key_leds_t g_rgb_key_leds[MATRIX_ROWS][MATRIX_COLS];
+uint8_t    g_rgb_key_led_list[RGB_MATRIX_KEY_LED_LIST_SIZE];
+#endif
+
 __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv); }
 
+#ifdef RGB_MATRIX_HSV_BATCH
+HSV g_rgb_hsv_batch[RGB_MATRIX_HSV_BATCH_SIZE];
+
+// Must be overridden together with rgb_matrix_hsv_to_rgb()
+__attribute__((weak)) void rgb_matrix_hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) { hsv_to_rgb_batch(hsv, rgb, count); }
+
+// Leds skipped by RGB_MATRIX_TEST_LED_FLAGS() leave stale slots, they are converted but never set
+void rgb_matrix_set_hsv_batch(effect_params_t *params, uint8_t led_min, uint8_t led_max) {
+    RGB rgb[8];
+    for (uint8_t base = led_min; base < led_max; base += 8) {
+        uint8_t count = led_max - base < 8 ? led_max - base : 8;
+        rgb_matrix_hsv_to_rgb_batch(&g_rgb_hsv_batch[base - led_min], rgb, count);
+        // Hand each run of leds matching the flags to the driver at once
+        uint8_t run = 0;
+        for (uint8_t j = 0; j <= count; j++) {
+            if (j < count && HAS_ANY_FLAGS(g_led_config.flags[base + j], params->flags)) {
+                run++;
+                continue;
+            }
+            if (run) {
+                rgb_matrix_set_color_span(base + j - run, &rgb[j - run], run);
+            }
+            run = 0;
+        }
+    }
+}
+#endif  // RGB_MATRIX_HSV_BATCH
+
 // Generic effect runners
 #include "rgb_matrix_runners/effect_runner_dx_dy_dist.h"
 #include "rgb_matrix_runners/effect_runner_dx_dy.h"
+#include "rgb_matrix_runners/effect_runner_angle.h"
+#include "rgb_matrix_runners/effect_runner_angle_dist.h"
 #include "rgb_matrix_runners/effect_runner_i.h"
 #include "rgb_matrix_runners/effect_runner_sin_cos_i.h"
 #include "rgb_matrix_runners/effect_runner_reactive.h"
@@ -76,6 +120,18 @@ __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv
 #    define RGB_MATRIX_MAXIMUM_BRIGHTNESS UINT8_MAX
 #endif
 
+#ifdef RGB_MATRIX_OUTPUT_LUT
+#    ifndef RGB_MATRIX_OUTPUT_GAMMA
+#        define RGB_MATRIX_OUTPUT_GAMMA 10
+#    endif
+#    ifndef RGB_MATRIX_OUTPUT_LIMIT
+#        define RGB_MATRIX_OUTPUT_LIMIT UINT8_MAX
+#    endif
+#    ifndef RGB_MATRIX_WHITE_BALANCE
+#        define RGB_MATRIX_WHITE_BALANCE { UINT8_MAX, UINT8_MAX, UINT8_MAX }
+#    endif
+#endif
+
 #if !defined(RGB_MATRIX_HUE_STEP)
 #    define RGB_MATRIX_HUE_STEP 8
 #endif
@@ -117,16 +173,62 @@ __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv
 #    define RGB_MATRIX_STARTUP_SPD UINT8_MAX / 2
 #endif
 
+#ifdef RGB_MATRIX_RENDER_THREAD
+#    ifndef PROTOCOL_CHIBIOS
+#        error "RGB_MATRIX_RENDER_THREAD is only supported on ChibiOS"
+#    endif
+#    include <ch.h>
+#    ifndef RGB_MATRIX_THREAD_PRIORITY
+#        define RGB_MATRIX_THREAD_PRIORITY (NORMALPRIO + 1)
+#    endif
+#    ifndef RGB_MATRIX_THREAD_STACK_SIZE
+#        define RGB_MATRIX_THREAD_STACK_SIZE 512
+#    endif
+#    ifndef RGB_MATRIX_HIT_QUEUE_SIZE
+#        define RGB_MATRIX_HIT_QUEUE_SIZE 16
+#    endif
+#endif
+
+#ifdef RGB_MATRIX_STATS
+#    ifdef PROTOCOL_CHIBIOS
+#        include <ch.h>
+typedef systime_t rgb_stats_time_t;
+#        define rgb_stats_now() chVTGetSystemTimeX()
+#        define rgb_stats_elapsed_us(start) TIME_I2US(chVTTimeElapsedSinceX(start))
+#    else
+typedef uint16_t rgb_stats_time_t;
+#        define rgb_stats_now() timer_read()
+#        define rgb_stats_elapsed_us(start) ((uint32_t)timer_elapsed(start) * 1000)
+#    endif
+#endif
+
 // globals
 bool         g_suspend_state = false;
 rgb_config_t rgb_matrix_config;  // TODO: would like to prefix this with g_ for global consistancy, do this in another pr
 uint32_t     g_rgb_timer;
 #ifdef RGB_MATRIX_FRAMEBUFFER_EFFECTS
-uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS] = {{0}};
+uint8_t g_rgb_frame_buffer[DRIVER_LED_TOTAL] = {0};
 #endif  // RGB_MATRIX_FRAMEBUFFER_EFFECTS
+#ifdef RGB_MATRIX_DIRECT_ENABLE
+RGB g_rgb_direct_frame[DRIVER_LED_TOTAL] = {0};
+#endif  // RGB_MATRIX_DIRECT_ENABLE
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+#    if LED_HITS_TO_REMEMBER > UINT8_MAX
+#        error "LED_HITS_TO_REMEMBER must not be larger than 255"
+#    endif
 last_hit_t g_last_hit_tracker;
+uint16_t   g_led_hit_time[DRIVER_LED_TOTAL];
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
+#ifdef RGB_MATRIX_STATS
+#    if RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
+#        define RGB_MATRIX_PROCESS_LIMIT_MIN (RGB_MATRIX_LED_PROCESS_LIMIT)
+#    else
+#        define RGB_MATRIX_PROCESS_LIMIT_MIN DRIVER_LED_TOTAL
+#    endif
+#endif  // RGB_MATRIX_STATS
+#ifdef RGB_MATRIX_TARGET_FPS
+uint8_t g_rgb_process_limit = RGB_MATRIX_PROCESS_LIMIT_MIN;
+#endif  // RGB_MATRIX_TARGET_FPS
 
 // internals
 static uint8_t         rgb_last_enable   = UINT8_MAX;
@@ -140,7 +242,21 @@ static uint32_t rgb_anykey_timer;
 // double buffers
 static uint32_t rgb_timer_buffer;
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
-static last_hit_t last_hit_buffer;
+// Ring of the last hits, oldest first from head, stamped with the 16 bit time they happened.
+// A full ring overwrites its oldest hit.
+static struct {
+    uint8_t  head;
+    uint8_t  count;
+    uint8_t  x[LED_HITS_TO_REMEMBER];
+    uint8_t  y[LED_HITS_TO_REMEMBER];
+    uint8_t  index[LED_HITS_TO_REMEMBER];
+    uint16_t time[LED_HITS_TO_REMEMBER];
+} last_hit_buffer;
+
+// Stamps are clamped to this age every RGB_HIT_SWEEP_INTERVAL ms, so none of them can wrap around
+#    define RGB_HIT_SWEEP_INTERVAL 1024
+#    define RGB_HIT_MAX_AGE (UINT16_MAX - RGB_HIT_SWEEP_INTERVAL)
+static uint16_t last_hit_sweep;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 
 void eeconfig_read_rgb_matrix(void) { eeprom_read_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
@@ -168,7 +284,7 @@ void eeconfig_debug_rgb_matrix(void) {
 
 __attribute__((weak)) uint8_t rgb_matrix_map_row_column_to_led_kb(uint8_t row, uint8_t column, uint8_t *led_i) { return 0; }
 
-uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *led_i) {
+static uint8_t rgb_matrix_find_key_leds(uint8_t row, uint8_t column, uint8_t *led_i) {
     uint8_t led_count = rgb_matrix_map_row_column_to_led_kb(row, column, led_i);
     uint8_t led_index = g_led_config.matrix_co[row][column];
     if (led_index != NO_LED) {
@@ -178,23 +294,290 @@ uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
     return led_count;
 }
 
+uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *led_i) {
+#ifdef RGB_MATRIX_KEY_LED_CACHE
+    const key_leds_t *key = &g_rgb_key_leds[row][column];
+    memcpy(led_i, &g_rgb_key_led_list[key->first], key->count);
+    return key->count;
+#else
+    return rgb_matrix_find_key_leds(row, column, led_i);
+#endif
+}
+
+#ifdef RGB_MATRIX_KEY_LED_CACHE
+// Call again if g_led_config or rgb_matrix_map_row_column_to_led_kb() change at runtime
+void rgb_matrix_update_key_leds(void) {
+    uint8_t used = 0;
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            uint8_t led[LED_HITS_TO_REMEMBER];
+            uint8_t count = rgb_matrix_find_key_leds(row, col, led);
+            if (count > RGB_MATRIX_KEY_LED_LIST_SIZE - used) {
+                dprintf("rgb_matrix_update_key_leds: RGB_MATRIX_KEY_LED_LIST_SIZE is too small\n");
+                count = RGB_MATRIX_KEY_LED_LIST_SIZE - used;
+            }
+
+            key_leds_t *key = &g_rgb_key_leds[row][col];
+            key->first      = used;
+            key->count      = count;
+            key->flags      = LED_FLAG_NONE;
+            for (uint8_t i = 0; i < count; i++) {
+                g_rgb_key_led_list[used++] = led[i];
+                key->flags |= g_led_config.flags[led[i]];
+            }
+        }
+    }
+}
+#endif  // RGB_MATRIX_KEY_LED_CACHE
+
 void rgb_matrix_update_pwm_buffers(void) { rgb_matrix_driver.flush(); }
 
-void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) { rgb_matrix_driver.set_color(index, red, green, blue); }
+// Set when whatever shares the driver with rgb_matrix changed its part of the frame
+static volatile bool rgb_flush_pending = false;
+
+void rgb_matrix_request_flush(void) { rgb_flush_pending = true; }
+
+#ifdef RGB_MATRIX_EFFECT_LAYERS
+typedef struct {
+    uint8_t         mode;  // RGB_MATRIX_NONE while the layer is unused
+    uint8_t         alpha;
+    const uint8_t * mask;  // one bit per led, NULL for every led
+    effect_params_t params;
+    bool            lit;   // drew a led during its current frame
+    bool            idle;  // a reactive effect that drew nothing, skipped until the next key hit
+} rgb_effect_layer_t;
+
+static rgb_effect_layer_t  rgb_effect_layers[RGB_MATRIX_EFFECT_LAYERS];
+static RGB                 rgb_compose_frame[DRIVER_LED_TOTAL];
+static bool                rgb_composing     = false;  // the set_color functions draw into rgb_compose_frame
+static rgb_effect_layer_t *rgb_drawing_layer = NULL;   // blended onto rgb_compose_frame, NULL while the base effect draws
+
+static void rgb_compose_set_color(uint8_t index, uint8_t red, uint8_t green, uint8_t blue) {
+    RGB *               led   = &rgb_compose_frame[index];
+    rgb_effect_layer_t *layer = rgb_drawing_layer;
+    if (layer) {
+        // A layer's black leds, and the ones outside its mask, show what is below
+        if (!(red | green | blue) || (layer->mask && !(layer->mask[index / 8] & (1 << (index % 8))))) {
+            return;
+        }
+        layer->lit = true;
+        if (layer->alpha < UINT8_MAX) {
+            red   = lerp8by8(led->r, red, layer->alpha);
+            green = lerp8by8(led->g, green, layer->alpha);
+            blue  = lerp8by8(led->b, blue, layer->alpha);
+        }
+    }
+    led->r = red;
+    led->g = green;
+    led->b = blue;
+}
+#endif  // RGB_MATRIX_EFFECT_LAYERS
+
+#ifdef RGB_MATRIX_OUTPUT_LUT
+static rgb_matrix_output_t rgb_output = {RGB_MATRIX_OUTPUT_GAMMA, RGB_MATRIX_OUTPUT_LIMIT, RGB_MATRIX_WHITE_BALANCE};
+// What the drivers get for each value of each channel, rebuilt only when rgb_output changes
+static uint8_t rgb_output_lut[3][256];
+
+#    define rgb_output_r(value) rgb_output_lut[0][value]
+#    define rgb_output_g(value) rgb_output_lut[1][value]
+#    define rgb_output_b(value) rgb_output_lut[2][value]
+
+static void rgb_output_lut_update(void) {
+    float gamma = rgb_output.gamma / 10.0f;
+    for (uint16_t value = 0; value < 256; value++) {
+        uint16_t level = (uint16_t)(powf(value / 255.0f, gamma) * rgb_output.limit + 0.5f);
+        for (uint8_t channel = 0; channel < 3; channel++) {
+            rgb_output_lut[channel][value] = level * rgb_output.white_balance[channel] / UINT8_MAX;
+        }
+    }
+}
 
-void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) { rgb_matrix_driver.set_color_all(red, green, blue); }
+void rgb_matrix_set_output(const rgb_matrix_output_t *output) {
+    if (memcmp(output, &rgb_output, sizeof(rgb_output)) == 0) {
+        return;
+    }
+    rgb_output = *output;
+    rgb_output_lut_update();
+#    ifdef RGB_MATRIX_SKIP_STATIC_FRAMES
+    rgb_matrix_redraw();
+#    endif
+}
 
-void process_rgb_matrix(uint8_t row, uint8_t col, bool pressed) {
-#ifndef RGB_MATRIX_SPLIT
-    if (!is_keyboard_master()) return;
+const rgb_matrix_output_t *rgb_matrix_get_output(void) { return &rgb_output; }
+#else
+#    define rgb_output_r(value) (value)
+#    define rgb_output_g(value) (value)
+#    define rgb_output_b(value) (value)
+#endif  // RGB_MATRIX_OUTPUT_LUT
+
+void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+#ifdef RGB_MATRIX_EFFECT_LAYERS
+    if (rgb_composing) {
+        rgb_compose_set_color(index, red, green, blue);
+        return;
+    }
+#endif
+    rgb_matrix_driver.set_color(index, rgb_output_r(red), rgb_output_g(green), rgb_output_b(blue));
+}
+
+void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
+#ifdef RGB_MATRIX_EFFECT_LAYERS
+    if (rgb_composing) {
+        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+            rgb_compose_set_color(i, red, green, blue);
+        }
+        return;
+    }
+#endif
+    rgb_matrix_driver.set_color_all(rgb_output_r(red), rgb_output_g(green), rgb_output_b(blue));
+}
+
+void rgb_matrix_set_color_span(uint8_t start, const RGB *colors, uint8_t count) {
+#ifdef RGB_MATRIX_EFFECT_LAYERS
+    if (rgb_composing) {
+        for (uint8_t i = 0; i < count; i++) {
+            rgb_compose_set_color(start + i, colors[i].r, colors[i].g, colors[i].b);
+        }
+        return;
+    }
+#endif
+    const rgb_matrix_framebuffer_t *fb = rgb_matrix_driver.framebuffer;
+    if (!fb) {
+        for (uint8_t i = 0; i < count; i++) {
+            rgb_matrix_driver.set_color(start + i, rgb_output_r(colors[i].r), rgb_output_g(colors[i].g), rgb_output_b(colors[i].b));
+        }
+        return;
+    }
+
+    uint8_t *led = fb->leds + start * fb->stride;
+#ifndef RGB_MATRIX_OUTPUT_LUT
+    if (fb->stride == sizeof(RGB) && fb->r == offsetof(RGB, r) && fb->g == offsetof(RGB, g) && fb->b == offsetof(RGB, b)) {
+        memcpy(led, colors, count * sizeof(RGB));
+        return;
+    }
 #endif
+    for (uint8_t i = 0; i < count; i++, led += fb->stride) {
+        led[fb->r] = rgb_output_r(colors[i].r);
+        led[fb->g] = rgb_output_g(colors[i].g);
+        led[fb->b] = rgb_output_b(colors[i].b);
+    }
+}
+
+#ifdef RGB_MATRIX_DIRECT_ENABLE
+#    ifndef RGB_MATRIX_DIRECT_TIMEOUT
+#        define RGB_MATRIX_DIRECT_TIMEOUT 1000
+#    endif
+
+// The host builds the next frame here while the effect shows g_rgb_direct_frame. It keeps the
+// whole frame, so that a packet only needs to carry the leds that changed since the last one.
+static RGB           rgb_direct_back[DRIVER_LED_TOTAL];
+static volatile bool rgb_direct_committed = false;
+static bool          rgb_direct_active    = false;
+static uint8_t       rgb_direct_fallback;  // the effect to go back to once the host goes quiet
+static uint32_t      rgb_direct_last;
+
+void rgb_matrix_direct_present(void) {
+    if (rgb_direct_committed) {
+        memcpy(g_rgb_direct_frame, rgb_direct_back, sizeof(g_rgb_direct_frame));
+        rgb_direct_committed = false;
+    }
+}
+
+bool rgb_matrix_direct_receive(const uint8_t *data, uint8_t length) {
+    if (length < 3) {
+        return false;
+    }
+    uint8_t        flags = data[0];
+    uint8_t        led   = data[1];
+    uint8_t        count = data[2];
+    const uint8_t *color = &data[3];
+    const uint8_t *end   = data + length;
+
+    if (led > DRIVER_LED_TOTAL || count > DRIVER_LED_TOTAL - led) {
+        return false;
+    }
+    // A frame the effect hasn't picked up yet goes out before this packet changes it, or the
+    // effect could show half of the next one
+    if (count) {
+        rgb_matrix_direct_present();
+    }
+
+    if (flags & RGB_MATRIX_DIRECT_RLE) {
+        while (count) {
+            if (color >= end) {
+                return false;
+            }
+            uint8_t run = *color & 0x7F;
+            if (run == 0 || run > count) {
+                return false;
+            }
+            if (*color++ & 0x80) {
+                led += run;
+                count -= run;
+                continue;
+            }
+            if (end - color < 3) {
+                return false;
+            }
+            RGB rgb = {.r = color[0], .g = color[1], .b = color[2]};
+            color += 3;
+            count -= run;
+            while (run--) {
+                rgb_direct_back[led++] = rgb;
+            }
+        }
+    } else {
+        if (end - color < count * 3) {
+            return false;
+        }
+        // RGB follows WS2812_BYTE_ORDER, the wire is always r, g, b
+        for (; count; count--, color += 3) {
+            rgb_direct_back[led++] = (RGB){.r = color[0], .g = color[1], .b = color[2]};
+        }
+    }
+
+    rgb_direct_last = timer_read32();
+    if (!rgb_direct_active) {
+        // Once the host is streaming, switching to another effect sticks until it stops
+        rgb_direct_active   = true;
+        rgb_direct_fallback = rgb_matrix_config.mode;
+        rgb_matrix_mode_noeeprom(RGB_MATRIX_DIRECT);
+    }
+    if (flags & RGB_MATRIX_DIRECT_COMMIT) {
+        rgb_direct_committed = true;
+        rgb_matrix_request_flush();
+    }
+    return true;
+}
+
+// Goes back to the effect from before the host took over, after RGB_MATRIX_DIRECT_TIMEOUT ms without a packet
+static void rgb_direct_timeout(void) {
+    if (rgb_direct_active && timer_elapsed32(rgb_direct_last) > RGB_MATRIX_DIRECT_TIMEOUT) {
+        rgb_direct_active = false;
+        if (rgb_matrix_config.mode == RGB_MATRIX_DIRECT) {
+            rgb_matrix_mode_noeeprom(rgb_direct_fallback);
+        }
+    }
+}
+#endif  // RGB_MATRIX_DIRECT_ENABLE
+
+static void rgb_matrix_handle_hit(uint8_t row, uint8_t col, bool pressed) {
 #if RGB_DISABLE_TIMEOUT > 0
     rgb_anykey_timer = 0;
 #endif  // RGB_DISABLE_TIMEOUT > 0
+#ifdef RGB_MATRIX_SKIP_STATIC_FRAMES
+    rgb_matrix_redraw();
+#endif  // RGB_MATRIX_SKIP_STATIC_FRAMES
+#ifdef RGB_MATRIX_EFFECT_LAYERS
+    for (uint8_t i = 0; i < RGB_MATRIX_EFFECT_LAYERS; i++) {
+        rgb_effect_layers[i].idle = false;
+    }
+#endif  // RGB_MATRIX_EFFECT_LAYERS
 
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
-    uint8_t led[LED_HITS_TO_REMEMBER];
-    uint8_t led_count = 0;
+    uint8_t        led_buffer[LED_HITS_TO_REMEMBER];
+    const uint8_t *led       = led_buffer;
+    uint8_t        led_count = 0;
 
 #    if defined(RGB_MATRIX_KEYRELEASES)
     if (!pressed)
@@ -202,24 +585,32 @@ void process_rgb_matrix(uint8_t row, uint8_t col, bool pressed) {
     if (pressed)
 #    endif  // defined(RGB_MATRIX_KEYRELEASES)
     {
-        led_count = rgb_matrix_map_row_column_to_led(row, col, led);
-    }
-
-    if (last_hit_buffer.count + led_count > LED_HITS_TO_REMEMBER) {
-        memcpy(&last_hit_buffer.x[0], &last_hit_buffer.x[led_count], LED_HITS_TO_REMEMBER - led_count);
-        memcpy(&last_hit_buffer.y[0], &last_hit_buffer.y[led_count], LED_HITS_TO_REMEMBER - led_count);
-        memcpy(&last_hit_buffer.tick[0], &last_hit_buffer.tick[led_count], (LED_HITS_TO_REMEMBER - led_count) * 2);  // 16 bit
-        memcpy(&last_hit_buffer.index[0], &last_hit_buffer.index[led_count], LED_HITS_TO_REMEMBER - led_count);
-        last_hit_buffer.count--;
+#    ifdef RGB_MATRIX_KEY_LED_CACHE
+        led       = &g_rgb_key_led_list[g_rgb_key_leds[row][col].first];
+        led_count = g_rgb_key_leds[row][col].count;
+#    else
+        led_count = rgb_matrix_map_row_column_to_led(row, col, led_buffer);
+#    endif
     }
 
+    uint16_t now = sync_timer_read32();
     for (uint8_t i = 0; i < led_count; i++) {
-        uint8_t index                = last_hit_buffer.count;
-        last_hit_buffer.x[index]     = g_led_config.point[led[i]].x;
-        last_hit_buffer.y[index]     = g_led_config.point[led[i]].y;
-        last_hit_buffer.index[index] = led[i];
-        last_hit_buffer.tick[index]  = 0;
-        last_hit_buffer.count++;
+        uint8_t slot;
+        if (last_hit_buffer.count < LED_HITS_TO_REMEMBER) {
+            slot = last_hit_buffer.head + last_hit_buffer.count;
+            last_hit_buffer.count++;
+        } else {
+            slot = last_hit_buffer.head;
+            last_hit_buffer.head++;
+            if (last_hit_buffer.head >= LED_HITS_TO_REMEMBER) last_hit_buffer.head = 0;
+        }
+        if (slot >= LED_HITS_TO_REMEMBER) slot -= LED_HITS_TO_REMEMBER;
+
+        last_hit_buffer.x[slot]     = g_led_config.point[led[i]].x;
+        last_hit_buffer.y[slot]     = g_led_config.point[led[i]].y;
+        last_hit_buffer.index[slot] = led[i];
+        last_hit_buffer.time[slot]  = now;
+        g_led_hit_time[led[i]]      = now;
     }
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 
@@ -230,6 +621,86 @@ void process_rgb_matrix(uint8_t row, uint8_t col, bool pressed) {
 #endif  // defined(RGB_MATRIX_FRAMEBUFFER_EFFECTS) && !defined(DISABLE_RGB_MATRIX_TYPING_HEATMAP)
 }
 
+#ifdef RGB_MATRIX_RENDER_THREAD
+// Switch events from the main loop to the render thread
+typedef struct {
+    uint8_t row;
+    uint8_t col;
+    bool    pressed;
+} rgb_hit_t;
+
+SPSC_QUEUE(rgb_hit_queue, rgb_hit_t, RGB_MATRIX_HIT_QUEUE_SIZE)
+
+static void rgb_hit_queue_drain(void) {
+    rgb_hit_t hit;
+    while (rgb_hit_queue_pop(&hit)) {
+        rgb_matrix_handle_hit(hit.row, hit.col, hit.pressed);
+    }
+}
+#endif  // RGB_MATRIX_RENDER_THREAD
+
+static void rgb_matrix_queue_hit(uint8_t row, uint8_t col, bool pressed) {
+#ifdef RGB_MATRIX_RENDER_THREAD
+    // Dropped when full, rather than waiting for the renderer
+    rgb_hit_queue_push(&(rgb_hit_t){row, col, pressed});
+#else
+    rgb_matrix_handle_hit(row, col, pressed);
+#endif
+}
+
+#ifdef RGB_MATRIX_SPLIT_SYNC
+// Hits and config the slave has not acknowledged yet
+static rgb_matrix_split_hit_t rgb_split_hits[RGB_MATRIX_SPLIT_HITS];
+static uint8_t                rgb_split_hit_count = 0;
+static rgb_config_t           rgb_split_config_sent;
+static bool                   rgb_split_config_valid = false;
+
+static void rgb_matrix_split_hit_push(uint8_t row, uint8_t col, bool pressed) {
+    if (rgb_split_hit_count >= RGB_MATRIX_SPLIT_HITS) {
+        return;  // the slave misses this one rather than the master stalling on the transport
+    }
+    rgb_matrix_split_hit_t hit = (rgb_matrix_split_hit_t)(row * MATRIX_COLS + col);
+    if (pressed) hit |= RGB_MATRIX_SPLIT_HIT_PRESSED;
+    rgb_split_hits[rgb_split_hit_count++] = hit;
+}
+
+bool rgb_matrix_get_sync_pending(void) { return rgb_split_hit_count || !rgb_split_config_valid || memcmp(&rgb_split_config_sent, &rgb_matrix_config, sizeof(rgb_config_t)) != 0; }
+
+void rgb_matrix_get_syncinfo(rgb_matrix_syncinfo_t *syncinfo) {
+    syncinfo->config    = rgb_matrix_config;
+    syncinfo->hit_count = rgb_split_hit_count;
+    memcpy(syncinfo->hits, rgb_split_hits, rgb_split_hit_count * sizeof(rgb_matrix_split_hit_t));
+}
+
+void rgb_matrix_clear_sync_pending(const rgb_matrix_syncinfo_t *syncinfo) {
+    // Hits queued while the transfer was in flight stay for the next one
+    uint8_t sent = syncinfo->hit_count;
+    rgb_split_hit_count -= sent;
+    memmove(rgb_split_hits, &rgb_split_hits[sent], rgb_split_hit_count * sizeof(rgb_matrix_split_hit_t));
+    rgb_split_config_sent  = syncinfo->config;
+    rgb_split_config_valid = true;
+}
+
+void rgb_matrix_update_sync(const rgb_matrix_syncinfo_t *syncinfo) {
+    rgb_matrix_config = syncinfo->config;
+    for (uint8_t i = 0; i < syncinfo->hit_count && i < RGB_MATRIX_SPLIT_HITS; i++) {
+        rgb_matrix_split_hit_t hit = syncinfo->hits[i] & ~RGB_MATRIX_SPLIT_HIT_PRESSED;
+        rgb_matrix_queue_hit(hit / MATRIX_COLS, hit % MATRIX_COLS, syncinfo->hits[i] & RGB_MATRIX_SPLIT_HIT_PRESSED);
+    }
+}
+#endif  // RGB_MATRIX_SPLIT_SYNC
+
+void process_rgb_matrix(uint8_t row, uint8_t col, bool pressed) {
+#ifndef RGB_MATRIX_SPLIT
+    if (!is_keyboard_master()) return;
+#elif defined(RGB_MATRIX_SPLIT_SYNC)
+    // The slave gets every hit, from both halves, through rgb_matrix_update_sync()
+    if (!is_keyboard_master()) return;
+    rgb_matrix_split_hit_push(row, col, pressed);
+#endif
+    rgb_matrix_queue_hit(row, col, pressed);
+}
+
 void rgb_matrix_test(void) {
     // Mask out bits 4 and 5
     // Increase the factor to make the test animation slower (and reduce to make it faster)
@@ -264,9 +735,9 @@ static bool rgb_matrix_none(effect_params_t *params) {
 }
 
 static void rgb_task_timers(void) {
-#if defined(RGB_MATRIX_KEYREACTIVE_ENABLED) || RGB_DISABLE_TIMEOUT > 0
+#if RGB_DISABLE_TIMEOUT > 0
     uint32_t deltaTime = sync_timer_elapsed32(rgb_timer_buffer);
-#endif  // defined(RGB_MATRIX_KEYREACTIVE_ENABLED) || RGB_DISABLE_TIMEOUT > 0
+#endif  // RGB_DISABLE_TIMEOUT > 0
     rgb_timer_buffer = sync_timer_read32();
 
     // Update double buffer timers
@@ -280,24 +751,242 @@ static void rgb_task_timers(void) {
     }
 #endif  // RGB_DISABLE_TIMEOUT > 0
 
-    // Update double buffer last hit timers
+    // Expire old hits and clamp the per led stamps, instead of aging every hit on every call
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
-    uint8_t count = last_hit_buffer.count;
-    for (uint8_t i = 0; i < count; ++i) {
-        if (UINT16_MAX - deltaTime < last_hit_buffer.tick[i]) {
+    uint16_t now = rgb_timer_buffer;
+    if ((uint16_t)(now - last_hit_sweep) >= RGB_HIT_SWEEP_INTERVAL) {
+        last_hit_sweep = now;
+        while (last_hit_buffer.count && (uint16_t)(now - last_hit_buffer.time[last_hit_buffer.head]) > RGB_HIT_MAX_AGE) {
             last_hit_buffer.count--;
-            continue;
+            last_hit_buffer.head++;
+            if (last_hit_buffer.head >= LED_HITS_TO_REMEMBER) last_hit_buffer.head = 0;
+        }
+        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+            if ((uint16_t)(now - g_led_hit_time[i]) > RGB_HIT_MAX_AGE) {
+                g_led_hit_time[i] = now - RGB_HIT_MAX_AGE;
+            }
         }
-        last_hit_buffer.tick[i] += deltaTime;
     }
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
+
+#ifdef RGB_MATRIX_DIRECT_ENABLE
+    rgb_direct_timeout();
+#endif  // RGB_MATRIX_DIRECT_ENABLE
+}
+
+#ifdef RGB_MATRIX_STATS
+static rgb_matrix_stats_t rgb_stats;
+static uint32_t           rgb_stats_render_us;
+static uint16_t           rgb_stats_frames;
+static uint16_t           rgb_stats_frame_max_ms;
+static uint16_t           rgb_stats_second;
+
+const rgb_matrix_stats_t *rgb_matrix_get_stats(void) { return &rgb_stats; }
+
+void rgb_matrix_reset_stats(void) {
+    rgb_stats.render_max_us = 0;
+    rgb_stats.flush_max_us  = 0;
+}
+
+void rgb_matrix_print_stats(void) { uprintf("rgb_matrix: %u fps, render %u us (max %u), flush %u us (max %u), limit %u\n", rgb_stats.fps, rgb_stats.render_us, rgb_stats.render_max_us, rgb_stats.flush_us, rgb_stats.flush_max_us, rgb_stats.process_limit); }
+
+static inline uint16_t rgb_stats_clamp(uint32_t us) { return us > UINT16_MAX ? UINT16_MAX : us; }
+
+#    ifdef RGB_MATRIX_TARGET_FPS
+// Frames are only started on whole milliseconds, so allow for some slack below the target
+#        define RGB_MATRIX_TARGET_FPS_MIN (RGB_MATRIX_TARGET_FPS - RGB_MATRIX_TARGET_FPS / 8)
+
+// Render more leds per iteration while frames come too slowly, and fewer
+// while they are done well within their period, to keep the main loop free
+static void rgb_stats_adapt_limit(void) {
+    if (rgb_stats.fps < RGB_MATRIX_TARGET_FPS_MIN && g_rgb_process_limit < DRIVER_LED_TOTAL) {
+        uint8_t step        = (g_rgb_process_limit + 3) / 4;
+        g_rgb_process_limit = DRIVER_LED_TOTAL - g_rgb_process_limit > step ? g_rgb_process_limit + step : DRIVER_LED_TOTAL;
+    } else if (rgb_stats.fps >= RGB_MATRIX_TARGET_FPS_MIN && rgb_stats_frame_max_ms < (1000 / RGB_MATRIX_TARGET_FPS) * 3 / 4 && g_rgb_process_limit > RGB_MATRIX_PROCESS_LIMIT_MIN) {
+        g_rgb_process_limit--;
+    }
+}
+#    endif
+
+// Called once per frame, after its flush
+static void rgb_stats_frame(uint32_t flush_us) {
+    rgb_stats.render_us = rgb_stats_clamp(rgb_stats_render_us);
+    rgb_stats.flush_us  = rgb_stats_clamp(flush_us);
+    if (rgb_stats.render_us > rgb_stats.render_max_us) rgb_stats.render_max_us = rgb_stats.render_us;
+    if (rgb_stats.flush_us > rgb_stats.flush_max_us) rgb_stats.flush_max_us = rgb_stats.flush_us;
+    rgb_stats_render_us = 0;
+
+    uint16_t frame_ms = sync_timer_elapsed32(g_rgb_timer);
+    if (frame_ms > rgb_stats_frame_max_ms) rgb_stats_frame_max_ms = frame_ms;
+
+    rgb_stats_frames++;
+    uint16_t elapsed = timer_elapsed(rgb_stats_second);
+    if (elapsed >= 1000) {
+        rgb_stats.fps = (uint32_t)rgb_stats_frames * 1000 / elapsed;
+#    ifdef RGB_MATRIX_TARGET_FPS
+        rgb_stats_adapt_limit();
+#    endif
+#    ifdef RGB_MATRIX_TARGET_FPS
+        rgb_stats.process_limit = g_rgb_process_limit;
+#    else
+        rgb_stats.process_limit = RGB_MATRIX_PROCESS_LIMIT_MIN;
+#    endif
+        rgb_stats_frames        = 0;
+        rgb_stats_frame_max_ms  = 0;
+        rgb_stats_second        = timer_read();
+    }
 }
+#endif  // RGB_MATRIX_STATS
+
+#ifdef RGB_MATRIX_SKIP_STATIC_FRAMES
+// Everything besides the time that a static effect or the indicators may draw from
+typedef struct {
+    rgb_config_t  config;
+    uint8_t       effect;
+    led_flags_t   flags;
+    uint8_t       host_leds;
+    uint8_t       mods;
+    layer_state_t layers;
+} rgb_frame_inputs_t;
+
+static rgb_frame_inputs_t rgb_frame_inputs;
+static volatile bool      rgb_frame_dirty = true;
 
-static void rgb_task_sync(void) {
+__attribute__((weak)) bool rgb_matrix_effect_is_static_user(uint8_t mode) { return false; }
+
+__attribute__((weak)) bool rgb_matrix_effect_is_static_kb(uint8_t mode) { return rgb_matrix_effect_is_static_user(mode); }
+
+// Effects whose frames only depend on rgb_frame_inputs_t
+static bool rgb_matrix_effect_is_static(uint8_t effect) {
+    switch (effect) {
+        case RGB_MATRIX_NONE:
+#    ifndef DISABLE_RGB_MATRIX_SOLID_COLOR
+        case RGB_MATRIX_SOLID_COLOR:
+#    endif
+#    ifndef DISABLE_RGB_MATRIX_ALPHAS_MODS
+        case RGB_MATRIX_ALPHAS_MODS:
+#    endif
+#    ifndef DISABLE_RGB_MATRIX_GRADIENT_UP_DOWN
+        case RGB_MATRIX_GRADIENT_UP_DOWN:
+#    endif
+#    ifndef DISABLE_RGB_MATRIX_GRADIENT_LEFT_RIGHT
+        case RGB_MATRIX_GRADIENT_LEFT_RIGHT:
+#    endif
+#    ifdef RGB_MATRIX_DIRECT_ENABLE
+        // A committed frame requests a flush
+        case RGB_MATRIX_DIRECT:
+#    endif
+            return true;
+        default:
+            return rgb_matrix_effect_is_static_kb(effect);
+    }
+}
+
+void rgb_matrix_redraw(void) { rgb_frame_dirty = true; }
+
+static bool rgb_frame_is_static(uint8_t effect) {
+    if (!rgb_matrix_effect_is_static(effect)) {
+        return false;
+    }
+#    ifdef RGB_MATRIX_EFFECT_LAYERS
+    for (uint8_t i = 0; i < RGB_MATRIX_EFFECT_LAYERS; i++) {
+        const rgb_effect_layer_t *layer = &rgb_effect_layers[i];
+        if (effect != RGB_MATRIX_NONE && layer->mode != RGB_MATRIX_NONE && !layer->idle && !rgb_matrix_effect_is_static(layer->mode)) {
+            return false;
+        }
+    }
+#    endif
+    return true;
+}
+
+static bool rgb_frame_changed(uint8_t effect) {
+    rgb_frame_inputs_t inputs;
+    memset(&inputs, 0, sizeof(inputs));
+    inputs.config    = rgb_matrix_config;
+    inputs.effect    = effect;
+    inputs.flags     = rgb_effect_params.flags;
+    inputs.host_leds = host_keyboard_leds();
+    inputs.mods      = get_mods();
+    inputs.layers    = layer_state | default_layer_state;
+
+    bool changed     = rgb_frame_dirty || !rgb_frame_is_static(effect) || memcmp(&inputs, &rgb_frame_inputs, sizeof(inputs)) != 0;
+    rgb_frame_inputs = inputs;
+    rgb_frame_dirty  = false;
+    return changed;
+}
+#endif  // RGB_MATRIX_SKIP_STATIC_FRAMES
+
+static void rgb_task_sync(uint8_t effect) {
     // next task
-    if (sync_timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
+#ifdef RGB_MATRIX_TARGET_FPS
+    if (sync_timer_elapsed32(g_rgb_timer) < 1000 / RGB_MATRIX_TARGET_FPS) return;
+#else
+    if (sync_timer_elapsed32(g_rgb_timer) < RGB_MATRIX_LED_FLUSH_LIMIT) return;
+#endif
+#ifdef RGB_MATRIX_SKIP_STATIC_FRAMES
+    if (!rgb_frame_changed(effect) && !rgb_flush_pending) {
+#    ifdef RGB_MATRIX_STATS
+        // An idle stretch doesn't count against the frame rate
+        rgb_stats_frames = 0;
+        rgb_stats_second = timer_read();
+#    endif
+        return;
+    }
+#endif
+    rgb_task_state = STARTING;
 }
 
+#ifdef RGB_MATRIX_LAYER_COLORS
+/* The keys lit on the highest active layer, only worked out again when the
+ * layer or the keymap changes rather than looked up for every frame */
+static RGB     layer_led_colors[DRIVER_LED_TOTAL];
+static uint8_t layer_led_mask[(DRIVER_LED_TOTAL + 7) / 8];
+static uint8_t layer_leds_layer = UINT8_MAX;  // UINT8_MAX when out of date
+
+__attribute__((weak)) bool rgb_matrix_layer_key_color_user(uint8_t layer, uint16_t keycode, RGB *rgb) { return false; }
+
+__attribute__((weak)) bool rgb_matrix_layer_key_color_kb(uint8_t layer, uint16_t keycode, RGB *rgb) { return rgb_matrix_layer_key_color_user(layer, keycode, rgb); }
+
+void rgb_matrix_layer_colors_refresh(void) {
+    layer_leds_layer = UINT8_MAX;
+#    ifdef RGB_MATRIX_SKIP_STATIC_FRAMES
+    rgb_matrix_redraw();
+#    endif
+}
+
+static void rgb_matrix_layer_colors_update(void) {
+    uint8_t layer = get_highest_layer(layer_state | default_layer_state);
+    if (layer == layer_leds_layer) {
+        return;
+    }
+    layer_leds_layer = layer;
+    memset(layer_led_mask, 0, sizeof(layer_led_mask));
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            uint8_t led = g_led_config.matrix_co[row][col];
+            RGB     rgb;
+            if (led == NO_LED || !rgb_matrix_layer_key_color_kb(layer, keymap_key_to_keycode(layer, (keypos_t){.row = row, .col = col}), &rgb)) {
+                continue;
+            }
+            layer_led_colors[led] = rgb;
+            layer_led_mask[led / 8] |= 1 << (led % 8);
+        }
+    }
+}
+
+static void rgb_matrix_layer_colors_draw(uint8_t led_min, uint8_t led_max) {
+    for (uint16_t i = led_min; i < led_max; i++) {
+        if (!layer_led_mask[i / 8]) {
+            i |= 7;  // none of the next eight
+            continue;
+        }
+        if (layer_led_mask[i / 8] & (1 << (i % 8))) {
+            rgb_matrix_set_color(i, layer_led_colors[i].r, layer_led_colors[i].g, layer_led_colors[i].b);
+        }
+    }
+}
+#endif  // RGB_MATRIX_LAYER_COLORS
+
 static void rgb_task_start(void) {
     // reset iter
     rgb_effect_params.iter = 0;
@@ -305,38 +994,45 @@ static void rgb_task_start(void) {
     // update double buffers
     g_rgb_timer = rgb_timer_buffer;
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
-    g_last_hit_tracker = last_hit_buffer;
+    // Unroll the ring oldest first, with the age of each hit at the start of this frame
+    uint8_t slot = last_hit_buffer.head;
+    for (uint8_t i = 0; i < last_hit_buffer.count; i++) {
+        g_last_hit_tracker.x[i]     = last_hit_buffer.x[slot];
+        g_last_hit_tracker.y[i]     = last_hit_buffer.y[slot];
+        g_last_hit_tracker.index[i] = last_hit_buffer.index[slot];
+        g_last_hit_tracker.tick[i]  = (uint16_t)g_rgb_timer - last_hit_buffer.time[slot];
+        if (++slot >= LED_HITS_TO_REMEMBER) slot = 0;
+    }
+    g_last_hit_tracker.count = last_hit_buffer.count;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
+#ifdef RGB_MATRIX_LAYER_COLORS
+    rgb_matrix_layer_colors_update();
+#endif
 
     // next task
     rgb_task_state = RENDERING;
 }
 
-static void rgb_task_render(uint8_t effect) {
-    bool rendering         = false;
-    rgb_effect_params.init = (effect != rgb_last_effect) || (rgb_matrix_config.enable != rgb_last_enable);
-
+// Renders the next iteration of an effect, returns whether it has more to render
+static bool rgb_effect_run(uint8_t effect, effect_params_t *params) {
     // each effect can opt to do calculations
     // and/or request PWM buffer updates.
     switch (effect) {
         case RGB_MATRIX_NONE:
-            rendering = rgb_matrix_none(&rgb_effect_params);
-            break;
+            return rgb_matrix_none(params);
 
 // ---------------------------------------------
 // -----Begin rgb effect switch case macros-----
-#define RGB_MATRIX_EFFECT(name, ...)          \
-    case RGB_MATRIX_##name:                   \
-        rendering = name(&rgb_effect_params); \
-        break;
+#define RGB_MATRIX_EFFECT(name, ...) \
+    case RGB_MATRIX_##name:          \
+        return name(params);
 #include "rgb_matrix_animations/rgb_matrix_effects.inc"
 #undef RGB_MATRIX_EFFECT
 
 #if defined(RGB_MATRIX_CUSTOM_KB) || defined(RGB_MATRIX_CUSTOM_USER)
-#    define RGB_MATRIX_EFFECT(name, ...)          \
-        case RGB_MATRIX_CUSTOM_##name:            \
-            rendering = name(&rgb_effect_params); \
-            break;
+#    define RGB_MATRIX_EFFECT(name, ...) \
+        case RGB_MATRIX_CUSTOM_##name:   \
+            return name(params);
 #    ifdef RGB_MATRIX_CUSTOM_KB
 #        include "rgb_matrix_kb.inc"
 #    endif
@@ -347,21 +1043,146 @@ static void rgb_task_render(uint8_t effect) {
 #endif
             // -----End rgb effect switch case macros-------
             // ---------------------------------------------
+    }
+    return false;
+}
+
+#ifdef RGB_MATRIX_EFFECT_LAYERS
+__attribute__((weak)) bool rgb_matrix_effect_is_reactive_user(uint8_t mode) { return false; }
+
+__attribute__((weak)) bool rgb_matrix_effect_is_reactive_kb(uint8_t mode) { return rgb_matrix_effect_is_reactive_user(mode); }
+
+// Effects that only draw around recent key hits, and nothing once those faded
+static bool rgb_matrix_effect_is_reactive(uint8_t effect) {
+    switch (effect) {
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+#        ifndef DISABLE_RGB_MATRIX_SOLID_REACTIVE_SIMPLE
+        case RGB_MATRIX_SOLID_REACTIVE_SIMPLE:
+#        endif
+#        ifndef DISABLE_RGB_MATRIX_SOLID_REACTIVE_WIDE
+        case RGB_MATRIX_SOLID_REACTIVE_WIDE:
+#        endif
+#        ifndef DISABLE_RGB_MATRIX_SOLID_REACTIVE_MULTIWIDE
+        case RGB_MATRIX_SOLID_REACTIVE_MULTIWIDE:
+#        endif
+#        ifndef DISABLE_RGB_MATRIX_SOLID_REACTIVE_CROSS
+        case RGB_MATRIX_SOLID_REACTIVE_CROSS:
+#        endif
+#        ifndef DISABLE_RGB_MATRIX_SOLID_REACTIVE_MULTICROSS
+        case RGB_MATRIX_SOLID_REACTIVE_MULTICROSS:
+#        endif
+#        ifndef DISABLE_RGB_MATRIX_SOLID_REACTIVE_NEXUS
+        case RGB_MATRIX_SOLID_REACTIVE_NEXUS:
+#        endif
+#        ifndef DISABLE_RGB_MATRIX_SOLID_REACTIVE_MULTINEXUS
+        case RGB_MATRIX_SOLID_REACTIVE_MULTINEXUS:
+#        endif
+#        ifndef DISABLE_RGB_MATRIX_SPLASH
+        case RGB_MATRIX_SPLASH:
+#        endif
+#        ifndef DISABLE_RGB_MATRIX_MULTISPLASH
+        case RGB_MATRIX_MULTISPLASH:
+#        endif
+#        ifndef DISABLE_RGB_MATRIX_SOLID_SPLASH
+        case RGB_MATRIX_SOLID_SPLASH:
+#        endif
+#        ifndef DISABLE_RGB_MATRIX_SOLID_MULTISPLASH
+        case RGB_MATRIX_SOLID_MULTISPLASH:
+#        endif
+            return true;
+#    endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
+        default:
+            return rgb_matrix_effect_is_reactive_kb(effect);
+    }
+}
+
+void rgb_matrix_effect_layer_set(uint8_t layer, uint8_t mode, uint8_t alpha, const uint8_t *mask) {
+    if (layer >= RGB_MATRIX_EFFECT_LAYERS) {
+        return;
+    }
+    rgb_effect_layer_t *l = &rgb_effect_layers[layer];
+    if (l->mode != mode) {
+        l->params.init = true;
+    }
+    l->mode  = mode;
+    l->alpha = alpha;
+    l->mask  = mask;
+    l->idle  = false;
+#    ifdef RGB_MATRIX_SKIP_STATIC_FRAMES
+    rgb_matrix_redraw();
+#    endif
+}
 
-        // Factory default magic value
-        case UINT8_MAX: {
-            rgb_matrix_test();
-            rgb_task_state = FLUSHING;
+/* Renders an iteration of the base effect into rgb_compose_frame, then of each layer over the
+ * same leds, and hands those to the driver. Without any layer the base effect draws straight
+ * to the driver. */
+static bool rgb_effect_layers_render(uint8_t effect) {
+    effect_params_t *params    = &rgb_effect_params;
+    bool             composing = false;
+    for (uint8_t i = 0; i < RGB_MATRIX_EFFECT_LAYERS; i++) {
+        composing |= rgb_effect_layers[i].mode != RGB_MATRIX_NONE;
+    }
+    if (!composing || effect == RGB_MATRIX_NONE) {
+        return rgb_effect_run(effect, params);
+    }
+
+    rgb_composing  = true;
+    bool rendering = rgb_effect_run(effect, params);
+    for (uint8_t i = 0; i < RGB_MATRIX_EFFECT_LAYERS; i++) {
+        rgb_effect_layer_t *layer = &rgb_effect_layers[i];
+        if (layer->mode == RGB_MATRIX_NONE || layer->idle) {
+            continue;
         }
-            return;
+        layer->params.iter  = params->iter;
+        layer->params.flags = params->flags;
+        if (params->iter == 0) {
+            layer->lit = false;
+        }
+        rgb_drawing_layer = layer;
+        if (rgb_effect_run(layer->mode, &layer->params)) {
+            rendering = true;
+        } else {
+            layer->params.init = false;
+            layer->idle        = !layer->lit && rgb_matrix_effect_is_reactive(layer->mode);
+        }
+    }
+    rgb_drawing_layer = NULL;
+    rgb_composing     = false;
+
+    RGB_MATRIX_USE_LIMITS(led_min, led_max);
+    if (!rendering) {
+        // Effects that draw every led at once are done after their first iteration
+        led_max = DRIVER_LED_TOTAL;
+    }
+    if (led_min < led_max) {
+        rgb_matrix_set_color_span(led_min, &rgb_compose_frame[led_min], led_max - led_min);
+    }
+    return rendering;
+}
+#endif  // RGB_MATRIX_EFFECT_LAYERS
+
+static void rgb_task_render(uint8_t effect) {
+    rgb_effect_params.init = (effect != rgb_last_effect) || (rgb_matrix_config.enable != rgb_last_enable);
+
+    // Factory default magic value
+    if (effect == UINT8_MAX) {
+        rgb_matrix_test();
+        rgb_task_state = FLUSHING;
+        return;
     }
 
+#ifdef RGB_MATRIX_EFFECT_LAYERS
+    bool rendering = rgb_effect_layers_render(effect);
+#else
+    bool rendering = rgb_effect_run(effect, &rgb_effect_params);
+#endif
+
     rgb_effect_params.iter++;
 
     // next task
     if (!rendering) {
         rgb_task_state = FLUSHING;
-        if (!rgb_effect_params.init && effect == RGB_MATRIX_NONE) {
+        if (!rgb_effect_params.init && effect == RGB_MATRIX_NONE && !rgb_flush_pending) {
             // We only need to flush once if we are RGB_MATRIX_NONE
             rgb_task_state = SYNCING;
         }
@@ -374,13 +1195,14 @@ static void rgb_task_flush(uint8_t effect) {
     rgb_last_enable = rgb_matrix_config.enable;
 
     // update pwm buffers
+    rgb_flush_pending = false;
     rgb_matrix_update_pwm_buffers();
 
     // next task
     rgb_task_state = SYNCING;
 }
 
-void rgb_matrix_task(void) {
+static void rgb_matrix_task_step(void) {
     rgb_task_timers();
 
     // Ideally we would also stop sending zeros to the LED driver PWM buffers
@@ -395,6 +1217,9 @@ void rgb_matrix_task(void) {
         false;
 
     uint8_t effect = suspend_backlight || !rgb_matrix_config.enable ? 0 : rgb_matrix_config.mode;
+#ifdef RGB_MATRIX_STATS
+    rgb_stats_time_t start = rgb_stats_now();
+#endif
 
     switch (rgb_task_state) {
         case STARTING:
@@ -406,16 +1231,95 @@ void rgb_matrix_task(void) {
                 rgb_matrix_indicators();
                 rgb_matrix_indicators_advanced(&rgb_effect_params);
             }
+#ifdef RGB_MATRIX_STATS
+            rgb_stats_render_us += rgb_stats_elapsed_us(start);
+#endif
             break;
         case FLUSHING:
             rgb_task_flush(effect);
+#ifdef RGB_MATRIX_STATS
+            rgb_stats_frame(rgb_stats_elapsed_us(start));
+#endif
             break;
         case SYNCING:
-            rgb_task_sync();
+            rgb_task_sync(effect);
             break;
     }
 }
 
+#ifdef RGB_MATRIX_BENCHMARK
+#    include "task_profile.h"
+
+void rgb_matrix_benchmark_frame(uint8_t effect, uint16_t frame) {
+    // Effects are timed as if frames went out every RGB_MATRIX_LED_FLUSH_LIMIT ms, starting from init
+    rgb_last_effect  = frame == 0 ? UINT8_MAX : effect;
+    rgb_last_enable  = rgb_matrix_config.enable;
+    rgb_timer_buffer = (uint32_t)frame * RGB_MATRIX_LED_FLUSH_LIMIT;
+    rgb_task_start();
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+    // The reactive effects cost the most with every hit they remember still running
+    for (uint8_t i = 0; i < LED_HITS_TO_REMEMBER; i++) {
+        uint8_t led                 = (uint16_t)i * DRIVER_LED_TOTAL / LED_HITS_TO_REMEMBER;
+        g_last_hit_tracker.x[i]     = g_led_config.point[led].x;
+        g_last_hit_tracker.y[i]     = g_led_config.point[led].y;
+        g_last_hit_tracker.index[i] = led;
+        g_last_hit_tracker.tick[i]  = (frame * RGB_MATRIX_LED_FLUSH_LIMIT + i * 64) % 1024;
+    }
+    g_last_hit_tracker.count = LED_HITS_TO_REMEMBER;
+#    endif
+    do {
+        rgb_task_render(effect);
+    } while (rgb_task_state == RENDERING);
+}
+
+void rgb_matrix_benchmark(uint16_t frames) {
+    if (!frames) {
+        return;
+    }
+    uprintf("rgb_matrix benchmark: %u leds, %u frames per effect\n", DRIVER_LED_TOTAL, frames);
+    uprintf("effect   mean us    max us\n");
+    uint32_t timer_buffer = rgb_timer_buffer;
+    for (uint8_t effect = 1; effect < RGB_MATRIX_EFFECT_MAX; effect++) {
+        uint32_t total = 0, max = 0;
+        for (uint16_t frame = 0; frame < frames; frame++) {
+            uint32_t start = task_profile_ticks();
+            rgb_matrix_benchmark_frame(effect, frame);
+            uint32_t ticks = task_profile_ticks_diff(task_profile_ticks(), start);
+            total += ticks;
+            if (ticks > max) max = ticks;
+        }
+        uprintf("%6u %9lu %9lu\n", effect, (unsigned long)task_profile_ticks_to_us(total / frames), (unsigned long)task_profile_ticks_to_us(max));
+    }
+
+    // Start the configured effect over on the next task call
+    rgb_timer_buffer = timer_buffer;
+    rgb_last_effect  = UINT8_MAX;
+    rgb_task_state  = SYNCING;
+    rgb_matrix_request_flush();
+}
+#endif  // RGB_MATRIX_BENCHMARK
+
+#ifdef RGB_MATRIX_RENDER_THREAD
+// Renders and flushes frames off the main loop. The thread sleeps between frames and while the
+// driver waits for its I2C or SPI transfers, so LED I/O never holds up matrix scanning or USB.
+static THD_WORKING_AREA(waRGBMatrixThread, RGB_MATRIX_THREAD_STACK_SIZE);
+static THD_FUNCTION(RGBMatrixThread, arg) {
+    (void)arg;
+    chRegSetThreadName("rgb_matrix");
+    while (true) {
+        rgb_hit_queue_drain();
+        rgb_matrix_task_step();
+        if (rgb_task_state == SYNCING) {
+            chThdSleepMilliseconds(1);
+        }
+    }
+}
+
+void rgb_matrix_task(void) {}
+#else
+void rgb_matrix_task(void) { rgb_matrix_task_step(); }
+#endif  // RGB_MATRIX_RENDER_THREAD
+
 void rgb_matrix_indicators(void) {
     rgb_matrix_indicators_kb();
     rgb_matrix_indicators_user();
@@ -431,13 +1335,20 @@ void rgb_matrix_indicators_advanced(effect_params_t *params) {
      * and not sure which would be better. Otherwise, this should be called from
      * rgb_task_render, right before the iter++ line.
      */
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
+#ifdef RGB_MATRIX_TARGET_FPS
+    uint8_t min = g_rgb_process_limit * (params->iter - 1);
+    uint8_t max = min + g_rgb_process_limit;
+    if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
+#elif defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
     uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * (params->iter - 1);
     uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;
     if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
 #else
     uint8_t min = 0;
     uint8_t max = DRIVER_LED_TOTAL;
+#endif
+#ifdef RGB_MATRIX_LAYER_COLORS
+    rgb_matrix_layer_colors_draw(min, max);
 #endif
     rgb_matrix_indicators_advanced_kb(min, max);
     rgb_matrix_indicators_advanced_user(min, max);
@@ -447,8 +1358,30 @@ __attribute__((weak)) void rgb_matrix_indicators_advanced_kb(uint8_t led_min, ui
 
 __attribute__((weak)) void rgb_matrix_indicators_advanced_user(uint8_t led_min, uint8_t led_max) {}
 
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+// Call again if g_led_config is changed at runtime
+void rgb_matrix_update_geometry(void) {
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        int16_t dx              = g_led_config.point[i].x - k_rgb_matrix_center.x;
+        int16_t dy              = g_led_config.point[i].y - k_rgb_matrix_center.y;
+        g_led_geometry[i].dist  = sqrt16(dx * dx + dy * dy);
+        g_led_geometry[i].angle = atan2_8(dy, dx);
+    }
+}
+#endif  // RGB_MATRIX_GEOMETRY_CACHE
+
 void rgb_matrix_init(void) {
     rgb_matrix_driver.init();
+#ifdef RGB_MATRIX_OUTPUT_LUT
+    rgb_output_lut_update();
+#endif
+
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+    rgb_matrix_update_geometry();
+#endif
+#ifdef RGB_MATRIX_KEY_LED_CACHE
+    rgb_matrix_update_key_leds();
+#endif
 
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker.count = 0;
@@ -456,9 +1389,11 @@ void rgb_matrix_init(void) {
         g_last_hit_tracker.tick[i] = UINT16_MAX;
     }
 
+    last_hit_buffer.head  = 0;
     last_hit_buffer.count = 0;
-    for (uint8_t i = 0; i < LED_HITS_TO_REMEMBER; ++i) {
-        last_hit_buffer.tick[i] = UINT16_MAX;
+    last_hit_sweep        = sync_timer_read32();
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; ++i) {
+        g_led_hit_time[i] = last_hit_sweep - RGB_HIT_MAX_AGE;
     }
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 
@@ -474,6 +1409,10 @@ void rgb_matrix_init(void) {
         eeconfig_update_rgb_matrix_default();
     }
     eeconfig_debug_rgb_matrix();  // display current eeprom values
+
+#ifdef RGB_MATRIX_RENDER_THREAD
+    chThdCreateStatic(waRGBMatrixThread, sizeof(waRGBMatrixThread), RGB_MATRIX_THREAD_PRIORITY, RGBMatrixThread, NULL);
+#endif
 }
 
 void rgb_matrix_set_suspend_state(bool state) {
@@ -481,6 +1420,9 @@ void rgb_matrix_set_suspend_state(bool state) {
         rgb_matrix_set_color_all(0, 0, 0);  // turn off all LEDs when suspending
     }
     g_suspend_state = state;
+#ifdef RGB_MATRIX_SKIP_STATIC_FRAMES
+    rgb_matrix_redraw();
+#endif
 }
 
 bool rgb_matrix_get_suspend_state(void) { return g_suspend_state; }
@@ -45,7 +45,16 @@
 #    define RGB_MATRIX_LED_PROCESS_LIMIT (DRIVER_LED_TOTAL + 4) / 5
 #endif
 
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
+#ifdef RGB_MATRIX_TARGET_FPS
+#    ifndef RGB_MATRIX_STATS
+#        define RGB_MATRIX_STATS
+#    endif
+// The limit is adapted at runtime, starting from RGB_MATRIX_LED_PROCESS_LIMIT
+#    define RGB_MATRIX_USE_LIMITS(min, max)                  \
+        uint8_t min = g_rgb_process_limit * params->iter;     \
+        uint8_t max = min + g_rgb_process_limit;              \
+        if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
+#elif defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
 #    define RGB_MATRIX_USE_LIMITS(min, max)                        \
         uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * params->iter; \
         uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;          \
@@ -64,6 +73,29 @@
 #define RGB_MATRIX_TEST_LED_FLAGS() \
     if (!HAS_ANY_FLAGS(g_led_config.flags[i], params->flags)) continue
 
+#ifdef RGB_MATRIX_HSV_BATCH
+#    if RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL && !defined(RGB_MATRIX_TARGET_FPS)
+#        define RGB_MATRIX_HSV_BATCH_SIZE (RGB_MATRIX_LED_PROCESS_LIMIT)
+#    else
+#        define RGB_MATRIX_HSV_BATCH_SIZE DRIVER_LED_TOTAL
+#    endif
+// Runners stage colors with RGB_MATRIX_SET_HSV() and convert them all at once with RGB_MATRIX_FLUSH_HSV()
+#    define RGB_MATRIX_SET_HSV(i, hsv) g_rgb_hsv_batch[(i)-led_min] = (hsv)
+#    define RGB_MATRIX_FLUSH_HSV() rgb_matrix_set_hsv_batch(params, led_min, led_max)
+#else
+#    define RGB_MATRIX_SET_HSV(i, hsv)                    \
+        do {                                              \
+            RGB rgb = rgb_matrix_hsv_to_rgb(hsv);         \
+            rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b); \
+        } while (0)
+#    define RGB_MATRIX_FLUSH_HSV()
+#endif
+
+#if defined(RGB_MATRIX_KEY_LED_CACHE) && !defined(RGB_MATRIX_KEY_LED_LIST_SIZE)
+// Enough for every led to belong to one key
+#    define RGB_MATRIX_KEY_LED_LIST_SIZE DRIVER_LED_TOTAL
+#endif
+
 enum rgb_matrix_effects {
     RGB_MATRIX_NONE = 0,
 
@@ -97,6 +129,11 @@ uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
 
 void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue);
 void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue);
+void rgb_matrix_set_color_span(uint8_t start, const RGB *colors, uint8_t count);
+#ifdef RGB_MATRIX_HSV_BATCH
+void rgb_matrix_set_hsv_batch(effect_params_t *params, uint8_t led_min, uint8_t led_max);
+void rgb_matrix_hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count);
+#endif
 
 void process_rgb_matrix(uint8_t row, uint8_t col, bool pressed);
 
@@ -112,7 +149,81 @@ void rgb_matrix_indicators_advanced(effect_params_t *params);
 void rgb_matrix_indicators_advanced_kb(uint8_t led_min, uint8_t led_max);
 void rgb_matrix_indicators_advanced_user(uint8_t led_min, uint8_t led_max);
 
+#ifdef RGB_MATRIX_LAYER_COLORS
+// Whether, and in which color, the key is lit while layer is the highest active one
+bool rgb_matrix_layer_key_color_kb(uint8_t layer, uint16_t keycode, RGB *rgb);
+bool rgb_matrix_layer_key_color_user(uint8_t layer, uint16_t keycode, RGB *rgb);
+// Call after changing the keymap, or what the callbacks above return, at runtime
+void rgb_matrix_layer_colors_refresh(void);
+#endif
+
 void rgb_matrix_init(void);
+void rgb_matrix_request_flush(void);
+#ifdef RGB_MATRIX_SKIP_STATIC_FRAMES
+void rgb_matrix_redraw(void);
+bool rgb_matrix_effect_is_static_kb(uint8_t mode);
+bool rgb_matrix_effect_is_static_user(uint8_t mode);
+#endif
+
+#ifdef RGB_MATRIX_OUTPUT_LUT
+typedef struct {
+    uint8_t gamma;             // in tenths, 10 for none
+    uint8_t limit;             // the brightest a channel gets
+    uint8_t white_balance[3];  // red, green and blue of full white, before the limit
+} rgb_matrix_output_t;
+
+// Sets how colors are corrected on their way to the driver, only rebuilding the table when it changed
+void                       rgb_matrix_set_output(const rgb_matrix_output_t *output);
+const rgb_matrix_output_t *rgb_matrix_get_output(void);
+#endif
+
+#ifdef RGB_MATRIX_EFFECT_LAYERS
+// Draws the effect mode over the current one, blended by alpha onto the leds set in mask (one bit
+// per led, NULL for all of them), which must stay valid while it is shown. RGB_MATRIX_NONE removes it
+void rgb_matrix_effect_layer_set(uint8_t layer, uint8_t mode, uint8_t alpha, const uint8_t *mask);
+// Whether a custom effect only draws around recent key hits, so can be skipped as a layer once it drew nothing
+bool rgb_matrix_effect_is_reactive_kb(uint8_t mode);
+bool rgb_matrix_effect_is_reactive_user(uint8_t mode);
+#endif
+
+#ifdef RGB_MATRIX_DIRECT_ENABLE
+// Flags in the first byte of a direct mode packet
+#    define RGB_MATRIX_DIRECT_RLE 0x01     // colors are runs of {count, r, g, b}, or {0x80 | count} to skip leds
+#    define RGB_MATRIX_DIRECT_COMMIT 0x02  // the frame is complete, it is shown from the next frame on
+#    define RGB_MATRIX_DIRECT_ACK 0x04     // the host waits for a reply to this packet
+// Writes the packet {flags, first led, led count, colors...} to the frame the host is building,
+// false if it is malformed
+bool rgb_matrix_direct_receive(const uint8_t *data, uint8_t length);
+// Moves a committed frame to g_rgb_direct_frame
+void rgb_matrix_direct_present(void);
+#endif
+
+#ifdef RGB_MATRIX_STATS
+typedef struct {
+    uint16_t fps;            // frames flushed during the last second
+    uint16_t render_us;      // time the last frame spent rendering, over all of its iterations
+    uint16_t render_max_us;  // longest render since the stats were reset
+    uint16_t flush_us;       // time the last flush spent sending the frame to the driver
+    uint16_t flush_max_us;   // longest flush since the stats were reset
+    uint8_t  process_limit;  // leds rendered per iteration
+} rgb_matrix_stats_t;
+
+const rgb_matrix_stats_t *rgb_matrix_get_stats(void);
+void                      rgb_matrix_reset_stats(void);
+void                      rgb_matrix_print_stats(void);
+#endif
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+void rgb_matrix_update_geometry(void);
+#endif
+#ifdef RGB_MATRIX_KEY_LED_CACHE
+void rgb_matrix_update_key_leds(void);
+#endif
+#ifdef RGB_MATRIX_BENCHMARK
+// Renders every iteration of one frame of the effect, without flushing it to the driver
+void rgb_matrix_benchmark_frame(uint8_t effect, uint16_t frame);
+// Renders `frames` frames of every effect and prints the render time of each to the console
+void rgb_matrix_benchmark(uint16_t frames);
+#endif
 
 void        rgb_matrix_set_suspend_state(bool state);
 bool        rgb_matrix_get_suspend_state(void);
@@ -158,6 +269,38 @@ void        rgb_matrix_decrease_speed_noeeprom(void);
 led_flags_t rgb_matrix_get_flags(void);
 void        rgb_matrix_set_flags(led_flags_t flags);
 
+#if defined(RGB_MATRIX_SPLIT) && defined(SPLIT_KEYBOARD) && !defined(USE_I2C)
+// The serial split transport keeps the slave's config and key hits in step with the master
+#    define RGB_MATRIX_SPLIT_SYNC
+#endif
+
+#ifdef RGB_MATRIX_SPLIT_SYNC
+/* Sent from the master to the slave so both halves render the same effect.
+ * Each hit is row * MATRIX_COLS + col, with the top bit set for a press. */
+#    ifndef RGB_MATRIX_SPLIT_HITS
+#        define RGB_MATRIX_SPLIT_HITS 8
+#    endif
+#    if MATRIX_ROWS * MATRIX_COLS <= 0x80
+typedef uint8_t rgb_matrix_split_hit_t;
+#    else
+typedef uint16_t rgb_matrix_split_hit_t;
+#    endif
+#    define RGB_MATRIX_SPLIT_HIT_PRESSED ((rgb_matrix_split_hit_t)1 << (sizeof(rgb_matrix_split_hit_t) * 8 - 1))
+
+typedef struct PACKED {
+    rgb_config_t           config;
+    uint8_t                hit_count;
+    rgb_matrix_split_hit_t hits[RGB_MATRIX_SPLIT_HITS];
+} rgb_matrix_syncinfo_t;
+
+/* for split keyboard master side */
+bool rgb_matrix_get_sync_pending(void);
+void rgb_matrix_get_syncinfo(rgb_matrix_syncinfo_t *syncinfo);
+void rgb_matrix_clear_sync_pending(const rgb_matrix_syncinfo_t *syncinfo);
+/* for split keyboard slave side */
+void rgb_matrix_update_sync(const rgb_matrix_syncinfo_t *syncinfo);
+#endif
+
 #ifndef RGBLIGHT_ENABLE
 #    define eeconfig_update_rgblight_current eeconfig_update_rgb_matrix
 #    define rgblight_toggle rgb_matrix_toggle
@@ -201,6 +344,15 @@ void        rgb_matrix_set_flags(led_flags_t flags);
 #    define rgblight_decrease_speed_noeeprom rgb_matrix_decrease_speed_noeeprom
 #endif
 
+typedef struct {
+    /* First channel byte of LED 0 in the driver's LED buffer. */
+    uint8_t *leds;
+    /* Bytes from one LED to the next. */
+    uint8_t stride;
+    /* Offsets of the red, green and blue channels within an LED. */
+    uint8_t r, g, b;
+} rgb_matrix_framebuffer_t;
+
 typedef struct {
     /* Perform any initialisation required for the other driver functions to work. */
     void (*init)(void);
@@ -210,6 +362,8 @@ typedef struct {
     void (*set_color_all)(uint8_t r, uint8_t g, uint8_t b);
     /* Flush any buffered changes to the hardware. */
     void (*flush)(void);
+    /* Optional layout of a linear LED buffer that flush() sends as a whole, NULL if set_color() must be used. */
+    const rgb_matrix_framebuffer_t *framebuffer;
 } rgb_matrix_driver_t;
 
 extern const rgb_matrix_driver_t rgb_matrix_driver;
@@ -221,7 +375,24 @@ extern uint32_t     g_rgb_timer;
 extern led_config_t g_led_config;
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 extern last_hit_t g_last_hit_tracker;
+extern uint16_t   g_led_hit_time[DRIVER_LED_TOTAL];
+#endif
+#ifdef RGB_MATRIX_TARGET_FPS
+extern uint8_t g_rgb_process_limit;
+#endif
+#ifdef RGB_MATRIX_HSV_BATCH
+extern HSV g_rgb_hsv_batch[RGB_MATRIX_HSV_BATCH_SIZE];
+#endif
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+extern led_geometry_t g_led_geometry[DRIVER_LED_TOTAL];
+#endif
+#ifdef RGB_MATRIX_KEY_LED_CACHE
+extern key_leds_t g_rgb_key_leds[MATRIX_ROWS][MATRIX_COLS];
+extern uint8_t    g_rgb_key_led_list[RGB_MATRIX_KEY_LED_LIST_SIZE];
 #endif
 #ifdef RGB_MATRIX_FRAMEBUFFER_EFFECTS
-extern uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS];
+extern uint8_t g_rgb_frame_buffer[DRIVER_LED_TOTAL];
+#endif
+#ifdef RGB_MATRIX_DIRECT_ENABLE
+extern RGB g_rgb_direct_frame[DRIVER_LED_TOTAL];
 #endif
@@ -7,6 +7,33 @@ RGB_MATRIX_EFFECT(DIGITAL_RAIN)
 #            define RGB_DIGITAL_RAIN_DROPS 24
 #        endif
 
+#        ifndef RGB_DIGITAL_RAIN_MAX_DROPS
+// drops falling at once, new ones are held back while all are in use
+#            define RGB_DIGITAL_RAIN_MAX_DROPS MATRIX_COLS
+#        endif
+
+typedef struct {
+    uint8_t row;
+    uint8_t col;
+    uint8_t led;
+} digital_rain_drop_t;
+
+static digital_rain_drop_t digital_rain_drops[RGB_DIGITAL_RAIN_MAX_DROPS];
+static uint8_t             digital_rain_drop_count = 0;
+
+// LED of the first row from the given one down that has one in the column, or NO_LED
+static uint8_t digital_rain_led_below(uint8_t row, uint8_t col, uint8_t* found_row) {
+    for (; row < MATRIX_ROWS; row++) {
+        // TODO: multiple leds are supported mapped to the same row/column
+        uint8_t led[LED_HITS_TO_REMEMBER];
+        if (rgb_matrix_map_row_column_to_led(row, col, led) != 0) {
+            *found_row = row;
+            return led[0];
+        }
+    }
+    return NO_LED;
+}
+
 bool DIGITAL_RAIN(effect_params_t* params) {
     // algorithm ported from https://github.com/tremby/Kaleidoscope-LEDEffect-DigitalRain
     const uint8_t drop_ticks           = 28;
@@ -19,52 +46,59 @@ bool DIGITAL_RAIN(effect_params_t* params) {
     if (params->init) {
         rgb_matrix_set_color_all(0, 0, 0);
         memset(g_rgb_frame_buffer, 0, sizeof(g_rgb_frame_buffer));
-        drop = 0;
+        drop                    = 0;
+        digital_rain_drop_count = 0;
     }
 
-    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
-        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
-            if (row == 0 && drop == 0 && rand() < RAND_MAX / RGB_DIGITAL_RAIN_DROPS) {
-                // top row, pixels have just fallen and we're
-                // making a new rain drop in this column
-                g_rgb_frame_buffer[row][col] = max_intensity;
-            } else if (g_rgb_frame_buffer[row][col] > 0 && g_rgb_frame_buffer[row][col] < max_intensity) {
-                // neither fully bright nor dark, decay it
-                g_rgb_frame_buffer[row][col]--;
-            }
-            // set the pixel colour
-            uint8_t led[LED_HITS_TO_REMEMBER];
-            uint8_t led_count = rgb_matrix_map_row_column_to_led(row, col, led);
+    if (drop == 0) {
+        // pixels have just fallen, start new rain drops at the top led of some columns
+        for (uint8_t col = 0; col < MATRIX_COLS && digital_rain_drop_count < RGB_DIGITAL_RAIN_MAX_DROPS; col++) {
+            if (random8() >= 256 / RGB_DIGITAL_RAIN_DROPS) continue;
 
-            // TODO: multiple leds are supported mapped to the same row/column
-            if (led_count > 0) {
-                if (g_rgb_frame_buffer[row][col] > pure_green_intensity) {
-                    const uint8_t boost = (uint8_t)((uint16_t)max_brightness_boost * (g_rgb_frame_buffer[row][col] - pure_green_intensity) / (max_intensity - pure_green_intensity));
-                    rgb_matrix_set_color(led[0], boost, max_intensity, boost);
-                } else {
-                    const uint8_t green = (uint8_t)((uint16_t)max_intensity * g_rgb_frame_buffer[row][col] / pure_green_intensity);
-                    rgb_matrix_set_color(led[0], 0, green, 0);
-                }
-            }
+            digital_rain_drop_t* new_drop = &digital_rain_drops[digital_rain_drop_count];
+            new_drop->col                 = col;
+            new_drop->led                 = digital_rain_led_below(0, col, &new_drop->row);
+            // a drop that is still at the top is already bright
+            if (new_drop->led == NO_LED || g_rgb_frame_buffer[new_drop->led] == max_intensity) continue;
+
+            g_rgb_frame_buffer[new_drop->led] = max_intensity;
+            digital_rain_drop_count++;
+        }
+    }
+
+    // the trails behind the drops decay, the drops themselves stay fully bright
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        if (g_rgb_frame_buffer[i] > 0 && g_rgb_frame_buffer[i] < max_intensity) {
+            g_rgb_frame_buffer[i]--;
+        }
+
+        // set the pixel colour
+        if (g_rgb_frame_buffer[i] > pure_green_intensity) {
+            const uint8_t boost = (uint8_t)((uint16_t)max_brightness_boost * (g_rgb_frame_buffer[i] - pure_green_intensity) / (max_intensity - pure_green_intensity));
+            rgb_matrix_set_color(i, boost, max_intensity, boost);
+        } else {
+            const uint8_t green = (uint8_t)((uint16_t)max_intensity * g_rgb_frame_buffer[i] / pure_green_intensity);
+            rgb_matrix_set_color(i, 0, green, 0);
         }
     }
 
     if (++drop > drop_ticks) {
         // reset drop timer
         drop = 0;
-        for (uint8_t row = MATRIX_ROWS - 1; row > 0; row--) {
-            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
-                // if ths is on the bottom row and bright allow decay
-                if (row == MATRIX_ROWS - 1 && g_rgb_frame_buffer[row][col] == max_intensity) {
-                    g_rgb_frame_buffer[row][col]--;
-                }
-                // check if the pixel above is bright
-                if (g_rgb_frame_buffer[row - 1][col] == max_intensity) {
-                    // allow old bright pixel to decay
-                    g_rgb_frame_buffer[row - 1][col]--;
-                    // make this pixel bright
-                    g_rgb_frame_buffer[row][col] = max_intensity;
-                }
+        // allow old bright pixels to decay, all of them first as a drop can be right above another
+        for (uint8_t i = 0; i < digital_rain_drop_count; i++) {
+            g_rgb_frame_buffer[digital_rain_drops[i].led]--;
+        }
+        for (uint8_t i = 0; i < digital_rain_drop_count;) {
+            digital_rain_drop_t* falling = &digital_rain_drops[i];
+            // make the pixel below bright, rows without a led are skipped
+            falling->led = digital_rain_led_below(falling->row + 1, falling->col, &falling->row);
+            if (falling->led != NO_LED) {
+                g_rgb_frame_buffer[falling->led] = max_intensity;
+                i++;
+            } else {
+                // the drop has left the bottom led, the last one takes its place
+                *falling = digital_rain_drops[--digital_rain_drop_count];
             }
         }
     }
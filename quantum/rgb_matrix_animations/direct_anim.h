@@ -0,0 +1,18 @@
+#ifdef RGB_MATRIX_DIRECT_ENABLE
+RGB_MATRIX_EFFECT(DIRECT)
+#    ifdef RGB_MATRIX_CUSTOM_EFFECT_IMPLS
+
+// Shows the last frame the host committed with rgb_matrix_direct_receive(), flags and hsv don't apply
+bool DIRECT(effect_params_t* params) {
+    RGB_MATRIX_USE_LIMITS(led_min, led_max);
+
+    // A frame committed since the last one is only picked up at the start of a frame
+    if (params->iter == 0) {
+        rgb_matrix_direct_present();
+    }
+    rgb_matrix_set_color_span(led_min, &g_rgb_direct_frame[led_min], led_max - led_min);
+    return led_max < DRIVER_LED_TOTAL;
+}
+
+#    endif  // RGB_MATRIX_CUSTOM_EFFECT_IMPLS
+#endif      // RGB_MATRIX_DIRECT_ENABLE
@@ -14,7 +14,7 @@ static void raindrops_set_color(int i, effect_params_t* params) {
         deltaH += 256;
     }
 
-    hsv.h   = rgb_matrix_config.hsv.h + (deltaH * (rand() & 0x03));
+    hsv.h   = rgb_matrix_config.hsv.h + (deltaH * (random8() & 0x03));
     RGB rgb = rgb_matrix_hsv_to_rgb(hsv);
     rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
 }
@@ -23,7 +23,7 @@ bool RAINDROPS(effect_params_t* params) {
     if (!params->init) {
         // Change one LED every tick, make sure speed is not 0
         if (scale16by8(g_rgb_timer, qadd8(rgb_matrix_config.speed, 16)) % 10 == 0) {
-            raindrops_set_color(rand() % DRIVER_LED_TOTAL, params);
+            raindrops_set_color(random8_max(DRIVER_LED_TOTAL), params);
         }
         return false;
     }
@@ -6,26 +6,33 @@ RGB_MATRIX_EFFECT(TYPING_HEATMAP)
 #            define RGB_MATRIX_TYPING_HEATMAP_DECREASE_DELAY_MS 25
 #        endif
 
-void process_rgb_matrix_typing_heatmap(uint8_t row, uint8_t col) {
-    uint8_t m_row = row - 1;
-    uint8_t p_row = row + 1;
-    uint8_t m_col = col - 1;
-    uint8_t p_col = col + 1;
-
-    if (m_col < col) g_rgb_frame_buffer[row][m_col] = qadd8(g_rgb_frame_buffer[row][m_col], 16);
-    g_rgb_frame_buffer[row][col] = qadd8(g_rgb_frame_buffer[row][col], 32);
-    if (p_col < MATRIX_COLS) g_rgb_frame_buffer[row][p_col] = qadd8(g_rgb_frame_buffer[row][p_col], 16);
-
-    if (p_row < MATRIX_ROWS) {
-        if (m_col < col) g_rgb_frame_buffer[p_row][m_col] = qadd8(g_rgb_frame_buffer[p_row][m_col], 13);
-        g_rgb_frame_buffer[p_row][col] = qadd8(g_rgb_frame_buffer[p_row][col], 16);
-        if (p_col < MATRIX_COLS) g_rgb_frame_buffer[p_row][p_col] = qadd8(g_rgb_frame_buffer[p_row][p_col], 13);
-    }
+#        ifndef RGB_MATRIX_TYPING_HEATMAP_SPREAD
+#            define RGB_MATRIX_TYPING_HEATMAP_SPREAD 40
+#        endif
 
-    if (m_row < row) {
-        if (m_col < col) g_rgb_frame_buffer[m_row][m_col] = qadd8(g_rgb_frame_buffer[m_row][m_col], 13);
-        g_rgb_frame_buffer[m_row][col] = qadd8(g_rgb_frame_buffer[m_row][col], 16);
-        if (p_col < MATRIX_COLS) g_rgb_frame_buffer[m_row][p_col] = qadd8(g_rgb_frame_buffer[m_row][p_col], 13);
+// Heats the leds of the key, and every led closer than RGB_MATRIX_TYPING_HEATMAP_SPREAD to them by distance
+void process_rgb_matrix_typing_heatmap(uint8_t row, uint8_t col) {
+#        ifdef RGB_MATRIX_KEY_LED_CACHE
+    const uint8_t* led       = &g_rgb_key_led_list[g_rgb_key_leds[row][col].first];
+    uint8_t        led_count = g_rgb_key_leds[row][col].count;
+#        else
+    uint8_t led[LED_HITS_TO_REMEMBER];
+    uint8_t led_count = rgb_matrix_map_row_column_to_led(row, col, led);
+#        endif
+    for (uint8_t j = 0; j < led_count; j++) {
+        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+            if (i == led[j]) {
+                g_rgb_frame_buffer[i] = qadd8(g_rgb_frame_buffer[i], 32);
+                continue;
+            }
+            int16_t dx = g_led_config.point[i].x - g_led_config.point[led[j]].x;
+            int16_t dy = g_led_config.point[i].y - g_led_config.point[led[j]].y;
+            if (abs(dx) >= RGB_MATRIX_TYPING_HEATMAP_SPREAD || abs(dy) >= RGB_MATRIX_TYPING_HEATMAP_SPREAD) continue;
+            uint8_t dist = sqrt16(dx * dx + dy * dy);
+            if (dist < RGB_MATRIX_TYPING_HEATMAP_SPREAD) {
+                g_rgb_frame_buffer[i] = qadd8(g_rgb_frame_buffer[i], (RGB_MATRIX_TYPING_HEATMAP_SPREAD - dist) / 2);
+            }
+        }
     }
 }
 
@@ -35,10 +42,7 @@ static uint16_t heatmap_decrease_timer;
 static bool decrease_heatmap_values;
 
 bool TYPING_HEATMAP(effect_params_t* params) {
-    // Modified version of RGB_MATRIX_USE_LIMITS to work off of matrix row / col size
-    uint8_t led_min = RGB_MATRIX_LED_PROCESS_LIMIT * params->iter;
-    uint8_t led_max = led_min + RGB_MATRIX_LED_PROCESS_LIMIT;
-    if (led_max > sizeof(g_rgb_frame_buffer)) led_max = sizeof(g_rgb_frame_buffer);
+    RGB_MATRIX_USE_LIMITS(led_min, led_max);
 
     if (params->init) {
         rgb_matrix_set_color_all(0, 0, 0);
@@ -57,29 +61,22 @@ bool TYPING_HEATMAP(effect_params_t* params) {
         }
     }
 
-    // Render heatmap & decrease
-    for (int i = led_min; i < led_max; i++) {
-        uint8_t row = i % MATRIX_ROWS;
-        uint8_t col = i / MATRIX_ROWS;
-        uint8_t val = g_rgb_frame_buffer[row][col];
-
-        // set the pixel colour
-        uint8_t led[LED_HITS_TO_REMEMBER];
-        uint8_t led_count = rgb_matrix_map_row_column_to_led(row, col, led);
-        for (uint8_t j = 0; j < led_count; ++j) {
-            if (!HAS_ANY_FLAGS(g_led_config.flags[led[j]], params->flags)) continue;
+    // Render heatmap
+    for (uint8_t i = led_min; i < led_max; i++) {
+        uint8_t val = g_rgb_frame_buffer[i];
 
-            HSV hsv = {170 - qsub8(val, 85), rgb_matrix_config.hsv.s, scale8((qadd8(170, val) - 170) * 3, rgb_matrix_config.hsv.v)};
-            RGB rgb = rgb_matrix_hsv_to_rgb(hsv);
-            rgb_matrix_set_color(led[j], rgb.r, rgb.g, rgb.b);
-        }
+        RGB_MATRIX_TEST_LED_FLAGS();
+        HSV hsv = {170 - qsub8(val, 85), rgb_matrix_config.hsv.s, scale8((qadd8(170, val) - 170) * 3, rgb_matrix_config.hsv.v)};
+        RGB_MATRIX_SET_HSV(i, hsv);
+    }
+    RGB_MATRIX_FLUSH_HSV();
 
-        if (decrease_heatmap_values) {
-            g_rgb_frame_buffer[row][col] = qsub8(val, 1);
-        }
+    // Decrease, the whole span at once
+    if (decrease_heatmap_values) {
+        qsub8_array(&g_rgb_frame_buffer[led_min], 1, led_max - led_min);
     }
 
-    return led_max < sizeof(g_rgb_frame_buffer);
+    return led_max < DRIVER_LED_TOTAL;
 }
 
 #    endif  // RGB_MATRIX_CUSTOM_EFFECT_IMPLS
@@ -15,6 +15,7 @@
  */
 
 #include "rgb_matrix.h"
+#include <stddef.h>
 
 /* Each driver needs to define the struct
  *    const rgb_matrix_driver_t rgb_matrix_driver;
@@ -135,19 +136,47 @@ const rgb_matrix_driver_t rgb_matrix_driver = {
 #    endif
 
 #elif defined(WS2812)
-#    if defined(RGBLIGHT_ENABLE) && !defined(RGBLIGHT_CUSTOM_DRIVER)
+#    if defined(RGB_MATRIX_SHARED_RGBLIGHT)
+#        if !defined(RGBLIGHT_ENABLE) || defined(RGBLIGHT_CUSTOM_DRIVER)
+#            error "RGB_MATRIX_SHARED_RGBLIGHT needs RGBLIGHT_ENABLE with the WS2812 driver"
+#        endif
+#    elif defined(RGBLIGHT_ENABLE) && !defined(RGBLIGHT_CUSTOM_DRIVER)
 #        pragma message "Cannot use RGBLIGHT and RGB Matrix using WS2812 at the same time."
-#        pragma message "You need to use a custom driver, or re-implement the WS2812 driver to use a different configuration."
+#        pragma message "You need to use a custom driver, or define RGB_MATRIX_SHARED_RGBLIGHT if both are on the same chain."
 #    endif
 
+#    ifdef RGB_MATRIX_SHARED_RGBLIGHT
+#        include <string.h>
+#        include "rgblight.h"
+
+// The whole chain, the rgblight leds come first and the matrix leds follow them
+static struct {
+    LED_TYPE rgblight[RGBLED_NUM];
+    LED_TYPE matrix[DRIVER_LED_TOTAL];
+} ws2812_chain;
+
+#        define rgb_matrix_ws2812_array ws2812_chain.matrix
+#        define WS2812_CHAIN_START ws2812_chain.rgblight
+#        define WS2812_CHAIN_LENGTH (RGBLED_NUM + DRIVER_LED_TOTAL)
+
+// rgblight renders into its part of the chain, which goes out with the next rgb_matrix frame
+void rgblight_call_driver(LED_TYPE *start_led, uint8_t num_leds) {
+    memcpy(&ws2812_chain.rgblight[rgblight_ranges.clipping_start_pos], start_led, num_leds * sizeof(LED_TYPE));
+    rgb_matrix_request_flush();
+}
+#    else
 // LED color buffer
 LED_TYPE rgb_matrix_ws2812_array[DRIVER_LED_TOTAL];
 
+#        define WS2812_CHAIN_START rgb_matrix_ws2812_array
+#        define WS2812_CHAIN_LENGTH DRIVER_LED_TOTAL
+#    endif
+
 static void init(void) {}
 
 static void flush(void) {
     // Assumes use of RGB_DI_PIN
-    ws2812_setleds(rgb_matrix_ws2812_array, DRIVER_LED_TOTAL);
+    ws2812_setleds(WS2812_CHAIN_START, WS2812_CHAIN_LENGTH);
 }
 
 // Set an led in the buffer to a color
@@ -166,10 +195,24 @@ static void setled_all(uint8_t r, uint8_t g, uint8_t b) {
     }
 }
 
+#    ifndef RGBW
+// setled() has nothing to add without the white channel, so the buffer can be written directly
+static const rgb_matrix_framebuffer_t framebuffer = {
+    .leds   = (uint8_t *)rgb_matrix_ws2812_array,
+    .stride = sizeof(LED_TYPE),
+    .r      = offsetof(LED_TYPE, r),
+    .g      = offsetof(LED_TYPE, g),
+    .b      = offsetof(LED_TYPE, b),
+};
+#    endif
+
 const rgb_matrix_driver_t rgb_matrix_driver = {
     .init          = init,
     .flush         = flush,
     .set_color     = setled,
     .set_color_all = setled_all,
+#    ifndef RGBW
+    .framebuffer = &framebuffer,
+#    endif
 };
 #endif
@@ -8,21 +8,17 @@ bool effect_runner_reactive(effect_params_t* params, reactive_f effect_func) {
     RGB_MATRIX_USE_LIMITS(led_min, led_max);
 
     uint16_t max_tick = 65535 / rgb_matrix_config.speed;
+    uint16_t now      = g_rgb_timer;
     for (uint8_t i = led_min; i < led_max; i++) {
         RGB_MATRIX_TEST_LED_FLAGS();
-        uint16_t tick = max_tick;
-        // Reverse search to find most recent key hit
-        for (int8_t j = g_last_hit_tracker.count - 1; j >= 0; j--) {
-            if (g_last_hit_tracker.index[j] == i && g_last_hit_tracker.tick[j] < tick) {
-                tick = g_last_hit_tracker.tick[j];
-                break;
-            }
-        }
+        // Age of the most recent hit, a hit after the start of this frame wraps around and shows next frame
+        uint16_t tick = now - g_led_hit_time[i];
+        if (tick > max_tick) tick = max_tick;
 
         uint16_t offset = scale16by8(tick, rgb_matrix_config.speed);
-        RGB      rgb    = rgb_matrix_hsv_to_rgb(effect_func(rgb_matrix_config.hsv, offset));
-        rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
+        RGB_MATRIX_SET_HSV(i, effect_func(rgb_matrix_config.hsv, offset));
     }
+    RGB_MATRIX_FLUSH_HSV();
     return led_max < DRIVER_LED_TOTAL;
 }
 
@@ -49,6 +49,21 @@ typedef struct PACKED {
 } last_hit_t;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+typedef struct PACKED {
+    uint8_t dist;   // sqrt16 distance from k_rgb_matrix_center
+    uint8_t angle;  // atan2_8 angle around k_rgb_matrix_center
+} led_geometry_t;
+#endif  // RGB_MATRIX_GEOMETRY_CACHE
+
+#ifdef RGB_MATRIX_KEY_LED_CACHE
+typedef struct PACKED {
+    uint8_t first;  // index of the key's first led in g_rgb_key_led_list, the others follow it
+    uint8_t count;  // leds of the key
+    uint8_t flags;  // flags of the key's leds OR'd together
+} key_leds_t;
+#endif  // RGB_MATRIX_KEY_LED_CACHE
+
 typedef enum rgb_task_states { STARTING, RENDERING, FLUSHING, SYNCING } rgb_task_states;
 
 typedef uint8_t led_flags_t;
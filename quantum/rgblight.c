@@ -107,7 +107,7 @@ static uint8_t mode_base_table[] = {
 static inline int is_static_effect(uint8_t mode) { return memchr(static_effect_table, mode, sizeof(static_effect_table)) != NULL; }
 
 #ifdef RGBLIGHT_LED_MAP
-const uint8_t led_map[] PROGMEM = RGBLIGHT_LED_MAP;
+const uint8_t led_map[] HOT_TABLE(RGBLIGHT_LED_MAP) = RGBLIGHT_LED_MAP;
 #endif
 
 #ifdef RGBLIGHT_EFFECT_STATIC_GRADIENT
@@ -815,7 +815,7 @@ void rgblight_set(void) {
 #    ifdef RGBLIGHT_LED_MAP
     LED_TYPE led0[RGBLED_NUM];
     for (uint8_t i = 0; i < RGBLED_NUM; i++) {
-        led0[i] = led[pgm_read_byte(&led_map[i])];
+        led0[i] = led[hot_read_byte(RGBLIGHT_LED_MAP, &led_map[i])];
     }
     start_led = led0 + rgblight_ranges.clipping_start_pos;
 #    else
@@ -909,6 +909,29 @@ void rgblight_timer_toggle(void) {
     }
 }
 
+#    if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
+bool rgblight_get_animation_phase(rgblight_phase_t *phase) {
+    if (!rgblight_status.timer_enabled || animation_status.restart) {
+        return false;
+    }
+    phase->mode       = rgblight_config.mode;
+    phase->next_frame = animation_status.last_timer;
+    phase->pos16      = animation_status.pos16;
+    return true;
+}
+
+void rgblight_set_animation_phase(const rgblight_phase_t *phase) {
+    // A phase of another mode is from before a mode change that did not arrive yet
+    if (!rgblight_status.timer_enabled || rgblight_config.mode != phase->mode) {
+        return;
+    }
+    // Both halves count frames on sync_timer, so the slave's next frame is drawn when the master's is
+    animation_status.restart    = false;
+    animation_status.last_timer = phase->next_frame;
+    animation_status.pos16      = phase->pos16;
+}
+#    endif
+
 void rgblight_show_solid_color(uint8_t r, uint8_t g, uint8_t b) {
     rgblight_enable();
     rgblight_mode(RGBLIGHT_MODE_STATIC_LIGHT);
@@ -1085,11 +1108,12 @@ void rgblight_effect_rainbow_mood(animation_status_t *anim) {
 __attribute__((weak)) const uint8_t RGBLED_RAINBOW_SWIRL_INTERVALS[] PROGMEM = {100, 50, 20};
 
 void rgblight_effect_rainbow_swirl(animation_status_t *anim) {
-    uint8_t hue;
+    // Each led is a fixed hue step from the previous one, so only divide once per frame
+    uint8_t step = RGBLIGHT_RAINBOW_SWIRL_RANGE / rgblight_ranges.effect_num_leds;
+    uint8_t hue  = anim->current_hue;
     uint8_t i;
 
-    for (i = 0; i < rgblight_ranges.effect_num_leds; i++) {
-        hue = (RGBLIGHT_RAINBOW_SWIRL_RANGE / rgblight_ranges.effect_num_leds * i + anim->current_hue);
+    for (i = 0; i < rgblight_ranges.effect_num_leds; i++, hue += step) {
         sethsv(hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[i + rgblight_ranges.effect_start_pos]);
     }
     rgblight_set();
@@ -1195,12 +1219,16 @@ void rgblight_effect_knight(animation_status_t *anim) {
         led[i].w = 0;
 #    endif
     }
+    // Every lit led has the same color, convert it once
+    LED_TYPE color;
+    sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, &color);
+
     // Determine which LEDs should be lit up
     for (i = 0; i < RGBLIGHT_EFFECT_KNIGHT_LED_NUM; i++) {
         cur = (i + RGBLIGHT_EFFECT_KNIGHT_OFFSET) % rgblight_ranges.effect_num_leds + rgblight_ranges.effect_start_pos;
 
         if (i >= low_bound && i <= high_bound) {
-            sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[cur]);
+            led[cur] = color;
         } else {
             led[cur].r = 0;
             led[cur].g = 0;
@@ -1230,29 +1258,40 @@ void rgblight_effect_knight(animation_status_t *anim) {
 
 #ifdef RGBLIGHT_EFFECT_CHRISTMAS
 #    define CUBED(x) ((x) * (x) * (x))
+#    define CHRISTMAS_MAX_POS 32
+#    define CHRISTMAS_HUE_GREEN 85
+
+// The effect works by animating anim->pos from 0 to 32 and back to 0.
+// The pos is used in a cubic bezier formula to ease-in-out between red and green, leaving the interpolated colors visible as short as possible.
+// The compiler evaluates it for every pos, so the effect only has to look the hue up.
+#    define CHRISTMAS_HUE(pos) (uint8_t)((uint32_t)CHRISTMAS_HUE_GREEN * CUBED((uint32_t)(pos)) / (CUBED((uint32_t)(pos)) + CUBED((uint32_t)(CHRISTMAS_MAX_POS - (pos)))))
+#    define CHRISTMAS_HUE_4(pos) CHRISTMAS_HUE(pos), CHRISTMAS_HUE(pos + 1), CHRISTMAS_HUE(pos + 2), CHRISTMAS_HUE(pos + 3)
+
+static const uint8_t PROGMEM rgblight_effect_christmas_hues[CHRISTMAS_MAX_POS + 1] = {
+    CHRISTMAS_HUE_4(0), CHRISTMAS_HUE_4(4), CHRISTMAS_HUE_4(8), CHRISTMAS_HUE_4(12), CHRISTMAS_HUE_4(16), CHRISTMAS_HUE_4(20), CHRISTMAS_HUE_4(24), CHRISTMAS_HUE_4(28), CHRISTMAS_HUE(32),
+};
 
 /**
  * Christmas lights effect, with a smooth animation between red & green.
  */
 void rgblight_effect_christmas(animation_status_t *anim) {
     static int8_t increment = 1;
-    const uint8_t max_pos   = 32;
-    const uint8_t hue_green = 85;
+    const uint8_t max_pos   = CHRISTMAS_MAX_POS;
+    const uint8_t hue_green = CHRISTMAS_HUE_GREEN;
 
-    uint32_t xa;
-    uint8_t  hue, val;
-    uint8_t  i;
+    uint8_t hue, val;
+    uint8_t i;
 
-    // The effect works by animating anim->pos from 0 to 32 and back to 0.
-    // The pos is used in a cubic bezier formula to ease-in-out between red and green, leaving the interpolated colors visible as short as possible.
-    xa  = CUBED((uint32_t)anim->pos);
-    hue = ((uint32_t)hue_green) * xa / (xa + CUBED((uint32_t)(max_pos - anim->pos)));
+    hue = pgm_read_byte(&rgblight_effect_christmas_hues[anim->pos]);
     // Additionally, these interpolated colors get shown with a slightly darker value, to make them less prominent than the main colors.
     val = 255 - (3 * (hue < hue_green / 2 ? hue : hue_green - hue) / 2);
 
+    // Only two colors are shown at a time, convert each of them once
+    LED_TYPE colors[2];
+    sethsv(hue_green - hue, rgblight_config.sat, val, &colors[0]);
+    sethsv(hue, rgblight_config.sat, val, &colors[1]);
     for (i = 0; i < rgblight_ranges.effect_num_leds; i++) {
-        uint8_t local_hue = (i / RGBLIGHT_EFFECT_CHRISTMAS_STEP) % 2 ? hue : hue_green - hue;
-        sethsv(local_hue, rgblight_config.sat, val, (LED_TYPE *)&led[i + rgblight_ranges.effect_start_pos]);
+        led[i + rgblight_ranges.effect_start_pos] = colors[(i / RGBLIGHT_EFFECT_CHRISTMAS_STEP) % 2];
     }
     rgblight_set();
 
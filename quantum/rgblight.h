@@ -426,6 +426,19 @@ typedef struct _animation_status_t {
 
 extern animation_status_t animation_status;
 
+#        if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
+typedef struct _rgblight_phase_t {
+    uint8_t  mode;
+    uint16_t next_frame; /* sync_timer time */
+    uint16_t pos16;
+} rgblight_phase_t;
+
+/* for split keyboard master side, false while there is no running animation */
+bool rgblight_get_animation_phase(rgblight_phase_t *phase);
+/* for split keyboard slave side */
+void rgblight_set_animation_phase(const rgblight_phase_t *phase);
+#        endif
+
 void rgblight_effect_breathing(animation_status_t *anim);
 void rgblight_effect_rainbow_mood(animation_status_t *anim);
 void rgblight_effect_rainbow_swirl(animation_status_t *anim);
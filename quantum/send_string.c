@@ -15,10 +15,15 @@
  */
 
 #include <ctype.h>
+#include <string.h>
 
 #include "quantum.h"
 
 #include "send_string.h"
+#include "eeprom.h"
+#ifdef UNICODE_COMMON_ENABLE
+#    include "process_unicode_common.h"
+#endif
 
 // clang-format off
 
@@ -134,6 +139,84 @@ __attribute__((weak)) const uint8_t ascii_to_keycode_lut[128] PROGMEM = {
 // Note: we bit-pack in "reverse" order to optimize loading
 #define PGM_LOADBIT(mem, pos) ((pgm_read_byte(&((mem)[(pos) / 8])) >> ((pos) % 8)) & 0x01)
 
+/* Characters beyond ASCII come as UTF-8. They are typed with the keys the
+ * SEND_STRING_LOCALE table gives them, dead key first where there is one,
+ * and otherwise through Unicode input, which is far slower. */
+
+// Bytes in the UTF-8 sequence lead starts, 0 if it can't start one
+static uint8_t utf8_length(uint8_t lead) {
+    if (lead < 0x80) return 1;
+    if ((lead & 0xE0) == 0xC0) return 2;
+    if ((lead & 0xF0) == 0xE0) return 3;
+    if ((lead & 0xF8) == 0xF0) return 4;
+    return 0;
+}
+
+#ifdef SEND_STRING_UNICODE_H
+#    include SEND_STRING_UNICODE_H
+
+static bool send_string_unicode_lookup(uint32_t codepoint, send_string_unicode_t *entry) {
+    if (codepoint > UINT16_MAX) {
+        return false;
+    }
+    uint16_t low  = 0;
+    uint16_t high = sizeof(send_string_unicode_lut) / sizeof(send_string_unicode_lut[0]);
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        memcpy_P(entry, &send_string_unicode_lut[mid], sizeof(*entry));
+        if (entry->codepoint == codepoint) {
+            return true;
+        }
+        if (entry->codepoint < codepoint) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return false;
+}
+#else
+static bool send_string_unicode_lookup(uint32_t codepoint, send_string_unicode_t *entry) { return false; }
+#endif
+
+static void send_codepoint(uint32_t codepoint) {
+    send_string_unicode_t entry;
+    if (send_string_unicode_lookup(codepoint, &entry)) {
+        if (entry.dead_keycode != KC_NO) {
+            register_mods(entry.dead_mods);
+            tap_code(entry.dead_keycode);
+            unregister_mods(entry.dead_mods);
+        }
+        register_mods(entry.mods);
+        tap_code(entry.keycode);
+        unregister_mods(entry.mods);
+        return;
+    }
+#ifdef UNICODE_COMMON_ENABLE
+    register_unicode(codepoint);
+#endif
+}
+
+// Types the UTF-8 character starting at str, returns its last byte
+static const char *send_utf8(const char *str, bool progmem) {
+    uint8_t  lead      = progmem ? pgm_read_byte(str) : *str;
+    uint8_t  length    = utf8_length(lead);
+    uint32_t codepoint = lead & (0x7F >> length);
+    if (!length) {
+        return str;  // a stray continuation byte
+    }
+    for (uint8_t i = 1; i < length; i++) {
+        uint8_t next = progmem ? pgm_read_byte(str + 1) : str[1];
+        if ((next & 0xC0) != 0x80) {
+            return str;  // cut short, dropped
+        }
+        codepoint = (codepoint << 6) | (next & 0x3F);
+        str++;
+    }
+    send_codepoint(codepoint);
+    return str;
+}
+
 void send_string(const char *str) { send_string_with_delay(str, 0); }
 
 void send_string_P(const char *str) { send_string_with_delay_P(str, 0); }
@@ -167,6 +250,10 @@ void send_string_with_delay(const char *str, uint8_t interval) {
                 }
                 while (ms--) wait_ms(1);
             }
+        } else if ((uint8_t)ascii_code >= 0x80) {
+            str = send_utf8(str, false);
+        } else if ((uint8_t)ascii_code >= 0x80) {
+            str = send_utf8(str, true);
         } else {
             send_char(ascii_code);
         }
@@ -220,6 +307,277 @@ void send_string_with_delay_P(const char *str, uint8_t interval) {
     }
 }
 
+#ifndef SEND_STRING_ASYNC_QUEUE_SIZE
+#    define SEND_STRING_ASYNC_QUEUE_SIZE 4
+#endif
+
+#ifndef SEND_STRING_ASYNC_BATCH
+#    define SEND_STRING_ASYNC_BATCH 4
+#endif
+
+#ifndef SEND_STRING_EEPROM_BUFFER
+#    define SEND_STRING_EEPROM_BUFFER 16
+#endif
+
+typedef struct {
+    const char *str;
+    const char *end;  // EEPROM strings with a known length, else NULL
+    uint8_t     source;
+} send_string_async_t;
+
+static send_string_async_t async_queue[SEND_STRING_ASYNC_QUEUE_SIZE];
+static uint8_t             async_queue_head  = 0;
+static uint8_t             async_queue_count = 0;
+static send_string_async_t async_current     = {NULL, NULL, SEND_STRING_RAM};
+
+/* The block of the current EEPROM string last read, from async_eeprom_start */
+static uint8_t     async_eeprom_buffer[SEND_STRING_EEPROM_BUFFER];
+static const char *async_eeprom_start = NULL;
+static uint8_t     async_eeprom_fill  = 0;
+
+/* Keys the engine holds down in the keyboard report */
+static uint8_t  async_keys[SEND_STRING_ASYNC_BATCH];
+static uint8_t  async_key_count = 0;
+static uint8_t  async_mods      = 0;
+static bool     async_dead      = false;
+static bool     async_prefixed  = false;  // the dead key of the next character is down
+static uint16_t async_delay     = 0;
+static uint16_t async_timer     = 0;
+
+bool send_string_async_source(const char *str, send_string_source_t source) {
+    if (async_queue_count == SEND_STRING_ASYNC_QUEUE_SIZE) {
+        return false;
+    }
+    send_string_async_t *entry = &async_queue[(async_queue_head + async_queue_count++) % SEND_STRING_ASYNC_QUEUE_SIZE];
+    entry->str                 = str;
+    entry->end                 = NULL;
+    entry->source              = source;
+    return true;
+}
+
+bool send_string_async_eeprom(const char *str, uint16_t length) {
+    if (!send_string_async_source(str, SEND_STRING_EEPROM)) {
+        return false;
+    }
+    async_queue[(async_queue_head + async_queue_count - 1) % SEND_STRING_ASYNC_QUEUE_SIZE].end = str + length;
+    return true;
+}
+
+bool send_string_async(const char *str) { return send_string_async_source(str, SEND_STRING_RAM); }
+
+bool send_string_async_P(const char *str) { return send_string_async_source(str, SEND_STRING_PROGMEM); }
+
+bool send_string_async_busy(void) { return async_current.str || async_queue_count || async_key_count || async_mods || async_dead || async_prefixed; }
+
+static char async_read(void) {
+    switch (async_current.source) {
+        case SEND_STRING_PROGMEM:
+            return pgm_read_byte(async_current.str++);
+        case SEND_STRING_EEPROM:
+            if (!async_current.end) {
+                return eeprom_read_byte((const uint8_t *)async_current.str++);
+            }
+            if (async_current.str >= async_current.end) {
+                return 0;
+            }
+            if (async_current.str < async_eeprom_start || async_current.str >= async_eeprom_start + async_eeprom_fill) {
+                uint16_t left      = async_current.end - async_current.str;
+                async_eeprom_start = async_current.str;
+                async_eeprom_fill  = left < sizeof(async_eeprom_buffer) ? left : sizeof(async_eeprom_buffer);
+                eeprom_read_block(async_eeprom_buffer, async_eeprom_start, async_eeprom_fill);
+            }
+            return async_eeprom_buffer[async_current.str++ - async_eeprom_start];
+        default:
+            return *async_current.str++;
+    }
+}
+
+static char async_peek(void) {
+    char ascii_code = async_read();
+    async_current.str--;
+    return ascii_code;
+}
+
+/* Decodes the UTF-8 character at the head of the string without consuming
+ * it, returns the bytes it takes up. The codepoint is 0 where they don't
+ * make up a whole character, and are only to be skipped. */
+static uint8_t async_peek_utf8(uint32_t *codepoint) {
+    const char *start  = async_current.str;
+    uint8_t     lead   = async_read();
+    uint8_t     length = utf8_length(lead);
+    uint8_t     read   = 1;
+    *codepoint         = length ? lead & (0x7F >> length) : 0;
+    while (read < length) {
+        uint8_t next = async_read();
+        if ((next & 0xC0) != 0x80) {
+            // Cut short, the byte that cut it is the next character
+            *codepoint = 0;
+            break;
+        }
+        *codepoint = (*codepoint << 6) | (next & 0x3F);
+        read++;
+    }
+    async_current.str = start;
+    return read;
+}
+
+static void async_release(void) {
+    for (uint8_t i = 0; i < async_key_count; i++) {
+        del_key(async_keys[i]);
+    }
+    del_mods(async_mods);
+    send_keyboard_report();
+    async_key_count = 0;
+    async_mods      = 0;
+}
+
+/* Runs the SS_* code at the head of the string, with every key released */
+static void async_command(uint8_t code) {
+    uint8_t keycode = async_read();
+    if (code == SS_TAP_CODE) {
+        tap_code(keycode);
+    } else if (code == SS_DOWN_CODE) {
+        register_code(keycode);
+    } else if (code == SS_UP_CODE) {
+        unregister_code(keycode);
+    } else if (code == SS_DELAY_CODE) {
+        uint16_t ms = 0;
+        while (isdigit(keycode)) {
+            ms *= 10;
+            ms += keycode - '0';
+            keycode = async_read();
+        }
+        async_delay = ms;
+        async_timer = timer_read();
+    }
+}
+
+/* Sends at most one report: the next character is added to the keys
+ * already held, unless it repeats one of them, needs other modifiers or
+ * the batch is full, in which case everything is released first. */
+void send_string_task(void) {
+    if (async_delay) {
+        if (timer_elapsed(async_timer) < async_delay) {
+            return;
+        }
+        async_delay = 0;
+    }
+
+    if (async_dead) {
+        // A dead key is released on its own, then followed by a space
+        async_release();
+        tap_code(KC_SPACE);
+        async_dead = false;
+        return;
+    }
+
+    if (!async_current.str) {
+        if (!async_queue_count) {
+            if (async_key_count || async_mods) {
+                async_release();
+            }
+            return;
+        }
+        async_current      = async_queue[async_queue_head];
+        async_queue_head   = (async_queue_head + 1) % SEND_STRING_ASYNC_QUEUE_SIZE;
+        async_eeprom_start = NULL;
+        async_eeprom_fill  = 0;
+        async_queue_count--;
+    }
+
+    uint8_t ascii_code = async_peek();
+    if (!ascii_code) {
+        async_current.str = NULL;
+        if (async_key_count || async_mods) {
+            async_release();
+        }
+        return;
+    }
+
+    bool is_command = ascii_code == SS_QMK_PREFIX || (async_current.source == SEND_STRING_EEPROM && ascii_code <= SS_UP_CODE);
+    bool is_special = ascii_code == '\a';
+    if (is_command || is_special) {
+        if (async_key_count || async_mods) {
+            async_release();
+            return;
+        }
+        async_read();
+        if (!is_command) {
+            send_char(ascii_code);
+        } else if (async_current.source == SEND_STRING_EEPROM) {
+            // Dynamic macros store the code without a prefix
+            async_command(ascii_code);
+        } else {
+            async_command(async_read());
+        }
+        return;
+    }
+
+    uint8_t keycode;
+    uint8_t mods;
+    uint8_t length = 1;
+    bool    prefix = false;  // the dead key typed ahead of the character
+    if (ascii_code & 0x80) {
+        uint32_t              codepoint;
+        send_string_unicode_t entry;
+        length = async_peek_utf8(&codepoint);
+        if (!codepoint || !send_string_unicode_lookup(codepoint, &entry)) {
+            if (async_key_count || async_mods) {
+                async_release();
+                return;
+            }
+            async_current.str += length;
+#ifdef UNICODE_COMMON_ENABLE
+            if (codepoint) {
+                register_unicode(codepoint);
+            }
+#endif
+            return;
+        }
+        prefix  = entry.dead_keycode != KC_NO && !async_prefixed;
+        keycode = prefix ? entry.dead_keycode : entry.keycode;
+        mods    = prefix ? entry.dead_mods : entry.mods;
+    } else {
+        keycode = pgm_read_byte(&ascii_to_keycode_lut[ascii_code]);
+        mods    = (PGM_LOADBIT(ascii_to_shift_lut, ascii_code) ? MOD_BIT(KC_LSFT) : 0) | (PGM_LOADBIT(ascii_to_altgr_lut, ascii_code) ? MOD_BIT(KC_RALT) : 0);
+    }
+
+    if (async_key_count || async_mods) {
+        // A dead key goes down and back up on its own
+        bool repeat = async_key_count == SEND_STRING_ASYNC_BATCH || mods != async_mods || prefix || async_prefixed;
+        for (uint8_t i = 0; i < async_key_count && !repeat; i++) {
+            repeat = async_keys[i] == keycode;
+        }
+        if (repeat) {
+            async_release();
+            return;
+        }
+    }
+
+    if (keycode == KC_NO) {
+        async_current.str += length;
+        return;
+    }
+    if (mods != async_mods) {
+        // Modifiers change in a report of their own, ahead of the key
+        add_mods(mods);
+        async_mods = mods;
+        send_keyboard_report();
+        return;
+    }
+    add_key(keycode);
+    send_keyboard_report();
+    async_keys[async_key_count++] = keycode;
+    if (prefix) {
+        // The character itself follows, once the dead key is released
+        async_prefixed = true;
+        return;
+    }
+    async_current.str += length;
+    async_prefixed = false;
+    async_dead     = !(ascii_code & 0x80) && PGM_LOADBIT(ascii_to_dead_lut, ascii_code);
+}
+
 void send_char(char ascii_code) {
 #if defined(AUDIO_ENABLE) && defined(SENDSTRING_BELL)
     if (ascii_code == '\a') {  // BEL
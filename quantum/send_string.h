@@ -14,6 +14,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#pragma once
+
 #include <stdint.h>
 
 #include "progmem.h"
@@ -21,6 +23,7 @@
 
 #define SEND_STRING(string) send_string_P(PSTR(string))
 #define SEND_STRING_DELAY(string, interval) send_string_with_delay_P(PSTR(string), interval)
+#define SEND_STRING_ASYNC(string) send_string_async_P(PSTR(string))
 
 // Look-Up Tables (LUTs) to convert ASCII character to keycode sequence.
 extern const uint8_t ascii_to_shift_lut[16];
@@ -28,6 +31,15 @@ extern const uint8_t ascii_to_altgr_lut[16];
 extern const uint8_t ascii_to_dead_lut[16];
 extern const uint8_t ascii_to_keycode_lut[128];
 
+// A character beyond ASCII, in the table generated for SEND_STRING_LOCALE
+typedef struct {
+    uint16_t codepoint;
+    uint8_t  keycode;
+    uint8_t  mods;          // MOD_BIT()s held for keycode
+    uint8_t  dead_keycode;  // KC_NO, or a dead key tapped first
+    uint8_t  dead_mods;     // MOD_BIT()s held for dead_keycode
+} send_string_unicode_t;
+
 // clang-format off
 #define KCLUT_ENTRY(a, b, c, d, e, f, g, h) \
     ( ((a) ? 1 : 0) << 0 \
@@ -46,6 +58,22 @@ void send_string_P(const char *str);
 void send_string_with_delay_P(const char *str, uint8_t interval);
 void send_char(char ascii_code);
 
+// Queued strings, typed from the main loop without blocking it.
+// The string must stay valid until send_string_async_busy() is false.
+typedef enum {
+    SEND_STRING_RAM,
+    SEND_STRING_PROGMEM,
+    SEND_STRING_EEPROM,  // dynamic macro format, SS_* codes without SS_QMK_PREFIX
+} send_string_source_t;
+
+bool send_string_async(const char *str);
+bool send_string_async_P(const char *str);
+bool send_string_async_source(const char *str, send_string_source_t source);
+// A dynamic macro of length bytes, terminator included, read from EEPROM in blocks
+bool send_string_async_eeprom(const char *str, uint16_t length);
+bool send_string_async_busy(void);
+void send_string_task(void);
+
 void send_dword(uint32_t number);
 void send_word(uint16_t number);
 void send_byte(uint8_t number);
@@ -34,6 +34,15 @@ sequencer_config_t sequencer_config = {
 
 sequencer_state_t sequencer_internal_state = {0, 0, 0, 0, SEQUENCER_PHASE_ATTACK};
 
+/* Step durations are rarely a whole number of milliseconds. The part that
+ * does not fit is carried over from step to step, in 1/sequencer_get_step_divisor() ms. */
+static uint16_t step_carry = 0;
+
+#ifdef SEQUENCER_MIDI_CLOCK
+static uint8_t midi_clock_pulses = 0;
+static uint8_t midi_clock_steps  = 0;
+#endif
+
 bool is_sequencer_on(void) { return sequencer_config.enabled; }
 
 void sequencer_on(void) {
@@ -43,6 +52,11 @@ void sequencer_on(void) {
     sequencer_internal_state.current_step  = 0;
     sequencer_internal_state.timer         = timer_read();
     sequencer_internal_state.phase         = SEQUENCER_PHASE_ATTACK;
+    step_carry                             = 0;
+#ifdef SEQUENCER_MIDI_CLOCK
+    midi_clock_pulses = 0;
+    midi_clock_steps  = 0;
+#endif
 }
 
 void sequencer_off(void) {
@@ -69,9 +83,9 @@ bool is_sequencer_track_active(uint8_t track) { return (sequencer_internal_state
 
 void sequencer_set_track_activation(uint8_t track, bool value) {
     if (value) {
-        sequencer_internal_state.active_tracks |= (1 << track);
+        sequencer_internal_state.active_tracks |= SEQUENCER_TRACK_BIT(track);
     } else {
-        sequencer_internal_state.active_tracks &= ~(1 << track);
+        sequencer_internal_state.active_tracks &= ~SEQUENCER_TRACK_BIT(track);
     }
     dprintf("sequencer: track %d is %s\n", track, value ? "active" : "inactive");
 }
@@ -82,14 +96,31 @@ void sequencer_toggle_single_active_track(uint8_t track) {
     if (is_sequencer_track_active(track)) {
         sequencer_internal_state.active_tracks = 0;
     } else {
-        sequencer_internal_state.active_tracks = 1 << track;
+        sequencer_internal_state.active_tracks = SEQUENCER_TRACK_BIT(track);
+    }
+}
+
+#ifdef SEQUENCER_TRACK_VELOCITY
+uint8_t sequencer_get_track_velocity(uint8_t track) {
+    if (track >= SEQUENCER_TRACKS || sequencer_config.track_velocities[track] == 0) {
+        return 127;
     }
+    return sequencer_config.track_velocities[track];
 }
 
+void sequencer_set_track_velocity(uint8_t track, uint8_t velocity) {
+    if (track < SEQUENCER_TRACKS) {
+        sequencer_config.track_velocities[track] = velocity > 127 ? 127 : velocity;
+    }
+}
+#endif
+
 bool is_sequencer_step_on(uint8_t step) { return step < SEQUENCER_STEPS && (sequencer_config.steps[step] & sequencer_internal_state.active_tracks) > 0; }
 
 bool is_sequencer_step_on_for_track(uint8_t step, uint8_t track) { return step < SEQUENCER_STEPS && (sequencer_config.steps[step] >> track) & true; }
 
+sequencer_track_mask_t sequencer_get_step_tracks(uint8_t step) { return step < SEQUENCER_STEPS ? sequencer_config.steps[step] : 0; }
+
 void sequencer_set_step(uint8_t step, bool value) {
     if (step < SEQUENCER_STEPS) {
         if (value) {
@@ -165,17 +196,18 @@ void sequencer_phase_attack(void) {
     dprintf("sequencer: step %d\n", sequencer_internal_state.current_step);
     dprintf("sequencer: time %d\n", timer_read());
 
-    if (sequencer_internal_state.current_track == 0) {
-        sequencer_internal_state.timer = timer_read();
-    }
-
     if (timer_elapsed(sequencer_internal_state.timer) < sequencer_internal_state.current_track * SEQUENCER_TRACK_THROTTLE) {
         return;
     }
 
 #if defined(MIDI_ENABLE) || defined(MIDI_MOCKED)
-    if (is_sequencer_step_on_for_track(sequencer_internal_state.current_step, sequencer_internal_state.current_track)) {
-        process_midi_basic_noteon(midi_compute_note(sequencer_config.track_notes[sequencer_internal_state.current_track]));
+    if (sequencer_config.steps[sequencer_internal_state.current_step] & SEQUENCER_TRACK_BIT(sequencer_internal_state.current_track)) {
+        uint16_t note = midi_compute_note(sequencer_config.track_notes[sequencer_internal_state.current_track]);
+#    ifdef SEQUENCER_TRACK_VELOCITY
+        process_midi_basic_noteon_velocity(note, sequencer_get_track_velocity(sequencer_internal_state.current_track));
+#    else
+        process_midi_basic_noteon(note);
+#    endif
     }
 #endif
 
@@ -191,7 +223,7 @@ void sequencer_phase_release(void) {
         return;
     }
 #if defined(MIDI_ENABLE) || defined(MIDI_MOCKED)
-    if (is_sequencer_step_on_for_track(sequencer_internal_state.current_step, sequencer_internal_state.current_track)) {
+    if (sequencer_config.steps[sequencer_internal_state.current_step] & SEQUENCER_TRACK_BIT(sequencer_internal_state.current_track)) {
         process_midi_basic_noteoff(midi_compute_note(sequencer_config.track_notes[sequencer_internal_state.current_track]));
     }
 #endif
@@ -203,14 +235,58 @@ void sequencer_phase_release(void) {
 }
 
 void sequencer_phase_pause(void) {
-    if (timer_elapsed(sequencer_internal_state.timer) < sequencer_get_step_duration()) {
+#ifdef SEQUENCER_MIDI_CLOCK
+    if (!midi_clock_steps) {
+        return;
+    }
+    midi_clock_steps--;
+    sequencer_internal_state.timer = timer_read();
+#else
+    // Every so often the fractions of a ms add up to one more
+    uint16_t duration = sequencer_get_step_duration();
+    uint16_t carry    = step_carry + sequencer_get_step_remainder();
+    if (carry >= sequencer_get_step_divisor()) {
+        carry -= sequencer_get_step_divisor();
+        duration++;
+    }
+    if (timer_elapsed(sequencer_internal_state.timer) < duration) {
         return;
     }
 
+    /* The next step starts where this one was due to end, not whenever the
+     * main loop got here, so that late steps do not push back the ones after them. */
+    step_carry = carry;
+    sequencer_internal_state.timer += duration;
+
+    // More than a whole step behind, e.g. after the main loop was blocked: start over from now
+    if (timer_elapsed(sequencer_internal_state.timer) >= duration) {
+        sequencer_internal_state.timer = timer_read();
+        step_carry                     = 0;
+    }
+#endif
+
     sequencer_internal_state.current_step = (sequencer_internal_state.current_step + 1) % SEQUENCER_STEPS;
     sequencer_internal_state.phase        = SEQUENCER_PHASE_ATTACK;
 }
 
+#ifdef SEQUENCER_MIDI_CLOCK
+void sequencer_midi_clock(void) {
+    if (!sequencer_config.enabled) {
+        return;
+    }
+    if (++midi_clock_pulses >= sequencer_get_step_pulses()) {
+        midi_clock_pulses = 0;
+        midi_clock_steps++;
+    }
+}
+
+void sequencer_midi_start(void) {
+    if (sequencer_config.enabled) {
+        sequencer_on();
+    }
+}
+#endif
+
 void matrix_scan_sequencer(void) {
     if (!sequencer_config.enabled) {
         return;
@@ -233,6 +309,12 @@ uint16_t sequencer_get_beat_duration(void) { return get_beat_duration(sequencer_
 
 uint16_t sequencer_get_step_duration(void) { return get_step_duration(sequencer_config.tempo, sequencer_config.resolution); }
 
+uint16_t sequencer_get_step_divisor(void) { return get_step_divisor(sequencer_config.tempo, sequencer_config.resolution); }
+
+uint16_t sequencer_get_step_remainder(void) { return get_step_remainder(sequencer_config.tempo, sequencer_config.resolution); }
+
+uint8_t sequencer_get_step_pulses(void) { return get_step_pulses(sequencer_config.resolution); }
+
 uint16_t get_beat_duration(uint8_t tempo) {
     // Don’t crash in the unlikely case where the given tempo is 0
     if (tempo == 0) {
@@ -251,6 +333,9 @@ uint16_t get_beat_duration(uint8_t tempo) {
     return 60000 / tempo;
 }
 
+// Milliseconds in 4 beats at 1 bpm, doubled for the ternary resolutions (see get_step_divisor)
+static uint32_t get_step_total(sequencer_resolution_t resolution) { return resolution % 2 == 0 ? 240000UL : 480000UL; }
+
 uint16_t get_step_duration(uint8_t tempo, sequencer_resolution_t resolution) {
     /**
      * Resolution cheatsheet:
@@ -267,9 +352,38 @@ uint16_t get_step_duration(uint8_t tempo, sequencer_resolution_t resolution) {
      * The number of steps for binary resolutions follows the powers of 2.
      * The ternary variants are simply 1.5x faster.
      */
-    bool     is_binary            = resolution % 2 == 0;
-    uint8_t  binary_steps         = 2 << (resolution / 2);
-    uint16_t binary_step_duration = get_beat_duration(tempo) * 4 / binary_steps;
+    return get_step_total(resolution) / get_step_divisor(tempo, resolution);
+}
+
+/**
+ * The exact step duration is 240000ms / (tempo * steps per 4 beats), where the
+ * ternary resolutions have 1.5x the steps of the binary one below them:
+ *  binary:  240000ms / (tempo * binary_steps)
+ *  ternary: 480000ms / (tempo * binary_steps * 3)
+ * get_step_duration() is the whole number of ms, get_step_remainder() the
+ * fraction left over, in 1/get_step_divisor() ms.
+ */
+uint16_t get_step_divisor(uint8_t tempo, sequencer_resolution_t resolution) {
+    // Don’t crash in the unlikely case where the given tempo is 0
+    if (tempo == 0) {
+        tempo = 60;
+    }
+    bool    is_binary    = resolution % 2 == 0;
+    uint8_t binary_steps = 2 << (resolution / 2);
+
+    return tempo * binary_steps * (is_binary ? 1 : 3);
+}
+
+uint16_t get_step_remainder(uint8_t tempo, sequencer_resolution_t resolution) { return get_step_total(resolution) % get_step_divisor(tempo, resolution); }
+
+uint8_t get_step_pulses(sequencer_resolution_t resolution) {
+    /**
+     * MIDI clock runs at 24 pulses per beat, so 96 pulses per 4 beats:
+     *  binary:  96 / binary_steps
+     *  ternary: 96 / (binary_steps * 1.5) = 64 / binary_steps
+     */
+    bool    is_binary    = resolution % 2 == 0;
+    uint8_t binary_steps = 2 << (resolution / 2);
 
-    return is_binary ? binary_step_duration : 2 * binary_step_duration / 3;
+    return (is_binary ? 96 : 64) / binary_steps;
 }
@@ -25,7 +25,7 @@
 #    define SEQUENCER_STEPS 16
 #endif
 
-// Maximum number of tracks: 8
+// Maximum number of tracks: 32
 #ifndef SEQUENCER_TRACKS
 #    define SEQUENCER_TRACKS 8
 #endif
@@ -38,6 +38,22 @@
 #    define SEQUENCER_PHASE_RELEASE_TIMEOUT 30
 #endif
 
+/**
+ * Each step is a mask with a bit per track, as narrow as SEQUENCER_TRACKS allows: patterns of
+ * up to 8 tracks take a byte per step, up to 16 tracks two and up to 32 tracks four.
+ */
+#if SEQUENCER_TRACKS <= 8
+typedef uint8_t sequencer_track_mask_t;
+#elif SEQUENCER_TRACKS <= 16
+typedef uint16_t sequencer_track_mask_t;
+#elif SEQUENCER_TRACKS <= 32
+typedef uint32_t sequencer_track_mask_t;
+#else
+#    error "SEQUENCER_TRACKS must be 32 or less"
+#endif
+
+#define SEQUENCER_TRACK_BIT(track) ((sequencer_track_mask_t)1 << (track))
+
 /**
  * Make sure that the items of this enumeration follow the powers of 2, separated by a ternary variant.
  * Check the implementation of `get_step_duration` for further explanation.
@@ -46,10 +62,13 @@ typedef enum { SQ_RES_2, SQ_RES_2T, SQ_RES_4, SQ_RES_4T, SQ_RES_8, SQ_RES_8T, SQ
 
 typedef struct {
     bool                   enabled;
-    uint8_t                steps[SEQUENCER_STEPS];
+    sequencer_track_mask_t steps[SEQUENCER_STEPS];
     uint16_t               track_notes[SEQUENCER_TRACKS];
     uint8_t                tempo;  // Is a maximum tempo of 255 reasonable?
     sequencer_resolution_t resolution;
+#ifdef SEQUENCER_TRACK_VELOCITY
+    uint8_t                track_velocities[SEQUENCER_TRACKS];  // 1 to 127, 0 plays the track at full velocity
+#endif
 } sequencer_config_t;
 
 /**
@@ -63,11 +82,11 @@ typedef enum sequencer_phase_t {
 } sequencer_phase_t;
 
 typedef struct {
-    uint8_t           active_tracks;
-    uint8_t           current_track;
-    uint8_t           current_step;
-    uint16_t          timer;
-    sequencer_phase_t phase;
+    sequencer_track_mask_t active_tracks;
+    uint8_t                current_track;
+    uint8_t                current_step;
+    uint16_t               timer;
+    sequencer_phase_t      phase;
 } sequencer_state_t;
 
 extern sequencer_config_t sequencer_config;
@@ -87,11 +106,18 @@ void sequencer_set_track_activation(uint8_t track, bool value);
 void sequencer_toggle_track_activation(uint8_t track);
 void sequencer_toggle_single_active_track(uint8_t track);
 
+#ifdef SEQUENCER_TRACK_VELOCITY
+uint8_t sequencer_get_track_velocity(uint8_t track);
+void    sequencer_set_track_velocity(uint8_t track, uint8_t velocity);
+#endif
+
 #define sequencer_activate_track(track) sequencer_set_track_activation(track, true)
 #define sequencer_deactivate_track(track) sequencer_set_track_activation(track, false)
 
 bool is_sequencer_step_on(uint8_t step);
 bool is_sequencer_step_on_for_track(uint8_t step, uint8_t track);
+// The tracks that play on the step, whether they are active or not
+sequencer_track_mask_t sequencer_get_step_tracks(uint8_t step);
 void sequencer_set_step(uint8_t step, bool value);
 void sequencer_toggle_step(uint8_t step);
 void sequencer_set_all_steps(bool value);
@@ -116,7 +142,20 @@ uint8_t sequencer_get_current_step(void);
 uint16_t sequencer_get_beat_duration(void);
 uint16_t sequencer_get_step_duration(void);
 
+uint16_t sequencer_get_step_divisor(void);
+uint16_t sequencer_get_step_remainder(void);
+uint8_t  sequencer_get_step_pulses(void);
+
 uint16_t get_beat_duration(uint8_t tempo);
 uint16_t get_step_duration(uint8_t tempo, sequencer_resolution_t resolution);
+uint16_t get_step_divisor(uint8_t tempo, sequencer_resolution_t resolution);
+uint16_t get_step_remainder(uint8_t tempo, sequencer_resolution_t resolution);
+uint8_t  get_step_pulses(sequencer_resolution_t resolution);
+
+#ifdef SEQUENCER_MIDI_CLOCK
+// Feed the sequencer from an external MIDI clock instead of its own tempo
+void sequencer_midi_clock(void);
+void sequencer_midi_start(void);
+#endif
 
 void matrix_scan_sequencer(void);
@@ -16,11 +16,17 @@
 
 #include "midi_mock.h"
 
-uint16_t last_noteon  = 0;
-uint16_t last_noteoff = 0;
+uint16_t last_noteon   = 0;
+uint16_t last_noteoff  = 0;
+uint8_t  last_velocity = 0;
 
 uint16_t midi_compute_note(uint16_t keycode) { return keycode; }
 
-void process_midi_basic_noteon(uint16_t note) { last_noteon = note; }
+void process_midi_basic_noteon(uint16_t note) { process_midi_basic_noteon_velocity(note, 127); }
+
+void process_midi_basic_noteon_velocity(uint16_t note, uint8_t velocity) {
+    last_noteon   = note;
+    last_velocity = velocity;
+}
 
 void process_midi_basic_noteoff(uint16_t note) { last_noteoff = note; }
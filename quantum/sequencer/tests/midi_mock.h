@@ -20,7 +20,9 @@
 
 extern uint16_t last_noteon;
 extern uint16_t last_noteoff;
+extern uint8_t  last_velocity;
 
 uint16_t midi_compute_note(uint16_t keycode);
 void     process_midi_basic_noteon(uint16_t note);
+void     process_midi_basic_noteon_velocity(uint16_t note, uint8_t velocity);
 void     process_midi_basic_noteoff(uint16_t note);
@@ -9,3 +9,12 @@ sequencer_SRC := \
 	$(QUANTUM_PATH)/sequencer/tests/sequencer_tests.cpp \
 	$(QUANTUM_PATH)/sequencer/sequencer.c \
 	$(TMK_PATH)/common/test/timer.c
+
+# 32 tracks take a 32 bit mask per step, and each track has a velocity
+sequencer_wide_DEFS := -DNO_DEBUG -DMIDI_MOCKED -DSEQUENCER_TRACKS=32 -DSEQUENCER_STEPS=64 -DSEQUENCER_TRACK_VELOCITY
+
+sequencer_wide_SRC := \
+	$(QUANTUM_PATH)/sequencer/tests/midi_mock.c \
+	$(QUANTUM_PATH)/sequencer/tests/sequencer_wide_tests.cpp \
+	$(QUANTUM_PATH)/sequencer/sequencer.c \
+	$(TMK_PATH)/common/test/timer.c
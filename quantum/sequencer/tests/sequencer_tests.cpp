@@ -268,6 +268,14 @@ TEST_F(SequencerTest, TestSetAllStepsOff) {
     EXPECT_EQ(sequencer_config.steps[4], (1 << 1));
 }
 
+TEST_F(SequencerTest, TestGetStepTracks) {
+    sequencer_internal_state.active_tracks = (1 << 1);
+    sequencer_config.steps[2]              = (1 << 7) + (1 << 6);
+
+    EXPECT_EQ(sequencer_get_step_tracks(2), (1 << 7) + (1 << 6));
+    EXPECT_EQ(sequencer_get_step_tracks(SEQUENCER_STEPS), 0);
+}
+
 TEST_F(SequencerTest, TestSetTempoZero) {
     sequencer_config.tempo = 123;
 
@@ -588,3 +596,85 @@ TEST_F(SequencerTest, TestMatrixScanSequencerShouldLoopOnceSequenceIsOver) {
     EXPECT_EQ(sequencer_internal_state.current_track, 1);
     EXPECT_EQ(sequencer_internal_state.phase, SEQUENCER_PHASE_ATTACK);
 }
+
+TEST_F(SequencerTest, TestGetStepRemainder) {
+    // 1/2T at tempo=60 lasts 1333.33ms
+    EXPECT_EQ(get_step_divisor(60, SQ_RES_2T), 360);
+    EXPECT_EQ(get_step_remainder(60, SQ_RES_2T), 120);
+    // 1/16T at tempo=120 lasts 83.33ms
+    EXPECT_EQ(get_step_divisor(120, SQ_RES_16T), 5760);
+    EXPECT_EQ(get_step_remainder(120, SQ_RES_16T), 1920);
+    // 1/16 at tempo=120 lasts exactly 125ms
+    EXPECT_EQ(get_step_remainder(120, SQ_RES_16), 0);
+    // 1/4 at tempo=7 lasts 8571.43ms
+    EXPECT_EQ(get_step_duration(7, SQ_RES_4), 8571);
+    EXPECT_EQ(get_step_remainder(7, SQ_RES_4), 12);
+}
+
+TEST_F(SequencerTest, TestGetStepPulses) {
+    // MIDI clock sends 24 pulses per beat
+    EXPECT_EQ(get_step_pulses(SQ_RES_2), 48);
+    EXPECT_EQ(get_step_pulses(SQ_RES_2T), 32);
+    EXPECT_EQ(get_step_pulses(SQ_RES_4), 24);
+    EXPECT_EQ(get_step_pulses(SQ_RES_4T), 16);
+    EXPECT_EQ(get_step_pulses(SQ_RES_8), 12);
+    EXPECT_EQ(get_step_pulses(SQ_RES_8T), 8);
+    EXPECT_EQ(get_step_pulses(SQ_RES_16), 6);
+    EXPECT_EQ(get_step_pulses(SQ_RES_16T), 4);
+    EXPECT_EQ(get_step_pulses(SQ_RES_32), 3);
+}
+
+TEST_F(SequencerTest, TestMatrixScanSequencerStepsDoNotDriftWithLoopJitter) {
+    setUpMatrixScanSequencerTest();
+    sequencer_config.resolution = SQ_RES_16T;
+    sequencer_on();
+
+    // Scan at irregular intervals of 1 to 3ms, enough to get through all tracks within a step
+    uint32_t now  = 0;
+    uint32_t seed = 1;
+    uint8_t  step = 0;
+    for (uint32_t steps = 0; steps < 48;) {
+        seed        = seed * 1103515245 + 12345;
+        uint32_t ms = 1 + (seed >> 16) % 3;
+        advance_time(ms);
+        now += ms;
+        matrix_scan_sequencer();
+
+        if (sequencer_internal_state.current_step != step) {
+            step = sequencer_internal_state.current_step;
+            steps++;
+            // Each step is due at steps * 83.33ms, and starts with the first scan after that
+            uint32_t due = steps * 480000 / get_step_divisor(120, SQ_RES_16T);
+            EXPECT_GE(now, due);
+            EXPECT_LT(now, due + 3);
+        }
+    }
+}
+
+TEST_F(SequencerTest, TestMatrixScanSequencerStartsOverAfterStall) {
+    setUpMatrixScanSequencerTest();
+    sequencer_on();
+
+    uint32_t now = 0;
+    auto     run = [&](uint8_t step) {
+        while (sequencer_internal_state.current_step != step) {
+            advance_time(1);
+            now++;
+            matrix_scan_sequencer();
+        }
+    };
+
+    // One 16th at tempo=120 lasts 125ms
+    run(1);
+    EXPECT_EQ(now, 125);
+
+    // Block the main loop for several steps
+    advance_time(1000);
+    now += 1000;
+    run(2);
+    uint32_t resumed = now;
+
+    // The missed steps are skipped rather than played back to back
+    run(3);
+    EXPECT_EQ(now - resumed, 125);
+}
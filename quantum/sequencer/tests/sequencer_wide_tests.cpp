@@ -0,0 +1,125 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "sequencer.h"
+#include "midi_mock.h"
+#include "quantum/quantum_keycodes.h"
+}
+
+extern "C" {
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+class SequencerWideTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        memset(&sequencer_config.steps, 0, sizeof(sequencer_config.steps));
+        memset(&sequencer_config.track_velocities, 0, sizeof(sequencer_config.track_velocities));
+        sequencer_config.enabled    = false;
+        sequencer_config.tempo      = 120;
+        sequencer_config.resolution = SQ_RES_16;
+
+        sequencer_internal_state.active_tracks = 0;
+        sequencer_internal_state.current_track = 0;
+        sequencer_internal_state.current_step  = 0;
+        sequencer_internal_state.phase         = SEQUENCER_PHASE_ATTACK;
+
+        last_noteon   = 0;
+        last_noteoff  = 0;
+        last_velocity = 0;
+
+        set_time(0);
+    }
+};
+
+TEST_F(SequencerWideTest, TestStepMaskHoldsEveryTrack) {
+    EXPECT_EQ(sizeof(sequencer_config.steps[0]), 4u);
+    EXPECT_EQ(sizeof(sequencer_config.steps), 4u * SEQUENCER_STEPS);
+}
+
+TEST_F(SequencerWideTest, TestHighTrackActivation) {
+    sequencer_set_track_activation(31, true);
+    sequencer_set_track_activation(17, true);
+
+    EXPECT_EQ(is_sequencer_track_active(31), true);
+    EXPECT_EQ(is_sequencer_track_active(17), true);
+    EXPECT_EQ(is_sequencer_track_active(1), false);
+    EXPECT_EQ(sequencer_internal_state.active_tracks, (1UL << 31) + (1UL << 17));
+
+    sequencer_toggle_single_active_track(24);
+    EXPECT_EQ(sequencer_internal_state.active_tracks, 1UL << 24);
+}
+
+TEST_F(SequencerWideTest, TestSetStepsForHighTracks) {
+    sequencer_internal_state.active_tracks = (1UL << 31) + (1UL << 16);
+    sequencer_config.steps[40]             = (1UL << 20) + (1UL << 16);
+
+    sequencer_set_step_on(40);
+    sequencer_set_step_on(63);
+
+    EXPECT_EQ(sequencer_get_step_tracks(40), (1UL << 31) + (1UL << 20) + (1UL << 16));
+    EXPECT_EQ(sequencer_get_step_tracks(63), (1UL << 31) + (1UL << 16));
+    EXPECT_EQ(sequencer_get_step_tracks(64), 0u);
+    EXPECT_EQ(is_sequencer_step_on_for_track(40, 20), true);
+    EXPECT_EQ(is_sequencer_step_on_for_track(40, 21), false);
+
+    sequencer_set_all_steps_off();
+    EXPECT_EQ(sequencer_get_step_tracks(40), 1UL << 20);
+    EXPECT_EQ(sequencer_get_step_tracks(63), 0u);
+}
+
+TEST_F(SequencerWideTest, TestStepOnIsAnyActiveTrack) {
+    sequencer_config.steps[5]              = 1UL << 30;
+    sequencer_internal_state.active_tracks = 1UL << 29;
+    EXPECT_EQ(is_sequencer_step_on(5), false);
+
+    sequencer_internal_state.active_tracks |= 1UL << 30;
+    EXPECT_EQ(is_sequencer_step_on(5), true);
+}
+
+TEST_F(SequencerWideTest, TestTrackVelocity) {
+    // Not set, the track plays at full velocity
+    EXPECT_EQ(sequencer_get_track_velocity(3), 127);
+
+    sequencer_set_track_velocity(3, 64);
+    EXPECT_EQ(sequencer_get_track_velocity(3), 64);
+
+    sequencer_set_track_velocity(3, 200);
+    EXPECT_EQ(sequencer_get_track_velocity(3), 127);
+
+    EXPECT_EQ(sequencer_get_track_velocity(SEQUENCER_TRACKS), 127);
+}
+
+TEST_F(SequencerWideTest, TestMatrixScanSequencerAttacksHighTrackWithItsVelocity) {
+    sequencer_config.enabled         = true;
+    sequencer_config.track_notes[20] = MI_E;
+    sequencer_config.steps[0]        = 1UL << 20;
+    sequencer_set_track_velocity(20, 90);
+
+    // Tracks are attacked one after the other, SEQUENCER_TRACK_THROTTLE ms apart
+    for (uint8_t track = 0; track <= 20; track++) {
+        matrix_scan_sequencer();
+        advance_time(SEQUENCER_TRACK_THROTTLE);
+    }
+
+    EXPECT_EQ(last_noteon, MI_E);
+    EXPECT_EQ(last_velocity, 90);
+    EXPECT_EQ(sequencer_internal_state.current_track, 21);
+}
@@ -1 +1,3 @@
-TEST_LIST += sequencer
+TEST_LIST +=\
+	sequencer\
+	sequencer_wide
@@ -16,9 +16,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "util.h"
 #include "matrix.h"
 #include "debounce.h"
+#include "task_profile.h"
+#include "latency_probe.h"
 #include "quantum.h"
 #include "split_util.h"
 #include "config.h"
@@ -38,6 +41,7 @@ static pin_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
 /* matrix state(1:on, 0:off) */
 extern matrix_row_t raw_matrix[MATRIX_ROWS];  // raw values
 extern matrix_row_t matrix[MATRIX_ROWS];      // debounced values
+extern uint16_t     matrix_row_time[MATRIX_ROWS];
 
 // row offsets for each hand
 uint8_t thisHand, thatHand;
@@ -45,6 +49,47 @@ uint8_t thisHand, thatHand;
 // user-defined overridable functions
 __attribute__((weak)) void matrix_slave_scan_user(void) {}
 
+// fallbacks for custom transports that don't carry the slave's scan times
+__attribute__((weak)) void transport_master_row_times(uint16_t slave_row_time[]) {
+    uint16_t now = sync_timer_read();
+    for (int i = 0; i < ROWS_PER_HAND; ++i) {
+        slave_row_time[i] = now;
+    }
+}
+
+__attribute__((weak)) void transport_slave_row_times(uint16_t slave_row_time[]) {}
+
+#ifdef SPLIT_TRANSPORT_EVENTS
+// Applies the slave's key events in order. keyboard_task() only sees one time per row and one change per key in a
+// scan, so an event for a key that already changed, or for a row that already changed at another time, waits.
+static bool matrix_apply_slave_events(void) {
+    matrix_row_t             applied[ROWS_PER_HAND] = {0};
+    bool                     changed                = false;
+    const split_key_event_t *event;
+
+    while ((event = transport_master_event_peek())) {
+        if (event->row < ROWS_PER_HAND && event->col < MATRIX_COLS) {
+            uint8_t      row      = thatHand + event->row;
+            matrix_row_t col_mask = (matrix_row_t)1 << event->col;
+            if ((applied[event->row] & col_mask) || (applied[event->row] && matrix_row_time[row] != event->time)) {
+                break;
+            }
+            if (event->pressed) {
+                matrix[row] |= col_mask;
+            } else {
+                matrix[row] &= ~col_mask;
+            }
+            matrix_row_time[row] = event->time;
+            matrix_mark_row_changed(row);
+            applied[event->row] |= col_mask;
+            changed = true;
+        }
+        transport_master_event_drop();
+    }
+    return changed;
+}
+#endif
+
 static inline void setPinOutput_writeLow(pin_t pin) {
     ATOMIC_BLOCK_FORCEON {
         setPinOutput(pin);
@@ -97,6 +142,63 @@ static void select_row(uint8_t row) { setPinOutput_writeLow(row_pins[row]); }
 
 static void unselect_row(uint8_t row) { setPinInputHigh_atomic(row_pins[row]); }
 
+#        ifdef MATRIX_READ_COLS_BY_PORT
+// Runs of columns wired to consecutive pads of the same port, built from col_pins[] at init
+typedef struct {
+    uint8_t     port;  // index into col_ports[]
+    uint8_t     pad;   // pad of the first column of the run
+    uint8_t     col;   // first column of the run
+    port_data_t mask;  // one bit per column of the run
+} col_run_t;
+
+static pin_t     col_ports[MATRIX_COLS];
+static uint8_t   col_port_count;
+static col_run_t col_runs[MATRIX_COLS];
+static uint8_t   col_run_count;
+
+static void init_col_runs(void) {
+    col_port_count = 0;
+    col_run_count  = 0;
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        pin_t pin = col_pins[col];
+
+        // Extend the previous run if this pin is the next pad on the same port
+        if (col_run_count > 0) {
+            col_run_t *run = &col_runs[col_run_count - 1];
+            if (samePinPort(col_ports[run->port], pin) && getPinPad(pin) == run->pad + col - run->col) {
+                run->mask = (run->mask << 1) | 1;
+                continue;
+            }
+        }
+
+        uint8_t port = 0;
+        while (port < col_port_count && !samePinPort(col_ports[port], pin)) {
+            port++;
+        }
+        if (port == col_port_count) {
+            col_ports[col_port_count++] = pin;
+        }
+
+        col_runs[col_run_count++] = (col_run_t){.port = port, .pad = getPinPad(pin), .col = col, .mask = 1};
+    }
+}
+
+static matrix_row_t read_cols(void) {
+    // Sample every port once, then assemble the row from the runs
+    port_data_t port_values[MATRIX_COLS];
+    for (uint8_t port = 0; port < col_port_count; port++) {
+        port_values[port] = ~readPinPort(col_ports[port]);
+    }
+
+    matrix_row_t row_value = 0;
+    for (uint8_t i = 0; i < col_run_count; i++) {
+        const col_run_t *run = &col_runs[i];
+        row_value |= (matrix_row_t)((port_values[run->port] >> run->pad) & run->mask) << run->col;
+    }
+    return row_value;
+}
+#        endif
+
 static void unselect_rows(void) {
     for (uint8_t x = 0; x < ROWS_PER_HAND; x++) {
         setPinInputHigh_atomic(row_pins[x]);
@@ -108,6 +210,9 @@ static void init_pins(void) {
     for (uint8_t x = 0; x < MATRIX_COLS; x++) {
         setPinInputHigh_atomic(col_pins[x]);
     }
+#        ifdef MATRIX_READ_COLS_BY_PORT
+    init_col_runs();
+#        endif
 }
 
 static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row) {
@@ -118,6 +223,9 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
     select_row(current_row);
     matrix_output_select_delay();
 
+#        ifdef MATRIX_READ_COLS_BY_PORT
+    current_row_value = read_cols();
+#        else
     // For each col...
     for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
         // Select the col pin to read (active low)
@@ -126,6 +234,7 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
         // Populate the matrix row with the state of the col pin
         current_row_value |= pin_state ? 0 : (MATRIX_ROW_SHIFTER << col_index);
     }
+#        endif
 
     // Unselect row
     unselect_row(current_row);
@@ -256,7 +365,13 @@ bool matrix_post_scan(void) {
     if (is_keyboard_master()) {
         static uint8_t error_count;
 
+#ifdef SPLIT_TRANSPORT_EVENTS
+        // Only overwritten when the halves resync, the events bring every other change
+        matrix_row_t slave_matrix[ROWS_PER_HAND];
+        memcpy(slave_matrix, matrix + thatHand, sizeof(slave_matrix));
+#else
         matrix_row_t slave_matrix[ROWS_PER_HAND] = {0};
+#endif
         if (!transport_master(matrix + thisHand, slave_matrix)) {
             error_count++;
 
@@ -265,6 +380,7 @@ bool matrix_post_scan(void) {
                 for (int i = 0; i < ROWS_PER_HAND; ++i) {
                     matrix[thatHand + i] = 0;
                     slave_matrix[i]      = 0;
+                    matrix_mark_row_changed(thatHand + i);
                 }
 
                 changed = true;
@@ -272,18 +388,36 @@ bool matrix_post_scan(void) {
         } else {
             error_count = 0;
 
+            uint16_t slave_row_time[ROWS_PER_HAND];
+            transport_master_row_times(slave_row_time);
+
             for (int i = 0; i < ROWS_PER_HAND; ++i) {
                 if (matrix[thatHand + i] != slave_matrix[i]) {
-                    matrix[thatHand + i] = slave_matrix[i];
-                    changed              = true;
+                    matrix[thatHand + i]          = slave_matrix[i];
+                    matrix_row_time[thatHand + i] = slave_row_time[i];
+                    changed                       = true;
+                    matrix_mark_row_changed(thatHand + i);
                 }
             }
+#ifdef SPLIT_TRANSPORT_EVENTS
+            changed |= matrix_apply_slave_events();
+#endif
         }
 
         matrix_scan_quantum();
     } else {
+        matrix_row_t master_matrix[ROWS_PER_HAND];
+        memcpy(master_matrix, matrix + thatHand, sizeof(master_matrix));
+
+        transport_slave_row_times(matrix_row_time + thisHand);
         transport_slave(matrix + thatHand, matrix + thisHand);
 
+        for (int i = 0; i < ROWS_PER_HAND; ++i) {
+            if (matrix[thatHand + i] != master_matrix[i]) {
+                matrix_mark_row_changed(thatHand + i);
+            }
+        }
+
         matrix_slave_scan_user();
     }
 
@@ -305,7 +439,9 @@ uint8_t matrix_scan(void) {
     }
 #endif
 
-    debounce(raw_matrix, matrix + thisHand, ROWS_PER_HAND, local_changed);
+    latency_probe_raw_matrix(raw_matrix, thisHand, ROWS_PER_HAND, local_changed);
+    TASK_PROFILE(TASK_PROFILE_DEBOUNCE, debounce(raw_matrix, matrix + thisHand, ROWS_PER_HAND, local_changed));
+    matrix_update_row_times(thisHand, ROWS_PER_HAND);
 
     bool remote_changed = matrix_post_scan();
     return (uint8_t)(local_changed || remote_changed);
@@ -16,4 +16,24 @@
 // When using serial and RGBLIGHT_SPLIT need separate transaction
 #        define SERIAL_USE_MULTI_TRANSACTION
 #    endif
+#    if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT) && !defined(SERIAL_USE_MULTI_TRANSACTION)
+#        define SERIAL_USE_MULTI_TRANSACTION
+#    endif
+#    if defined(SPLIT_POINTING_ENABLE) && !defined(SERIAL_USE_MULTI_TRANSACTION)
+#        define SERIAL_USE_MULTI_TRANSACTION
+#    endif
+// Key events from the slave are polled for like the rest of the delta transport
+#    if defined(SPLIT_TRANSPORT_EVENTS) && !defined(SPLIT_TRANSPORT_DELTA)
+#        define SPLIT_TRANSPORT_DELTA
+#    endif
+// The delta transport reads the matrix in a transaction of its own
+#    if defined(SPLIT_TRANSPORT_DELTA) && !defined(SERIAL_USE_MULTI_TRANSACTION)
+#        define SERIAL_USE_MULTI_TRANSACTION
+#    endif
+#    if defined(SPLIT_SHARED_OBJECTS) && !defined(SERIAL_USE_MULTI_TRANSACTION)
+#        define SERIAL_USE_MULTI_TRANSACTION
+#    endif
+#    if defined(SPLIT_OLED_MIRROR) && !defined(SERIAL_USE_MULTI_TRANSACTION)
+#        define SERIAL_USE_MULTI_TRANSACTION
+#    endif
 #endif
@@ -35,6 +35,17 @@
 #    define SPLIT_USB_DETECT  // Force this on for now
 #endif
 
+// The line a slave sees the master's transactions on, they pull it low out of its idle high
+#if defined(SPLIT_USB_DETECT) && !defined(USE_I2C) && !defined(SPLIT_USB_DETECT_NO_LINE) && !defined(SPLIT_USB_DETECT_LINE_PIN)
+#    if defined(SERIAL_DRIVER_USART_DUPLEX) && defined(SERIAL_USART_RX_PIN)
+#        define SPLIT_USB_DETECT_LINE_PIN SERIAL_USART_RX_PIN
+#    elif defined(SOFT_SERIAL_PIN)
+#        define SPLIT_USB_DETECT_LINE_PIN SOFT_SERIAL_PIN
+#    elif defined(SERIAL_USART_TX_PIN)
+#        define SPLIT_USB_DETECT_LINE_PIN SERIAL_USART_TX_PIN
+#    endif
+#endif
+
 volatile bool isLeftHand = true;
 
 #if defined(SPLIT_USB_DETECT)
@@ -58,13 +69,37 @@ static inline bool usbHasActiveConnection(void) { return true; }
 static inline void usbDisable(void) {}
 #    endif
 
+#    ifdef SPLIT_USB_DETECT_LINE_PIN
+// Watches the split line between two USB polls, true as soon as the other half, having found USB first, starts
+// its transactions
+static bool splitLineActive(void) {
+    uint16_t start = timer_read();
+    do {
+        if (!readPin(SPLIT_USB_DETECT_LINE_PIN)) {
+            return true;
+        }
+    } while (timer_elapsed(start) < SPLIT_USB_TIMEOUT_POLL);
+    return false;
+}
+#    endif
+
 bool usbIsActive(void) {
+#    ifdef SPLIT_USB_DETECT_LINE_PIN
+    setPinInputHigh(SPLIT_USB_DETECT_LINE_PIN);
+#    endif
     for (uint8_t i = 0; i < (SPLIT_USB_TIMEOUT / SPLIT_USB_TIMEOUT_POLL); i++) {
         // This will return true if a USB connection has been established
         if (usbHasActiveConnection()) {
             return true;
         }
+#    ifdef SPLIT_USB_DETECT_LINE_PIN
+        // The other half is the master, so this one is the slave without waiting out the timeout
+        if (splitLineActive()) {
+            break;
+        }
+#    else
         wait_ms(SPLIT_USB_TIMEOUT_POLL);
+#    endif
     }
 
     // Avoid NO_USB_STARTUP_CHECK - Disable USB as the previous checks seem to enable it somehow
@@ -0,0 +1,37 @@
+# The letter case of these variables might seem odd. However:
+# - it is consistent with the serial_link example that is used as a reference in the Unit Testing article (https://docs.qmk.fm/#/unit_testing?id=adding-tests-for-new-or-existing-features)
+# - Neither `make test:split_transport_serial` or `make test:SPLIT_TRANSPORT_SERIAL` work when using SCREAMING_SNAKE_CASE
+
+SPLIT_TRANSPORT_COMMON_DEFS := -DNO_DEBUG -DMATRIX_ROWS=10 -DMATRIX_COLS=7 -DSPLIT_TRANSPORT_MIRROR -DSPLIT_TRANSPORT_STATS
+
+# config.h comes from the tests directory, serial.h from the ChibiOS drivers the simulation mimics
+SPLIT_TRANSPORT_COMMON_INC := \
+	$(QUANTUM_PATH)/split_common/tests \
+	$(DRIVER_PATH)/chibios
+
+SPLIT_TRANSPORT_COMMON_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/serial_sim.c \
+	$(QUANTUM_PATH)/split_common/tests/transport_master.c \
+	$(QUANTUM_PATH)/split_common/tests/transport_slave.c \
+	$(QUANTUM_PATH)/split_common/tests/transport_tests.cpp \
+	$(TMK_PATH)/common/test/timer.c
+
+split_transport_serial_DEFS := $(SPLIT_TRANSPORT_COMMON_DEFS)
+split_transport_serial_INC := $(SPLIT_TRANSPORT_COMMON_INC)
+split_transport_serial_SRC := $(SPLIT_TRANSPORT_COMMON_SRC)
+
+split_transport_crc_DEFS := $(SPLIT_TRANSPORT_COMMON_DEFS) -DSPLIT_TRANSPORT_CRC -DSPLIT_TRANSPORT_RETRIES=2
+split_transport_crc_INC := $(SPLIT_TRANSPORT_COMMON_INC)
+split_transport_crc_SRC := $(SPLIT_TRANSPORT_COMMON_SRC)
+
+split_transport_delta_DEFS := $(SPLIT_TRANSPORT_COMMON_DEFS) -DSERIAL_USE_MULTI_TRANSACTION -DSPLIT_TRANSPORT_DELTA -DSPLIT_TRANSPORT_CRC
+split_transport_delta_INC := $(SPLIT_TRANSPORT_COMMON_INC)
+split_transport_delta_SRC := $(SPLIT_TRANSPORT_COMMON_SRC)
+
+split_transport_shared_DEFS := $(SPLIT_TRANSPORT_COMMON_DEFS) -DSERIAL_USE_MULTI_TRANSACTION -DSPLIT_SHARED_OBJECTS=2 -DSPLIT_TRANSPORT_CRC
+split_transport_shared_INC := $(SPLIT_TRANSPORT_COMMON_INC)
+split_transport_shared_SRC := $(SPLIT_TRANSPORT_COMMON_SRC)
+
+split_transport_events_DEFS := $(SPLIT_TRANSPORT_COMMON_DEFS) -DSERIAL_USE_MULTI_TRANSACTION -DSPLIT_TRANSPORT_DELTA -DSPLIT_TRANSPORT_EVENTS -DSPLIT_TRANSPORT_CRC
+split_transport_events_INC := $(SPLIT_TRANSPORT_COMMON_INC)
+split_transport_events_SRC := $(SPLIT_TRANSPORT_COMMON_SRC)
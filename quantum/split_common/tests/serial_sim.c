@@ -0,0 +1,154 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "serial_sim.h"
+#include "timer.h"
+
+#define HANDSHAKE_MAGIC 7
+
+void set_time(uint32_t t);
+
+static serial_sim_config_t sim_config;
+static serial_sim_stats_t  sim_stats;
+static uint64_t            sim_now_ns;
+static uint32_t            sim_seed;
+
+static SSTD_t *initiator_table;
+static int     initiator_table_size;
+static SSTD_t *target_table;
+static int     target_table_size;
+
+void serial_sim_default_config(serial_sim_config_t *config) {
+    config->bit_time_ns     = 1000;
+    config->turnaround_ns   = 2000;
+    config->timeout_us      = 100000;
+    config->byte_error_ppm  = 0;
+    config->slave_connected = true;
+}
+
+void serial_sim_init(const serial_sim_config_t *config, uint32_t seed) {
+    sim_config = *config;
+    memset(&sim_stats, 0, sizeof(sim_stats));
+    sim_seed = seed ? seed : 1;
+}
+
+void serial_sim_set_config(const serial_sim_config_t *config) { sim_config = *config; }
+
+uint64_t serial_sim_now_ns(void) { return sim_now_ns; }
+
+void serial_sim_advance_ns(uint64_t ns) {
+    sim_now_ns += ns;
+    set_time((uint32_t)(sim_now_ns / 1000000));
+}
+
+const serial_sim_stats_t *serial_sim_get_stats(void) { return &sim_stats; }
+
+// xorshift32, so the same seed corrupts the same bytes
+static uint32_t sim_random(void) {
+    sim_seed ^= sim_seed << 13;
+    sim_seed ^= sim_seed >> 17;
+    sim_seed ^= sim_seed << 5;
+    return sim_seed;
+}
+
+// Puts `size` bytes on the wire, from `src` to `dst`, and returns whether they all arrived intact
+static bool sim_send(uint8_t *dst, const uint8_t *src, uint8_t size) {
+    bool intact = true;
+    for (uint8_t i = 0; i < size; i++) {
+        uint8_t byte = src[i];
+        if (sim_config.byte_error_ppm && sim_random() % 1000000 < sim_config.byte_error_ppm) {
+            byte ^= 1 << (sim_random() % 8);
+            sim_stats.corrupted_bytes++;
+            intact = false;
+        }
+        if (dst) {
+            dst[i] = byte;
+        }
+    }
+    sim_stats.bytes += size;
+    uint64_t ns = (uint64_t)size * 10 * sim_config.bit_time_ns;
+    sim_stats.busy_ns += ns;
+    serial_sim_advance_ns(ns);
+    return intact;
+}
+
+static void sim_turnaround(void) {
+    sim_stats.busy_ns += sim_config.turnaround_ns;
+    serial_sim_advance_ns(sim_config.turnaround_ns);
+}
+
+static int sim_no_response(void) {
+    sim_stats.no_response++;
+    serial_sim_advance_ns((uint64_t)sim_config.timeout_us * 1000);
+    return TRANSACTION_NO_RESPONSE;
+}
+
+void soft_serial_initiator_init(SSTD_t *sstd_table, int sstd_table_size) {
+    initiator_table      = sstd_table;
+    initiator_table_size = sstd_table_size;
+}
+
+void soft_serial_target_init(SSTD_t *sstd_table, int sstd_table_size) {
+    target_table      = sstd_table;
+    target_table_size = sstd_table_size;
+}
+
+#ifndef SERIAL_USE_MULTI_TRANSACTION
+int soft_serial_transaction(void) {
+    int sstd_index = 0;
+#else
+int soft_serial_transaction(int sstd_index) {
+#endif
+    if (sstd_index >= initiator_table_size) {
+        return TRANSACTION_TYPE_ERROR;
+    }
+    sim_stats.transactions++;
+
+    // The id goes out even if nobody listens
+    uint8_t id       = sstd_index;
+    uint8_t received = 0;
+    bool    intact   = sim_send(&received, &id, 1);
+    if (!sim_config.slave_connected || !intact || received >= target_table_size) {
+        return sim_no_response();
+    }
+    SSTD_t *master = &initiator_table[sstd_index];
+    SSTD_t *slave  = &target_table[received];
+
+    sim_turnaround();
+    uint8_t shake = received ^ HANDSHAKE_MAGIC;
+    uint8_t echo  = 0;
+    if (!sim_send(&echo, &shake, 1) || echo != (id ^ HANDSHAKE_MAGIC)) {
+        return sim_no_response();
+    }
+
+    if (master->initiator2target_buffer_size) {
+        sim_turnaround();
+        sim_send(slave->initiator2target_buffer, master->initiator2target_buffer, master->initiator2target_buffer_size);
+    }
+    if (master->target2initiator_buffer_size) {
+        if (master->initiator2target_buffer_size) {
+            sim_turnaround();
+        }
+        sim_send(master->target2initiator_buffer, slave->target2initiator_buffer, master->target2initiator_buffer_size);
+    }
+
+    if (slave->status) {
+        *slave->status = TRANSACTION_ACCEPTED;
+    }
+    return TRANSACTION_END;
+}
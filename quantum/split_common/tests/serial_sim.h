@@ -0,0 +1,69 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "serial.h"
+
+/*
+ * A simulated half duplex wire between the two halves, framed like
+ * drivers/chibios/serial_usart.c: the master sends the transaction id, the
+ * slave answers with id ^ 7, then the master payload and the slave payload
+ * follow. The slave side answers from whatever tables were passed to
+ * soft_serial_target_init(), the master side from soft_serial_initiator_init().
+ *
+ * The simulation keeps its own clock in nanoseconds and drives the test
+ * timer from it, so every transaction costs the time it would take on the
+ * wire. The clock keeps running across serial_sim_init(), since transport.c
+ * keeps timestamps in statics.
+ */
+
+typedef struct {
+    uint32_t bit_time_ns;       // time per bit on the wire, start and stop bits make 10 per byte
+    uint32_t turnaround_ns;     // every time the line changes direction
+    uint32_t timeout_us;        // what a transaction without an answer costs the master
+    uint32_t byte_error_ppm;    // chance per byte, in parts per million, that one of its bits flips
+    bool     slave_connected;   // whether the slave answers at all
+} serial_sim_config_t;
+
+typedef struct {
+    uint32_t transactions;      // every soft_serial_transaction() call
+    uint32_t no_response;       // transactions the slave did not answer
+    uint32_t bytes;             // bytes on the wire, both directions
+    uint32_t corrupted_bytes;   // bytes that arrived with a flipped bit
+    uint64_t busy_ns;           // time the wire was in use
+} serial_sim_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 1 Mbit/s, 2 us turnarounds and the default SERIAL_USART_TIMEOUT of serial_usart.c
+void serial_sim_default_config(serial_sim_config_t *config);
+void serial_sim_init(const serial_sim_config_t *config, uint32_t seed);
+void serial_sim_set_config(const serial_sim_config_t *config);
+
+uint64_t serial_sim_now_ns(void);
+void     serial_sim_advance_ns(uint64_t ns);
+
+const serial_sim_stats_t *serial_sim_get_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
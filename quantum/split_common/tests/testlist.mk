@@ -0,0 +1,6 @@
+TEST_LIST +=\
+	split_transport_serial\
+	split_transport_crc\
+	split_transport_delta\
+	split_transport_shared\
+	split_transport_events
@@ -0,0 +1,91 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+ * transport.c is built twice, once for each half, so both can run in one
+ * test program. The globals of each copy get a master_ or slave_ prefix.
+ * Features that add globals to transport.c need their names added here
+ * before a test can enable them.
+ */
+
+#ifdef TRANSPORT_SIM_PREFIX
+#    define TRANSPORT_SIM_CONCAT2(a, b) a##b
+#    define TRANSPORT_SIM_CONCAT(a, b) TRANSPORT_SIM_CONCAT2(a, b)
+#    define TRANSPORT_SIM_NAME(name) TRANSPORT_SIM_CONCAT(TRANSPORT_SIM_PREFIX, name)
+
+#    define transactions TRANSPORT_SIM_NAME(transactions)
+#    define serial_s2m_buffer TRANSPORT_SIM_NAME(serial_s2m_buffer)
+#    define serial_m2s_buffer TRANSPORT_SIM_NAME(serial_m2s_buffer)
+#    define status0 TRANSPORT_SIM_NAME(status0)
+#    define serial_s2m_sequence TRANSPORT_SIM_NAME(serial_s2m_sequence)
+#    define status_matrix TRANSPORT_SIM_NAME(status_matrix)
+#    define status_m2s TRANSPORT_SIM_NAME(status_m2s)
+#    define transport_master_init TRANSPORT_SIM_NAME(transport_master_init)
+#    define transport_slave_init TRANSPORT_SIM_NAME(transport_slave_init)
+#    define transport_master TRANSPORT_SIM_NAME(transport_master)
+#    define transport_slave TRANSPORT_SIM_NAME(transport_slave)
+#    define transport_master_row_times TRANSPORT_SIM_NAME(transport_master_row_times)
+#    define transport_slave_row_times TRANSPORT_SIM_NAME(transport_slave_row_times)
+#    define transport_get_stats TRANSPORT_SIM_NAME(transport_get_stats)
+#    define serial_shared_object TRANSPORT_SIM_NAME(serial_shared_object)
+#    define status_shared_object TRANSPORT_SIM_NAME(status_shared_object)
+#    define split_shared_object_register TRANSPORT_SIM_NAME(split_shared_object_register)
+#    define split_shared_object_set_interval TRANSPORT_SIM_NAME(split_shared_object_set_interval)
+#    define split_shared_object_changed TRANSPORT_SIM_NAME(split_shared_object_changed)
+#    define split_shared_object_version TRANSPORT_SIM_NAME(split_shared_object_version)
+#    ifdef SPLIT_SHARED_OBJECTS
+// Otherwise transport.c defines them as empty macros
+#        define transport_shared_objects_master TRANSPORT_SIM_NAME(transport_shared_objects_master)
+#        define transport_shared_objects_slave TRANSPORT_SIM_NAME(transport_shared_objects_slave)
+#    endif
+#    define serial_s2m_poll TRANSPORT_SIM_NAME(serial_s2m_poll)
+#    define serial_events TRANSPORT_SIM_NAME(serial_events)
+#    define status_events TRANSPORT_SIM_NAME(status_events)
+#    define transport_master_event_peek TRANSPORT_SIM_NAME(transport_master_event_peek)
+#    define transport_master_event_drop TRANSPORT_SIM_NAME(transport_master_event_drop)
+#else
+#    include "split_common/transport.h"
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+void master_transport_master_init(void);
+bool master_transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]);
+void slave_transport_slave_init(void);
+void slave_transport_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]);
+void slave_transport_slave_row_times(uint16_t slave_row_time[]);
+#    ifdef SPLIT_TRANSPORT_STATS
+const split_transport_stats_t *master_transport_get_stats(void);
+#    endif
+#    ifdef SPLIT_SHARED_OBJECTS
+void    master_split_shared_object_register(uint8_t id, void *data, uint8_t size);
+void    master_split_shared_object_set_interval(uint8_t id, uint16_t interval);
+void    master_split_shared_object_changed(uint8_t id);
+void    slave_split_shared_object_register(uint8_t id, void *data, uint8_t size);
+uint8_t slave_split_shared_object_version(uint8_t id);
+#    endif
+#    ifdef SPLIT_TRANSPORT_EVENTS
+const split_key_event_t *master_transport_master_event_peek(void);
+void                     master_transport_master_event_drop(void);
+#    endif
+
+#    ifdef __cplusplus
+}
+#    endif
+#endif
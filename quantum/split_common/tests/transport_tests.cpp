@@ -0,0 +1,385 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+extern "C" {
+#include "serial_sim.h"
+#include "transport_sim.h"
+#include "timer.h"
+}
+
+#define ROWS_PER_HAND (MATRIX_ROWS / 2)
+#define ROW_MASK ((matrix_row_t)((1ULL << MATRIX_COLS) - 1))
+
+#ifndef SPLIT_TRANSPORT_RETRIES
+#    define SPLIT_TRANSPORT_RETRIES 0
+#endif
+
+// Time each half spends scanning its own matrix between two transactions
+#define SCAN_TIME_NS 200000
+
+class SplitTransport : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        serial_sim_default_config(&config);
+        serial_sim_init(&config, 1);
+        master_transport_master_init();
+        slave_transport_slave_init();
+        memset(master_rows, 0, sizeof(master_rows));
+        memset(master_view, 0, sizeof(master_view));
+        memset(slave_rows, 0, sizeof(slave_rows));
+        memset(slave_mirror, 0, sizeof(slave_mirror));
+        memset(slave_stamped, 0, sizeof(slave_stamped));
+        memset(slave_row_time, 0, sizeof(slave_row_time));
+#ifdef SPLIT_TRANSPORT_STATS
+        stats_start = *master_transport_get_stats();
+#endif
+        failed_scans    = 0;
+        stale_reads     = 0;
+        corrupted_reads = 0;
+        history.clear();
+        seed            = 0x9E3779B9;
+#ifdef SPLIT_TRANSPORT_EVENTS
+        events.clear();
+#endif
+    }
+
+    void configure(void) { serial_sim_set_config(&config); }
+
+    // A matrix scan of the slave alone
+    void slave_scan(void) {
+        // Stamped like matrix_update_row_times() does
+        for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+            if (slave_rows[row] != slave_stamped[row]) {
+                slave_stamped[row]  = slave_rows[row];
+                slave_row_time[row] = timer_read();
+            }
+        }
+        slave_transport_slave_row_times(slave_row_time);
+        slave_transport_slave(slave_mirror, slave_rows);
+        history.push_back({});
+        memcpy(history.back().rows, slave_rows, sizeof(slave_rows));
+        if (history.size() > 64) {
+            history.pop_front();
+        }
+    }
+
+    // One matrix scan on each half, the slave first so the master reads what it just scanned
+    bool scan(void) {
+        slave_scan();
+        bool ok = master_transport_master(master_rows, master_view);
+#ifdef SPLIT_TRANSPORT_EVENTS
+        if (ok) {
+            apply_events();
+        }
+#endif
+        read_ns = serial_sim_now_ns();
+        if (!ok) {
+            failed_scans++;
+        } else if (memcmp(master_view, slave_rows, sizeof(slave_rows)) != 0) {
+            // An older matrix is a missed update, one the slave never had is corruption
+            bool seen = false;
+            for (auto &old : history) {
+                seen |= memcmp(master_view, old.rows, sizeof(old.rows)) == 0;
+            }
+            seen ? stale_reads++ : corrupted_reads++;
+        }
+        serial_sim_advance_ns(SCAN_TIME_NS);
+        return ok;
+    }
+
+    uint32_t random(void) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+#ifdef SPLIT_TRANSPORT_EVENTS
+    // What matrix.c does with the events, without holding any of them back for the next scan
+    void apply_events(void) {
+        const split_key_event_t *event;
+        while ((event = master_transport_master_event_peek())) {
+            matrix_row_t col_mask = (matrix_row_t)1 << event->col;
+            master_view[event->row] = event->pressed ? master_view[event->row] | col_mask : master_view[event->row] & ~col_mask;
+            events.push_back(*event);
+            master_transport_master_event_drop();
+        }
+    }
+#endif
+
+    void toggle_random_key(matrix_row_t *rows) { rows[random() % ROWS_PER_HAND] ^= (matrix_row_t)1 << (random() % MATRIX_COLS); }
+
+    void report(const char *name, unsigned scans, uint64_t start_ns, uint32_t max_latency_ns = 0, double mean_latency_ns = 0) {
+        const serial_sim_stats_t *wire    = serial_sim_get_stats();
+        double                    elapsed = (double)(serial_sim_now_ns() - start_ns);
+        printf("[ SPLIT    ] %-18s %5u scans, %7.0f transactions/s, %5.1f bytes/scan, wire busy %5.1f%%, latency max %6.1f us mean %6.1f us, %4u failed scans, %3u stale %3u corrupted reads\n", name, scans, wire->transactions * 1e9 / elapsed, (double)wire->bytes / scans, 100.0 * wire->busy_ns / elapsed, max_latency_ns / 1000.0, mean_latency_ns / 1000.0, failed_scans, stale_reads, corrupted_reads);
+    }
+
+    serial_sim_config_t config;
+    matrix_row_t        master_rows[ROWS_PER_HAND];   // the master's own half
+    matrix_row_t        master_view[ROWS_PER_HAND];   // the slave's half as seen by the master
+    matrix_row_t        slave_rows[ROWS_PER_HAND];    // the slave's own half
+    matrix_row_t        slave_mirror[ROWS_PER_HAND];  // the master's half as seen by the slave
+    matrix_row_t        slave_stamped[ROWS_PER_HAND];
+    uint16_t            slave_row_time[ROWS_PER_HAND];
+    uint64_t            read_ns;
+    unsigned            failed_scans;
+    unsigned            stale_reads;      // the master got an older matrix of the slave
+    unsigned            corrupted_reads;  // the master got a matrix the slave never had
+    uint32_t            seed;
+#ifdef SPLIT_TRANSPORT_STATS
+    split_transport_stats_t stats_start;
+#endif
+#ifdef SPLIT_TRANSPORT_EVENTS
+    std::vector<split_key_event_t> events;  // every event the master applied
+#endif
+
+   private:
+    struct Snapshot {
+        matrix_row_t rows[ROWS_PER_HAND];
+    };
+    std::deque<Snapshot> history;  // what the slave scanned, most recent last
+};
+
+TEST_F(SplitTransport, SlaveMatrixArrives) {
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        slave_rows[row] = (0x55 << row) & ROW_MASK;
+    }
+    EXPECT_TRUE(scan());
+    EXPECT_EQ(memcmp(master_view, slave_rows, sizeof(slave_rows)), 0);
+
+    // The last column of the last row is the last bit of the packed matrix
+    memset(slave_rows, 0, sizeof(slave_rows));
+    slave_rows[ROWS_PER_HAND - 1] = (matrix_row_t)1 << (MATRIX_COLS - 1);
+    EXPECT_TRUE(scan());
+    EXPECT_EQ(memcmp(master_view, slave_rows, sizeof(slave_rows)), 0);
+}
+
+TEST_F(SplitTransport, MasterMatrixMirrored) {
+    master_rows[0]                 = 0x01;
+    master_rows[ROWS_PER_HAND - 1] = ROW_MASK;
+    // The master queues its half for the next transaction, which the slave applies on its next scan
+    for (int i = 0; i < 3; i++) {
+        EXPECT_TRUE(scan());
+    }
+    EXPECT_EQ(memcmp(slave_mirror, master_rows, sizeof(master_rows)), 0);
+}
+
+TEST_F(SplitTransport, Throughput) {
+    uint64_t start = serial_sim_now_ns();
+    for (int i = 0; i < 2000; i++) {
+        // A key changes on every tenth scan, which is a lot more than anyone types
+        if (i % 10 == 0) {
+            toggle_random_key(slave_rows);
+        }
+        EXPECT_TRUE(scan());
+    }
+    EXPECT_EQ(failed_scans, 0);
+    EXPECT_EQ(stale_reads, 0);
+    EXPECT_EQ(corrupted_reads, 0);
+    report("throughput", 2000, start);
+}
+
+TEST_F(SplitTransport, Latency) {
+    uint64_t start = serial_sim_now_ns(), total = 0;
+    uint32_t max_latency = 0;
+    for (int i = 0; i < 200; i++) {
+        // The key changes at a random point between two scans of the slave
+        toggle_random_key(slave_rows);
+        uint64_t changed = serial_sim_now_ns();
+        serial_sim_advance_ns(random() % SCAN_TIME_NS);
+        int      scans   = 0;
+        while (memcmp(master_view, slave_rows, sizeof(slave_rows)) != 0 && scans < 10) {
+            scan();
+            scans++;
+        }
+        ASSERT_EQ(memcmp(master_view, slave_rows, sizeof(slave_rows)), 0);
+        // The next scan of the slave is always enough to deliver a change
+        EXPECT_EQ(scans, 1);
+        uint32_t latency = read_ns - changed;
+        max_latency      = std::max(max_latency, latency);
+        total += latency;
+    }
+    report("latency", 200, start, max_latency, (double)total / 200);
+}
+
+TEST_F(SplitTransport, RecoversFromDisconnect) {
+    EXPECT_TRUE(scan());
+
+    config.slave_connected = false;
+    configure();
+    slave_rows[0] = 0x03;
+    uint64_t start = serial_sim_now_ns();
+    for (int i = 0; i < 3; i++) {
+        EXPECT_FALSE(scan());
+    }
+    // Every attempt waits for the whole timeout
+    EXPECT_GE(serial_sim_now_ns() - start, 3ULL * (SPLIT_TRANSPORT_RETRIES + 1) * config.timeout_us * 1000);
+#ifdef SPLIT_TRANSPORT_STATS
+    EXPECT_EQ(master_transport_get_stats()->errors - stats_start.errors, 3);
+#endif
+
+    config.slave_connected = true;
+    configure();
+    EXPECT_TRUE(scan());
+    EXPECT_EQ(memcmp(master_view, slave_rows, sizeof(slave_rows)), 0);
+    report("disconnect", 4, start);
+}
+
+#ifdef SPLIT_SHARED_OBJECTS
+TEST_F(SplitTransport, SharedObjectSynced) {
+    uint8_t master_data[4] = {1, 2, 3, 4};
+    uint8_t slave_data[4]  = {};
+    master_split_shared_object_register(1, master_data, sizeof(master_data));
+    slave_split_shared_object_register(1, slave_data, sizeof(slave_data));
+
+    // Sent as soon as it is registered, applied on the slave's next scan
+    for (int i = 0; i < 2; i++) {
+        EXPECT_TRUE(scan());
+    }
+    EXPECT_EQ(memcmp(slave_data, master_data, sizeof(master_data)), 0);
+    uint8_t version = slave_split_shared_object_version(1);
+
+    // Nothing but the matrix goes over the wire while the object stays as it is
+    uint32_t transactions = serial_sim_get_stats()->transactions;
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(scan());
+    }
+    EXPECT_EQ(serial_sim_get_stats()->transactions - transactions, 10);
+
+    master_data[2] = 9;
+    master_split_shared_object_changed(1);
+    for (int i = 0; i < 2; i++) {
+        EXPECT_TRUE(scan());
+    }
+    EXPECT_EQ(memcmp(slave_data, master_data, sizeof(master_data)), 0);
+    EXPECT_NE(slave_split_shared_object_version(1), version);
+
+    master_split_shared_object_register(1, NULL, 0);
+    slave_split_shared_object_register(1, NULL, 0);
+}
+
+TEST_F(SplitTransport, SharedObjectRateLimited) {
+    uint8_t master_data[2] = {1, 2};
+    uint8_t slave_data[2]  = {};
+    master_split_shared_object_register(0, master_data, sizeof(master_data));
+    master_split_shared_object_set_interval(0, 50);
+    slave_split_shared_object_register(0, slave_data, sizeof(slave_data));
+
+    // Changes are noticed without being told about them, but go out no more than once every 50 ms
+    uint64_t start = serial_sim_now_ns();
+    while (memcmp(slave_data, master_data, sizeof(master_data)) != 0 && serial_sim_now_ns() - start < 100000000) {
+        EXPECT_TRUE(scan());
+    }
+    EXPECT_EQ(memcmp(slave_data, master_data, sizeof(master_data)), 0);
+
+    master_data[0] = 7;
+    start          = serial_sim_now_ns();
+    while (slave_data[0] != 7 && serial_sim_now_ns() - start < 100000000) {
+        EXPECT_TRUE(scan());
+    }
+    EXPECT_EQ(slave_data[0], 7);
+    EXPECT_GE(serial_sim_now_ns() - start, 40000000);
+
+    master_split_shared_object_register(0, NULL, 0);
+    slave_split_shared_object_register(0, NULL, 0);
+}
+#endif
+
+#ifdef SPLIT_TRANSPORT_EVENTS
+TEST_F(SplitTransport, EventsKeepEveryChange) {
+    EXPECT_TRUE(scan());
+    events.clear();
+
+    // A tap that is over before the master next reads the slave still arrives, press first
+    slave_rows[1] = 0x04;
+    slave_scan();
+    serial_sim_advance_ns(2000000);
+    slave_rows[1] = 0;
+    EXPECT_TRUE(scan());
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events[0].row, 1);
+    EXPECT_EQ(events[0].col, 2);
+    EXPECT_TRUE(events[0].pressed);
+    EXPECT_FALSE(events[1].pressed);
+    // Stamped with the times the slave saw them, so the release is the later one
+    EXPECT_GT(events[1].time, events[0].time);
+    EXPECT_EQ(memcmp(master_view, slave_rows, sizeof(slave_rows)), 0);
+
+    // Nothing but the status poll goes over the wire while no key changes
+    uint32_t transactions = serial_sim_get_stats()->transactions;
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(scan());
+    }
+    EXPECT_EQ(serial_sim_get_stats()->transactions - transactions, 10);
+    EXPECT_EQ(events.size(), 2);
+}
+
+TEST_F(SplitTransport, EventsResyncWhenMissed) {
+    EXPECT_TRUE(scan());
+
+    // More changes than the slave keeps events for, the master gets the whole matrix instead
+    for (int i = 0; i < 40; i++) {
+        toggle_random_key(slave_rows);
+        slave_scan();
+    }
+    events.clear();
+    EXPECT_TRUE(scan());
+    EXPECT_EQ(events.size(), 0);
+    EXPECT_EQ(memcmp(master_view, slave_rows, sizeof(slave_rows)), 0);
+
+    // and follows the events again from there
+    toggle_random_key(slave_rows);
+    EXPECT_TRUE(scan());
+    EXPECT_EQ(events.size(), 1);
+    EXPECT_EQ(memcmp(master_view, slave_rows, sizeof(slave_rows)), 0);
+}
+#endif
+
+TEST_F(SplitTransport, BitErrors) {
+    config.byte_error_ppm = 2000;
+    configure();
+    uint64_t start = serial_sim_now_ns();
+    for (int i = 0; i < 5000; i++) {
+        toggle_random_key(slave_rows);
+        scan();
+    }
+    EXPECT_GT(serial_sim_get_stats()->corrupted_bytes, 0);
+#ifdef SPLIT_TRANSPORT_CRC
+    // Corrupted slave data is dropped, the master never acts on it
+    EXPECT_EQ(corrupted_reads, 0);
+#    ifndef SPLIT_TRANSPORT_DELTA
+    EXPECT_EQ(stale_reads, 0);
+#    endif
+    // With SPLIT_TRANSPORT_DELTA the sequence number the master polls is not covered by the CRC, so a
+    // flipped bit there can make the master keep the old matrix until the slave's next change
+#    ifdef SPLIT_TRANSPORT_STATS
+    EXPECT_GT(master_transport_get_stats()->crc_errors - stats_start.crc_errors, 0);
+#    endif
+#else
+    // Without SPLIT_TRANSPORT_CRC nothing catches a flipped bit in the payload
+    EXPECT_GT(corrupted_reads, 0);
+#endif
+    report("bit errors", 5000, start);
+}
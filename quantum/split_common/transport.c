@@ -4,9 +4,10 @@
 #include "config.h"
 #include "matrix.h"
 #include "quantum.h"
+#include "transport.h"
 
 #define ROWS_PER_HAND (MATRIX_ROWS / 2)
-#define SYNC_TIMER_OFFSET 2
+#define SYNC_TIMER_OFFSET 2  // link delay in ms the master assumes until it has timed a transfer
 
 #ifdef RGBLIGHT_ENABLE
 #    include "rgblight.h"
@@ -16,17 +17,55 @@
 #    include "backlight.h"
 #endif
 
+#ifdef RGB_MATRIX_ENABLE
+#    include "rgb_matrix.h"
+#endif
+
+#ifdef SPLIT_POINTING_ENABLE
+#    include "pointing_device.h"
+#endif
+
+#ifdef SPLIT_OLED_MIRROR
+#    ifndef OLED_DRIVER_ENABLE
+#        error "SPLIT_OLED_MIRROR needs OLED_DRIVER_ENABLE"
+#    endif
+#    include "oled_driver.h"
+#endif
+
 #ifdef ENCODER_ENABLE
 #    include "encoder.h"
 static pin_t encoders_pad[] = ENCODERS_PAD_A;
 #    define NUMBER_OF_ENCODERS (sizeof(encoders_pad) / sizeof(pin_t))
 #endif
 
+#ifndef DISABLE_SYNC_TIMER
+// One way delay of the link in microseconds, averaged over the last few transfers of the time
+static uint32_t transport_link_delay_us = SYNC_TIMER_OFFSET * 1000;
+
+// The master's time as it will be when the slave receives it
+static uint32_t transport_sync_time(void) { return sync_timer_read32() + (transport_link_delay_us + 500) / 1000; }
+
+static void transport_link_delay_update(uint32_t delay_us) { transport_link_delay_us += ((int32_t)delay_us - (int32_t)transport_link_delay_us) / 4; }
+#endif
+
 #if defined(USE_I2C)
 
 #    include "i2c_master.h"
 #    include "i2c_slave.h"
 
+#    ifdef SPLIT_POINTING_ENABLE
+#        error "SPLIT_POINTING_ENABLE is only supported by the serial split transport"
+#    endif
+#    ifdef SPLIT_SHARED_OBJECTS
+#        error "SPLIT_SHARED_OBJECTS is only supported by the serial split transport"
+#    endif
+#    ifdef SPLIT_TRANSPORT_EVENTS
+#        error "SPLIT_TRANSPORT_EVENTS is only supported by the serial split transport"
+#    endif
+#    ifdef SPLIT_OLED_MIRROR
+#        error "SPLIT_OLED_MIRROR is only supported by the serial split transport"
+#    endif
+
 typedef struct _I2C_slave_buffer_t {
 #    ifndef DISABLE_SYNC_TIMER
     uint32_t sync_timer;
@@ -35,6 +74,9 @@ typedef struct _I2C_slave_buffer_t {
     matrix_row_t mmatrix[ROWS_PER_HAND];
 #    endif
     matrix_row_t smatrix[ROWS_PER_HAND];
+#    ifndef DISABLE_SYNC_TIMER
+    uint16_t smatrix_time[ROWS_PER_HAND];
+#    endif
 #    ifdef SPLIT_MODS_ENABLE
     uint8_t real_mods;
     uint8_t weak_mods;
@@ -49,7 +91,7 @@ typedef struct _I2C_slave_buffer_t {
     rgblight_syncinfo_t rgblight_sync;
 #    endif
 #    ifdef ENCODER_ENABLE
-    uint8_t encoder_state[NUMBER_OF_ENCODERS];
+    uint8_t encoder_state[ENCODER_STATE_SIZE(NUMBER_OF_ENCODERS)];
 #    endif
 #    ifdef WPM_ENABLE
     uint8_t current_wpm;
@@ -61,6 +103,7 @@ static I2C_slave_buffer_t *const i2c_buffer = (I2C_slave_buffer_t *)i2c_slave_re
 #    define I2C_SYNC_TIME_START offsetof(I2C_slave_buffer_t, sync_timer)
 #    define I2C_KEYMAP_MASTER_START offsetof(I2C_slave_buffer_t, mmatrix)
 #    define I2C_KEYMAP_SLAVE_START offsetof(I2C_slave_buffer_t, smatrix)
+#    define I2C_KEYMAP_SLAVE_TIME_START offsetof(I2C_slave_buffer_t, smatrix_time)
 #    define I2C_REAL_MODS_START offsetof(I2C_slave_buffer_t, real_mods)
 #    define I2C_WEAK_MODS_START offsetof(I2C_slave_buffer_t, weak_mods)
 #    define I2C_ONESHOT_MODS_START offsetof(I2C_slave_buffer_t, oneshot_mods)
@@ -78,6 +121,9 @@ static I2C_slave_buffer_t *const i2c_buffer = (I2C_slave_buffer_t *)i2c_slave_re
 // Get rows from other half over i2c
 bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
     i2c_readReg(SLAVE_I2C_ADDRESS, I2C_KEYMAP_SLAVE_START, (void *)slave_matrix, sizeof(i2c_buffer->smatrix), TIMEOUT);
+#    ifndef DISABLE_SYNC_TIMER
+    i2c_readReg(SLAVE_I2C_ADDRESS, I2C_KEYMAP_SLAVE_TIME_START, (void *)i2c_buffer->smatrix_time, sizeof(i2c_buffer->smatrix_time), TIMEOUT);
+#    endif
 #    ifdef SPLIT_TRANSPORT_MIRROR
     i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_KEYMAP_MASTER_START, (void *)master_matrix, sizeof(i2c_buffer->mmatrix), TIMEOUT);
 #    endif
@@ -142,8 +188,12 @@ bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])
 #    endif
 
 #    ifndef DISABLE_SYNC_TIMER
-    i2c_buffer->sync_timer = sync_timer_read32() + SYNC_TIMER_OFFSET;
-    i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_SYNC_TIME_START, (void *)&i2c_buffer->sync_timer, sizeof(i2c_buffer->sync_timer), TIMEOUT);
+    // The slave has the time once the write is done
+    uint32_t start         = timer_read_us();
+    i2c_buffer->sync_timer = transport_sync_time();
+    if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_SYNC_TIME_START, (void *)&i2c_buffer->sync_timer, sizeof(i2c_buffer->sync_timer), TIMEOUT) >= 0) {
+        transport_link_delay_update(timer_elapsed_us(start));
+    }
 #    endif
     return true;
 }
@@ -188,6 +238,12 @@ void transport_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])
 #    endif
 }
 
+#    ifndef DISABLE_SYNC_TIMER
+void transport_master_row_times(uint16_t slave_row_time[]) { memcpy((void *)slave_row_time, (void *)i2c_buffer->smatrix_time, sizeof(i2c_buffer->smatrix_time)); }
+
+void transport_slave_row_times(uint16_t slave_row_time[]) { memcpy((void *)i2c_buffer->smatrix_time, (void *)slave_row_time, sizeof(i2c_buffer->smatrix_time)); }
+#    endif
+
 void transport_master_init(void) { i2c_init(); }
 
 void transport_slave_init(void) { i2c_slave_init(SLAVE_I2C_ADDRESS); }
@@ -196,14 +252,62 @@ void transport_slave_init(void) { i2c_slave_init(SLAVE_I2C_ADDRESS); }
 
 #    include "serial.h"
 
+#    ifdef SPLIT_TRANSPORT_EVENTS
+#        if !defined(SERIAL_USE_MULTI_TRANSACTION) || !defined(SPLIT_TRANSPORT_DELTA)
+#            error "SPLIT_TRANSPORT_EVENTS needs SERIAL_USE_MULTI_TRANSACTION and SPLIT_TRANSPORT_DELTA"
+#        endif
+#        ifdef DISABLE_SYNC_TIMER
+#            error "SPLIT_TRANSPORT_EVENTS stamps the events with the sync timer"
+#        endif
+#        include "spsc_queue.h"
+#    endif
+
+#    ifdef SPLIT_TRANSPORT_CRC
+// Every payload ends in a CRC-8 of the bytes before it, checked by whichever half receives it
+#        define SERIAL_CRC_FIELD uint8_t crc;
+#        define SERIAL_CRC_SET(type, buf) ((buf).crc = serial_crc8((const volatile uint8_t *)&(buf), offsetof(type, crc)))
+#        define SERIAL_CRC_VALID(type, buf) ((buf).crc == serial_crc8((const volatile uint8_t *)&(buf), offsetof(type, crc)))
+
+// CRC-8, polynomial 0x07
+static uint8_t serial_crc8(const volatile uint8_t *data, size_t size) {
+    uint8_t crc = 0;
+    while (size--) {
+        crc ^= *data++;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+#    else
+#        define SERIAL_CRC_FIELD
+#        define SERIAL_CRC_SET(type, buf)
+#        define SERIAL_CRC_VALID(type, buf) true
+#    endif
+
+#    ifndef SPLIT_TRANSPORT_RETRIES
+#        define SPLIT_TRANSPORT_RETRIES 0
+#    endif
+
+// The slave half of the matrix goes over the wire as one bitstream, row after row, MATRIX_COLS bits each
+#    define SERIAL_PACKED_MATRIX_SIZE ((ROWS_PER_HAND * MATRIX_COLS + 7) / 8)
+
 typedef struct _Serial_s2m_buffer_t {
-    // TODO: if MATRIX_COLS > 8 change to uint8_t packed_matrix[] for pack/unpack
-    matrix_row_t smatrix[ROWS_PER_HAND];
+    uint8_t      packed_matrix[SERIAL_PACKED_MATRIX_SIZE];
+
+#    ifndef DISABLE_SYNC_TIMER
+    uint16_t     smatrix_time[ROWS_PER_HAND];
+#    endif
 
 #    ifdef ENCODER_ENABLE
-    uint8_t      encoder_state[NUMBER_OF_ENCODERS];
+    uint8_t      encoder_state[ENCODER_STATE_SIZE(NUMBER_OF_ENCODERS)];
+#    endif
+
+#    ifdef SPLIT_TRANSPORT_EVENTS
+    uint8_t      event_count;  // events generated up to packed_matrix
 #    endif
 
+    SERIAL_CRC_FIELD
 } Serial_s2m_buffer_t;
 
 typedef struct _Serial_m2s_buffer_t {
@@ -226,6 +330,7 @@ typedef struct _Serial_m2s_buffer_t {
 #    ifdef WPM_ENABLE
     uint8_t      current_wpm;
 #    endif
+    SERIAL_CRC_FIELD
 } Serial_m2s_buffer_t;
 
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
@@ -239,20 +344,157 @@ typedef struct _Serial_m2s_buffer_t {
 
 typedef struct _Serial_rgblight_t {
     rgblight_syncinfo_t rgblight_sync;
+    SERIAL_CRC_FIELD
 } Serial_rgblight_t;
 
 volatile Serial_rgblight_t serial_rgblight = {};
 uint8_t volatile status_rgblight           = 0;
+
+#        if defined(RGBLIGHT_USE_TIMER) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
+#            define SERIAL_RGBLIGHT_PHASE
+#            ifndef RGBLIGHT_SPLIT_PHASE_INTERVAL
+#                define RGBLIGHT_SPLIT_PHASE_INTERVAL 2000
+#            endif
+// Where the master's animation is, the slave runs its own frames in between
+typedef struct _Serial_rgblight_phase_t {
+    rgblight_phase_t phase;
+    SERIAL_CRC_FIELD
+} Serial_rgblight_phase_t;
+
+volatile Serial_rgblight_phase_t serial_rgblight_phase = {};
+uint8_t volatile status_rgblight_phase                 = 0;
+#        endif
+#    endif
+
+#    ifdef RGB_MATRIX_SPLIT_SYNC
+typedef struct _Serial_rgb_matrix_t {
+    rgb_matrix_syncinfo_t rgb_matrix_sync;
+    SERIAL_CRC_FIELD
+} Serial_rgb_matrix_t;
+
+volatile Serial_rgb_matrix_t serial_rgb_matrix = {};
+uint8_t volatile status_rgb_matrix             = 0;
+#    endif
+
+#    ifdef SPLIT_POINTING_ENABLE
+// Pointing device motion from the slave. The slave only replaces it once the master has fetched it.
+typedef struct _Serial_pointing_t {
+    report_mouse_t report;
+    SERIAL_CRC_FIELD
+} Serial_pointing_t;
+
+volatile Serial_pointing_t serial_pointing = {};
+uint8_t volatile status_pointing           = 0;
+#    endif
+
+#    ifdef SPLIT_SHARED_OBJECTS
+// One object at a time, tagged with its id and the version the master gave it
+typedef struct _Serial_shared_object_t {
+    uint8_t id;
+    uint8_t version;
+    uint8_t data[SPLIT_SHARED_OBJECT_SIZE];
+    SERIAL_CRC_FIELD
+} Serial_shared_object_t;
+
+volatile Serial_shared_object_t serial_shared_object = {};
+uint8_t volatile status_shared_object                = 0;
+#    endif
+
+#    ifdef SPLIT_OLED_MIRROR
+// One block of the slave's display, drawn by the master
+typedef struct _Serial_oled_block_t {
+    uint8_t block;
+    uint8_t data[OLED_BLOCK_SIZE];
+    SERIAL_CRC_FIELD
+} Serial_oled_block_t;
+
+volatile Serial_oled_block_t serial_oled_block = {};
+uint8_t volatile status_oled_block             = 0;
+#    endif
+
+#    ifdef SPLIT_TRANSPORT_EVENTS
+#        ifndef SPLIT_TRANSPORT_EVENT_BUFFER
+#            define SPLIT_TRANSPORT_EVENT_BUFFER 4
+#        endif
+_Static_assert(SPLIT_TRANSPORT_EVENT_BUFFER >= 1 && SPLIT_TRANSPORT_EVENT_BUFFER <= 127, "SPLIT_TRANSPORT_EVENT_BUFFER must be from 1 to 127");
+
+// The last key events of the slave, oldest first, the last one being number event_count - 1
+typedef struct _Serial_events_t {
+    uint8_t           event_count;
+    split_key_event_t events[SPLIT_TRANSPORT_EVENT_BUFFER];
+    SERIAL_CRC_FIELD
+} Serial_events_t;
+
+volatile Serial_events_t serial_events = {};
+uint8_t volatile status_events         = 0;
 #    endif
 
 volatile Serial_s2m_buffer_t serial_s2m_buffer = {};
 volatile Serial_m2s_buffer_t serial_m2s_buffer = {};
 uint8_t volatile status0                       = 0;
 
+#    ifdef SPLIT_TRANSPORT_DELTA
+#        ifndef SPLIT_TRANSPORT_HEARTBEAT
+#            define SPLIT_TRANSPORT_HEARTBEAT 500
+#        endif
+#        ifdef SPLIT_TRANSPORT_EVENTS
+// The status poll also carries serial_events.event_count, and the matrix no longer bumps the sequence
+typedef struct _Serial_s2m_poll_t {
+    uint8_t sequence;
+    uint8_t event_count;
+} Serial_s2m_poll_t;
+
+volatile Serial_s2m_poll_t serial_s2m_poll = {};
+#            define SERIAL_S2M_SEQUENCE serial_s2m_poll.sequence
+#            define SERIAL_S2M_POLL serial_s2m_poll
+#        else
+// Bumped by the slave whenever serial_s2m_buffer changes, so the master only reads it when needed
+uint8_t volatile serial_s2m_sequence = 0;
+#            define SERIAL_S2M_SEQUENCE serial_s2m_sequence
+#            define SERIAL_S2M_POLL serial_s2m_sequence
+#        endif
+uint8_t volatile status_matrix       = 0;
+uint8_t volatile status_m2s          = 0;
+// The regular transaction is then only a status poll, everything else is sent when it changes
+#        define SERIAL_M2S_MAIN_SIZE 0
+#        define SERIAL_M2S_MAIN_BUFFER NULL
+#        define SERIAL_S2M_MAIN_SIZE sizeof(SERIAL_S2M_POLL)
+#        define SERIAL_S2M_MAIN_BUFFER (uint8_t *)&SERIAL_S2M_POLL
+#        define transport_main_transaction() transport_transaction(GET_SLAVE_MATRIX)
+#    else
+#        define SERIAL_M2S_MAIN_SIZE sizeof(serial_m2s_buffer)
+#        define SERIAL_M2S_MAIN_BUFFER (uint8_t *)&serial_m2s_buffer
+#        define SERIAL_S2M_MAIN_SIZE sizeof(serial_s2m_buffer)
+#        define SERIAL_S2M_MAIN_BUFFER (uint8_t *)&serial_s2m_buffer
+#        define transport_main_transaction() transport_m2s_transaction(GET_SLAVE_MATRIX)
+#    endif
+
 enum serial_transaction_id {
     GET_SLAVE_MATRIX = 0,
+#    ifdef SPLIT_TRANSPORT_DELTA
+    GET_SLAVE_MATRIX_DATA,
+    PUT_MASTER_STATE,
+#    endif
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     PUT_RGBLIGHT,
+#        ifdef SERIAL_RGBLIGHT_PHASE
+    PUT_RGBLIGHT_PHASE,
+#        endif
+#    endif
+#    ifdef RGB_MATRIX_SPLIT_SYNC
+    PUT_RGB_MATRIX,
+#    endif
+#    ifdef SPLIT_POINTING_ENABLE
+    GET_POINTING,
+#    endif
+#    ifdef SPLIT_SHARED_OBJECTS
+    PUT_SHARED_OBJECT,
+#    endif
+#    ifdef SPLIT_OLED_MIRROR
+    PUT_OLED_BLOCK,
+#    endif
+#    ifdef SPLIT_TRANSPORT_EVENTS
+    GET_SLAVE_EVENTS,
 #    endif
 };
 
@@ -260,19 +502,179 @@ SSTD_t transactions[] = {
     [GET_SLAVE_MATRIX] =
         {
             (uint8_t *)&status0,
-            sizeof(serial_m2s_buffer),
-            (uint8_t *)&serial_m2s_buffer,
-            sizeof(serial_s2m_buffer),
-            (uint8_t *)&serial_s2m_buffer,
+            SERIAL_M2S_MAIN_SIZE,
+            SERIAL_M2S_MAIN_BUFFER,
+            SERIAL_S2M_MAIN_SIZE,
+            SERIAL_S2M_MAIN_BUFFER,
         },
+#    ifdef SPLIT_TRANSPORT_DELTA
+    [GET_SLAVE_MATRIX_DATA] =
+        {
+            (uint8_t *)&status_matrix, 0, NULL, sizeof(serial_s2m_buffer), (uint8_t *)&serial_s2m_buffer  // no master to slave transfer
+        },
+    [PUT_MASTER_STATE] =
+        {
+            (uint8_t *)&status_m2s, sizeof(serial_m2s_buffer), (uint8_t *)&serial_m2s_buffer, 0, NULL  // no slave to master transfer
+        },
+#    endif
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     [PUT_RGBLIGHT] =
         {
             (uint8_t *)&status_rgblight, sizeof(serial_rgblight), (uint8_t *)&serial_rgblight, 0, NULL  // no slave to master transfer
         },
+#        ifdef SERIAL_RGBLIGHT_PHASE
+    [PUT_RGBLIGHT_PHASE] =
+        {
+            (uint8_t *)&status_rgblight_phase, sizeof(serial_rgblight_phase), (uint8_t *)&serial_rgblight_phase, 0, NULL  // no slave to master transfer
+        },
+#        endif
+#    endif
+#    ifdef RGB_MATRIX_SPLIT_SYNC
+    [PUT_RGB_MATRIX] =
+        {
+            (uint8_t *)&status_rgb_matrix, sizeof(serial_rgb_matrix), (uint8_t *)&serial_rgb_matrix, 0, NULL  // no slave to master transfer
+        },
+#    endif
+#    ifdef SPLIT_POINTING_ENABLE
+    [GET_POINTING] =
+        {
+            (uint8_t *)&status_pointing, 0, NULL, sizeof(serial_pointing), (uint8_t *)&serial_pointing  // no master to slave transfer
+        },
+#    endif
+#    ifdef SPLIT_SHARED_OBJECTS
+    [PUT_SHARED_OBJECT] =
+        {
+            (uint8_t *)&status_shared_object, sizeof(serial_shared_object), (uint8_t *)&serial_shared_object, 0, NULL  // no slave to master transfer
+        },
+#    endif
+#    ifdef SPLIT_OLED_MIRROR
+    [PUT_OLED_BLOCK] =
+        {
+            (uint8_t *)&status_oled_block, sizeof(serial_oled_block), (uint8_t *)&serial_oled_block, 0, NULL  // no slave to master transfer
+        },
+#    endif
+#    ifdef SPLIT_TRANSPORT_EVENTS
+    [GET_SLAVE_EVENTS] =
+        {
+            (uint8_t *)&status_events, 0, NULL, sizeof(serial_events), (uint8_t *)&serial_events  // no master to slave transfer
+        },
 #    endif
 };
 
+#    ifndef DISABLE_SYNC_TIMER
+void transport_master_row_times(uint16_t slave_row_time[]) {
+    for (int i = 0; i < ROWS_PER_HAND; ++i) {
+        slave_row_time[i] = serial_s2m_buffer.smatrix_time[i];
+    }
+}
+
+void transport_slave_row_times(uint16_t slave_row_time[]) {
+    for (int i = 0; i < ROWS_PER_HAND; ++i) {
+        serial_s2m_buffer.smatrix_time[i] = slave_row_time[i];
+    }
+}
+#    endif
+
+static void serial_pack_matrix(uint8_t packed[], const matrix_row_t matrix[]) {
+    uint16_t bit = 0;
+    memset(packed, 0, SERIAL_PACKED_MATRIX_SIZE);
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++, bit++) {
+            if (matrix[row] & ((matrix_row_t)1 << col)) {
+                packed[bit / 8] |= 1 << (bit % 8);
+            }
+        }
+    }
+}
+
+static void serial_unpack_matrix(matrix_row_t matrix[], const volatile uint8_t packed[]) {
+    uint16_t bit = 0;
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        matrix_row_t value = 0;
+        for (uint8_t col = 0; col < MATRIX_COLS; col++, bit++) {
+            if (packed[bit / 8] & (1 << (bit % 8))) {
+                value |= (matrix_row_t)1 << col;
+            }
+        }
+        matrix[row] = value;
+    }
+}
+
+#    ifdef SPLIT_TRANSPORT_STATS
+static split_transport_stats_t transport_stats = {};
+
+const split_transport_stats_t *transport_get_stats(void) { return &transport_stats; }
+
+#        define TRANSPORT_STATS_INC(field) transport_stats.field++
+#    else
+#        define TRANSPORT_STATS_INC(field)
+#    endif
+
+#    ifndef SERIAL_USE_MULTI_TRANSACTION
+#        define serial_transaction_once(id) soft_serial_transaction()
+#    else
+#        define serial_transaction_once(id) soft_serial_transaction(id)
+#    endif
+
+// Whether the data the slave sent in a transaction arrived intact
+static bool transport_s2m_valid(uint8_t id) {
+    uint8_t *buffer = transactions[id].target2initiator_buffer;
+    if (buffer == (uint8_t *)&serial_s2m_buffer) {
+        return SERIAL_CRC_VALID(Serial_s2m_buffer_t, serial_s2m_buffer);
+    }
+#    ifdef SPLIT_POINTING_ENABLE
+    if (buffer == (uint8_t *)&serial_pointing) {
+        return SERIAL_CRC_VALID(Serial_pointing_t, serial_pointing);
+    }
+#    endif
+#    ifdef SPLIT_TRANSPORT_EVENTS
+    if (buffer == (uint8_t *)&serial_events) {
+        return SERIAL_CRC_VALID(Serial_events_t, serial_events);
+    }
+#    endif
+    return true;
+}
+
+// Runs a transaction, retrying it up to SPLIT_TRANSPORT_RETRIES times when it fails or the slave's data is corrupt
+static bool transport_transaction(uint8_t id) {
+    for (uint8_t attempt = 0;; attempt++) {
+        TRANSPORT_STATS_INC(transactions);
+        bool ok = serial_transaction_once(id) == TRANSACTION_END;
+        if (ok && !transport_s2m_valid(id)) {
+            TRANSPORT_STATS_INC(crc_errors);
+            ok = false;
+        }
+        if (ok) {
+            return true;
+        }
+        if (attempt >= SPLIT_TRANSPORT_RETRIES) {
+            TRANSPORT_STATS_INC(errors);
+#    ifdef SPLIT_TRANSPORT_STATS
+            dprintf("transport: %u failed, errors %lu crc %lu retries %lu of %lu\n", id, transport_stats.errors, transport_stats.crc_errors, transport_stats.retries, transport_stats.transactions);
+#    endif
+            return false;
+        }
+        TRANSPORT_STATS_INC(retries);
+    }
+}
+
+// Runs a transaction that sends serial_m2s_buffer, stamped with the master's time as it reaches the slave
+static bool transport_m2s_transaction(uint8_t id) {
+#    ifndef DISABLE_SYNC_TIMER
+    uint32_t start               = timer_read_us();
+    serial_m2s_buffer.sync_timer = transport_sync_time();
+#    endif
+    SERIAL_CRC_SET(Serial_m2s_buffer_t, serial_m2s_buffer);
+    bool ok = transport_transaction(id);
+#    ifndef DISABLE_SYNC_TIMER
+    if (ok) {
+        // Half of the round trip, the slave got the buffer before it answered
+        transport_link_delay_update(timer_elapsed_us(start) / 2);
+    }
+#    endif
+    return ok;
+}
+
 void transport_master_init(void) { soft_serial_initiator_init(transactions, TID_LIMIT(transactions)); }
 
 void transport_slave_init(void) { soft_serial_target_init(transactions, TID_LIMIT(transactions)); }
@@ -280,21 +682,57 @@ void transport_slave_init(void) { soft_serial_target_init(transactions, TID_LIMI
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
 
 // rgblight synchronization information communication.
+// The config goes out when it changes, the animation phase every RGBLIGHT_SPLIT_PHASE_INTERVAL milliseconds.
 
 void transport_rgblight_master(void) {
-    if (rgblight_get_change_flags()) {
+#        ifdef SERIAL_RGBLIGHT_PHASE
+    static bool     phase_due = true;
+    static uint16_t phase_time;
+    // The phase replaces the restart the master asks for when its animation wraps around
+    uint8_t flags = rgblight_get_change_flags() & ~RGBLIGHT_STATUS_ANIMATION_TICK;
+    if (!flags) {
+        rgblight_clear_change_flags();
+    }
+#        else
+    uint8_t flags = rgblight_get_change_flags();
+#        endif
+    if (flags) {
         rgblight_get_syncinfo((rgblight_syncinfo_t *)&serial_rgblight.rgblight_sync);
-        if (soft_serial_transaction(PUT_RGBLIGHT) == TRANSACTION_END) {
+        serial_rgblight.rgblight_sync.status.change_flags = flags;
+        SERIAL_CRC_SET(Serial_rgblight_t, serial_rgblight);
+        if (transport_transaction(PUT_RGBLIGHT)) {
             rgblight_clear_change_flags();
+#        ifdef SERIAL_RGBLIGHT_PHASE
+            phase_due = true;
+#        endif
+        }
+    }
+#        ifdef SERIAL_RGBLIGHT_PHASE
+    rgblight_phase_t phase;
+    if ((phase_due || timer_elapsed(phase_time) >= RGBLIGHT_SPLIT_PHASE_INTERVAL) && rgblight_get_animation_phase(&phase)) {
+        serial_rgblight_phase.phase = phase;
+        SERIAL_CRC_SET(Serial_rgblight_phase_t, serial_rgblight_phase);
+        if (transport_transaction(PUT_RGBLIGHT_PHASE)) {
+            phase_due  = false;
+            phase_time = timer_read();
         }
     }
+#        endif
 }
 
 void transport_rgblight_slave(void) {
-    if (status_rgblight == TRANSACTION_ACCEPTED) {
+    if (status_rgblight == TRANSACTION_ACCEPTED && SERIAL_CRC_VALID(Serial_rgblight_t, serial_rgblight)) {
         rgblight_update_sync((rgblight_syncinfo_t *)&serial_rgblight.rgblight_sync, false);
         status_rgblight = TRANSACTION_END;
     }
+#        ifdef SERIAL_RGBLIGHT_PHASE
+    // After the config, so a mode change and the phase of the new mode can arrive together
+    if (status_rgblight_phase == TRANSACTION_ACCEPTED && SERIAL_CRC_VALID(Serial_rgblight_phase_t, serial_rgblight_phase)) {
+        rgblight_phase_t phase = serial_rgblight_phase.phase;
+        rgblight_set_animation_phase(&phase);
+        status_rgblight_phase = TRANSACTION_END;
+    }
+#        endif
 }
 
 #    else
@@ -302,25 +740,401 @@ void transport_rgblight_slave(void) {
 #        define transport_rgblight_slave()
 #    endif
 
+#    ifdef RGB_MATRIX_SPLIT_SYNC
+
+// rgb matrix config and key hit communication, sent only when something changed.
+
+void transport_rgb_matrix_master(void) {
+    if (rgb_matrix_get_sync_pending()) {
+        rgb_matrix_get_syncinfo((rgb_matrix_syncinfo_t *)&serial_rgb_matrix.rgb_matrix_sync);
+        SERIAL_CRC_SET(Serial_rgb_matrix_t, serial_rgb_matrix);
+        if (transport_transaction(PUT_RGB_MATRIX)) {
+            rgb_matrix_clear_sync_pending((rgb_matrix_syncinfo_t *)&serial_rgb_matrix.rgb_matrix_sync);
+        }
+    }
+}
+
+void transport_rgb_matrix_slave(void) {
+    if (status_rgb_matrix == TRANSACTION_ACCEPTED && SERIAL_CRC_VALID(Serial_rgb_matrix_t, serial_rgb_matrix)) {
+        rgb_matrix_update_sync((rgb_matrix_syncinfo_t *)&serial_rgb_matrix.rgb_matrix_sync);
+        status_rgb_matrix = TRANSACTION_END;
+    }
+}
+
+#    else
+#        define transport_rgb_matrix_master()
+#        define transport_rgb_matrix_slave()
+#    endif
+
+#    ifdef SPLIT_POINTING_ENABLE
+
+// pointing device motion, accumulated on the slave until the master fetches it.
+
+#        ifndef SPLIT_POINTING_INTERVAL
+#            define SPLIT_POINTING_INTERVAL 0
+#        endif
+
+void transport_pointing_master(void) {
+#        if SPLIT_POINTING_INTERVAL > 0
+    static uint16_t last_fetch;
+    if (timer_elapsed(last_fetch) < SPLIT_POINTING_INTERVAL) {
+        return;
+    }
+    last_fetch = timer_read();
+#        endif
+    if (transport_transaction(GET_POINTING)) {
+        pointing_device_set_split_report(serial_pointing.report);
+    }
+}
+
+void transport_pointing_slave(void) {
+    // The master has what was in the buffer, so it can hold the next batch of motion
+    if (status_pointing == TRANSACTION_ACCEPTED) {
+        status_pointing        = TRANSACTION_END;
+        serial_pointing.report = pointing_device_get_split_report();
+        SERIAL_CRC_SET(Serial_pointing_t, serial_pointing);
+    }
+}
+
+#    else
+#        define transport_pointing_master()
+#        define transport_pointing_slave()
+#    endif
+
+#    ifdef SPLIT_SHARED_OBJECTS
+
+// keyboard and keymap data, each object sent on its own when it changed.
+
+#        ifndef SPLIT_SHARED_OBJECT_REFRESH
+#            define SPLIT_SHARED_OBJECT_REFRESH 1000
+#        endif
+
+typedef struct {
+    void *   data;
+    uint8_t  size;
+    uint8_t  version;       // master: bumped on every change, slave: the last one received
+    uint8_t  sent_version;  // master: the last one the slave took
+    uint16_t interval;      // master: minimum time between two sends
+    uint16_t last_sent;
+#        ifndef SPLIT_SHARED_OBJECT_NO_COMPARE
+    uint8_t last_data[SPLIT_SHARED_OBJECT_SIZE];  // master: what the data was when a change was last noticed
+#        endif
+} shared_object_t;
+
+static shared_object_t shared_objects[SPLIT_SHARED_OBJECTS];
+
+void split_shared_object_register(uint8_t id, void *data, uint8_t size) {
+    if (id >= SPLIT_SHARED_OBJECTS || size > SPLIT_SHARED_OBJECT_SIZE) {
+        return;
+    }
+    shared_objects[id].data = data;
+    shared_objects[id].size = data ? size : 0;
+#        ifndef SPLIT_SHARED_OBJECT_NO_COMPARE
+    memcpy(shared_objects[id].last_data, data, shared_objects[id].size);
+#        endif
+    // Sent as soon as the master is up
+    shared_objects[id].sent_version = shared_objects[id].version + 1;
+}
+
+void split_shared_object_set_interval(uint8_t id, uint16_t interval) {
+    if (id < SPLIT_SHARED_OBJECTS) {
+        shared_objects[id].interval = interval;
+    }
+}
+
+void split_shared_object_changed(uint8_t id) {
+    if (id < SPLIT_SHARED_OBJECTS) {
+        shared_objects[id].version++;
+    }
+}
+
+uint8_t split_shared_object_version(uint8_t id) { return id < SPLIT_SHARED_OBJECTS ? shared_objects[id].version : 0; }
+
+static bool transport_shared_object_send(uint8_t id) {
+    shared_object_t *object = &shared_objects[id];
+    serial_shared_object.id      = id;
+    serial_shared_object.version = object->version;
+    memcpy((void *)serial_shared_object.data, object->data, object->size);
+    SERIAL_CRC_SET(Serial_shared_object_t, serial_shared_object);
+    object->last_sent = timer_read();
+    if (!transport_transaction(PUT_SHARED_OBJECT)) {
+        return false;
+    }
+    object->sent_version = object->version;
+    return true;
+}
+
+// Sends at most one object per scan: the first that changed and may be sent again already, or else now and then
+// the next one round, in case the slave was reset
+void transport_shared_objects_master(void) {
+    static uint16_t last_refresh;
+    static uint8_t  next_refresh;
+
+    for (uint8_t id = 0; id < SPLIT_SHARED_OBJECTS; id++) {
+        shared_object_t *object = &shared_objects[id];
+        if (!object->data) {
+            continue;
+        }
+#        ifndef SPLIT_SHARED_OBJECT_NO_COMPARE
+        if (memcmp(object->last_data, object->data, object->size) != 0) {
+            memcpy(object->last_data, object->data, object->size);
+            object->version++;
+        }
+#        endif
+        if (object->sent_version != object->version && timer_elapsed(object->last_sent) >= object->interval) {
+            transport_shared_object_send(id);
+            return;
+        }
+    }
+
+    if (timer_elapsed(last_refresh) >= SPLIT_SHARED_OBJECT_REFRESH / SPLIT_SHARED_OBJECTS) {
+        last_refresh = timer_read();
+        next_refresh = (next_refresh + 1) % SPLIT_SHARED_OBJECTS;
+        if (shared_objects[next_refresh].data) {
+            transport_shared_object_send(next_refresh);
+        }
+    }
+}
+
+void transport_shared_objects_slave(void) {
+    if (status_shared_object == TRANSACTION_ACCEPTED) {
+        uint8_t id = serial_shared_object.id;
+        // Refreshes are taken too, the slave may have been reset since it last had the same version
+        if (SERIAL_CRC_VALID(Serial_shared_object_t, serial_shared_object) && id < SPLIT_SHARED_OBJECTS && shared_objects[id].data) {
+            memcpy(shared_objects[id].data, (void *)serial_shared_object.data, shared_objects[id].size);
+            shared_objects[id].version = serial_shared_object.version;
+        }
+        status_shared_object = TRANSACTION_END;
+    }
+}
+
+#    else
+#        define transport_shared_objects_master()
+#        define transport_shared_objects_slave()
+#    endif
+
+#    ifdef SPLIT_OLED_MIRROR
+
+// The slave's display, drawn on the master, one changed block at a time after everything else of the scan.
+
+#        ifndef SPLIT_OLED_MIRROR_INTERVAL
+#            define SPLIT_OLED_MIRROR_INTERVAL 2
+#        endif
+
+static bool transport_oled_mirror_lost = false;  // the slave may have been reset since it last took a block
+
+void transport_oled_mirror_master(void) {
+    static uint16_t last_sent;
+
+    if (transport_oled_mirror_lost) {
+        oled_mirror_resend();
+        transport_oled_mirror_lost = false;
+    }
+    if (timer_elapsed(last_sent) < SPLIT_OLED_MIRROR_INTERVAL) {
+        return;
+    }
+    uint8_t block = oled_mirror_next_block();
+    if (block >= OLED_BLOCK_COUNT) {
+        return;
+    }
+    serial_oled_block.block = block;
+    memcpy((void *)serial_oled_block.data, oled_mirror_block_data(block), OLED_BLOCK_SIZE);
+    SERIAL_CRC_SET(Serial_oled_block_t, serial_oled_block);
+    last_sent = timer_read();
+    if (transport_transaction(PUT_OLED_BLOCK)) {
+        oled_mirror_block_sent(block);
+    }
+}
+
+void transport_oled_mirror_slave(void) {
+    if (status_oled_block == TRANSACTION_ACCEPTED) {
+        if (SERIAL_CRC_VALID(Serial_oled_block_t, serial_oled_block)) {
+            oled_mirror_write_block(serial_oled_block.block, (const uint8_t *)serial_oled_block.data);
+        }
+        status_oled_block = TRANSACTION_END;
+    }
+}
+
+#    else
+#        define transport_oled_mirror_master()
+#        define transport_oled_mirror_slave()
+#    endif
+
+#    ifdef SPLIT_TRANSPORT_DELTA
+static bool    serial_s2m_stale = true;
+static uint8_t serial_s2m_last_sequence;
+
+static Serial_m2s_buffer_t serial_m2s_last;
+static bool                serial_m2s_sent = false;
+static uint16_t            serial_m2s_last_time;
+
+// Sends serial_m2s_buffer when a field other than sync_timer changed, or as a heartbeat that keeps sync_timer aligned
+static void transport_master_state(void) {
+    Serial_m2s_buffer_t *next = (Serial_m2s_buffer_t *)&serial_m2s_buffer;
+
+#        ifndef DISABLE_SYNC_TIMER
+    next->sync_timer = serial_m2s_last.sync_timer;
+#        endif
+    if (serial_m2s_sent && timer_elapsed(serial_m2s_last_time) < SPLIT_TRANSPORT_HEARTBEAT && memcmp(next, &serial_m2s_last, sizeof(serial_m2s_last)) == 0) {
+        return;
+    }
+
+    serial_m2s_sent = transport_m2s_transaction(PUT_MASTER_STATE);
+    if (serial_m2s_sent) {
+        memcpy(&serial_m2s_last, next, sizeof(serial_m2s_last));
+        serial_m2s_last_time = timer_read();
+    }
+}
+#    endif
+
+#    ifdef SPLIT_TRANSPORT_EVENTS
+
+// Key events generated by the slave, which the master takes by their count and applies in order.
+// The whole matrix is only read again when the two halves need to resync.
+
+// Events the master received and matrix.c did not apply yet
+SPSC_QUEUE(serial_event_queue, split_key_event_t, SPLIT_TRANSPORT_EVENT_BUFFER + 1)
+
+static bool    serial_events_synced = false;
+static uint8_t serial_events_taken;  // events received from the slave, modulo 256
+
+const split_key_event_t *transport_master_event_peek(void) { return serial_event_queue_peek(); }
+
+void transport_master_event_drop(void) { serial_event_queue_drop(); }
+
+static bool transport_events_master(matrix_row_t slave_matrix[]) {
+    if (serial_events_synced && serial_s2m_poll.event_count != serial_events_taken) {
+        if (!transport_transaction(GET_SLAVE_EVENTS)) {
+            return false;
+        }
+        uint8_t missed = serial_events.event_count - serial_events_taken;
+        if (missed <= SPLIT_TRANSPORT_EVENT_BUFFER) {
+            // Whatever does not fit in the queue is taken again next time
+            for (uint8_t i = SPLIT_TRANSPORT_EVENT_BUFFER - missed; i < SPLIT_TRANSPORT_EVENT_BUFFER; i++) {
+                split_key_event_t event = serial_events.events[i];
+                if (!serial_event_queue_push(&event)) {
+                    break;
+                }
+                serial_events_taken++;
+            }
+            return true;
+        }
+        // The slave no longer holds every event the master is missing
+        if (!transport_transaction(GET_SLAVE_MATRIX_DATA)) {
+            return false;
+        }
+        serial_events_synced = false;
+    }
+    if (!serial_events_synced) {
+        // serial_s2m_buffer was read by this call, its matrix is the one its event count leads up to
+        serial_unpack_matrix(slave_matrix, serial_s2m_buffer.packed_matrix);
+        serial_events_taken = serial_s2m_buffer.event_count;
+        serial_event_queue_clear();
+        serial_events_synced = true;
+    }
+    return true;
+}
+
+static matrix_row_t    serial_events_matrix[ROWS_PER_HAND];  // the slave's half as its events left it
+static Serial_events_t serial_events_next;
+
+// Turns every change of the slave's debounced half into an event, stamped with the time its row changed
+static void transport_events_slave(const matrix_row_t slave_matrix[]) {
+    bool added = false;
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        matrix_row_t change = slave_matrix[row] ^ serial_events_matrix[row];
+        for (uint8_t col = 0; change; col++, change >>= 1) {
+            if (change & 1) {
+                memmove(&serial_events_next.events[0], &serial_events_next.events[1], sizeof(serial_events_next.events) - sizeof(split_key_event_t));
+                serial_events_next.events[SPLIT_TRANSPORT_EVENT_BUFFER - 1] = (split_key_event_t){
+                    .row     = row,
+                    .col     = col,
+                    .pressed = (slave_matrix[row] >> col) & 1,
+                    .time    = serial_s2m_buffer.smatrix_time[row],
+                };
+                serial_events_next.event_count++;
+                added = true;
+            }
+        }
+        serial_events_matrix[row] = slave_matrix[row];
+    }
+    if (added) {
+        // The events have to be in place before the master can see the new count
+        SERIAL_CRC_SET(Serial_events_t, serial_events_next);
+        memcpy((void *)&serial_events, &serial_events_next, sizeof(serial_events_next));
+        serial_s2m_poll.event_count = serial_events_next.event_count;
+    }
+    serial_s2m_buffer.event_count = serial_events_next.event_count;
+}
+#    endif
+
 bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+#    ifdef SPLIT_TRANSPORT_STATS
+    static uint16_t last_good;
+    static bool     had_good = false;
+#    endif
 #    ifndef SERIAL_USE_MULTI_TRANSACTION
-    if (soft_serial_transaction() != TRANSACTION_END) {
+    if (!transport_main_transaction()) {
         return false;
     }
 #    else
     transport_rgblight_master();
-    if (soft_serial_transaction(GET_SLAVE_MATRIX) != TRANSACTION_END) {
+    transport_rgb_matrix_master();
+    if (!transport_main_transaction()) {
+#        ifdef SPLIT_TRANSPORT_DELTA
+        serial_s2m_stale = true;
+#        endif
+#        ifdef SPLIT_OLED_MIRROR
+        transport_oled_mirror_lost = true;
+#        endif
+#        ifdef SPLIT_TRANSPORT_EVENTS
+        serial_events_synced = false;
+#        endif
+        return false;
+    }
+#        ifdef SPLIT_TRANSPORT_DELTA
+    // serial_s2m_buffer still holds what was read last time unless the slave says it changed
+    if (serial_s2m_stale || SERIAL_S2M_SEQUENCE != serial_s2m_last_sequence) {
+        uint8_t sequence = SERIAL_S2M_SEQUENCE;
+        if (!transport_transaction(GET_SLAVE_MATRIX_DATA)) {
+            serial_s2m_stale = true;
+#            ifdef SPLIT_TRANSPORT_EVENTS
+            serial_events_synced = false;
+#            endif
+            return false;
+        }
+        serial_s2m_last_sequence = sequence;
+        serial_s2m_stale         = false;
+    }
+#        endif
+#        ifdef SPLIT_TRANSPORT_EVENTS
+    if (!transport_events_master(slave_matrix)) {
+        serial_s2m_stale     = true;
+        serial_events_synced = false;
         return false;
     }
+#        endif
+#    endif
+    transport_pointing_master();
+    transport_shared_objects_master();
+    transport_oled_mirror_master();
+#    ifdef SPLIT_TRANSPORT_STATS
+    uint16_t gap = timer_elapsed(last_good);
+    if (had_good && gap > transport_stats.max_gap) {
+        transport_stats.max_gap = gap;
+    }
+    last_good = timer_read();
+    had_good  = true;
 #    endif
 
-    // TODO:  if MATRIX_COLS > 8 change to unpack()
-    for (int i = 0; i < ROWS_PER_HAND; ++i) {
-        slave_matrix[i]              = serial_s2m_buffer.smatrix[i];
+#    ifndef SPLIT_TRANSPORT_EVENTS
+    serial_unpack_matrix(slave_matrix, serial_s2m_buffer.packed_matrix);
+#    endif
 #    ifdef SPLIT_TRANSPORT_MIRROR
+    for (int i = 0; i < ROWS_PER_HAND; ++i) {
         serial_m2s_buffer.mmatrix[i] = master_matrix[i];
-#    endif
     }
+#    endif
 
 #    ifdef BACKLIGHT_ENABLE
     // Write backlight level for slave to read
@@ -343,44 +1157,98 @@ bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])
     serial_m2s_buffer.oneshot_mods = get_oneshot_mods();
 #        endif
 #    endif
-#    ifndef DISABLE_SYNC_TIMER
-    serial_m2s_buffer.sync_timer   = sync_timer_read32() + SYNC_TIMER_OFFSET;
+#    ifdef SPLIT_TRANSPORT_DELTA
+    transport_master_state();
 #    endif
     return true;
 }
 
 void transport_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
     transport_rgblight_slave();
-#    ifndef DISABLE_SYNC_TIMER
-    sync_timer_update(serial_m2s_buffer.sync_timer);
+    transport_rgb_matrix_slave();
+    transport_pointing_slave();
+    transport_shared_objects_slave();
+    transport_oled_mirror_slave();
+#    ifdef SPLIT_TRANSPORT_CRC
+    // A corrupted update is ignored, the slave keeps the last state that arrived intact
+    static Serial_m2s_buffer_t m2s_good = {};
+    bool                       m2s_valid = SERIAL_CRC_VALID(Serial_m2s_buffer_t, serial_m2s_buffer);
+    if (m2s_valid) {
+        memcpy(&m2s_good, (void *)&serial_m2s_buffer, sizeof(m2s_good));
+    }
+    const Serial_m2s_buffer_t *m2s = &m2s_good;
+#    else
+    bool                                m2s_valid = true;
+    const volatile Serial_m2s_buffer_t *m2s       = &serial_m2s_buffer;
+#    endif
+#    ifdef SPLIT_TRANSPORT_DELTA
+    // sync_timer is only meaningful right after the master sent it
+    if (status_m2s == TRANSACTION_ACCEPTED) {
+#        ifndef DISABLE_SYNC_TIMER
+        if (m2s_valid) {
+            sync_timer_update(m2s->sync_timer);
+        }
+#        endif
+        status_m2s = TRANSACTION_END;
+    }
+#    elif !defined(DISABLE_SYNC_TIMER)
+    if (m2s_valid) {
+        sync_timer_update(m2s->sync_timer);
+    }
 #    endif
+    (void)m2s_valid;
+    (void)m2s;
 
-    // TODO: if MATRIX_COLS > 8 change to pack()
-    for (int i = 0; i < ROWS_PER_HAND; ++i) {
-        serial_s2m_buffer.smatrix[i] = slave_matrix[i];
-#    ifdef SPLIT_TRANSPORT_MIRROR
-        master_matrix[i]             = serial_m2s_buffer.mmatrix[i];
+    uint8_t packed_matrix[SERIAL_PACKED_MATRIX_SIZE];
+    serial_pack_matrix(packed_matrix, slave_matrix);
+#    if defined(SPLIT_TRANSPORT_EVENTS)
+    // The master follows the matrix through the events, and only reads it whole to resync
+    transport_events_slave(slave_matrix);
+    memcpy((void *)serial_s2m_buffer.packed_matrix, packed_matrix, sizeof(packed_matrix));
+#    elif defined(SPLIT_TRANSPORT_DELTA)
+    // The data has to be in place before the master can see the new sequence number
+    if (memcmp(packed_matrix, (void *)serial_s2m_buffer.packed_matrix, sizeof(packed_matrix)) != 0) {
+        memcpy((void *)serial_s2m_buffer.packed_matrix, packed_matrix, sizeof(packed_matrix));
+        SERIAL_S2M_SEQUENCE++;
+    }
+#    else
+    memcpy((void *)serial_s2m_buffer.packed_matrix, packed_matrix, sizeof(packed_matrix));
 #    endif
+#    ifdef SPLIT_TRANSPORT_MIRROR
+    for (int i = 0; i < ROWS_PER_HAND; ++i) {
+        master_matrix[i] = m2s->mmatrix[i];
     }
+#    endif
 #    ifdef BACKLIGHT_ENABLE
-    backlight_set(serial_m2s_buffer.backlight_level);
+    backlight_set(m2s->backlight_level);
 #    endif
 
 #    ifdef ENCODER_ENABLE
+#        ifdef SPLIT_TRANSPORT_DELTA
+    uint8_t encoder_state[ENCODER_STATE_SIZE(NUMBER_OF_ENCODERS)];
+    encoder_state_raw(encoder_state);
+    if (memcmp(encoder_state, (void *)serial_s2m_buffer.encoder_state, sizeof(encoder_state)) != 0) {
+        memcpy((void *)serial_s2m_buffer.encoder_state, encoder_state, sizeof(encoder_state));
+        SERIAL_S2M_SEQUENCE++;
+    }
+#        else
     encoder_state_raw((uint8_t *)serial_s2m_buffer.encoder_state);
+#        endif
 #    endif
 
 #    ifdef WPM_ENABLE
-    set_current_wpm(serial_m2s_buffer.current_wpm);
+    set_current_wpm(m2s->current_wpm);
 #    endif
 
 #    ifdef SPLIT_MODS_ENABLE
-    set_mods(serial_m2s_buffer.real_mods);
-    set_weak_mods(serial_m2s_buffer.weak_mods);
+    set_mods(m2s->real_mods);
+    set_weak_mods(m2s->weak_mods);
 #        ifndef NO_ACTION_ONESHOT
-    set_oneshot_mods(serial_m2s_buffer.oneshot_mods);
+    set_oneshot_mods(m2s->oneshot_mods);
 #        endif
 #    endif
+
+    SERIAL_CRC_SET(Serial_s2m_buffer_t, serial_s2m_buffer);
 }
 
 #endif
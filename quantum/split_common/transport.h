@@ -8,3 +8,52 @@ void transport_slave_init(void);
 // returns false if valid data not received from slave
 bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]);
 void transport_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]);
+
+// sync_timer times at which the slave rows last changed, valid after a successful transport_master()
+void transport_master_row_times(uint16_t slave_row_time[]);
+void transport_slave_row_times(uint16_t slave_row_time[]);
+
+#ifdef SPLIT_TRANSPORT_EVENTS
+typedef struct {
+    uint8_t  row;          // within the slave's half
+    uint8_t  col : 7;
+    uint8_t  pressed : 1;
+    uint16_t time;         // sync_timer time at which the slave's debounced row changed
+} split_key_event_t;
+
+// Master: the oldest key event from the slave that is still to be applied, in the order the slave generated them,
+// or NULL when there is none. transport_master() then only overwrites slave_matrix when the two halves resync.
+const split_key_event_t *transport_master_event_peek(void);
+void                     transport_master_event_drop(void);
+#endif
+
+#if defined(SPLIT_TRANSPORT_STATS) && !defined(USE_I2C)
+typedef struct {
+    uint32_t transactions;  // every attempt, retries included
+    uint32_t retries;       // attempts repeated after a failure
+    uint32_t errors;        // transactions that still failed after every retry
+    uint32_t crc_errors;    // slave data that arrived corrupted
+    uint16_t max_gap;       // longest time between two good reads of the slave matrix, in ms
+} split_transport_stats_t;
+
+// Counters kept by the master, serial transport only
+const split_transport_stats_t *transport_get_stats(void);
+#endif
+
+#ifdef SPLIT_SHARED_OBJECTS
+#    ifndef SPLIT_SHARED_OBJECT_SIZE
+#        define SPLIT_SHARED_OBJECT_SIZE 16
+#    endif
+
+// Keeps up to SPLIT_SHARED_OBJECTS blocks of the keyboard's or keymap's own data in step from the master to the
+// slave, serial transport only. Both halves register the same id with a buffer of the same size, at most
+// SPLIT_SHARED_OBJECT_SIZE bytes, or with NULL to unregister it.
+void split_shared_object_register(uint8_t id, void *data, uint8_t size);
+// Master: sends the object at most once every interval milliseconds, 0 (the default) for as soon as it changes
+void split_shared_object_set_interval(uint8_t id, uint16_t interval);
+// Master: the object's data changed and is to be sent. Changes are also noticed by comparing the data with a copy
+// every scan, unless SPLIT_SHARED_OBJECT_NO_COMPARE is defined.
+void split_shared_object_changed(uint8_t id);
+// Slave: changes whenever new data for the object arrived
+uint8_t split_shared_object_version(uint8_t id);
+#endif
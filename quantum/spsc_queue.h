@@ -0,0 +1,102 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Queue between one producer and one consumer, such as an interrupt handler
+ * and the main loop, that needs no locking and never disables interrupts.
+ *
+ *   SPSC_QUEUE(key_events, key_event_t, 16)
+ *
+ * declares a queue holding up to 15 key_event_t, and static functions for it:
+ *
+ *   bool         key_events_push(const key_event_t *item);  // producer, false when full
+ *   bool         key_events_pop(key_event_t *item);         // consumer, false when empty
+ *   key_event_t *key_events_peek(void);                     // consumer, NULL when empty
+ *   void         key_events_drop(void);                     // consumer, pops the peeked item
+ *   void         key_events_clear(void);                    // consumer
+ *   uint8_t      key_events_count(void);                    // either side
+ *
+ * Each index is only written by one side, and is a single byte, so that it
+ * is read and written whole on AVR too. The item is written before the
+ * producer publishes it by moving the head, and read before the consumer
+ * hands the slot back by moving the tail, with a barrier in between.
+ */
+
+#if defined(__AVR__)
+// A single core that doesn't reorder memory accesses, only the compiler could
+#    define SPSC_QUEUE_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#    define SPSC_QUEUE_BARRIER() __sync_synchronize()
+#endif
+
+// size is the number of slots, one of which is always left free, from 2 to 256
+#define SPSC_QUEUE(name, type, size)                                                                                   \
+    _Static_assert((size) >= 2 && (size) <= 256, #name " must have from 2 to 256 slots");                              \
+    static type             name##_items[size];                                                                        \
+    static volatile uint8_t name##_head = 0; /* only written by the producer */                                        \
+    static volatile uint8_t name##_tail = 0; /* only written by the consumer */                                        \
+                                                                                                                       \
+    static inline uint8_t name##_next(uint8_t index) { return index == (size)-1 ? 0 : index + 1; }                     \
+                                                                                                                       \
+    static inline bool name##_push(const type *item) {                                                                 \
+        uint8_t head = name##_head;                                                                                    \
+        uint8_t next = name##_next(head);                                                                              \
+        if (next == name##_tail) {                                                                                     \
+            return false;                                                                                              \
+        }                                                                                                              \
+        name##_items[head] = *item;                                                                                    \
+        SPSC_QUEUE_BARRIER();                                                                                          \
+        name##_head = next;                                                                                            \
+        return true;                                                                                                   \
+    }                                                                                                                  \
+                                                                                                                       \
+    static inline type *name##_peek(void) {                                                                            \
+        uint8_t tail = name##_tail;                                                                                    \
+        if (tail == name##_head) {                                                                                     \
+            return NULL;                                                                                               \
+        }                                                                                                              \
+        SPSC_QUEUE_BARRIER();                                                                                          \
+        return &name##_items[tail];                                                                                    \
+    }                                                                                                                  \
+                                                                                                                       \
+    static inline void name##_drop(void) {                                                                             \
+        SPSC_QUEUE_BARRIER();                                                                                          \
+        name##_tail = name##_next(name##_tail);                                                                        \
+    }                                                                                                                  \
+                                                                                                                       \
+    static inline bool name##_pop(type *item) {                                                                        \
+        type *next = name##_peek();                                                                                    \
+        if (!next) {                                                                                                   \
+            return false;                                                                                              \
+        }                                                                                                              \
+        *item = *next;                                                                                                 \
+        name##_drop();                                                                                                 \
+        return true;                                                                                                   \
+    }                                                                                                                  \
+                                                                                                                       \
+    static inline void name##_clear(void) { name##_tail = name##_head; }                                               \
+                                                                                                                       \
+    static inline uint8_t name##_count(void) {                                                                         \
+        uint8_t head = name##_head;                                                                                    \
+        uint8_t tail = name##_tail;                                                                                    \
+        return head >= tail ? head - tail : (size)-tail + head;                                                        \
+    }
@@ -18,12 +18,17 @@
 #include <stddef.h>
 #include <string.h>
 
-#ifdef NO_PRINT
-#    error "You need undef NO_PRINT to use the variable trace feature"
-#endif
+#ifdef EVENT_TRACE
+/* Modifications go into the event trace instead of being printed */
+#    include "event_trace.h"
+#else
+#    ifdef NO_PRINT
+#        error "You need undef NO_PRINT to use the variable trace feature"
+#    endif
 
-#ifndef CONSOLE_ENABLE
-#    error "The console needs to be enabled in the makefile to use the variable trace feature"
+#    ifndef CONSOLE_ENABLE
+#        error "The console needs to be enabled in the makefile to use the variable trace feature"
+#    endif
 #endif
 
 #define NUM_TRACED_VARIABLES 1
@@ -93,16 +98,22 @@ void verify_traced_variables(const char* func, int line) {
         traced_variable_t* t = &traced_variables[i];
         if (t->addr != NULL && t->name != NULL) {
             if (memcmp(t->last_value, t->addr, t->size) != 0) {
-#if defined(__AVR__)
+#ifdef EVENT_TRACE
+                uint8_t* addr  = (uint8_t*)(t->addr);
+                uint16_t value = t->size > 1 ? addr[0] | addr[1] << 8 : addr[0];
+                event_trace(EVENT_TRACE_VARIABLE, i, line, value);
+                memcpy(t->last_value, addr, t->size);
+#else
+#    if defined(__AVR__)
                 xprintf("Traced variable \"%S\" has been modified\n", t->name);
                 xprintf("Between %S:%d\n", t->func, t->line);
                 xprintf("And %S:%d\n", func, line);
 
-#else
+#    else
                 xprintf("Traced variable \"%s\" has been modified\n", t->name);
                 xprintf("Between %s:%d\n", t->func, t->line);
                 xprintf("And %s:%d\n", func, line);
-#endif
+#    endif
                 xprintf("Previous value ");
                 for (int j = 0; j < t->size; j++) {
                     print_hex8(t->last_value[j]);
@@ -114,6 +125,7 @@ void verify_traced_variables(const char* func, int line) {
                 }
                 xprintf("\n");
                 memcpy(t->last_value, addr, t->size);
+#endif
             }
         }
 
@@ -38,6 +38,8 @@
 #    define VIA_QMK_RGBLIGHT_ENABLE
 #endif
 
+#include <string.h>
+
 #include "quantum.h"
 
 #include "via.h"
@@ -48,6 +50,25 @@
 #include "version.h"  // for QMK_BUILDDATE used in EEPROM magic
 #include "via_ensure_keycode.h"
 
+#ifndef MIN
+#    define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
+#if defined(SPLIT_KEYBOARD) && defined(SPLIT_TRANSPORT_STATS) && !defined(USE_I2C)
+#    include "split_common/transport.h"
+#endif
+
+#ifdef EVENT_TRACE
+#    include "event_trace.h"
+#endif
+
+#ifdef VIA_TELEMETRY
+#    include "task_profile.h"
+#    ifdef EEPROM_DRIVER
+#        include "eeprom_driver.h"
+#    endif
+#endif
+
 // Forward declare some helpers.
 #if defined(VIA_QMK_BACKLIGHT_ENABLE)
 void via_qmk_backlight_set_value(uint8_t *data);
@@ -185,6 +206,84 @@ bool process_record_via(uint16_t keycode, keyrecord_t *record) {
     return true;
 }
 
+static void via_bulk_read(uint8_t buffer, uint16_t offset, uint8_t size, uint8_t *data) {
+    if (buffer == id_bulk_macro) {
+        dynamic_keymap_macro_get_buffer(offset, size, data);
+    } else {
+        dynamic_keymap_get_buffer(offset, size, data);
+    }
+}
+
+static void via_bulk_write(uint8_t buffer, uint16_t offset, uint8_t size, uint8_t *data) {
+    if (buffer == id_bulk_macro) {
+        dynamic_keymap_macro_set_buffer(offset, size, data);
+    } else {
+        dynamic_keymap_set_buffer(offset, size, data);
+    }
+}
+
+#ifdef VIA_TELEMETRY
+static uint8_t *via_telemetry_put(uint8_t *data, uint32_t value, uint8_t size) {
+    while (size--) {
+        *data++ = (value >> (size * 8)) & 0xFF;
+    }
+    return data;
+}
+
+// Big endian values, the ones this build can't measure read as all ones:
+// scan rate (32 bit), keyboard_task() average and max us (16 bit each), RGB matrix fps (16 bit),
+// dropped reports (32 bit), split transport errors and crc errors (32 bit each),
+// EEPROM blocks written (32 bit) and bytes pending in the write-back cache (16 bit)
+static void via_get_telemetry(uint8_t *data) {
+    data = via_telemetry_put(data, get_matrix_scan_rate(), 4);
+
+#    ifdef KEYBOARD_TASK_PROFILE
+    const task_profile_stats_t *task = task_profile_get(TASK_PROFILE_KEYBOARD_TASK);
+    uint32_t                    avg  = task->count ? task_profile_ticks_to_us(task->total / task->count) : 0;
+    uint32_t                    max  = task_profile_ticks_to_us(task->max);
+    data                             = via_telemetry_put(data, MIN(avg, UINT16_MAX - 1), 2);
+    data                             = via_telemetry_put(data, MIN(max, UINT16_MAX - 1), 2);
+#    else
+    data = via_telemetry_put(data, UINT32_MAX, 4);
+#    endif
+
+#    if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_STATS)
+    data = via_telemetry_put(data, rgb_matrix_get_stats()->fps, 2);
+#    else
+    data = via_telemetry_put(data, UINT16_MAX, 2);
+#    endif
+
+    data = via_telemetry_put(data, host_dropped_reports(), 4);
+
+#    if defined(SPLIT_KEYBOARD) && defined(SPLIT_TRANSPORT_STATS) && !defined(USE_I2C)
+    const split_transport_stats_t *split = transport_get_stats();
+    data                                 = via_telemetry_put(data, split->errors, 4);
+    data                                 = via_telemetry_put(data, split->crc_errors, 4);
+#    else
+    data = via_telemetry_put(data, UINT32_MAX, 4);
+    data = via_telemetry_put(data, UINT32_MAX, 4);
+#    endif
+
+#    ifdef EEPROM_DRIVER
+    data = via_telemetry_put(data, eeprom_driver_get_writes(), 4);
+    data = via_telemetry_put(data, eeprom_driver_get_pending(), 2);
+#    else
+    data = via_telemetry_put(data, UINT32_MAX, 4);
+    data = via_telemetry_put(data, UINT16_MAX, 2);
+#    endif
+}
+
+// Starts the keyboard_task() time and RGB matrix maxima over, the counters keep going
+static void via_reset_telemetry(void) {
+#    ifdef KEYBOARD_TASK_PROFILE
+    task_profile_reset();
+#    endif
+#    if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_STATS)
+    rgb_matrix_reset_stats();
+#    endif
+}
+#endif
+
 // Keyboard level code can override this to handle custom messages from VIA.
 // See raw_hid_receive() implementation.
 // DO NOT call raw_hid_send() in the override function.
@@ -193,6 +292,105 @@ __attribute__((weak)) void raw_hid_receive_kb(uint8_t *data, uint8_t length) {
     *command_id         = id_unhandled;
 }
 
+#if defined(VIA_QMK_BACKLIGHT_ENABLE) || defined(VIA_QMK_RGBLIGHT_ENABLE) || defined(VIA_CUSTOM_LIGHTING_ENABLE)
+// Value bytes a lighting value handled here takes, 0 for the ones it doesn't know
+static uint8_t via_lighting_value_size(uint8_t value_id) {
+    switch (value_id) {
+#    if defined(VIA_QMK_BACKLIGHT_ENABLE)
+        case id_qmk_backlight_brightness:
+        case id_qmk_backlight_effect:
+            return 1;
+#    endif
+#    if defined(VIA_QMK_RGBLIGHT_ENABLE)
+        case id_qmk_rgblight_brightness:
+        case id_qmk_rgblight_effect:
+        case id_qmk_rgblight_effect_speed:
+            return 1;
+        case id_qmk_rgblight_color:
+            return 2;
+#    endif
+        default:
+            return 0;
+    }
+}
+
+/* Sets several lighting values from one packet, [count] followed by count times [value_id][size][value...]. The
+ * whole packet is checked before any value is set, and the RGB Light color and brightness are applied in one go
+ * once every value has been read. Like id_lighting_set_value, nothing is written to EEPROM until id_lighting_save.
+ */
+static bool via_lighting_set_values(uint8_t *data, uint8_t length) {
+    uint8_t  count  = data[0];
+    uint16_t offset = 1;
+    for (uint8_t i = 0; i < count; i++) {
+        if (offset + 2 > length || offset + 2 + data[offset + 1] > length) {
+            return false;
+        }
+        uint8_t size = via_lighting_value_size(data[offset]);
+#    if defined(VIA_CUSTOM_LIGHTING_ENABLE)
+        // The others go to raw_hid_receive_kb() one by one, as an id_lighting_set_value packet each
+        if (data[offset + 1] < size) {
+#    else
+        if (!size || data[offset + 1] < size) {
+#    endif
+            return false;
+        }
+        offset += 2 + data[offset + 1];
+    }
+
+#    if defined(VIA_QMK_RGBLIGHT_ENABLE)
+    uint8_t hue = rgblight_get_hue();
+    uint8_t sat = rgblight_get_sat();
+    uint8_t val = rgblight_get_val();
+    bool    hsv = false;
+#    endif
+    offset = 1;
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t  value_id   = data[offset];
+        uint8_t  size       = data[offset + 1];
+        uint8_t *value_data = &data[offset + 2];
+        offset += 2 + size;
+
+        switch (value_id) {
+#    if defined(VIA_QMK_BACKLIGHT_ENABLE)
+            case id_qmk_backlight_brightness:
+            case id_qmk_backlight_effect:
+                via_qmk_backlight_set_value((uint8_t[]){value_id, value_data[0]});
+                break;
+#    endif
+#    if defined(VIA_QMK_RGBLIGHT_ENABLE)
+            case id_qmk_rgblight_brightness:
+                val = value_data[0];
+                hsv = true;
+                break;
+            case id_qmk_rgblight_color:
+                hue = value_data[0];
+                sat = value_data[1];
+                hsv = true;
+                break;
+            case id_qmk_rgblight_effect:
+            case id_qmk_rgblight_effect_speed:
+                via_qmk_rgblight_set_value((uint8_t[]){value_id, value_data[0]});
+                break;
+#    endif
+            default: {
+#    if defined(VIA_CUSTOM_LIGHTING_ENABLE)
+                uint8_t packet[32] = {id_lighting_set_value, value_id};
+                memcpy(&packet[2], value_data, MIN(size, sizeof(packet) - 2));
+                raw_hid_receive_kb(packet, MIN(length + 1, sizeof(packet)));
+#    endif
+                break;
+            }
+        }
+    }
+#    if defined(VIA_QMK_RGBLIGHT_ENABLE)
+    if (hsv) {
+        rgblight_sethsv_noeeprom(hue, sat, val);
+    }
+#    endif
+    return true;
+}
+#endif
+
 // VIA handles received HID messages first, and will route to
 // raw_hid_receive_kb() for command IDs that are not handled here.
 // This gives the keyboard code level the ability to handle the command
@@ -207,6 +405,8 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
         case id_get_protocol_version: {
             command_data[0] = VIA_PROTOCOL_VERSION >> 8;
             command_data[1] = VIA_PROTOCOL_VERSION & 0xFF;
+            // Frame size, so hosts can size id_bulk_read and id_bulk_write frames
+            command_data[2] = length;
             break;
         }
         case id_get_keyboard_value: {
@@ -246,6 +446,51 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
 #endif
                     break;
                 }
+#if defined(SPLIT_KEYBOARD) && defined(SPLIT_TRANSPORT_STATS) && !defined(USE_I2C)
+                case id_split_transport_stats: {
+                    const split_transport_stats_t *stats = transport_get_stats();
+                    uint32_t                       values[] = {stats->transactions, stats->retries, stats->errors, stats->crc_errors};
+                    uint8_t                        i        = 1;
+                    for (uint8_t v = 0; v < sizeof(values) / sizeof(values[0]); v++) {
+                        command_data[i++] = (values[v] >> 24) & 0xFF;
+                        command_data[i++] = (values[v] >> 16) & 0xFF;
+                        command_data[i++] = (values[v] >> 8) & 0xFF;
+                        command_data[i++] = values[v] & 0xFF;
+                    }
+                    command_data[i++] = (stats->max_gap >> 8) & 0xFF;
+                    command_data[i++] = stats->max_gap & 0xFF;
+                    break;
+                }
+#endif
+#if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_STATS)
+                case id_rgb_matrix_stats: {
+                    const rgb_matrix_stats_t *stats    = rgb_matrix_get_stats();
+                    uint16_t                  values[] = {stats->fps, stats->render_us, stats->render_max_us, stats->flush_us, stats->flush_max_us};
+                    uint8_t                   i        = 1;
+                    for (uint8_t v = 0; v < sizeof(values) / sizeof(values[0]); v++) {
+                        command_data[i++] = (values[v] >> 8) & 0xFF;
+                        command_data[i++] = values[v] & 0xFF;
+                    }
+                    command_data[i++] = stats->process_limit;
+                    break;
+                }
+#endif
+#ifdef VIA_TELEMETRY
+                case id_telemetry: {
+                    via_get_telemetry(&command_data[1]);
+                    break;
+                }
+#endif
+#ifdef EVENT_TRACE
+                case id_event_trace: {
+                    // The number of records, then as many 8 byte records as fit. The frame isn't aligned for them.
+                    event_trace_record_t records[(64 - 3) / sizeof(event_trace_record_t)];  // raw HID frames are at most 64 bytes
+                    uint8_t              count = event_trace_read(records, MIN((length - 3) / sizeof(event_trace_record_t), sizeof(records) / sizeof(records[0])));
+                    command_data[1]            = count;
+                    memcpy(&command_data[2], records, count * sizeof(event_trace_record_t));
+                    break;
+                }
+#endif
                 default: {
                     raw_hid_receive_kb(data, length);
                     break;
@@ -260,6 +505,12 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
                     via_set_layout_options(value);
                     break;
                 }
+#ifdef VIA_TELEMETRY
+                case id_telemetry: {
+                    via_reset_telemetry();
+                    break;
+                }
+#endif
                 default: {
                     raw_hid_receive_kb(data, length);
                     break;
@@ -326,6 +577,16 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
 #if !defined(VIA_QMK_BACKLIGHT_ENABLE) && !defined(VIA_QMK_RGBLIGHT_ENABLE) && !defined(VIA_CUSTOM_LIGHTING_ENABLE)
             // Return the unhandled state
             *command_id = id_unhandled;
+#endif
+            break;
+        }
+        case id_lighting_set_values: {
+#if defined(VIA_QMK_BACKLIGHT_ENABLE) || defined(VIA_QMK_RGBLIGHT_ENABLE) || defined(VIA_CUSTOM_LIGHTING_ENABLE)
+            if (!via_lighting_set_values(command_data, length - 1)) {
+                *command_id = id_unhandled;
+            }
+#else
+            *command_id = id_unhandled;
 #endif
             break;
         }
@@ -341,13 +602,13 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
         }
         case id_dynamic_keymap_macro_get_buffer: {
             uint16_t offset = (command_data[0] << 8) | command_data[1];
-            uint16_t size   = command_data[2];  // size <= 28
+            uint16_t size   = MIN(command_data[2], length - 4);  // size <= 28 with 32 byte frames
             dynamic_keymap_macro_get_buffer(offset, size, &command_data[3]);
             break;
         }
         case id_dynamic_keymap_macro_set_buffer: {
             uint16_t offset = (command_data[0] << 8) | command_data[1];
-            uint16_t size   = command_data[2];  // size <= 28
+            uint16_t size   = MIN(command_data[2], length - 4);  // size <= 28 with 32 byte frames
             dynamic_keymap_macro_set_buffer(offset, size, &command_data[3]);
             break;
         }
@@ -361,16 +622,66 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
         }
         case id_dynamic_keymap_get_buffer: {
             uint16_t offset = (command_data[0] << 8) | command_data[1];
-            uint16_t size   = command_data[2];  // size <= 28
+            uint16_t size   = MIN(command_data[2], length - 4);  // size <= 28 with 32 byte frames
             dynamic_keymap_get_buffer(offset, size, &command_data[3]);
             break;
         }
         case id_dynamic_keymap_set_buffer: {
             uint16_t offset = (command_data[0] << 8) | command_data[1];
-            uint16_t size   = command_data[2];  // size <= 28
+            uint16_t size   = MIN(command_data[2], length - 4);  // size <= 28 with 32 byte frames
             dynamic_keymap_set_buffer(offset, size, &command_data[3]);
             break;
         }
+        case id_bulk_read: {
+            // One request streams the whole range back, as many frames as it takes
+            uint8_t  buffer    = command_data[0];
+            uint16_t offset    = (command_data[1] << 8) | command_data[2];
+            uint16_t remaining = (command_data[3] << 8) | command_data[4];
+            if (buffer > id_bulk_macro) {
+                *command_id = id_unhandled;
+                break;
+            }
+            do {
+                uint8_t size    = MIN(remaining, length - 5);
+                command_data[1] = offset >> 8;
+                command_data[2] = offset & 0xFF;
+                command_data[3] = size;
+                via_bulk_read(buffer, offset, size, &command_data[4]);
+                raw_hid_send(data, length);
+                offset += size;
+                remaining -= size;
+            } while (remaining);
+            return;
+        }
+        case id_bulk_write: {
+            // Frames are pipelined, only the last one (or a bad one) gets a reply
+            uint8_t  buffer = command_data[0];
+            uint16_t offset = (command_data[1] << 8) | command_data[2];
+            uint8_t  size   = command_data[3];
+            uint8_t  flags  = command_data[4];
+            if (buffer > id_bulk_macro || size > length - 6) {
+                *command_id = id_unhandled;
+                break;
+            }
+            via_bulk_write(buffer, offset, size, &command_data[5]);
+            if (!(flags & VIA_BULK_LAST)) {
+                return;
+            }
+            break;
+        }
+#if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_DIRECT_ENABLE)
+        case id_rgb_matrix_direct: {
+            // Streamed like id_bulk_write, only a packet asking for it (or a bad one) gets a reply
+            if (!rgb_matrix_direct_receive(command_data, length - 1)) {
+                *command_id = id_unhandled;
+                break;
+            }
+            if (!(command_data[0] & RGB_MATRIX_DIRECT_ACK)) {
+                return;
+            }
+            break;
+        }
+#endif
         default: {
             // The command ID is not known
             // Return the unhandled state
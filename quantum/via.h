@@ -78,13 +78,30 @@ enum via_command_id {
     id_dynamic_keymap_get_layer_count       = 0x11,
     id_dynamic_keymap_get_buffer            = 0x12,
     id_dynamic_keymap_set_buffer            = 0x13,
+    id_bulk_read                            = 0x14,
+    id_bulk_write                           = 0x15,
+    id_rgb_matrix_direct                    = 0x16,
+    id_lighting_set_values                  = 0x17,
     id_unhandled                            = 0xFF,
 };
 
+// Buffers that id_bulk_read and id_bulk_write stream
+enum via_bulk_buffer_id {
+    id_bulk_dynamic_keymap = 0x00,
+    id_bulk_macro          = 0x01,
+};
+
+// id_bulk_write flag, the keyboard replies to the frame that carries it
+#define VIA_BULK_LAST 0x01
+
 enum via_keyboard_value_id {
-    id_uptime              = 0x01,  //
-    id_layout_options      = 0x02,
-    id_switch_matrix_state = 0x03
+    id_uptime                = 0x01,  //
+    id_layout_options        = 0x02,
+    id_switch_matrix_state   = 0x03,
+    id_split_transport_stats = 0x04,
+    id_rgb_matrix_stats      = 0x05,
+    id_telemetry             = 0x06,
+    id_event_trace           = 0x07
 };
 
 enum via_lighting_value {
@@ -16,16 +16,45 @@
  */
 
 #include "wpm.h"
+#include "deferred_exec.h"
+#include "event_bus.h"
 
-// WPM Stuff
-static uint8_t  current_wpm = 0;
-static uint8_t  latest_wpm  = 0;
-static uint16_t wpm_timer   = 0;
+/* Keystrokes are counted in one-second buckets, and the WPM is the number of
+ * them in the last WPM_WINDOW buckets, a word being five keystrokes. A
+ * deferred callback moves on to the next bucket every second, dropping the
+ * oldest, and stops once the window is empty. */
 
-// This smoothing is 40 keystrokes
-static const float wpm_smoothing = 0.0487;
+static uint8_t        current_wpm = 0;
+static uint8_t        buckets[WPM_WINDOW];
+static uint8_t        bucket     = 0;  // the one keystrokes are counted in now
+static uint16_t       keystrokes = 0;  // in all the buckets
+static deferred_token wpm_token  = INVALID_DEFERRED_TOKEN;
 
-void set_current_wpm(uint8_t new_wpm) { current_wpm = new_wpm; }
+static uint8_t keystrokes_to_wpm(uint16_t count) {
+    // WPM_WINDOW is a constant, so this is no actual division
+    uint32_t wpm = (uint32_t)count * 60 / 5 / WPM_WINDOW;
+    return wpm > UINT8_MAX ? UINT8_MAX : wpm;
+}
+
+void set_current_wpm(uint8_t new_wpm) {
+    if (current_wpm != new_wpm) {
+        current_wpm = new_wpm;
+        event_bus_publish(EVENT_BUS_WPM);
+    }
+}
+
+static uint32_t wpm_tick(uint32_t trigger_time, void *cb_arg) {
+    bucket = (bucket + 1) % WPM_WINDOW;
+    keystrokes -= buckets[bucket];
+    buckets[bucket] = 0;
+    set_current_wpm(keystrokes_to_wpm(keystrokes));
+
+    if (keystrokes == 0) {
+        wpm_token = INVALID_DEFERRED_TOKEN;
+        return 0;
+    }
+    return 1000;
+}
 
 uint8_t get_current_wpm(void) { return current_wpm; }
 
@@ -48,17 +77,13 @@ __attribute__((weak)) bool wpm_keycode_user(uint16_t keycode) {
 
 void update_wpm(uint16_t keycode) {
     if (wpm_keycode(keycode)) {
-        if (wpm_timer > 0) {
-            latest_wpm  = 60000 / timer_elapsed(wpm_timer) / 5;
-            current_wpm = (latest_wpm - current_wpm) * wpm_smoothing + current_wpm;
+        if (buckets[bucket] < UINT8_MAX) {
+            buckets[bucket]++;
+            keystrokes++;
+            set_current_wpm(keystrokes_to_wpm(keystrokes));
+        }
+        if (wpm_token == INVALID_DEFERRED_TOKEN) {
+            wpm_token = defer_exec(1000, wpm_tick, NULL);
         }
-        wpm_timer = timer_read();
-    }
-}
-
-void decay_wpm(void) {
-    if (timer_elapsed(wpm_timer) > 1000) {
-        current_wpm = (0 - current_wpm) * wpm_smoothing + current_wpm;
-        wpm_timer   = timer_read();
     }
 }
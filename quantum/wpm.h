@@ -19,6 +19,11 @@
 
 #include "quantum.h"
 
+// Seconds of keystrokes the WPM is computed from
+#ifndef WPM_WINDOW
+#    define WPM_WINDOW 5
+#endif
+
 bool wpm_keycode(uint16_t keycode);
 bool wpm_keycode_kb(uint16_t keycode);
 bool wpm_keycode_user(uint16_t keycode);
@@ -26,5 +31,3 @@ bool wpm_keycode_user(uint16_t keycode);
 void    set_current_wpm(uint8_t);
 uint8_t get_current_wpm(void);
 void    update_wpm(uint16_t);
-
-void decay_wpm(void);
@@ -42,17 +42,14 @@ TEST_F(KeyPress, CorrectKeysAreReportedWhenTwoKeysArePressed) {
     TestDriver driver;
     press_key(1, 0);
     press_key(0, 3);
-    // Note that QMK only processes one key at a time
-    // See issue #1476 for more information
+    // Both keys are processed in the same scan, in matrix order
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B, KC_C)));
     keyboard_task();
     release_key(1, 0);
     release_key(0, 3);
     // Note that the first key released is the first one in the matrix order
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
     keyboard_task();
 }
@@ -69,10 +66,8 @@ TEST_F(KeyPress, LeftShiftIsReportedCorrectly) {
     TestDriver driver;
     press_key(3, 0);
     press_key(0, 0);
-    // Unfortunately modifiers are also processed in the wrong order
-    // See issue #1476 for more information
+    // Modifiers are processed in matrix order too, so they are reported after the key
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_LSFT)));
     keyboard_task();
     release_key(0, 0);
@@ -87,10 +82,8 @@ TEST_F(KeyPress, PressLeftShiftAndControl) {
     TestDriver driver;
     press_key(3, 0);
     press_key(5, 0);
-    // Unfortunately modifiers are also processed in the wrong order
-    // See issue #1476 for more information
+    // Both modifiers are processed in the same scan, in matrix order
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_LCTRL)));
     keyboard_task();
 }
@@ -99,10 +92,8 @@ TEST_F(KeyPress, LeftAndRightShiftCanBePressedAtTheSameTime) {
     TestDriver driver;
     press_key(3, 0);
     press_key(4, 0);
-    // Unfortunately modifiers are also processed in the wrong order
-    // See issue #1476 for more information
+    // Both modifiers are processed in the same scan, in matrix order
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_RSFT)));
     keyboard_task();
 }
@@ -0,0 +1,198 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "test_common.hpp"
+#include "action_tapping.h"
+
+extern "C" {
+void advance_time(uint32_t ms);
+}
+
+using testing::_;
+using testing::Invoke;
+
+/*
+ * Replays typing traces through keyboard_task() and measures, for every
+ * event, the time from the matrix change to the first report that shows it.
+ * The latency bounds are asserted, the host CPU time per keyboard_task() is
+ * only printed as it depends on the machine running the tests.
+ */
+
+struct TraceEvent {
+    uint32_t time;  // ms since the start of the trace
+    uint8_t  col;
+    uint8_t  row;
+    bool     pressed;
+    uint8_t  key;          // report key or modifier the event shows up as, KC_NO to not measure it
+    uint32_t max_latency;  // ms
+};
+
+struct TraceResult {
+    std::vector<uint32_t> latency;
+    size_t                reports;
+};
+
+class Benchmark : public TestFixture {
+   protected:
+    TraceResult replay(const char* name, const std::vector<TraceEvent>& trace);
+};
+
+static bool report_has_key(const report_keyboard_t& report, uint8_t key) {
+    if (IS_MOD(key)) {
+        return report.mods & MOD_BIT(key);
+    }
+    for (int i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report.keys[i] == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TraceResult Benchmark::replay(const char* name, const std::vector<TraceEvent>& trace) {
+    struct timed_report_t {
+        uint32_t          time;
+        report_keyboard_t report;
+    };
+    std::vector<timed_report_t> reports;
+    TestDriver                  driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).WillRepeatedly(Invoke([&](report_keyboard_t& report) { reports.push_back({timer_read32(), report}); }));
+
+    const uint32_t           start = timer_read32();
+    const uint32_t           end   = trace.back().time + TAPPING_TERM + 10;
+    std::chrono::nanoseconds cpu_time(0);
+    size_t                   next = 0;
+    for (uint32_t t = 0; t < end; t++) {
+        for (; next < trace.size() && trace[next].time == t; next++) {
+            if (trace[next].pressed) {
+                press_key(trace[next].col, trace[next].row);
+            } else {
+                release_key(trace[next].col, trace[next].row);
+            }
+        }
+        auto before = std::chrono::steady_clock::now();
+        keyboard_task();
+        cpu_time += std::chrono::steady_clock::now() - before;
+        advance_time(1);
+    }
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    TraceResult result;
+    result.reports = reports.size();
+    uint32_t max_latency = 0, total_latency = 0, measured = 0;
+    for (const TraceEvent& event : trace) {
+        if (event.key == KC_NO) {
+            result.latency.push_back(0);
+            continue;
+        }
+        uint32_t latency = UINT32_MAX;
+        for (const timed_report_t& report : reports) {
+            if (report.time >= start + event.time && report_has_key(report.report, event.key) == event.pressed) {
+                latency = report.time - start - event.time;
+                break;
+            }
+        }
+        EXPECT_LE(latency, event.max_latency) << name << ": key " << (int)event.key << (event.pressed ? " press" : " release") << " at " << event.time << " ms";
+        result.latency.push_back(latency);
+        if (latency != UINT32_MAX) {
+            max_latency = latency > max_latency ? latency : max_latency;
+            total_latency += latency;
+            measured++;
+        }
+    }
+
+    printf("[ BENCH    ] %-16s %3zu events %3zu reports, latency max %3u ms mean %6.2f ms, %6.0f ns per keyboard_task\n", name, trace.size(), result.reports, max_latency, measured ? (double)total_latency / measured : 0.0, (double)cpu_time.count() / end);
+    return result;
+}
+
+TEST_F(Benchmark, Rolls) {
+    // Each key is pressed before the previous one is released
+    static const uint8_t    keys[] = {KC_A, KC_S, KC_D, KC_F, KC_G, KC_H, KC_J, KC_K, KC_L, KC_SCLN};
+    std::vector<TraceEvent> trace;
+    for (uint8_t i = 0; i < 10; i++) {
+        trace.push_back({i * 30u, i, 0, true, keys[i], 0});
+        trace.push_back({i * 30u + 45, i, 0, false, keys[i], 0});
+    }
+    std::stable_sort(trace.begin(), trace.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.time < b.time; });
+    TraceResult result = replay("rolls", trace);
+    EXPECT_EQ(result.reports, trace.size());
+}
+
+TEST_F(Benchmark, Chords) {
+    // Groups of keys that change in the same scan
+    std::vector<TraceEvent> trace = {
+        {0, 0, 0, true, KC_A, 0},      {0, 1, 0, true, KC_S, 0},      {0, 2, 0, true, KC_D, 0},      {0, 3, 0, true, KC_F, 0},
+        {60, 0, 0, false, KC_A, 0},    {60, 1, 0, false, KC_S, 0},    {60, 2, 0, false, KC_D, 0},    {60, 3, 0, false, KC_F, 0},
+        {100, 6, 0, true, KC_J, 0},    {100, 7, 0, true, KC_K, 0},    {100, 8, 0, true, KC_L, 0},    {140, 6, 0, false, KC_J, 0},
+        {140, 7, 0, false, KC_K, 0},   {140, 8, 0, false, KC_L, 0},
+    };
+    TraceResult result = replay("chords", trace);
+    EXPECT_LE(result.reports, trace.size());
+}
+
+TEST_F(Benchmark, TapHoldBursts) {
+    std::vector<TraceEvent> trace = {
+        // Quick taps resolve on release
+        {0, 0, 1, true, KC_Z, 40},
+        {40, 0, 1, false, KC_Z, 0},
+        {80, 1, 1, true, KC_X, 30},
+        {110, 1, 1, false, KC_X, 0},
+        // Holds resolve once the tapping term has passed
+        {300, 0, 1, true, KC_LSFT, TAPPING_TERM},
+        {560, 1, 0, true, KC_S, 0},
+        {600, 1, 0, false, KC_S, 0},
+        {620, 0, 1, false, KC_LSFT, 0},
+        {700, 1, 1, true, KC_LCTL, TAPPING_TERM},
+        {950, 1, 1, false, KC_LCTL, 0},
+        // A mod-tap interrupted by a plain key turns into the modifier once it is released,
+        // the plain key is only let through when the tapping term runs out
+        {1200, 0, 1, true, KC_LSFT, 30},
+        {1220, 0, 0, true, KC_A, TAPPING_TERM},
+        {1230, 0, 1, false, KC_LSFT, TAPPING_TERM},
+        {1250, 0, 0, false, KC_A, TAPPING_TERM},
+    };
+    replay("tap-hold", trace);
+}
+
+TEST_F(Benchmark, Combos) {
+    std::vector<TraceEvent> trace = {
+        // Both combo keys inside the combo term
+        {0, 0, 2, true, KC_NO, 0},
+        {10, 1, 2, true, KC_ESC, 0},
+        {60, 0, 2, false, KC_ESC, 0},
+        {70, 1, 2, false, KC_NO, 0},
+        // A lone combo key is held back until the scan after the combo term runs out
+        {200, 0, 2, true, KC_Q, COMBO_TERM + 1},
+        {300, 0, 2, false, KC_Q, 0},
+        // A combo key followed by a key outside of the combo
+        {400, 1, 2, true, KC_W, 10},
+        {410, 2, 2, true, KC_E, 0},
+        {430, 1, 2, false, KC_W, 0},
+        {440, 2, 2, false, KC_E, 0},
+        // Keys of two different combos can't become either, so both go through right away
+        {600, 0, 2, true, KC_Q, 10},
+        {610, 0, 3, true, KC_R, 0},
+        {630, 0, 2, false, KC_Q, 0},
+        {640, 0, 3, false, KC_R, 0},
+    };
+    replay("combos", trace);
+}
@@ -0,0 +1,25 @@
+# Copyright 2021 QMK
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+CUSTOM_MATRIX = yes
+
+# Replays against tests/replay/keymap.c unless given another keymap, for example
+# make test:replay REPLAY_KEYMAP=path/to/keymap.c REPLAY_MATRIX_ROWS=6 REPLAY_MATRIX_COLS=17
+REPLAY_MATRIX_ROWS ?= 5
+REPLAY_MATRIX_COLS ?= 15
+OPT_DEFS += -DMATRIX_ROWS=$(REPLAY_MATRIX_ROWS) -DMATRIX_COLS=$(REPLAY_MATRIX_COLS)
+ifneq ($(strip $(REPLAY_KEYMAP)),)
+    OPT_DEFS += -DREPLAY_KEYMAP=\"$(abspath $(REPLAY_KEYMAP))\"
+endif
@@ -0,0 +1,174 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test_common.hpp"
+
+extern "C" {
+void advance_time(uint32_t ms);
+}
+
+using testing::_;
+using testing::Invoke;
+
+/*
+ * Replays a capture of key events through keyboard_task(), one scan per
+ * millisecond, and compares the keyboard reports it sends, with the time each
+ * went out, to the ones a previous build sent. Captures come from the event
+ * trace of a real keyboard, see `qmk decode-trace --capture`.
+ *
+ *   REPLAY_CAPTURE   capture to replay, capture.txt when not set
+ *   REPLAY_EXPECTED  reports to compare against, replay_reports.txt for capture.txt
+ *   REPLAY_OUTPUT    file to write the reports of this build to
+ */
+
+#define REPLAY_DEFAULT_CAPTURE "tests/replay/capture.txt"
+#define REPLAY_DEFAULT_EXPECTED "tests/replay/replay_reports.txt"
+
+struct CaptureEvent {
+    uint32_t time;  // ms since the start of the capture
+    uint8_t  row;
+    uint8_t  col;
+    bool     pressed;
+};
+
+// Lines without '#' comments and blank lines
+static bool read_lines(const char* path, std::vector<std::string>& lines) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") != std::string::npos) {
+            lines.push_back(line.substr(0, line.find_last_not_of(" \t\r") + 1));
+        }
+    }
+    return true;
+}
+
+static bool parse_capture(const std::vector<std::string>& lines, std::vector<CaptureEvent>& events) {
+    for (const std::string& line : lines) {
+        std::istringstream in(line);
+        unsigned           time, row, col;
+        std::string        state;
+        if (!(in >> time >> row >> col >> state) || (state != "down" && state != "up")) {
+            ADD_FAILURE() << "not a capture line: " << line;
+            return false;
+        }
+        if (row >= MATRIX_ROWS || col >= MATRIX_COLS) {
+            ADD_FAILURE() << "key outside of the " << MATRIX_ROWS << "x" << MATRIX_COLS << " matrix: " << line;
+            return false;
+        }
+        if (!events.empty() && time < events.back().time) {
+            ADD_FAILURE() << "capture goes back in time: " << line;
+            return false;
+        }
+        events.push_back({time, (uint8_t)row, (uint8_t)col, state == "down"});
+    }
+    return true;
+}
+
+static std::string format_report(uint32_t time, const report_keyboard_t& report) {
+    char text[64];
+    int  length = snprintf(text, sizeof(text), "%u mods 0x%02X keys", time, report.mods);
+    bool empty  = true;
+    for (int i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report.keys[i]) {
+            length += snprintf(text + length, sizeof(text) - length, " 0x%02X", report.keys[i]);
+            empty = false;
+        }
+    }
+    if (empty) {
+        snprintf(text + length, sizeof(text) - length, " -");
+    }
+    return text;
+}
+
+class Replay : public TestFixture {};
+
+TEST_F(Replay, Capture) {
+    const char* capture  = getenv("REPLAY_CAPTURE");
+    const char* expected = getenv("REPLAY_EXPECTED");
+    const char* output   = getenv("REPLAY_OUTPUT");
+    if (!capture) {
+        capture = REPLAY_DEFAULT_CAPTURE;
+        if (!expected) {
+            expected = REPLAY_DEFAULT_EXPECTED;
+        }
+    }
+
+    std::vector<std::string>  lines;
+    std::vector<CaptureEvent> events;
+    ASSERT_TRUE(read_lines(capture, lines)) << "can't read " << capture;
+    ASSERT_TRUE(parse_capture(lines, events));
+    ASSERT_FALSE(events.empty()) << capture << " has no events";
+
+    std::vector<std::string> reports;
+    TestDriver               driver;
+    const uint32_t           start = timer_read32();
+    EXPECT_CALL(driver, send_keyboard_mock(_)).WillRepeatedly(Invoke([&](report_keyboard_t& report) { reports.push_back(format_report(timer_read32() - start, report)); }));
+
+    const uint32_t           end = events.back().time + REPLAY_SETTLE_TIME;
+    std::chrono::nanoseconds cpu_time(0);
+    size_t                   next = 0;
+    for (uint32_t t = 0; t < end; t++) {
+        for (; next < events.size() && events[next].time == t; next++) {
+            if (events[next].pressed) {
+                press_key(events[next].col, events[next].row);
+            } else {
+                release_key(events[next].col, events[next].row);
+            }
+        }
+        auto before = std::chrono::steady_clock::now();
+        keyboard_task();
+        cpu_time += std::chrono::steady_clock::now() - before;
+        advance_time(1);
+    }
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    if (output) {
+        std::ofstream file(output);
+        for (const std::string& report : reports) {
+            file << report << '\n';
+        }
+        EXPECT_TRUE(file.good()) << "can't write " << output;
+    }
+
+    if (expected) {
+        std::vector<std::string> previous;
+        ASSERT_TRUE(read_lines(expected, previous)) << "can't read " << expected;
+        for (size_t i = 0; i < reports.size() || i < previous.size(); i++) {
+            const std::string got  = i < reports.size() ? reports[i] : "(no report)";
+            const std::string want = i < previous.size() ? previous[i] : "(no report)";
+            if (got != want) {
+                ADD_FAILURE() << "report " << i + 1 << " differs from " << expected << "\n  expected: " << want << "\n  actual:   " << got;
+                break;
+            }
+        }
+    }
+
+    printf("[ REPLAY   ] %s: %zu events, %zu reports, %.0f ns per keyboard_task\n", capture, events.size(), reports.size(), (double)cpu_time.count() / end);
+}
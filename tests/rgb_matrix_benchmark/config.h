@@ -0,0 +1,34 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#define MATRIX_ROWS 6
+#define MATRIX_COLS 21
+
+// The LEDs are laid out in MATRIX_ROWS rows, one per key, see keymap.c
+#define DRIVER_LED_TOTAL RGB_MATRIX_BENCHMARK_LEDS
+#if DRIVER_LED_TOTAL > MATRIX_ROWS * MATRIX_COLS
+#    error "RGB_MATRIX_BENCHMARK_LEDS can't be larger than MATRIX_ROWS * MATRIX_COLS"
+#endif
+
+#define RGB_MATRIX_KEYPRESSES
+#define RGB_MATRIX_FRAMEBUFFER_EFFECTS
+#define RGB_MATRIX_DIRECT_ENABLE
+#define RGB_MATRIX_DIRECT_TIMEOUT 100
+#define RGB_MATRIX_EFFECT_LAYERS 2
+#define RGB_MATRIX_OUTPUT_LUT
@@ -0,0 +1,68 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "quantum.h"
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {{KC_NO}},
+};
+
+// Filled in by keyboard_post_init_user(), rows of equal length spread over the whole 224x64 area
+led_config_t g_led_config;
+
+// Every LED an effect wrote since the test last cleared it
+bool rgb_benchmark_written[DRIVER_LED_TOTAL];
+RGB  rgb_benchmark_color[DRIVER_LED_TOTAL];
+
+static void benchmark_init(void) {}
+static void benchmark_flush(void) {}
+static void benchmark_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+    rgb_benchmark_written[index] = true;
+    rgb_benchmark_color[index].r = red;
+    rgb_benchmark_color[index].g = green;
+    rgb_benchmark_color[index].b = blue;
+}
+static void benchmark_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        benchmark_set_color(i, red, green, blue);
+    }
+}
+
+const rgb_matrix_driver_t rgb_matrix_driver = {
+    .init          = benchmark_init,
+    .flush         = benchmark_flush,
+    .set_color     = benchmark_set_color,
+    .set_color_all = benchmark_set_color_all,
+};
+
+void keyboard_post_init_user(void) {
+    const uint8_t cols = (DRIVER_LED_TOTAL + MATRIX_ROWS - 1) / MATRIX_ROWS;
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            g_led_config.matrix_co[row][col] = NO_LED;
+        }
+    }
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        uint8_t row                      = i / cols;
+        uint8_t col                      = i % cols;
+        g_led_config.matrix_co[row][col] = i;
+        g_led_config.point[i].x          = cols > 1 ? col * 224 / (cols - 1) : 112;
+        g_led_config.point[i].y          = row * 64 / (MATRIX_ROWS - 1);
+        // The outer columns are modifiers, so ALPHAS_MODS has both kinds
+        g_led_config.flags[i] = col == 0 || col == cols - 1 ? LED_FLAG_MODIFIER : LED_FLAG_KEYLIGHT;
+    }
+}
@@ -0,0 +1,26 @@
+# Copyright 2021 QMK
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+CUSTOM_MATRIX = yes
+RGB_MATRIX_ENABLE = yes
+RGB_MATRIX_DRIVER = custom
+
+# RGB_MATRIX_BENCHMARK_ENABLE would also turn on the console, which the tests don't build with
+TASK_PROFILE_COUNTER = yes
+OPT_DEFS += -DRGB_MATRIX_BENCHMARK
+
+# The number of LEDs is fixed at build time, e.g. make test:rgb_matrix_benchmark RGB_MATRIX_BENCHMARK_LEDS=120
+RGB_MATRIX_BENCHMARK_LEDS ?= 87
+OPT_DEFS += -DRGB_MATRIX_BENCHMARK_LEDS=$(RGB_MATRIX_BENCHMARK_LEDS)
@@ -0,0 +1,165 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "rgb_matrix.h"
+extern bool rgb_benchmark_written[DRIVER_LED_TOTAL];
+extern RGB  rgb_benchmark_color[DRIVER_LED_TOTAL];
+}
+
+/*
+ * Renders every effect for a number of frames on the host and prints the
+ * time each frame took. The times depend on the machine running the tests
+ * and are not checked, only that every effect draws every LED.
+ */
+
+#define BENCHMARK_FRAMES 200
+
+static const struct {
+    uint8_t     mode;
+    const char* name;
+} effects[] = {
+#define RGB_MATRIX_EFFECT(name, ...) {RGB_MATRIX_##name, #name},
+#include "rgb_matrix_animations/rgb_matrix_effects.inc"
+#undef RGB_MATRIX_EFFECT
+};
+
+class RgbMatrixBenchmark : public TestFixture {
+   protected:
+    void SetUp() override {
+        rgb_matrix_sethsv_noeeprom(0, 255, 255);
+        rgb_matrix_set_speed_noeeprom(128);
+        rgb_matrix_set_flags(LED_FLAG_ALL);
+    }
+};
+
+TEST_F(RgbMatrixBenchmark, EveryEffect) {
+    printf("[ RGB      ] %u leds, %u frames per effect\n", DRIVER_LED_TOTAL, BENCHMARK_FRAMES);
+    for (auto& effect : effects) {
+        std::fill(rgb_benchmark_written, rgb_benchmark_written + DRIVER_LED_TOTAL, false);
+        std::chrono::nanoseconds total(0), max(0);
+        for (uint16_t frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+            auto start = std::chrono::steady_clock::now();
+            rgb_matrix_benchmark_frame(effect.mode, frame);
+            auto time = std::chrono::steady_clock::now() - start;
+            total += time;
+            max = std::max(max, std::chrono::duration_cast<std::chrono::nanoseconds>(time));
+        }
+        EXPECT_EQ(std::count(rgb_benchmark_written, rgb_benchmark_written + DRIVER_LED_TOTAL, true), DRIVER_LED_TOTAL) << effect.name;
+        printf("[ RGB      ] %-28s %8.2f us mean %8.2f us max per frame\n", effect.name, total.count() / 1000.0 / BENCHMARK_FRAMES, max.count() / 1000.0);
+    }
+}
+
+TEST_F(RgbMatrixBenchmark, DeviceRunner) {
+    TestDriver driver;
+    // The host has no cycle counter, this only makes sure the runner goes through every effect
+    // and hands the LEDs back to the configured effect afterwards
+    rgb_matrix_benchmark(2);
+    std::fill(rgb_benchmark_written, rgb_benchmark_written + DRIVER_LED_TOTAL, false);
+    idle_for(RGB_MATRIX_LED_FLUSH_LIMIT * 4);
+    EXPECT_EQ(std::count(rgb_benchmark_written, rgb_benchmark_written + DRIVER_LED_TOTAL, true), DRIVER_LED_TOTAL);
+}
+
+TEST_F(RgbMatrixBenchmark, DirectFrames) {
+    TestDriver    driver;
+    const uint8_t mode = rgb_matrix_get_mode();
+
+    // Written to the back buffer, shown once committed
+    const uint8_t full[] = {0, 2, 2, 10, 20, 30, 40, 50, 60};
+    EXPECT_TRUE(rgb_matrix_direct_receive(full, sizeof(full)));
+    EXPECT_EQ(rgb_matrix_get_mode(), RGB_MATRIX_DIRECT);
+    rgb_matrix_direct_present();
+    EXPECT_EQ(g_rgb_direct_frame[2].r, 0);
+    const uint8_t commit[] = {RGB_MATRIX_DIRECT_COMMIT, 0, 0};
+    EXPECT_TRUE(rgb_matrix_direct_receive(commit, sizeof(commit)));
+    rgb_matrix_direct_present();
+    EXPECT_EQ(g_rgb_direct_frame[2].r, 10);
+    EXPECT_EQ(g_rgb_direct_frame[3].b, 60);
+
+    // Three leds set, the two after them kept
+    const uint8_t delta[] = {RGB_MATRIX_DIRECT_RLE | RGB_MATRIX_DIRECT_COMMIT, 0, 5, 3, 7, 8, 9, 0x82};
+    EXPECT_TRUE(rgb_matrix_direct_receive(delta, sizeof(delta)));
+    rgb_matrix_direct_present();
+    EXPECT_EQ(g_rgb_direct_frame[0].r, 7);
+    EXPECT_EQ(g_rgb_direct_frame[2].b, 9);
+    EXPECT_EQ(g_rgb_direct_frame[3].r, 40);
+    EXPECT_EQ(g_rgb_direct_frame[4].r, 0);
+
+    const uint8_t past_end[] = {0, DRIVER_LED_TOTAL - 1, 2, 1, 2, 3, 4, 5, 6};
+    EXPECT_FALSE(rgb_matrix_direct_receive(past_end, sizeof(past_end)));
+    const uint8_t short_run[] = {RGB_MATRIX_DIRECT_RLE, 0, 4, 3, 1, 2, 3};
+    EXPECT_FALSE(rgb_matrix_direct_receive(short_run, sizeof(short_run)));
+
+    // The effect from before comes back once the host goes quiet
+    idle_for(RGB_MATRIX_DIRECT_TIMEOUT + RGB_MATRIX_LED_FLUSH_LIMIT);
+    EXPECT_EQ(rgb_matrix_get_mode(), mode);
+}
+
+TEST_F(RgbMatrixBenchmark, EffectLayers) {
+    // A blue base, with a half transparent red layer over the second led only
+    static const uint8_t mask[(DRIVER_LED_TOTAL + 7) / 8] = {0x02};
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        g_rgb_direct_frame[i].r = 0;
+        g_rgb_direct_frame[i].g = 0;
+        g_rgb_direct_frame[i].b = 200;
+    }
+    rgb_matrix_effect_layer_set(0, RGB_MATRIX_SOLID_COLOR, 128, mask);
+    rgb_matrix_benchmark_frame(RGB_MATRIX_DIRECT, 1);
+    EXPECT_EQ(rgb_benchmark_color[0].r, 0);
+    EXPECT_EQ(rgb_benchmark_color[0].b, 200);
+    EXPECT_NEAR(rgb_benchmark_color[1].r, 128, 1);
+    EXPECT_NEAR(rgb_benchmark_color[1].b, 100, 1);
+    EXPECT_EQ(rgb_benchmark_color[2].b, 200);
+
+    // A black layer leaves every led as it is
+    rgb_matrix_sethsv_noeeprom(0, 255, 0);
+    rgb_matrix_effect_layer_set(0, RGB_MATRIX_SOLID_COLOR, 255, NULL);
+    rgb_matrix_benchmark_frame(RGB_MATRIX_DIRECT, 2);
+    EXPECT_EQ(rgb_benchmark_color[1].r, 0);
+    EXPECT_EQ(rgb_benchmark_color[1].b, 200);
+
+    rgb_matrix_effect_layer_set(0, RGB_MATRIX_NONE, 0, NULL);
+    rgb_matrix_benchmark_frame(RGB_MATRIX_DIRECT, 3);
+    EXPECT_EQ(rgb_benchmark_color[1].b, 200);
+}
+
+TEST_F(RgbMatrixBenchmark, OutputLut) {
+    const rgb_matrix_output_t identity = *rgb_matrix_get_output();
+
+    // Without correction, colors reach the driver unchanged
+    rgb_matrix_set_color(0, 1, 128, 255);
+    EXPECT_EQ(rgb_benchmark_color[0].r, 1);
+    EXPECT_EQ(rgb_benchmark_color[0].g, 128);
+    EXPECT_EQ(rgb_benchmark_color[0].b, 255);
+
+    const rgb_matrix_output_t corrected = {.gamma = 20, .limit = 200, .white_balance = {255, 255, 128}};
+    rgb_matrix_set_output(&corrected);
+    rgb_matrix_set_color(0, 255, 128, 255);
+    EXPECT_EQ(rgb_benchmark_color[0].r, 200);
+    EXPECT_NEAR(rgb_benchmark_color[0].g, 50, 1);
+    EXPECT_NEAR(rgb_benchmark_color[0].b, 100, 1);
+    rgb_matrix_set_color_all(0, 0, 0);
+    EXPECT_EQ(rgb_benchmark_color[DRIVER_LED_TOTAL - 1].r, 0);
+
+    rgb_matrix_set_output(&identity);
+}
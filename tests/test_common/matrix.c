@@ -19,6 +19,7 @@
 #include <string.h>
 
 static matrix_row_t matrix[MATRIX_ROWS] = {};
+static uint8_t      changed_rows[MATRIX_ROW_BITMAP_SIZE] = {};
 
 void matrix_init(void) {
     clear_all_keys();
@@ -32,16 +33,35 @@ uint8_t matrix_scan(void) {
 
 matrix_row_t matrix_get_row(uint8_t row) { return matrix[row]; }
 
+bool matrix_take_changed_rows(uint8_t rows[]) {
+    bool changed = false;
+    for (uint8_t i = 0; i < MATRIX_ROW_BITMAP_SIZE; i++) {
+        changed |= changed_rows[i] != 0;
+        rows[i] |= changed_rows[i];
+        changed_rows[i] = 0;
+    }
+    return changed;
+}
+
 void matrix_print(void) {}
 
 void matrix_init_kb(void) {}
 
 void matrix_scan_kb(void) {}
 
-void press_key(uint8_t col, uint8_t row) { matrix[row] |= 1 << col; }
+void press_key(uint8_t col, uint8_t row) {
+    matrix[row] |= 1 << col;
+    changed_rows[row / 8] |= 1 << (row % 8);
+}
 
-void release_key(uint8_t col, uint8_t row) { matrix[row] &= ~(1 << col); }
+void release_key(uint8_t col, uint8_t row) {
+    matrix[row] &= ~(1 << col);
+    changed_rows[row / 8] |= 1 << (row % 8);
+}
 
-void clear_all_keys(void) { memset(matrix, 0, sizeof(matrix)); }
+void clear_all_keys(void) {
+    memset(matrix, 0, sizeof(matrix));
+    memset(changed_rows, 0xFF, sizeof(changed_rows));
+}
 
 void led_set(uint8_t usb_led) {}
@@ -8,6 +8,8 @@ TMK_COMMON_SRC +=	$(COMMON_DIR)/host.c \
 	$(COMMON_DIR)/action_macro.c \
 	$(COMMON_DIR)/action_layer.c \
 	$(COMMON_DIR)/action_util.c \
+	$(COMMON_DIR)/deferred_exec.c \
+	$(COMMON_DIR)/event_bus.c \
 	$(COMMON_DIR)/debug.c \
 	$(COMMON_DIR)/sendchar_null.c \
 	$(COMMON_DIR)/eeconfig.c \
@@ -73,6 +75,53 @@ ifeq ($(strip $(RAW_ENABLE)), yes)
     TMK_COMMON_DEFS += -DRAW_ENABLE
 endif
 
+ifeq ($(strip $(VIRTSER_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/virtser.c
+endif
+
+ifeq ($(strip $(KEYBOARD_TASK_PROFILE_ENABLE)), yes)
+    TMK_COMMON_DEFS += -DKEYBOARD_TASK_PROFILE
+    TASK_PROFILE_COUNTER = yes
+    CONSOLE_ENABLE = yes
+else ifeq ($(strip $(KEYBOARD_TASK_PROFILE_ENABLE)), api)
+    TMK_COMMON_DEFS += -DKEYBOARD_TASK_PROFILE
+    TASK_PROFILE_COUNTER = yes
+endif
+
+ifeq ($(strip $(LATENCY_PROBE_ENABLE)), yes)
+    TMK_COMMON_DEFS += -DLATENCY_PROBE
+    TMK_COMMON_SRC += $(COMMON_DIR)/latency_probe.c
+    TASK_PROFILE_COUNTER = yes
+    CONSOLE_ENABLE = yes
+else ifeq ($(strip $(LATENCY_PROBE_ENABLE)), api)
+    TMK_COMMON_DEFS += -DLATENCY_PROBE
+    TMK_COMMON_SRC += $(COMMON_DIR)/latency_probe.c
+    TASK_PROFILE_COUNTER = yes
+endif
+
+ifeq ($(strip $(EVENT_TRACE_ENABLE)), yes)
+    TMK_COMMON_DEFS += -DEVENT_TRACE
+    TMK_COMMON_SRC += $(COMMON_DIR)/event_trace.c
+    CONSOLE_ENABLE = yes
+else ifeq ($(strip $(EVENT_TRACE_ENABLE)), api)
+    TMK_COMMON_DEFS += -DEVENT_TRACE
+    TMK_COMMON_SRC += $(COMMON_DIR)/event_trace.c
+endif
+
+ifeq ($(strip $(STACK_WATERMARK_ENABLE)), yes)
+    TMK_COMMON_DEFS += -DSTACK_WATERMARK
+    TMK_COMMON_SRC += $(COMMON_DIR)/stack_watermark.c
+    CONSOLE_ENABLE = yes
+else ifeq ($(strip $(STACK_WATERMARK_ENABLE)), api)
+    TMK_COMMON_DEFS += -DSTACK_WATERMARK
+    TMK_COMMON_SRC += $(COMMON_DIR)/stack_watermark.c
+endif
+
+ifeq ($(strip $(TASK_PROFILE_COUNTER)), yes)
+    TMK_COMMON_DEFS += -DTASK_PROFILE_COUNTER
+    TMK_COMMON_SRC += $(COMMON_DIR)/task_profile.c
+endif
+
 ifeq ($(strip $(CONSOLE_ENABLE)), yes)
     TMK_COMMON_DEFS += -DCONSOLE_ENABLE
 else
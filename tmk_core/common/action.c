@@ -26,6 +26,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_util.h"
 #include "action.h"
 #include "wait.h"
+#include "timer.h"
+#include "event_trace.h"
 
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
@@ -55,22 +57,20 @@ __attribute__((weak)) bool get_ignore_mod_tap_interrupt(uint16_t keycode, keyrec
 __attribute__((weak)) bool get_retro_tapping(uint16_t keycode, keyrecord_t *record) { return false; }
 #endif
 
-#ifndef TAP_CODE_DELAY
-#    define TAP_CODE_DELAY 0
-#endif
-#ifndef TAP_HOLD_CAPS_DELAY
-#    define TAP_HOLD_CAPS_DELAY 80
-#endif
 /** \brief Called to execute an action.
  *
  * FIXME: Needs documentation.
  */
 void action_exec(keyevent_t event) {
     if (!IS_NOEVENT(event)) {
+        // finish the taps still waiting for their release first, so that
+        // this event sees the same state as if they had been blocking
+        deferred_release_flush();
         dprint("\n---- action_exec: start -----\n");
         dprint("EVENT: ");
         debug_event(event);
         dprintln();
+        event_trace(EVENT_TRACE_KEY, event.key.row, event.key.col | event.pressed << 8, event.time);
 #if defined(RETRO_TAPPING) || defined(RETRO_TAPPING_PER_KEY)
         retro_tapping_counter++;
 #endif
@@ -91,14 +91,16 @@ void action_exec(keyevent_t event) {
 
 #ifndef NO_ACTION_ONESHOT
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-    if (has_oneshot_layer_timed_out()) {
+    // The timeouts are deferred callbacks, checking here only makes sure an
+    // event in the same pass as the timeout doesn't see stale oneshot state.
+    if (!IS_NOEVENT(event) && has_oneshot_layer_timed_out()) {
         clear_oneshot_layer_state(ONESHOT_OTHER_KEY_PRESSED);
     }
-    if (has_oneshot_mods_timed_out()) {
+    if (!IS_NOEVENT(event) && has_oneshot_mods_timed_out()) {
         clear_oneshot_mods();
     }
 #        ifdef SWAP_HANDS_ENABLE
-    if (has_oneshot_swaphands_timed_out()) {
+    if (!IS_NOEVENT(event) && has_oneshot_swaphands_timed_out()) {
         clear_oneshot_swaphands();
     }
 #        endif
@@ -113,6 +115,7 @@ void action_exec(keyevent_t event) {
         dprint("processed: ");
         debug_record(record);
         dprintln();
+        event_trace(EVENT_TRACE_RECORD, record.event.key.row, record.event.key.col | record.event.pressed << 8, 0);
     }
 #endif
 }
@@ -206,6 +209,7 @@ void process_record(keyrecord_t *record) {
 
 void process_record_handler(keyrecord_t *record) {
     action_t action = store_or_get_action(record->event.pressed, record->event.key);
+    event_trace(EVENT_TRACE_ACTION, action.kind.id, action.code, record->event.key.row << 8 | record->event.key.col);
     dprint("ACTION: ");
     debug_action(action);
 #ifndef NO_ACTION_LAYER
@@ -369,12 +373,7 @@ void process_action(keyrecord_t *record, action_t action) {
                     } else {
                         if (tap_count > 0) {
                             dprint("MODS_TAP: Tap: unregister_code\n");
-                            if (action.layer_tap.code == KC_CAPS) {
-                                wait_ms(TAP_HOLD_CAPS_DELAY);
-                            } else {
-                                wait_ms(TAP_CODE_DELAY);
-                            }
-                            unregister_code(action.key.code);
+                            unregister_code_deferred(action.key.code, 0, 0, action.layer_tap.code == KC_CAPS ? TAP_HOLD_CAPS_DELAY : TAP_CODE_DELAY);
                         } else {
                             dprint("MODS_TAP: No tap: add_mods\n");
                             unregister_mods(mods);
@@ -560,12 +559,7 @@ void process_action(keyrecord_t *record, action_t action) {
                     } else {
                         if (tap_count > 0) {
                             dprint("KEYMAP_TAP_KEY: Tap: unregister_code\n");
-                            if (action.layer_tap.code == KC_CAPS) {
-                                wait_ms(TAP_HOLD_CAPS_DELAY);
-                            } else {
-                                wait_ms(TAP_CODE_DELAY);
-                            }
-                            unregister_code(action.layer_tap.code);
+                            unregister_code_deferred(action.layer_tap.code, 0, 0, action.layer_tap.code == KC_CAPS ? TAP_HOLD_CAPS_DELAY : TAP_CODE_DELAY);
                         } else {
                             dprint("KEYMAP_TAP_KEY: No tap: Off on release\n");
                             layer_off(action.layer_tap.val);
@@ -642,8 +636,7 @@ void process_action(keyrecord_t *record, action_t action) {
                         if (event.pressed) {
                             register_code(action.swap.code);
                         } else {
-                            wait_ms(TAP_CODE_DELAY);
-                            unregister_code(action.swap.code);
+                            unregister_code_deferred(action.swap.code, 0, 0, TAP_CODE_DELAY);
                             *record = (keyrecord_t){};  // hack: reset tap mode
                         }
                     } else {
@@ -733,6 +726,7 @@ void process_action(keyrecord_t *record, action_t action) {
  * FIXME: Needs documentation.
  */
 void register_code(uint8_t code) {
+    deferred_release_flush();
     if (code == KC_NO) {
         return;
     }
@@ -895,10 +889,7 @@ void unregister_code(uint8_t code) {
  */
 void tap_code_delay(uint8_t code, uint16_t delay) {
     register_code(code);
-    for (uint16_t i = delay; i > 0; i--) {
-        wait_ms(1);
-    }
-    unregister_code(code);
+    unregister_code_deferred(code, 0, 0, delay);
 }
 
 /** \brief Tap a keycode with the default delay.
@@ -907,6 +898,85 @@ void tap_code_delay(uint8_t code, uint16_t delay) {
  */
 void tap_code(uint8_t code) { tap_code_delay(code, code == KC_CAPS ? TAP_HOLD_CAPS_DELAY : TAP_CODE_DELAY); }
 
+#ifndef DEFERRED_RELEASE_SIZE
+#    define DEFERRED_RELEASE_SIZE 4
+#endif
+
+/* Releases of synthesized taps, in the order they were scheduled. */
+static struct {
+    uint16_t time;
+    uint16_t delay;
+    uint8_t  code;
+    uint8_t  mods;
+    uint8_t  weak_mods;
+} deferred_releases[DEFERRED_RELEASE_SIZE];
+static uint8_t deferred_release_head  = 0;
+static uint8_t deferred_release_count = 0;
+
+static void deferred_release(uint8_t code, uint8_t mods, uint8_t weak_mods) {
+    unregister_code(code);
+    unregister_mods(mods);
+    unregister_weak_mods(weak_mods);
+}
+
+/** \brief Waits for the oldest deferred release to become due and performs it.
+ */
+static void deferred_release_pop(void) {
+    uint8_t i = deferred_release_head;
+
+    while (timer_elapsed(deferred_releases[i].time) < deferred_releases[i].delay) {
+        wait_ms(1);
+    }
+    deferred_release_head = (i + 1) % DEFERRED_RELEASE_SIZE;
+    deferred_release_count--;
+    deferred_release(deferred_releases[i].code, deferred_releases[i].mods, deferred_releases[i].weak_mods);
+}
+
+/** \brief Unregisters a keycode and modifiers once a delay has passed, without blocking.
+ *
+ * The release is performed by `deferred_release_task()`, or earlier by `deferred_release_flush()` when a new key
+ * event or keycode registration must not overtake it.
+ *
+ * \param code The basic keycode to unregister.
+ * \param mods The physically pressed modifiers to unregister along with it.
+ * \param weak_mods The weak modifiers to unregister along with it.
+ * \param delay The amount of time in milliseconds to leave the keycode registered.
+ */
+void unregister_code_deferred(uint8_t code, uint8_t mods, uint8_t weak_mods, uint16_t delay) {
+    if (delay == 0) {
+        deferred_release(code, mods, weak_mods);
+        return;
+    }
+    if (deferred_release_count == DEFERRED_RELEASE_SIZE) {
+        deferred_release_pop();
+    }
+
+    uint8_t i = (deferred_release_head + deferred_release_count) % DEFERRED_RELEASE_SIZE;
+
+    deferred_releases[i].time      = timer_read();
+    deferred_releases[i].delay     = delay;
+    deferred_releases[i].code      = code;
+    deferred_releases[i].mods      = mods;
+    deferred_releases[i].weak_mods = weak_mods;
+    deferred_release_count++;
+}
+
+/** \brief Performs all pending deferred releases, waiting out what is left of their delay.
+ */
+void deferred_release_flush(void) {
+    while (deferred_release_count) {
+        deferred_release_pop();
+    }
+}
+
+/** \brief Performs the deferred releases that are due. Called from the main loop.
+ */
+void deferred_release_task(void) {
+    while (deferred_release_count && timer_elapsed(deferred_releases[deferred_release_head].time) >= deferred_releases[deferred_release_head].delay) {
+        deferred_release_pop();
+    }
+}
+
 /** \brief Adds the given physically pressed modifiers and sends a keyboard report immediately.
  *
  * \param mods A bitfield of modifiers to register.
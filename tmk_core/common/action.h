@@ -38,6 +38,13 @@ extern "C" {
 #    endif
 #endif
 
+#ifndef TAP_CODE_DELAY
+#    define TAP_CODE_DELAY 0
+#endif
+#ifndef TAP_HOLD_CAPS_DELAY
+#    define TAP_HOLD_CAPS_DELAY 80
+#endif
+
 /* tapping count and state */
 typedef struct {
     bool    interrupted : 1;
@@ -101,6 +108,9 @@ void register_code(uint8_t code);
 void unregister_code(uint8_t code);
 void tap_code(uint8_t code);
 void tap_code_delay(uint8_t code, uint16_t delay);
+void unregister_code_deferred(uint8_t code, uint8_t mods, uint8_t weak_mods, uint16_t delay);
+void deferred_release_flush(void);
+void deferred_release_task(void);
 void register_mods(uint8_t mods);
 void unregister_mods(uint8_t mods);
 void register_weak_mods(uint8_t mods);
@@ -1,8 +1,11 @@
 #include <stdint.h>
+#include <string.h>
 #include "keyboard.h"
 #include "action.h"
 #include "util.h"
 #include "action_layer.h"
+#include "event_trace.h"
+#include "event_bus.h"
 
 #ifdef DEBUG_ACTION
 #    include "debug.h"
@@ -35,9 +38,13 @@ static void default_layer_state_set(layer_state_t state) {
     debug("default_layer_state: ");
     default_layer_debug();
     debug(" to ");
+    if (default_layer_state != state) {
+        event_bus_publish(EVENT_BUS_LAYER);
+    }
     default_layer_state = state;
     default_layer_debug();
     debug("\n");
+    layer_resolve_cache_clear();
 #ifdef STRICT_LAYER_RELEASE
     clear_keyboard_but_mods();  // To avoid stuck keys
 #else
@@ -47,9 +54,15 @@ static void default_layer_state_set(layer_state_t state) {
 
 /** \brief Default Layer Print
  *
- * Print out the hex value of the 32-bit default layer state, as well as the value of the highest bit.
+ * Print out the hex value of the default layer state, as well as the value of the highest bit.
  */
-void default_layer_debug(void) { dprintf("%08lX(%u)", default_layer_state, get_highest_layer(default_layer_state)); }
+void default_layer_debug(void) {
+#if defined(LAYER_STATE_64BIT)
+    dprintf("%08lX%08lX(%u)", (uint32_t)(default_layer_state >> 32), (uint32_t)default_layer_state, get_highest_layer(default_layer_state));
+#else
+    dprintf("%08lX(%u)", (uint32_t)default_layer_state, get_highest_layer(default_layer_state));
+#endif
+}
 
 /** \brief Default Layer Set
  *
@@ -80,6 +93,10 @@ void default_layer_xor(layer_state_t state) { default_layer_state_set(default_la
  */
 layer_state_t layer_state = 0;
 
+/* get_highest_layer(layer_state), and the layer_state it was computed for */
+static layer_state_t highest_layer_state  = 0;
+static uint8_t       highest_active_layer = 0;
+
 /** \brief Layer state set user
  *
  * Runs user code on layer state change
@@ -101,9 +118,16 @@ void layer_state_set(layer_state_t state) {
     dprint("layer_state: ");
     layer_debug();
     dprint(" to ");
-    layer_state = state;
+    if (layer_state != state) {
+        event_bus_publish(EVENT_BUS_LAYER);
+    }
+    layer_state          = state;
+    highest_layer_state  = state;
+    highest_active_layer = get_highest_layer(state);
     layer_debug();
     dprintln();
+    event_trace(EVENT_TRACE_LAYER, 0, (uint16_t)state, (uint16_t)((uint32_t)state >> 16));
+    layer_resolve_cache_clear();
 #    ifdef STRICT_LAYER_RELEASE
     clear_keyboard_but_mods();  // To avoid stuck keys
 #    else
@@ -111,6 +135,19 @@ void layer_state_set(layer_state_t state) {
 #    endif
 }
 
+/** \brief Highest active layer
+ *
+ * Returns get_highest_layer(layer_state) as cached by layer_state_set(), recomputed only if layer_state was
+ * assigned directly since.
+ */
+uint8_t get_highest_active_layer(void) {
+    if (highest_layer_state != layer_state) {
+        highest_layer_state  = layer_state;
+        highest_active_layer = get_highest_layer(layer_state);
+    }
+    return highest_active_layer;
+}
+
 /** \brief Layer clear
  *
  * Turn off all layers
@@ -131,32 +168,32 @@ bool layer_state_cmp(layer_state_t cmp_layer_state, uint8_t layer) {
     if (!cmp_layer_state) {
         return layer == 0;
     }
-    return (cmp_layer_state & (1UL << layer)) != 0;
+    return (cmp_layer_state & LAYER_STATE_BIT(layer)) != 0;
 }
 
 /** \brief Layer move
  *
  * Turns on the given layer and turn off all other layers
  */
-void layer_move(uint8_t layer) { layer_state_set(1UL << layer); }
+void layer_move(uint8_t layer) { layer_state_set(LAYER_STATE_BIT(layer)); }
 
 /** \brief Layer on
  *
  * Turns on given layer
  */
-void layer_on(uint8_t layer) { layer_state_set(layer_state | (1UL << layer)); }
+void layer_on(uint8_t layer) { layer_state_set(layer_state | LAYER_STATE_BIT(layer)); }
 
 /** \brief Layer off
  *
  * Turns off given layer
  */
-void layer_off(uint8_t layer) { layer_state_set(layer_state & ~(1UL << layer)); }
+void layer_off(uint8_t layer) { layer_state_set(layer_state & ~LAYER_STATE_BIT(layer)); }
 
 /** \brief Layer invert
  *
  * Toggle the given layer (set it if it's unset, or unset it if it's set)
  */
-void layer_invert(uint8_t layer) { layer_state_set(layer_state ^ (1UL << layer)); }
+void layer_invert(uint8_t layer) { layer_state_set(layer_state ^ LAYER_STATE_BIT(layer)); }
 
 /** \brief Layer or
  *
@@ -176,28 +213,80 @@ void layer_xor(layer_state_t state) { layer_state_set(layer_state ^ state); }
 
 /** \brief Layer debug printing
  *
- * Print out the hex value of the 32-bit layer state, as well as the value of the highest bit.
+ * Print out the hex value of the layer state, as well as the value of the highest bit.
  */
-void layer_debug(void) { dprintf("%08lX(%u)", layer_state, get_highest_layer(layer_state)); }
+void layer_debug(void) {
+#    if defined(LAYER_STATE_64BIT)
+    dprintf("%08lX%08lX(%u)", (uint32_t)(layer_state >> 32), (uint32_t)layer_state, get_highest_layer(layer_state));
+#    else
+    dprintf("%08lX(%u)", (uint32_t)layer_state, get_highest_layer(layer_state));
+#    endif
+}
 #endif
 
 #if !defined(NO_ACTION_LAYER) && !defined(STRICT_LAYER_RELEASE)
 /** \brief source layer cache
+ *
+ * The layer each pressed key was resolved on. One byte per key when RAM
+ * allows, one nibble per key when MAX_LAYER_BITS is 4, otherwise one bit
+ * plane per layer bit with a bit per key. Keys are numbered from 0 to
+ * MATRIX_ROWS * MATRIX_COLS - 1, in 16 bits so large matrices fit.
  */
+#    if !defined(SOURCE_LAYERS_CACHE_BYTES) && !defined(SOURCE_LAYERS_CACHE_NIBBLES) && !defined(SOURCE_LAYERS_CACHE_BIT_PLANES)
+#        if !defined(__AVR__)
+#            define SOURCE_LAYERS_CACHE_BYTES
+#        elif MAX_LAYER_BITS == 4
+#            define SOURCE_LAYERS_CACHE_NIBBLES
+#        else
+#            define SOURCE_LAYERS_CACHE_BIT_PLANES
+#        endif
+#    endif
+
+#    define SOURCE_LAYERS_CACHE_KEYS (MATRIX_ROWS * MATRIX_COLS)
+
+static inline uint16_t source_layers_cache_key(keypos_t key) { return (uint16_t)key.row * MATRIX_COLS + key.col; }
+
+#    if defined(SOURCE_LAYERS_CACHE_BYTES)
+uint8_t source_layers_cache[SOURCE_LAYERS_CACHE_KEYS] = {0};
+
+void update_source_layers_cache(keypos_t key, uint8_t layer) { source_layers_cache[source_layers_cache_key(key)] = layer; }
+
+uint8_t read_source_layers_cache(keypos_t key) { return source_layers_cache[source_layers_cache_key(key)]; }
+#    elif defined(SOURCE_LAYERS_CACHE_NIBBLES)
+#        if MAX_LAYER_BITS > 4
+#            error SOURCE_LAYERS_CACHE_NIBBLES needs LAYER_STATE_8BIT or LAYER_STATE_16BIT
+#        endif
+uint8_t source_layers_cache[(SOURCE_LAYERS_CACHE_KEYS + 1) / 2] = {0};
 
-uint8_t source_layers_cache[(MATRIX_ROWS * MATRIX_COLS + 7) / 8][MAX_LAYER_BITS] = {{0}};
+void update_source_layers_cache(keypos_t key, uint8_t layer) {
+    const uint16_t key_number = source_layers_cache_key(key);
+    uint8_t *      pair       = &source_layers_cache[key_number / 2];
+    if (key_number & 1) {
+        *pair = (*pair & 0x0F) | (layer << 4);
+    } else {
+        *pair = (*pair & 0xF0) | (layer & 0x0F);
+    }
+}
+
+uint8_t read_source_layers_cache(keypos_t key) {
+    const uint16_t key_number = source_layers_cache_key(key);
+    const uint8_t  pair       = source_layers_cache[key_number / 2];
+    return (key_number & 1) ? pair >> 4 : pair & 0x0F;
+}
+#    else
+uint8_t source_layers_cache[(SOURCE_LAYERS_CACHE_KEYS + 7) / 8][MAX_LAYER_BITS] = {{0}};
 
 /** \brief update source layers cache
  *
  * Updates the cached keys when changing layers
  */
 void update_source_layers_cache(keypos_t key, uint8_t layer) {
-    const uint8_t key_number  = key.col + (key.row * MATRIX_COLS);
-    const uint8_t storage_row = key_number / 8;
-    const uint8_t storage_bit = key_number % 8;
+    const uint16_t key_number = source_layers_cache_key(key);
+    uint8_t *      planes     = source_layers_cache[key_number / 8];
+    const uint8_t  mask       = 1U << (key_number % 8);
 
     for (uint8_t bit_number = 0; bit_number < MAX_LAYER_BITS; bit_number++) {
-        source_layers_cache[storage_row][bit_number] ^= (-((layer & (1U << bit_number)) != 0) ^ source_layers_cache[storage_row][bit_number]) & (1U << storage_bit);
+        planes[bit_number] = (layer & (1U << bit_number)) ? planes[bit_number] | mask : planes[bit_number] & ~mask;
     }
 }
 
@@ -206,17 +295,34 @@ void update_source_layers_cache(keypos_t key, uint8_t layer) {
  * reads the cached keys stored when the layer was changed
  */
 uint8_t read_source_layers_cache(keypos_t key) {
-    const uint8_t key_number  = key.col + (key.row * MATRIX_COLS);
-    const uint8_t storage_row = key_number / 8;
-    const uint8_t storage_bit = key_number % 8;
-    uint8_t       layer       = 0;
+    const uint16_t key_number = source_layers_cache_key(key);
+    const uint8_t *planes     = source_layers_cache[key_number / 8];
+    const uint8_t  mask       = 1U << (key_number % 8);
+    uint8_t        layer      = 0;
 
     for (uint8_t bit_number = 0; bit_number < MAX_LAYER_BITS; bit_number++) {
-        layer |= ((source_layers_cache[storage_row][bit_number] & (1U << storage_bit)) != 0) << bit_number;
+        if (planes[bit_number] & mask) {
+            layer |= 1U << bit_number;
+        }
     }
 
     return layer;
 }
+#    endif
+#endif
+
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_RESOLVE_CACHE)
+/** \brief resolved layer cache
+ *
+ * Topmost non-transparent layer plus one for each key, zero until resolved
+ */
+static uint8_t resolved_layer_cache[MATRIX_ROWS][MATRIX_COLS];
+
+/** \brief clear resolved layer cache
+ *
+ * Forgets every resolved layer, called whenever the layer state or the keymap changes
+ */
+void layer_resolve_cache_clear(void) { memset(resolved_layer_cache, 0, sizeof(resolved_layer_cache)); }
 #endif
 
 /** \brief Store or get action (FIXME: Needs better summary)
@@ -246,27 +352,46 @@ action_t store_or_get_action(bool pressed, keypos_t key) {
 #endif
 }
 
-/** \brief Layer switch get layer
+#ifndef NO_ACTION_LAYER
+/** \brief Layer switch resolve layer
  *
- * Gets the layer based on key info
+ * Walks the active layers from the top to find the first non-transparent one
  */
-uint8_t layer_switch_get_layer(keypos_t key) {
-#ifndef NO_ACTION_LAYER
+static uint8_t layer_switch_resolve_layer(keypos_t key) {
     action_t action;
     action.code = ACTION_TRANSPARENT;
 
     layer_state_t layers = layer_state | default_layer_state;
-    /* check top layer first */
-    for (int8_t i = MAX_LAYER - 1; i >= 0; i--) {
-        if (layers & (1UL << i)) {
-            action = action_for_key(i, key);
-            if (action.code != ACTION_TRANSPARENT) {
-                return i;
-            }
+    /* check top layer first, visiting only the active ones */
+    while (layers) {
+        uint8_t i = get_highest_layer(layers);
+        action    = action_for_key(i, key);
+        if (action.code != ACTION_TRANSPARENT) {
+            return i;
         }
+        layers &= ~LAYER_STATE_BIT(i);
     }
     /* fall back to layer 0 */
     return 0;
+}
+#endif
+
+/** \brief Layer switch get layer
+ *
+ * Gets the layer based on key info
+ */
+uint8_t layer_switch_get_layer(keypos_t key) {
+#ifndef NO_ACTION_LAYER
+#    ifdef LAYER_RESOLVE_CACHE
+    if (key.row < MATRIX_ROWS && key.col < MATRIX_COLS) {
+        uint8_t *cached = &resolved_layer_cache[key.row][key.col];
+        if (!*cached) {
+            *cached = layer_switch_resolve_layer(key) + 1;
+        }
+        return *cached - 1;
+    }
+#    endif
+    return layer_switch_resolve_layer(key);
 #else
     return get_highest_layer(default_layer_state);
 #endif
@@ -21,7 +21,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "keyboard.h"
 #include "action.h"
 
-#if defined(LAYER_STATE_8BIT)
+#if defined(LAYER_STATE_64BIT)
+typedef uint64_t layer_state_t;
+#    define MAX_LAYER_BITS 6
+#    ifndef MAX_LAYER
+#        define MAX_LAYER 64
+#    endif
+#    define get_highest_layer(state) biton64(state)
+#elif defined(LAYER_STATE_8BIT)
 typedef uint8_t layer_state_t;
 #    define MAX_LAYER_BITS 3
 #    ifndef MAX_LAYER
@@ -44,6 +51,9 @@ typedef uint32_t layer_state_t;
 #    define get_highest_layer(state) biton32(state)
 #endif
 
+/* A single layer as a layer_state_t bit, wide enough for any layer state size */
+#define LAYER_STATE_BIT(layer) ((layer_state_t)1 << (layer))
+
 /*
  * Default Layer
  */
@@ -71,8 +81,9 @@ void default_layer_xor(layer_state_t state);
 #ifndef NO_ACTION_LAYER
 extern layer_state_t layer_state;
 
-void layer_state_set(layer_state_t state);
-bool layer_state_is(uint8_t layer);
+void    layer_state_set(layer_state_t state);
+uint8_t get_highest_active_layer(void);
+bool    layer_state_is(uint8_t layer);
 bool layer_state_cmp(layer_state_t layer1, uint8_t layer2);
 
 void layer_debug(void);
@@ -91,8 +102,9 @@ layer_state_t layer_state_set_kb(layer_state_t state);
 #    define layer_state 0
 
 #    define layer_state_set(layer)
+#    define get_highest_active_layer() 0
 #    define layer_state_is(layer) (layer == 0)
-#    define layer_state_cmp(state, layer) (state == 0 ? layer == 0 : (state & 1UL << layer) != 0)
+#    define layer_state_cmp(state, layer) (state == 0 ? layer == 0 : (state & LAYER_STATE_BIT(layer)) != 0)
 
 #    define layer_debug()
 #    define layer_clear()
@@ -107,6 +119,13 @@ layer_state_t layer_state_set_kb(layer_state_t state);
 #    define layer_state_set_user(state) (void)state
 #endif
 
+/* resolved layer cache */
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_RESOLVE_CACHE)
+void layer_resolve_cache_clear(void);
+#else
+#    define layer_resolve_cache_clear()
+#endif
+
 /* pressed actions cache */
 #if !defined(NO_ACTION_LAYER) && !defined(STRICT_LAYER_RELEASE)
 
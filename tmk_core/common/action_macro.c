@@ -27,17 +27,32 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #ifndef NO_ACTION_MACRO
 
-#    define MACRO_READ() (macro = MACRO_GET(macro_p++))
-/** \brief Action Macro Play
- *
- * FIXME: Needs doc
- */
-void action_macro_play(const macro_t *macro_p) {
-    macro_t macro    = END;
-    uint8_t interval = 0;
+#    include "timer.h"
+#    include "deferred_exec.h"
+
+#    ifndef ACTION_MACRO_QUEUE_SIZE
+#        define ACTION_MACRO_QUEUE_SIZE 4
+#    endif
+
+/* Macros are played from the main loop rather than in one go: at every WAIT
+ * and interval the rest of the macro is left to a deferred callback, so
+ * scanning, reports and split sync carry on meanwhile. Macros started while
+ * one is still playing are queued, to keep their keys in order. */
+static const macro_t *playing  = NULL;  // next byte of the macro being played, NULL when none is
+static uint8_t        interval = 0;
+static const macro_t *queue[ACTION_MACRO_QUEUE_SIZE];
+static uint8_t        queue_head  = 0;
+static uint8_t        queue_count = 0;
+static deferred_token resume_token;
+static uint32_t       resume_time;
+
+#    define MACRO_READ() (macro = MACRO_GET(playing++))
+// Plays the macro until it ends or has to wait, returns how long for, 0 once it has ended
+static uint16_t macro_run(void) {
+    macro_t macro = END;
 
-    if (!macro_p) return;
     while (true) {
+        uint16_t wait = 0;
         switch (MACRO_READ()) {
             case KEY_DOWN:
                 MACRO_READ();
@@ -62,10 +77,7 @@ void action_macro_play(const macro_t *macro_p) {
             case WAIT:
                 MACRO_READ();
                 dprintf("WAIT(%u)\n", macro);
-                {
-                    uint8_t ms = macro;
-                    while (ms--) wait_ms(1);
-                }
+                wait = macro;
                 break;
             case INTERVAL:
                 interval = MACRO_READ();
@@ -81,12 +93,75 @@ void action_macro_play(const macro_t *macro_p) {
                 break;
             case END:
             default:
-                return;
+                playing = NULL;
+                return 0;
         }
         // interval
-        {
-            uint8_t ms = interval;
-            while (ms--) wait_ms(1);
+        wait += interval;
+        if (wait) {
+            return wait;
+        }
+    }
+}
+
+// Plays on through the queued macros until one has to wait, returns how long for, 0 once all have ended
+static uint16_t macro_step(void) {
+    while (true) {
+        if (playing) {
+            uint16_t wait = macro_run();
+            if (wait) {
+                resume_time = timer_read32() + wait;
+                return wait;
+            }
+        }
+        if (queue_count == 0) {
+            return 0;
+        }
+        playing    = queue[queue_head];
+        interval   = 0;
+        queue_head = (queue_head + 1) % ACTION_MACRO_QUEUE_SIZE;
+        queue_count--;
+    }
+}
+
+static uint32_t macro_resume(uint32_t trigger_time, void *cb_arg) { return macro_step(); }
+
+// Plays everything left at once, waiting in place the way macros used to
+static void macro_finish(void) {
+    cancel_deferred_exec(resume_token);
+    resume_token = INVALID_DEFERRED_TOKEN;
+    do {
+        while (!timer_expired32(timer_read32(), resume_time)) {
+            wait_ms(1);
+        }
+    } while (macro_step());
+}
+
+/** \brief Action Macro Play
+ *
+ * Starts playing the macro, or queues it behind the one still playing. Whatever
+ * comes after a wait is played later from the main loop.
+ */
+void action_macro_play(const macro_t *macro_p) {
+    if (!macro_p) return;
+
+    if (playing) {
+        if (queue_count == ACTION_MACRO_QUEUE_SIZE) {
+            macro_finish();
+        } else {
+            queue[(queue_head + queue_count) % ACTION_MACRO_QUEUE_SIZE] = macro_p;
+            queue_count++;
+            return;
+        }
+    }
+
+    playing       = macro_p;
+    interval      = 0;
+    uint16_t wait = macro_step();
+    if (wait) {
+        resume_token = defer_exec(wait, macro_resume, NULL);
+        if (resume_token == INVALID_DEFERRED_TOKEN) {
+            macro_finish();
         }
     }
 }
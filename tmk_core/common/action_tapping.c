@@ -5,6 +5,7 @@
 #include "action_tapping.h"
 #include "keycode.h"
 #include "timer.h"
+#include "event_trace.h"
 
 #ifdef DEBUG_ACTION
 #    include "debug.h"
@@ -22,7 +23,7 @@
 __attribute__((weak)) uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) { return TAPPING_TERM; }
 
 #    ifdef TAPPING_TERM_PER_KEY
-#        define WITHIN_TAPPING_TERM(e) (TIMER_DIFF_16(e.time, tapping_key.event.time) < get_tapping_term(get_event_keycode(tapping_key.event, false), &tapping_key))
+#        define WITHIN_TAPPING_TERM(e) (TIMER_DIFF_16(e.time, tapping_key.event.time) < tapping_key_options.tapping_term)
 #    else
 #        define WITHIN_TAPPING_TERM(e) (TIMER_DIFF_16(e.time, tapping_key.event.time) < TAPPING_TERM)
 #    endif
@@ -35,10 +36,106 @@ __attribute__((weak)) bool get_tapping_force_hold(uint16_t keycode, keyrecord_t
 __attribute__((weak)) bool get_permissive_hold(uint16_t keycode, keyrecord_t *record) { return false; }
 #    endif
 
-static keyrecord_t tapping_key                         = {};
-static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE] = {};
-static uint8_t     waiting_buffer_head                 = 0;
-static uint8_t     waiting_buffer_tail                 = 0;
+#    ifdef FLOW_TAP_TERM
+#        ifdef FLOW_TAP_TERM_PER_KEY
+__attribute__((weak)) uint16_t get_flow_tap_term(uint16_t keycode, keyrecord_t *record) { return FLOW_TAP_TERM; }
+#            define GET_FLOW_TAP_TERM(keycode, record) get_flow_tap_term(keycode, record)
+#        else
+#            define GET_FLOW_TAP_TERM(keycode, record) (FLOW_TAP_TERM)
+#        endif
+
+// The two newest key presses, the newest first
+static keyevent_t flow_tap_presses[2] = {};
+
+static void flow_tap_record(keyevent_t event);
+static bool flow_tap_typing(keyrecord_t *keyp);
+#    endif
+
+#    if WAITING_BUFFER_SIZE > 255
+#        error "WAITING_BUFFER_SIZE must be 255 or less"
+#    endif
+
+#    ifdef WAITING_BUFFER_PACKED
+/* A keyrecord_t in 5 bytes with no padding, for deep buffers */
+typedef struct {
+    uint8_t row;
+    uint8_t col;
+    uint8_t flags;  // pressed, tap.interrupted and tap.count
+    uint8_t time_lo;
+    uint8_t time_hi;
+} waiting_record_t;
+
+#        define WAITING_RECORD_PRESSED 0x80
+#        define WAITING_RECORD_INTERRUPTED 0x10
+
+static inline waiting_record_t waiting_record_pack(keyrecord_t record) {
+    return (waiting_record_t){
+        .row     = record.event.key.row,
+        .col     = record.event.key.col,
+        .flags   = (record.event.pressed ? WAITING_RECORD_PRESSED : 0) | (record.tap.interrupted ? WAITING_RECORD_INTERRUPTED : 0) | record.tap.count,
+        .time_lo = record.event.time & 0xFF,
+        .time_hi = record.event.time >> 8,
+    };
+}
+
+static inline keyrecord_t waiting_record_unpack(waiting_record_t packed) {
+    return (keyrecord_t){
+        .event.key.row   = packed.row,
+        .event.key.col   = packed.col,
+        .event.pressed   = packed.flags & WAITING_RECORD_PRESSED,
+        .event.time      = packed.time_lo | (uint16_t)packed.time_hi << 8,
+        .tap.interrupted = packed.flags & WAITING_RECORD_INTERRUPTED,
+        .tap.count       = packed.flags & 0x0F,
+    };
+}
+#    else
+typedef keyrecord_t waiting_record_t;
+
+#        define waiting_record_pack(record) (record)
+#        define waiting_record_unpack(packed) (packed)
+#    endif
+
+static keyrecord_t      tapping_key                         = {};
+static waiting_record_t waiting_buffer[WAITING_BUFFER_SIZE] = {};
+static uint8_t          waiting_buffer_head                 = 0;
+static uint8_t          waiting_buffer_tail                 = 0;
+static uint8_t          waiting_buffer_peak                 = 0;
+static uint16_t         waiting_buffer_overflows            = 0;
+
+#    if defined(TAPPING_TERM_PER_KEY) || defined(PERMISSIVE_HOLD_PER_KEY) || defined(TAPPING_FORCE_HOLD_PER_KEY)
+/* The per key options of tapping_key, asked for once when its key is pressed rather than on every
+ * comparison, each of which would look its keycode up through the layers again. */
+static struct {
+#        ifdef TAPPING_TERM_PER_KEY
+    uint16_t tapping_term;
+#        endif
+#        ifdef PERMISSIVE_HOLD_PER_KEY
+    bool permissive_hold;
+#        endif
+#        ifdef TAPPING_FORCE_HOLD_PER_KEY
+    bool tapping_force_hold;
+#        endif
+} tapping_key_options;
+
+static void tapping_key_set(keyrecord_t *keyp) {
+    tapping_key = *keyp;
+    // A release keeps the options of the press, it's the same key
+    if (!IS_NOEVENT(tapping_key.event) && tapping_key.event.pressed) {
+        uint16_t keycode = get_event_keycode(tapping_key.event, false);
+#        ifdef TAPPING_TERM_PER_KEY
+        tapping_key_options.tapping_term = get_tapping_term(keycode, &tapping_key);
+#        endif
+#        ifdef PERMISSIVE_HOLD_PER_KEY
+        tapping_key_options.permissive_hold = get_permissive_hold(keycode, &tapping_key);
+#        endif
+#        ifdef TAPPING_FORCE_HOLD_PER_KEY
+        tapping_key_options.tapping_force_hold = get_tapping_force_hold(keycode, &tapping_key);
+#        endif
+    }
+}
+#    else
+#        define tapping_key_set(keyp) (tapping_key = *(keyp))
+#    endif
 
 static bool process_tapping(keyrecord_t *record);
 static bool waiting_buffer_enq(keyrecord_t record);
@@ -54,16 +151,21 @@ static void debug_waiting_buffer(void);
  * FIXME: Needs doc
  */
 void action_tapping_process(keyrecord_t record) {
+#    ifdef FLOW_TAP_TERM
+    flow_tap_record(record.event);
+#    endif
     if (process_tapping(&record)) {
         if (!IS_NOEVENT(record.event)) {
             debug("processed: ");
             debug_record(record);
             debug("\n");
+            event_trace(EVENT_TRACE_RECORD, record.event.key.row, record.event.key.col | record.event.pressed << 8 | record.tap.interrupted << 9, record.tap.count);
         }
     } else {
         if (!waiting_buffer_enq(record)) {
             // clear all in case of overflow.
             debug("OVERFLOW: CLEAR ALL STATES\n");
+            if (waiting_buffer_overflows < UINT16_MAX) waiting_buffer_overflows++;
             clear_keyboard();
             waiting_buffer_clear();
             tapping_key = (keyrecord_t){};
@@ -75,13 +177,16 @@ void action_tapping_process(keyrecord_t record) {
         debug("---- action_exec: process waiting_buffer -----\n");
     }
     for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
-        if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
+        keyrecord_t waiting = waiting_record_unpack(waiting_buffer[waiting_buffer_tail]);
+        if (process_tapping(&waiting)) {
             debug("processed: waiting_buffer[");
             debug_dec(waiting_buffer_tail);
             debug("] = ");
-            debug_record(waiting_buffer[waiting_buffer_tail]);
+            debug_record(waiting);
             debug("\n\n");
         } else {
+            // keep whatever tap state was settled for it
+            waiting_buffer[waiting_buffer_tail] = waiting_record_pack(waiting);
             break;
         }
     }
@@ -122,14 +227,14 @@ bool process_tapping(keyrecord_t *keyp) {
 #    if defined(TAPPING_TERM_PER_KEY) || (TAPPING_TERM >= 500) || defined(PERMISSIVE_HOLD) || defined(PERMISSIVE_HOLD_PER_KEY)
                 else if (((
 #        ifdef TAPPING_TERM_PER_KEY
-                              get_tapping_term(get_event_keycode(tapping_key.event, false), keyp)
+                              tapping_key_options.tapping_term
 #        else
                               TAPPING_TERM
 #        endif
                               >= 500)
 
 #        ifdef PERMISSIVE_HOLD_PER_KEY
-                          || get_permissive_hold(get_event_keycode(tapping_key.event, false), keyp)
+                          || tapping_key_options.permissive_hold
 #        elif defined(PERMISSIVE_HOLD)
                           || true
 #        endif
@@ -183,7 +288,7 @@ bool process_tapping(keyrecord_t *keyp) {
                     debug(")\n");
                     keyp->tap = tapping_key.tap;
                     process_record(keyp);
-                    tapping_key = *keyp;
+                    tapping_key_set(keyp);
                     debug_tapping_key();
                     return true;
                 } else if (is_tap_key(event.key) && event.pressed) {
@@ -194,7 +299,7 @@ bool process_tapping(keyrecord_t *keyp) {
                     } else {
                         debug("Tapping: Start while last tap(1).\n");
                     }
-                    tapping_key = *keyp;
+                    tapping_key_set(keyp);
                     waiting_buffer_scan_tap();
                     debug_tapping_key();
                     return true;
@@ -232,7 +337,7 @@ bool process_tapping(keyrecord_t *keyp) {
                     } else {
                         debug("Tapping: Start while last timeout tap(1).\n");
                     }
-                    tapping_key = *keyp;
+                    tapping_key_set(keyp);
                     waiting_buffer_scan_tap();
                     debug_tapping_key();
                     return true;
@@ -253,7 +358,7 @@ bool process_tapping(keyrecord_t *keyp) {
 #    if !defined(TAPPING_FORCE_HOLD) || defined(TAPPING_FORCE_HOLD_PER_KEY)
                     if (
 #        ifdef TAPPING_FORCE_HOLD_PER_KEY
-                        !get_tapping_force_hold(get_event_keycode(tapping_key.event, false), keyp) &&
+                        !tapping_key_options.tapping_force_hold &&
 #        endif
                         !tapping_key.tap.interrupted && tapping_key.tap.count > 0) {
                         // sequential tap.
@@ -263,18 +368,18 @@ bool process_tapping(keyrecord_t *keyp) {
                         debug_dec(keyp->tap.count);
                         debug(")\n");
                         process_record(keyp);
-                        tapping_key = *keyp;
+                        tapping_key_set(keyp);
                         debug_tapping_key();
                         return true;
                     }
 #    endif
                     // FIX: start new tap again
-                    tapping_key = *keyp;
+                    tapping_key_set(keyp);
                     return true;
                 } else if (is_tap_key(event.key)) {
                     // Sequential tap can be interfered with other tap key.
                     debug("Tapping: Start with interfering other tap.\n");
-                    tapping_key = *keyp;
+                    tapping_key_set(keyp);
                     waiting_buffer_scan_tap();
                     debug_tapping_key();
                     return true;
@@ -305,7 +410,7 @@ bool process_tapping(keyrecord_t *keyp) {
     else {
         if (event.pressed && is_tap_key(event.key)) {
             debug("Tapping: Start(Press tap key).\n");
-            tapping_key = *keyp;
+            tapping_key_set(keyp);
             process_record_tap_hint(&tapping_key);
             waiting_buffer_scan_tap();
             debug_tapping_key();
@@ -331,9 +436,12 @@ bool waiting_buffer_enq(keyrecord_t record) {
         return false;
     }
 
-    waiting_buffer[waiting_buffer_head] = record;
+    waiting_buffer[waiting_buffer_head] = waiting_record_pack(record);
     waiting_buffer_head                 = (waiting_buffer_head + 1) % WAITING_BUFFER_SIZE;
 
+    uint8_t depth = (waiting_buffer_head + WAITING_BUFFER_SIZE - waiting_buffer_tail) % WAITING_BUFFER_SIZE;
+    if (depth > waiting_buffer_peak) waiting_buffer_peak = depth;
+
     debug("waiting_buffer_enq: ");
     debug_waiting_buffer();
     return true;
@@ -354,20 +462,33 @@ void waiting_buffer_clear(void) {
  */
 bool waiting_buffer_typed(keyevent_t event) {
     for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
-        if (KEYEQ(event.key, waiting_buffer[i].event.key) && event.pressed != waiting_buffer[i].event.pressed) {
+        keyevent_t waiting = waiting_record_unpack(waiting_buffer[i]).event;
+        if (KEYEQ(event.key, waiting.key) && event.pressed != waiting.pressed) {
             return true;
         }
     }
     return false;
 }
 
+/** \brief Waiting buffer overflow count
+ *
+ * How often the waiting buffer overflowed and all states were cleared, saturating at UINT16_MAX.
+ */
+uint16_t waiting_buffer_overflow_count(void) { return waiting_buffer_overflows; }
+
+/** \brief Waiting buffer peak depth
+ *
+ * The most records the waiting buffer held at once, to tune WAITING_BUFFER_SIZE.
+ */
+uint8_t waiting_buffer_peak_depth(void) { return waiting_buffer_peak; }
+
 /** \brief Waiting buffer has anykey pressed
  *
  * FIXME: Needs docs
  */
 __attribute__((unused)) bool waiting_buffer_has_anykey_pressed(void) {
     for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
-        if (waiting_buffer[i].event.pressed) return true;
+        if (waiting_record_unpack(waiting_buffer[i]).event.pressed) return true;
     }
     return false;
 }
@@ -382,10 +503,22 @@ void waiting_buffer_scan_tap(void) {
     // invalid state: tapping_key released && tap.count == 0
     if (!tapping_key.event.pressed) return;
 
+#    ifdef FLOW_TAP_TERM
+    // settled right away: a tap key pressed while typing is a tap
+    if (flow_tap_typing(&tapping_key)) {
+        debug("waiting_buffer_scan_tap: flow tap\n");
+        tapping_key.tap.count = 1;
+        process_record(&tapping_key);
+        return;
+    }
+#    endif
+
     for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
-        if (IS_TAPPING_KEY(waiting_buffer[i].event.key) && !waiting_buffer[i].event.pressed && WITHIN_TAPPING_TERM(waiting_buffer[i].event)) {
-            tapping_key.tap.count       = 1;
-            waiting_buffer[i].tap.count = 1;
+        keyrecord_t waiting = waiting_record_unpack(waiting_buffer[i]);
+        if (IS_TAPPING_KEY(waiting.event.key) && !waiting.event.pressed && WITHIN_TAPPING_TERM(waiting.event)) {
+            tapping_key.tap.count = 1;
+            waiting.tap.count     = 1;
+            waiting_buffer[i]     = waiting_record_pack(waiting);
             process_record(&tapping_key);
 
             debug("waiting_buffer_scan_tap: found at [");
@@ -397,6 +530,34 @@ void waiting_buffer_scan_tap(void) {
     }
 }
 
+#    ifdef FLOW_TAP_TERM
+/** \brief Remember a key press for flow tap
+ *
+ * Every press is remembered, so that a modifier pressed in between ends the typing streak.
+ */
+static void flow_tap_record(keyevent_t event) {
+    if (IS_NOEVENT(event) || !event.pressed) return;
+    flow_tap_presses[1] = flow_tap_presses[0];
+    flow_tap_presses[0] = event;
+}
+
+/** \brief Is the tap key of keyp pressed while typing
+ *
+ * True when the press just before it was not a modifier and came less than the flow tap term earlier.
+ * A press that comes back from the waiting buffer after a newer press was made doesn't qualify.
+ */
+static bool flow_tap_typing(keyrecord_t *keyp) {
+    if (!KEYEQ(flow_tap_presses[0].key, keyp->event.key) || flow_tap_presses[0].time != keyp->event.time || IS_NOEVENT(flow_tap_presses[1])) {
+        return false;
+    }
+    keyevent_t prev = flow_tap_presses[1];
+    if (IS_MOD(get_event_keycode(prev, false))) {
+        return false;
+    }
+    return TIMER_DIFF_16(keyp->event.time, prev.time) < GET_FLOW_TAP_TERM(get_event_keycode(keyp->event, false), keyp);
+}
+#    endif
+
 /** \brief Tapping key debug print
  *
  * FIXME: Needs docs
@@ -417,7 +578,7 @@ static void debug_waiting_buffer(void) {
         debug("[");
         debug_dec(i);
         debug("]=");
-        debug_record(waiting_buffer[i]);
+        debug_record(waiting_record_unpack(waiting_buffer[i]));
         debug(" ");
     }
     debug("}\n");
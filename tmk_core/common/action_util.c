@@ -20,23 +20,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_util.h"
 #include "action_layer.h"
 #include "timer.h"
+#include "deferred_exec.h"
 #include "keycode_config.h"
 
 extern keymap_config_t keymap_config;
 
-static uint8_t real_mods  = 0;
-static uint8_t weak_mods  = 0;
-static uint8_t macro_mods = 0;
-
-#ifdef USB_6KRO_ENABLE
-#    define RO_ADD(a, b) ((a + b) % KEYBOARD_REPORT_KEYS)
-#    define RO_SUB(a, b) ((a - b + KEYBOARD_REPORT_KEYS) % KEYBOARD_REPORT_KEYS)
-#    define RO_INC(a) RO_ADD(a, 1)
-#    define RO_DEC(a) RO_SUB(a, 1)
-static int8_t cb_head  = 0;
-static int8_t cb_tail  = 0;
-static int8_t cb_count = 0;
-#endif
+static uint8_t real_mods   = 0;
+static uint8_t weak_mods   = 0;
+static uint8_t macro_mods  = 0;
+static uint8_t report_mods = 0;  // all of the above and the oneshot mods, see update_report_mods()
 
 // TODO: pointer variable is not needed
 // report_keyboard_t keyboard_report = {};
@@ -49,6 +41,20 @@ extern inline void clear_keys(void);
 #ifndef NO_ACTION_ONESHOT
 static uint8_t oneshot_mods        = 0;
 static uint8_t oneshot_locked_mods = 0;
+#endif
+
+/** \brief Recomputes the modifiers of the keyboard report
+ *
+ * Called whenever one of the modifier sets changes, so that send_keyboard_report() doesn't need to.
+ */
+static void update_report_mods(void) {
+    report_mods = real_mods | weak_mods | macro_mods;
+#ifndef NO_ACTION_ONESHOT
+    report_mods |= oneshot_mods;
+#endif
+}
+
+#ifndef NO_ACTION_ONESHOT
 uint8_t        get_oneshot_locked_mods(void) { return oneshot_locked_mods; }
 void           set_oneshot_locked_mods(uint8_t mods) {
     if (mods != oneshot_locked_mods) {
@@ -63,8 +69,30 @@ void clear_oneshot_locked_mods(void) {
     }
 }
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-static uint16_t oneshot_time = 0;
-bool            has_oneshot_mods_timed_out(void) { return TIMER_DIFF_16(timer_read(), oneshot_time) >= ONESHOT_TIMEOUT; }
+static uint16_t       oneshot_time       = 0;
+static deferred_token oneshot_mods_token = INVALID_DEFERRED_TOKEN;
+bool                  has_oneshot_mods_timed_out(void) { return TIMER_DIFF_16(timer_read(), oneshot_time) >= ONESHOT_TIMEOUT; }
+
+static uint32_t oneshot_mods_timeout(uint32_t trigger_time, void *cb_arg) {
+    dprintf("Oneshot: timeout\n");
+    oneshot_mods_token = INVALID_DEFERRED_TOKEN;
+    clear_oneshot_mods();
+    return 0;
+}
+
+/* Restarts the timeout of the oneshot mods, or stops it once there are none. */
+static void oneshot_mods_timer_restart(void) {
+    if (!oneshot_mods) {
+        oneshot_time = 0;
+        cancel_deferred_exec(oneshot_mods_token);
+        oneshot_mods_token = INVALID_DEFERRED_TOKEN;
+        return;
+    }
+    oneshot_time = timer_read();
+    if (!extend_deferred_exec(oneshot_mods_token, ONESHOT_TIMEOUT)) {
+        oneshot_mods_token = defer_exec(ONESHOT_TIMEOUT, oneshot_mods_timeout, NULL);
+    }
+}
 #    else
 bool has_oneshot_mods_timed_out(void) { return false; }
 #    endif
@@ -93,11 +121,31 @@ enum {
 #    endif
 
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-static uint16_t oneshot_layer_time = 0;
-inline bool     has_oneshot_layer_timed_out() { return TIMER_DIFF_16(timer_read(), oneshot_layer_time) >= ONESHOT_TIMEOUT && !(get_oneshot_layer_state() & ONESHOT_TOGGLED); }
+static uint16_t       oneshot_layer_time  = 0;
+static deferred_token oneshot_layer_token = INVALID_DEFERRED_TOKEN;
+inline bool           has_oneshot_layer_timed_out() { return TIMER_DIFF_16(timer_read(), oneshot_layer_time) >= ONESHOT_TIMEOUT && !(get_oneshot_layer_state() & ONESHOT_TOGGLED); }
+
+static uint32_t oneshot_layer_timeout(uint32_t trigger_time, void *cb_arg) {
+    oneshot_layer_token = INVALID_DEFERRED_TOKEN;
+    if (!(get_oneshot_layer_state() & ONESHOT_TOGGLED)) {
+        clear_oneshot_layer_state(ONESHOT_OTHER_KEY_PRESSED);
+    }
+    return 0;
+}
+
 #        ifdef SWAP_HANDS_ENABLE
-static uint16_t oneshot_swaphands_time = 0;
-inline bool     has_oneshot_swaphands_timed_out() { return TIMER_DIFF_16(timer_read(), oneshot_swaphands_time) >= ONESHOT_TIMEOUT && (swap_hands_oneshot == SHO_ACTIVE); }
+static uint16_t       oneshot_swaphands_time  = 0;
+static deferred_token oneshot_swaphands_token = INVALID_DEFERRED_TOKEN;
+inline bool           has_oneshot_swaphands_timed_out() { return TIMER_DIFF_16(timer_read(), oneshot_swaphands_time) >= ONESHOT_TIMEOUT && (swap_hands_oneshot == SHO_ACTIVE); }
+
+static uint32_t oneshot_swaphands_timeout(uint32_t trigger_time, void *cb_arg) {
+    oneshot_swaphands_token = INVALID_DEFERRED_TOKEN;
+    // Still held, release_oneshot_swaphands() takes care of the timeout.
+    if (swap_hands_oneshot == SHO_ACTIVE) {
+        clear_oneshot_swaphands();
+    }
+    return 0;
+}
 #        endif
 #    endif
 
@@ -108,8 +156,12 @@ void set_oneshot_swaphands(void) {
     swap_hands         = true;
 #        if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
     oneshot_swaphands_time = timer_read();
+    if (!extend_deferred_exec(oneshot_swaphands_token, ONESHOT_TIMEOUT)) {
+        oneshot_swaphands_token = defer_exec(ONESHOT_TIMEOUT, oneshot_swaphands_timeout, NULL);
+    }
     if (oneshot_layer_time != 0) {
         oneshot_layer_time = oneshot_swaphands_time;
+        extend_deferred_exec(oneshot_layer_token, ONESHOT_TIMEOUT);
     }
 #        endif
 }
@@ -117,6 +169,11 @@ void set_oneshot_swaphands(void) {
 void release_oneshot_swaphands(void) {
     if (swap_hands_oneshot == SHO_PRESSED) {
         swap_hands_oneshot = SHO_ACTIVE;
+#        if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
+        if (has_oneshot_swaphands_timed_out()) {
+            clear_oneshot_swaphands();
+        }
+#        endif
     }
     if (swap_hands_oneshot == SHO_USED) {
         clear_oneshot_swaphands();
@@ -137,6 +194,8 @@ void clear_oneshot_swaphands(void) {
     swap_hands         = false;
 #        if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
     oneshot_swaphands_time = 0;
+    cancel_deferred_exec(oneshot_swaphands_token);
+    oneshot_swaphands_token = INVALID_DEFERRED_TOKEN;
 #        endif
 }
 
@@ -151,6 +210,9 @@ void set_oneshot_layer(uint8_t layer, uint8_t state) {
     layer_on(layer);
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
     oneshot_layer_time = timer_read();
+    if (!extend_deferred_exec(oneshot_layer_token, ONESHOT_TIMEOUT)) {
+        oneshot_layer_token = defer_exec(ONESHOT_TIMEOUT, oneshot_layer_timeout, NULL);
+    }
 #    endif
     oneshot_layer_changed_kb(get_oneshot_layer());
 }
@@ -162,6 +224,8 @@ void reset_oneshot_layer(void) {
     oneshot_layer_data = 0;
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
     oneshot_layer_time = 0;
+    cancel_deferred_exec(oneshot_layer_token);
+    oneshot_layer_token = INVALID_DEFERRED_TOKEN;
 #    endif
     oneshot_layer_changed_kb(get_oneshot_layer());
 }
@@ -189,23 +253,11 @@ bool is_oneshot_layer_active(void) { return get_oneshot_layer_state(); }
  * FIXME: needs doc
  */
 void send_keyboard_report(void) {
-    keyboard_report->mods = real_mods;
-    keyboard_report->mods |= weak_mods;
-    keyboard_report->mods |= macro_mods;
+    keyboard_report->mods = report_mods;
 #ifndef NO_ACTION_ONESHOT
-    if (oneshot_mods) {
-#    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-        if (has_oneshot_mods_timed_out()) {
-            dprintf("Oneshot: timeout\n");
-            clear_oneshot_mods();
-        }
-#    endif
-        keyboard_report->mods |= oneshot_mods;
-        if (has_anykey(keyboard_report)) {
-            clear_oneshot_mods();
-        }
+    if (oneshot_mods && has_anykey(keyboard_report)) {
+        clear_oneshot_mods();
     }
-
 #endif
     host_keyboard_send(keyboard_report);
 }
@@ -219,22 +271,34 @@ uint8_t get_mods(void) { return real_mods; }
  *
  * FIXME: needs doc
  */
-void add_mods(uint8_t mods) { real_mods |= mods; }
+void add_mods(uint8_t mods) {
+    real_mods |= mods;
+    update_report_mods();
+}
 /** \brief del mods
  *
  * FIXME: needs doc
  */
-void del_mods(uint8_t mods) { real_mods &= ~mods; }
+void del_mods(uint8_t mods) {
+    real_mods &= ~mods;
+    update_report_mods();
+}
 /** \brief set mods
  *
  * FIXME: needs doc
  */
-void set_mods(uint8_t mods) { real_mods = mods; }
+void set_mods(uint8_t mods) {
+    real_mods = mods;
+    update_report_mods();
+}
 /** \brief clear mods
  *
  * FIXME: needs doc
  */
-void clear_mods(void) { real_mods = 0; }
+void clear_mods(void) {
+    real_mods = 0;
+    update_report_mods();
+}
 
 /** \brief get weak mods
  *
@@ -245,22 +309,34 @@ uint8_t get_weak_mods(void) { return weak_mods; }
  *
  * FIXME: needs doc
  */
-void add_weak_mods(uint8_t mods) { weak_mods |= mods; }
+void add_weak_mods(uint8_t mods) {
+    weak_mods |= mods;
+    update_report_mods();
+}
 /** \brief del weak mods
  *
  * FIXME: needs doc
  */
-void del_weak_mods(uint8_t mods) { weak_mods &= ~mods; }
+void del_weak_mods(uint8_t mods) {
+    weak_mods &= ~mods;
+    update_report_mods();
+}
 /** \brief set weak mods
  *
  * FIXME: needs doc
  */
-void set_weak_mods(uint8_t mods) { weak_mods = mods; }
+void set_weak_mods(uint8_t mods) {
+    weak_mods = mods;
+    update_report_mods();
+}
 /** \brief clear weak mods
  *
  * FIXME: needs doc
  */
-void clear_weak_mods(void) { weak_mods = 0; }
+void clear_weak_mods(void) {
+    weak_mods = 0;
+    update_report_mods();
+}
 
 /* macro modifier */
 /** \brief get macro mods
@@ -272,22 +348,34 @@ uint8_t get_macro_mods(void) { return macro_mods; }
  *
  * FIXME: needs doc
  */
-void add_macro_mods(uint8_t mods) { macro_mods |= mods; }
+void add_macro_mods(uint8_t mods) {
+    macro_mods |= mods;
+    update_report_mods();
+}
 /** \brief del macro mods
  *
  * FIXME: needs doc
  */
-void del_macro_mods(uint8_t mods) { macro_mods &= ~mods; }
+void del_macro_mods(uint8_t mods) {
+    macro_mods &= ~mods;
+    update_report_mods();
+}
 /** \brief set macro mods
  *
  * FIXME: needs doc
  */
-void set_macro_mods(uint8_t mods) { macro_mods = mods; }
+void set_macro_mods(uint8_t mods) {
+    macro_mods = mods;
+    update_report_mods();
+}
 /** \brief clear macro mods
  *
  * FIXME: needs doc
  */
-void clear_macro_mods(void) { macro_mods = 0; }
+void clear_macro_mods(void) {
+    macro_mods = 0;
+    update_report_mods();
+}
 
 #ifndef NO_ACTION_ONESHOT
 /** \brief get oneshot mods
@@ -298,10 +386,11 @@ uint8_t get_oneshot_mods(void) { return oneshot_mods; }
 
 void add_oneshot_mods(uint8_t mods) {
     if ((oneshot_mods & mods) != mods) {
+        oneshot_mods |= mods;
+        update_report_mods();
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-        oneshot_time = timer_read();
+        oneshot_mods_timer_restart();
 #    endif
-        oneshot_mods |= mods;
         oneshot_mods_changed_kb(mods);
     }
 }
@@ -309,8 +398,9 @@ void add_oneshot_mods(uint8_t mods) {
 void del_oneshot_mods(uint8_t mods) {
     if (oneshot_mods & mods) {
         oneshot_mods &= ~mods;
+        update_report_mods();
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-        oneshot_time = oneshot_mods ? timer_read() : 0;
+        oneshot_mods_timer_restart();
 #    endif
         oneshot_mods_changed_kb(oneshot_mods);
     }
@@ -322,10 +412,11 @@ void del_oneshot_mods(uint8_t mods) {
  */
 void set_oneshot_mods(uint8_t mods) {
     if (oneshot_mods != mods) {
+        oneshot_mods = mods;
+        update_report_mods();
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-        oneshot_time = timer_read();
+        oneshot_mods_timer_restart();
 #    endif
-        oneshot_mods = mods;
         oneshot_mods_changed_kb(mods);
     }
 }
@@ -336,8 +427,9 @@ void set_oneshot_mods(uint8_t mods) {
 void clear_oneshot_mods(void) {
     if (oneshot_mods) {
         oneshot_mods = 0;
+        update_report_mods();
 #    if (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
-        oneshot_time = 0;
+        oneshot_mods_timer_restart();
 #    endif
         oneshot_mods_changed_kb(oneshot_mods);
     }
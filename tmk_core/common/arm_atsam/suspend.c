@@ -2,6 +2,7 @@
 #include "i2c_master.h"
 #include "md_rgb_matrix.h"
 #include "suspend.h"
+#include "event_bus.h"
 
 /** \brief Suspend idle
  *
@@ -27,6 +28,7 @@ __attribute__((weak)) void suspend_power_down_kb(void) { suspend_power_down_user
  * FIXME: needs doc
  */
 void suspend_power_down(void) {
+    event_bus_suspend(true);
 #ifdef RGB_MATRIX_ENABLE
     I2C3733_Control_Set(0);  // Disable LED driver
 #endif
@@ -73,5 +75,6 @@ void suspend_wakeup_init(void) {
 #    endif
 #endif
 
+    event_bus_suspend(false);
     suspend_wakeup_init_kb();
 }
@@ -32,3 +32,10 @@ typedef uint8_t pin_t;
 #define readPin(pin) ((bool)(PINx_ADDRESS(pin) & _BV((pin)&0xF)))
 
 #define togglePin(pin) (PORTx_ADDRESS(pin) ^= _BV((pin)&0xF))
+
+typedef uint8_t port_data_t;
+
+// Reads every pin of the port the given pin belongs to in one access
+#define readPinPort(pin) (PINx_ADDRESS(pin))
+#define getPinPad(pin) ((pin)&0xF)
+#define samePinPort(pin_a, pin_b) (((pin_a) >> PORT_SHIFTER) == ((pin_b) >> PORT_SHIFTER))
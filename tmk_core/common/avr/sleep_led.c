@@ -1,7 +1,7 @@
 #include <stdint.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
-#include <avr/pgmspace.h>
+#include "progmem.h"
 #include "led.h"
 #include "sleep_led.h"
 
@@ -93,7 +93,7 @@ void sleep_led_toggle(void) {
  * https://www.wolframalpha.com/input/?i=sin%28x%2F64*pi%29**8+*+255%2C+x%3D0+to+63
  * (0..63).each {|x| p ((sin(x/64.0*PI)**8)*255).to_i }
  */
-static const uint8_t breathing_table[64] PROGMEM = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 6, 10, 15, 23, 32, 44, 58, 74, 93, 113, 135, 157, 179, 199, 218, 233, 245, 252, 255, 252, 245, 233, 218, 199, 179, 157, 135, 113, 93, 74, 58, 44, 32, 23, 15, 10, 6, 4, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t breathing_table[64] HOT_TABLE(SLEEP_LED_BREATHING) = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 6, 10, 15, 23, 32, 44, 58, 74, 93, 113, 135, 157, 179, 199, 218, 233, 245, 252, 255, 252, 245, 233, 218, 199, 179, 157, 135, 113, 93, 74, 58, 44, 32, 23, 15, 10, 6, 4, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
 ISR(TIMERx_COMPA_vect) {
     /* Software PWM
@@ -118,7 +118,7 @@ ISR(TIMERx_COMPA_vect) {
         led_set(1 << USB_LED_CAPS_LOCK);
     }
     // LED off
-    if (timer.pwm.count == pgm_read_byte(&breathing_table[timer.pwm.index])) {
+    if (timer.pwm.count == hot_read_byte(SLEEP_LED_BREATHING, &breathing_table[timer.pwm.index])) {
         led_set(0);
     }
 }
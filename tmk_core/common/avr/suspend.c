@@ -8,6 +8,7 @@
 #include "timer.h"
 #include "led.h"
 #include "host.h"
+#include "event_bus.h"
 
 #ifdef PROTOCOL_LUFA
 #    include "lufa.h"
@@ -28,6 +29,10 @@
 #    include "rgblight.h"
 #endif
 
+#if defined(EEPROM_DRIVER) && defined(EEPROM_WRITE_BACK)
+#    include "eeprom_driver.h"
+#endif
+
 /** \brief Suspend idle
  *
  * FIXME: needs doc
@@ -127,6 +132,12 @@ void suspend_power_down(void) {
 #ifdef PROTOCOL_VUSB
     if (!vusb_suspended) return;
 #endif
+    event_bus_suspend(true);
+
+#if defined(EEPROM_DRIVER) && defined(EEPROM_WRITE_BACK)
+    // Power may go away while suspended
+    eeprom_driver_flush();
+#endif
 
     suspend_power_down_kb();
 
@@ -208,6 +219,7 @@ void suspend_wakeup_init(void) {
     rgblight_wakeup();
 #endif
 
+    event_bus_suspend(false);
     suspend_wakeup_init_kb();
 }
 
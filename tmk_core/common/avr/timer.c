@@ -124,6 +124,29 @@ inline uint32_t timer_elapsed32(uint32_t last) {
     return TIMER_DIFF_32(t, last);
 }
 
+/** \brief timer read microseconds
+ *
+ * The milliseconds counted by the interrupt plus how far Timer0 has got into the current one. Wraps every 71 minutes.
+ */
+uint32_t timer_read_us(void) {
+    uint32_t t;
+    uint8_t  raw;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        t   = timer_count;
+        raw = TIMER_RAW;
+        if (TIMER_COMPARE_PENDING() && raw < TIMER_RAW_TOP / 2) {
+            t++;
+        }
+    }
+
+    return t * 1000 + TIMER_RAW_TO_US(raw);
+}
+
+/** \brief timer elapsed microseconds
+ */
+uint32_t timer_elapsed_us(uint32_t last) { return TIMER_DIFF_32(timer_read_us(), last); }
+
 // excecuted once per 1ms.(excess for just timer count?)
 #ifndef __AVR_ATmega32A__
 #    define TIMER_INTERRUPT_VECTOR TIMER0_COMPA_vect
@@ -37,3 +37,19 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #if (TIMER_RAW_TOP > 255)
 #    error "Timer0 can't count 1ms at this clock freq. Use larger prescaler."
 #endif
+
+// The counter started over but the compare interrupt hasn't run yet
+#if defined(__AVR_ATmega32A__)
+#    define TIMER_COMPARE_PENDING() (TIFR & _BV(OCF0))
+#elif defined(__AVR_ATtiny85__)
+#    define TIMER_COMPARE_PENDING() (TIFR & _BV(OCF0A))
+#else
+#    define TIMER_COMPARE_PENDING() (TIFR0 & _BV(OCF0A))
+#endif
+
+// Microseconds into the current millisecond, a multiply at the usual 8 and 16 MHz
+#if 1000 % (TIMER_RAW_TOP + 1) == 0
+#    define TIMER_RAW_TO_US(raw) ((uint16_t)(raw) * (1000 / (TIMER_RAW_TOP + 1)))
+#else
+#    define TIMER_RAW_TO_US(raw) ((uint16_t)(raw) * 1000 / (TIMER_RAW_TOP + 1))
+#endif
@@ -12,6 +12,24 @@
 
 keymap_config_t keymap_config;
 
+// Provided by matrix_common.c, custom matrices may not have it
+extern bool peek_matrix(uint8_t row_index, uint8_t col_index, bool read_raw) __attribute__((weak));
+
+// Whether any key reads as pressed on a single scan, before debouncing
+static bool bootmagic_any_raw_key(void) {
+    if (!peek_matrix) {
+        return true;
+    }
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (peek_matrix(row, col, true)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 /** \brief Bootmagic
  *
  * FIXME: needs doc
@@ -22,6 +40,12 @@ void bootmagic(void) {
         eeconfig_init();
     }
 
+    /* nothing held down on power up, skip the scans in case of bounce */
+    matrix_scan();
+    if (!bootmagic_any_raw_key()) {
+        return;
+    }
+
     /* do scans in case of bounce */
     print("bootmagic scan: ... ");
     uint8_t scan = 100;
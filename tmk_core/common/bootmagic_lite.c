@@ -12,20 +12,14 @@ __attribute__((weak)) void bootmagic_lite_reset_eeprom(void) {
 #endif
 }
 
+// Provided by matrix_common.c, custom matrices may not have it
+extern bool peek_matrix(uint8_t row_index, uint8_t col_index, bool read_raw) __attribute__((weak));
+
 /** \brief The lite version of TMK's bootmagic based on Wilba.
  *
  *  100% less potential for accidentally making the keyboard do stupid things.
  */
 __attribute__((weak)) void bootmagic_lite(void) {
-    // We need multiple scans because debouncing can't be turned off.
-    matrix_scan();
-#if defined(DEBOUNCE) && DEBOUNCE > 0
-    wait_ms(DEBOUNCE * 2);
-#else
-    wait_ms(30);
-#endif
-    matrix_scan();
-
     // If the configured key (commonly Esc) is held down on power up,
     // reset the EEPROM valid state and jump to bootloader.
     // This isn't very generalized, but we need something that doesn't
@@ -40,6 +34,21 @@ __attribute__((weak)) void bootmagic_lite(void) {
     }
 #endif
 
+    matrix_scan();
+
+    // Nothing to debounce if the key doesn't read as pressed, which spares the usual boot the wait
+    if (peek_matrix && !peek_matrix(row, col, true)) {
+        return;
+    }
+
+    // We need multiple scans because debouncing can't be turned off.
+#if defined(DEBOUNCE) && DEBOUNCE > 0
+    wait_ms(DEBOUNCE * 2);
+#else
+    wait_ms(30);
+#endif
+    matrix_scan();
+
     if (matrix_get_row(row) & (1 << col)) {
         bootmagic_lite_reset_eeprom();
 
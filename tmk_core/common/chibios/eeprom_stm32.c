@@ -24,16 +24,64 @@
  * the functionality use the EEPROM_Init() function. Be sure that by reprogramming
  * of the controller just affected pages will be deleted. In other case the non
  * volatile data will be lost.
+ *
+ * The reserved pages hold a compacted image of the whole EEPROM followed by a
+ * write log. A write only appends an (address, value) record to the log, and
+ * the pages are erased and the image rewritten only once the log is full.
+ * Word and block writes put two neighbouring bytes in one record, marked with
+ * FEE_RECORD_PAIR, where a byte write takes a record each.
+ * Reads are served from a RAM copy that EEPROM_Init() rebuilds from the image
+ * and the log.
  ******************************************************************************/
 
 /* Private macro -------------------------------------------------------------*/
+#define FEE_RECORD_ADDRESS(slot) (FEE_LOG_BASE_ADDRESS + (slot)*FEE_RECORD_SIZE)
+#define FEE_RECORD_KEY(slot) (*(__IO uint16_t *)FEE_RECORD_ADDRESS(slot))
+#define FEE_RECORD_VALUE(slot) (*(__IO uint16_t *)(FEE_RECORD_ADDRESS(slot) + 2))
+
 /* Private variables ---------------------------------------------------------*/
+static uint8_t  DataBuf[FEE_DENSITY_BYTES + 1];
+static uint16_t NextRecord;
+
 /* Functions -----------------------------------------------------------------*/
 
-uint8_t DataBuf[FEE_PAGE_SIZE];
+static bool EEPROM_IsBlank(void) {
+    for (uint32_t address = FEE_PAGE_BASE_ADDRESS; address < FEE_LAST_PAGE_ADDRESS; address += 2) {
+        if (*(__IO uint16_t *)address != FEE_EMPTY_WORD) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*****************************************************************************
+ *  Erase the reserved pages and write DataBuf back as the compacted image,
+ *  leaving the whole log free. The magic word goes first so that a power loss
+ *  half way is not mistaken for the old one byte per halfword layout.
+ ******************************************************************************/
+static FLASH_Status EEPROM_Compact(void) {
+    FLASH_Status FlashStatus = FLASH_COMPLETE;
+
+    for (int page_num = 0; page_num < FEE_DENSITY_PAGES; page_num++) {
+        FlashStatus = FLASH_ErasePage(FEE_PAGE_BASE_ADDRESS + (page_num * FEE_PAGE_SIZE));
+    }
+    FlashStatus = FLASH_ProgramHalfWord(FEE_RECORD_ADDRESS(0), FEE_MAGIC_WORD);
+
+    for (uint16_t i = 0; i < sizeof(DataBuf); i += 4) {
+        uint32_t value;
+        memcpy(&value, &DataBuf[i], sizeof(value));
+        if (value != 0xFFFFFFFF) {
+            FlashStatus = FLASH_ProgramWord(FEE_PAGE_BASE_ADDRESS + i, value);
+        }
+    }
+    NextRecord = 1;
+
+    return FlashStatus;
+}
+
 /*****************************************************************************
- *  Delete Flash Space used for user Data, deletes the whole space between
- *  RW_PAGE_BASE_ADDRESS and the last uC Flash Page
+ *  Unlock the flash and load the EEPROM contents into RAM: the compacted
+ *  image first, then every complete record of the write log on top.
  ******************************************************************************/
 uint16_t EEPROM_Init(void) {
     // unlock flash
@@ -42,65 +90,107 @@ uint16_t EEPROM_Init(void) {
     // Clear Flags
     // FLASH_ClearFlag(FLASH_SR_EOP|FLASH_SR_PGERR|FLASH_SR_WRPERR);
 
+    if (FEE_RECORD_KEY(0) == FEE_MAGIC_WORD) {
+        memcpy(DataBuf, (uint8_t *)FEE_PAGE_BASE_ADDRESS, sizeof(DataBuf));
+
+        for (NextRecord = 1; NextRecord < FEE_LOG_RECORDS; NextRecord++) {
+            uint16_t key   = FEE_RECORD_KEY(NextRecord);
+            uint16_t value = FEE_RECORD_VALUE(NextRecord);
+            if (key == FEE_EMPTY_WORD) {
+                // A record cut short after its value but before its address can't be programmed again
+                if (value == FEE_EMPTY_WORD) {
+                    break;
+                }
+            } else if (key & FEE_RECORD_PAIR) {
+                // The address is programmed last, so the value is complete even when it reads as erased
+                key &= ~FEE_RECORD_PAIR;
+                if (key < FEE_DENSITY_BYTES) {
+                    DataBuf[key]     = (uint8_t)value;
+                    DataBuf[key + 1] = (uint8_t)(value >> 8);
+                }
+            } else if (key <= FEE_DENSITY_BYTES && value != FEE_EMPTY_WORD) {
+                // A byte record of an older log whose value never got programmed was cut short by a power loss
+                DataBuf[key] = (uint8_t)value;
+            }
+        }
+    } else if (EEPROM_IsBlank()) {
+        memset(DataBuf, 0xFF, sizeof(DataBuf));
+        FLASH_ProgramHalfWord(FEE_RECORD_ADDRESS(0), FEE_MAGIC_WORD);
+        NextRecord = 1;
+    } else {
+        // Written by the previous driver, which kept one byte in the low half of every halfword
+        for (uint16_t i = 0; i < sizeof(DataBuf); i++) {
+            DataBuf[i] = *(__IO uint8_t *)(FEE_PAGE_BASE_ADDRESS + i * 2);
+        }
+        EEPROM_Compact();
+    }
+
     return FEE_DENSITY_BYTES;
 }
 /*****************************************************************************
  *  Erase the whole reserved Flash Space used for user Data
  ******************************************************************************/
 void EEPROM_Erase(void) {
-    int page_num = 0;
-
-    // delete all pages from specified start page to the last page
-    do {
-        FLASH_ErasePage(FEE_PAGE_BASE_ADDRESS + (page_num * FEE_PAGE_SIZE));
-        page_num++;
-    } while (page_num < FEE_DENSITY_PAGES);
+    memset(DataBuf, 0xFF, sizeof(DataBuf));
+    EEPROM_Compact();
 }
 /*****************************************************************************
- *  Writes once data byte to flash on specified address. If a byte is already
- *  written, the whole page must be copied to a buffer, the byte changed and
- *  the manipulated buffer written after PageErase.
- *******************************************************************************/
-uint16_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte) {
+ *  Append a record to the write log, or compact DataBuf, which already holds
+ *  the new data, into a fresh image when the log runs out of room.
+ ******************************************************************************/
+static FLASH_Status EEPROM_AppendRecord(uint16_t Key, uint16_t Value) {
     FLASH_Status FlashStatus = FLASH_COMPLETE;
 
-    uint32_t page;
-    int      i;
+    if (NextRecord >= FEE_LOG_RECORDS) {
+        return EEPROM_Compact();
+    }
+
+    // The address goes in last, a record only counts once it is programmed
+    FlashStatus = FLASH_ProgramHalfWord(FEE_RECORD_ADDRESS(NextRecord) + 2, Value);
+    if (FlashStatus == FLASH_COMPLETE) {
+        FlashStatus = FLASH_ProgramHalfWord(FEE_RECORD_ADDRESS(NextRecord), Key);
+    }
+    NextRecord++;
 
+    return FlashStatus;
+}
+/*****************************************************************************
+ *  Writes once data byte to flash on specified address. Unchanged bytes are
+ *  skipped, anything else is appended to the write log.
+ *******************************************************************************/
+uint16_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte) {
     // exit if desired address is above the limit (e.G. under 2048 Bytes for 4 pages)
     if (Address > FEE_DENSITY_BYTES) {
         return 0;
     }
 
-    // calculate which page is affected (Pagenum1/Pagenum2...PagenumN)
-    page = FEE_ADDR_OFFSET(Address) / FEE_PAGE_SIZE;
-
-    // if current data is 0xFF, the byte is empty, just overwrite with the new one
-    if ((*(__IO uint16_t *)(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address))) == FEE_EMPTY_WORD) {
-        FlashStatus = FLASH_ProgramHalfWord(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address), (uint16_t)(0x00FF & DataByte));
-    } else {
-        // Copy Page to a buffer
-        memcpy(DataBuf, (uint8_t *)FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE), FEE_PAGE_SIZE);  // !!! Calculate base address for the desired page
-
-        // check if new data is differ to current data, return if not, proceed if yes
-        if (DataByte == *(__IO uint8_t *)(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address))) {
-            return 0;
-        }
-
-        // manipulate desired data byte in temp data array if new byte is differ to the current
-        DataBuf[FEE_ADDR_OFFSET(Address) % FEE_PAGE_SIZE] = DataByte;
+    // check if new data is differ to current data, return if not, proceed if yes
+    if (DataBuf[Address] == DataByte) {
+        return 0;
+    }
+    DataBuf[Address] = DataByte;
 
-        // Erase Page
-        FlashStatus = FLASH_ErasePage(FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE));
+    return EEPROM_AppendRecord(Address, DataByte);
+}
+/*****************************************************************************
+ *  Writes two data bytes, low byte first, from the specified address. When
+ *  both change they share a single record of the write log.
+ *******************************************************************************/
+uint16_t EEPROM_WriteDataWord(uint16_t Address, uint16_t DataWord) {
+    if (Address >= FEE_DENSITY_BYTES) {
+        return EEPROM_WriteDataByte(Address, (uint8_t)DataWord);
+    }
 
-        // Write new data (whole page) to flash if data has been changed
-        for (i = 0; i < (FEE_PAGE_SIZE / 2); i++) {
-            if ((__IO uint16_t)(0xFF00 | DataBuf[FEE_ADDR_OFFSET(i)]) != 0xFFFF) {
-                FlashStatus = FLASH_ProgramHalfWord((FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE)) + (i * 2), (uint16_t)(0xFF00 | DataBuf[FEE_ADDR_OFFSET(i)]));
-            }
-        }
+    if (DataBuf[Address] == (uint8_t)DataWord) {
+        return EEPROM_WriteDataByte(Address + 1, (uint8_t)(DataWord >> 8));
     }
-    return FlashStatus;
+    if (DataBuf[Address + 1] == (uint8_t)(DataWord >> 8)) {
+        return EEPROM_WriteDataByte(Address, (uint8_t)DataWord);
+    }
+    DataBuf[Address]     = (uint8_t)DataWord;
+    DataBuf[Address + 1] = (uint8_t)(DataWord >> 8);
+
+    return EEPROM_AppendRecord(Address | FEE_RECORD_PAIR, DataWord);
 }
 /*****************************************************************************
  *  Read once data byte from a specified address.
@@ -108,8 +198,10 @@ uint16_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte) {
 uint8_t EEPROM_ReadDataByte(uint16_t Address) {
     uint8_t DataByte = 0xFF;
 
-    // Get Byte from specified address
-    DataByte = (*(__IO uint8_t *)(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address)));
+    // Get Byte from the RAM copy of the EEPROM
+    if (Address <= FEE_DENSITY_BYTES) {
+        DataByte = DataBuf[Address];
+    }
 
     return DataByte;
 }
@@ -139,14 +231,12 @@ uint16_t eeprom_read_word(const uint16_t *Address) {
 
 void eeprom_write_word(uint16_t *Address, uint16_t Value) {
     uint16_t p = (uint32_t)Address;
-    EEPROM_WriteDataByte(p, (uint8_t)Value);
-    EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
+    EEPROM_WriteDataWord(p, Value);
 }
 
 void eeprom_update_word(uint16_t *Address, uint16_t Value) {
     uint16_t p = (uint32_t)Address;
-    EEPROM_WriteDataByte(p, (uint8_t)Value);
-    EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
+    EEPROM_WriteDataWord(p, Value);
 }
 
 uint32_t eeprom_read_dword(const uint32_t *Address) {
@@ -156,20 +246,16 @@ uint32_t eeprom_read_dword(const uint32_t *Address) {
 
 void eeprom_write_dword(uint32_t *Address, uint32_t Value) {
     uint16_t p = (const uint32_t)Address;
-    EEPROM_WriteDataByte(p, (uint8_t)Value);
-    EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
-    EEPROM_WriteDataByte(p + 2, (uint8_t)(Value >> 16));
-    EEPROM_WriteDataByte(p + 3, (uint8_t)(Value >> 24));
+    EEPROM_WriteDataWord(p, (uint16_t)Value);
+    EEPROM_WriteDataWord(p + 2, (uint16_t)(Value >> 16));
 }
 
 void eeprom_update_dword(uint32_t *Address, uint32_t Value) {
     uint16_t p             = (const uint32_t)Address;
     uint32_t existingValue = EEPROM_ReadDataByte(p) | (EEPROM_ReadDataByte(p + 1) << 8) | (EEPROM_ReadDataByte(p + 2) << 16) | (EEPROM_ReadDataByte(p + 3) << 24);
     if (Value != existingValue) {
-        EEPROM_WriteDataByte(p, (uint8_t)Value);
-        EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
-        EEPROM_WriteDataByte(p + 2, (uint8_t)(Value >> 16));
-        EEPROM_WriteDataByte(p + 3, (uint8_t)(Value >> 24));
+        EEPROM_WriteDataWord(p, (uint16_t)Value);
+        EEPROM_WriteDataWord(p + 2, (uint16_t)(Value >> 16));
     }
 }
 
@@ -182,17 +268,23 @@ void eeprom_read_block(void *buf, const void *addr, size_t len) {
 }
 
 void eeprom_write_block(const void *buf, void *addr, size_t len) {
-    uint8_t *      p   = (uint8_t *)addr;
+    uint16_t       p   = (uint32_t)addr;
     const uint8_t *src = (const uint8_t *)buf;
-    while (len--) {
-        eeprom_write_byte(p++, *src++);
+    for (; len >= 2; len -= 2, p += 2, src += 2) {
+        EEPROM_WriteDataWord(p, src[0] | (src[1] << 8));
+    }
+    if (len) {
+        EEPROM_WriteDataByte(p, *src);
     }
 }
 
 void eeprom_update_block(const void *buf, void *addr, size_t len) {
-    uint8_t *      p   = (uint8_t *)addr;
+    uint16_t       p   = (uint32_t)addr;
     const uint8_t *src = (const uint8_t *)buf;
-    while (len--) {
-        eeprom_write_byte(p++, *src++);
+    for (; len >= 2; len -= 2, p += 2, src += 2) {
+        EEPROM_WriteDataWord(p, src[0] | (src[1] << 8));
+    }
+    if (len) {
+        EEPROM_WriteDataByte(p, *src);
     }
 }
@@ -17,7 +17,7 @@
  *
  * This library assumes 8-bit data locations. To add a new MCU, please provide the flash
  * page size and the total flash size in Kb. The number of available pages must be a multiple
- * of 2. Only half of the pages account for the total EEPROM size.
+ * of 2. Half of the pages hold the compacted EEPROM contents, the other half the write log.
  * This library also assumes that the pages are not used by the firmware.
  */
 
@@ -75,10 +75,16 @@
 #define FEE_DENSITY_BYTES ((FEE_PAGE_SIZE / 2) * FEE_DENSITY_PAGES - 1)
 #define FEE_LAST_PAGE_ADDRESS (FEE_PAGE_BASE_ADDRESS + (FEE_PAGE_SIZE * FEE_DENSITY_PAGES))
 #define FEE_EMPTY_WORD ((uint16_t)0xFFFF)
-#define FEE_ADDR_OFFSET(Address) (Address * 2)  // 1Byte per Word will be saved to preserve Flash
+// The compacted image stores two bytes per halfword, the write log after it one or two bytes per 4 byte record
+#define FEE_LOG_BASE_ADDRESS (FEE_PAGE_BASE_ADDRESS + FEE_DENSITY_BYTES + 1)
+#define FEE_RECORD_SIZE 4
+#define FEE_LOG_RECORDS ((FEE_LAST_PAGE_ADDRESS - FEE_LOG_BASE_ADDRESS) / FEE_RECORD_SIZE)  // the first one holds FEE_MAGIC_WORD
+#define FEE_MAGIC_WORD ((uint16_t)0xFEE1)                                               // never a valid address
+#define FEE_RECORD_PAIR ((uint16_t)0x8000)                                              // set in the address of a record holding two bytes
 
 // Use this function to initialize the functionality
 uint16_t EEPROM_Init(void);
 void     EEPROM_Erase(void);
 uint16_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte);
+uint16_t EEPROM_WriteDataWord(uint16_t Address, uint16_t DataWord);
 uint8_t  EEPROM_ReadDataByte(uint16_t Address);
@@ -155,6 +155,39 @@ FLASH_Status FLASH_ProgramHalfWord(uint32_t Address, uint16_t Data) {
     return status;
 }
 
+/**
+ * @brief  Programs a word at a specified address. These families program half
+ *   words, so it goes in as two, low half first, without leaving PG mode.
+ * @param  Address: specifies the address to be programmed.
+ * @param  Data: specifies the data to be programmed.
+ * @retval FLASH Status: The returned value can be: FLASH_ERROR_PG,
+ *   FLASH_ERROR_WRP, FLASH_COMPLETE or FLASH_TIMEOUT.
+ */
+FLASH_Status FLASH_ProgramWord(uint32_t Address, uint32_t Data) {
+    FLASH_Status status = FLASH_BAD_ADDRESS;
+
+    if (IS_FLASH_ADDRESS(Address)) {
+        /* Wait for last operation to be completed */
+        status = FLASH_WaitForLastOperation(ProgramTimeout);
+        if (status == FLASH_COMPLETE) {
+            /* if the previous operation is completed, proceed to program the new data */
+            FLASH->CR |= FLASH_CR_PG;
+            *(__IO uint16_t*)Address = (uint16_t)Data;
+            status = FLASH_WaitForLastOperation(ProgramTimeout);
+            if (status == FLASH_COMPLETE) {
+                *(__IO uint16_t*)(Address + 2) = (uint16_t)(Data >> 16);
+                status = FLASH_WaitForLastOperation(ProgramTimeout);
+            }
+            if (status != FLASH_TIMEOUT) {
+                /* if the program operation is completed, disable the PG Bit */
+                FLASH->CR &= ~FLASH_CR_PG;
+            }
+            FLASH->SR = (FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPERR);
+        }
+    }
+    return status;
+}
+
 /**
  * @brief  Unlocks the FLASH Program Erase Controller.
  * @param  None
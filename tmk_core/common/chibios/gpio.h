@@ -32,3 +32,10 @@ typedef ioline_t pin_t;
 #define readPin(pin) palReadLine(pin)
 
 #define togglePin(pin) palToggleLine(pin)
+
+typedef ioportmask_t port_data_t;
+
+// Reads every pin of the port the given pin belongs to in one access
+#define readPinPort(pin) palReadPort(PAL_PORT(pin))
+#define getPinPad(pin) PAL_PAD(pin)
+#define samePinPort(pin_a, pin_b) (PAL_PORT(pin_a) == PAL_PORT(pin_b))
@@ -3,7 +3,9 @@
 #include <ch.h>
 #include <hal.h>
 
+#include <string.h>
 #include "matrix.h"
+#include "keyboard.h"
 #include "action.h"
 #include "action_util.h"
 #include "mousekey.h"
@@ -11,6 +13,7 @@
 #include "suspend.h"
 #include "led.h"
 #include "wait.h"
+#include "event_bus.h"
 
 #ifdef AUDIO_ENABLE
 #    include "audio.h"
@@ -24,6 +27,10 @@
 #    include "rgblight.h"
 #endif
 
+#if defined(EEPROM_DRIVER) && defined(EEPROM_WRITE_BACK)
+#    include "eeprom_driver.h"
+#endif
+
 /** \brief suspend idle
  *
  * FIXME: needs doc
@@ -33,6 +40,43 @@ void suspend_idle(uint8_t time) {
     wait_ms(time);
 }
 
+#ifdef SUSPEND_STOP_MODE
+#    if !defined(STM32F0XX) && !defined(STM32F1XX) && !defined(STM32F3XX) && !defined(STM32F4XX)
+#        error "SUSPEND_STOP_MODE is only implemented for STM32F0, F1, F3 and F4"
+#    endif
+// EXTI line of the USB wakeup event, 18 on all of the above
+#    ifndef SUSPEND_STOP_USB_WAKEUP_LINE
+#        define SUSPEND_STOP_USB_WAKEUP_LINE 18
+#    endif
+
+/* Stops the MCU until a key press (see matrix_power_down()) or resume
+ * signalling from the host. All clocks but the low speed ones are off
+ * meanwhile, and waking up from STOP leaves the MCU on HSI, so the clock
+ * tree is set up again before anything else runs.
+ */
+static void suspend_stop(void) {
+    matrix_power_down();
+
+    chSysLock();
+    EXTI->RTSR |= 1U << SUSPEND_STOP_USB_WAKEUP_LINE;
+    EXTI->EMR |= 1U << SUSPEND_STOP_USB_WAKEUP_LINE;
+    PWR->CR &= ~PWR_CR_PDDS;
+    PWR->CR |= PWR_CR_LPDS;
+    // Interrupts are masked, so a pending one has to raise the wakeup event instead
+    SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk | SCB_SCR_SEVONPEND_Msk;
+    __SEV();
+    __WFE();  // clears the event register
+    __WFE();
+    SCB->SCR &= ~(SCB_SCR_SLEEPDEEP_Msk | SCB_SCR_SEVONPEND_Msk);
+    EXTI->EMR &= ~(1U << SUSPEND_STOP_USB_WAKEUP_LINE);
+    EXTI->PR = 1U << SUSPEND_STOP_USB_WAKEUP_LINE;
+    stm32_clock_init();
+    chSysUnlock();
+
+    matrix_power_up();
+}
+#endif
+
 /** \brief Run keyboard level Power down
  *
  * FIXME: needs doc
@@ -49,6 +93,11 @@ __attribute__((weak)) void suspend_power_down_kb(void) { suspend_power_down_user
  * FIXME: needs doc
  */
 void suspend_power_down(void) {
+    event_bus_suspend(true);
+#if defined(EEPROM_DRIVER) && defined(EEPROM_WRITE_BACK)
+    // Power may go away while suspended
+    eeprom_driver_flush();
+#endif
 #ifdef BACKLIGHT_ENABLE
     backlight_set(0);
 #endif
@@ -77,23 +126,49 @@ void suspend_power_down(void) {
     // on AVR, this enables the watchdog for 15ms (max), and goes to
     // SLEEP_MODE_PWR_DOWN
 
+#ifdef SUSPEND_STOP_MODE
+    suspend_stop();
+#else
     wait_ms(17);
+#endif
 }
 
 /** \brief suspend wakeup condition
  *
- * FIXME: needs doc
+ * Called in a loop while suspended, so it only probes for a key first and
+ * runs the full, debounced scan once there is one.
  */
+// Every key seen down while suspended, see suspend_wakeup_replay()
+static matrix_row_t wakeup_matrix[MATRIX_ROWS];
+
 __attribute__((weak)) void matrix_power_up(void) {}
 __attribute__((weak)) void matrix_power_down(void) {}
-bool                       suspend_wakeup_condition(void) {
+
+// Matrices without a probe of their own are scanned every time
+__attribute__((weak)) bool matrix_any_key_down(void) { return true; }
+
+bool suspend_wakeup_condition(void) {
+    if (!matrix_any_key_down()) return false;
     matrix_power_up();
     matrix_scan();
     matrix_power_down();
+    bool wakeup = false;
     for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
-        if (matrix_get_row(r)) return true;
+        matrix_row_t row = matrix_get_row(r);
+        wakeup_matrix[r] |= row;
+        if (row) wakeup = true;
     }
-    return false;
+    return wakeup;
+}
+
+/** \brief Taps the keys that were pressed and released again while the host was resuming
+ *
+ * suspend_wakeup_condition() keeps scanning until the host is back, so the key that woke it up
+ * is not lost when it is released before then. Keys still held are left to the next scan.
+ */
+void suspend_wakeup_replay(void) {
+    keyboard_replay_keys(wakeup_matrix);
+    memset(wakeup_matrix, 0, sizeof(wakeup_matrix));
 }
 
 /** \brief run user level code immediately after wakeup
@@ -131,11 +206,13 @@ void suspend_wakeup_init(void) {
     host_consumer_send(0);
 #endif /* EXTRAKEY_ENABLE */
 #ifdef BACKLIGHT_ENABLE
-    backlight_init();
+    // From the settings in RAM, they have not changed while suspended
+    backlight_set(is_backlight_enabled() ? get_backlight_level() : 0);
 #endif /* BACKLIGHT_ENABLE */
     led_set(host_keyboard_leds());
 #if defined(RGBLIGHT_SLEEP) && defined(RGBLIGHT_ENABLE)
     rgblight_wakeup();
 #endif
+    event_bus_suspend(false);
     suspend_wakeup_init_kb();
 }
@@ -1,4 +1,5 @@
 #include <ch.h>
+#include <hal.h>
 
 #include "timer.h"
 
@@ -8,9 +9,56 @@ static uint32_t last_systime = 0;
 static uint32_t overflow     = 0;
 #endif
 
-void timer_init(void) { timer_clear(); }
+#if defined(CORTEX_MODEL) && CORTEX_MODEL >= 3
+#    if defined(STM32_SYSCLK)
+#        define TIMER_CORE_CLOCK STM32_SYSCLK
+#    elif defined(KINETIS_SYSCLK_FREQUENCY)
+#        define TIMER_CORE_CLOCK KINETIS_SYSCLK_FREQUENCY
+#    endif
+#endif
+#if defined(TIMER_CORE_CLOCK) && TIMER_CORE_CLOCK % 1000000 == 0
+// Microseconds are counted off the DWT cycle counter, which runs at the core clock
+#    define TIMER_US_DWT
+#    define TIMER_CYCLES_PER_US (TIMER_CORE_CLOCK / 1000000)
+// Often enough that the cycle counter never wraps between two updates, below 4.2 seconds even at 1 GHz
+#    define TIMER_US_REFRESH_INTERVAL 1000
+
+static uint32_t        us_cycles = 0;  // cycle count the microseconds were last brought up to
+static uint32_t        us_count  = 0;
+static virtual_timer_t us_refresh;
+
+static void timer_us_update(void) {
+    uint32_t us = (DWT->CYCCNT - us_cycles) / TIMER_CYCLES_PER_US;
+    // The cycles of an unfinished microsecond are kept for the next update
+    us_cycles += us * TIMER_CYCLES_PER_US;
+    us_count += us;
+}
+
+static void timer_us_refresh(void *arg) {
+    chSysLockFromISR();
+    timer_us_update();
+    chVTSetI(&us_refresh, TIME_MS2I(TIMER_US_REFRESH_INTERVAL), timer_us_refresh, NULL);
+    chSysUnlockFromISR();
+}
+#endif
+
+void timer_init(void) {
+#ifdef TIMER_US_DWT
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    chVTObjectInit(&us_refresh);
+    chVTSet(&us_refresh, TIME_MS2I(TIMER_US_REFRESH_INTERVAL), timer_us_refresh, NULL);
+#endif
+    timer_clear();
+}
 
 void timer_clear(void) {
+#ifdef TIMER_US_DWT
+    syssts_t status = chSysGetStatusAndLockX();
+    us_cycles       = DWT->CYCCNT;
+    us_count        = 0;
+    chSysRestoreStatusX(status);
+#endif
     reset_point = (uint32_t)chVTGetSystemTime();
 #if CH_CFG_ST_RESOLUTION < 32
     last_systime = reset_point;
@@ -18,9 +66,8 @@ void timer_clear(void) {
 #endif
 }
 
-uint16_t timer_read(void) { return (uint16_t)timer_read32(); }
-
-uint32_t timer_read32(void) {
+// System ticks since timer_clear()
+static uint32_t timer_read_ticks(void) {
     uint32_t systime = (uint32_t)chVTGetSystemTime();
 
 #if CH_CFG_ST_RESOLUTION < 32
@@ -36,12 +83,40 @@ uint32_t timer_read32(void) {
     }
 
     last_systime = systime;
-    return (uint32_t)TIME_I2MS(systime - reset_point + overflow);
+    return systime - reset_point + overflow;
 #else
-    return (uint32_t)TIME_I2MS(systime - reset_point);
+    return systime - reset_point;
+#endif
+}
+
+uint16_t timer_read(void) { return (uint16_t)timer_read32(); }
+
+uint32_t timer_read32(void) {
+#if CH_CFG_ST_FREQUENCY % 1000 == 0
+    // A 32 bit division by a constant, which compiles to a multiply, where TIME_I2MS() goes through 64 bits
+    return timer_read_ticks() / (CH_CFG_ST_FREQUENCY / 1000);
+#else
+    return (uint32_t)TIME_I2MS(timer_read_ticks());
 #endif
 }
 
 uint16_t timer_elapsed(uint16_t last) { return TIMER_DIFF_16(timer_read(), last); }
 
 uint32_t timer_elapsed32(uint32_t last) { return TIMER_DIFF_32(timer_read32(), last); }
+
+uint32_t timer_read_us(void) {
+#ifdef TIMER_US_DWT
+    syssts_t status = chSysGetStatusAndLockX();
+    timer_us_update();
+    uint32_t us = us_count;
+    chSysRestoreStatusX(status);
+    return us;
+#elif 1000000 % CH_CFG_ST_FREQUENCY == 0
+    // Only as fine as the system tick
+    return timer_read_ticks() * (1000000 / CH_CFG_ST_FREQUENCY);
+#else
+    return (uint32_t)TIME_I2US(timer_read_ticks());
+#endif
+}
+
+uint32_t timer_elapsed_us(uint32_t last) { return TIMER_DIFF_32(timer_read_us(), last); }
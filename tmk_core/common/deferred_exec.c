@@ -0,0 +1,165 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "deferred_exec.h"
+#include "timer.h"
+
+typedef struct {
+    deferred_token         token;
+    uint32_t               trigger_time;
+    deferred_exec_callback callback;
+    void *                 cb_arg;
+} deferred_executor_t;
+
+static deferred_executor_t executors[DEFERRED_EXEC_COUNT];
+static deferred_token      last_token   = INVALID_DEFERRED_TOKEN;
+static uint8_t             active_count = 0;
+static uint32_t            next_trigger = 0;  // earliest trigger time, valid while active_count > 0
+
+static deferred_executor_t *find_executor(deferred_token token) {
+    if (token == INVALID_DEFERRED_TOKEN) {
+        return NULL;
+    }
+    for (uint8_t i = 0; i < DEFERRED_EXEC_COUNT; i++) {
+        if (executors[i].token == token) {
+            return &executors[i];
+        }
+    }
+    return NULL;
+}
+
+/* Pulls the cached earliest trigger time forward if needed. Must be called
+ * before the new executor is counted in active_count. */
+static void schedule(uint32_t trigger_time, uint32_t now) {
+    if (active_count == 0 || (!timer_expired32(now, next_trigger) && trigger_time - now < next_trigger - now)) {
+        next_trigger = trigger_time;
+    }
+}
+
+/** \brief Runs a callback once the delay has passed.
+ *
+ * \param delay_ms The delay in milliseconds, must not be 0.
+ * \param callback Called from the main loop. Its return value is the delay until it runs again, 0 ends it.
+ * \param cb_arg Passed to the callback.
+ * \return A token for extend_deferred_exec() and cancel_deferred_exec(), or INVALID_DEFERRED_TOKEN if none
+ * of the DEFERRED_EXEC_COUNT slots is free.
+ */
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg) {
+    if (delay_ms == 0 || callback == NULL) {
+        return INVALID_DEFERRED_TOKEN;
+    }
+
+    deferred_executor_t *executor = NULL;
+    for (uint8_t i = 0; executor == NULL && i < DEFERRED_EXEC_COUNT; i++) {
+        if (executors[i].token == INVALID_DEFERRED_TOKEN) {
+            executor = &executors[i];
+        }
+    }
+    if (executor == NULL) {
+        return INVALID_DEFERRED_TOKEN;
+    }
+
+    // Tokens wrap around, skip the ones still held by long running executors.
+    do {
+        last_token++;
+    } while (last_token == INVALID_DEFERRED_TOKEN || find_executor(last_token) != NULL);
+
+    uint32_t now           = timer_read32();
+    executor->trigger_time = now + delay_ms;
+    executor->callback     = callback;
+    executor->cb_arg       = cb_arg;
+    schedule(executor->trigger_time, now);
+    executor->token = last_token;
+    active_count++;
+    return last_token;
+}
+
+/** \brief Reschedules a pending callback to run delay_ms from now.
+ *
+ * \return false if the token is not, or no longer, pending.
+ */
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms) {
+    deferred_executor_t *executor = find_executor(token);
+    if (executor == NULL || delay_ms == 0) {
+        return false;
+    }
+
+    uint32_t now           = timer_read32();
+    executor->trigger_time = now + delay_ms;
+    // A later trigger leaves the cached one early, which only costs one extra pass.
+    active_count--;
+    schedule(executor->trigger_time, now);
+    active_count++;
+    return true;
+}
+
+/** \brief Cancels a pending callback.
+ *
+ * \return false if the token is not, or no longer, pending.
+ */
+bool cancel_deferred_exec(deferred_token token) {
+    deferred_executor_t *executor = find_executor(token);
+    if (executor == NULL) {
+        return false;
+    }
+
+    executor->token = INVALID_DEFERRED_TOKEN;
+    active_count--;
+    return true;
+}
+
+/** \brief Runs the callbacks that are due. Called once per pass of the main loop.
+ */
+void deferred_exec_task(void) {
+    if (active_count == 0) {
+        return;
+    }
+
+    uint32_t now = timer_read32();
+    if (!timer_expired32(now, next_trigger)) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < DEFERRED_EXEC_COUNT; i++) {
+        deferred_executor_t *executor = &executors[i];
+        deferred_token       token    = executor->token;
+        if (token == INVALID_DEFERRED_TOKEN || !timer_expired32(now, executor->trigger_time)) {
+            continue;
+        }
+
+        uint32_t delay_ms = executor->callback(executor->trigger_time, executor->cb_arg);
+
+        // The callback may have cancelled or extended itself.
+        if (executor->token != token || !timer_expired32(now, executor->trigger_time)) {
+            continue;
+        }
+        if (delay_ms == 0) {
+            executor->token = INVALID_DEFERRED_TOKEN;
+            active_count--;
+        } else {
+            executor->trigger_time = now + delay_ms;
+        }
+    }
+
+    // Callbacks may have added executors too, so find the earliest trigger from scratch.
+    bool found = false;
+    for (uint8_t i = 0; i < DEFERRED_EXEC_COUNT; i++) {
+        if (executors[i].token != INVALID_DEFERRED_TOKEN && (!found || executors[i].trigger_time - now < next_trigger - now)) {
+            next_trigger = executors[i].trigger_time;
+            found        = true;
+        }
+    }
+}
@@ -0,0 +1,40 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Deferred execution: callbacks that run from the main loop once their delay
+ * has passed. The earliest trigger time is cached, so servicing costs a single
+ * comparison per pass while nothing is due. */
+
+#ifndef DEFERRED_EXEC_COUNT
+#    define DEFERRED_EXEC_COUNT 8
+#endif
+
+typedef uint8_t deferred_token;
+#define INVALID_DEFERRED_TOKEN 0
+
+/* Returns the delay until the next run in milliseconds, or 0 to stop. */
+typedef uint32_t (*deferred_exec_callback)(uint32_t trigger_time, void *cb_arg);
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg);
+bool           extend_deferred_exec(deferred_token token, uint32_t delay_ms);
+bool           cancel_deferred_exec(deferred_token token);
+void           deferred_exec_task(void);
@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "eeprom.h"
 #include "eeconfig.h"
 #include "action_layer.h"
@@ -17,6 +18,61 @@
 #    include "haptic.h"
 #endif
 
+#ifdef EECONFIG_CACHE
+/*
+ * A RAM copy of everything below EECONFIG_SIZE, read with a single block read
+ * the first time any of it is needed, so that loading the settings at boot
+ * doesn't cost one EEPROM transaction per field. Updates only reach the EEPROM
+ * for the bytes they actually change.
+ */
+static uint8_t eeconfig_cache[EECONFIG_SIZE];
+static bool    eeconfig_cache_loaded = false;
+
+static uint8_t *eeconfig_cache_at(const void *addr) {
+    if (!eeconfig_cache_loaded) {
+        eeprom_read_block(eeconfig_cache, (const void *)0, EECONFIG_SIZE);
+        eeconfig_cache_loaded = true;
+    }
+    return &eeconfig_cache[(uintptr_t)addr];
+}
+
+static void eeconfig_cache_update(const void *buf, void *addr, size_t len) {
+    uint8_t *cached = eeconfig_cache_at(addr);
+    if (memcmp(cached, buf, len) != 0) {
+        memcpy(cached, buf, len);
+        eeprom_update_block(buf, addr, len);
+    }
+}
+
+static uint8_t eeconfig_get_byte(const uint8_t *addr) { return *eeconfig_cache_at(addr); }
+static void    eeconfig_set_byte(uint8_t *addr, uint8_t val) { eeconfig_cache_update(&val, addr, sizeof(val)); }
+
+static uint16_t eeconfig_get_word(const uint16_t *addr) {
+    uint16_t val;
+    memcpy(&val, eeconfig_cache_at(addr), sizeof(val));
+    return val;
+}
+static void eeconfig_set_word(uint16_t *addr, uint16_t val) { eeconfig_cache_update(&val, addr, sizeof(val)); }
+
+static uint32_t eeconfig_get_dword(const uint32_t *addr) {
+    uint32_t val;
+    memcpy(&val, eeconfig_cache_at(addr), sizeof(val));
+    return val;
+}
+static void eeconfig_set_dword(uint32_t *addr, uint32_t val) { eeconfig_cache_update(&val, addr, sizeof(val)); }
+
+// After the EEPROM has been erased, the copy is read again the next time it's needed
+#    define eeconfig_cache_discard() (eeconfig_cache_loaded = false)
+#else
+#    define eeconfig_get_byte eeprom_read_byte
+#    define eeconfig_set_byte eeprom_update_byte
+#    define eeconfig_get_word eeprom_read_word
+#    define eeconfig_set_word eeprom_update_word
+#    define eeconfig_get_dword eeprom_read_dword
+#    define eeconfig_set_dword eeprom_update_dword
+#    define eeconfig_cache_discard()
+#endif
+
 /** \brief eeconfig enable
  *
  * FIXME: needs doc
@@ -41,32 +97,34 @@ void eeconfig_init_quantum(void) {
     EEPROM_Erase();
 #endif
 #if defined(EEPROM_DRIVER)
+    eeprom_driver_discard();
     eeprom_driver_erase();
 #endif
-    eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
-    eeprom_update_byte(EECONFIG_DEBUG, 0);
-    eeprom_update_byte(EECONFIG_DEFAULT_LAYER, 0);
+    eeconfig_cache_discard();
+    eeconfig_set_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
+    eeconfig_set_byte(EECONFIG_DEBUG, 0);
+    eeconfig_set_byte(EECONFIG_DEFAULT_LAYER, 0);
     default_layer_state = 0;
-    eeprom_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, 0);
-    eeprom_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, 0);
-    eeprom_update_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
-    eeprom_update_byte(EECONFIG_BACKLIGHT, 0);
-    eeprom_update_byte(EECONFIG_AUDIO, 0xFF);  // On by default
-    eeprom_update_dword(EECONFIG_RGBLIGHT, 0);
-    eeprom_update_byte(EECONFIG_STENOMODE, 0);
-    eeprom_update_dword(EECONFIG_HAPTIC, 0);
-    eeprom_update_byte(EECONFIG_VELOCIKEY, 0);
-    eeprom_update_dword(EECONFIG_RGB_MATRIX, 0);
-    eeprom_update_byte(EECONFIG_RGB_MATRIX_SPEED, 0);
+    eeconfig_set_byte(EECONFIG_KEYMAP_LOWER_BYTE, 0);
+    eeconfig_set_byte(EECONFIG_KEYMAP_UPPER_BYTE, 0);
+    eeconfig_set_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
+    eeconfig_set_byte(EECONFIG_BACKLIGHT, 0);
+    eeconfig_set_byte(EECONFIG_AUDIO, 0xFF);  // On by default
+    eeconfig_set_dword(EECONFIG_RGBLIGHT, 0);
+    eeconfig_set_byte(EECONFIG_STENOMODE, 0);
+    eeconfig_set_dword(EECONFIG_HAPTIC, 0);
+    eeconfig_set_byte(EECONFIG_VELOCIKEY, 0);
+    eeconfig_set_dword(EECONFIG_RGB_MATRIX, 0);
+    eeconfig_set_byte(EECONFIG_RGB_MATRIX_SPEED, 0);
 
     // TODO: Remove once ARM has a way to configure EECONFIG_HANDEDNESS
     //        within the emulated eeprom via dfu-util or another tool
 #if defined INIT_EE_HANDS_LEFT
 #    pragma message "Faking EE_HANDS for left hand"
-    eeprom_update_byte(EECONFIG_HANDEDNESS, 1);
+    eeconfig_set_byte(EECONFIG_HANDEDNESS, 1);
 #elif defined INIT_EE_HANDS_RIGHT
 #    pragma message "Faking EE_HANDS for right hand"
-    eeprom_update_byte(EECONFIG_HANDEDNESS, 0);
+    eeconfig_set_byte(EECONFIG_HANDEDNESS, 0);
 #endif
 
 #if defined(HAPTIC_ENABLE)
@@ -75,7 +133,7 @@ void eeconfig_init_quantum(void) {
     // this is used in case haptic is disabled, but we still want sane defaults
     // in the haptic configuration eeprom. All zero will trigger a haptic_reset
     // when a haptic-enabled firmware is loaded onto the keyboard.
-    eeprom_update_dword(EECONFIG_HAPTIC, 0);
+    eeconfig_set_dword(EECONFIG_HAPTIC, 0);
 #endif
 
     eeconfig_init_kb();
@@ -91,7 +149,7 @@ void eeconfig_init(void) { eeconfig_init_quantum(); }
  *
  * FIXME: needs doc
  */
-void eeconfig_enable(void) { eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER); }
+void eeconfig_enable(void) { eeconfig_set_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER); }
 
 /** \brief eeconfig disable
  *
@@ -102,121 +160,123 @@ void eeconfig_disable(void) {
     EEPROM_Erase();
 #endif
 #if defined(EEPROM_DRIVER)
+    eeprom_driver_discard();
     eeprom_driver_erase();
 #endif
-    eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER_OFF);
+    eeconfig_cache_discard();
+    eeconfig_set_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER_OFF);
 }
 
 /** \brief eeconfig is enabled
  *
  * FIXME: needs doc
  */
-bool eeconfig_is_enabled(void) { return (eeprom_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER); }
+bool eeconfig_is_enabled(void) { return (eeconfig_get_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER); }
 
 /** \brief eeconfig is disabled
  *
  * FIXME: needs doc
  */
-bool eeconfig_is_disabled(void) { return (eeprom_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER_OFF); }
+bool eeconfig_is_disabled(void) { return (eeconfig_get_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER_OFF); }
 
 /** \brief eeconfig read debug
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_debug(void) { return eeprom_read_byte(EECONFIG_DEBUG); }
+uint8_t eeconfig_read_debug(void) { return eeconfig_get_byte(EECONFIG_DEBUG); }
 /** \brief eeconfig update debug
  *
  * FIXME: needs doc
  */
-void eeconfig_update_debug(uint8_t val) { eeprom_update_byte(EECONFIG_DEBUG, val); }
+void eeconfig_update_debug(uint8_t val) { eeconfig_set_byte(EECONFIG_DEBUG, val); }
 
 /** \brief eeconfig read default layer
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_default_layer(void) { return eeprom_read_byte(EECONFIG_DEFAULT_LAYER); }
+uint8_t eeconfig_read_default_layer(void) { return eeconfig_get_byte(EECONFIG_DEFAULT_LAYER); }
 /** \brief eeconfig update default layer
  *
  * FIXME: needs doc
  */
-void eeconfig_update_default_layer(uint8_t val) { eeprom_update_byte(EECONFIG_DEFAULT_LAYER, val); }
+void eeconfig_update_default_layer(uint8_t val) { eeconfig_set_byte(EECONFIG_DEFAULT_LAYER, val); }
 
 /** \brief eeconfig read keymap
  *
  * FIXME: needs doc
  */
-uint16_t eeconfig_read_keymap(void) { return (eeprom_read_byte(EECONFIG_KEYMAP_LOWER_BYTE) | (eeprom_read_byte(EECONFIG_KEYMAP_UPPER_BYTE) << 8)); }
+uint16_t eeconfig_read_keymap(void) { return (eeconfig_get_byte(EECONFIG_KEYMAP_LOWER_BYTE) | (eeconfig_get_byte(EECONFIG_KEYMAP_UPPER_BYTE) << 8)); }
 /** \brief eeconfig update keymap
  *
  * FIXME: needs doc
  */
 void eeconfig_update_keymap(uint16_t val) {
-    eeprom_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, val & 0xFF);
-    eeprom_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, (val >> 8) & 0xFF);
+    eeconfig_set_byte(EECONFIG_KEYMAP_LOWER_BYTE, val & 0xFF);
+    eeconfig_set_byte(EECONFIG_KEYMAP_UPPER_BYTE, (val >> 8) & 0xFF);
 }
 
 /** \brief eeconfig read backlight
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_backlight(void) { return eeprom_read_byte(EECONFIG_BACKLIGHT); }
+uint8_t eeconfig_read_backlight(void) { return eeconfig_get_byte(EECONFIG_BACKLIGHT); }
 /** \brief eeconfig update backlight
  *
  * FIXME: needs doc
  */
-void eeconfig_update_backlight(uint8_t val) { eeprom_update_byte(EECONFIG_BACKLIGHT, val); }
+void eeconfig_update_backlight(uint8_t val) { eeconfig_set_byte(EECONFIG_BACKLIGHT, val); }
 
 /** \brief eeconfig read audio
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_audio(void) { return eeprom_read_byte(EECONFIG_AUDIO); }
+uint8_t eeconfig_read_audio(void) { return eeconfig_get_byte(EECONFIG_AUDIO); }
 /** \brief eeconfig update audio
  *
  * FIXME: needs doc
  */
-void eeconfig_update_audio(uint8_t val) { eeprom_update_byte(EECONFIG_AUDIO, val); }
+void eeconfig_update_audio(uint8_t val) { eeconfig_set_byte(EECONFIG_AUDIO, val); }
 
 /** \brief eeconfig read kb
  *
  * FIXME: needs doc
  */
-uint32_t eeconfig_read_kb(void) { return eeprom_read_dword(EECONFIG_KEYBOARD); }
+uint32_t eeconfig_read_kb(void) { return eeconfig_get_dword(EECONFIG_KEYBOARD); }
 /** \brief eeconfig update kb
  *
  * FIXME: needs doc
  */
-void eeconfig_update_kb(uint32_t val) { eeprom_update_dword(EECONFIG_KEYBOARD, val); }
+void eeconfig_update_kb(uint32_t val) { eeconfig_set_dword(EECONFIG_KEYBOARD, val); }
 
 /** \brief eeconfig read user
  *
  * FIXME: needs doc
  */
-uint32_t eeconfig_read_user(void) { return eeprom_read_dword(EECONFIG_USER); }
+uint32_t eeconfig_read_user(void) { return eeconfig_get_dword(EECONFIG_USER); }
 /** \brief eeconfig update user
  *
  * FIXME: needs doc
  */
-void eeconfig_update_user(uint32_t val) { eeprom_update_dword(EECONFIG_USER, val); }
+void eeconfig_update_user(uint32_t val) { eeconfig_set_dword(EECONFIG_USER, val); }
 
 /** \brief eeconfig read haptic
  *
  * FIXME: needs doc
  */
-uint32_t eeconfig_read_haptic(void) { return eeprom_read_dword(EECONFIG_HAPTIC); }
+uint32_t eeconfig_read_haptic(void) { return eeconfig_get_dword(EECONFIG_HAPTIC); }
 /** \brief eeconfig update haptic
  *
  * FIXME: needs doc
  */
-void eeconfig_update_haptic(uint32_t val) { eeprom_update_dword(EECONFIG_HAPTIC, val); }
+void eeconfig_update_haptic(uint32_t val) { eeconfig_set_dword(EECONFIG_HAPTIC, val); }
 
 /** \brief eeconfig read split handedness
  *
  * FIXME: needs doc
  */
-bool eeconfig_read_handedness(void) { return !!eeprom_read_byte(EECONFIG_HANDEDNESS); }
+bool eeconfig_read_handedness(void) { return !!eeconfig_get_byte(EECONFIG_HANDEDNESS); }
 /** \brief eeconfig update split handedness
  *
  * FIXME: needs doc
  */
-void eeconfig_update_handedness(bool val) { eeprom_update_byte(EECONFIG_HANDEDNESS, !!val); }
+void eeconfig_update_handedness(bool val) { eeconfig_set_byte(EECONFIG_HANDEDNESS, !!val); }
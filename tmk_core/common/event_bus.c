@@ -0,0 +1,134 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+
+#include "event_bus.h"
+#include "action_util.h"
+
+typedef struct {
+    uint8_t            events;  // 0 while the slot is free
+    event_bus_callback callback;
+    void *             cb_arg;
+} event_bus_subscriber_t;
+
+static event_bus_subscriber_t subscribers[EVENT_BUS_SUBSCRIBER_COUNT];
+static uint8_t                subscribed = 0;  // every event some subscriber follows
+static uint8_t                pending    = 0;
+static bool                   suspended  = false;
+static uint8_t                last_mods  = 0;
+
+static void update_subscribed(void) {
+    subscribed = 0;
+    for (uint8_t i = 0; i < EVENT_BUS_SUBSCRIBER_COUNT; i++) {
+        subscribed |= subscribers[i].events;
+    }
+}
+
+// The mods change in too many places to publish each, so they are compared once per pass instead
+static uint8_t event_bus_mods(void) {
+    return get_mods() | get_weak_mods()
+#ifndef NO_ACTION_ONESHOT
+           | get_oneshot_mods()
+#endif
+        ;
+}
+
+/** \brief Calls the callback from the main loop whenever one of the events happened.
+ *
+ * \param events The EVENT_BUS_ events to follow.
+ * \param callback Called with the events that happened since the last call, as a mask.
+ * \param cb_arg Passed to the callback.
+ * \return false if none of the EVENT_BUS_SUBSCRIBER_COUNT slots is free.
+ */
+bool event_bus_subscribe(uint8_t events, event_bus_callback callback, void *cb_arg) {
+    if (events == 0 || callback == NULL) {
+        return false;
+    }
+    for (uint8_t i = 0; i < EVENT_BUS_SUBSCRIBER_COUNT; i++) {
+        if (subscribers[i].events == 0) {
+            subscribers[i] = (event_bus_subscriber_t){events, callback, cb_arg};
+            if ((events & EVENT_BUS_MODS) && !(subscribed & EVENT_BUS_MODS)) {
+                last_mods = event_bus_mods();
+            }
+            subscribed |= events;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** \brief Stops the callback subscribed with the same cb_arg, which may call this itself.
+ *
+ * \return false if it was not subscribed.
+ */
+bool event_bus_unsubscribe(event_bus_callback callback, void *cb_arg) {
+    for (uint8_t i = 0; i < EVENT_BUS_SUBSCRIBER_COUNT; i++) {
+        if (subscribers[i].events && subscribers[i].callback == callback && subscribers[i].cb_arg == cb_arg) {
+            subscribers[i].events = 0;
+            update_subscribed();
+            return true;
+        }
+    }
+    return false;
+}
+
+/** \brief Marks the events as happened, for the next event_bus_task(). Costs nothing while
+ * no one follows them.
+ */
+void event_bus_publish(uint8_t events) { pending |= events & subscribed; }
+
+/** \brief Publishes the transitions into and out of suspend.
+ *
+ * The main loop doesn't run while the keyboard is suspended, so EVENT_BUS_SUSPEND is
+ * delivered right away.
+ */
+void event_bus_suspend(bool state) {
+    if (suspended == state) {
+        return;
+    }
+    suspended = state;
+    if (state) {
+        event_bus_publish(EVENT_BUS_SUSPEND);
+        event_bus_task();
+    } else {
+        event_bus_publish(EVENT_BUS_WAKEUP);
+    }
+}
+
+/** \brief Delivers the events published since the last call. Called once per pass of the main loop.
+ */
+void event_bus_task(void) {
+    if (subscribed & EVENT_BUS_MODS) {
+        uint8_t mods = event_bus_mods();
+        if (mods != last_mods) {
+            last_mods = mods;
+            pending |= EVENT_BUS_MODS;
+        }
+    }
+    if (pending == 0) {
+        return;
+    }
+
+    // Events published by the callbacks go out with the next pass
+    uint8_t events = pending;
+    pending        = 0;
+    for (uint8_t i = 0; i < EVENT_BUS_SUBSCRIBER_COUNT; i++) {
+        if (subscribers[i].events & events) {
+            subscribers[i].callback(subscribers[i].events & events, subscribers[i].cb_arg);
+        }
+    }
+}
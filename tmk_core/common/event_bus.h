@@ -0,0 +1,46 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Event bus: callbacks that run from the main loop when the keyboard state
+ * they follow changed, instead of comparing it on every pass or frame. The
+ * changes published during a pass are delivered together once it ends, so a
+ * callback runs at most once per pass, with every event it follows that
+ * happened. */
+
+#ifndef EVENT_BUS_SUBSCRIBER_COUNT
+#    define EVENT_BUS_SUBSCRIBER_COUNT 4
+#endif
+
+#define EVENT_BUS_LAYER 0x01      // layer_state or default_layer_state
+#define EVENT_BUS_MODS 0x02       // the real, weak or oneshot mods
+#define EVENT_BUS_HOST_LEDS 0x04  // host_keyboard_leds()
+#define EVENT_BUS_WPM 0x08        // get_current_wpm()
+#define EVENT_BUS_SUSPEND 0x10    // the host suspended the keyboard, delivered right away
+#define EVENT_BUS_WAKEUP 0x20     // the keyboard resumed
+#define EVENT_BUS_ALL 0x3F
+
+typedef void (*event_bus_callback)(uint8_t events, void *cb_arg);
+
+bool event_bus_subscribe(uint8_t events, event_bus_callback callback, void *cb_arg);
+bool event_bus_unsubscribe(event_bus_callback callback, void *cb_arg);
+void event_bus_publish(uint8_t events);
+void event_bus_suspend(bool state);
+void event_bus_task(void);
@@ -0,0 +1,105 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "event_trace.h"
+#include "timer.h"
+#include "sendchar.h"
+
+/*
+ * Records go into a ring buffer from the main loop only, which costs about as
+ * much as a function call. With the console they are drained a few per
+ * keyboard_task() as "~T" lines of hex for `qmk decode-trace`, otherwise
+ * event_trace_read() hands them out, for example to answer a raw HID request.
+ */
+
+#ifndef EVENT_TRACE_SIZE
+#    define EVENT_TRACE_SIZE 64
+#endif
+#if EVENT_TRACE_SIZE & (EVENT_TRACE_SIZE - 1) || EVENT_TRACE_SIZE > 256
+#    error "EVENT_TRACE_SIZE must be a power of two, at most 256"
+#endif
+#ifndef EVENT_TRACE_DRAIN
+#    define EVENT_TRACE_DRAIN 4
+#endif
+
+static event_trace_record_t trace_buffer[EVENT_TRACE_SIZE];
+static uint8_t              trace_head    = 0;
+static uint8_t              trace_tail    = 0;
+static uint16_t             trace_dropped = 0;
+
+_Static_assert(sizeof(event_trace_record_t) == 8, "event trace records are 8 bytes on the wire");
+
+#define TRACE_NEXT(i) ((uint8_t)((i) + 1) & (EVENT_TRACE_SIZE - 1))
+
+void event_trace(uint8_t type, uint8_t a, uint16_t b, uint16_t c) {
+#ifdef EVENT_TRACE_KEYS_ONLY
+    // A capture to replay only needs the key events, they get the whole buffer
+    if (type != EVENT_TRACE_KEY) {
+        return;
+    }
+#endif
+    uint8_t next = TRACE_NEXT(trace_head);
+    if (next == trace_tail) {
+        if (trace_dropped < UINT16_MAX) {
+            trace_dropped++;
+        }
+        return;
+    }
+    event_trace_record_t *record = &trace_buffer[trace_head];
+    record->time                 = timer_read();
+    record->type                 = type;
+    record->a                    = a;
+    record->b                    = b;
+    record->c                    = c;
+    trace_head                   = next;
+}
+
+/** \brief Takes up to count records out of the buffer
+ *
+ * An overflow record goes first if any were dropped since the last read.
+ */
+uint8_t event_trace_read(event_trace_record_t *records, uint8_t count) {
+    uint8_t read = 0;
+    if (trace_dropped && count) {
+        records[read++] = (event_trace_record_t){.time = timer_read(), .type = EVENT_TRACE_OVERFLOW, .b = trace_dropped};
+        trace_dropped   = 0;
+    }
+    while (read < count && trace_tail != trace_head) {
+        records[read++] = trace_buffer[trace_tail];
+        trace_tail      = TRACE_NEXT(trace_tail);
+    }
+    return read;
+}
+
+void event_trace_task(void) {
+#ifdef CONSOLE_ENABLE
+    static const char    hex[] = "0123456789ABCDEF";
+    event_trace_record_t records[EVENT_TRACE_DRAIN];
+    uint8_t              count = event_trace_read(records, EVENT_TRACE_DRAIN);
+
+    for (uint8_t i = 0; i < count; i++) {
+        const uint8_t *bytes = (const uint8_t *)&records[i];
+        sendchar('~');
+        sendchar('T');
+        sendchar(' ');
+        for (uint8_t j = 0; j < sizeof(event_trace_record_t); j++) {
+            sendchar(hex[bytes[j] >> 4]);
+            sendchar(hex[bytes[j] & 0xF]);
+        }
+        sendchar('\n');
+    }
+#endif
+}
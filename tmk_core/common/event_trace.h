@@ -0,0 +1,57 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Every record is 8 bytes, sent little endian in this order. Type specific
+ * fields:
+ *   EVENT_TRACE_KEY       a: row, b: col | pressed << 8, c: event time
+ *   EVENT_TRACE_RECORD    a: row, b: col | pressed << 8 | interrupted << 9, c: tap count
+ *   EVENT_TRACE_ACTION    a: action kind, b: action code, c: row << 8 | col
+ *   EVENT_TRACE_REPORT    a: mods, b: keys[0] | keys[1] << 8, c: keys[2] | keys[3] << 8
+ *   EVENT_TRACE_LAYER     b: layer state bits 0-15, c: bits 16-31
+ *   EVENT_TRACE_VARIABLE  a: traced variable, b: line of the check, c: first two bytes of the new value
+ *   EVENT_TRACE_OVERFLOW  b: records dropped because the buffer was full
+ * Types from EVENT_TRACE_USER up are free for keymaps. */
+typedef struct {
+    uint16_t time;  // timer_read()
+    uint8_t  type;
+    uint8_t  a;
+    uint16_t b;
+    uint16_t c;
+} event_trace_record_t;
+
+enum event_trace_type {
+    EVENT_TRACE_KEY = 1,
+    EVENT_TRACE_RECORD,
+    EVENT_TRACE_ACTION,
+    EVENT_TRACE_REPORT,
+    EVENT_TRACE_LAYER,
+    EVENT_TRACE_VARIABLE,
+    EVENT_TRACE_USER     = 0x80,
+    EVENT_TRACE_OVERFLOW = 0xFF,
+};
+
+#ifdef EVENT_TRACE
+void    event_trace(uint8_t type, uint8_t a, uint16_t b, uint16_t c);
+uint8_t event_trace_read(event_trace_record_t *records, uint8_t count);
+void    event_trace_task(void);
+#else
+#    define event_trace(type, a, b, c)
+#    define event_trace_task()
+#endif
@@ -16,22 +16,36 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <stdint.h>
+#include <string.h>
 //#include <avr/interrupt.h>
 #include "keycode.h"
 #include "host.h"
 #include "util.h"
 #include "debug.h"
+#include "latency_probe.h"
+#include "event_trace.h"
 
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
 extern keymap_config_t keymap_config;
 #endif
 
-static host_driver_t *driver;
-static uint16_t       last_system_report   = 0;
-static uint16_t       last_consumer_report = 0;
+static host_driver_t    *driver;
+static uint16_t          last_system_report   = 0;
+static uint16_t          last_consumer_report = 0;
+static uint32_t          dropped_reports      = 0;
+#ifdef KEYBOARD_REPORT_COALESCE
+static report_keyboard_t last_keyboard_report = {0};
+static bool              last_keyboard_nkro   = false;
+static bool              last_keyboard_sent   = false;
+#endif
 
-void host_set_driver(host_driver_t *d) { driver = d; }
+void host_set_driver(host_driver_t *d) {
+    driver = d;
+#ifdef KEYBOARD_REPORT_COALESCE
+    last_keyboard_sent = false;
+#endif
+}
 
 host_driver_t *host_get_driver(void) { return driver; }
 
@@ -62,6 +76,22 @@ void host_keyboard_send(report_keyboard_t *report) {
         report->report_id = REPORT_ID_KEYBOARD;
 #endif
     }
+
+#ifdef KEYBOARD_REPORT_COALESCE
+    /* Several register/unregister calls in one action can rebuild the same report */
+#    ifdef NKRO_ENABLE
+    bool nkro = keyboard_protocol && keymap_config.nkro;
+#    else
+    bool nkro = false;
+#    endif
+    if (last_keyboard_sent && nkro == last_keyboard_nkro && memcmp(report, &last_keyboard_report, sizeof(report_keyboard_t)) == 0) return;
+    last_keyboard_report = *report;
+    last_keyboard_nkro   = nkro;
+    last_keyboard_sent   = true;
+#endif
+
+    event_trace(EVENT_TRACE_REPORT, report->mods, report->keys[0] | report->keys[1] << 8, report->keys[2] | report->keys[3] << 8);
+    latency_probe_report_sent();
     (*driver->send_keyboard)(report);
 
     if (debug_keyboard) {
@@ -100,3 +130,7 @@ void host_consumer_send(uint16_t report) {
 uint16_t host_last_system_report(void) { return last_system_report; }
 
 uint16_t host_last_consumer_report(void) { return last_consumer_report; }
+
+void host_report_dropped(void) { dropped_reports++; }
+
+uint32_t host_dropped_reports(void) { return dropped_reports; }
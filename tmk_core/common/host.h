@@ -51,6 +51,10 @@ void    host_consumer_send(uint16_t data);
 uint16_t host_last_system_report(void);
 uint16_t host_last_consumer_report(void);
 
+/* reports the protocol had to give up on, e.g. because the host didn't poll the endpoint in time */
+void     host_report_dropped(void);
+uint32_t host_dropped_reports(void);
+
 #ifdef __cplusplus
 }
 #endif
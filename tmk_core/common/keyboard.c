@@ -16,6 +16,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <stdint.h>
+#include <stddef.h>
+#include <string.h>
 #include "keyboard.h"
 #include "matrix.h"
 #include "keymap.h"
@@ -31,6 +33,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "sendchar.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "task_profile.h"
+#include "latency_probe.h"
+#include "event_trace.h"
+#include "stack_watermark.h"
+#include "deferred_exec.h"
+#include "event_bus.h"
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
 #endif
@@ -57,6 +65,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef RGB_MATRIX_ENABLE
 #    include "rgb_matrix.h"
 #endif
+#if defined(AUDIO_CLICKY) && defined(AUDIO_CLICKY_ON_SWITCH)
+#    include "process_clicky.h"
+#endif
 #ifdef ENCODER_ENABLE
 #    include "encoder.h"
 #endif
@@ -96,6 +107,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef DIP_SWITCH_ENABLE
 #    include "dip_switch.h"
 #endif
+#if defined(EEPROM_DRIVER) && defined(EEPROM_WRITE_BACK)
+#    include "eeprom_driver.h"
+#endif
+#if defined(PROTOCOL_CHIBIOS) && defined(I2C_ASYNC)
+#    include "i2c_master.h"
+#endif
+#if defined(PROTOCOL_CHIBIOS) && defined(SPI_ASYNC)
+#    include "spi_master.h"
+#endif
 
 static uint32_t last_input_modification_time = 0;
 uint32_t        last_input_activity_time(void) { return last_input_modification_time; }
@@ -112,7 +132,9 @@ uint32_t        last_encoder_activity_elapsed(void) { return timer_elapsed32(las
 void            last_encoder_activity_trigger(void) { last_encoder_modification_time = last_input_modification_time = timer_read32(); }
 
 // Only enable this if console is enabled to print to
-#if defined(DEBUG_MATRIX_SCAN_RATE)
+// With MATRIX_SCAN_ADAPTIVE the matrix calls matrix_scan_perf_task() itself, so only real scans are counted
+// VIA_TELEMETRY only needs get_matrix_scan_rate()
+#if defined(DEBUG_MATRIX_SCAN_RATE) || defined(MATRIX_SCAN_ADAPTIVE) || defined(VIA_TELEMETRY)
 static uint32_t matrix_timer           = 0;
 static uint32_t matrix_scan_count      = 0;
 static uint32_t last_matrix_scan_count = 0;
@@ -122,7 +144,7 @@ void matrix_scan_perf_task(void) {
 
     uint32_t timer_now = timer_read32();
     if (TIMER_DIFF_32(timer_now, matrix_timer) > 1000) {
-#    if defined(CONSOLE_ENABLE)
+#    if defined(DEBUG_MATRIX_SCAN_RATE) && defined(CONSOLE_ENABLE)
         dprintf("matrix scan frequency: %lu\n", matrix_scan_count);
 #    endif
         last_matrix_scan_count = matrix_scan_count;
@@ -137,19 +159,22 @@ uint32_t get_matrix_scan_rate(void) { return last_matrix_scan_count; }
 #endif
 
 #ifdef MATRIX_HAS_GHOST
-extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
-static matrix_row_t   get_real_keys(uint8_t row, matrix_row_t rowdata) {
-    matrix_row_t out = 0;
-    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
-        // read each key in the row data and check if the keymap defines it as a real key
-        if (pgm_read_byte(&keymaps[0][row][col]) && (rowdata & (1 << col))) {
-            // this creates new row data, if a key is defined in the keymap, it will be set here
-            out |= 1 << col;
+// The keys of each row that the keymap defines on its base layer, read from flash once at init
+static matrix_row_t real_keys[MATRIX_ROWS];
+
+static void real_keys_init(void) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        real_keys[row] = 0;
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (keymap_flash_keycode(0, row, col)) {
+                real_keys[row] |= MATRIX_ROW_SHIFTER << col;
+            }
         }
     }
-    return out;
 }
 
+static inline matrix_row_t get_real_keys(uint8_t row, matrix_row_t rowdata) { return rowdata & real_keys[row]; }
+
 static inline bool popcount_more_than_one(matrix_row_t rowdata) {
     rowdata &= rowdata - 1;  // if there are less than two bits (keys) set, rowdata will become zero
     return rowdata;
@@ -270,6 +295,15 @@ __attribute__((weak)) void housekeeping_task_kb(void) {}
  */
 __attribute__((weak)) void housekeeping_task_user(void) {}
 
+#ifndef KEYBOARD_DEFERRED_INIT_TIMEOUT
+#    define KEYBOARD_DEFERRED_INIT_TIMEOUT 1000
+#endif
+
+static bool deferred_init_done = false;
+#ifdef KEYBOARD_DEFERRED_INIT
+static uint16_t deferred_init_timer;
+#endif
+
 /** \brief keyboard_init
  *
  * FIXME: needs doc
@@ -277,16 +311,14 @@ __attribute__((weak)) void housekeeping_task_user(void) {}
 void keyboard_init(void) {
     timer_init();
     sync_timer_init();
+    task_profile_init();
     matrix_init();
+#ifdef MATRIX_HAS_GHOST
+    real_keys_init();
+#endif
 #ifdef VIA_ENABLE
     via_init();
 #endif
-#ifdef QWIIC_ENABLE
-    qwiic_init();
-#endif
-#ifdef OLED_DRIVER_ENABLE
-    oled_init(OLED_ROTATION_0);
-#endif
 #ifdef PS2_MOUSE_ENABLE
     ps2_mouse_init();
 #endif
@@ -301,12 +333,6 @@ void keyboard_init(void) {
 #else
     magic();
 #endif
-#ifdef BACKLIGHT_ENABLE
-    backlight_init();
-#endif
-#ifdef RGBLIGHT_ENABLE
-    rgblight_init();
-#endif
 #ifdef ENCODER_ENABLE
     encoder_init();
 #endif
@@ -328,6 +354,50 @@ void keyboard_init(void) {
     debug_enable = true;
 #endif
 
+#ifdef KEYBOARD_DEFERRED_INIT
+    deferred_init_timer = timer_read();
+#else
+    keyboard_init_deferred();
+#endif
+}
+
+/** \brief keyboard_host_ready
+ *
+ * Whether the host has configured the keyboard, so that reports get through. Protocols that can
+ * tell override this, see keyboard_init_deferred().
+ */
+__attribute__((weak)) bool keyboard_host_ready(void) { return true; }
+
+/** \brief keyboard_init_deferred
+ *
+ * Starts the output features, displays, lighting, audio and haptic feedback, then runs
+ * keyboard_post_init_kb(). It is the end of keyboard_init(), unless KEYBOARD_DEFERRED_INIT is
+ * defined: the matrix is then scanned and reports are sent straight away, and keyboard_task()
+ * runs this once keyboard_host_ready() says the host has configured the keyboard, or after
+ * KEYBOARD_DEFERRED_INIT_TIMEOUT milliseconds without a host, as on the slave half of a split.
+ */
+void keyboard_init_deferred(void) {
+    if (deferred_init_done) {
+        return;
+    }
+    deferred_init_done = true;
+
+#ifdef KEYBOARD_DEFERRED_INIT
+    keyboard_init_deferred_quantum();
+#endif
+#ifdef QWIIC_ENABLE
+    qwiic_init();
+#endif
+#ifdef OLED_DRIVER_ENABLE
+    oled_init(OLED_ROTATION_0);
+#endif
+#ifdef BACKLIGHT_ENABLE
+    backlight_init();
+#endif
+#ifdef RGBLIGHT_ENABLE
+    rgblight_init();
+#endif
+
     keyboard_post_init_kb(); /* Always keep this last */
 }
 
@@ -337,119 +407,378 @@ void keyboard_init(void) {
  * This is differnet than keycode events as no layer processing, or filtering occurs.
  */
 void switch_events(uint8_t row, uint8_t col, bool pressed) {
+#if defined(AUDIO_CLICKY) && defined(AUDIO_CLICKY_ON_SWITCH)
+    clicky_switch_event(row, col, pressed);
+#endif
 #if defined(RGB_MATRIX_ENABLE)
     process_rgb_matrix(row, col, pressed);
 #endif
 }
 
+#ifndef QMK_KEYS_PER_SCAN
+#    define QMK_KEYS_PER_SCAN 8
+#endif
+
+/** \brief Key event queue
+ *
+ * Matrix changes found by a single scan are collected here in scan order, then all of them
+ * are handed to action_exec() before the slower peripheral tasks run. Changes that do not fit
+ * stay pending in matrix_prev and are picked up by the next pass.
+ *
+ * Only the rows the matrix reports as changed, and the rows whose changes are still pending, are
+ * compared against matrix_prev, so a pass with no changes doesn't touch any row.
+ */
+static matrix_row_t matrix_prev[MATRIX_ROWS];
+static uint8_t      matrix_rows_pending[MATRIX_ROW_BITMAP_SIZE];
+static bool         matrix_any_row_pending = false;
+static keyevent_t   key_event_queue[QMK_KEYS_PER_SCAN];
+static uint16_t     last_event_time = 0;
+
+/** \brief matrix_take_changed_rows
+ *
+ * Rows whose debounced state changed since the last call. Matrix implementations that don't
+ * track this report every row.
+ */
+__attribute__((weak)) bool matrix_take_changed_rows(uint8_t rows[]) {
+    memset(rows, 0xFF, MATRIX_ROW_BITMAP_SIZE);
+    return true;
+}
+
+/** \brief matrix_get_row_time
+ *
+ * Time at which the debounced state of a row last changed. Matrix implementations that don't
+ * record this fall back to the time the change is dispatched.
+ */
+__attribute__((weak)) uint16_t matrix_get_row_time(uint8_t row) { return timer_read(); }
+
+/** \brief key_event_time
+ *
+ * Time for an event on the given row, clamped between the last dispatched event and now so the
+ * tapping code never sees time running backwards, or ahead of the local timer on split slaves.
+ */
+static uint16_t key_event_time(uint8_t row, uint16_t now) {
+    uint16_t time = matrix_get_row_time(row) | 1; /* time should not be 0 */
+    uint16_t age  = TIMER_DIFF_16(now, time);
+
+    if (age >= (UINT16_MAX / 2)) {
+        return now;
+    }
+    if (age > TIMER_DIFF_16(now, last_event_time)) {
+        return last_event_time;
+    }
+    return time;
+}
+
+/** \brief matrix_collect_events
+ *
+ * Diffs the changed rows of the current matrix against the last processed state and queues up to
+ * QMK_KEYS_PER_SCAN key events, stamped with the time their row changed.
+ */
+static uint8_t matrix_collect_events(uint16_t now) {
+    uint8_t count = 0;
+
+    if (matrix_take_changed_rows(matrix_rows_pending)) {
+        matrix_any_row_pending = true;
+    }
+    if (!matrix_any_row_pending) {
+        return 0;
+    }
+
+    matrix_any_row_pending = false;
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        uint8_t row_bit = 1 << (r % 8);
+        if (!(matrix_rows_pending[r / 8] & row_bit)) {
+            continue;
+        }
+        matrix_row_t matrix_row    = matrix_get_row(r);
+        matrix_row_t matrix_change = matrix_row ^ matrix_prev[r];
+        if (!matrix_change) {
+            matrix_rows_pending[r / 8] &= ~row_bit;
+            continue;
+        }
+#ifdef MATRIX_HAS_GHOST
+        if (has_ghost_in_row(r, matrix_row)) {
+            // looked at again on every pass, until a change in another row clears the ghost
+            matrix_any_row_pending = true;
+            continue;
+        }
+#endif
+        if (debug_matrix) matrix_print();
+        uint16_t     time     = key_event_time(r, now);
+        matrix_row_t col_mask = 1;
+        for (uint8_t c = 0; c < MATRIX_COLS; c++, col_mask <<= 1) {
+            if (matrix_change & col_mask) {
+                key_event_queue[count++] = (keyevent_t){.key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = time};
+                // record a processed key
+                matrix_prev[r] ^= col_mask;
+
+                if (count >= QMK_KEYS_PER_SCAN) {
+                    // the rest of this row and the rows after it are left for the next pass
+                    matrix_any_row_pending = true;
+                    return count;
+                }
+            }
+        }
+        matrix_rows_pending[r / 8] &= ~row_bit;
+    }
+    return count;
+}
+
+/** \brief key_event_queue_sort
+ *
+ * Puts the queued events in the order they happened, which differs from the scan order when rows
+ * changed at different times, as the rows of the two halves of a split keyboard do. Events with the
+ * same time keep their scan order.
+ */
+static void key_event_queue_sort(uint8_t count, uint16_t now) {
+    for (uint8_t i = 1; i < count; i++) {
+        keyevent_t event = key_event_queue[i];
+        uint16_t   age   = TIMER_DIFF_16(now, event.time);
+        uint8_t    j     = i;
+        for (; j > 0 && TIMER_DIFF_16(now, key_event_queue[j - 1].time) < age; j--) {
+            key_event_queue[j] = key_event_queue[j - 1];
+        }
+        key_event_queue[j] = event;
+    }
+}
+
+#ifndef RGBLIGHT_TASK_PERIOD
+#    define RGBLIGHT_TASK_PERIOD 0
+#endif
+#ifndef RGB_MATRIX_TASK_PERIOD
+#    define RGB_MATRIX_TASK_PERIOD 0
+#endif
+#ifndef BACKLIGHT_TASK_PERIOD
+#    define BACKLIGHT_TASK_PERIOD 0
+#endif
+#ifndef QWIIC_TASK_PERIOD
+#    define QWIIC_TASK_PERIOD 0
+#endif
+#ifndef OLED_TASK_PERIOD
+#    define OLED_TASK_PERIOD 0
+#endif
+#ifndef VISUALIZER_TASK_PERIOD
+#    define VISUALIZER_TASK_PERIOD 0
+#endif
+#ifndef VELOCIKEY_TASK_PERIOD
+#    define VELOCIKEY_TASK_PERIOD 0
+#endif
+
+#ifdef KEYBOARD_PERIPHERAL_THREAD
+#    ifndef PROTOCOL_CHIBIOS
+#        error "KEYBOARD_PERIPHERAL_THREAD is only supported on ChibiOS"
+#    endif
+#    include <ch.h>
+#    if CH_CFG_USE_MUTEXES == FALSE
+#        error "KEYBOARD_PERIPHERAL_THREAD needs CH_CFG_USE_MUTEXES"
+#    endif
+#    ifndef KEYBOARD_PERIPHERAL_THREAD_PRIORITY
+#        define KEYBOARD_PERIPHERAL_THREAD_PRIORITY (NORMALPRIO - 1)
+#    endif
+#    ifndef KEYBOARD_PERIPHERAL_THREAD_STACK_SIZE
+#        define KEYBOARD_PERIPHERAL_THREAD_STACK_SIZE 1024
+#    endif
+// Held by the main loop for each of its passes, and by the peripheral thread for each task it runs
+static MUTEX_DECL(keyboard_state_mutex);
+
+void keyboard_state_lock(void) { chMtxLock(&keyboard_state_mutex); }
+void keyboard_state_unlock(void) { chMtxUnlock(&keyboard_state_mutex); }
+#else
+#    define keyboard_state_lock()
+#    define keyboard_state_unlock()
+#endif
+
+// The peripheral thread is preempted by the main loop anyway, it has no budget to keep to
+#if defined(KEYBOARD_TASK_BUDGET_US) && !defined(KEYBOARD_PERIPHERAL_THREAD)
+#    ifdef PROTOCOL_CHIBIOS
+#        include <ch.h>
+static systime_t task_budget_start;
+static inline void     task_budget_reset(void) { task_budget_start = chVTGetSystemTimeX(); }
+static inline uint32_t task_budget_elapsed_us(void) { return TIME_I2US(chVTTimeElapsedSinceX(task_budget_start)); }
+#    else
+static uint16_t        task_budget_start;
+static inline void     task_budget_reset(void) { task_budget_start = timer_read(); }
+static inline uint32_t task_budget_elapsed_us(void) { return (uint32_t)timer_elapsed(task_budget_start) * 1000; }
+#    endif
+#    define task_budget_exhausted() (task_budget_elapsed_us() >= KEYBOARD_TASK_BUDGET_US)
+#else
+#    define task_budget_reset()
+#    define task_budget_exhausted() false
+#endif
+
+#if defined(BACKLIGHT_ENABLE) && (defined(BACKLIGHT_PIN) || defined(BACKLIGHT_PINS))
+#    define BACKLIGHT_TASK_ENABLE
+#endif
+
+#ifdef VISUALIZER_ENABLE
+static void visualizer_task(void) { visualizer_update(default_layer_state, layer_state, visualizer_get_mods(), host_keyboard_leds()); }
+#endif
+
+#ifdef VELOCIKEY_ENABLE
+static void velocikey_task(void) {
+    if (velocikey_enabled()) {
+        velocikey_decelerate();
+    }
+}
+#endif
+
+/** \brief Deferrable tasks
+ *
+ * Lighting and display tasks that run after the matrix and the input devices have been handled.
+ * Each one runs at most every `period` milliseconds, and when KEYBOARD_TASK_BUDGET_US is set,
+ * whatever doesn't fit in the remaining budget of the current pass is picked up by the next one.
+ */
+typedef struct {
+    void (*task)(void);
+    uint16_t period;
+    uint16_t last_run;
+    uint8_t  profile_stage;
+} deferrable_task_t;
+
+static deferrable_task_t deferrable_tasks[] = {
+#if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_USE_TIMER)
+    {rgblight_task, RGBLIGHT_TASK_PERIOD, 0, TASK_PROFILE_RGBLIGHT},
+#endif
+#ifdef RGB_MATRIX_ENABLE
+    {rgb_matrix_task, RGB_MATRIX_TASK_PERIOD, 0, TASK_PROFILE_RGB_MATRIX},
+#endif
+#ifdef BACKLIGHT_TASK_ENABLE
+    {backlight_task, BACKLIGHT_TASK_PERIOD, 0, TASK_PROFILE_BACKLIGHT},
+#endif
+#ifdef QWIIC_ENABLE
+    {qwiic_task, QWIIC_TASK_PERIOD, 0, TASK_PROFILE_OTHER},
+#endif
+#ifdef OLED_DRIVER_ENABLE
+    {oled_task, OLED_TASK_PERIOD, 0, TASK_PROFILE_OLED},
+#endif
+#ifdef VISUALIZER_ENABLE
+    {visualizer_task, VISUALIZER_TASK_PERIOD, 0, TASK_PROFILE_OTHER},
+#endif
+#ifdef VELOCIKEY_ENABLE
+    {velocikey_task, VELOCIKEY_TASK_PERIOD, 0, TASK_PROFILE_OTHER},
+#endif
+    {NULL, 0, 0, 0},
+};
+
+#define DEFERRABLE_TASK_COUNT ((sizeof(deferrable_tasks) / sizeof(deferrable_task_t)) - 1)
+
+/** \brief deferrable_tasks_run
+ *
+ * Runs the deferrable tasks that are due, starting with the one that was deferred last time so
+ * none of them can starve. At least one due task runs per pass, even once the budget is spent.
+ */
+static void deferrable_tasks_run(void) {
+    static uint8_t next = 0;
+    uint16_t       now  = timer_read();
+    bool           ran  = false;
+    uint8_t        idx  = next;
+
+    for (uint8_t i = 0; i < DEFERRABLE_TASK_COUNT; i++) {
+        deferrable_task_t *task = &deferrable_tasks[idx];
+        if (TIMER_DIFF_16(now, task->last_run) >= task->period) {
+            if (ran && task_budget_exhausted()) {
+                next = idx;
+                return;
+            }
+            keyboard_state_lock();
+            TASK_PROFILE(task->profile_stage, task->task());
+            keyboard_state_unlock();
+            task->last_run = now;
+            ran            = true;
+        }
+        if (++idx >= DEFERRABLE_TASK_COUNT) {
+            idx = 0;
+        }
+    }
+}
+
+#ifdef KEYBOARD_PERIPHERAL_THREAD
+/* Runs the deferrable tasks below the main loop's priority, so lighting and displays only get the
+ * time scanning and reporting leave them, however long they take. The main loop waits for at most
+ * the one task holding the lock when it wakes up. */
+static THD_WORKING_AREA(waKeyboardPeripheralThread, KEYBOARD_PERIPHERAL_THREAD_STACK_SIZE);
+static THD_FUNCTION(KeyboardPeripheralThread, arg) {
+    (void)arg;
+    chRegSetThreadName("peripherals");
+    while (true) {
+        deferrable_tasks_run();
+        chThdSleepMilliseconds(1);
+    }
+}
+static thread_t *keyboard_peripheral_thread = NULL;
+#endif
+
 /** \brief Keyboard task: Do keyboard routine jobs
  *
  * Do routine keyboard jobs:
  *
  * * scan matrix
  * * handle mouse movements
- * * run visualizer code
  * * handle midi commands
+ * * run visualizer code
  * * light LEDs
  *
  * This is repeatedly called as fast as possible.
  */
 void keyboard_task(void) {
-    static matrix_row_t matrix_prev[MATRIX_ROWS];
-    static uint8_t      led_status    = 0;
-    matrix_row_t        matrix_row    = 0;
-    matrix_row_t        matrix_change = 0;
-#ifdef QMK_KEYS_PER_SCAN
-    uint8_t keys_processed = 0;
-#endif
+    static uint8_t led_status = 0;
 #ifdef ENCODER_ENABLE
     bool encoders_changed = false;
 #endif
+#ifdef KEYBOARD_TASK_PROFILE
+    uint32_t task_start = task_profile_ticks();
+#endif
+
+    task_budget_reset();
 
     housekeeping_task_kb();
     housekeeping_task_user();
 
-    uint8_t matrix_changed = matrix_scan();
+    uint8_t matrix_changed;
+    TASK_PROFILE(TASK_PROFILE_MATRIX_SCAN, matrix_changed = matrix_scan());
     if (matrix_changed) last_matrix_activity_trigger();
 
-    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
-        matrix_row    = matrix_get_row(r);
-        matrix_change = matrix_row ^ matrix_prev[r];
-        if (matrix_change) {
-#ifdef MATRIX_HAS_GHOST
-            if (has_ghost_in_row(r, matrix_row)) {
-                continue;
-            }
-#endif
-            if (debug_matrix) matrix_print();
-            matrix_row_t col_mask = 1;
-            for (uint8_t c = 0; c < MATRIX_COLS; c++, col_mask <<= 1) {
-                if (matrix_change & col_mask) {
-                    if (should_process_keypress()) {
-                        action_exec((keyevent_t){
-                            .key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = (timer_read() | 1) /* time should not be 0 */
-                        });
-                    }
-                    // record a processed key
-                    matrix_prev[r] ^= col_mask;
-
-                    switch_events(r, c, (matrix_row & col_mask));
-
-#ifdef QMK_KEYS_PER_SCAN
-                    // only jump out if we have processed "enough" keys.
-                    if (++keys_processed >= QMK_KEYS_PER_SCAN)
-#endif
-                        // process a key per task call
-                        goto MATRIX_LOOP_END;
-                }
-            }
+#ifdef KEYBOARD_TASK_PROFILE
+    uint32_t action_start = task_profile_ticks();
+#endif
+    uint16_t now    = timer_read() | 1; /* time should not be 0 */
+    uint8_t  events = matrix_collect_events(now);
+    key_event_queue_sort(events, now);
+    for (uint8_t i = 0; i < events; i++) {
+        keyevent_t *event = &key_event_queue[i];
+        latency_probe_event(event->key.row, event->key.col);
+        // Ahead of processing, so feedback of the switch itself isn't held back by it
+        switch_events(event->key.row, event->key.col, event->pressed);
+        if (should_process_keypress()) {
+            action_exec(*event);
         }
+        last_event_time = event->time;
     }
     // call with pseudo tick event when no real key event.
-#ifdef QMK_KEYS_PER_SCAN
-    // we can get here with some keys processed now.
-    if (!keys_processed)
+    if (!events) {
+        keyevent_t tick = TICK;
+        action_exec(tick);
+        last_event_time = tick.time;
+    }
+#ifdef KEYBOARD_TASK_PROFILE
+    task_profile_record(TASK_PROFILE_ACTION_EXEC, action_start);
 #endif
-        action_exec(TICK);
-
-MATRIX_LOOP_END:
 
-#ifdef DEBUG_MATRIX_SCAN_RATE
+#if (defined(DEBUG_MATRIX_SCAN_RATE) || defined(VIA_TELEMETRY)) && !defined(MATRIX_SCAN_ADAPTIVE)
     matrix_scan_perf_task();
 #endif
 
-#if defined(RGBLIGHT_ENABLE)
-    rgblight_task();
-#endif
-
-#ifdef RGB_MATRIX_ENABLE
-    rgb_matrix_task();
-#endif
-
-#if defined(BACKLIGHT_ENABLE)
-#    if defined(BACKLIGHT_PIN) || defined(BACKLIGHT_PINS)
-    backlight_task();
-#    endif
-#endif
-
 #ifdef ENCODER_ENABLE
-    encoders_changed = encoder_read();
+    TASK_PROFILE(TASK_PROFILE_ENCODER, encoders_changed = encoder_read());
     if (encoders_changed) last_encoder_activity_trigger();
 #endif
 
-#ifdef QWIIC_ENABLE
-    qwiic_task();
-#endif
-
-#ifdef OLED_DRIVER_ENABLE
-    oled_task();
-#    ifndef OLED_DISABLE_TIMEOUT
+#if defined(OLED_DRIVER_ENABLE) && !defined(OLED_DISABLE_TIMEOUT)
     // Wake up oled if user is using those fabulous keys or spinning those encoders!
-#        ifdef ENCODER_ENABLE
+#    ifdef ENCODER_ENABLE
     if (matrix_changed || encoders_changed) oled_on();
-#        else
+#    else
     if (matrix_changed) oled_on();
-#        endif
 #    endif
 #endif
 
@@ -474,32 +803,92 @@ MATRIX_LOOP_END:
     serial_link_update();
 #endif
 
-#ifdef VISUALIZER_ENABLE
-    visualizer_update(default_layer_state, layer_state, visualizer_get_mods(), host_keyboard_leds());
-#endif
-
 #ifdef POINTING_DEVICE_ENABLE
-    pointing_device_task();
+    TASK_PROFILE(TASK_PROFILE_POINTING_DEVICE, pointing_device_task());
 #endif
 
 #ifdef MIDI_ENABLE
     midi_task();
 #endif
 
-#ifdef VELOCIKEY_ENABLE
-    if (velocikey_enabled()) {
-        velocikey_decelerate();
-    }
-#endif
-
 #ifdef JOYSTICK_ENABLE
     joystick_task();
 #endif
 
+#if defined(EEPROM_DRIVER) && defined(EEPROM_WRITE_BACK)
+    eeprom_driver_task();
+#endif
+
+#if defined(PROTOCOL_CHIBIOS) && defined(I2C_ASYNC)
+    i2c_async_task();
+#endif
+
+#if defined(PROTOCOL_CHIBIOS) && defined(SPI_ASYNC)
+    spi_async_task();
+#endif
+
+    // release the synthesized taps whose delay has passed
+    deferred_release_task();
+
+    deferred_exec_task();
+
     // update LED
     if (led_status != host_keyboard_leds()) {
         led_status = host_keyboard_leds();
         keyboard_set_leds(led_status);
+        event_bus_publish(EVENT_BUS_HOST_LEDS);
+    }
+
+    event_bus_task();
+
+#ifdef KEYBOARD_DEFERRED_INIT
+    // This pass's reports have gone out, start the rest once the host is listening
+    if (!deferred_init_done && (keyboard_host_ready() || timer_elapsed(deferred_init_timer) > KEYBOARD_DEFERRED_INIT_TIMEOUT)) {
+        keyboard_init_deferred();
+    }
+#endif
+    // The lighting and display tasks have nothing to drive until then
+#ifdef KEYBOARD_PERIPHERAL_THREAD
+    if (deferred_init_done && !keyboard_peripheral_thread) {
+        keyboard_peripheral_thread = chThdCreateStatic(waKeyboardPeripheralThread, sizeof(waKeyboardPeripheralThread), KEYBOARD_PERIPHERAL_THREAD_PRIORITY, KeyboardPeripheralThread, NULL);
+    }
+#else
+    if (deferred_init_done) {
+        deferrable_tasks_run();
+    }
+#endif
+
+#ifdef KEYBOARD_TASK_PROFILE
+    task_profile_record(TASK_PROFILE_KEYBOARD_TASK, task_start);
+    task_profile_task();
+#endif
+    latency_probe_task();
+    event_trace_task();
+    stack_watermark_task();
+}
+
+/** \brief keyboard_replay_keys
+ *
+ * Taps the keys in rows that are neither down now nor known to keyboard_task() as down, so were
+ * pressed and released while the matrix was scanned elsewhere, such as while the host resumed.
+ */
+void keyboard_replay_keys(const matrix_row_t rows[]) {
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        matrix_row_t missed = rows[r] & ~matrix_get_row(r) & ~matrix_prev[r];
+        for (uint8_t c = 0; missed && c < MATRIX_COLS; c++) {
+            if (!(missed & ((matrix_row_t)1 << c))) {
+                continue;
+            }
+            missed &= ~((matrix_row_t)1 << c);
+
+            keyevent_t event = {.key = (keypos_t){.row = r, .col = c}, .pressed = true, .time = timer_read() | 1};
+            if (should_process_keypress()) {
+                action_exec(event);
+                event.pressed = false;
+                action_exec(event);
+            }
+            last_event_time = event.time;
+        }
     }
 }
 
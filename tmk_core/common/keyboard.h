@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "matrix.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -56,8 +57,20 @@ static inline bool IS_RELEASED(keyevent_t event) { return (!IS_NOEVENT(event) &&
 void keyboard_setup(void);
 /* it runs once after initializing host side protocol, debug and MCU peripherals. */
 void keyboard_init(void);
+/* it runs at the end of keyboard_init, or later with KEYBOARD_DEFERRED_INIT, to start the output features */
+void keyboard_init_deferred(void);
+void keyboard_init_deferred_quantum(void);
+/* it tells whether the host has configured the keyboard */
+bool keyboard_host_ready(void);
 /* it runs repeatedly in main loop */
 void keyboard_task(void);
+/* it taps the keys in rows that were released before keyboard_task could see them */
+void keyboard_replay_keys(const matrix_row_t rows[]);
+#ifdef KEYBOARD_PERIPHERAL_THREAD
+/* it keeps the peripheral thread's tasks from running while the main loop changes keyboard state */
+void keyboard_state_lock(void);
+void keyboard_state_unlock(void);
+#endif
 /* it runs when host LED status is updated */
 void keyboard_set_leds(uint8_t leds);
 /* it runs whenever code has to behave differently on a slave */
@@ -83,6 +96,7 @@ uint32_t last_encoder_activity_time(void);     // Timestamp of the last encoder
 uint32_t last_encoder_activity_elapsed(void);  // Number of milliseconds since the last encoder activity
 
 uint32_t get_matrix_scan_rate(void);
+void     matrix_scan_perf_task(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,216 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "latency_probe.h"
+#include "task_profile.h"
+#include "atomic_util.h"
+#include "timer.h"
+#include "debug.h"
+
+/*
+ * A key goes through three steps:
+ *   - the raw matrix first differs from the debounced one, the edge is timestamped
+ *   - debounce lets the event through and keyboard_task() processes it, the key waits for a report
+ *   - host_keyboard_send() sends the next report, the key waits for the host to take it
+ * On ChibiOS the last step ends once the keyboard endpoint has no report left to transmit,
+ * elsewhere it ends in host_keyboard_send(). Keys that don't send a report in the same
+ * keyboard_task() as their event (layer keys, tap-hold keys that wait for their tapping term)
+ * are not counted. Only the keys of the half the host is connected to are seen.
+ */
+
+#ifndef LATENCY_PROBE_PENDING
+#    define LATENCY_PROBE_PENDING 8
+#endif
+// Edges older than this are from a glitch that never made it through debounce
+#ifndef LATENCY_PROBE_STALE_MS
+#    define LATENCY_PROBE_STALE_MS 100
+#endif
+#ifndef LATENCY_PROBE_PRINT_INTERVAL
+#    define LATENCY_PROBE_PRINT_INTERVAL 5000
+#endif
+
+typedef struct {
+    uint8_t  row;
+    uint8_t  col;
+    bool     submitted;
+    uint32_t edge;
+    uint32_t submit;
+} latency_probe_pending_t;
+
+static latency_probe_stats_t   probe_stats[MATRIX_ROWS][MATRIX_COLS];
+static uint32_t                probe_edge[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t            probe_seen[MATRIX_ROWS];
+static matrix_row_t            probe_raw[MATRIX_ROWS];
+static latency_probe_pending_t probe_pending[LATENCY_PROBE_PENDING];
+static uint8_t                 probe_pending_count = 0;
+static bool                    probe_updated       = false;
+
+static volatile uint32_t probe_done_time;
+static volatile uint8_t  probe_done_count = 0;
+static uint8_t           probe_done_seen  = 0;
+
+static uint32_t probe_stale_ticks(void) { return task_profile_tick_frequency() / 1000 * LATENCY_PROBE_STALE_MS; }
+
+/** \brief Timestamps the keys whose raw state moved away from the debounced one
+ *
+ * Called by the matrix with the rows it just read, before debounce.
+ */
+void latency_probe_raw_matrix(const matrix_row_t *raw, uint8_t first_row, uint8_t rows, bool changed) {
+    if (!changed) {
+        return;
+    }
+    uint32_t now = task_profile_ticks();
+    for (uint8_t i = 0; i < rows; i++) {
+        uint8_t      row     = first_row + i;
+        matrix_row_t changes = raw[i] ^ probe_raw[row];
+        if (!changes) {
+            continue;
+        }
+        probe_raw[row] = raw[i];
+
+        matrix_row_t edges = changes & (raw[i] ^ matrix_get_row(row));
+        for (uint8_t col = 0; edges; col++, edges >>= 1) {
+            if (!(edges & 1)) {
+                continue;
+            }
+            matrix_row_t bit = (matrix_row_t)1 << col;
+            if (!(probe_seen[row] & bit) || task_profile_ticks_diff(now, probe_edge[row][col]) > probe_stale_ticks()) {
+                probe_edge[row][col] = now;
+                probe_seen[row] |= bit;
+            }
+        }
+    }
+}
+
+/** \brief The debounced event of a key is being processed */
+void latency_probe_event(uint8_t row, uint8_t col) {
+    matrix_row_t bit = (matrix_row_t)1 << col;
+    if (row >= MATRIX_ROWS || !(probe_seen[row] & bit)) {
+        return;
+    }
+    probe_seen[row] &= ~bit;
+    if (probe_pending_count < LATENCY_PROBE_PENDING) {
+        probe_pending[probe_pending_count++] = (latency_probe_pending_t){.row = row, .col = col, .submitted = false, .edge = probe_edge[row][col]};
+    }
+}
+
+static void latency_probe_record(const latency_probe_pending_t *pending, uint32_t done) {
+    latency_probe_stats_t *stats   = &probe_stats[pending->row][pending->col];
+    uint32_t               latency = task_profile_ticks_to_us(task_profile_ticks_diff(done, pending->edge));
+    uint32_t               submit  = task_profile_ticks_to_us(task_profile_ticks_diff(pending->submit, pending->edge));
+    uint16_t               clamped = latency > UINT16_MAX ? UINT16_MAX : latency;
+
+    if (stats->count == UINT16_MAX) {
+        return;
+    }
+    if (stats->count == 0 || clamped < stats->min) {
+        stats->min = clamped;
+    }
+    if (clamped > stats->max) {
+        stats->max = clamped;
+    }
+    stats->count++;
+    stats->total += latency;
+    stats->total_submit += submit;
+
+    uint32_t bucket = latency / LATENCY_PROBE_BUCKET_US;
+    stats->histogram[bucket < LATENCY_PROBE_HISTOGRAM_SIZE ? bucket : LATENCY_PROBE_HISTOGRAM_SIZE - 1]++;
+    probe_updated = true;
+}
+
+static void latency_probe_remove(uint8_t index) { probe_pending[index] = probe_pending[--probe_pending_count]; }
+
+/** \brief A keyboard report is about to be handed to the driver */
+void latency_probe_report_sent(void) {
+    uint32_t now = task_profile_ticks();
+    for (uint8_t i = 0; i < probe_pending_count; i++) {
+        if (!probe_pending[i].submitted) {
+            probe_pending[i].submitted = true;
+            probe_pending[i].submit    = now;
+        }
+    }
+#ifndef PROTOCOL_CHIBIOS
+    // No IN completion to wait for
+    for (uint8_t i = probe_pending_count; i-- > 0;) {
+        latency_probe_record(&probe_pending[i], now);
+        latency_probe_remove(i);
+    }
+#endif
+}
+
+/** \brief The keyboard endpoint transmitted everything it had queued
+ *
+ * Called from the USB IN callback (ISR, locked state).
+ */
+void latency_probe_report_done_I(void) {
+    probe_done_time = task_profile_ticks();
+    probe_done_count++;
+}
+
+/** \brief Settles the keys the host took and prints the stats that changed */
+void latency_probe_task(void) {
+    uint8_t  done_count;
+    uint32_t done_time;
+    ATOMIC_BLOCK_FORCEON {
+        done_count = probe_done_count;
+        done_time  = probe_done_time;
+    }
+    bool     done = done_count != probe_done_seen;
+    uint32_t now  = task_profile_ticks();
+    probe_done_seen = done_count;
+
+    for (uint8_t i = probe_pending_count; i-- > 0;) {
+        latency_probe_pending_t *pending = &probe_pending[i];
+        if (!pending->submitted) {
+            // The event didn't send a report
+            latency_probe_remove(i);
+        } else if (done && (int32_t)task_profile_ticks_diff(done_time, pending->submit) >= 0) {
+            latency_probe_record(pending, done_time);
+            latency_probe_remove(i);
+        } else if (task_profile_ticks_diff(now, pending->submit) > probe_stale_ticks()) {
+            // The host stopped polling
+            latency_probe_remove(i);
+        }
+    }
+
+#ifdef CONSOLE_ENABLE
+    static uint32_t last_print = 0;
+    if (!probe_updated || timer_elapsed32(last_print) < LATENCY_PROBE_PRINT_INTERVAL) {
+        return;
+    }
+    last_print    = timer_read32();
+    probe_updated = false;
+
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            const latency_probe_stats_t *stats = &probe_stats[row][col];
+            if (stats->count == 0) {
+                continue;
+            }
+            dprintf("latency %u,%u: %u events, send avg %lu us, host min %u avg %lu max %u us, ms:", row, col, stats->count, (unsigned long)(stats->total_submit / stats->count), stats->min, (unsigned long)(stats->total / stats->count), stats->max);
+            for (uint8_t bucket = 0; bucket < LATENCY_PROBE_HISTOGRAM_SIZE; bucket++) {
+                dprintf(" %u", stats->histogram[bucket]);
+            }
+            dprintf("\n");
+        }
+    }
+#endif
+}
+
+const latency_probe_stats_t *latency_probe_get(uint8_t row, uint8_t col) { return &probe_stats[row][col]; }
+
+void latency_probe_reset(void) { memset(probe_stats, 0, sizeof(probe_stats)); }
@@ -0,0 +1,57 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+#ifndef LATENCY_PROBE_HISTOGRAM_SIZE
+#    define LATENCY_PROBE_HISTOGRAM_SIZE 16
+#endif
+#ifndef LATENCY_PROBE_BUCKET_US
+#    define LATENCY_PROBE_BUCKET_US 1000
+#endif
+
+/* Per key, from the first raw matrix edge to the host taking the report.
+ * Bucket n counts the latencies from n to n + 1 buckets of
+ * LATENCY_PROBE_BUCKET_US, the last one everything longer. */
+typedef struct {
+    uint16_t count;
+    uint16_t min;           // us
+    uint16_t max;           // us
+    uint32_t total;         // us
+    uint32_t total_submit;  // us, up to host_keyboard_send()
+    uint16_t histogram[LATENCY_PROBE_HISTOGRAM_SIZE];
+} latency_probe_stats_t;
+
+#ifdef LATENCY_PROBE
+void latency_probe_raw_matrix(const matrix_row_t *raw, uint8_t first_row, uint8_t rows, bool changed);
+void latency_probe_event(uint8_t row, uint8_t col);
+void latency_probe_report_sent(void);
+void latency_probe_report_done_I(void);
+void latency_probe_task(void);
+void latency_probe_reset(void);
+
+const latency_probe_stats_t *latency_probe_get(uint8_t row, uint8_t col);
+#else
+#    define latency_probe_raw_matrix(raw, first_row, rows, changed)
+#    define latency_probe_event(row, col)
+#    define latency_probe_report_sent()
+#    define latency_probe_report_done_I()
+#    define latency_probe_task()
+#endif
@@ -15,3 +15,64 @@
 #    define strcpy_P(dest, src) strcpy(dest, src)
 #    define strlen_P(src) strlen(src)
 #endif
+
+/* Hot tables
+ *
+ * Lookup tables read in hot paths can be kept in RAM instead of flash on AVR,
+ * where every flash read is an LPM through the Z register. A table is
+ * declared and read with its name from the list below:
+ *
+ *   const uint8_t CIE1931_CURVE[256] HOT_TABLE(CIE1931_CURVE) = {...};
+ *   v = hot_read_byte(CIE1931_CURVE, &CIE1931_CURVE[i]);
+ *
+ * Tables placed in RAM are copied there from flash at startup along with the
+ * rest of .data. Up to HOT_TABLE_RAM_BUDGET bytes are given out, one whole
+ * table at a time in the order below, to those the build includes. Elsewhere
+ * flash reads are plain loads already, and every table stays in flash.
+ */
+#ifndef HOT_TABLE_RAM_BUDGET
+#    define HOT_TABLE_RAM_BUDGET 0
+#endif
+
+#if defined(__AVR__) && defined(USE_CIE1931_CURVE) && HOT_TABLE_RAM_BUDGET >= 256
+#    define HOT_TABLE_IN_RAM_CIE1931_CURVE 1
+#    define HOT_TABLE_USED_CIE1931_CURVE 256
+#else
+#    define HOT_TABLE_IN_RAM_CIE1931_CURVE 0
+#    define HOT_TABLE_USED_CIE1931_CURVE 0
+#endif
+
+// Read from the backlight PWM interrupt, BREATHING_STEPS bytes
+#if defined(__AVR__) && defined(BACKLIGHT_BREATHING) && HOT_TABLE_RAM_BUDGET - HOT_TABLE_USED_CIE1931_CURVE >= 128
+#    define HOT_TABLE_IN_RAM_BACKLIGHT_BREATHING 1
+#    define HOT_TABLE_USED_BACKLIGHT_BREATHING (HOT_TABLE_USED_CIE1931_CURVE + 128)
+#else
+#    define HOT_TABLE_IN_RAM_BACKLIGHT_BREATHING 0
+#    define HOT_TABLE_USED_BACKLIGHT_BREATHING HOT_TABLE_USED_CIE1931_CURVE
+#endif
+
+// Read from the sleep LED timer interrupt
+#if defined(__AVR__) && defined(SLEEP_LED_ENABLE) && HOT_TABLE_RAM_BUDGET - HOT_TABLE_USED_BACKLIGHT_BREATHING >= 64
+#    define HOT_TABLE_IN_RAM_SLEEP_LED_BREATHING 1
+#    define HOT_TABLE_USED_SLEEP_LED_BREATHING (HOT_TABLE_USED_BACKLIGHT_BREATHING + 64)
+#else
+#    define HOT_TABLE_IN_RAM_SLEEP_LED_BREATHING 0
+#    define HOT_TABLE_USED_SLEEP_LED_BREATHING HOT_TABLE_USED_BACKLIGHT_BREATHING
+#endif
+
+// Read for every LED of every rgblight frame, RGBLED_NUM bytes
+#if defined(__AVR__) && defined(RGBLIGHT_LED_MAP) && defined(RGBLED_NUM) && HOT_TABLE_RAM_BUDGET - HOT_TABLE_USED_SLEEP_LED_BREATHING >= RGBLED_NUM
+#    define HOT_TABLE_IN_RAM_RGBLIGHT_LED_MAP 1
+#else
+#    define HOT_TABLE_IN_RAM_RGBLIGHT_LED_MAP 0
+#endif
+
+#define HOT_TABLE_PLACE_0 PROGMEM
+#define HOT_TABLE_PLACE_1
+#define HOT_TABLE_PLACE_(in_ram) HOT_TABLE_PLACE_##in_ram
+#define HOT_TABLE_PLACE(in_ram) HOT_TABLE_PLACE_(in_ram)
+// PROGMEM, or nothing for a table given RAM
+#define HOT_TABLE(name) HOT_TABLE_PLACE(HOT_TABLE_IN_RAM_##name)
+
+#define hot_read_byte(name, address) (HOT_TABLE_IN_RAM_##name ? *(const uint8_t*)(address) : pgm_read_byte(address))
+#define hot_read_word(name, address) (HOT_TABLE_IN_RAM_##name ? *(const uint16_t*)(address) : pgm_read_word(address))
@@ -1,5 +1,15 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+
 void raw_hid_receive(uint8_t *data, uint8_t length);
 
 void raw_hid_send(uint8_t *data, uint8_t length);
+
+#ifdef RAW_HID_ZERO_COPY
+/* ChibiOS only. Called instead of raw_hid_receive() with the packet in the
+ * endpoint's own buffer, and reply pointing to the RAW_EPSIZE bytes of the
+ * next packet to the host. Returns whether to send the reply. */
+bool raw_hid_receive_zero_copy(uint8_t *data, uint8_t *reply, uint8_t length);
+#endif
@@ -21,6 +21,16 @@
 #include "util.h"
 #include <string.h>
 
+#ifdef USB_6KRO_ENABLE
+#    define RO_ADD(a, b) ((a + b) % KEYBOARD_REPORT_KEYS)
+#    define RO_SUB(a, b) ((a - b + KEYBOARD_REPORT_KEYS) % KEYBOARD_REPORT_KEYS)
+#    define RO_INC(a) RO_ADD(a, 1)
+#    define RO_DEC(a) RO_SUB(a, 1)
+static int8_t cb_head  = 0;
+static int8_t cb_tail  = 0;
+static int8_t cb_count = 0;
+#endif
+
 /** \brief has_anykey
  *
  * FIXME: Needs doc
@@ -51,7 +61,7 @@ uint8_t get_first_key(report_keyboard_t* keyboard_report) {
         uint8_t i = 0;
         for (; i < KEYBOARD_REPORT_BITS && !keyboard_report->nkro.bits[i]; i++)
             ;
-        return i << 3 | biton(keyboard_report->nkro.bits[i]);
+        return i < KEYBOARD_REPORT_BITS ? i << 3 | biton(keyboard_report->nkro.bits[i]) : 0;
     }
 #endif
 #ifdef USB_6KRO_ENABLE
@@ -94,6 +104,33 @@ bool is_key_pressed(report_keyboard_t* keyboard_report, uint8_t key) {
     return false;
 }
 
+/** \brief Compares two keyboard reports
+ *
+ * Returns KEYBOARD_REPORT_PRESSED if any key or mod is down in to but not in from,
+ * and KEYBOARD_REPORT_RELEASED if any is down in from but not in to
+ */
+uint8_t keyboard_report_changes(report_keyboard_t* from, report_keyboard_t* to) {
+    uint8_t changes = 0;
+    if (to->mods & ~from->mods) changes |= KEYBOARD_REPORT_PRESSED;
+    if (from->mods & ~to->mods) changes |= KEYBOARD_REPORT_RELEASED;
+#ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) {
+        // Both flags can be set before the end of the bitfield
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS && changes != (KEYBOARD_REPORT_PRESSED | KEYBOARD_REPORT_RELEASED); i++) {
+            uint8_t diff = to->nkro.bits[i] ^ from->nkro.bits[i];
+            if (diff & to->nkro.bits[i]) changes |= KEYBOARD_REPORT_PRESSED;
+            if (diff & from->nkro.bits[i]) changes |= KEYBOARD_REPORT_RELEASED;
+        }
+        return changes;
+    }
+#endif
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (!is_key_pressed(from, to->keys[i]) && to->keys[i]) changes |= KEYBOARD_REPORT_PRESSED;
+        if (!is_key_pressed(to, from->keys[i]) && from->keys[i]) changes |= KEYBOARD_REPORT_RELEASED;
+    }
+    return changes;
+}
+
 /** \brief add key byte
  *
  * FIXME: Needs doc
@@ -192,9 +229,11 @@ void del_key_byte(report_keyboard_t* keyboard_report, uint8_t code) {
         } while (i != cb_tail);
     }
 #else
+    // add_key_byte() never adds a key twice
     for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
         if (keyboard_report->keys[i] == code) {
             keyboard_report->keys[i] = 0;
+            break;
         }
     }
 #endif
@@ -265,6 +304,9 @@ void clear_keys_from_report(report_keyboard_t* keyboard_report) {
         memset(keyboard_report->nkro.bits, 0, sizeof(keyboard_report->nkro.bits));
         return;
     }
+#endif
+#ifdef USB_6KRO_ENABLE
+    cb_head = cb_tail = cb_count = 0;
 #endif
     memset(keyboard_report->keys, 0, sizeof(keyboard_report->keys));
 }
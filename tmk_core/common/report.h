@@ -131,6 +131,9 @@ enum desktop_usages {
 #        define KEYBOARD_REPORT_BITS (NKRO_EPSIZE - 1)
 #        undef NKRO_SHARED_EP
 #        undef MOUSE_SHARED_EP
+#    elif defined(PROTOCOL_NATIVE)
+/* As large as over USB, where the report shares the 32 byte endpoint */
+#        define KEYBOARD_REPORT_BITS (32 - 2)
 #    else
 #        error "NKRO not supported with this protocol"
 #    endif
@@ -194,15 +197,27 @@ typedef struct {
     uint16_t usage;
 } __attribute__((packed)) report_extra_t;
 
+#ifdef MOUSE_EXTENDED_REPORT
+#    ifdef PROTOCOL_ARM_ATSAM
+#        error "MOUSE_EXTENDED_REPORT is not supported by the arm_atsam protocol"
+#    endif
+/* 16 bit cursor movement, so high CPI sensors aren't clamped */
+typedef int16_t mouse_xy_report_t;
+#    define MOUSE_REPORT_XY_MAX 32767
+#else
+typedef int8_t mouse_xy_report_t;
+#    define MOUSE_REPORT_XY_MAX 127
+#endif
+
 typedef struct {
 #ifdef MOUSE_SHARED_EP
     uint8_t report_id;
 #endif
-    uint8_t buttons;
-    int8_t  x;
-    int8_t  y;
-    int8_t  v;
-    int8_t  h;
+    uint8_t           buttons;
+    mouse_xy_report_t x;
+    mouse_xy_report_t y;
+    int8_t            v;
+    int8_t            h;
 } __attribute__((packed)) report_mouse_t;
 
 typedef struct {
@@ -302,6 +317,11 @@ void add_key_to_report(report_keyboard_t* keyboard_report, uint8_t key);
 void del_key_from_report(report_keyboard_t* keyboard_report, uint8_t key);
 void clear_keys_from_report(report_keyboard_t* keyboard_report);
 
+#define KEYBOARD_REPORT_PRESSED 0x01
+#define KEYBOARD_REPORT_RELEASED 0x02
+
+uint8_t keyboard_report_changes(report_keyboard_t* from, report_keyboard_t* to);
+
 #ifdef __cplusplus
 }
 #endif
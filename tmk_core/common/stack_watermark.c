@@ -0,0 +1,106 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stack_watermark.h"
+#include "timer.h"
+#include "debug.h"
+
+#ifndef STACK_WATERMARK_PRINT_INTERVAL
+#    define STACK_WATERMARK_PRINT_INTERVAL 5000
+#endif
+
+#if defined(__AVR__)
+#    define STACK_WATERMARK_PATTERN 0xA5
+
+extern uint8_t _end;
+extern uint8_t __stack;
+
+/* Runs from .init3, after the stack pointer is set up and before .data and
+ * .bss are initialised, with nothing on the stack yet. Anything malloc()
+ * puts behind .bss shows up as stack use. */
+void stack_watermark_paint(void) __attribute__((naked, used, section(".init3")));
+void stack_watermark_paint(void) {
+    uint8_t *p = &_end;
+    while (p <= &__stack) {
+        *p++ = STACK_WATERMARK_PATTERN;
+    }
+}
+
+static void stack_watermark_measure(const uint8_t *bottom, const uint8_t *top, stack_watermark_t *watermark) {
+    const uint8_t *p = bottom;
+    while (p < top && *p == STACK_WATERMARK_PATTERN) {
+        p++;
+    }
+    watermark->size = top - bottom;
+    watermark->used = top - p;
+}
+
+void stack_watermark_get(uint8_t stack, stack_watermark_t *watermark) {
+    (void)stack;
+    stack_watermark_measure(&_end, &__stack + 1, watermark);
+}
+#elif defined(PROTOCOL_CHIBIOS)
+// CRT0_STACKS_FILL_PATTERN, written by crt0 when CRT0_INIT_STACKS is on (the default)
+#    define STACK_WATERMARK_PATTERN 0x55555555
+
+extern uint32_t __main_stack_base__, __main_stack_end__;
+extern uint32_t __process_stack_base__, __process_stack_end__;
+
+static void stack_watermark_measure(const uint32_t *bottom, const uint32_t *top, stack_watermark_t *watermark) {
+    const uint32_t *p = bottom;
+    while (p < top && *p == STACK_WATERMARK_PATTERN) {
+        p++;
+    }
+    watermark->size = (top - bottom) * sizeof(uint32_t);
+    watermark->used = (top - p) * sizeof(uint32_t);
+}
+
+void stack_watermark_get(uint8_t stack, stack_watermark_t *watermark) {
+    if (stack == STACK_WATERMARK_EXCEPTIONS) {
+        stack_watermark_measure(&__main_stack_base__, &__main_stack_end__, watermark);
+    } else {
+        stack_watermark_measure(&__process_stack_base__, &__process_stack_end__, watermark);
+    }
+}
+#else
+// No fill pattern to measure against
+void stack_watermark_get(uint8_t stack, stack_watermark_t *watermark) {
+    (void)stack;
+    watermark->size = 0;
+    watermark->used = 0;
+}
+#endif
+
+void stack_watermark_task(void) {
+#ifdef CONSOLE_ENABLE
+    static uint32_t last_print                      = 0;
+    static uint16_t last_used[STACK_WATERMARK_COUNT] = {0};
+    if (timer_elapsed32(last_print) < STACK_WATERMARK_PRINT_INTERVAL) {
+        return;
+    }
+    last_print = timer_read32();
+
+    // Only print a stack when it went deeper than before
+    for (uint8_t stack = 0; stack < STACK_WATERMARK_COUNT; stack++) {
+        stack_watermark_t watermark;
+        stack_watermark_get(stack, &watermark);
+        if (watermark.used > last_used[stack]) {
+            last_used[stack] = watermark.used;
+            dprintf("stack %u: %u of %u bytes used, %u free\n", stack, watermark.used, watermark.size, watermark.size - watermark.used);
+        }
+    }
+#endif
+}
@@ -0,0 +1,43 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Stack high-water marks, measured from the fill pattern the startup code
+ * leaves in the unused part of the stack. On AVR the free RAM between the end
+ * of .bss and the top of RAM is painted before main(), on ChibiOS the crt0
+ * fill of the main and process stacks is used. */
+typedef struct {
+    uint16_t size;  // bytes, on AVR the RAM left after .data and .bss
+    uint16_t used;  // bytes, the deepest the stack has been
+} stack_watermark_t;
+
+enum stack_watermark_stack {
+    STACK_WATERMARK_MAIN,  // the stack main() runs on
+#ifdef PROTOCOL_CHIBIOS
+    STACK_WATERMARK_EXCEPTIONS,  // the ChibiOS main stack, used by interrupts
+#endif
+    STACK_WATERMARK_COUNT
+};
+
+#ifdef STACK_WATERMARK
+void stack_watermark_get(uint8_t stack, stack_watermark_t *watermark);
+void stack_watermark_task(void);
+#else
+#    define stack_watermark_task()
+#endif
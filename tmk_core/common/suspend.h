@@ -7,6 +7,7 @@ void suspend_idle(uint8_t timeout);
 void suspend_power_down(void);
 bool suspend_wakeup_condition(void);
 void suspend_wakeup_init(void);
+void suspend_wakeup_replay(void);
 
 void suspend_wakeup_init_user(void);
 void suspend_wakeup_init_kb(void);
@@ -16,3 +17,7 @@ void suspend_power_down_kb(void);
 #ifndef USB_SUSPEND_WAKEUP_DELAY
 #    define USB_SUSPEND_WAKEUP_DELAY 0
 #endif
+// Longest wait after a remote wakeup for the host to resume before the keyboard carries on without it
+#ifndef USB_RESUME_TIMEOUT
+#    define USB_RESUME_TIMEOUT 2000
+#endif
@@ -27,13 +27,77 @@ SOFTWARE.
 #include "keyboard.h"
 
 #if defined(SPLIT_KEYBOARD) && !defined(DISABLE_SYNC_TIMER)
+#    ifndef SYNC_TIMER_SLEW
+#        define SYNC_TIMER_SLEW 1
+#    endif
+#    ifndef SYNC_TIMER_STEP
+#        define SYNC_TIMER_STEP 50
+#    endif
+#    ifndef SYNC_TIMER_WINDOW
+#        define SYNC_TIMER_WINDOW 16
+#    endif
+
 volatile int32_t sync_timer_ms;
 
-void sync_timer_init(void) { sync_timer_ms = 0; }
+// Slave only
+static bool     sync_timer_synced = false;
+static uint32_t sync_timer_last_time;  // the last time the master sent
+static uint32_t sync_timer_last_read;  // the last time sync_timer_read32() returned on the slave
+static int32_t  sync_timer_window_error;
+static uint8_t  sync_timer_window_count;
+static uint8_t  sync_timer_quality = SYNC_TIMER_UNSYNCED;
+
+void sync_timer_init(void) {
+    sync_timer_ms      = 0;
+    sync_timer_synced  = false;
+    sync_timer_quality = SYNC_TIMER_UNSYNCED;
+}
 
+/*
+ * time is the master's clock when the slave received it, as far as the master can tell from the
+ * link delay. Handling the update late only makes the master look behind, never ahead, so the
+ * slave catches up with a master that is ahead straight away, but only falls back when every
+ * update of a window says so. Either way it moves by at most SYNC_TIMER_SLEW at once, so that
+ * timers and animations don't jump, unless it is off by more than SYNC_TIMER_STEP.
+ */
 void sync_timer_update(uint32_t time) {
     if (is_keyboard_master()) return;
-    sync_timer_ms = time - timer_read32();
+    // The same update read again is no newer than the first time
+    if (sync_timer_synced && time == sync_timer_last_time) return;
+    sync_timer_last_time = time;
+
+    uint32_t now   = timer_read32();
+    int32_t  error = (int32_t)(time - now) - sync_timer_ms;
+    if (!sync_timer_synced || error > SYNC_TIMER_STEP || error < -SYNC_TIMER_STEP) {
+        sync_timer_ms           = time - now;
+        sync_timer_last_read    = time;
+        sync_timer_synced       = true;
+        sync_timer_quality      = 0;
+        sync_timer_window_count = 0;
+        return;
+    }
+
+    if (error > 0) {
+        sync_timer_ms += error < SYNC_TIMER_SLEW ? error : SYNC_TIMER_SLEW;
+    }
+    if (sync_timer_window_count == 0 || error > sync_timer_window_error) {
+        sync_timer_window_error = error;
+    }
+    if (++sync_timer_window_count < SYNC_TIMER_WINDOW) return;
+
+    error                   = sync_timer_window_error;
+    sync_timer_window_count = 0;
+    if (error < 0) {
+        // Even the update that arrived soonest found the slave ahead, its clock runs faster than the master's
+        sync_timer_ms -= -error < SYNC_TIMER_SLEW ? -error : SYNC_TIMER_SLEW;
+        error = -error;
+    }
+    sync_timer_quality = error < SYNC_TIMER_UNSYNCED ? error : SYNC_TIMER_UNSYNCED - 1;
+}
+
+uint8_t sync_timer_error(void) {
+    if (is_keyboard_master()) return 0;
+    return sync_timer_quality;
 }
 
 uint16_t sync_timer_read(void) {
@@ -43,7 +107,11 @@ uint16_t sync_timer_read(void) {
 
 uint32_t sync_timer_read32(void) {
     if (is_keyboard_master()) return timer_read32();
-    return sync_timer_ms + timer_read32();
+    uint32_t time = sync_timer_ms + timer_read32();
+    // Falling back to the master's clock holds the slave's still rather than going back in time
+    if ((int32_t)(time - sync_timer_last_read) < 0) return sync_timer_last_read;
+    sync_timer_last_read = time;
+    return time;
 }
 
 uint16_t sync_timer_elapsed(uint16_t last) {
@@ -32,9 +32,13 @@ SOFTWARE.
 extern "C" {
 #endif
 
+// What sync_timer_error() returns on a slave that has not heard from the master yet
+#define SYNC_TIMER_UNSYNCED 0xFF
+
 #if defined(SPLIT_KEYBOARD) && !defined(DISABLE_SYNC_TIMER)
 void     sync_timer_init(void);
 void     sync_timer_update(uint32_t time);
+uint8_t  sync_timer_error(void);  // how far off the master's clock the slave's was lately, in ms
 uint16_t sync_timer_read(void);
 uint32_t sync_timer_read32(void);
 uint16_t sync_timer_elapsed(uint16_t last);
@@ -43,6 +47,7 @@ uint32_t sync_timer_elapsed32(uint32_t last);
 #    define sync_timer_init()
 #    define sync_timer_clear()
 #    define sync_timer_update(t)
+#    define sync_timer_error() 0
 #    define sync_timer_read() timer_read()
 #    define sync_timer_read32() timer_read32()
 #    define sync_timer_elapsed(t) timer_elapsed(t)
@@ -0,0 +1,153 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "task_profile.h"
+#include "timer.h"
+#include "debug.h"
+
+#if defined(PROTOCOL_CHIBIOS)
+#    include <ch.h>
+#    include <hal.h>
+#elif defined(__AVR__)
+#    include <avr/io.h>
+#    include <util/atomic.h>
+#endif
+
+#ifndef TASK_PROFILE_PRINT_INTERVAL
+#    define TASK_PROFILE_PRINT_INTERVAL 1000
+#endif
+
+#if defined(PROTOCOL_CHIBIOS) && defined(CORTEX_MODEL) && CORTEX_MODEL >= 3
+// DWT cycle counter, it runs at the core clock
+#    ifndef TASK_PROFILE_TICK_FREQUENCY
+#        if defined(STM32_SYSCLK)
+#            define TASK_PROFILE_TICK_FREQUENCY STM32_SYSCLK
+#        elif defined(KINETIS_SYSCLK_FREQUENCY)
+#            define TASK_PROFILE_TICK_FREQUENCY KINETIS_SYSCLK_FREQUENCY
+#        else
+#            error "TASK_PROFILE_TICK_FREQUENCY must be set to the core clock"
+#        endif
+#    endif
+// Left running, timer_read_us() may be counting off it too
+static void task_profile_counter_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+uint32_t               task_profile_ticks(void) { return DWT->CYCCNT; }
+uint32_t               task_profile_ticks_diff(uint32_t now, uint32_t start) { return now - start; }
+#elif defined(PROTOCOL_CHIBIOS)
+// Cortex-M0 has no cycle counter, fall back to the system tick
+#    define TASK_PROFILE_TICK_FREQUENCY CH_CFG_ST_FREQUENCY
+static void            task_profile_counter_init(void) {}
+uint32_t               task_profile_ticks(void) { return (uint32_t)chVTGetSystemTimeX(); }
+uint32_t               task_profile_ticks_diff(uint32_t now, uint32_t start) { return (uint32_t)chTimeDiffX((systime_t)start, (systime_t)now); }
+#elif defined(__AVR__)
+// Timer0 already counts the milliseconds, its counter register adds the fraction
+#    define TASK_PROFILE_TICK_FREQUENCY ((uint32_t)(TIMER_RAW_TOP + 1) * 1000)
+static void task_profile_counter_init(void) {}
+uint32_t    task_profile_ticks(void) {
+    uint32_t count;
+    uint8_t  raw;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        count = timer_count;
+        raw   = TIMER_RAW;
+        // The counter started over but the compare interrupt hasn't had a chance to run yet
+        if (TIMER_COMPARE_PENDING() && raw < TIMER_RAW_TOP / 2) {
+            count++;
+        }
+    }
+    return count * (TIMER_RAW_TOP + 1) + raw;
+}
+uint32_t task_profile_ticks_diff(uint32_t now, uint32_t start) { return now - start; }
+#else
+#    define TASK_PROFILE_TICK_FREQUENCY 1000
+static void            task_profile_counter_init(void) {}
+uint32_t               task_profile_ticks(void) { return timer_read32(); }
+uint32_t               task_profile_ticks_diff(uint32_t now, uint32_t start) { return now - start; }
+#endif
+
+void task_profile_init(void) {
+    task_profile_counter_init();
+#ifdef CONSOLE_ENABLE
+    debug_enable = true;
+#endif
+}
+
+uint32_t task_profile_tick_frequency(void) { return TASK_PROFILE_TICK_FREQUENCY; }
+
+uint32_t task_profile_ticks_to_us(uint32_t ticks) { return (uint32_t)((uint64_t)ticks * 1000000 / TASK_PROFILE_TICK_FREQUENCY); }
+
+#ifdef KEYBOARD_TASK_PROFILE
+static task_profile_stats_t task_profile_stats[TASK_PROFILE_STAGE_COUNT];
+
+void task_profile_record(task_profile_stage_t stage, uint32_t start) {
+    uint32_t              ticks = task_profile_ticks_diff(task_profile_ticks(), start);
+    task_profile_stats_t *stats = &task_profile_stats[stage];
+
+    if (stats->count == 0 || ticks < stats->min) {
+        stats->min = ticks;
+    }
+    if (ticks > stats->max) {
+        stats->max = ticks;
+    }
+    stats->count++;
+    stats->total += ticks;
+
+    uint8_t bucket = 0;
+    while (bucket < TASK_PROFILE_HISTOGRAM_SIZE - 1 && (ticks >> bucket)) {
+        bucket++;
+    }
+    if (stats->histogram[bucket] < UINT16_MAX) {
+        stats->histogram[bucket]++;
+    }
+}
+
+const task_profile_stats_t *task_profile_get(task_profile_stage_t stage) { return &task_profile_stats[stage]; }
+
+void task_profile_reset(void) { memset(task_profile_stats, 0, sizeof(task_profile_stats)); }
+
+/** \brief Prints the stages that ran since the last print and starts over
+ *
+ * Only enabled with the console, otherwise the stats keep adding up until task_profile_reset().
+ */
+void task_profile_task(void) {
+#ifdef CONSOLE_ENABLE
+    static const char *const stage_names[TASK_PROFILE_STAGE_COUNT] = {
+        [TASK_PROFILE_KEYBOARD_TASK] = "keyboard_task", [TASK_PROFILE_MATRIX_SCAN] = "matrix_scan", [TASK_PROFILE_DEBOUNCE] = "debounce", [TASK_PROFILE_ACTION_EXEC] = "action_exec", [TASK_PROFILE_ENCODER] = "encoder", [TASK_PROFILE_POINTING_DEVICE] = "pointing_device", [TASK_PROFILE_RGBLIGHT] = "rgblight", [TASK_PROFILE_RGB_MATRIX] = "rgb_matrix", [TASK_PROFILE_BACKLIGHT] = "backlight", [TASK_PROFILE_OLED] = "oled", [TASK_PROFILE_OTHER] = "other", [TASK_PROFILE_CONSOLE] = "console", [TASK_PROFILE_RAW_HID] = "raw_hid",
+    };
+    static uint32_t last_print = 0;
+
+    if (timer_elapsed32(last_print) < TASK_PROFILE_PRINT_INTERVAL) {
+        return;
+    }
+    last_print = timer_read32();
+
+    for (uint8_t stage = 0; stage < TASK_PROFILE_STAGE_COUNT; stage++) {
+        const task_profile_stats_t *stats = &task_profile_stats[stage];
+        if (stats->count == 0) {
+            continue;
+        }
+        dprintf("%s: %lu runs, min %lu avg %lu max %lu us, ticks <2^n:", stage_names[stage], (unsigned long)stats->count, (unsigned long)task_profile_ticks_to_us(stats->min), (unsigned long)task_profile_ticks_to_us((uint32_t)(stats->total / stats->count)), (unsigned long)task_profile_ticks_to_us(stats->max));
+        for (uint8_t bucket = 0; bucket < TASK_PROFILE_HISTOGRAM_SIZE; bucket++) {
+            dprintf(" %u", stats->histogram[bucket]);
+        }
+        dprintf("\n");
+    }
+    task_profile_reset();
+#endif
+}
+#endif
@@ -0,0 +1,85 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Stages of the main loop that KEYBOARD_TASK_PROFILE times. They nest:
+ * matrix_scan includes debounce and everything matrix_scan_quantum() runs,
+ * keyboard_task includes all the stages but console and raw_hid. */
+typedef enum {
+    TASK_PROFILE_KEYBOARD_TASK,
+    TASK_PROFILE_MATRIX_SCAN,
+    TASK_PROFILE_DEBOUNCE,
+    TASK_PROFILE_ACTION_EXEC,
+    TASK_PROFILE_ENCODER,
+    TASK_PROFILE_POINTING_DEVICE,
+    TASK_PROFILE_RGBLIGHT,
+    TASK_PROFILE_RGB_MATRIX,
+    TASK_PROFILE_BACKLIGHT,
+    TASK_PROFILE_OLED,
+    TASK_PROFILE_OTHER,  // deferrable tasks without a stage of their own
+    TASK_PROFILE_CONSOLE,
+    TASK_PROFILE_RAW_HID,
+    TASK_PROFILE_STAGE_COUNT,
+} task_profile_stage_t;
+
+// Bucket n counts the runs that took less than 2^n ticks, the last one everything longer
+#ifndef TASK_PROFILE_HISTOGRAM_SIZE
+#    define TASK_PROFILE_HISTOGRAM_SIZE 16
+#endif
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;    // ticks
+    uint32_t max;    // ticks
+    uint64_t total;  // ticks
+    uint16_t histogram[TASK_PROFILE_HISTOGRAM_SIZE];  // saturates at UINT16_MAX
+} task_profile_stats_t;
+
+#ifdef TASK_PROFILE_COUNTER
+// The tick counter, also used by the latency probe and the RGB matrix benchmark
+void     task_profile_init(void);
+uint32_t task_profile_ticks(void);
+uint32_t task_profile_ticks_diff(uint32_t now, uint32_t start);
+uint32_t task_profile_tick_frequency(void);
+uint32_t task_profile_ticks_to_us(uint32_t ticks);
+#else
+#    define task_profile_init()
+#endif
+
+#ifdef KEYBOARD_TASK_PROFILE
+void task_profile_task(void);
+void task_profile_record(task_profile_stage_t stage, uint32_t start);
+void task_profile_reset(void);
+
+const task_profile_stats_t *task_profile_get(task_profile_stage_t stage);
+
+// Runs the statements and records how long they took under the given stage
+#    define TASK_PROFILE(stage, ...)                            \
+        do {                                                    \
+            uint32_t task_profile_start = task_profile_ticks(); \
+            __VA_ARGS__;                                        \
+            task_profile_record(stage, task_profile_start);     \
+        } while (0)
+#else
+#    define task_profile_task()
+#    define TASK_PROFILE(stage, ...) \
+        do {                         \
+            __VA_ARGS__;             \
+        } while (0)
+#endif
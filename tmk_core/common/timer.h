@@ -42,6 +42,9 @@ uint16_t timer_read(void);
 uint32_t timer_read32(void);
 uint16_t timer_elapsed(uint16_t last);
 uint32_t timer_elapsed32(uint32_t last);
+// Free running microseconds, wrapping at UINT32_MAX. Not every platform counts every one of them, see docs/ref_functions.md
+uint32_t timer_read_us(void);
+uint32_t timer_elapsed_us(uint32_t last);
 
 // Utility functions to check if a future time has expired & autmatically handle time wrapping if checked / reset frequently (half of max value)
 #define timer_expired(current, future) ((uint16_t)(current - future) < UINT16_MAX / 2)
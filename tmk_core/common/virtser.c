@@ -0,0 +1,63 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+
+#include "virtser.h"
+
+__attribute__((weak)) void virtser_recv(const uint8_t ch) {
+    // Ignore by default
+}
+
+#ifdef VIRTSER_LINE_SIZE
+static char    virtser_line[VIRTSER_LINE_SIZE + 1];
+static uint8_t virtser_line_length   = 0;
+static bool    virtser_line_overflow = false;  // the line in progress is dropped
+
+__attribute__((weak)) void virtser_recv_line(char *line, uint8_t length) {
+    // Ignore by default
+}
+
+static void virtser_line_add(uint8_t ch) {
+    if (ch == '\r' || ch == '\n') {
+        // Empty lines, including the one between the \r and \n of a \r\n, are skipped
+        if (virtser_line_length && !virtser_line_overflow) {
+            virtser_line[virtser_line_length] = 0;
+            virtser_recv_line(virtser_line, virtser_line_length);
+        }
+        virtser_line_length   = 0;
+        virtser_line_overflow = false;
+    } else if (virtser_line_length < VIRTSER_LINE_SIZE) {
+        virtser_line[virtser_line_length++] = ch;
+    } else {
+        virtser_line_overflow = true;
+    }
+}
+#endif
+
+/** \brief Takes the bytes virtser_task() read in one go
+ *
+ * Hands each byte to virtser_recv(), and with VIRTSER_LINE_SIZE each complete line to virtser_recv_line().
+ * Define your own to take the whole block instead.
+ */
+__attribute__((weak)) void virtser_recv_buffer(const uint8_t *data, uint8_t length) {
+    for (uint8_t i = 0; i < length; i++) {
+        virtser_recv(data[i]);
+#ifdef VIRTSER_LINE_SIZE
+        virtser_line_add(data[i]);
+#endif
+    }
+}
@@ -1,7 +1,19 @@
 #pragma once
 
+#include <stdint.h>
+
 /* Define this function in your code to process incoming bytes */
 void virtser_recv(const uint8_t ch);
 
+/* Or this one to process them a block at a time, as they were read */
+void virtser_recv_buffer(const uint8_t *data, uint8_t length);
+
+/* With VIRTSER_LINE_SIZE defined, this one gets every complete line of up to that many characters, without
+ * its line ending and NUL terminated. The line can be modified in place, but not kept after returning. */
+void virtser_recv_line(char *line, uint8_t length);
+
 /* Call this to send a character over the Virtual Serial Device */
 void virtser_send(const uint8_t byte);
+
+/* Call this to send several characters over the Virtual Serial Device in one transfer */
+void virtser_send_buffer(const uint8_t *data, uint8_t length);
@@ -4,7 +4,7 @@ CC = gcc
 OBJCOPY =
 OBJDUMP =
 SIZE =
-AR =
+AR = ar
 NM =
 HEX =
 EEP =
@@ -61,12 +61,193 @@ static inline void     send_byte(uint8_t data);
 static inline uint16_t wait_data_lo(uint16_t us);
 static inline uint16_t wait_data_hi(uint16_t us);
 
+#ifdef ADB_ASYNC
+/*
+ * Non-blocking Talk
+ *
+ * Timer1 runs free at F_CPU / 8. adb_host_talk_start() pulls the line low for the attention signal and returns,
+ * the compare A interrupt ends it and sends the command, about a millisecond with interrupts off as the bit cells
+ * are too short to be timed by interrupts reliably. The device's service request, its stop to start time and
+ * its data are then timestamped edge by edge: exactly by the input capture unit if the data line is ICP1 and
+ * ADB_DATA_ICP is defined, otherwise by the external interrupt ADB_DATA_INT reading the timer, give or take the
+ * latency of the USB interrupts. The compare B interrupt ends the transfer once the line stays quiet.
+ */
+#    ifndef ADB_DATA_ICP
+#        ifndef ADB_DATA_INT
+#            define ADB_DATA_INT ADB_DATA_BIT  // INT0-3 are PD0-3 on the ATmega32U4
+#        endif
+#        define ADB_INT_VECT__(n) INT##n##_vect
+#        define ADB_INT_VECT_(n) ADB_INT_VECT__(n)
+#        define ADB_INT_VECT ADB_INT_VECT_(ADB_DATA_INT)
+#    endif
+
+#    define ADB_TICKS(us) ((uint16_t)((us) * (F_CPU / 8 / 1000000)))
+
+enum {
+    ASYNC_IDLE,
+    ASYNC_ATTENTION,
+    ASYNC_WAIT,  // for the end of a service request and the device's start bit
+    ASYNC_RECV,
+    ASYNC_DONE,  // until adb_host_talk_result()
+};
+
+static volatile uint8_t async_state = ASYNC_IDLE;
+static uint8_t          async_command;
+static uint8_t          async_buf[8];
+static uint8_t          async_cells;  // bit cells received, the start bit included
+static uint16_t         async_fall;   // when the current bit cell began
+static uint16_t         async_rise;
+
+static inline void edges_enable(void) {
+#    ifdef ADB_DATA_ICP
+    // Capture whichever edge comes next, a service request may be holding the line low
+    if (data_in()) {
+        TCCR1B &= ~(1 << ICES1);
+    } else {
+        TCCR1B |= (1 << ICES1);
+    }
+    TIFR1 = (1 << ICF1);
+    TIMSK1 |= (1 << ICIE1);
+#    else
+#        if ADB_DATA_INT < 4
+    EICRA = (EICRA & ~(3 << (ADB_DATA_INT * 2))) | (1 << (ADB_DATA_INT * 2));  // any edge
+#        else
+    EICRB = (EICRB & ~(3 << ((ADB_DATA_INT - 4) * 2))) | (1 << ((ADB_DATA_INT - 4) * 2));
+#        endif
+    EIFR = (1 << ADB_DATA_INT);
+    EIMSK |= (1 << ADB_DATA_INT);
+#    endif
+}
+
+static inline void edges_disable(void) {
+#    ifdef ADB_DATA_ICP
+    TIMSK1 &= ~(1 << ICIE1);
+#    else
+    EIMSK &= ~(1 << ADB_DATA_INT);
+#    endif
+}
+
+static void async_edge(uint16_t now, bool rising) {
+    if (async_state == ASYNC_WAIT) {
+        if (rising) {
+            return;  // the end of a service request
+        }
+        async_state = ASYNC_RECV;
+        async_cells = 0;
+    } else if (rising) {
+        async_rise = now;
+        OCR1B      = now + ADB_TICKS(130);
+        return;
+    } else if (async_cells > 0 && async_cells <= 8 * sizeof(async_buf)) {
+        // A falling edge ends the bit cell, a 1 is low for shorter than it is high
+        uint8_t n = async_cells - 1;
+        async_buf[n / 8] <<= 1;
+        if ((uint16_t)(async_rise - async_fall) < (uint16_t)(now - async_rise)) {
+            async_buf[n / 8] |= 1;
+        }
+    }
+    if (async_cells < 255) {
+        async_cells++;
+    }
+    async_fall = now;
+    OCR1B      = now + ADB_TICKS(130);
+}
+
+#    ifdef ADB_DATA_ICP
+ISR(TIMER1_CAPT_vect) {
+    uint16_t now    = ICR1;
+    bool     rising = TCCR1B & (1 << ICES1);
+    TCCR1B ^= (1 << ICES1);
+    TIFR1 = (1 << ICF1);
+    async_edge(now, rising);
+}
+#    else
+ISR(ADB_INT_VECT) { async_edge(TCNT1, data_in()); }
+#    endif
+
+ISR(TIMER1_COMPA_vect) {
+    TIMSK1 &= ~(1 << OCIE1A);
+    place_bit1();  // ends the attention
+    send_byte(async_command);
+    place_bit0();  // Stopbit(0)
+
+    async_state = ASYNC_WAIT;
+    OCR1B       = TCNT1 + ADB_TICKS(500 + 500);  // Service request, then Tlt/Stop to Start
+    TIFR1       = (1 << OCF1B);
+    TIMSK1 |= (1 << OCIE1B);
+    edges_enable();
+}
+
+ISR(TIMER1_COMPB_vect) {
+    edges_disable();
+    TIMSK1 &= ~(1 << OCIE1B);
+    async_state = ASYNC_DONE;
+}
+
+static void async_wait(void) {
+    while (adb_host_talk_busy()) {
+    }
+}
+
+bool adb_host_talk_busy(void) {
+    uint8_t state = async_state;
+    return state != ASYNC_IDLE && state != ASYNC_DONE;
+}
+
+/** \brief Starts a Talk command, false while another one is in progress or its result was not read yet
+ */
+bool adb_host_talk_start(uint8_t addr, uint8_t reg) {
+    if (async_state != ASYNC_IDLE) {
+        return false;
+    }
+    for (uint8_t i = 0; i < sizeof(async_buf); i++) async_buf[i] = 0;
+    async_command = (addr << 4) | ADB_CMD_TALK | reg;
+    async_state   = ASYNC_ATTENTION;
+
+    cli();
+    data_lo();
+    OCR1A = TCNT1 + ADB_TICKS(800 - 35);  // bit1 holds lo for 35 more
+    TIFR1 = (1 << OCF1A);
+    TIMSK1 |= (1 << OCIE1A);
+    sei();
+    return true;
+}
+
+/** \brief Copies the data of the finished Talk started by adb_host_talk_start() to buf and returns its length
+ *
+ * Returns 0 while it is still in progress, as well as when the device sent nothing.
+ */
+uint8_t adb_host_talk_result(uint8_t *buf, uint8_t len) {
+    if (async_state != ASYNC_DONE) {
+        return 0;
+    }
+    uint8_t n = async_cells > 0 ? (async_cells - 1) / 8 : 0;
+    if (n > sizeof(async_buf)) {
+        n = sizeof(async_buf);
+    }
+    for (uint8_t i = 0; i < len; i++) {
+        buf[i] = i < n ? async_buf[i] : 0;
+    }
+    async_state = ASYNC_IDLE;
+    return n;
+}
+#endif
+
 void adb_host_init(void) {
     ADB_PORT &= ~(1 << ADB_DATA_BIT);
     data_hi();
 #ifdef ADB_PSW_BIT
     psw_hi();
 #endif
+#ifdef ADB_ASYNC
+    TCCR1A = 0;
+    TCCR1B = (1 << CS11);  // normal mode, F_CPU / 8
+#    ifdef ADB_DATA_ICP
+    TCCR1B |= (1 << ICNC1);
+#    endif
+    TIMSK1 = 0;
+    async_state = ASYNC_IDLE;
+#endif
 }
 
 #ifdef ADB_PSW_BIT
@@ -94,6 +275,9 @@ uint16_t adb_host_mouse_recv(void) { return adb_host_talk(ADB_ADDR_MOUSE, ADB_RE
 // This sends Talk command to read data from register and returns length of the data.
 uint8_t adb_host_talk_buf(uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len) {
     for (int8_t i = 0; i < len; i++) buf[i] = 0;
+#ifdef ADB_ASYNC
+    async_wait();
+#endif
 
     cli();
     attention();
@@ -204,6 +388,9 @@ uint16_t adb_host_talk(uint8_t addr, uint8_t reg) {
 }
 
 void adb_host_listen_buf(uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len) {
+#ifdef ADB_ASYNC
+    async_wait();
+#endif
     cli();
     attention();
     send_byte((addr << 4) | ADB_CMD_LISTEN | reg);
@@ -225,6 +412,9 @@ void adb_host_listen(uint8_t addr, uint8_t reg, uint8_t data_h, uint8_t data_l)
 }
 
 void adb_host_flush(uint8_t addr) {
+#ifdef ADB_ASYNC
+    async_wait();
+#endif
     cli();
     attention();
     send_byte((addr << 4) | ADB_CMD_FLUSH);
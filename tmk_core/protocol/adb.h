@@ -100,6 +100,11 @@ void     adb_host_flush(uint8_t addr);
 void     adb_host_kbd_led(uint8_t led);
 uint16_t adb_host_kbd_recv(void);
 uint16_t adb_host_mouse_recv(void);
+#ifdef ADB_ASYNC
+bool    adb_host_talk_start(uint8_t addr, uint8_t reg);
+bool    adb_host_talk_busy(void);
+uint8_t adb_host_talk_result(uint8_t *buf, uint8_t len);
+#endif
 
 // ADB Mouse
 void adb_mouse_task(void);
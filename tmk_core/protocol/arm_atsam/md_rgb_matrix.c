@@ -27,6 +27,9 @@ __attribute__((weak)) led_instruction_t led_instructions[] = {{.end = 1}};
 static void                             md_rgb_matrix_config_override(int i);
 #    endif  // USE_MASSDROP_CONFIGURATOR
 
+static void             queue_frame(void);
+static volatile uint8_t flush_pending;
+
 void SERCOM1_0_Handler(void) {
     if (SERCOM1->I2CM.INTFLAG.bit.ERROR) {
         SERCOM1->I2CM.INTFLAG.reg = SERCOM_I2CM_INTENCLR_ERROR;
@@ -43,6 +46,12 @@ void DMAC_0_Handler(void) {
 
         i2c_led_q_run();
 
+        // The frame flushed while the last one was going out is sent as soon as that is done
+        if (!i2c_led_q_running && flush_pending) {
+            flush_pending = 0;
+            queue_frame();
+        }
+
         return;
     }
 
@@ -60,9 +69,9 @@ uint8_t gcr_desired;
 uint8_t gcr_actual;
 uint8_t gcr_actual_last;
 #    ifdef USE_MASSDROP_CONFIGURATOR
-uint8_t gcr_breathe;
-float   breathe_mult;
-float   pomod;
+uint8_t  gcr_breathe;
+uint16_t breathe_mult;  // 0 - 256
+int32_t  pomod;         // hundredths of a percent
 #    endif
 
 #    define ACT_GCR_NONE 0
@@ -239,11 +248,7 @@ static void flush(void) {
     }  // Prevent calculations and I2C traffic if LED drivers are not enabled
 #    endif
 
-    // Wait for previous transfer to complete
-    while (i2c_led_q_running) {
-    }
-
-    // Copy buffer to live DMA region
+    // Copy buffer to the PWM arrays, each driver's is only copied to the DMA buffer when it is sent
     for (uint8_t i = 0; i < ISSI3733_LED_COUNT; i++) {
         *led_map[i].rgb.r = led_buffer[i].r;
         *led_map[i].rgb.g = led_buffer[i].g;
@@ -251,7 +256,7 @@ static void flush(void) {
     }
 
 #    ifdef USE_MASSDROP_CONFIGURATOR
-    breathe_mult = 1;
+    breathe_mult = 256;
 
     if (led_animation_breathing) {
         //+60us 119 LED
@@ -263,21 +268,28 @@ static void flush(void) {
             breathe_dir = 1;
 
         // Brightness curve created for 256 steps, 0 - ~98%
-        breathe_mult = 0.000015 * led_animation_breathe_cur * led_animation_breathe_cur;
-        if (breathe_mult > 1)
-            breathe_mult = 1;
-        else if (breathe_mult < 0)
-            breathe_mult = 0;
+        breathe_mult = (uint32_t)led_animation_breathe_cur * led_animation_breathe_cur * 256 * 15 / 1000000;
+        if (breathe_mult > 256) breathe_mult = 256;
     }
 
     // This should only be performed once per frame
-    pomod = (float)((g_rgb_timer / 10) % (uint32_t)(1000.0f / led_animation_speed)) / 10.0f * led_animation_speed;
-    pomod *= 100.0f;
-    pomod = (uint32_t)pomod % 10000;
-    pomod /= 100.0f;
+    pomod = (uint32_t)((g_rgb_timer / 10) % (uint32_t)(1000.0f / led_animation_speed) * 10.0f * led_animation_speed) % 10000;
 
 #    endif  // USE_MASSDROP_CONFIGURATOR
 
+    // Rendering carries on while a frame is sent, the one flushed meanwhile follows it rather than being waited for
+    __disable_irq();
+    if (i2c_led_q_running) {
+        flush_pending = 1;
+        __enable_irq();
+        return;
+    }
+    __enable_irq();
+
+    queue_frame();
+}
+
+static void queue_frame(void) {
     uint8_t drvid;
 
     // NOTE: GCR does not need to be timed with LED processing, but there is really no harm
@@ -342,8 +354,15 @@ uint8_t led_enabled               = 1;
 uint8_t led_animation_breathe_cur = BREATHE_MIN_STEP;
 uint8_t breathe_dir               = 1;
 
-static void led_run_pattern(led_setup_t* f, float* ro, float* go, float* bo, float pos) {
-    float po;
+// Positions are in hundredths of a percent
+#        define PO_SCALE 100
+#        define PO_MAX (100 * PO_SCALE)
+
+// Colour at blend / 256 of the way from start to end
+static int32_t led_blend(uint8_t start, uint8_t end, int32_t blend) { return blend * (end - start) / 256 + start; }
+
+static void led_run_pattern(led_setup_t* f, int32_t* ro, int32_t* go, int32_t* bo, int32_t pos) {
+    int32_t po;
 
     while (f->end != 1) {
         po = pos;  // Reset po for new frame
@@ -352,46 +371,49 @@ static void led_run_pattern(led_setup_t* f, float* ro, float* go, float* bo, flo
         if ((!led_animation_direction && f->ef & EF_SCR_R) || (led_animation_direction && (f->ef & EF_SCR_L))) {
             po -= pomod;
 
-            if (po > 100)
-                po -= 100;
+            if (po > PO_MAX)
+                po -= PO_MAX;
             else if (po < 0)
-                po += 100;
+                po += PO_MAX;
         } else if ((!led_animation_direction && f->ef & EF_SCR_L) || (led_animation_direction && (f->ef & EF_SCR_R))) {
             po += pomod;
 
-            if (po > 100)
-                po -= 100;
+            if (po > PO_MAX)
+                po -= PO_MAX;
             else if (po < 0)
-                po += 100;
+                po += PO_MAX;
         }
 
+        int32_t hs = f->hs * PO_SCALE;
+        int32_t he = f->he * PO_SCALE;
+
         // Check if LED's po is in current frame
-        if (po < f->hs) {
+        if (po < hs) {
             f++;
             continue;
         }
-        if (po > f->he) {
+        if (po > he) {
             f++;
             continue;
         }
         // note: < 0 or > 100 continue
 
-        // Calculate the po within the start-stop percentage for color blending
-        po = (po - f->hs) / (f->he - f->hs);
+        // Calculate the po within the start-stop percentage for color blending, 0 - 256
+        int32_t blend = he > hs ? (po - hs) * 256 / (he - hs) : 0;
 
         // Add in any color effects
         if (f->ef & EF_OVER) {
-            *ro = (po * (f->re - f->rs)) + f->rs;  // + 0.5;
-            *go = (po * (f->ge - f->gs)) + f->gs;  // + 0.5;
-            *bo = (po * (f->be - f->bs)) + f->bs;  // + 0.5;
+            *ro = led_blend(f->rs, f->re, blend);
+            *go = led_blend(f->gs, f->ge, blend);
+            *bo = led_blend(f->bs, f->be, blend);
         } else if (f->ef & EF_SUBTRACT) {
-            *ro -= (po * (f->re - f->rs)) + f->rs;  // + 0.5;
-            *go -= (po * (f->ge - f->gs)) + f->gs;  // + 0.5;
-            *bo -= (po * (f->be - f->bs)) + f->bs;  // + 0.5;
+            *ro -= led_blend(f->rs, f->re, blend);
+            *go -= led_blend(f->gs, f->ge, blend);
+            *bo -= led_blend(f->bs, f->be, blend);
         } else {
-            *ro += (po * (f->re - f->rs)) + f->rs;  // + 0.5;
-            *go += (po * (f->ge - f->gs)) + f->gs;  // + 0.5;
-            *bo += (po * (f->be - f->bs)) + f->bs;  // + 0.5;
+            *ro += led_blend(f->rs, f->re, blend);
+            *go += led_blend(f->gs, f->ge, blend);
+            *bo += led_blend(f->bs, f->be, blend);
         }
 
         f++;
@@ -399,11 +421,11 @@ static void led_run_pattern(led_setup_t* f, float* ro, float* go, float* bo, flo
 }
 
 static void md_rgb_matrix_config_override(int i) {
-    float ro = 0;
-    float go = 0;
-    float bo = 0;
+    int32_t ro = 0;
+    int32_t go = 0;
+    int32_t bo = 0;
 
-    float po = (led_animation_orientation) ? (float)g_led_config.point[i].y / 64.f * 100 : (float)g_led_config.point[i].x / 224.f * 100;
+    int32_t po = (led_animation_orientation) ? (int32_t)g_led_config.point[i].y * PO_MAX / 64 : (int32_t)g_led_config.point[i].x * PO_MAX / 224;
 
     uint8_t highest_active_layer = biton32(layer_state);
 
@@ -459,9 +481,9 @@ static void md_rgb_matrix_config_override(int i) {
             bo = 0;
 
         if (led_animation_breathing) {
-            ro *= breathe_mult;
-            go *= breathe_mult;
-            bo *= breathe_mult;
+            ro = ro * breathe_mult / 256;
+            go = go * breathe_mult / 256;
+            bo = bo * breathe_mult / 256;
         }
     }
 
@@ -58,7 +58,14 @@
 #    include "eeprom_driver.h"
 #endif
 #include "suspend.h"
+#include "timer.h"
 #include "wait.h"
+#include "task_profile.h"
+
+// System ticks the main loop sleeps after each pass, the time the peripheral thread gets
+#if defined(KEYBOARD_PERIPHERAL_THREAD) && !defined(KEYBOARD_PERIPHERAL_THREAD_SLEEP)
+#    define KEYBOARD_PERIPHERAL_THREAD_SLEEP 1
+#endif
 
 /* -------------------------
  *   TMK host driver defs
@@ -143,6 +150,8 @@ void boardInit(void) {
     board_init();
 }
 
+bool keyboard_host_ready(void) { return USB_DRIVER.state == USB_ACTIVE; }
+
 /* Main thread
  */
 int main(void) {
@@ -198,16 +207,12 @@ int main(void) {
         }
         serial_link_update();
 #endif
-        wait_ms(50);
+        wait_ms(1);
     }
 
-    /* Do need to wait here!
-     * Otherwise the next print might start a transfer on console EP
-     * before the USB is completely ready, which sometimes causes
-     * HardFaults.
+    /* No need to wait for the USB to settle before printing: the
+     * console only starts a transfer once the driver is USB_ACTIVE.
      */
-    wait_ms(50);
-
     print("USB configured.\n");
 
     /* init TMK modules */
@@ -222,6 +227,9 @@ int main(void) {
 
     /* Main loop */
     while (true) {
+#ifdef KEYBOARD_PERIPHERAL_THREAD
+        keyboard_state_lock();
+#endif
         usb_event_queue_task();
 
 #if !defined(NO_USB_STARTUP_CHECK)
@@ -242,9 +250,15 @@ int main(void) {
                     restart_usb_driver(&USB_DRIVER);
                 }
             }
-            /* Woken up */
+            /* Woken up, keep scanning until the host is back so that no key is lost */
+            uint16_t resume_timer = timer_read();
+            while (USB_DRIVER.state != USB_ACTIVE && USB_DRIVER.state != USB_SUSPENDED && timer_elapsed(resume_timer) < USB_RESUME_TIMEOUT) {
+                usb_event_queue_task();
+                suspend_wakeup_condition();
+            }
             // variables has been already cleared by the wakeup hook
             send_keyboard_report();
+            suspend_wakeup_replay();
 #    ifdef MOUSEKEY_ENABLE
             mousekey_send();
 #    endif /* MOUSEKEY_ENABLE */
@@ -257,7 +271,7 @@ int main(void) {
 
         keyboard_task();
 #ifdef CONSOLE_ENABLE
-        console_task();
+        TASK_PROFILE(TASK_PROFILE_CONSOLE, console_task());
 #endif
 #ifdef MIDI_ENABLE
         midi_ep_task();
@@ -266,11 +280,17 @@ int main(void) {
         virtser_task();
 #endif
 #ifdef RAW_ENABLE
-        raw_hid_task();
+        TASK_PROFILE(TASK_PROFILE_RAW_HID, raw_hid_task());
 #endif
 
         // Run housekeeping
         housekeeping_task_kb();
         housekeeping_task_user();
+
+#ifdef KEYBOARD_PERIPHERAL_THREAD
+        keyboard_state_unlock();
+        // The lighting and display tasks are of lower priority, they only run while the main loop sleeps
+        chThdSleep(KEYBOARD_PERIPHERAL_THREAD_SLEEP);
+#endif
     }
 }
@@ -27,6 +27,7 @@
 
 #include <ch.h>
 #include <hal.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "usb_main.h"
@@ -41,6 +42,8 @@
 #include "wait.h"
 #include "usb_descriptor.h"
 #include "usb_driver.h"
+#include "latency_probe.h"
+#include "timer.h"
 
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
@@ -52,6 +55,14 @@ extern keymap_config_t keymap_config;
 #    include "joystick.h"
 #endif
 
+#ifdef RAW_ENABLE
+#    include "raw_hid.h"
+#endif
+
+#ifdef VIRTSER_ENABLE
+#    include "virtser.h"
+#endif
+
 /* ---------------------------------------------------------
  *       Global interface variables and declarations
  * ---------------------------------------------------------
@@ -432,6 +443,184 @@ void usb_event_queue_task(void) {
     }
 }
 
+/* ---------------------------------------------------------
+ *                  Report queues
+ * ---------------------------------------------------------
+ * Reports are queued per IN endpoint and sent from the IN callback of the
+ * one before it, so a busy endpoint does not hold up the main loop. Only
+ * a full queue waits, unless the report can be merged into the newest one
+ * still queued.
+ */
+
+#ifndef USB_REPORT_QUEUE_SIZE
+#    define USB_REPORT_QUEUE_SIZE 8
+#endif
+#if USB_REPORT_QUEUE_SIZE < 3
+#    error "USB_REPORT_QUEUE_SIZE must be at least 3"
+#endif
+
+typedef struct usb_report_queue usb_report_queue_t;
+
+typedef struct {
+    report_keyboard_t data; /* large enough for every report type */
+    uint8_t           offset;
+    uint8_t           size;
+    bool (*merge)(usb_report_queue_t *queue, const void *report);
+} usb_report_t;
+
+struct usb_report_queue {
+    usb_report_t reports[USB_REPORT_QUEUE_SIZE];
+    uint8_t      head;
+    uint8_t      tail;
+    bool         inflight; /* reports[tail] is being transmitted */
+};
+
+#ifndef KEYBOARD_SHARED_EP
+static usb_report_queue_t kbd_report_queue;
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+static usb_report_queue_t mouse_report_queue;
+#endif
+#ifdef SHARED_EP_ENABLE
+static usb_report_queue_t shared_report_queue;
+#endif
+
+static usb_report_queue_t *usb_report_queue(usbep_t ep) {
+#ifndef KEYBOARD_SHARED_EP
+    if (ep == KEYBOARD_IN_EPNUM) return &kbd_report_queue;
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+    if (ep == MOUSE_IN_EPNUM) return &mouse_report_queue;
+#endif
+#ifdef SHARED_EP_ENABLE
+    if (ep == SHARED_IN_EPNUM) return &shared_report_queue;
+#endif
+    return NULL;
+}
+
+/* Drops everything queued, the endpoints were (re)initialized */
+static void usb_report_queue_reset_I(void) {
+#ifndef KEYBOARD_SHARED_EP
+    memset(&kbd_report_queue, 0, sizeof(usb_report_queue_t));
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+    memset(&mouse_report_queue, 0, sizeof(usb_report_queue_t));
+#endif
+#ifdef SHARED_EP_ENABLE
+    memset(&shared_report_queue, 0, sizeof(usb_report_queue_t));
+#endif
+}
+
+static inline bool usb_report_queue_full(usb_report_queue_t *queue) { return (queue->head + 1) % USB_REPORT_QUEUE_SIZE == queue->tail; }
+
+/* The newest queued report and the one before it, which may be in flight
+ * already, if both came from the same merge function */
+static usb_report_t *usb_report_queue_newest(usb_report_queue_t *queue, const void *merge, usb_report_t **previous) {
+    uint8_t newest = (queue->head + USB_REPORT_QUEUE_SIZE - 1) % USB_REPORT_QUEUE_SIZE;
+    if (queue->head == queue->tail || newest == queue->tail) {
+        return NULL;
+    }
+    *previous = &queue->reports[(newest + USB_REPORT_QUEUE_SIZE - 1) % USB_REPORT_QUEUE_SIZE];
+    if (queue->reports[newest].merge != merge || (*previous)->merge != merge) {
+        return NULL;
+    }
+    return &queue->reports[newest];
+}
+
+/* Starts the oldest queued report if the endpoint is idle */
+static void usb_report_queue_start_I(USBDriver *usbp, usbep_t ep, usb_report_queue_t *queue) {
+    if (queue->inflight || queue->head == queue->tail || usbGetTransmitStatusI(usbp, ep)) {
+        return;
+    }
+    usb_report_t *report = &queue->reports[queue->tail];
+    queue->inflight      = true;
+    usbStartTransmitI(usbp, ep, (uint8_t *)&report->data + report->offset, report->size);
+}
+
+/* Called from the IN callback (ISR, unlocked state) once a transfer is done */
+static void usb_report_queue_in_cb(USBDriver *usbp, usbep_t ep) {
+    usb_report_queue_t *queue = usb_report_queue(ep);
+    if (!queue) {
+        return;
+    }
+    osalSysLockFromISR();
+    if (queue->inflight) {
+        queue->inflight = false;
+        queue->tail     = (queue->tail + 1) % USB_REPORT_QUEUE_SIZE;
+    }
+    usb_report_queue_start_I(usbp, ep, queue);
+#ifdef LATENCY_PROBE
+    if (ep == KEYBOARD_IN_EPNUM && !queue->inflight) {
+        latency_probe_report_done_I();
+    }
+#endif
+    osalSysUnlockFromISR();
+}
+
+/* Not callable from ISR, called in locked state */
+static void usb_report_queue_send_S(usbep_t ep, const void *report, uint8_t report_size, uint8_t offset, uint8_t size, bool (*merge)(usb_report_queue_t *queue, const void *report)) {
+    usb_report_queue_t *queue = usb_report_queue(ep);
+
+    while (usb_report_queue_full(queue)) {
+        if (merge && merge(queue, report)) {
+            return;
+        }
+        /* Need USB_USE_WAIT == TRUE in halconf.h, the IN callback frees a slot before this resumes */
+        if (osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[ep]->in_state->thread, TIME_MS2I(50)) == MSG_TIMEOUT || usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
+            host_report_dropped();
+            return;
+        }
+    }
+
+    usb_report_t *entry = &queue->reports[queue->head];
+    memcpy(&entry->data, report, report_size);
+    entry->offset = offset;
+    entry->size   = size;
+    entry->merge  = merge;
+    queue->head   = (queue->head + 1) % USB_REPORT_QUEUE_SIZE;
+    usb_report_queue_start_I(&USB_DRIVER, ep, queue);
+}
+
+/* Keyboard reports are only merged when neither step presses anything,
+ * so the host never sees presses out of order */
+static bool keyboard_report_merge(usb_report_queue_t *queue, const void *report) {
+#ifdef KEYBOARD_REPORT_COALESCE
+    usb_report_t *previous;
+    usb_report_t *newest = usb_report_queue_newest(queue, keyboard_report_merge, &previous);
+    if (!newest || ((keyboard_report_changes(&previous->data, &newest->data) | keyboard_report_changes(&newest->data, (report_keyboard_t *)report)) & KEYBOARD_REPORT_PRESSED)) {
+        return false;
+    }
+    memcpy(&newest->data, report, sizeof(report_keyboard_t));
+    return true;
+#else
+    (void)queue;
+    (void)report;
+    return false;
+#endif
+}
+
+#ifdef MOUSE_ENABLE
+/* Mouse motion adds up as long as the buttons are the same */
+static bool mouse_report_merge(usb_report_queue_t *queue, const void *report) {
+    usb_report_t *previous;
+    usb_report_t *newest = usb_report_queue_newest(queue, mouse_report_merge, &previous);
+    if (!newest) {
+        return false;
+    }
+    report_mouse_t *queued = (report_mouse_t *)&newest->data;
+    report_mouse_t *next   = (report_mouse_t *)report;
+    int16_t         x = queued->x + next->x, y = queued->y + next->y, v = queued->v + next->v, h = queued->h + next->h;
+    if (queued->buttons != next->buttons || x < -127 || x > 127 || y < -127 || y > 127 || v < -127 || v > 127 || h < -127 || h > 127) {
+        return false;
+    }
+    queued->x = x;
+    queued->y = y;
+    queued->v = v;
+    queued->h = h;
+    return true;
+}
+#endif
+
 /* Handles the USB driver global events
  * TODO: maybe disable some things when connection is lost? */
 static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
@@ -441,6 +630,7 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
 
         case USB_EVENT_CONFIGURED:
             osalSysLockFromISR();
+            usb_report_queue_reset_I();
             /* Enable the endpoints specified into the configuration. */
 #ifndef KEYBOARD_SHARED_EP
             usbInitEndpointI(usbp, KEYBOARD_IN_EPNUM, &kbd_ep_config);
@@ -471,6 +661,9 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
         case USB_EVENT_UNCONFIGURED:
             /* Falls into.*/
         case USB_EVENT_RESET:
+            osalSysLockFromISR();
+            usb_report_queue_reset_I();
+            osalSysUnlockFromISR();
             for (int i = 0; i < NUM_USB_DRIVERS; i++) {
                 chSysLockFromISR();
                 /* Disconnection event on suspend.*/
@@ -729,11 +922,7 @@ void restart_usb_driver(USBDriver *usbp) {
  */
 /* keyboard IN callback hander (a kbd report has made it IN) */
 #ifndef KEYBOARD_SHARED_EP
-void kbd_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
-    (void)usbp;
-    (void)ep;
-}
+void kbd_in_cb(USBDriver *usbp, usbep_t ep) { usb_report_queue_in_cb(usbp, ep); }
 #endif
 
 /* start-of-frame handler
@@ -786,50 +975,15 @@ void send_keyboard(report_keyboard_t *report) {
 
 #ifdef NKRO_ENABLE
     if (keymap_config.nkro && keyboard_protocol) { /* NKRO protocol */
-        /* need to wait until the previous packet has made it through */
-        /* can rewrite this using the synchronous API, then would wait
-         * until *after* the packet has been transmitted. I think
-         * this is more efficient */
-        /* busy wait, should be short and not very common */
-        if (usbGetTransmitStatusI(&USB_DRIVER, SHARED_IN_EPNUM)) {
-            /* Need to either suspend, or loop and call unlock/lock during
-             * every iteration - otherwise the system will remain locked,
-             * no interrupts served, so USB not going through as well.
-             * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-            osalThreadSuspendS(&(&USB_DRIVER)->epc[SHARED_IN_EPNUM]->in_state->thread);
-
-            /* after osalThreadSuspendS returns USB status might have changed */
-            if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-                goto unlock;
-            }
-        }
-        usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)report, sizeof(struct nkro_report));
+        usb_report_queue_send_S(SHARED_IN_EPNUM, report, sizeof(report_keyboard_t), 0, sizeof(struct nkro_report), keyboard_report_merge);
     } else
 #endif /* NKRO_ENABLE */
-    {  /* regular protocol */
-        /* need to wait until the previous packet has made it through */
-        /* busy wait, should be short and not very common */
-        if (usbGetTransmitStatusI(&USB_DRIVER, KEYBOARD_IN_EPNUM)) {
-            /* Need to either suspend, or loop and call unlock/lock during
-             * every iteration - otherwise the system will remain locked,
-             * no interrupts served, so USB not going through as well.
-             * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-            osalThreadSuspendS(&(&USB_DRIVER)->epc[KEYBOARD_IN_EPNUM]->in_state->thread);
-
-            /* after osalThreadSuspendS returns USB status might have changed */
-            if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-                goto unlock;
-            }
-        }
-        uint8_t *data, size;
+    {
         if (keyboard_protocol) {
-            data = (uint8_t *)report;
-            size = KEYBOARD_REPORT_SIZE;
+            usb_report_queue_send_S(KEYBOARD_IN_EPNUM, report, sizeof(report_keyboard_t), 0, KEYBOARD_REPORT_SIZE, keyboard_report_merge);
         } else { /* boot protocol */
-            data = &report->mods;
-            size = 8;
+            usb_report_queue_send_S(KEYBOARD_IN_EPNUM, report, sizeof(report_keyboard_t), offsetof(report_keyboard_t, mods), 8, keyboard_report_merge);
         }
-        usbStartTransmitI(&USB_DRIVER, KEYBOARD_IN_EPNUM, data, size);
     }
     keyboard_report_sent = *report;
 
@@ -846,30 +1000,14 @@ unlock:
 
 #    ifndef MOUSE_SHARED_EP
 /* mouse IN callback hander (a mouse report has made it IN) */
-void mouse_in_cb(USBDriver *usbp, usbep_t ep) {
-    (void)usbp;
-    (void)ep;
-}
+void mouse_in_cb(USBDriver *usbp, usbep_t ep) { usb_report_queue_in_cb(usbp, ep); }
 #    endif
 
 void send_mouse(report_mouse_t *report) {
     osalSysLock();
-    if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-        osalSysUnlock();
-        return;
-    }
-
-    if (usbGetTransmitStatusI(&USB_DRIVER, MOUSE_IN_EPNUM)) {
-        /* Need to either suspend, or loop and call unlock/lock during
-         * every iteration - otherwise the system will remain locked,
-         * no interrupts served, so USB not going through as well.
-         * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-        if (osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[MOUSE_IN_EPNUM]->in_state->thread, TIME_MS2I(10)) == MSG_TIMEOUT) {
-            osalSysUnlock();
-            return;
-        }
+    if (usbGetDriverStateI(&USB_DRIVER) == USB_ACTIVE) {
+        usb_report_queue_send_S(MOUSE_IN_EPNUM, report, sizeof(report_mouse_t), 0, sizeof(report_mouse_t), mouse_report_merge);
     }
-    usbStartTransmitI(&USB_DRIVER, MOUSE_IN_EPNUM, (uint8_t *)report, sizeof(report_mouse_t));
     osalSysUnlock();
 }
 
@@ -883,11 +1021,7 @@ void send_mouse(report_mouse_t *report) { (void)report; }
  */
 #ifdef SHARED_EP_ENABLE
 /* shared IN callback hander */
-void shared_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
-    (void)usbp;
-    (void)ep;
-}
+void shared_in_cb(USBDriver *usbp, usbep_t ep) { usb_report_queue_in_cb(usbp, ep); }
 #endif
 
 /* ---------------------------------------------------------
@@ -905,7 +1039,7 @@ static void send_extra(uint8_t report_id, uint16_t data) {
 
     report_extra_t report = {.report_id = report_id, .usage = data};
 
-    usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)&report, sizeof(report_extra_t));
+    usb_report_queue_send_S(SHARED_IN_EPNUM, &report, sizeof(report_extra_t), 0, sizeof(report_extra_t), NULL);
     osalSysUnlock();
 }
 #endif
@@ -929,33 +1063,29 @@ void send_consumer(uint16_t data) {
 
 #ifdef CONSOLE_ENABLE
 
-int8_t sendchar(uint8_t c) {
-    static bool timed_out = false;
-    /* The `timed_out` state is an approximation of the ideal `is_listener_disconnected?` state.
-     *
-     * When a 5ms timeout write has timed out, hid_listen is most likely not running, or not
-     * listening to this keyboard, so we go into the timed_out state. In this state we assume
-     * that hid_listen is most likely not gonna be connected to us any time soon, so it would
-     * be wasteful to write follow-up characters with a 5ms timeout, it would all add up and
-     * unncecessarily slow down the firmware. However instead of just dropping the characters,
-     * we write them with a TIME_IMMEDIATE timeout, which is a zero timeout,
-     * and this will succeed only if hid_listen gets connected again. When a write with
-     * TIME_IMMEDIATE timeout succeeds, we know that hid_listen is listening to us again, and
-     * we can go back to the timed_out = false state, and following writes will be executed
-     * with a 5ms timeout. The reason we don't just send all characters with the TIME_IMMEDIATE
-     * timeout is that this could cause bytes to be lost even if hid_listen is running, if there
-     * is a lot of data being sent over the console.
-     *
-     * This logic will work correctly as long as hid_listen is able to receive at least 200
-     * bytes per second. On a heavily overloaded machine that's so overloaded that it's
-     * unusable, and constantly swapping, hid_listen might have trouble receiving 200 bytes per
-     * second, so some bytes might be lost on the console.
-     */
+/* Characters are gathered into a packet, which is handed to the console
+ * endpoint at the end of a line, once it is full, or from console_task()
+ * after the keyboard task has run. Nothing waits for the host: whatever does
+ * not fit in the endpoint's queue, because hid_listen is not running or not
+ * keeping up, is dropped, so printing costs the same whether or not anyone is
+ * listening.
+ */
+static uint8_t console_buffer[CONSOLE_EPSIZE];
+static uint8_t console_buffer_length = 0;
 
-    const sysinterval_t timeout = timed_out ? TIME_IMMEDIATE : TIME_MS2I(5);
-    const size_t        result  = chnWriteTimeout(&drivers.console_driver.driver, &c, 1, timeout);
-    timed_out                   = (result == 0);
-    return result;
+static void console_flush(void) {
+    if (console_buffer_length > 0) {
+        chnWriteTimeout(&drivers.console_driver.driver, console_buffer, console_buffer_length, TIME_IMMEDIATE);
+        console_buffer_length = 0;
+    }
+}
+
+int8_t sendchar(uint8_t c) {
+    console_buffer[console_buffer_length++] = c;
+    if (c == '\n' || console_buffer_length == sizeof(console_buffer)) {
+        console_flush();
+    }
+    return 0;
 }
 
 // Just a dummy function for now, this could be exposed as a weak function
@@ -966,6 +1096,8 @@ static void console_receive(uint8_t *data, uint8_t length) {
 }
 
 void console_task(void) {
+    console_flush();
+
     uint8_t buffer[CONSOLE_EPSIZE];
     size_t  size = 0;
     do {
@@ -993,6 +1125,42 @@ __attribute__((weak)) void raw_hid_receive(uint8_t *data, uint8_t length) {
     // so users can opt to not handle data coming in.
 }
 
+#    ifdef RAW_HID_ZERO_COPY
+#        ifndef RAW_HID_TASK_BUDGET_US
+#            define RAW_HID_TASK_BUDGET_US 1000
+#        endif
+
+// Handlers that only implement raw_hid_receive() still work, their raw_hid_send() fills the reply buffer
+__attribute__((weak)) bool raw_hid_receive_zero_copy(uint8_t *data, uint8_t *reply, uint8_t length) {
+    raw_hid_receive(data, length);
+    return false;
+}
+
+/* Packets are handled in the buffers of the endpoint queues: the handler
+ * reads the OUT buffer the packet arrived in and writes its reply straight
+ * into an IN buffer taken before the packet, so that there always is room for
+ * it. Packets are handled until the queue is empty or the time budget is
+ * spent, the rest wait for the next call. */
+void raw_hid_task(void) {
+    input_buffers_queue_t  *ibqp  = &drivers.raw_driver.driver.ibqueue;
+    output_buffers_queue_t *obqp  = &drivers.raw_driver.driver.obqueue;
+    uint32_t                start = timer_read_us();
+    do {
+        // Kept across calls when no packet came, a raw_hid_send() meanwhile fills it
+        if (obqp->ptr == NULL && obqGetEmptyBufferTimeout(obqp, TIME_IMMEDIATE) != MSG_OK) {
+            return;
+        }
+        if (ibqGetFullBufferTimeout(ibqp, TIME_IMMEDIATE) != MSG_OK) {
+            return;
+        }
+        uint8_t length = ibqp->top - ibqp->ptr;
+        if (raw_hid_receive_zero_copy(ibqp->ptr, obqp->ptr, length) && obqp->ptr != NULL) {
+            obqPostFullBuffer(obqp, RAW_EPSIZE);
+        }
+        ibqReleaseEmptyBuffer(ibqp);
+    } while (timer_elapsed_us(start) < RAW_HID_TASK_BUDGET_US);
+}
+#    else
 void raw_hid_task(void) {
     uint8_t buffer[RAW_EPSIZE];
     size_t  size = 0;
@@ -1003,27 +1171,28 @@ void raw_hid_task(void) {
         }
     } while (size > 0);
 }
+#    endif
 
 #endif
 
 #ifdef MIDI_ENABLE
 
-void send_midi_packet(MIDI_EventPacket_t *event) { chnWrite(&drivers.midi_driver.driver, (uint8_t *)event, sizeof(MIDI_EventPacket_t)); }
+/* Packets are written into the 64 byte buffers of the output queue and go out
+ * with the next SOF, so a chord or a sweep shares transfers. Waiting for room
+ * is bounded, so a host that stopped reading cannot stall the main loop. */
+#    ifndef MIDI_SEND_TIMEOUT
+#        define MIDI_SEND_TIMEOUT 50
+#    endif
+
+void send_midi_packet(MIDI_EventPacket_t *event) { chnWriteTimeout(&drivers.midi_driver.driver, (uint8_t *)event, sizeof(MIDI_EventPacket_t), TIME_MS2I(MIDI_SEND_TIMEOUT)); }
 
 bool recv_midi_packet(MIDI_EventPacket_t *const event) {
     size_t size = chnReadTimeout(&drivers.midi_driver.driver, (uint8_t *)event, sizeof(MIDI_EventPacket_t), TIME_IMMEDIATE);
     return size == sizeof(MIDI_EventPacket_t);
 }
+
 void midi_ep_task(void) {
-    uint8_t buffer[MIDI_STREAM_EPSIZE];
-    size_t  size = 0;
-    do {
-        size_t size = chnReadTimeout(&drivers.midi_driver.driver, buffer, sizeof(buffer), TIME_IMMEDIATE);
-        if (size > 0) {
-            MIDI_EventPacket_t event;
-            recv_midi_packet(&event);
-        }
-    } while (size > 0);
+    // Incoming packets are read by midi_task() through recv_midi_packet(), reading them here would drop them
 }
 #endif
 
@@ -1031,17 +1200,16 @@ void midi_ep_task(void) {
 
 void virtser_send(const uint8_t byte) { chnWrite(&drivers.serial_driver.driver, &byte, 1); }
 
-__attribute__((weak)) void virtser_recv(uint8_t c) {
-    // Ignore by default
-}
+void virtser_send_buffer(const uint8_t *data, uint8_t length) { chnWrite(&drivers.serial_driver.driver, data, length); }
 
 void virtser_task(void) {
+    // The driver's input queue is filled from the USB interrupt, this takes it a packet at a time
     uint8_t numBytesReceived = 0;
-    uint8_t buffer[16];
+    uint8_t buffer[CDC_EPSIZE];
     do {
         numBytesReceived = chnReadTimeout(&drivers.serial_driver.driver, buffer, sizeof(buffer), TIME_IMMEDIATE);
-        for (int i = 0; i < numBytesReceived; i++) {
-            virtser_recv(buffer[i]);
+        if (numBytesReceived > 0) {
+            virtser_recv_buffer(buffer, numBytesReceived);
         }
     } while (numBytesReceived > 0);
 }
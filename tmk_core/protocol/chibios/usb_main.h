@@ -28,8 +28,10 @@
  * -------------------------
  */
 
-/* The USB driver to use */
-#define USB_DRIVER USBD1
+/* The USB driver to use, USBD2 is the OTG_HS peripheral on chips that have one */
+#ifndef USB_DRIVER
+#    define USB_DRIVER USBD1
+#endif
 
 /* Initialize the USB driver and bus */
 void init_usb_driver(USBDriver *usbp);
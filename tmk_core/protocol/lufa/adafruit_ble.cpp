@@ -55,6 +55,8 @@ static struct {
     uint32_t vbat;
 #endif
     uint16_t last_connection_update;
+    uint16_t last_send_failure;
+    bool     send_failed;
 } state;
 
 // Commands are encoded using SDEP and sent via SPI
@@ -267,20 +269,98 @@ static void send_buf_send_one(uint16_t timeout = SdepTimeout) {
         return;
     }
 
+    // Give the module some time after a failure, without holding up the keyboard
+    if (state.send_failed && timer_elapsed(state.last_send_failure) < SdepTimeout) {
+        return;
+    }
+
     if (!send_buf.peek(item)) {
         return;
     }
     if (process_queue_item(&item, timeout)) {
         // commit that peek
         send_buf.get(item);
+        state.send_failed = false;
         dprintf("send_buf_send_one: have %d remaining\n", (int)send_buf.size());
     } else {
         dprint("failed to send, will retry\n");
-        wait_ms(SdepTimeout);
+        state.send_failed       = true;
+        state.last_send_failure = timer_read();
         resp_buf_read_one(true);
     }
 }
 
+// Reports queue up while the module acknowledges the previous one. Rather
+// than sending each of them in turn, a report that only adds to the one
+// waiting behind it replaces it, so the queue never falls further behind the
+// keyboard than it has to.
+static bool send_buf_merge(const struct queue_item &item) {
+    if (send_buf.size() < 2) {
+        // The front item is the one being sent
+        return false;
+    }
+
+    struct queue_item &last = send_buf.back();
+    if (last.queue_type != item.queue_type) {
+        return false;
+    }
+
+    switch (item.queue_type) {
+        case QTKeyReport:
+            // A modifier changing between two reports would change what the keys in them mean
+            if (last.key.modifier != item.key.modifier) {
+                return false;
+            }
+            // Every key of the last report has to still be down, or its press would be lost
+            for (uint8_t i = 0; i < sizeof(last.key.keys); i++) {
+                if (last.key.keys[i] && !memchr(item.key.keys, last.key.keys[i], sizeof(item.key.keys))) {
+                    return false;
+                }
+            }
+            last.key = item.key;
+            return true;
+
+#ifdef MOUSE_ENABLE
+        case QTMouseMove: {
+            if (last.mousemove.buttons != item.mousemove.buttons) {
+                return false;
+            }
+            int16_t x      = last.mousemove.x + item.mousemove.x;
+            int16_t y      = last.mousemove.y + item.mousemove.y;
+            int16_t scroll = last.mousemove.scroll + item.mousemove.scroll;
+            int16_t pan    = last.mousemove.pan + item.mousemove.pan;
+            if (x != (int8_t)x || y != (int8_t)y || scroll != (int8_t)scroll || pan != (int8_t)pan) {
+                return false;
+            }
+            last.mousemove.x      = x;
+            last.mousemove.y      = y;
+            last.mousemove.scroll = scroll;
+            last.mousemove.pan    = pan;
+            return true;
+        }
+#endif
+
+        default:
+            return false;
+    }
+}
+
+static void send_buf_enqueue(const struct queue_item &item) {
+    if (send_buf_merge(item)) {
+        return;
+    }
+
+    bool didWait = false;
+    while (!send_buf.enqueue(item)) {
+        if (!didWait) {
+            dprint("wait for buf space\n");
+            didWait = true;
+        }
+        state.send_failed = false;
+        send_buf_send_one();
+    }
+}
+
 static void resp_buf_wait(const char *cmd) {
     bool didPrint = false;
     while (!resp_buf.empty()) {
@@ -560,9 +640,18 @@ void adafruit_ble_task(void) {
 #endif
 }
 
+// Writes value as two lowercase hex digits, the commands below are built this way rather than through snprintf()
+static char *append_hex(char *dest, uint8_t value) {
+    static const char digits[] PROGMEM = "0123456789abcdef";
+
+    *dest++ = pgm_read_byte(&digits[value >> 4]);
+    *dest++ = pgm_read_byte(&digits[value & 0xF]);
+    return dest;
+}
+
 static bool process_queue_item(struct queue_item *item, uint16_t timeout) {
-    char cmdbuf[48];
-    char fmtbuf[64];
+    char  cmdbuf[48];
+    char *end;
 
     // Arrange to re-check connection after keys have settled
     state.last_connection_update = timer_read();
@@ -575,17 +664,29 @@ static bool process_queue_item(struct queue_item *item, uint16_t timeout) {
 
     switch (item->queue_type) {
         case QTKeyReport:
-            strcpy_P(fmtbuf, PSTR("AT+BLEKEYBOARDCODE=%02x-00-%02x-%02x-%02x-%02x-%02x-%02x"));
-            snprintf(cmdbuf, sizeof(cmdbuf), fmtbuf, item->key.modifier, item->key.keys[0], item->key.keys[1], item->key.keys[2], item->key.keys[3], item->key.keys[4], item->key.keys[5]);
+            // AT+BLEKEYBOARDCODE=mm-00-kk-kk-kk-kk-kk-kk
+            strcpy_P(cmdbuf, PSTR("AT+BLEKEYBOARDCODE="));
+            end    = append_hex(cmdbuf + strlen(cmdbuf), item->key.modifier);
+            *end++ = '-';
+            end    = append_hex(end, 0);
+            for (uint8_t i = 0; i < sizeof(item->key.keys); i++) {
+                *end++ = '-';
+                end    = append_hex(end, item->key.keys[i]);
+            }
+            *end = 0;
             return at_command(cmdbuf, NULL, 0, true, timeout);
 
         case QTConsumer:
-            strcpy_P(fmtbuf, PSTR("AT+BLEHIDCONTROLKEY=0x%04x"));
-            snprintf(cmdbuf, sizeof(cmdbuf), fmtbuf, item->consumer);
+            // AT+BLEHIDCONTROLKEY=0xuuuu
+            strcpy_P(cmdbuf, PSTR("AT+BLEHIDCONTROLKEY=0x"));
+            end  = append_hex(cmdbuf + strlen(cmdbuf), item->consumer >> 8);
+            end  = append_hex(end, item->consumer & 0xFF);
+            *end = 0;
             return at_command(cmdbuf, NULL, 0, true, timeout);
 
 #ifdef MOUSE_ENABLE
-        case QTMouseMove:
+        case QTMouseMove: {
+            char fmtbuf[64];
             strcpy_P(fmtbuf, PSTR("AT+BLEHIDMOUSEMOVE=%d,%d,%d,%d"));
             snprintf(cmdbuf, sizeof(cmdbuf), fmtbuf, item->mousemove.x, item->mousemove.y, item->mousemove.scroll, item->mousemove.pan);
             if (!at_command(cmdbuf, NULL, 0, true, timeout)) {
@@ -605,6 +706,7 @@ static bool process_queue_item(struct queue_item *item, uint16_t timeout) {
                 strcat(cmdbuf, "0");
             }
             return at_command(cmdbuf, NULL, 0, true, timeout);
+        }
 #endif
         default:
             return true;
@@ -613,7 +715,6 @@ static bool process_queue_item(struct queue_item *item, uint16_t timeout) {
 
 void adafruit_ble_send_keys(uint8_t hid_modifier_mask, uint8_t *keys, uint8_t nkeys) {
     struct queue_item item;
-    bool              didWait = false;
 
     item.queue_type   = QTKeyReport;
     item.key.modifier = hid_modifier_mask;
@@ -627,14 +728,7 @@ void adafruit_ble_send_keys(uint8_t hid_modifier_mask, uint8_t *keys, uint8_t nk
         item.key.keys[4] = nkeys >= 4 ? keys[4] : 0;
         item.key.keys[5] = nkeys >= 5 ? keys[5] : 0;
 
-        if (!send_buf.enqueue(item)) {
-            if (!didWait) {
-                dprint("wait for buf space\n");
-                didWait = true;
-            }
-            send_buf_send_one();
-            continue;
-        }
+        send_buf_enqueue(item);
 
         if (nkeys <= 6) {
             return;
@@ -650,10 +744,9 @@ void adafruit_ble_send_consumer_key(uint16_t usage) {
 
     item.queue_type = QTConsumer;
     item.consumer   = usage;
+    item.added      = timer_read();
 
-    while (!send_buf.enqueue(item)) {
-        send_buf_send_one();
-    }
+    send_buf_enqueue(item);
 }
 
 #ifdef MOUSE_ENABLE
@@ -666,10 +759,9 @@ void adafruit_ble_send_mouse_move(int8_t x, int8_t y, int8_t scroll, int8_t pan,
     item.mousemove.scroll  = scroll;
     item.mousemove.pan     = pan;
     item.mousemove.buttons = buttons;
+    item.added             = timer_read();
 
-    while (!send_buf.enqueue(item)) {
-        send_buf_send_one();
-    }
+    send_buf_enqueue(item);
 }
 #endif
 
@@ -48,10 +48,12 @@
 #    include "sleep_led.h"
 #endif
 #include "suspend.h"
+#include "task_profile.h"
 
 #include "usb_descriptor.h"
 #include "lufa.h"
 #include "quantum.h"
+#include <stddef.h>
 #include <util/atomic.h>
 
 #ifdef NKRO_ENABLE
@@ -195,8 +197,8 @@ void raw_hid_send(uint8_t *data, uint8_t length) {
 
     Endpoint_SelectEndpoint(RAW_IN_EPNUM);
 
-    // Check to see if the host is ready to accept another packet
-    if (Endpoint_IsINReady()) {
+    // Wait for the host to accept the previous packet, so frames sent back to back are not dropped
+    if (Endpoint_WaitUntilReady() == ENDPOINT_READYWAIT_NoError) {
         // Write data
         Endpoint_Write_Stream_LE(data, RAW_EPSIZE, NULL);
         // Finalize the stream transfer to send the last packet
@@ -361,7 +363,10 @@ void send_joystick_packet(joystick_t *joystick) {
 
     /* Check if write ready for a polling interval around 10ms */
     while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
+    if (!Endpoint_IsReadWriteAllowed()) {
+        host_report_dropped();
+        return;
+    }
 
     /* Write Joystick Report Data */
     Endpoint_Write_Stream_LE(&r, sizeof(joystick_report_t), NULL);
@@ -371,6 +376,204 @@ void send_joystick_packet(joystick_t *joystick) {
 }
 #endif
 
+/*******************************************************************************
+ * Report queues
+ ******************************************************************************/
+/* Reports are queued per IN endpoint and written to it once the host has
+ * taken the one before, from the main loop or from the start of frame
+ * interrupt, so a busy endpoint does not hold up the main loop. Only a full
+ * queue waits, unless the report can be merged into the newest one still
+ * queued.
+ */
+
+#ifndef USB_REPORT_QUEUE_SIZE
+#    define USB_REPORT_QUEUE_SIZE 8
+#endif
+#if USB_REPORT_QUEUE_SIZE < 3
+#    error "USB_REPORT_QUEUE_SIZE must be at least 3"
+#endif
+
+typedef struct usb_report_queue usb_report_queue_t;
+
+typedef struct {
+    report_keyboard_t data; /* large enough for every report type */
+    uint8_t           offset;
+    uint8_t           size;
+    bool (*merge)(usb_report_queue_t *queue, const void *report);
+} usb_report_t;
+
+struct usb_report_queue {
+    usb_report_t reports[USB_REPORT_QUEUE_SIZE];
+    uint8_t      head;
+    uint8_t      tail;
+};
+
+#ifndef KEYBOARD_SHARED_EP
+static usb_report_queue_t kbd_report_queue;
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+static usb_report_queue_t mouse_report_queue;
+#endif
+#ifdef SHARED_EP_ENABLE
+static usb_report_queue_t shared_report_queue;
+#endif
+
+static usb_report_queue_t *usb_report_queue(uint8_t ep) {
+#ifndef KEYBOARD_SHARED_EP
+    if (ep == KEYBOARD_IN_EPNUM) return &kbd_report_queue;
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+    if (ep == MOUSE_IN_EPNUM) return &mouse_report_queue;
+#endif
+#ifdef SHARED_EP_ENABLE
+    if (ep == SHARED_IN_EPNUM) return &shared_report_queue;
+#endif
+    return NULL;
+}
+
+/* Drops everything queued, the endpoints were (re)configured */
+static void usb_report_queue_reset(void) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+#ifndef KEYBOARD_SHARED_EP
+        memset(&kbd_report_queue, 0, sizeof(usb_report_queue_t));
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+        memset(&mouse_report_queue, 0, sizeof(usb_report_queue_t));
+#endif
+#ifdef SHARED_EP_ENABLE
+        memset(&shared_report_queue, 0, sizeof(usb_report_queue_t));
+#endif
+    }
+}
+
+static inline bool usb_report_queue_full(usb_report_queue_t *queue) { return (queue->head + 1) % USB_REPORT_QUEUE_SIZE == queue->tail; }
+
+/* The newest queued report and the one before it, which may have been written
+ * to the endpoint already, if both came from the same merge function */
+static usb_report_t *usb_report_queue_newest(usb_report_queue_t *queue, const void *merge, usb_report_t **previous) {
+    uint8_t newest = (queue->head + USB_REPORT_QUEUE_SIZE - 1) % USB_REPORT_QUEUE_SIZE;
+    if (queue->head == queue->tail || newest == queue->tail) {
+        return NULL;
+    }
+    *previous = &queue->reports[(newest + USB_REPORT_QUEUE_SIZE - 1) % USB_REPORT_QUEUE_SIZE];
+    if (queue->reports[newest].merge != merge || (*previous)->merge != merge) {
+        return NULL;
+    }
+    return &queue->reports[newest];
+}
+
+/* Writes the oldest queued report if the endpoint bank is free, with interrupts disabled */
+static void usb_report_queue_transmit(uint8_t ep, usb_report_queue_t *queue) {
+    if (queue->head == queue->tail) {
+        return;
+    }
+    Endpoint_SelectEndpoint(ep);
+    if (!Endpoint_IsReadWriteAllowed()) {
+        return;
+    }
+    usb_report_t *report = &queue->reports[queue->tail];
+    Endpoint_Write_Stream_LE((uint8_t *)&report->data + report->offset, report->size, NULL);
+    Endpoint_ClearIN();
+    queue->tail = (queue->tail + 1) % USB_REPORT_QUEUE_SIZE;
+}
+
+/* Hands every queue's oldest report to its endpoint, from the main loop and the start of frame interrupt */
+static void usb_report_queue_task(void) {
+    if (USB_DeviceState != DEVICE_STATE_Configured) {
+        return;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uint8_t ep = Endpoint_GetCurrentEndpoint();
+#ifndef KEYBOARD_SHARED_EP
+        usb_report_queue_transmit(KEYBOARD_IN_EPNUM, &kbd_report_queue);
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+        usb_report_queue_transmit(MOUSE_IN_EPNUM, &mouse_report_queue);
+#endif
+#ifdef SHARED_EP_ENABLE
+        usb_report_queue_transmit(SHARED_IN_EPNUM, &shared_report_queue);
+#endif
+        Endpoint_SelectEndpoint(ep);
+    }
+}
+
+static void usb_report_queue_send(uint8_t ep, const void *report, uint8_t report_size, uint8_t offset, uint8_t size, bool (*merge)(usb_report_queue_t *queue, const void *report)) {
+    usb_report_queue_t *queue   = usb_report_queue(ep);
+    uint8_t             timeout = 255;
+
+    if (USB_DeviceState != DEVICE_STATE_Configured) {
+        return;
+    }
+
+    /* ATOMIC_BLOCK is a loop of its own, hence the flags rather than break */
+    bool queued = false, merged = false;
+    while (true) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            if (!usb_report_queue_full(queue)) {
+                usb_report_t *entry = &queue->reports[queue->head];
+                memcpy(&entry->data, report, report_size);
+                entry->offset = offset;
+                entry->size   = size;
+                entry->merge  = merge;
+                queue->head   = (queue->head + 1) % USB_REPORT_QUEUE_SIZE;
+                queued        = true;
+            } else if (merge) {
+                merged = merge(queue, report);
+            }
+        }
+        if (queued || merged) {
+            break;
+        }
+        /* Wait for a polling interval around 10ms, the start of frame interrupt frees a slot as soon as the host takes a report */
+        if (!timeout--) {
+            host_report_dropped();
+            return;
+        }
+        _delay_us(40);
+    }
+    usb_report_queue_task();
+}
+
+/* Keyboard reports are only merged when neither step presses anything,
+ * so the host never sees presses out of order */
+static bool keyboard_report_merge(usb_report_queue_t *queue, const void *report) {
+#ifdef KEYBOARD_REPORT_COALESCE
+    usb_report_t *previous;
+    usb_report_t *newest = usb_report_queue_newest(queue, keyboard_report_merge, &previous);
+    if (!newest || ((keyboard_report_changes(&previous->data, &newest->data) | keyboard_report_changes(&newest->data, (report_keyboard_t *)report)) & KEYBOARD_REPORT_PRESSED)) {
+        return false;
+    }
+    memcpy(&newest->data, report, sizeof(report_keyboard_t));
+    return true;
+#else
+    (void)queue;
+    (void)report;
+    return false;
+#endif
+}
+
+#ifdef MOUSE_ENABLE
+/* Mouse motion adds up as long as the buttons are the same */
+static bool mouse_report_merge(usb_report_queue_t *queue, const void *report) {
+    usb_report_t *previous;
+    usb_report_t *newest = usb_report_queue_newest(queue, mouse_report_merge, &previous);
+    if (!newest) {
+        return false;
+    }
+    report_mouse_t *queued = (report_mouse_t *)&newest->data;
+    report_mouse_t *next   = (report_mouse_t *)report;
+    int16_t         x = queued->x + next->x, y = queued->y + next->y, v = queued->v + next->v, h = queued->h + next->h;
+    if (queued->buttons != next->buttons || x < -127 || x > 127 || y < -127 || y > 127 || v < -127 || v > 127 || h < -127 || h > 127) {
+        return false;
+    }
+    queued->x = x;
+    queued->y = y;
+    queued->v = v;
+    queued->h = h;
+    return true;
+}
+#endif
+
 /*******************************************************************************
  * USB Events
  ******************************************************************************/
@@ -453,12 +656,18 @@ static bool console_flush = false;
             ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { console_flush = b; } \
         } while (0)
 
+#endif
+
 /** \brief Event USB Device Start Of Frame
  *
- * FIXME: Needs doc
+ * Sends the queued reports the host is ready for, and flushes the console
+ * every 50ms.
  * called every 1ms
  */
 void EVENT_USB_Device_StartOfFrame(void) {
+    usb_report_queue_task();
+
+#ifdef CONSOLE_ENABLE
     static uint8_t count;
     if (++count % 50) return;
     count = 0;
@@ -466,9 +675,8 @@ void EVENT_USB_Device_StartOfFrame(void) {
     if (!console_flush) return;
     Console_Task();
     console_flush = false;
-}
-
 #endif
+}
 
 /** \brief Event handler for the USB_ConfigurationChanged event.
  *
@@ -480,6 +688,8 @@ void EVENT_USB_Device_StartOfFrame(void) {
 void EVENT_USB_Device_ConfigurationChanged(void) {
     bool ConfigSuccess = true;
 
+    usb_report_queue_reset();
+
 #ifndef KEYBOARD_SHARED_EP
     /* Setup keyboard report endpoint */
     ConfigSuccess &= Endpoint_ConfigureEndpoint((KEYBOARD_IN_EPNUM | ENDPOINT_DIR_IN), EP_TYPE_INTERRUPT, KEYBOARD_EPSIZE, 1);
@@ -663,122 +873,221 @@ void EVENT_USB_Device_ControlRequest(void) {
  */
 static uint8_t keyboard_leds(void) { return keyboard_led_state; }
 
-/** \brief Send Keyboard
+/** \brief Send Keyboard over USB
  *
  * FIXME: Needs doc
  */
-static void send_keyboard(report_keyboard_t *report) {
-    uint8_t timeout = 255;
-
-#ifdef BLUETOOTH_ENABLE
-    if (where_to_send() == OUTPUT_BLUETOOTH) {
-#    ifdef MODULE_ADAFRUIT_BLE
-        adafruit_ble_send_keys(report->mods, report->keys, sizeof(report->keys));
-#    elif MODULE_RN42
-        serial_send(0xFD);
-        serial_send(0x09);
-        serial_send(0x01);
-        serial_send(report->mods);
-        serial_send(report->reserved);
-        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
-            serial_send(report->keys[i]);
-        }
-#    endif
-        return;
-    }
-#endif
-
-    /* Select the Keyboard Report Endpoint */
-    uint8_t ep   = KEYBOARD_IN_EPNUM;
-    uint8_t size = KEYBOARD_REPORT_SIZE;
+static void send_keyboard_usb(report_keyboard_t *report) {
 #ifdef NKRO_ENABLE
     if (keyboard_protocol && keymap_config.nkro) {
-        ep   = SHARED_IN_EPNUM;
-        size = sizeof(struct nkro_report);
-    }
+        usb_report_queue_send(SHARED_IN_EPNUM, report, sizeof(report_keyboard_t), 0, sizeof(struct nkro_report), keyboard_report_merge);
+    } else
 #endif
-    Endpoint_SelectEndpoint(ep);
-    /* Check if write ready for a polling interval around 10ms */
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
-
-    /* If we're in Boot Protocol, don't send any report ID or other funky fields */
-    if (!keyboard_protocol) {
-        Endpoint_Write_Stream_LE(&report->mods, 8, NULL);
-    } else {
-        Endpoint_Write_Stream_LE(report, size, NULL);
+    {
+        /* If we're in Boot Protocol, don't send any report ID or other funky fields */
+        if (!keyboard_protocol) {
+            usb_report_queue_send(KEYBOARD_IN_EPNUM, report, sizeof(report_keyboard_t), offsetof(report_keyboard_t, mods), 8, keyboard_report_merge);
+        } else {
+            usb_report_queue_send(KEYBOARD_IN_EPNUM, report, sizeof(report_keyboard_t), 0, KEYBOARD_REPORT_SIZE, keyboard_report_merge);
+        }
     }
 
-    /* Finalize the stream transfer to send the last packet */
-    Endpoint_ClearIN();
-
     keyboard_report_sent = *report;
 }
 
-/** \brief Send Mouse
+/** \brief Send Mouse over USB
  *
  * FIXME: Needs doc
  */
-static void send_mouse(report_mouse_t *report) {
 #ifdef MOUSE_ENABLE
-    uint8_t timeout = 255;
+static void send_mouse_usb(report_mouse_t *report) { usb_report_queue_send(MOUSE_IN_EPNUM, report, sizeof(report_mouse_t), 0, sizeof(report_mouse_t), mouse_report_merge); }
+#endif
 
-#    ifdef BLUETOOTH_ENABLE
-    if (where_to_send() == OUTPUT_BLUETOOTH) {
+/** \brief Send Extra
+ *
+ * FIXME: Needs doc
+ */
+#ifdef EXTRAKEY_ENABLE
+static void send_extra(uint8_t report_id, uint16_t data) {
+    report_extra_t r = {.report_id = report_id, .usage = data};
+    usb_report_queue_send(SHARED_IN_EPNUM, &r, sizeof(report_extra_t), 0, sizeof(report_extra_t), NULL);
+}
+#endif
+
+#ifdef BLUETOOTH_ENABLE
+/** \brief Send Keyboard over Bluetooth
+ *
+ * FIXME: Needs doc
+ */
+static void send_keyboard_bt(report_keyboard_t *report) {
+#    ifdef MODULE_ADAFRUIT_BLE
+    adafruit_ble_send_keys(report->mods, report->keys, sizeof(report->keys));
+#    elif MODULE_RN42
+    serial_send(0xFD);
+    serial_send(0x09);
+    serial_send(0x01);
+    serial_send(report->mods);
+    serial_send(report->reserved);
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        serial_send(report->keys[i]);
+    }
+#    endif
+}
+
+/** \brief Send Mouse over Bluetooth
+ *
+ * FIXME: Needs doc
+ */
+#    ifdef MOUSE_ENABLE
+static void send_mouse_bt(report_mouse_t *report) {
 #        ifdef MODULE_ADAFRUIT_BLE
-        // FIXME: mouse buttons
-        adafruit_ble_send_mouse_move(report->x, report->y, report->v, report->h, report->buttons);
+    // FIXME: mouse buttons
+    adafruit_ble_send_mouse_move(report->x, report->y, report->v, report->h, report->buttons);
 #        else
-        serial_send(0xFD);
-        serial_send(0x00);
-        serial_send(0x03);
-        serial_send(report->buttons);
-        serial_send(report->x);
-        serial_send(report->y);
-        serial_send(report->v);  // should try sending the wheel v here
-        serial_send(report->h);  // should try sending the wheel h here
-        serial_send(0x00);
+    serial_send(0xFD);
+    serial_send(0x00);
+    serial_send(0x03);
+    serial_send(report->buttons);
+    serial_send(report->x);
+    serial_send(report->y);
+    serial_send(report->v);  // should try sending the wheel v here
+    serial_send(report->h);  // should try sending the wheel h here
+    serial_send(0x00);
 #        endif
-        return;
-    }
+}
 #    endif
 
-    /* Select the Mouse Report Endpoint */
-    Endpoint_SelectEndpoint(MOUSE_IN_EPNUM);
+/** \brief Send Consumer over Bluetooth
+ *
+ * FIXME: Needs doc
+ */
+#    ifdef EXTRAKEY_ENABLE
+static void send_consumer_bt(uint16_t data) {
+#        ifdef MODULE_ADAFRUIT_BLE
+    adafruit_ble_send_consumer_key(data);
+#        elif MODULE_RN42
+    static uint16_t last_data = 0;
+    if (data == last_data) return;
+    last_data       = data;
+    uint16_t bitmap = CONSUMER2RN42(data);
+    serial_send(0xFD);
+    serial_send(0x03);
+    serial_send(0x03);
+    serial_send(bitmap & 0xFF);
+    serial_send((bitmap >> 8) & 0xFF);
+#        endif
+}
+#    endif
 
-    /* Check if write ready for a polling interval around 10ms */
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
+/*******************************************************************************
+ * Output multiplexer
+ *
+ * Reports go to every output where_to_send() currently selects. What is held
+ * down is kept here, so that when the selection changes, the outputs that are
+ * left get everything released and the ones that are joined get it pressed,
+ * instead of keys sticking on one side or going missing on the other.
+ ******************************************************************************/
+#    define OUTPUT_MASK_USB (1 << 0)
+#    define OUTPUT_MASK_BT (1 << 1)
 
-    /* Write Mouse Report Data */
-    Endpoint_Write_Stream_LE(report, sizeof(report_mouse_t), NULL);
+static uint8_t           output_mask = OUTPUT_MASK_USB;
+static report_keyboard_t output_keyboard_report;
+#    ifdef MOUSE_ENABLE
+static uint8_t output_mouse_buttons;
+#    endif
+#    ifdef EXTRAKEY_ENABLE
+static uint16_t output_system_usage;
+static uint16_t output_consumer_usage;
+#    endif
 
-    /* Finalize the stream transfer to send the last packet */
-    Endpoint_ClearIN();
-#endif
+static uint8_t output_mask_of(uint8_t output) {
+    switch (output) {
+        case OUTPUT_BLUETOOTH:
+            return OUTPUT_MASK_BT;
+        case OUTPUT_USB_AND_BT:
+            return OUTPUT_MASK_USB | OUTPUT_MASK_BT;
+        default:
+            // Nothing selected still goes to USB, which drops it while unconfigured
+            return OUTPUT_MASK_USB;
+    }
 }
 
-/** \brief Send Extra
+// Brings the outputs in mask to the held state, or to nothing held when release is set
+static void output_replay(uint8_t mask, bool release) {
+    report_keyboard_t keyboard_report = {0};
+    if (!release) {
+        keyboard_report = output_keyboard_report;
+    }
+    if (mask & OUTPUT_MASK_USB) send_keyboard_usb(&keyboard_report);
+    if (mask & OUTPUT_MASK_BT) send_keyboard_bt(&keyboard_report);
+
+#    ifdef MOUSE_ENABLE
+    if (output_mouse_buttons) {
+        report_mouse_t mouse_report = {.buttons = release ? 0 : output_mouse_buttons};
+        if (mask & OUTPUT_MASK_USB) send_mouse_usb(&mouse_report);
+        if (mask & OUTPUT_MASK_BT) send_mouse_bt(&mouse_report);
+    }
+#    endif
+
+#    ifdef EXTRAKEY_ENABLE
+    if (output_system_usage && (mask & OUTPUT_MASK_USB)) {
+        send_extra(REPORT_ID_SYSTEM, release ? 0 : output_system_usage);
+    }
+    if (output_consumer_usage) {
+        if (mask & OUTPUT_MASK_USB) send_extra(REPORT_ID_CONSUMER, release ? 0 : output_consumer_usage);
+        if (mask & OUTPUT_MASK_BT) send_consumer_bt(release ? 0 : output_consumer_usage);
+    }
+#    endif
+}
+
+/** \brief Hand the held state over to the outputs selected now
  *
- * FIXME: Needs doc
+ * Called before every report and once per main loop, so a switch takes effect right away.
  */
-#ifdef EXTRAKEY_ENABLE
-static void send_extra(uint8_t report_id, uint16_t data) {
-    uint8_t timeout = 255;
+static uint8_t output_update(void) {
+    uint8_t mask = output_mask_of(where_to_send());
+    if (mask != output_mask) {
+        uint8_t left   = output_mask & ~mask;
+        uint8_t joined = mask & ~output_mask;
+        output_mask    = mask;
+        output_replay(left, true);
+        output_replay(joined, false);
+    }
+    return mask;
+}
+#endif
 
-    if (USB_DeviceState != DEVICE_STATE_Configured) return;
+/** \brief Send Keyboard
+ *
+ * FIXME: Needs doc
+ */
+static void send_keyboard(report_keyboard_t *report) {
+#ifdef BLUETOOTH_ENABLE
+    uint8_t mask           = output_update();
+    output_keyboard_report = *report;
+    if (mask & OUTPUT_MASK_BT) send_keyboard_bt(report);
+    if (!(mask & OUTPUT_MASK_USB)) return;
+#endif
 
-    report_extra_t r = {.report_id = report_id, .usage = data};
-    Endpoint_SelectEndpoint(SHARED_IN_EPNUM);
+    send_keyboard_usb(report);
+}
 
-    /* Check if write ready for a polling interval around 10ms */
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
+/** \brief Send Mouse
+ *
+ * FIXME: Needs doc
+ */
+static void send_mouse(report_mouse_t *report) {
+#ifdef MOUSE_ENABLE
+#    ifdef BLUETOOTH_ENABLE
+    uint8_t mask         = output_update();
+    output_mouse_buttons = report->buttons;
+    if (mask & OUTPUT_MASK_BT) send_mouse_bt(report);
+    if (!(mask & OUTPUT_MASK_USB)) return;
+#    endif
 
-    Endpoint_Write_Stream_LE(&r, sizeof(report_extra_t), NULL);
-    Endpoint_ClearIN();
-}
+    send_mouse_usb(report);
 #endif
+}
 
 /** \brief Send System
  *
@@ -786,6 +1095,13 @@ static void send_extra(uint8_t report_id, uint16_t data) {
  */
 static void send_system(uint16_t data) {
 #ifdef EXTRAKEY_ENABLE
+#    ifdef BLUETOOTH_ENABLE
+    // Only USB has a system control report
+    uint8_t mask        = output_update();
+    output_system_usage = data;
+    if (!(mask & OUTPUT_MASK_USB)) return;
+#    endif
+
     send_extra(REPORT_ID_SYSTEM, data);
 #endif
 }
@@ -797,22 +1113,10 @@ static void send_system(uint16_t data) {
 static void send_consumer(uint16_t data) {
 #ifdef EXTRAKEY_ENABLE
 #    ifdef BLUETOOTH_ENABLE
-    if (where_to_send() == OUTPUT_BLUETOOTH) {
-#        ifdef MODULE_ADAFRUIT_BLE
-        adafruit_ble_send_consumer_key(data);
-#        elif MODULE_RN42
-        static uint16_t last_data = 0;
-        if (data == last_data) return;
-        last_data       = data;
-        uint16_t bitmap = CONSUMER2RN42(data);
-        serial_send(0xFD);
-        serial_send(0x03);
-        serial_send(0x03);
-        serial_send(bitmap & 0xFF);
-        serial_send((bitmap >> 8) & 0xFF);
-#        endif
-        return;
-    }
+    uint8_t mask          = output_update();
+    output_consumer_usage = data;
+    if (mask & OUTPUT_MASK_BT) send_consumer_bt(data);
+    if (!(mask & OUTPUT_MASK_USB)) return;
 #    endif
 
     send_extra(REPORT_ID_CONSUMER, data);
@@ -931,25 +1235,23 @@ void virtser_init(void) {
     CDC_Device_SendControlLineStateChange(&cdc_device);
 }
 
-/** \brief Virtual Serial Receive
- *
- * FIXME: Needs doc
- */
-void virtser_recv(uint8_t c) __attribute__((weak));
-void virtser_recv(uint8_t c) {
-    // Ignore by default
-}
-
 /** \brief Virtual Serial Task
  *
- * FIXME: Needs doc
+ * Hands the bytes of the packet received from the host to virtser_recv_buffer() in one go
  */
 void virtser_task(void) {
-    uint16_t count = CDC_Device_BytesReceived(&cdc_device);
-    uint8_t  ch;
+    uint8_t  buffer[CDC_EPSIZE];
+    uint8_t  length = 0;
+    uint16_t count  = CDC_Device_BytesReceived(&cdc_device);
     for (; count; --count) {
-        ch = CDC_Device_ReceiveByte(&cdc_device);
-        virtser_recv(ch);
+        buffer[length++] = CDC_Device_ReceiveByte(&cdc_device);
+        if (length == sizeof(buffer)) {
+            virtser_recv_buffer(buffer, length);
+            length = 0;
+        }
+    }
+    if (length) {
+        virtser_recv_buffer(buffer, length);
     }
 }
 /** \brief Virtual Serial Send
@@ -981,6 +1283,36 @@ void virtser_send(const uint8_t byte) {
         Endpoint_SelectEndpoint(ep);
     }
 }
+
+/** \brief Virtual Serial Send Buffer
+ *
+ * Writes all bytes to the IN endpoint before flushing, so they leave in as few packets as possible
+ */
+void virtser_send_buffer(const uint8_t *data, uint8_t length) {
+    uint8_t timeout = 255;
+    uint8_t ep      = Endpoint_GetCurrentEndpoint();
+
+    if (cdc_device.State.ControlLineStates.HostToDevice & CDC_CONTROL_LINE_OUT_DTR) {
+        /* IN packet */
+        Endpoint_SelectEndpoint(cdc_device.Config.DataINEndpoint.Address);
+
+        if (!Endpoint_IsEnabled() || !Endpoint_IsConfigured()) {
+            Endpoint_SelectEndpoint(ep);
+            return;
+        }
+
+        while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
+
+        Endpoint_Write_Stream_LE(data, length, NULL);
+        CDC_Device_Flush(&cdc_device);
+
+        if (Endpoint_IsINReady()) {
+            Endpoint_ClearIN();
+        }
+
+        Endpoint_SelectEndpoint(ep);
+    }
+}
 #endif
 
 /*******************************************************************************
@@ -1084,6 +1416,7 @@ int main(void) {
 #endif
 
         keyboard_task();
+        usb_report_queue_task();
 
 #ifdef MIDI_ENABLE
         MIDI_Device_USBTask(&USB_MIDI_Interface);
@@ -1093,13 +1426,17 @@ int main(void) {
         adafruit_ble_task();
 #endif
 
+#ifdef BLUETOOTH_ENABLE
+        output_update();
+#endif
+
 #ifdef VIRTSER_ENABLE
         virtser_task();
         CDC_Device_USBTask(&cdc_device);
 #endif
 
 #ifdef RAW_ENABLE
-        raw_hid_task();
+        TASK_PROFILE(TASK_PROFILE_RAW_HID, raw_hid_task());
 #endif
 
 #if !defined(INTERRUPT_CONTROL_ENDPOINT)
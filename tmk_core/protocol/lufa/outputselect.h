@@ -21,7 +21,10 @@ enum outputs {
 
     OUTPUT_NONE,
     OUTPUT_USB,
-    OUTPUT_BLUETOOTH
+    OUTPUT_BLUETOOTH,
+
+    // Both at once, eg. while moving over from one host to the other
+    OUTPUT_USB_AND_BT
 };
 
 #ifndef OUTPUT_DEFAULT
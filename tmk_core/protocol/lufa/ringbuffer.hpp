@@ -60,6 +60,10 @@ class RingBuffer {
     return buf_[tail_];
   }
 
+  inline T& back() {
+    return buf_[prevPosition(head_)];
+  }
+
   inline bool peek(T &item) {
     return get(item, false);
   }
@@ -4,6 +4,9 @@
 #include "midi.h"
 #include "usb_descriptor.h"
 #include "process_midi.h"
+#ifdef SEQUENCER_ENABLE
+#    include "sequencer.h"
+#endif
 #if API_SYSEX_ENABLE
 #    include "api_sysex.h"
 #endif
@@ -119,6 +122,23 @@ static void fallthrough_callback(MidiDevice* device, uint16_t cnt, uint8_t byte0
 #endif
 }
 
+#if defined(SEQUENCER_ENABLE) && defined(SEQUENCER_MIDI_CLOCK)
+static void realtime_callback(MidiDevice* device, uint8_t byte) {
+    switch (byte) {
+        case MIDI_CLOCK:
+            sequencer_midi_clock();
+            break;
+        case MIDI_START:
+            sequencer_midi_start();
+            break;
+        default:
+            // everything else is handled as it would be without this callback
+            fallthrough_callback(device, 1, byte, 0, 0);
+            break;
+    }
+}
+#endif
+
 static void cc_callback(MidiDevice* device, uint8_t chan, uint8_t num, uint8_t val) {
     // sending it back on the next channel
     // midi_send_cc(device, (chan + 1) % 16, num, val);
@@ -170,6 +190,9 @@ void setup_midi(void) {
     midi_device_set_pre_input_process_func(&midi_device, usb_get_midi);
     midi_register_fallthrough_callback(&midi_device, fallthrough_callback);
     midi_register_cc_callback(&midi_device, cc_callback);
+#if defined(SEQUENCER_ENABLE) && defined(SEQUENCER_MIDI_CLOCK)
+    midi_register_realtime_callback(&midi_device, realtime_callback);
+#endif
 #ifdef API_SYSEX_ENABLE
     midi_register_sysex_callback(&midi_device, sysex_callback);
 #endif
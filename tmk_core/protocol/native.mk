@@ -0,0 +1,8 @@
+NATIVE_DIR = protocol/native
+
+SRC += $(NATIVE_DIR)/main.c
+
+# Search Path
+VPATH += $(TMK_PATH)/$(NATIVE_DIR)
+
+OPT_DEFS += -DPROTOCOL_NATIVE
@@ -0,0 +1,42 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pin_defs.h"
+
+typedef uint16_t pin_t;
+
+// There are no pins on the host: writes go nowhere and every input reads high, as if pulled up
+#define setPinInput(pin) ((void)(pin))
+#define setPinInputHigh(pin) ((void)(pin))
+#define setPinInputLow(pin) ((void)(pin))
+#define setPinOutput(pin) ((void)(pin))
+
+#define writePinHigh(pin) ((void)(pin))
+#define writePinLow(pin) ((void)(pin))
+#define writePin(pin, level) ((void)(pin), (void)(level))
+
+#define readPin(pin) ((void)(pin), true)
+
+#define togglePin(pin) ((void)(pin))
+
+typedef uint32_t port_data_t;
+
+#define readPinPort(pin) ((void)(pin), (port_data_t)~0)
+#define getPinPad(pin) ((pin) & ((1 << PORT_SHIFTER) - 1))
+#define samePinPort(pin_a, pin_b) (((pin_a) >> PORT_SHIFTER) == ((pin_b) >> PORT_SHIFTER))
@@ -0,0 +1,299 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "keyboard.h"
+#include "matrix.h"
+#include "host.h"
+#include "timer.h"
+#include "keycode_config.h"
+#ifdef RAW_ENABLE
+#    include "raw_hid.h"
+#endif
+
+/*
+ * Runs the keyboard and keymap on the host, so that they can be profiled
+ * with perf, callgrind and the like. The matrix is fed from a capture in the
+ * format of `qmk decode-trace --capture`, one scan per millisecond of virtual
+ * time, and the reports go out as lines of text, keyboard reports formatted
+ * as tests/replay writes them.
+ *
+ *   <keyboard>_<keymap>.elf [-q] [-r repeat] [-o output] [capture]
+ *
+ *   -q         count the reports without writing them out
+ *   -r repeat  replay the capture this many times in a row
+ *   -o output  file to write the reports to, stdout when not given
+ *   capture    file to read the capture from, stdin when not given or -
+ */
+
+#ifndef NATIVE_SETTLE_TIME
+// Scans that run after the last event, so that tapping terms and the like run out
+#    define NATIVE_SETTLE_TIME 1000
+#endif
+
+typedef struct {
+    uint32_t time;  // ms since the start of the capture
+    uint8_t  row;
+    uint8_t  col;
+    bool     pressed;
+} native_event_t;
+
+void advance_time(uint32_t ms);
+
+uint8_t keyboard_idle     = 0;
+uint8_t keyboard_protocol = 1;
+
+// Split keyboards run as one, split_util.h declares this for their code
+volatile bool isLeftHand = true;
+
+static FILE *   report_file  = NULL;  // NULL when the reports are only counted
+static uint32_t report_count = 0;
+static uint32_t report_start = 0;  // virtual time the current replay started at
+
+static matrix_row_t native_matrix[MATRIX_ROWS];
+static bool         native_matrix_changed = false;
+
+// matrix_common.c scans through this, CUSTOM_MATRIX = lite
+bool matrix_scan_custom(matrix_row_t current_matrix[]) {
+    if (!native_matrix_changed) {
+        return false;
+    }
+    memcpy(current_matrix, native_matrix, sizeof(native_matrix));
+    native_matrix_changed = false;
+    return true;
+}
+
+static unsigned long report_time(void) { return timer_read32() - report_start; }
+
+static uint8_t keyboard_leds(void) { return 0; }
+
+static void send_keyboard(report_keyboard_t *report) {
+    report_count++;
+    if (!report_file) {
+        return;
+    }
+
+    bool    empty = true;
+    uint8_t mods  = report->mods;
+#ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) {
+        mods = report->nkro.mods;
+    }
+#endif
+    fprintf(report_file, "%lu mods 0x%02X keys", report_time(), mods);
+#ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) {
+        for (uint16_t i = 0; i < KEYBOARD_REPORT_BITS * 8; i++) {
+            if (report->nkro.bits[i / 8] & (1 << (i % 8))) {
+                fprintf(report_file, " 0x%02X", i);
+                empty = false;
+            }
+        }
+    } else
+#endif
+    {
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+            if (report->keys[i]) {
+                fprintf(report_file, " 0x%02X", report->keys[i]);
+                empty = false;
+            }
+        }
+    }
+    fputs(empty ? " -\n" : "\n", report_file);
+}
+
+static void send_mouse(report_mouse_t *report) {
+    report_count++;
+    if (report_file) {
+        fprintf(report_file, "%lu mouse buttons 0x%02X x %d y %d v %d h %d\n", report_time(), report->buttons, report->x, report->y, report->v, report->h);
+    }
+}
+
+static void send_system(uint16_t data) {
+    report_count++;
+    if (report_file) {
+        fprintf(report_file, "%lu system 0x%04X\n", report_time(), data);
+    }
+}
+
+static void send_consumer(uint16_t data) {
+    report_count++;
+    if (report_file) {
+        fprintf(report_file, "%lu consumer 0x%04X\n", report_time(), data);
+    }
+}
+
+static host_driver_t native_driver = {keyboard_leds, send_keyboard, send_mouse, send_system, send_consumer};
+
+#ifdef RAW_ENABLE
+void raw_hid_send(uint8_t *data, uint8_t length) {
+    report_count++;
+    if (report_file) {
+        fprintf(report_file, "%lu raw", report_time());
+        for (uint8_t i = 0; i < length; i++) {
+            fprintf(report_file, " %02X", data[i]);
+        }
+        fputc('\n', report_file);
+    }
+}
+#endif
+
+// Reads every event of the capture, skipping '#' comments and blank lines
+static bool read_capture(FILE *file, const char *name, native_event_t **events, size_t *count) {
+    size_t   capacity = 0;
+    char     line[256];
+    unsigned number = 0;
+
+    *events = NULL;
+    *count  = 0;
+    while (fgets(line, sizeof(line), file)) {
+        number++;
+        char *comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+
+        unsigned long time;
+        unsigned      row, col;
+        char          state[8], rest;
+        int           fields = sscanf(line, "%lu %u %u %7s %c", &time, &row, &col, state, &rest);
+        if (fields <= 0) {
+            continue;
+        }
+        if (fields != 4 || (strcmp(state, "down") && strcmp(state, "up"))) {
+            fprintf(stderr, "%s:%u: not a capture line\n", name, number);
+            return false;
+        }
+        if (row >= MATRIX_ROWS || col >= MATRIX_COLS) {
+            fprintf(stderr, "%s:%u: key outside of the %ux%u matrix\n", name, number, MATRIX_ROWS, MATRIX_COLS);
+            return false;
+        }
+        if (*count && time < (*events)[*count - 1].time) {
+            fprintf(stderr, "%s:%u: capture goes back in time\n", name, number);
+            return false;
+        }
+
+        if (*count == capacity) {
+            capacity            = capacity ? capacity * 2 : 256;
+            native_event_t *all = realloc(*events, capacity * sizeof(native_event_t));
+            if (!all) {
+                fprintf(stderr, "%s: out of memory\n", name);
+                return false;
+            }
+            *events = all;
+        }
+        (*events)[(*count)++] = (native_event_t){.time = time, .row = row, .col = col, .pressed = !strcmp(state, "down")};
+    }
+
+    if (ferror(file)) {
+        fprintf(stderr, "can't read %s\n", name);
+        return false;
+    }
+    return true;
+}
+
+static int usage(const char *program) {
+    fprintf(stderr, "usage: %s [-q] [-r repeat] [-o output] [capture]\n", program);
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    const char *  capture = "-";
+    const char *  output  = NULL;
+    bool          quiet   = false;
+    unsigned long repeat  = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-q")) {
+            quiet = true;
+        } else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            repeat = strtoul(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            output = argv[++i];
+        } else if (argv[i][0] == '-' && argv[i][1]) {
+            return usage(argv[0]);
+        } else {
+            capture = argv[i];
+        }
+    }
+    if (!repeat) {
+        return usage(argv[0]);
+    }
+
+    FILE *in = strcmp(capture, "-") ? fopen(capture, "r") : stdin;
+    if (!in) {
+        fprintf(stderr, "can't read %s\n", capture);
+        return 1;
+    }
+    native_event_t *events;
+    size_t          count;
+    bool            read = read_capture(in, capture, &events, &count);
+    if (in != stdin) {
+        fclose(in);
+    }
+    if (!read) {
+        free(events);
+        return 1;
+    }
+
+    if (!quiet) {
+        report_file = output ? fopen(output, "w") : stdout;
+        if (!report_file) {
+            fprintf(stderr, "can't write %s\n", output);
+            return 1;
+        }
+    }
+
+    keyboard_setup();
+    keyboard_init();
+    host_set_driver(&native_driver);
+
+    const uint32_t length = (count ? events[count - 1].time : 0) + NATIVE_SETTLE_TIME;
+    clock_t        start  = clock();
+    for (unsigned long r = 0; r < repeat; r++) {
+        report_start = timer_read32();
+        size_t next  = 0;
+        for (uint32_t t = 0; t < length; t++) {
+            for (; next < count && events[next].time == t; next++) {
+                if (events[next].pressed) {
+                    native_matrix[events[next].row] |= (matrix_row_t)1 << events[next].col;
+                } else {
+                    native_matrix[events[next].row] &= ~((matrix_row_t)1 << events[next].col);
+                }
+                native_matrix_changed = true;
+            }
+
+            keyboard_task();
+            housekeeping_task_kb();
+            housekeeping_task_user();
+            advance_time(1);
+        }
+    }
+    double cpu_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    if (report_file && report_file != stdout && fclose(report_file)) {
+        fprintf(stderr, "can't write %s\n", output);
+        return 1;
+    }
+    fprintf(stderr, "%s: %zu events, %lu reports, %.0f ns per scan\n", capture, count * repeat, (unsigned long)report_count, cpu_time * 1e9 / ((double)length * repeat));
+
+    free(events);
+    return 0;
+}
@@ -0,0 +1,203 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+// The pin names of the AVR and ChibiOS platforms, so that the pins of any keyboard's config.h compile
+#define PORT_SHIFTER 5
+#define PINDEF(port, pad) ((pin_t)(((port) << PORT_SHIFTER) | (pad)))
+
+// clang-format off
+#define A0 PINDEF(0, 0)
+#define A1 PINDEF(0, 1)
+#define A2 PINDEF(0, 2)
+#define A3 PINDEF(0, 3)
+#define A4 PINDEF(0, 4)
+#define A5 PINDEF(0, 5)
+#define A6 PINDEF(0, 6)
+#define A7 PINDEF(0, 7)
+#define A8 PINDEF(0, 8)
+#define A9 PINDEF(0, 9)
+#define A10 PINDEF(0, 10)
+#define A11 PINDEF(0, 11)
+#define A12 PINDEF(0, 12)
+#define A13 PINDEF(0, 13)
+#define A14 PINDEF(0, 14)
+#define A15 PINDEF(0, 15)
+#define B0 PINDEF(1, 0)
+#define B1 PINDEF(1, 1)
+#define B2 PINDEF(1, 2)
+#define B3 PINDEF(1, 3)
+#define B4 PINDEF(1, 4)
+#define B5 PINDEF(1, 5)
+#define B6 PINDEF(1, 6)
+#define B7 PINDEF(1, 7)
+#define B8 PINDEF(1, 8)
+#define B9 PINDEF(1, 9)
+#define B10 PINDEF(1, 10)
+#define B11 PINDEF(1, 11)
+#define B12 PINDEF(1, 12)
+#define B13 PINDEF(1, 13)
+#define B14 PINDEF(1, 14)
+#define B15 PINDEF(1, 15)
+#define B16 PINDEF(1, 16)
+#define B17 PINDEF(1, 17)
+#define B18 PINDEF(1, 18)
+#define B19 PINDEF(1, 19)
+#define C0 PINDEF(2, 0)
+#define C1 PINDEF(2, 1)
+#define C2 PINDEF(2, 2)
+#define C3 PINDEF(2, 3)
+#define C4 PINDEF(2, 4)
+#define C5 PINDEF(2, 5)
+#define C6 PINDEF(2, 6)
+#define C7 PINDEF(2, 7)
+#define C8 PINDEF(2, 8)
+#define C9 PINDEF(2, 9)
+#define C10 PINDEF(2, 10)
+#define C11 PINDEF(2, 11)
+#define C12 PINDEF(2, 12)
+#define C13 PINDEF(2, 13)
+#define C14 PINDEF(2, 14)
+#define C15 PINDEF(2, 15)
+#define D0 PINDEF(3, 0)
+#define D1 PINDEF(3, 1)
+#define D2 PINDEF(3, 2)
+#define D3 PINDEF(3, 3)
+#define D4 PINDEF(3, 4)
+#define D5 PINDEF(3, 5)
+#define D6 PINDEF(3, 6)
+#define D7 PINDEF(3, 7)
+#define D8 PINDEF(3, 8)
+#define D9 PINDEF(3, 9)
+#define D10 PINDEF(3, 10)
+#define D11 PINDEF(3, 11)
+#define D12 PINDEF(3, 12)
+#define D13 PINDEF(3, 13)
+#define D14 PINDEF(3, 14)
+#define D15 PINDEF(3, 15)
+#define E0 PINDEF(4, 0)
+#define E1 PINDEF(4, 1)
+#define E2 PINDEF(4, 2)
+#define E3 PINDEF(4, 3)
+#define E4 PINDEF(4, 4)
+#define E5 PINDEF(4, 5)
+#define E6 PINDEF(4, 6)
+#define E7 PINDEF(4, 7)
+#define E8 PINDEF(4, 8)
+#define E9 PINDEF(4, 9)
+#define E10 PINDEF(4, 10)
+#define E11 PINDEF(4, 11)
+#define E12 PINDEF(4, 12)
+#define E13 PINDEF(4, 13)
+#define E14 PINDEF(4, 14)
+#define E15 PINDEF(4, 15)
+#define F0 PINDEF(5, 0)
+#define F1 PINDEF(5, 1)
+#define F2 PINDEF(5, 2)
+#define F3 PINDEF(5, 3)
+#define F4 PINDEF(5, 4)
+#define F5 PINDEF(5, 5)
+#define F6 PINDEF(5, 6)
+#define F7 PINDEF(5, 7)
+#define F8 PINDEF(5, 8)
+#define F9 PINDEF(5, 9)
+#define F10 PINDEF(5, 10)
+#define F11 PINDEF(5, 11)
+#define F12 PINDEF(5, 12)
+#define F13 PINDEF(5, 13)
+#define F14 PINDEF(5, 14)
+#define F15 PINDEF(5, 15)
+#define G0 PINDEF(6, 0)
+#define G1 PINDEF(6, 1)
+#define G2 PINDEF(6, 2)
+#define G3 PINDEF(6, 3)
+#define G4 PINDEF(6, 4)
+#define G5 PINDEF(6, 5)
+#define G6 PINDEF(6, 6)
+#define G7 PINDEF(6, 7)
+#define G8 PINDEF(6, 8)
+#define G9 PINDEF(6, 9)
+#define G10 PINDEF(6, 10)
+#define G11 PINDEF(6, 11)
+#define G12 PINDEF(6, 12)
+#define G13 PINDEF(6, 13)
+#define G14 PINDEF(6, 14)
+#define G15 PINDEF(6, 15)
+#define H0 PINDEF(7, 0)
+#define H1 PINDEF(7, 1)
+#define H2 PINDEF(7, 2)
+#define H3 PINDEF(7, 3)
+#define H4 PINDEF(7, 4)
+#define H5 PINDEF(7, 5)
+#define H6 PINDEF(7, 6)
+#define H7 PINDEF(7, 7)
+#define H8 PINDEF(7, 8)
+#define H9 PINDEF(7, 9)
+#define H10 PINDEF(7, 10)
+#define H11 PINDEF(7, 11)
+#define H12 PINDEF(7, 12)
+#define H13 PINDEF(7, 13)
+#define H14 PINDEF(7, 14)
+#define H15 PINDEF(7, 15)
+#define I0 PINDEF(8, 0)
+#define I1 PINDEF(8, 1)
+#define I2 PINDEF(8, 2)
+#define I3 PINDEF(8, 3)
+#define I4 PINDEF(8, 4)
+#define I5 PINDEF(8, 5)
+#define I6 PINDEF(8, 6)
+#define I7 PINDEF(8, 7)
+#define I8 PINDEF(8, 8)
+#define I9 PINDEF(8, 9)
+#define I10 PINDEF(8, 10)
+#define I11 PINDEF(8, 11)
+#define I12 PINDEF(8, 12)
+#define I13 PINDEF(8, 13)
+#define I14 PINDEF(8, 14)
+#define I15 PINDEF(8, 15)
+#define J0 PINDEF(9, 0)
+#define J1 PINDEF(9, 1)
+#define J2 PINDEF(9, 2)
+#define J3 PINDEF(9, 3)
+#define J4 PINDEF(9, 4)
+#define J5 PINDEF(9, 5)
+#define J6 PINDEF(9, 6)
+#define J7 PINDEF(9, 7)
+#define J8 PINDEF(9, 8)
+#define J9 PINDEF(9, 9)
+#define J10 PINDEF(9, 10)
+#define J11 PINDEF(9, 11)
+#define J12 PINDEF(9, 12)
+#define J13 PINDEF(9, 13)
+#define J14 PINDEF(9, 14)
+#define J15 PINDEF(9, 15)
+#define K0 PINDEF(10, 0)
+#define K1 PINDEF(10, 1)
+#define K2 PINDEF(10, 2)
+#define K3 PINDEF(10, 3)
+#define K4 PINDEF(10, 4)
+#define K5 PINDEF(10, 5)
+#define K6 PINDEF(10, 6)
+#define K7 PINDEF(10, 7)
+#define K8 PINDEF(10, 8)
+#define K9 PINDEF(10, 9)
+#define K10 PINDEF(10, 10)
+#define K11 PINDEF(10, 11)
+#define K12 PINDEF(10, 12)
+#define K13 PINDEF(10, 13)
+#define K14 PINDEF(10, 14)
+#define K15 PINDEF(10, 15)
+// clang-format on
@@ -0,0 +1,29 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ws2812.h"
+
+// The animations are computed as on the keyboard, the frames they produce are dropped
+void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds) {
+    (void)ledarray;
+    (void)number_of_leds;
+}
+
+void ws2812_setleds_async(LED_TYPE *ledarray, uint16_t number_of_leds, ws2812_callback_t callback) {
+    ws2812_setleds(ledarray, number_of_leds);
+    if (callback) {
+        callback();
+    }
+}
@@ -89,6 +89,10 @@ uint8_t ps2_host_send(uint8_t data);
 uint8_t ps2_host_recv_response(void);
 uint8_t ps2_host_recv(void);
 void    ps2_host_set_led(uint8_t usb_led);
+#if defined(PS2_USE_INT) || defined(PS2_USE_USART)
+uint8_t  ps2_host_recv_count(void);
+uint16_t ps2_host_overflows(void);
+#endif
 
 /*--------------------------------------------------------------------
  * static functions
@@ -30,8 +30,22 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 static report_mouse_t mouse_report = {};
 
+#if !defined(PS2_MOUSE_USE_REMOTE_MODE) && (defined(PS2_USE_INT) || defined(PS2_USE_USART))
+/* In stream mode the mouse sends a packet at every sample, which the interrupt driven backends collect in their
+ * buffer. Every task takes all of them: their motion is added up into one report, and whatever does not fit into
+ * it is kept for the next one, so none is lost however fast the mouse streams. */
+#    define PS2_MOUSE_STREAM_BUFFERED
+#    ifdef PS2_MOUSE_ENABLE_SCROLLING
+#        define PS2_MOUSE_PACKET_SIZE 4
+#    else
+#        define PS2_MOUSE_PACKET_SIZE 3
+#    endif
+#endif
+
 static inline void ps2_mouse_print_report(report_mouse_t *mouse_report);
 static inline void ps2_mouse_convert_report_to_hid(report_mouse_t *mouse_report);
+static inline void ps2_mouse_orient_report(report_mouse_t *mouse_report);
+static void        ps2_mouse_send_report(report_mouse_t *mouse_report);
 static inline void ps2_mouse_clear_report(report_mouse_t *mouse_report);
 static inline void ps2_mouse_enable_scrolling(void);
 static inline void ps2_mouse_scroll_button_task(report_mouse_t *mouse_report);
@@ -70,6 +84,83 @@ __attribute__((weak)) void ps2_mouse_init_user(void) {}
 
 __attribute__((weak)) void ps2_mouse_moved_user(report_mouse_t *mouse_report) {}
 
+#ifdef PS2_MOUSE_STREAM_BUFFERED
+// Motion of the packets taken so far that was not sent yet
+static int16_t pending_x, pending_y, pending_v;
+static uint8_t pending_buttons;
+static bool    pending;
+
+static int16_t ps2_mouse_packet_delta(uint8_t status, uint8_t value, uint8_t sign_bit, uint8_t overflow_bit) {
+    // 9-bit two's complement, see ps2_mouse_convert_report_to_hid()
+    if (status & (1 << overflow_bit)) {
+        return (status & (1 << sign_bit)) ? -255 : 255;
+    }
+    return (status & (1 << sign_bit)) ? (int16_t)value - 256 : value;
+}
+
+static int8_t ps2_mouse_take_pending(int16_t *pending_delta) {
+    int16_t delta = *pending_delta < -127 ? -127 : *pending_delta > 127 ? 127 : *pending_delta;
+    *pending_delta -= delta;
+    return delta;
+}
+
+static void ps2_mouse_send_pending(void) {
+    mouse_report.buttons = pending_buttons;
+    mouse_report.x       = ps2_mouse_take_pending(&pending_x);
+    mouse_report.y       = ps2_mouse_take_pending(&pending_y);
+    mouse_report.v       = ps2_mouse_take_pending(&pending_v);
+    ps2_mouse_orient_report(&mouse_report);
+    ps2_mouse_send_report(&mouse_report);
+    ps2_mouse_clear_report(&mouse_report);
+    pending = pending_x || pending_y || pending_v;
+}
+
+void ps2_mouse_task(void) {
+    extern int      tp_buttons;
+    static uint16_t overflows = 0;
+    uint8_t         packet[PS2_MOUSE_PACKET_SIZE];
+
+    while (ps2_host_recv_count() >= PS2_MOUSE_PACKET_SIZE) {
+        packet[0] = ps2_host_recv();
+        // Bit 3 of the first byte is always set, skip bytes until one has it should a byte have been lost
+        if (!(packet[0] & (1 << 3))) {
+            continue;
+        }
+        for (uint8_t i = 1; i < PS2_MOUSE_PACKET_SIZE; i++) {
+            packet[i] = ps2_host_recv();
+        }
+#    ifdef PS2_MOUSE_DEBUG_RAW
+        if (debug_mouse) xprintf("ps2_mouse: packet %02X %02X %02X\n", packet[0], packet[1], packet[2]);
+#    endif
+
+        // A change of buttons goes out in a report of its own, after the motion that came before it
+        uint8_t buttons = (packet[0] | tp_buttons) & PS2_MOUSE_BTN_MASK;
+        if (buttons != pending_buttons) {
+            if (pending) {
+                ps2_mouse_send_pending();
+            }
+            pending_buttons = buttons;
+            pending         = true;
+        }
+
+        pending_x += ps2_mouse_packet_delta(packet[0], packet[1], PS2_MOUSE_X_SIGN, PS2_MOUSE_X_OVFLW) * PS2_MOUSE_X_MULTIPLIER;
+        pending_y += ps2_mouse_packet_delta(packet[0], packet[2], PS2_MOUSE_Y_SIGN, PS2_MOUSE_Y_OVFLW) * PS2_MOUSE_Y_MULTIPLIER;
+#    ifdef PS2_MOUSE_ENABLE_SCROLLING
+        pending_v += -(packet[3] & PS2_MOUSE_SCROLL_MASK) * PS2_MOUSE_V_MULTIPLIER;
+#    endif
+        pending |= pending_x || pending_y || pending_v;
+    }
+
+    if (debug_mouse && ps2_host_overflows() != overflows) {
+        overflows = ps2_host_overflows();
+        xprintf("ps2_mouse: %u bytes lost to a full buffer\n", overflows);
+    }
+
+    if (pending) {
+        ps2_mouse_send_pending();
+    }
+}
+#else
 void ps2_mouse_task(void) {
     static uint8_t buttons_prev = 0;
     extern int     tp_buttons;
@@ -81,9 +172,9 @@ void ps2_mouse_task(void) {
         mouse_report.buttons = ps2_host_recv_response() | tp_buttons;
         mouse_report.x       = ps2_host_recv_response() * PS2_MOUSE_X_MULTIPLIER;
         mouse_report.y       = ps2_host_recv_response() * PS2_MOUSE_Y_MULTIPLIER;
-#ifdef PS2_MOUSE_ENABLE_SCROLLING
+#    ifdef PS2_MOUSE_ENABLE_SCROLLING
         mouse_report.v = -(ps2_host_recv_response() & PS2_MOUSE_SCROLL_MASK) * PS2_MOUSE_V_MULTIPLIER;
-#endif
+#    endif
     } else {
         if (debug_mouse) print("ps2_mouse: fail to get mouse packet\n");
         return;
@@ -91,26 +182,31 @@ void ps2_mouse_task(void) {
 
     /* if mouse moves or buttons state changes */
     if (mouse_report.x || mouse_report.y || mouse_report.v || ((mouse_report.buttons ^ buttons_prev) & PS2_MOUSE_BTN_MASK)) {
-#ifdef PS2_MOUSE_DEBUG_RAW
+#    ifdef PS2_MOUSE_DEBUG_RAW
         // Used to debug raw ps2 bytes from mouse
         ps2_mouse_print_report(&mouse_report);
-#endif
+#    endif
         buttons_prev = mouse_report.buttons;
         ps2_mouse_convert_report_to_hid(&mouse_report);
+        ps2_mouse_send_report(&mouse_report);
+    }
+
+    ps2_mouse_clear_report(&mouse_report);
+}
+#endif
+
+static void ps2_mouse_send_report(report_mouse_t *mouse_report) {
 #if PS2_MOUSE_SCROLL_BTN_MASK
-        ps2_mouse_scroll_button_task(&mouse_report);
+    ps2_mouse_scroll_button_task(mouse_report);
 #endif
-        if (mouse_report.x || mouse_report.y || mouse_report.v) {
-            ps2_mouse_moved_user(&mouse_report);
-        }
+    if (mouse_report->x || mouse_report->y || mouse_report->v) {
+        ps2_mouse_moved_user(mouse_report);
+    }
 #ifdef PS2_MOUSE_DEBUG_HID
-        // Used to debug the bytes sent to the host
-        ps2_mouse_print_report(&mouse_report);
+    // Used to debug the bytes sent to the host
+    ps2_mouse_print_report(mouse_report);
 #endif
-        host_mouse_send(&mouse_report);
-    }
-
-    ps2_mouse_clear_report(&mouse_report);
+    host_mouse_send(mouse_report);
 }
 
 void ps2_mouse_disable_data_reporting(void) { PS2_MOUSE_SEND(PS2_MOUSE_DISABLE_DATA_REPORTING, "ps2 mouse disable data reporting"); }
@@ -155,6 +251,10 @@ static inline void ps2_mouse_convert_report_to_hid(report_mouse_t *mouse_report)
     // remove sign and overflow flags
     mouse_report->buttons &= PS2_MOUSE_BTN_MASK;
 
+    ps2_mouse_orient_report(mouse_report);
+}
+
+static inline void ps2_mouse_orient_report(report_mouse_t *mouse_report) {
 #ifdef PS2_MOUSE_INVERT_X
     mouse_report->x = -mouse_report->x;
 #endif
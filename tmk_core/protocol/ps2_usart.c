@@ -60,6 +60,9 @@ static inline uint8_t pbuf_dequeue(void);
 static inline void    pbuf_enqueue(uint8_t data);
 static inline bool    pbuf_has_data(void);
 static inline void    pbuf_clear(void);
+static inline uint8_t pbuf_count(void);
+
+static uint16_t pbuf_overflows = 0;
 
 void ps2_host_init(void) {
     idle();  // without this many USART errors occur when cable is disconnected
@@ -139,6 +142,18 @@ uint8_t ps2_host_recv_response(void) {
     return pbuf_dequeue();
 }
 
+/* number of bytes received by interrupt and not read yet */
+uint8_t ps2_host_recv_count(void) { return pbuf_count(); }
+
+/* number of bytes dropped because the buffer was full */
+uint16_t ps2_host_overflows(void) {
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t overflows = pbuf_overflows;
+    SREG               = sreg;
+    return overflows;
+}
+
 uint8_t ps2_host_recv(void) {
     if (pbuf_has_data()) {
         ps2_error = PS2_ERR_NONE;
@@ -169,7 +184,10 @@ void ps2_host_set_led(uint8_t led) {
 /*--------------------------------------------------------------------
  * Ring buffer to store scan codes from keyboard
  *------------------------------------------------------------------*/
-#define PBUF_SIZE 32
+#ifndef PS2_BUFFER_SIZE
+#    define PS2_BUFFER_SIZE 32
+#endif
+#define PBUF_SIZE PS2_BUFFER_SIZE
 static uint8_t     pbuf[PBUF_SIZE];
 static uint8_t     pbuf_head = 0;
 static uint8_t     pbuf_tail = 0;
@@ -181,7 +199,7 @@ static inline void pbuf_enqueue(uint8_t data) {
         pbuf[pbuf_head] = data;
         pbuf_head       = next;
     } else {
-        print("pbuf: full\n");
+        pbuf_overflows++;
     }
     SREG = sreg;
 }
@@ -205,6 +223,13 @@ static inline bool pbuf_has_data(void) {
     SREG          = sreg;
     return has_data;
 }
+static inline uint8_t pbuf_count(void) {
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t count = (pbuf_head + PBUF_SIZE - pbuf_tail) % PBUF_SIZE;
+    SREG          = sreg;
+    return count;
+}
 static inline void pbuf_clear(void) {
     uint8_t sreg = SREG;
     cli();
@@ -278,7 +278,13 @@ enum usb_endpoints {
 #define KEYBOARD_EPSIZE 8
 #define SHARED_EPSIZE 32
 #define MOUSE_EPSIZE 8
-#define RAW_EPSIZE 32
+// 64 bytes is the largest interrupt packet at full speed, raw HID frames are one packet
+#ifndef RAW_EPSIZE
+#    define RAW_EPSIZE 32
+#endif
+#if RAW_EPSIZE > 64
+#    error "RAW_EPSIZE must be 64 or less"
+#endif
 #define CONSOLE_EPSIZE 32
 #define MIDI_STREAM_EPSIZE 64
 #define CDC_NOTIFICATION_EPSIZE 8
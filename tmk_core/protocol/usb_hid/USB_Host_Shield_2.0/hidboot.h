@@ -539,7 +539,12 @@ void HIDBoot<BOOT_PROTOCOL>::EndpointXtract(uint8_t conf, uint8_t iface, uint8_t
         bIfaceNum = iface;
 
         if((pep->bmAttributes & 0x03) == 3 && (pep->bEndpointAddress & 0x80) == 0x80) {
+#ifdef USB_HOST_POLL_INTERVAL
+                // Poll more often than the device asks for, it NAKs when it has nothing new
+                bInterval = USB_HOST_POLL_INTERVAL;
+#else
                 if(pep->bInterval > bInterval) bInterval = pep->bInterval;
+#endif
 
                 // Fill in the endpoint info structure
                 epInfo[bNumEP].epAddr = (pep->bEndpointAddress & 0x0F);
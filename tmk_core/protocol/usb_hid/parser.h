@@ -9,6 +9,7 @@ class KBDReportParser : public HIDReportParser
 public:
     report_keyboard_t report;
     uint16_t time_stamp;
+    bool updated;  // a report came in since this was last cleared
     virtual void Parse(HID *hid, bool is_rpt_id, uint8_t len, uint8_t *buf);
 };
 
@@ -16,6 +16,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <stdint.h>
+#include <string.h>
 
 #include <avr/wdt.h>
 
@@ -85,35 +86,52 @@ static uint8_t keyboard_led_state = 0;
 static uint8_t vusb_idle_rate     = 0;
 
 /* Keyboard report send buffer */
-#define KBUF_SIZE 16
+#ifndef VUSB_KEYBOARD_BUFFER_SIZE
+#    define VUSB_KEYBOARD_BUFFER_SIZE 16
+#endif
+#define KBUF_SIZE VUSB_KEYBOARD_BUFFER_SIZE
 static report_keyboard_t kbuf[KBUF_SIZE];
 static uint8_t           kbuf_head = 0;
 static uint8_t           kbuf_tail = 0;
+#ifdef KEYBOARD_SHARED_EP
+// The first part of kbuf[kbuf_tail] has been sent, its last byte goes next
+static bool kbuf_split = false;
+#endif
 
 static report_keyboard_t keyboard_report_sent;
 
 #define VUSB_TRANSFER_KEYBOARD_MAX_TRIES 10
 
+static uint8_t kbuf_count(void) { return (kbuf_head + KBUF_SIZE - kbuf_tail) % KBUF_SIZE; }
+
+/* hand the next part of the oldest report to the driver, if it can take one */
+static bool kbuf_transfer(void) {
+    if (kbuf_head == kbuf_tail || !usbInterruptIsReady()) {
+        return false;
+    }
+#ifndef KEYBOARD_SHARED_EP
+    usbSetInterrupt((void *)&kbuf[kbuf_tail], sizeof(report_keyboard_t));
+#else
+    // The report is one byte larger than the endpoint, it goes in two parts, one per poll of the host
+    if (!kbuf_split) {
+        usbSetInterrupt((void *)&kbuf[kbuf_tail], sizeof(report_keyboard_t) - 1);
+        kbuf_split = true;
+        return true;
+    }
+    usbSetInterrupt((void *)(&(kbuf[kbuf_tail].keys[5])), 1);
+    kbuf_split = false;
+#endif
+    kbuf_tail = (kbuf_tail + 1) % KBUF_SIZE;
+    if (debug_keyboard) {
+        dprintf("V-USB: kbuf[%d->%d](%02X)\n", kbuf_tail, kbuf_head, kbuf_count());
+    }
+    return true;
+}
+
 /* transfer keyboard report from buffer */
 void vusb_transfer_keyboard(void) {
     for (int i = 0; i < VUSB_TRANSFER_KEYBOARD_MAX_TRIES; i++) {
-        if (usbInterruptIsReady()) {
-            if (kbuf_head != kbuf_tail) {
-#ifndef KEYBOARD_SHARED_EP
-                usbSetInterrupt((void *)&kbuf[kbuf_tail], sizeof(report_keyboard_t));
-#else
-                // Ugly hack! :(
-                usbSetInterrupt((void *)&kbuf[kbuf_tail], sizeof(report_keyboard_t) - 1);
-                while (!usbInterruptIsReady()) {
-                    usbPoll();
-                }
-                usbSetInterrupt((void *)(&(kbuf[kbuf_tail].keys[5])), 1);
-#endif
-                kbuf_tail = (kbuf_tail + 1) % KBUF_SIZE;
-                if (debug_keyboard) {
-                    dprintf("V-USB: kbuf[%d->%d](%02X)\n", kbuf_tail, kbuf_head, (kbuf_head < kbuf_tail) ? (KBUF_SIZE - kbuf_tail + kbuf_head) : (kbuf_head - kbuf_tail));
-                }
-            }
+        if (kbuf_transfer() || kbuf_head == kbuf_tail) {
             break;
         }
         usbPoll();
@@ -234,12 +252,34 @@ host_driver_t *vusb_driver(void) { return &driver; }
 static uint8_t keyboard_leds(void) { return keyboard_led_state; }
 
 static void send_keyboard(report_keyboard_t *report) {
+    // The host already has, or is going to get, this state
+    if (memcmp(report, &keyboard_report_sent, sizeof(report_keyboard_t)) == 0) {
+        return;
+    }
+
+    if (kbuf_count() == KBUF_SIZE - 1) {
+        // Make room by sending, for as long as that would not block
+        vusb_transfer_keyboard();
+    }
+
     uint8_t next = (kbuf_head + 1) % KBUF_SIZE;
     if (next != kbuf_tail) {
         kbuf[kbuf_head] = *report;
         kbuf_head       = next;
     } else {
-        dprint("kbuf: full\n");
+        // Still full: the newest state replaces the one queued before it, which is lost
+        uint8_t newest = (kbuf_head + KBUF_SIZE - 1) % KBUF_SIZE;
+#ifdef KEYBOARD_SHARED_EP
+        if (kbuf_split && newest == kbuf_tail) {
+            // Already half sent
+            dprint("kbuf: full\n");
+            host_report_dropped();
+            return;
+        }
+#endif
+        kbuf[newest] = *report;
+        dprint("kbuf: merged\n");
+        host_report_dropped();
     }
 
     // NOTE: send key strokes of Macro
@@ -252,7 +292,8 @@ static void send_keyboard(report_keyboard_t *report) {
 #    define usbInterruptIsReadyShared usbInterruptIsReady3
 #    define usbSetInterruptShared usbSetInterrupt3
 #else
-#    define usbInterruptIsReadyShared usbInterruptIsReady
+// Not between the two parts of a keyboard report
+#    define usbInterruptIsReadyShared() (usbInterruptIsReady() && !kbuf_split)
 #    define usbSetInterruptShared usbSetInterrupt
 #endif
 
@@ -454,6 +495,17 @@ const PROGMEM uchar shared_hid_report[] = {
     0x75, 0x01,  //     Report Size (1)
     0x81, 0x02,  //     Input (Data, Variable, Absolute)
 
+#    ifdef MOUSE_EXTENDED_REPORT
+    // X/Y position (4 bytes)
+    0x05, 0x01,        //     Usage Page (Generic Desktop)
+    0x09, 0x30,        //     Usage (X)
+    0x09, 0x31,        //     Usage (Y)
+    0x16, 0x01, 0x80,  //     Logical Minimum (-32767)
+    0x26, 0xFF, 0x7F,  //     Logical Maximum (32767)
+    0x95, 0x02,        //     Report Count (2)
+    0x75, 0x10,        //     Report Size (16)
+    0x81, 0x06,        //     Input (Data, Variable, Relative)
+#    else
     // X/Y position (2 bytes)
     0x05, 0x01,  //     Usage Page (Generic Desktop)
     0x09, 0x30,  //     Usage (X)
@@ -463,6 +515,7 @@ const PROGMEM uchar shared_hid_report[] = {
     0x95, 0x02,  //     Report Count (2)
     0x75, 0x08,  //     Report Size (8)
     0x81, 0x06,  //     Input (Data, Variable, Relative)
+#    endif
 
     // Vertical wheel (1 byte)
     0x09, 0x38,  //     Usage (Wheel)
@@ -228,6 +228,10 @@ endif
 GENDEPFLAGS = -MMD -MP -MF $(patsubst %.o,%.td,$@)
 
 
+# Put in front of the compiler for C and C++ sources, e.g. make COMPILER_CACHE=ccache, so that builds whose
+# preprocessed sources, flags and compiler match share their objects
+COMPILER_CACHE ?=
+
 # Combine all necessary flags and optional flags.
 # Add target processor to flags.
 # You can give extra flags at 'make' command line like: make EXTRAFLAGS=-DFOO=bar
@@ -338,7 +342,7 @@ $1_ASFLAGS = $$(ALL_ASFLAGS) $$($1_DEFS) $$($1_INCFLAGS) $$($1_CONFIG_FLAGS)
 $1/%.o : %.c $1/%.d $1/cflags.txt $1/compiler.txt | $(BEGIN)
 	@mkdir -p $$(@D)
 	@$$(SILENT) || printf "$$(MSG_COMPILING) $$<" | $$(AWK_CMD)
-	$$(eval CC_EXEC := $$(CC))
+	$$(eval CC_EXEC := $$(COMPILER_CACHE) $$(CC))
     ifneq ($$(VERBOSE_C_CMD),)
 	$$(if $$(filter $$(notdir $$(VERBOSE_C_CMD)),$$(notdir $$<)),$$(eval CC_EXEC += -v))
     endif
@@ -356,13 +360,13 @@ $1/%.o : %.c $1/%.d $1/cflags.txt $1/compiler.txt | $(BEGIN)
 $1/%.o : %.cpp $1/%.d $1/cxxflags.txt $1/compiler.txt | $(BEGIN)
 	@mkdir -p $$(@D)
 	@$$(SILENT) || printf "$$(MSG_COMPILING_CXX) $$<" | $$(AWK_CMD)
-	$$(eval CMD=$$(CC) -c $$($1_CXXFLAGS) $$(INIT_HOOK_CFLAGS) $$(GENDEPFLAGS) $$< -o $$@ && $$(MOVE_DEP))
+	$$(eval CMD=$$(COMPILER_CACHE) $$(CC) -c $$($1_CXXFLAGS) $$(INIT_HOOK_CFLAGS) $$(GENDEPFLAGS) $$< -o $$@ && $$(MOVE_DEP))
 	@$$(BUILD_CMD)
 
 $1/%.o : %.cc $1/%.d $1/cxxflags.txt $1/compiler.txt | $(BEGIN)
 	@mkdir -p $$(@D)
 	@$$(SILENT) || printf "$$(MSG_COMPILING_CXX) $$<" | $$(AWK_CMD)
-	$$(eval CMD=$$(CC) -c $$($1_CXXFLAGS) $$(INIT_HOOK_CFLAGS) $$(GENDEPFLAGS) $$< -o $$@ && $$(MOVE_DEP))
+	$$(eval CMD=$$(COMPILER_CACHE) $$(CC) -c $$($1_CXXFLAGS) $$(INIT_HOOK_CFLAGS) $$(GENDEPFLAGS) $$< -o $$@ && $$(MOVE_DEP))
 	@$$(BUILD_CMD)
 
 # Assemble: create object files from assembler source files.
@@ -435,6 +439,12 @@ dump_vars:
 objs-size:
 	for i in $(OBJ); do echo $$i; done | sort | xargs $(SIZE)
 
+# Per feature and per object RAM/flash use, checked against MEMORY_BUDGET
+memory-report:
+	$(SIZE) $(sort $(filter %.o,$(OBJ))) $(BUILD_DIR)/$(TARGET).elf > $(BUILD_DIR)/$(TARGET).size.txt
+	$(NM) -S --size-sort $(BUILD_DIR)/$(TARGET).elf > $(BUILD_DIR)/$(TARGET).nm.txt
+	bin/qmk memory-report --budget '$(MEMORY_BUDGET)' --symbols $(BUILD_DIR)/$(TARGET).nm.txt $(BUILD_DIR)/$(TARGET).size.txt
+
 ifeq ($(findstring avr-gcc,$(CC)),avr-gcc)
 SIZE_MARGIN = 1024
 
@@ -476,7 +486,7 @@ $(eval $(foreach OUTPUT,$(OUTPUTS),$(shell mkdir -p $(OUTPUT) 2>/dev/null)))
 
 # Listing of phony targets.
 .PHONY : all dump_vars finish sizebefore sizeafter qmkversion \
-gccversion build elf hex eep lss sym coff extcoff \
+gccversion build elf hex eep lss sym coff extcoff memory-report \
 clean clean_list debug gdb-config show_path \
 program teensy dfu dfu-ee dfu-start \
 flash dfu-split-left dfu-split-right \